@@ -0,0 +1,625 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// Audio codecs for the RX audio stream from the server to the client.
+//
+// Uncompressed 16-bit stereo audio at 48 kHz needs 1.5 Mbit/s. The in-tree
+// IMA ADPCM codec reduces this by a factor of four (stereo) up to a factor
+// of 16 (mono, 24 kHz sample rate) at practically no CPU cost and without
+// adding any latency beyond the frame length. Each ADPCM frame starts with
+// the predictor state of each channel, so a frame can be decoded without
+// knowledge of the previous one.
+//
+// If compiled with OPUS, the Opus codec (in its low-delay mode) can be used
+// with bit rates down to 16 kbit/s.
+//
+
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+#ifdef OPUS
+#include <opus.h>
+#endif
+
+#include "audio_codec.h"
+#include "message.h"
+
+const AUDIO_CODEC_CHOICE audio_codec_choices[] = {
+  {AUDIO_CODEC_PCM,        1536, "PCM 1536 kbit/s"},
+  {AUDIO_CODEC_ADPCM,       384, "ADPCM 384 kbit/s"},
+  {AUDIO_CODEC_ADPCM_MONO,  192, "ADPCM Mono 192 kbit/s"},
+  {AUDIO_CODEC_ADPCM_24K,    96, "ADPCM Mono 96 kbit/s"},
+#ifdef OPUS
+  {AUDIO_CODEC_OPUS,         64, "Opus 64 kbit/s"},
+  {AUDIO_CODEC_OPUS,         32, "Opus 32 kbit/s"},
+  {AUDIO_CODEC_OPUS,         16, "Opus 16 kbit/s"},
+#endif
+};
+
+int audio_codec_num_choices() {
+  return sizeof(audio_codec_choices) / sizeof(audio_codec_choices[0]);
+}
+
+//
+// Half-band low-pass filter used for decimation/interpolation
+// in the 24 kHz codec. Every second coefficient (except the
+// center one) is zero.
+//
+#define HB_TAPS 31
+
+static float hb_coeff[HB_TAPS];
+static int hb_init = 0;
+
+typedef struct _adpcm_state {
+  int predictor;
+  int index;
+} ADPCM_STATE;
+
+struct _audio_codec {
+  int codec;
+  int bitrate;
+  int frame;
+  ADPCM_STATE adpcm[2];
+  float hist[HB_TAPS - 1];      // filter history of the 24 kHz codec
+  short last[2 * AUDIO_CODEC_MAX_FRAME];  // decoder: last frame, for loss concealment
+  int last_n;
+  int concealed;                // decoder: number of frames concealed in a row
+#ifdef OPUS
+  OpusEncoder *opus_enc;
+  OpusDecoder *opus_dec;
+#endif
+};
+
+static const int adpcm_index_table[16] = {
+  -1, -1, -1, -1, 2, 4, 6, 8,
+  -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int adpcm_step_table[89] = {
+  7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+  19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+  50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+  130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+  337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+  876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+  2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+  5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+  15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static void hb_make_coeff() {
+  double sum = 0.0;
+
+  for (int i = 0; i < HB_TAPS; i++) {
+    int n = i - (HB_TAPS - 1) / 2;
+    double x = 0.5 * M_PI * n;
+    double s = (n == 0) ? 0.5 : 0.5 * sin(x) / x;
+    // Blackman window
+    double w = 0.42 - 0.5 * cos(2.0 * M_PI * i / (HB_TAPS - 1)) + 0.08 * cos(4.0 * M_PI * i / (HB_TAPS - 1));
+    hb_coeff[i] = s * w;
+    sum += hb_coeff[i];
+  }
+
+  for (int i = 0; i < HB_TAPS; i++) {
+    hb_coeff[i] /= sum;
+  }
+
+  hb_init = 1;
+}
+
+//
+// Filter n new samples (in) with the half-band filter, using and updating
+// the filter history. The output is produced for every "step"-th sample.
+//
+static int hb_filter(float *hist, const float *in, int n, int step, float gain, float *out) {
+  float buf[HB_TAPS - 1 + 2 * AUDIO_CODEC_MAX_FRAME];
+  int m = 0;
+  memcpy(buf, hist, (HB_TAPS - 1) * sizeof(float));
+  memcpy(buf + HB_TAPS - 1, in, n * sizeof(float));
+
+  for (int i = step - 1; i < n; i += step) {
+    float acc = 0.0F;
+    const float *p = buf + i;
+
+    for (int k = 0; k < HB_TAPS; k++) {
+      acc += hb_coeff[k] * p[HB_TAPS - 1 - k];
+    }
+
+    out[m++] = gain * acc;
+  }
+
+  memcpy(hist, buf + n, (HB_TAPS - 1) * sizeof(float));
+  return m;
+}
+
+static int adpcm_encode_sample(ADPCM_STATE *s, int sample) {
+  int step = adpcm_step_table[s->index];
+  int diff = sample - s->predictor;
+  int nibble = 0;
+  int delta = step >> 3;
+
+  if (diff < 0) {
+    nibble = 8;
+    diff = -diff;
+  }
+
+  if (diff >= step) {
+    nibble |= 4;
+    diff -= step;
+    delta += step;
+  }
+
+  step >>= 1;
+
+  if (diff >= step) {
+    nibble |= 2;
+    diff -= step;
+    delta += step;
+  }
+
+  step >>= 1;
+
+  if (diff >= step) {
+    nibble |= 1;
+    delta += step;
+  }
+
+  s->predictor += (nibble & 8) ? -delta : delta;
+
+  if (s->predictor > 32767) { s->predictor = 32767; }
+
+  if (s->predictor < -32768) { s->predictor = -32768; }
+
+  s->index += adpcm_index_table[nibble];
+
+  if (s->index < 0) { s->index = 0; }
+
+  if (s->index > 88) { s->index = 88; }
+
+  return nibble;
+}
+
+static int adpcm_decode_sample(ADPCM_STATE *s, int nibble) {
+  int step = adpcm_step_table[s->index];
+  int delta = step >> 3;
+
+  if (nibble & 4) { delta += step; }
+
+  if (nibble & 2) { delta += step >> 1; }
+
+  if (nibble & 1) { delta += step >> 2; }
+
+  s->predictor += (nibble & 8) ? -delta : delta;
+
+  if (s->predictor > 32767) { s->predictor = 32767; }
+
+  if (s->predictor < -32768) { s->predictor = -32768; }
+
+  s->index += adpcm_index_table[nibble];
+
+  if (s->index < 0) { s->index = 0; }
+
+  if (s->index > 88) { s->index = 88; }
+
+  return s->predictor;
+}
+
+static uint8_t *adpcm_put_state(uint8_t *p, const ADPCM_STATE *s) {
+  *p++ = s->predictor & 0xFF;
+  *p++ = (s->predictor >> 8) & 0xFF;
+  *p++ = s->index;
+  *p++ = 0;
+  return p;
+}
+
+static const uint8_t *adpcm_get_state(const uint8_t *p, ADPCM_STATE *s) {
+  s->predictor = (int16_t)(p[0] | (p[1] << 8));
+  s->index = p[2];
+
+  if (s->index > 88) { s->index = 88; }
+
+  return p + 4;
+}
+
+//
+// Encode/decode n mono samples, two samples per byte
+//
+static int adpcm_encode_mono(ADPCM_STATE *s, const short *in, int n, uint8_t *out) {
+  uint8_t *p = adpcm_put_state(out, s);
+
+  for (int i = 0; i < n; i += 2) {
+    int lo = adpcm_encode_sample(s, in[i]);
+    int hi = adpcm_encode_sample(s, in[i + 1]);
+    *p++ = lo | (hi << 4);
+  }
+
+  return p - out;
+}
+
+static int adpcm_decode_mono(ADPCM_STATE *s, const uint8_t *in, int len, short *out) {
+  int n = 0;
+
+  if (len < 4) { return -1; }
+
+  const uint8_t *p = adpcm_get_state(in, s);
+
+  for (int i = 4; i < len; i++) {
+    out[n++] = adpcm_decode_sample(s, *p & 0x0F);
+    out[n++] = adpcm_decode_sample(s, *p++ >> 4);
+  }
+
+  return n;
+}
+
+int audio_codec_supported(int codec) {
+  switch (codec) {
+  case AUDIO_CODEC_PCM:
+  case AUDIO_CODEC_ADPCM:
+  case AUDIO_CODEC_ADPCM_MONO:
+  case AUDIO_CODEC_ADPCM_24K:
+    return 1;
+
+  case AUDIO_CODEC_OPUS:
+#ifdef OPUS
+    return 1;
+#else
+    return 0;
+#endif
+
+  default:
+    return 0;
+  }
+}
+
+const char *audio_codec_name(int codec) {
+  switch (codec) {
+  case AUDIO_CODEC_PCM:
+    return "PCM";
+
+  case AUDIO_CODEC_ADPCM:
+    return "ADPCM";
+
+  case AUDIO_CODEC_ADPCM_MONO:
+    return "ADPCM Mono";
+
+  case AUDIO_CODEC_ADPCM_24K:
+    return "ADPCM Mono 24k";
+
+  case AUDIO_CODEC_OPUS:
+    return "Opus";
+
+  default:
+    return "Unknown";
+  }
+}
+
+static AUDIO_CODEC *audio_codec_new(int codec, int bitrate, int frame) {
+  if (!audio_codec_supported(codec)) {
+    t_print("%s: codec %d not supported\n", __FUNCTION__, codec);
+    return NULL;
+  }
+
+  if (!hb_init) { hb_make_coeff(); }
+
+  if (frame > AUDIO_CODEC_MAX_FRAME) { frame = AUDIO_CODEC_MAX_FRAME; }
+
+  //
+  // ADPCM packs two (mono) samples into a byte, and the 24 kHz
+  // codec drops every second sample, so use a multiple of 4.
+  //
+  frame &= ~3;
+
+  if (frame < 4) { frame = 4; }
+
+  AUDIO_CODEC *c = g_new0(AUDIO_CODEC, 1);
+  c->codec = codec;
+  c->bitrate = bitrate;
+  c->frame = frame;
+  return c;
+}
+
+AUDIO_CODEC *audio_encoder_new(int codec, int bitrate, int frame) {
+  AUDIO_CODEC *c = audio_codec_new(codec, bitrate, frame);
+
+  if (c == NULL) { return NULL; }
+
+#ifdef OPUS
+
+  if (codec == AUDIO_CODEC_OPUS) {
+    int err;
+
+    //
+    // Opus only supports frames of 2.5, 5, 10, 20 msec
+    //
+    if (c->frame >= 960) {
+      c->frame = 960;
+    } else if (c->frame >= 480) {
+      c->frame = 480;
+    } else if (c->frame >= 240) {
+      c->frame = 240;
+    } else {
+      c->frame = 120;
+    }
+
+    c->opus_enc = opus_encoder_create(48000, 2, OPUS_APPLICATION_RESTRICTED_LOWDELAY, &err);
+
+    if (err != OPUS_OK) {
+      t_print("%s: opus_encoder_create failed: %s\n", __FUNCTION__, opus_strerror(err));
+      g_free(c);
+      return NULL;
+    }
+
+    opus_encoder_ctl(c->opus_enc, OPUS_SET_BITRATE(bitrate * 1000));
+    opus_encoder_ctl(c->opus_enc, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
+  }
+
+#endif
+  t_print("%s: %s %d kbit/s, %d samples per frame\n", __FUNCTION__, audio_codec_name(codec), bitrate, c->frame);
+  return c;
+}
+
+AUDIO_CODEC *audio_decoder_new(int codec) {
+  AUDIO_CODEC *c = audio_codec_new(codec, 0, AUDIO_CODEC_MAX_FRAME);
+
+  if (c == NULL) { return NULL; }
+
+#ifdef OPUS
+
+  if (codec == AUDIO_CODEC_OPUS) {
+    int err;
+    c->opus_dec = opus_decoder_create(48000, 2, &err);
+
+    if (err != OPUS_OK) {
+      t_print("%s: opus_decoder_create failed: %s\n", __FUNCTION__, opus_strerror(err));
+      g_free(c);
+      return NULL;
+    }
+  }
+
+#endif
+  return c;
+}
+
+void audio_codec_free(AUDIO_CODEC *c) {
+  if (c == NULL) { return; }
+
+#ifdef OPUS
+
+  if (c->opus_enc) { opus_encoder_destroy(c->opus_enc); }
+
+  if (c->opus_dec) { opus_decoder_destroy(c->opus_dec); }
+
+#endif
+  g_free(c);
+}
+
+int audio_codec_get_codec(const AUDIO_CODEC *c) {
+  return c->codec;
+}
+
+int audio_codec_frame_size(const AUDIO_CODEC *c) {
+  return c->frame;
+}
+
+int audio_encode(AUDIO_CODEC *c, const short *pcm, uint8_t *out) {
+  int n = c->frame;
+  short mono[AUDIO_CODEC_MAX_FRAME];
+
+  switch (c->codec) {
+  case AUDIO_CODEC_PCM:
+    for (int i = 0; i < 2 * n; i++) {
+      *out++ = pcm[i] & 0xFF;
+      *out++ = (pcm[i] >> 8) & 0xFF;
+    }
+
+    return 4 * n;
+
+  case AUDIO_CODEC_ADPCM: {
+    uint8_t *p = adpcm_put_state(out, &c->adpcm[0]);
+    p = adpcm_put_state(p, &c->adpcm[1]);
+
+    for (int i = 0; i < n; i++) {
+      int l = adpcm_encode_sample(&c->adpcm[0], pcm[2 * i]);
+      int r = adpcm_encode_sample(&c->adpcm[1], pcm[2 * i + 1]);
+      *p++ = l | (r << 4);
+    }
+
+    return p - out;
+  }
+
+  case AUDIO_CODEC_ADPCM_MONO:
+    for (int i = 0; i < n; i++) {
+      mono[i] = (pcm[2 * i] + pcm[2 * i + 1]) / 2;
+    }
+
+    return adpcm_encode_mono(&c->adpcm[0], mono, n, out);
+
+  case AUDIO_CODEC_ADPCM_24K: {
+    float in[AUDIO_CODEC_MAX_FRAME];
+    float dec[AUDIO_CODEC_MAX_FRAME / 2];
+
+    for (int i = 0; i < n; i++) {
+      in[i] = 0.5F * (pcm[2 * i] + pcm[2 * i + 1]);
+    }
+
+    int m = hb_filter(c->hist, in, n, 2, 1.0F, dec);
+
+    for (int i = 0; i < m; i++) {
+      float s = dec[i];
+
+      if (s > 32767.0F) { s = 32767.0F; }
+
+      if (s < -32768.0F) { s = -32768.0F; }
+
+      mono[i] = (short) lrintf(s);
+    }
+
+    return adpcm_encode_mono(&c->adpcm[0], mono, m, out);
+  }
+
+#ifdef OPUS
+
+  case AUDIO_CODEC_OPUS: {
+    int rc = opus_encode(c->opus_enc, pcm, n, out, AUDIO_CODEC_MAX_BYTES);
+
+    if (rc < 0) {
+      t_print("%s: opus_encode failed: %s\n", __FUNCTION__, opus_strerror(rc));
+      return -1;
+    }
+
+    return rc;
+  }
+
+#endif
+
+  default:
+    return -1;
+  }
+}
+
+static int audio_decode_frame(AUDIO_CODEC *c, const uint8_t *in, int len, short *pcm) {
+  short mono[AUDIO_CODEC_MAX_FRAME];
+  int n;
+
+  switch (c->codec) {
+  case AUDIO_CODEC_PCM:
+    n = len / 4;
+
+    if (n > AUDIO_CODEC_MAX_FRAME) { return -1; }
+
+    for (int i = 0; i < 2 * n; i++) {
+      pcm[i] = (int16_t)(in[0] | (in[1] << 8));
+      in += 2;
+    }
+
+    return n;
+
+  case AUDIO_CODEC_ADPCM: {
+    if (len < 8 || len - 8 > AUDIO_CODEC_MAX_FRAME) { return -1; }
+
+    const uint8_t *p = adpcm_get_state(in, &c->adpcm[0]);
+    p = adpcm_get_state(p, &c->adpcm[1]);
+    n = len - 8;
+
+    for (int i = 0; i < n; i++) {
+      pcm[2 * i]     = adpcm_decode_sample(&c->adpcm[0], *p & 0x0F);
+      pcm[2 * i + 1] = adpcm_decode_sample(&c->adpcm[1], *p++ >> 4);
+    }
+
+    return n;
+  }
+
+  case AUDIO_CODEC_ADPCM_MONO:
+    if (2 * (len - 4) > AUDIO_CODEC_MAX_FRAME) { return -1; }
+
+    n = adpcm_decode_mono(&c->adpcm[0], in, len, mono);
+
+    for (int i = 0; i < n; i++) {
+      pcm[2 * i] = pcm[2 * i + 1] = mono[i];
+    }
+
+    return n;
+
+  case AUDIO_CODEC_ADPCM_24K: {
+    float up[AUDIO_CODEC_MAX_FRAME];
+    float out[AUDIO_CODEC_MAX_FRAME];
+
+    if (4 * (len - 4) > AUDIO_CODEC_MAX_FRAME) { return -1; }
+
+    int m = adpcm_decode_mono(&c->adpcm[0], in, len, mono);
+
+    if (m < 0) { return -1; }
+
+    //
+    // Insert zeroes and filter. The gain of 2 compensates for the zeroes.
+    //
+    for (int i = 0; i < m; i++) {
+      up[2 * i] = mono[i];
+      up[2 * i + 1] = 0.0F;
+    }
+
+    n = hb_filter(c->hist, up, 2 * m, 1, 2.0F, out);
+
+    for (int i = 0; i < n; i++) {
+      float s = out[i];
+
+      if (s > 32767.0F) { s = 32767.0F; }
+
+      if (s < -32768.0F) { s = -32768.0F; }
+
+      pcm[2 * i] = pcm[2 * i + 1] = (short) lrintf(s);
+    }
+
+    return n;
+  }
+
+#ifdef OPUS
+
+  case AUDIO_CODEC_OPUS:
+    n = opus_decode(c->opus_dec, in, len, pcm, AUDIO_CODEC_MAX_FRAME, 0);
+
+    if (n < 0) {
+      t_print("%s: opus_decode failed: %s\n", __FUNCTION__, opus_strerror(n));
+      return -1;
+    }
+
+    return n;
+#endif
+
+  default:
+    return -1;
+  }
+}
+
+int audio_decode(AUDIO_CODEC *c, const uint8_t *in, int len, short *pcm) {
+  int n = audio_decode_frame(c, in, len, pcm);
+
+  if (n > 0) {
+    memcpy(c->last, pcm, 2 * n * sizeof(short));
+    c->last_n = n;
+    c->concealed = 0;
+  }
+
+  return n;
+}
+
+//
+// Loss concealment. Opus has its own, for the other codecs the last
+// frame is repeated, 6 dB softer for each frame lost in a row.
+//
+int audio_conceal(AUDIO_CODEC *c, int n, short *pcm) {
+  if (n > AUDIO_CODEC_MAX_FRAME) { n = AUDIO_CODEC_MAX_FRAME; }
+
+#ifdef OPUS
+
+  if (c->codec == AUDIO_CODEC_OPUS) {
+    int rc = opus_decode(c->opus_dec, NULL, 0, pcm, n, 0);
+
+    if (rc > 0) { return rc; }
+  }
+
+#endif
+  int shift = ++c->concealed;
+
+  for (int i = 0; i < 2 * n; i++) {
+    pcm[i] = (i < 2 * c->last_n && shift < 4) ? c->last[i] >> shift : 0;
+  }
+
+  return n;
+}
@@ -0,0 +1,76 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _AUDIO_CODEC_H_
+#define _AUDIO_CODEC_H_
+
+#include <stdint.h>
+
+//
+// Audio codecs for the client/server RX audio stream.
+// All codecs take and deliver 16-bit stereo samples at 48 kHz.
+// The numerical values are part of the client/server protocol.
+//
+enum _audio_codec_enum {
+  AUDIO_CODEC_PCM = 0,         // 16-bit stereo, uncompressed
+  AUDIO_CODEC_ADPCM,           // IMA ADPCM stereo, 4 bits per sample
+  AUDIO_CODEC_ADPCM_MONO,      // IMA ADPCM mono
+  AUDIO_CODEC_ADPCM_24K,       // IMA ADPCM mono, sample rate reduced to 24 kHz
+  AUDIO_CODEC_OPUS,            // Opus (only available if compiled with OPUS)
+  AUDIO_CODECS
+};
+
+#define AUDIO_CODEC_MAX_FRAME  1024                        // max. number of stereo samples per frame
+#define AUDIO_CODEC_MAX_BYTES  (4 * AUDIO_CODEC_MAX_FRAME) // max. size of an encoded frame
+
+//
+// The list of codec/bitrate combinations offered to the user.
+// bitrate is in kbit/s.
+//
+typedef struct _audio_codec_choice {
+  int codec;
+  int bitrate;
+  const char *name;
+} AUDIO_CODEC_CHOICE;
+
+extern const AUDIO_CODEC_CHOICE audio_codec_choices[];
+extern int audio_codec_num_choices(void);
+
+typedef struct _audio_codec AUDIO_CODEC;
+
+extern int audio_codec_supported(int codec);
+extern const char *audio_codec_name(int codec);
+
+//
+// For the encoder, the frame size (number of stereo samples that go into
+// one encoded frame) is fixed at creation time. It is rounded to what the
+// codec supports, use audio_codec_frame_size() to get the actual value.
+// audio_encode() encodes exactly one frame and returns the number of bytes,
+// audio_decode() returns the number of stereo samples. Both return -1 on error.
+// audio_conceal() produces n stereo samples to replace a lost frame.
+//
+extern AUDIO_CODEC *audio_encoder_new(int codec, int bitrate, int frame);
+extern AUDIO_CODEC *audio_decoder_new(int codec);
+extern void audio_codec_free(AUDIO_CODEC *c);
+extern int  audio_codec_get_codec(const AUDIO_CODEC *c);
+extern int  audio_codec_frame_size(const AUDIO_CODEC *c);
+extern int  audio_encode(AUDIO_CODEC *c, const short *pcm, uint8_t *out);
+extern int  audio_decode(AUDIO_CODEC *c, const uint8_t *in, int len, short *pcm);
+extern int  audio_conceal(AUDIO_CODEC *c, int n, short *pcm);
+
+#endif
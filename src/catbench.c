@@ -0,0 +1,1097 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+/*
+ * TCI/CAT load generator.
+ *
+ * This program connects a number of simulated CAT clients (TCP) and TCI
+ * clients (WebSocket) to a running piHPSDR, which typically talks to
+ * hpsdrsim on the same machine, and lets each of them send a mix of
+ * queries and set commands. It reports reply latency percentiles,
+ * errors, timeouts, dropped connections and (with -pid) the CPU use of
+ * piHPSDR, such that changes to the CAT and TCI servers can be measured
+ * reproducibly on a single Linux box.
+ *
+ * CAT set commands have no reply, so each set command is immediately
+ * followed by the corresponding query, and the latency is the time until
+ * the reply to that query has arrived. With a given request rate, the
+ * latency is measured from the time the request was scheduled, not from
+ * the time it was actually sent, so a server that stalls is not rewarded
+ * by a client that then sends less.
+ *
+ * Note that the set commands change the VFO-A frequency (within 10 kHz
+ * around 14.150 MHz) and the RX1 volume of the radio under test. Both the
+ * CAT and the TCI server accept at most three clients, the surplus ones
+ * are reported as refused.
+ *
+ * Options:
+ *
+ * -host    <a>  IPv4 address of piHPSDR (default: 127.0.0.1)
+ * -cat     <n>  number of CAT clients (default: 2)
+ * -catport <n>  TCP port of the CAT server (default: 19090)
+ * -tci     <n>  number of TCI clients (default: 2)
+ * -tciport <n>  TCP port of the TCI server (default: 40001)
+ * -time    <n>  duration of the run in seconds (default: 30)
+ * -rate    <n>  requests per second and client, 0: back-to-back (default: 50)
+ * -set     <n>  percentage of set commands (default: 10)
+ * -timeout <n>  reply timeout in msec (default: 1000)
+ * -stream  <s>  TCI clients also receive a stream of RX1: iq, audio or spectrum
+ * -pid     <n>  process id of piHPSDR, to report its CPU use (Linux only)
+ * -conform      instead of the load test, send every SET and READ form
+ *               documented in rigctl.c once over a single CAT connection,
+ *               and check the replies against the documented responses.
+ *               This changes many settings of the radio under test (it
+ *               even transmits), so run it against hpsdrsim. The exit
+ *               code is non-zero if a check fails.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "catdef.h"
+
+#define MAX_BENCH_CLIENTS 16
+#define BENCH_BUFSIZE     65536        // receive buffer, must hold a complete stream frame
+#define BENCH_CONNECT     5000         // msec allowed for connect and initial TCI report
+
+enum _bench_kind_enum {
+  BENCH_CAT = 0,
+  BENCH_TCI,
+  BENCH_KINDS
+};
+
+static const char *kind_names[BENCH_KINDS] = {"CAT", "TCI"};
+
+//
+// The command mix. For set commands, "cmd" is a format for a value
+// that is chosen randomly from base ... base+range-1. "reply" is the
+// start of the expected reply.
+//
+typedef struct _bench_cmd {
+  const char *cmd;
+  const char *reply;
+  int base;
+  int range;
+} BENCH_CMD;
+
+static const BENCH_CMD cat_queries[] = {
+  {"FA;",   "FA",   0, 0},
+  {"FB;",   "FB",   0, 0},
+  {"IF;",   "IF",   0, 0},
+  {"MD;",   "MD",   0, 0},
+  {"SM0;",  "SM0",  0, 0},
+  {"ZZFA;", "ZZFA", 0, 0},
+  {"ZZMD;", "ZZMD", 0, 0},
+  {"ZZAG;", "ZZAG", 0, 0}
+};
+
+static const BENCH_CMD cat_sets[] = {
+  {"FA%011d;FA;",     "FA",   14145000, 10000},
+  {"ZZFA%011d;ZZFA;", "ZZFA", 14145000, 10000},
+  {"ZZAG%03d;ZZAG;",  "ZZAG", 40,       20}
+};
+
+static const BENCH_CMD tci_queries[] = {
+  {"trx_count;",             "trx_count",             0, 0},
+  {"trx:0;",                 "trx",                   0, 0},
+  {"modulation:0;",          "modulation",            0, 0},
+  {"vfo:0,0;",               "vfo",                   0, 0},
+  {"rx_smeter:0,0;",         "rx_smeter",             0, 0},
+  {"cw_macros_speed;",       "cw_macros_speed",       0, 0},
+  {"audio_stream_channels;", "audio_stream_channels", 0, 0}
+};
+
+static const BENCH_CMD tci_sets[] = {
+  {"iq_samplerate:%d;",    "iq_samplerate",    48000, 1},
+  {"audio_samplerate:%d;", "audio_samplerate", 48000, 1}
+};
+
+typedef struct _latencies {
+  long long *ns;
+  int n;
+  int size;
+} LATENCIES;
+
+typedef struct _bench_client {
+  int kind;
+  int id;
+  int fd;
+  pthread_t thread;
+  unsigned int rnd;
+  uint8_t buf[BENCH_BUFSIZE];
+  int fill;
+  char reply[256];                     // last text message received
+  //
+  // statistics
+  //
+  LATENCIES query;
+  LATENCIES set;
+  LATENCIES connect;
+  long requests;
+  long errors;                         // error replies ("?;")
+  long timeouts;
+  long drops;                          // connections lost during the run
+  long refused;                        // connection attempts that failed
+  long notifications;                  // unsolicited TCI messages
+  long long stream_bytes;
+  long stream_frames;
+} BENCH_CLIENT;
+
+static BENCH_CLIENT *clients[2 * MAX_BENCH_CLIENTS];
+static int nclients = 0;
+
+static char host[64] = "127.0.0.1";
+static int cat_port = 19090;
+static int tci_port = 40001;
+static int rate = 50;
+static int set_percent = 10;
+static int timeout_ms = 1000;
+static const char *stream = NULL;
+static volatile int running = 1;
+
+static long long now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void t_print(const char *format, ...) {
+  static long long start = 0;
+  va_list args;
+  long long now = now_ns();
+
+  if (start == 0) { start = now; }
+
+  va_start(args, format);
+  fprintf(stderr, "%10.3f ", 1.0E-9 * (now - start));
+  vfprintf(stderr, format, args);
+  va_end(args);
+}
+
+static void lat_add(LATENCIES *l, long long ns) {
+  if (l->n >= l->size) {
+    l->size = l->size ? 2 * l->size : 4096;
+    l->ns = realloc(l->ns, l->size * sizeof(long long));
+
+    if (l->ns == NULL) {
+      t_print("Out of memory\n");
+      exit(1);
+    }
+  }
+
+  l->ns[l->n++] = ns;
+}
+
+static int cmp_ns(const void *a, const void *b) {
+  long long x = *(const long long *) a;
+  long long y = *(const long long *) b;
+  return (x > y) - (x < y);
+}
+
+//
+// A simple pseudo-random generator (xorshift32), one per client
+//
+static unsigned int rnd_next(BENCH_CLIENT *c) {
+  c->rnd ^= c->rnd << 13;
+  c->rnd ^= c->rnd >> 17;
+  c->rnd ^= c->rnd << 5;
+  return c->rnd;
+}
+
+static int bench_write(int fd, const void *data, size_t len) {
+  const uint8_t *p = data;
+
+  while (len > 0) {
+    ssize_t n = send(fd, p, len, 0);
+
+    if (n < 0 && errno == EINTR) { continue; }
+
+    if (n <= 0) { return -1; }
+
+    p += n;
+    len -= n;
+  }
+
+  return 0;
+}
+
+//
+// Wait (at most until the deadline) for data and append it to the
+// receive buffer. Returns the number of bytes read, 0 if nothing has
+// arrived, and -1 if the connection has been closed.
+//
+static int bench_fill(BENCH_CLIENT *c, long long deadline) {
+  struct pollfd pfd;
+  long long wait = (deadline - now_ns()) / 1000000LL;
+
+  if (wait < 0) { wait = 0; }
+
+  if (c->fill >= BENCH_BUFSIZE) { return -1; }
+
+  pfd.fd = c->fd;
+  pfd.events = POLLIN;
+  int rc = poll(&pfd, 1, (int) wait);
+
+  if (rc < 0) { return (errno == EINTR) ? 0 : -1; }
+
+  if (rc == 0) { return 0; }
+
+  ssize_t n = recv(c->fd, c->buf + c->fill, BENCH_BUFSIZE - c->fill, 0);
+
+  if (n <= 0) { return -1; }
+
+  c->fill += n;
+  return (int) n;
+}
+
+static void bench_consume(BENCH_CLIENT *c, int len) {
+  c->fill -= len;
+  memmove(c->buf, c->buf + len, c->fill);
+}
+
+static void bench_copy_reply(BENCH_CLIENT *c, const uint8_t *data, size_t len) {
+  if (len >= sizeof(c->reply)) { len = sizeof(c->reply) - 1; }
+
+  memcpy(c->reply, data, len);
+  c->reply[len] = 0;
+}
+
+static int bench_connect(int port) {
+  struct sockaddr_in addr;
+  int on = 1;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+  if (fd < 0) { return -1; }
+
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+
+  if (inet_pton(AF_INET, host, &addr.sin_addr) != 1 ||
+      connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// CAT: replies come in the order of the commands and are terminated by ';'
+//
+/////////////////////////////////////////////////////////////////////////////
+
+//
+// Returns 1 if a reply is in c->reply, 0 on timeout, -1 if the connection is lost
+//
+static int cat_reply(BENCH_CLIENT *c, long long deadline) {
+  for (;;) {
+    const uint8_t *p = memchr(c->buf, ';', c->fill);
+
+    if (p != NULL) {
+      int len = (int)(p - c->buf) + 1;
+      bench_copy_reply(c, c->buf, len);
+      bench_consume(c, len);
+      return 1;
+    }
+
+    if (now_ns() >= deadline) { return 0; }
+
+    if (bench_fill(c, deadline) < 0) { return -1; }
+  }
+}
+
+static int cat_request(BENCH_CLIENT *c, int set, long long t0) {
+  char cmd[64];
+  const BENCH_CMD *bc;
+  long long deadline = now_ns() + 1000000LL * timeout_ms;
+
+  if (set) {
+    bc = &cat_sets[rnd_next(c) % (sizeof(cat_sets) / sizeof(cat_sets[0]))];
+    snprintf(cmd, sizeof(cmd), bc->cmd, bc->base + (int)(rnd_next(c) % bc->range));
+  } else {
+    bc = &cat_queries[rnd_next(c) % (sizeof(cat_queries) / sizeof(cat_queries[0]))];
+    snprintf(cmd, sizeof(cmd), "%s", bc->cmd);
+  }
+
+  if (bench_write(c->fd, cmd, strlen(cmd)) < 0) { return -1; }
+
+  c->requests++;
+
+  for (;;) {
+    int rc = cat_reply(c, deadline);
+
+    if (rc <= 0) { return rc; }
+
+    if (!strncmp(c->reply, bc->reply, strlen(bc->reply))) { break; }
+
+    //
+    // An error reply to a query ends the request. For a set command,
+    // the reply to the query that follows it is still to come.
+    //
+    c->errors++;
+
+    if (!set && !strcmp(c->reply, "?;")) { break; }
+  }
+
+  lat_add(set ? &c->set : &c->query, now_ns() - t0);
+  return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// TCI: WebSocket frames. Client frames must be masked, server frames
+// are not. Text messages that do not match the pending request are
+// taken as notifications (e.g. reports of frequency changes caused by
+// other clients).
+//
+/////////////////////////////////////////////////////////////////////////////
+
+static int tci_send_frame(BENCH_CLIENT *c, int opcode, const uint8_t *data, size_t len) {
+  uint8_t frame[256];
+  uint32_t key = rnd_next(c);
+  int head = 2;
+
+  if (len > sizeof(frame) - 8) { return -1; }
+
+  frame[0] = 0x80 | opcode;
+
+  if (len < 126) {
+    frame[1] = 0x80 | len;
+  } else {
+    frame[1] = 0x80 | 126;
+    frame[2] = (len >> 8) & 0xFF;
+    frame[3] = len & 0xFF;
+    head = 4;
+  }
+
+  memcpy(frame + head, &key, 4);
+
+  for (size_t i = 0; i < len; i++) {
+    frame[head + 4 + i] = data[i] ^ frame[head + (i & 3)];
+  }
+
+  return bench_write(c->fd, frame, head + 4 + len);
+}
+
+static int tci_send(BENCH_CLIENT *c, const char *msg) {
+  return tci_send_frame(c, 0x01, (const uint8_t *) msg, strlen(msg));
+}
+
+//
+// Check if a complete frame is in the buffer. Returns its total length,
+// 0 if the frame is not yet complete, and -1 if it does not fit into
+// the buffer at all.
+//
+static int tci_frame(BENCH_CLIENT *c, int *opcode, uint8_t **payload, size_t *len) {
+  uint8_t *b = c->buf;
+  size_t plen;
+  size_t head = 2;
+
+  if (c->fill < 2) { return 0; }
+
+  plen = b[1] & 0x7F;
+
+  if (plen == 126) {
+    if (c->fill < 4) { return 0; }
+
+    plen = ((size_t) b[2] << 8) | b[3];
+    head = 4;
+  } else if (plen == 127) {
+    if (c->fill < 10) { return 0; }
+
+    plen = 0;
+
+    for (int i = 2; i < 10; i++) { plen = (plen << 8) | b[i]; }
+
+    head = 10;
+  }
+
+  int masked = b[1] & 0x80;
+
+  if (masked) { head += 4; }
+
+  if (head + plen > BENCH_BUFSIZE) { return -1; }
+
+  if ((size_t) c->fill < head + plen) { return 0; }
+
+  if (masked) {
+    for (size_t i = 0; i < plen; i++) { b[head + i] ^= b[head - 4 + (i & 3)]; }
+  }
+
+  *opcode = b[0] & 0x0F;
+  *payload = b + head;
+  *len = plen;
+  return (int)(head + plen);
+}
+
+//
+// Process incoming frames until a text message has arrived (return 1),
+// the deadline has passed (return 0) or the connection is lost (return -1).
+// Stream frames are only counted.
+//
+static int tci_message(BENCH_CLIENT *c, long long deadline) {
+  for (;;) {
+    int opcode;
+    uint8_t *payload;
+    size_t len;
+    int n = tci_frame(c, &opcode, &payload, &len);
+
+    if (n < 0) { return -1; }
+
+    if (n > 0) {
+      int text = 0;
+
+      switch (opcode) {
+      case 0x01:
+        bench_copy_reply(c, payload, len);
+        text = 1;
+        break;
+
+      case 0x02:
+        c->stream_bytes += len;
+        c->stream_frames++;
+        break;
+
+      case 0x08:
+        return -1;
+
+      case 0x09:
+        if (tci_send_frame(c, 0x0A, payload, len) < 0) { return -1; }
+
+        break;
+      }
+
+      bench_consume(c, n);
+
+      if (text) { return 1; }
+
+      continue;
+    }
+
+    if (now_ns() >= deadline) { return 0; }
+
+    if (bench_fill(c, deadline) < 0) { return -1; }
+  }
+}
+
+//
+// Receive (stream frames and notifications) until the deadline
+//
+static int tci_drain(BENCH_CLIENT *c, long long deadline) {
+  for (;;) {
+    int rc = tci_message(c, deadline);
+
+    if (rc <= 0) { return rc; }
+
+    c->notifications++;
+  }
+}
+
+//
+// The Sec-WebSocket-Accept of the reply is not verified.
+//
+static int tci_handshake(BENCH_CLIENT *c, long long deadline) {
+  char req[256];
+  int end = 0;
+  snprintf(req, sizeof(req),
+           "GET / HTTP/1.1\r\n"
+           "Host: %s:%d\r\n"
+           "Upgrade: websocket\r\n"
+           "Connection: Upgrade\r\n"
+           "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+           "Sec-WebSocket-Version: 13\r\n\r\n", host, tci_port);
+
+  if (bench_write(c->fd, req, strlen(req)) < 0) { return 0; }
+
+  while (end == 0) {
+    for (int i = 3; i < c->fill; i++) {
+      if (!memcmp(c->buf + i - 3, "\r\n\r\n", 4)) {
+        end = i + 1;
+        break;
+      }
+    }
+
+    if (end == 0 && (now_ns() >= deadline || bench_fill(c, deadline) < 0)) { return 0; }
+  }
+
+  if (end < 12 || memcmp(c->buf, "HTTP/1.1 101", 12)) { return 0; }
+
+  bench_consume(c, end);
+
+  //
+  // The initial report of the radio state ends with "ready;"
+  //
+  do {
+    if (tci_message(c, deadline) <= 0) { return 0; }
+  } while (strcmp(c->reply, "ready;"));
+
+  if (stream != NULL) {
+    if (!strcmp(stream, "iq")) {
+      tci_send(c, "iq_start:0;");
+    } else if (!strcmp(stream, "audio")) {
+      tci_send(c, "audio_start:0;");
+    } else if (!strcmp(stream, "spectrum")) {
+      tci_send(c, "spectrum_start:0,1024,20;");
+    }
+  }
+
+  return 1;
+}
+
+static int tci_request(BENCH_CLIENT *c, int set, long long t0) {
+  char cmd[64];
+  const BENCH_CMD *bc;
+  long long deadline = now_ns() + 1000000LL * timeout_ms;
+
+  if (set) {
+    bc = &tci_sets[rnd_next(c) % (sizeof(tci_sets) / sizeof(tci_sets[0]))];
+    snprintf(cmd, sizeof(cmd), bc->cmd, bc->base + (int)(rnd_next(c) % bc->range));
+  } else {
+    bc = &tci_queries[rnd_next(c) % (sizeof(tci_queries) / sizeof(tci_queries[0]))];
+    snprintf(cmd, sizeof(cmd), "%s", bc->cmd);
+  }
+
+  if (tci_send(c, cmd) < 0) { return -1; }
+
+  c->requests++;
+  size_t n = strlen(bc->reply);
+
+  for (;;) {
+    int rc = tci_message(c, deadline);
+
+    if (rc <= 0) { return rc; }
+
+    if (!strncmp(c->reply, bc->reply, n) && (c->reply[n] == ':' || c->reply[n] == ';')) { break; }
+
+    c->notifications++;
+  }
+
+  lat_add(set ? &c->set : &c->query, now_ns() - t0);
+  return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Client threads
+//
+/////////////////////////////////////////////////////////////////////////////
+
+static int bench_open(BENCH_CLIENT *c) {
+  long long t0 = now_ns();
+  c->fill = 0;
+  c->fd = bench_connect(c->kind == BENCH_CAT ? cat_port : tci_port);
+
+  if (c->fd >= 0 && c->kind == BENCH_TCI && !tci_handshake(c, t0 + 1000000LL * BENCH_CONNECT)) {
+    close(c->fd);
+    c->fd = -1;
+  }
+
+  if (c->fd < 0) {
+    c->refused++;
+    return 0;
+  }
+
+  lat_add(&c->connect, now_ns() - t0);
+  return 1;
+}
+
+static void *bench_thread(void *arg) {
+  BENCH_CLIENT *c = arg;
+  long long period = (rate > 0) ? 1000000000LL / rate : 0;
+  long long next = 0;
+
+  while (running) {
+    if (c->fd < 0) {
+      if (!bench_open(c)) {
+        // try again after one second
+        for (int i = 0; i < 10 && running; i++) { usleep(100000); }
+
+        continue;
+      }
+
+      next = now_ns();
+    }
+
+    int rc = 1;
+
+    if (period > 0) {
+      if (c->kind == BENCH_TCI) {
+        rc = tci_drain(c, next);
+      } else {
+        long long wait = next - now_ns();
+
+        if (wait > 0) { usleep((useconds_t)(wait / 1000)); }
+      }
+    }
+
+    if (rc >= 0 && running) {
+      long long t0 = (period > 0) ? next : now_ns();
+      int set = (int)(rnd_next(c) % 100) < set_percent;
+      next += period;
+      rc = (c->kind == BENCH_CAT) ? cat_request(c, set, t0) : tci_request(c, set, t0);
+
+      if (rc == 0) { c->timeouts++; }
+    }
+
+    //
+    // After a timeout, replies cannot be assigned to requests any more,
+    // so the connection is dropped as well.
+    //
+    if (rc <= 0 && running) {
+      c->drops++;
+      close(c->fd);
+      c->fd = -1;
+    }
+  }
+
+  if (c->fd >= 0) { close(c->fd); }
+
+  return NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// CAT conformance (-conform): every SET and READ form documented in the
+// CATDEF blocks of rigctl.c is sent once, and the replies are checked
+// against the documentation. A READ form must give exactly one reply
+// that matches the documented response, a SET form must give no reply.
+// Each command is followed by ID; such that the end of its replies can
+// be recognized.
+//
+/////////////////////////////////////////////////////////////////////////////
+
+#define CONFORM_FENCE       "ID;"
+#define CONFORM_FENCE_REPLY "ID"       // start of the reply to the fence
+
+//
+// SET forms for which parameters of all zeros make no sense, and
+// forms that must not be sent at all (cmd == NULL)
+//
+static const struct {
+  const char *form;
+  const char *cmd;
+} conform_samples[] = {
+  {"#S;",           NULL},         // would shut down piHPSDR
+  {"KYxyyy...yyy;", "KY TEST;"}    // x must be a blank
+};
+
+static int conform_failed = 0;
+
+//
+// Make a command from a documented form: the parameters
+// (lower-case letters) become '0', a repeated part ("yyy...yyy")
+// is sent once. Returns 0 if the form must not be sent.
+//
+static int conform_fill(char *cmd, size_t size, const char *form) {
+  size_t j = 0;
+
+  for (size_t i = 0; i < sizeof(conform_samples) / sizeof(conform_samples[0]); i++) {
+    if (!strcmp(form, conform_samples[i].form)) {
+      if (conform_samples[i].cmd == NULL) { return 0; }
+
+      snprintf(cmd, size, "%s", conform_samples[i].cmd);
+      return 1;
+    }
+  }
+
+  for (const char *p = form; *p != 0 && j < size - 1; p++) {
+    if (!strncmp(p, "...", 3)) {
+      char rep = p[-1];
+      p += 3;
+
+      while (p[1] == rep) { p++; }
+
+      continue;
+    }
+
+    cmd[j++] = (*p >= 'a' && *p <= 'z') ? '0' : *p;
+  }
+
+  cmd[j] = 0;
+  return 1;
+}
+
+static int conform_match(const char *reply, const char *pattern) {
+  if (strlen(reply) != strlen(pattern)) { return 0; }
+
+  for (; *pattern != 0; pattern++, reply++) {
+    if (*pattern >= 'a' && *pattern <= 'z') {
+      if (*reply == ';') { return 0; }
+    } else if (*reply != *pattern) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+//
+// Send a command followed by the fence, and collect the replies that
+// arrive before the reply to the fence. Returns the number of replies,
+// or -1 on timeout or if the connection is lost.
+//
+static int conform_send(BENCH_CLIENT *c, const char *cmd, char *replies, size_t size) {
+  char buf[128];
+  int fences = strcmp(cmd, CONFORM_FENCE) ? 1 : 2;
+  int n = 0;
+  long long deadline = now_ns() + 1000000LL * timeout_ms;
+  snprintf(buf, sizeof(buf), "%s%s", cmd, CONFORM_FENCE);
+  replies[0] = 0;
+
+  if (bench_write(c->fd, buf, strlen(buf)) < 0) { return -1; }
+
+  for (;;) {
+    if (cat_reply(c, deadline) <= 0) { return -1; }
+
+    if (!strncmp(c->reply, CONFORM_FENCE_REPLY, strlen(CONFORM_FENCE_REPLY)) && --fences == 0) { return n; }
+
+    if (strlen(replies) + strlen(c->reply) < size) { strcat(replies, c->reply); }
+
+    n++;
+  }
+}
+
+static void conform_result(const char *cmd, const char *error, const char *replies) {
+  if (error == NULL) { return; }
+
+  conform_failed++;
+  fprintf(stdout, "FAIL %-20s %s%s%s\n", cmd, error, replies[0] ? ": " : "", replies);
+}
+
+static int cat_conform() {
+  BENCH_CLIENT *c = calloc(1, sizeof(BENCH_CLIENT));
+  char cmd[64];
+  char replies[256];
+  int forms = 0, skipped = 0;
+
+  if (c == NULL) {
+    t_print("Out of memory\n");
+    return 1;
+  }
+
+  c->kind = BENCH_CAT;
+  c->fd = bench_connect(cat_port);
+
+  if (c->fd < 0) {
+    t_print("Cannot connect to the CAT server on %s:%d\n", host, cat_port);
+    return 1;
+  }
+
+  t_print("CAT conformance test on %s:%d\n", host, cat_port);
+
+  for (const CATCONFORM *def = catconform_table; def->name != NULL; def++) {
+    char value[64] = "";
+
+    //
+    // The READ form comes first. If a SET form looks like the response,
+    // the value just read is set, so this does not change the radio state.
+    //
+    if (def->read != NULL && conform_fill(cmd, sizeof(cmd), def->read)) {
+      const char *error = NULL;
+      int n = conform_send(c, cmd, replies, sizeof(replies));
+      forms++;
+
+      if (n < 0) {
+        t_print("%s: no reply to %s, giving up\n", cmd, CONFORM_FENCE);
+        return 1;
+      }
+
+      if (n == 0) {
+        error = "no reply";
+      } else if (n > 1) {
+        error = "more than one reply";
+      } else if (!strcmp(replies, "?;")) {
+        error = "rejected";
+      } else if (def->resp != NULL && !conform_match(replies, def->resp)) {
+        error = "does not match";
+      } else {
+        snprintf(value, sizeof(value), "%s", replies);
+      }
+
+      conform_result(cmd, error, replies);
+    }
+
+    for (int i = 0; i < CATDEF_MAX_FORMS && def->set[i] != NULL; i++) {
+      if (value[0] != 0 && def->resp != NULL && !strcmp(def->set[i], def->resp)) {
+        snprintf(cmd, sizeof(cmd), "%s", value);
+      } else if (!conform_fill(cmd, sizeof(cmd), def->set[i])) {
+        skipped++;
+        continue;
+      }
+
+      int n = conform_send(c, cmd, replies, sizeof(replies));
+      forms++;
+
+      if (n < 0) {
+        t_print("%s: no reply to %s, giving up\n", cmd, CONFORM_FENCE);
+        return 1;
+      }
+
+      conform_result(cmd, n > 0 ? "unexpected reply" : NULL, replies);
+    }
+  }
+
+  //
+  // TX; has been sent, so go back to receive
+  //
+  bench_write(c->fd, "RX;", 3);
+  close(c->fd);
+  fprintf(stdout, "CAT conformance: %d forms sent, %d failed, %d skipped\n", forms, conform_failed, skipped);
+  return conform_failed > 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Report
+//
+/////////////////////////////////////////////////////////////////////////////
+
+static void report_latencies(const char *name, int kind, int which) {
+  LATENCIES all = {NULL, 0, 0};
+
+  for (int i = 0; i < nclients; i++) {
+    const BENCH_CLIENT *c = clients[i];
+    const LATENCIES *l = (which == 0) ? &c->query : (which == 1) ? &c->set : &c->connect;
+
+    if (c->kind != kind) { continue; }
+
+    for (int j = 0; j < l->n; j++) { lat_add(&all, l->ns[j]); }
+  }
+
+  if (all.n == 0) { return; }
+
+  qsort(all.ns, all.n, sizeof(long long), cmp_ns);
+  fprintf(stdout, "%s %-8s %8d %9.1f %9.1f %9.1f %9.1f\n", kind_names[kind], name, all.n,
+          1.0E-3 * all.ns[all.n / 2], 1.0E-3 * all.ns[(all.n * 90) / 100],
+          1.0E-3 * all.ns[(all.n * 99) / 100], 1.0E-3 * all.ns[all.n - 1]);
+  free(all.ns);
+}
+
+static void report_counters(int kind, double seconds) {
+  long requests = 0, errors = 0, timeouts = 0, drops = 0, refused = 0, notifications = 0, frames = 0;
+  long long bytes = 0;
+  int n = 0;
+
+  for (int i = 0; i < nclients; i++) {
+    const BENCH_CLIENT *c = clients[i];
+
+    if (c->kind != kind) { continue; }
+
+    n++;
+    requests += c->requests;
+    errors += c->errors;
+    timeouts += c->timeouts;
+    drops += c->drops;
+    refused += c->refused;
+    notifications += c->notifications;
+    frames += c->stream_frames;
+    bytes += c->stream_bytes;
+  }
+
+  if (n == 0) { return; }
+
+  fprintf(stdout, "%s: %d clients, %ld requests (%.1f/s), %ld errors, %ld timeouts, %ld dropped, %ld refused\n",
+          kind_names[kind], n, requests, requests / seconds, errors, timeouts, drops, refused);
+
+  if (kind == BENCH_TCI) {
+    fprintf(stdout, "TCI: %ld notifications, %ld stream frames (%.1f kB/s)\n",
+            notifications, frames, 1.0E-3 * bytes / seconds);
+  }
+}
+
+//
+// CPU time (user+system) of a process, from /proc
+//
+static int proc_cpu(int pid, double *seconds) {
+  char path[64];
+  char line[1024];
+  unsigned long utime, stime;
+  snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+  FILE *fp = fopen(path, "r");
+
+  if (fp == NULL) { return 0; }
+
+  char *ok = fgets(line, sizeof(line), fp);
+  fclose(fp);
+
+  if (ok == NULL) { return 0; }
+
+  //
+  // The command name may contain blanks, so start after its closing bracket
+  //
+  char *p = strrchr(line, ')');
+
+  if (p == NULL || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                          &utime, &stime) != 2) { return 0; }
+
+  *seconds = (double)(utime + stime) / (double) sysconf(_SC_CLK_TCK);
+  return 1;
+}
+
+static void stop_handler(int sig) {
+  running = 0;
+}
+
+int main(int argc, char *argv[]) {
+  int ncat = 2;
+  int ntci = 2;
+  int duration = 30;
+  int pid = 0;
+  int conform = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-host") && i < argc - 1)    { snprintf(host, sizeof(host), "%s", argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-cat") && i < argc - 1)     { ncat = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-catport") && i < argc - 1) { cat_port = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-tci") && i < argc - 1)     { ntci = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-tciport") && i < argc - 1) { tci_port = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-time") && i < argc - 1)    { duration = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-rate") && i < argc - 1)    { rate = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-set") && i < argc - 1)     { set_percent = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-timeout") && i < argc - 1) { timeout_ms = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-stream") && i < argc - 1)  { stream = argv[++i]; continue; }
+
+    if (!strcmp(argv[i], "-pid") && i < argc - 1)     { pid = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-conform"))                 { conform = 1; continue; }
+
+    t_print("Unknown option: %s\n", argv[i]);
+    t_print("Usage: %s [-host a] [-cat n] [-catport n] [-tci n] [-tciport n] [-time n]\n", argv[0]);
+    t_print("       [-rate n] [-set n] [-timeout n] [-stream iq|audio|spectrum] [-pid n] [-conform]\n");
+    exit(1);
+  }
+
+  if (ncat < 0) { ncat = 0; }
+
+  if (ncat > MAX_BENCH_CLIENTS) { ncat = MAX_BENCH_CLIENTS; }
+
+  if (ntci < 0) { ntci = 0; }
+
+  if (ntci > MAX_BENCH_CLIENTS) { ntci = MAX_BENCH_CLIENTS; }
+
+  if (duration < 1) { duration = 30; }
+
+  if (rate < 0) { rate = 50; }
+
+  if (set_percent < 0 || set_percent > 100) { set_percent = 10; }
+
+  if (timeout_ms < 10) { timeout_ms = 1000; }
+
+  if (stream != NULL && strcmp(stream, "iq") && strcmp(stream, "audio") && strcmp(stream, "spectrum")) {
+    t_print("Unknown stream type: %s\n", stream);
+    exit(1);
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, stop_handler);
+
+  if (conform) { return cat_conform(); }
+
+  double cpu0 = 0.0, cpu1 = 0.0;
+  int have_cpu = (pid > 0) && proc_cpu(pid, &cpu0);
+
+  if (pid > 0 && !have_cpu) { t_print("Cannot read CPU time of process %d\n", pid); }
+
+  t_print("%d CAT clients (port %d), %d TCI clients (port %d) on %s, %d sec, rate=%d/s, set=%d%%%s%s\n",
+          ncat, cat_port, ntci, tci_port, host, duration, rate, set_percent,
+          stream ? ", stream=" : "", stream ? stream : "");
+  long long start = now_ns();
+
+  for (int i = 0; i < ncat + ntci; i++) {
+    BENCH_CLIENT *c = calloc(1, sizeof(BENCH_CLIENT));
+
+    if (c == NULL) {
+      t_print("Out of memory\n");
+      exit(1);
+    }
+
+    c->kind = (i < ncat) ? BENCH_CAT : BENCH_TCI;
+    c->id = (i < ncat) ? i : i - ncat;
+    c->fd = -1;
+    c->rnd = 0x12345678 + 7919 * i;   // reproducible, but different for each client
+    clients[nclients++] = c;
+
+    if (pthread_create(&c->thread, NULL, bench_thread, c) != 0) {
+      t_print("Cannot create client thread\n");
+      exit(1);
+    }
+  }
+
+  while (running && now_ns() - start < 1000000000LL * duration) {
+    usleep(100000);
+  }
+
+  running = 0;
+
+  for (int i = 0; i < nclients; i++) {
+    pthread_join(clients[i]->thread, NULL);
+  }
+
+  double seconds = 1.0E-9 * (now_ns() - start);
+
+  if (have_cpu) { have_cpu = proc_cpu(pid, &cpu1); }
+
+  fprintf(stdout, "%-12s %8s %9s %9s %9s %9s\n", "latency", "count", "p50(us)", "p90(us)", "p99(us)", "max(us)");
+
+  for (int kind = 0; kind < BENCH_KINDS; kind++) {
+    report_latencies("query", kind, 0);
+    report_latencies("set", kind, 1);
+    report_latencies("connect", kind, 2);
+  }
+
+  for (int kind = 0; kind < BENCH_KINDS; kind++) {
+    report_counters(kind, seconds);
+  }
+
+  if (have_cpu) {
+    fprintf(stdout, "CPU use of process %d: %.1f%% of one core\n", pid, 100.0 * (cpu1 - cpu0) / seconds);
+  }
+
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  fprintf(stdout, "CPU use of the load generator: %.1f%% of one core\n",
+          100.0 * (ru.ru_utime.tv_sec + 1.0E-6 * ru.ru_utime.tv_usec +
+                   ru.ru_stime.tv_sec + 1.0E-6 * ru.ru_stime.tv_usec) / seconds);
+  return 0;
+}
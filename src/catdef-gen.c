@@ -0,0 +1,535 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// catdef-gen reads rigctl.c from stdin and writes the CAT command
+// table (catdef_table.c) to stdout. The command syntax is taken from
+// the SET and READ lines of the CATDEF blocks, so adding a new CAT
+// command only needs the CATDEF block (which is needed anyway for
+// the manual).
+//
+// With the option -ids, the header catdef_ids.h is written instead.
+// It enumerates the documented commands (CAT_FA, CAT_ZZFA, ...) in the
+// order of their CATDEF blocks, and parse_cmd() dispatches on these ids.
+//
+// With the option -conform, the table of all SET/READ forms and responses
+// (catconform_table.c) is written, which catbench uses to check a running
+// piHPSDR against the documentation.
+//
+// The table is indexed through a minimal perfect hash ("hash and
+// displace"): the command names are distributed into buckets, and for
+// each bucket a seed is searched such that all its names hash to free
+// slots. A lookup thus needs two hash computations and one string
+// comparison.
+//
+// As a consistency check, the code following each CATDEF block is
+// scanned for tests of the form command[N] == ';', and a warning is
+// issued if N+1 is not a documented length. Errors (duplicate commands,
+// malformed blocks) make the program fail so the build stops.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "catdef.h"
+
+#define MAX_COMMANDS 512
+#define MAX_SEED     100000
+
+typedef struct _command {
+  char name[8];
+  int nforms;
+  int len[CATDEF_MAX_FORMS];
+  int varlen;
+  int readlen;
+  unsigned long long setlen;   // bit mask of the SET form lengths
+  char set[CATDEF_MAX_FORMS][64];  // SET forms as documented
+  int nset;
+  char read[64];               // READ form as documented
+  char resp[64];               // response as documented
+  int line;                    // line number of the CATDEF line
+  int checked[64];             // lengths tested in the code
+  int nchecked;
+} COMMAND;
+
+static COMMAND commands[MAX_COMMANDS];
+static int ncommands = 0;
+static int errors = 0;
+
+//
+// Return the word following a //KEYWORD, with backslashes
+// (LaTeX escapes) removed and trailing blanks/newlines stripped.
+//
+static char *catdef_arg(char *line, const char *keyword) {
+  static char arg[256];
+  char *pos = strstr(line, keyword);
+  int j = 0;
+
+  if (pos == NULL) { return NULL; }
+
+  pos += strlen(keyword);
+
+  while (*pos == ' ') { pos++; }
+
+  while (*pos != 0 && *pos != '\n' && *pos != ' ' && j < (int) sizeof(arg) - 1) {
+    if (*pos != '\\') { arg[j++] = *pos; }
+
+    pos++;
+  }
+
+  arg[j] = 0;
+  return arg;
+}
+
+//
+// Add a SET or READ form to a command. In a form such as KYxyyy...yyy;
+// the repeated letter may occur any number of times, so the minimum
+// length is the length of the part before the first occurence of that
+// letter plus the terminating ';'.
+//
+static void add_form(COMMAND *cmd, const char *form, int is_read, int line) {
+  int len = strlen(form);
+  int namelen = strlen(cmd->name);
+  const char *dots = strstr(form, "...");
+
+  if (strncmp(form, cmd->name, namelen) != 0 || form[len - 1] != ';') {
+    fprintf(stderr, "rigctl.c:%d: %s: malformed form %s\n", line, cmd->name, form);
+    errors++;
+    return;
+  }
+
+  if (is_read) {
+    if (cmd->read[0] == 0) { snprintf(cmd->read, sizeof(cmd->read), "%s", form); }
+  } else if (cmd->nset < CATDEF_MAX_FORMS) {
+    snprintf(cmd->set[cmd->nset++], sizeof(cmd->set[0]), "%s", form);
+  }
+
+  if (dots != NULL && dots > form + namelen) {
+    const char *first = strchr(form + namelen, dots[-1]);
+    cmd->varlen = (first - form) + 1;
+    return;
+  }
+
+  if (is_read) {
+    if (cmd->readlen == 0) { cmd->readlen = len; }
+  } else if (len < 64) {
+    cmd->setlen |= 1ULL << len;
+  }
+
+  for (int i = 0; i < cmd->nforms; i++) {
+    if (cmd->len[i] == len) { return; }
+  }
+
+  if (cmd->nforms >= CATDEF_MAX_FORMS) {
+    fprintf(stderr, "rigctl.c:%d: %s: too many forms\n", line, cmd->name);
+    errors++;
+    return;
+  }
+
+  cmd->len[cmd->nforms++] = len;
+}
+
+//
+// The response of a command. A '|' only marks where the manual
+// may break a long response, it is not part of the response.
+//
+static void add_resp(COMMAND *cmd, const char *resp, int line) {
+  int len = strlen(resp);
+  int j = 0;
+
+  if (strncmp(resp, cmd->name, strlen(cmd->name)) != 0 || resp[len - 1] != ';' || cmd->resp[0] != 0) {
+    fprintf(stderr, "rigctl.c:%d: %s: malformed response %s\n", line, cmd->name, resp);
+    errors++;
+    return;
+  }
+
+  for (int i = 0; i < len && j < (int) sizeof(cmd->resp) - 1; i++) {
+    if (resp[i] != '|') { cmd->resp[j++] = resp[i]; }
+  }
+
+  cmd->resp[j] = 0;
+}
+
+//
+// Note all N from command[N] == ';' in a line of code
+//
+static void scan_code(COMMAND *cmd, const char *line) {
+  const char *pos = line;
+
+  while ((pos = strstr(pos, "command[")) != NULL) {
+    int n;
+    char quote;
+    pos += 8;
+
+    if (sscanf(pos, "%d] == '%c'", &n, &quote) == 2 && quote == ';' && cmd->nchecked < 64) {
+      cmd->checked[cmd->nchecked++] = n + 1;
+    }
+  }
+}
+
+static int documented(const COMMAND *cmd, int len) {
+  for (int i = 0; i < cmd->nforms; i++) {
+    if (cmd->len[i] == len) { return 1; }
+  }
+
+  return cmd->varlen > 0 && len >= cmd->varlen;
+}
+
+//
+// Name of the enum constant of a command: CAT_ followed by the command
+// name, with '#' spelled out as SHARP_
+//
+static const char *catdef_ident(const char *name) {
+  static char ident[32];
+  int j = snprintf(ident, sizeof(ident), "CAT_");
+
+  for (const char *p = name; *p != 0 && j < (int) sizeof(ident) - 7; p++) {
+    if (*p == '#') {
+      j += snprintf(ident + j, sizeof(ident) - j, "SHARP_");
+    } else {
+      ident[j++] = *p;
+    }
+  }
+
+  ident[j] = 0;
+  return ident;
+}
+
+static void write_ids(void) {
+  printf("//\n");
+  printf("// Generated by catdef-gen from the CATDEF blocks in rigctl.c\n");
+  printf("// DO NOT EDIT\n");
+  printf("//\n\n");
+  printf("#ifndef _CATDEF_IDS_H_\n");
+  printf("#define _CATDEF_IDS_H_\n\n");
+  printf("enum _catdef_id_enum {\n");
+  printf("  CAT_UNDOCUMENTED = 0,\n");
+
+  for (int i = 0; i < ncommands; i++) {
+    printf("  %s,\n", catdef_ident(commands[i].name));
+  }
+
+  printf("  CAT_IDS\n");
+  printf("};\n\n");
+  printf("#endif\n");
+}
+
+static void write_string(const char *s) {
+  if (s[0] == 0) {
+    printf("NULL");
+    return;
+  }
+
+  putchar('"');
+
+  for (; *s != 0; s++) {
+    if (*s == '"' || *s == '\\') { putchar('\\'); }
+
+    putchar(*s);
+  }
+
+  putchar('"');
+}
+
+static void write_conform(void) {
+  printf("//\n");
+  printf("// Generated by catdef-gen from the CATDEF blocks in rigctl.c\n");
+  printf("// DO NOT EDIT\n");
+  printf("//\n\n");
+  printf("#include <stddef.h>\n\n");
+  printf("#include \"catdef.h\"\n\n");
+  printf("const CATCONFORM catconform_table[] = {\n");
+
+  for (int i = 0; i < ncommands; i++) {
+    const COMMAND *c = &commands[i];
+    printf("  { ");
+    write_string(c->name);
+    printf(", {");
+
+    for (int j = 0; j < CATDEF_MAX_FORMS; j++) {
+      printf(" ");
+      write_string(j < c->nset ? c->set[j] : "");
+      printf("%s", j < CATDEF_MAX_FORMS - 1 ? "," : " ");
+    }
+
+    printf("}, ");
+    write_string(c->read);
+    printf(", ");
+    write_string(c->resp);
+    printf(" },\n");
+  }
+
+  printf("  { NULL, {");
+
+  for (int j = 0; j < CATDEF_MAX_FORMS; j++) {
+    printf(" NULL%s", j < CATDEF_MAX_FORMS - 1 ? "," : " ");
+  }
+
+  printf("}, NULL, NULL }\n");
+  printf("};\n");
+}
+
+//
+// Construct the minimal perfect hash. seed[b] < 0 means that the only
+// name in bucket b goes to slot -seed[b]-1, otherwise the slot is
+// catdef_hash(name, seed[b]) modulo the number of commands.
+//
+static int make_hash(int *slot, int *seed) {
+  int n = ncommands;
+  int bucket_size[MAX_COMMANDS];
+  int order[MAX_COMMANDS];
+  int used[MAX_COMMANDS];
+  int bucket[MAX_COMMANDS];
+
+  for (int i = 0; i < n; i++) {
+    bucket_size[i] = 0;
+    used[i] = 0;
+    seed[i] = 0;
+    order[i] = i;
+  }
+
+  for (int i = 0; i < n; i++) {
+    const char *name = commands[i].name;
+    bucket[i] = catdef_hash(name, strlen(name), 0) % n;
+    bucket_size[bucket[i]]++;
+  }
+
+  //
+  // Sort buckets by decreasing size, large buckets are placed first
+  //
+  for (int i = 0; i < n; i++) {
+    for (int j = i + 1; j < n; j++) {
+      if (bucket_size[order[j]] > bucket_size[order[i]]) {
+        int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+      }
+    }
+  }
+
+  for (int k = 0; k < n && bucket_size[order[k]] > 1; k++) {
+    int b = order[k];
+    int members[MAX_COMMANDS];
+    int m = 0;
+    int s;
+
+    for (int i = 0; i < n; i++) {
+      if (bucket[i] == b) { members[m++] = i; }
+    }
+
+    for (s = 1; s < MAX_SEED; s++) {
+      int ok = 1;
+
+      for (int i = 0; i < m && ok; i++) {
+        const char *name = commands[members[i]].name;
+        slot[members[i]] = catdef_hash(name, strlen(name), s) % n;
+
+        if (used[slot[members[i]]]) { ok = 0; }
+
+        for (int j = 0; j < i && ok; j++) {
+          if (slot[members[j]] == slot[members[i]]) { ok = 0; }
+        }
+      }
+
+      if (ok) { break; }
+    }
+
+    if (s >= MAX_SEED) { return -1; }
+
+    seed[b] = s;
+
+    for (int i = 0; i < m; i++) {
+      used[slot[members[i]]] = 1;
+    }
+  }
+
+  //
+  // Buckets with a single name go directly to the free slots
+  //
+  int free_slot = 0;
+
+  for (int i = 0; i < n; i++) {
+    if (bucket_size[bucket[i]] != 1) { continue; }
+
+    while (used[free_slot]) { free_slot++; }
+
+    used[free_slot] = 1;
+    slot[i] = free_slot;
+    seed[bucket[i]] = -free_slot - 1;
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  char line[1024];
+  int lineno = 0;
+  COMMAND *cmd = NULL;         // command whose CATDEF block is being read
+  COMMAND *code = NULL;        // command whose code is being scanned
+  int slot[MAX_COMMANDS];
+  int seed[MAX_COMMANDS];
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    char *arg;
+    lineno++;
+
+    if ((arg = catdef_arg(line, "//CATDEF")) != NULL) {
+      if (ncommands >= MAX_COMMANDS) {
+        fprintf(stderr, "rigctl.c:%d: too many commands\n", lineno);
+        return 1;
+      }
+
+      for (int i = 0; i < ncommands; i++) {
+        if (strcmp(commands[i].name, arg) == 0) {
+          fprintf(stderr, "rigctl.c:%d: %s already defined in line %d\n", lineno, arg, commands[i].line);
+          errors++;
+        }
+      }
+
+      cmd = &commands[ncommands++];
+      memset(cmd, 0, sizeof(COMMAND));
+      strncpy(cmd->name, arg, sizeof(cmd->name) - 1);
+      cmd->line = lineno;
+      code = NULL;
+
+      if ((int) strlen(cmd->name) != catdef_namelen(cmd->name)) {
+        fprintf(stderr, "rigctl.c:%d: illegal command name %s\n", lineno, cmd->name);
+        errors++;
+      }
+
+      continue;
+    }
+
+    if (cmd != NULL) {
+      if ((arg = catdef_arg(line, "//SET")) != NULL) { add_form(cmd, arg, 0, lineno); }
+
+      if ((arg = catdef_arg(line, "//READ")) != NULL) { add_form(cmd, arg, 1, lineno); }
+
+      if ((arg = catdef_arg(line, "//RESP")) != NULL) { add_resp(cmd, arg, lineno); }
+
+      if (strstr(line, "//ENDDEF") != NULL) {
+        //
+        // A READ form that cannot be told from a SET form is not a query
+        //
+        if (cmd->readlen > 0 && ((cmd->setlen >> cmd->readlen) & 1)) { cmd->readlen = 0; }
+
+        if (cmd->varlen > 0 && cmd->readlen >= cmd->varlen) { cmd->readlen = 0; }
+
+        code = cmd;
+        cmd = NULL;
+      }
+
+      continue;
+    }
+
+    //
+    // The code of a command ends with the next case label
+    // (or the next CATDEF block)
+    //
+    if (code != NULL) {
+      if (strstr(line, "case CAT_") != NULL || strstr(line, "case '") != NULL || strstr(line, "default:") != NULL) {
+        code = NULL;
+      } else {
+        scan_code(code, line);
+      }
+    }
+  }
+
+  if (cmd != NULL) {
+    fprintf(stderr, "rigctl.c: CATDEF block of %s not terminated\n", cmd->name);
+    errors++;
+  }
+
+  if (ncommands == 0) {
+    fprintf(stderr, "rigctl.c: no CATDEF blocks found\n");
+    errors++;
+  }
+
+  for (int i = 0; i < ncommands; i++) {
+    for (int j = 0; j < commands[i].nchecked; j++) {
+      if (!documented(&commands[i], commands[i].checked[j])) {
+        fprintf(stderr, "rigctl.c:%d: warning: %s: code accepts length %d which is not documented\n",
+                commands[i].line, commands[i].name, commands[i].checked[j]);
+      }
+    }
+  }
+
+  if (errors > 0) { return 1; }
+
+  if (argc > 1 && !strcmp(argv[1], "-ids")) {
+    write_ids();
+    return 0;
+  }
+
+  if (argc > 1 && !strcmp(argv[1], "-conform")) {
+    write_conform();
+    return 0;
+  }
+
+  if (make_hash(slot, seed) < 0) {
+    fprintf(stderr, "catdef-gen: no perfect hash found\n");
+    return 1;
+  }
+
+  printf("//\n");
+  printf("// Generated by catdef-gen from the CATDEF blocks in rigctl.c\n");
+  printf("// DO NOT EDIT\n");
+  printf("//\n\n");
+  printf("#include <string.h>\n\n");
+  printf("#include \"catdef.h\"\n");
+  printf("#include \"catdef_ids.h\"\n\n");
+  printf("#define CATDEF_COUNT %d\n\n", ncommands);
+  printf("static const CATDEF catdef_table[CATDEF_COUNT] = {\n");
+
+  for (int s = 0; s < ncommands; s++) {
+    for (int i = 0; i < ncommands; i++) {
+      const COMMAND *c = &commands[i];
+
+      if (slot[i] != s) { continue; }
+
+      printf("  { \"%s\", %s, %d, {", c->name, catdef_ident(c->name), c->nforms);
+
+      for (int j = 0; j < CATDEF_MAX_FORMS; j++) {
+        printf(" %d%s", c->len[j], j < CATDEF_MAX_FORMS - 1 ? "," : " ");
+      }
+
+      printf("}, %d, %d },\n", c->varlen, c->readlen);
+    }
+  }
+
+  printf("};\n\n");
+  printf("static const int catdef_seed[CATDEF_COUNT] = {");
+
+  for (int i = 0; i < ncommands; i++) {
+    printf("%s%d%s", (i % 12) == 0 ? "\n  " : " ", seed[i], i < ncommands - 1 ? "," : "\n");
+  }
+
+  printf("};\n\n");
+  printf("const CATDEF *catdef_lookup(const char *command) {\n");
+  printf("  int len = catdef_namelen(command);\n\n");
+  printf("  for (int i = 0; i < len; i++) {\n");
+  printf("    if (command[i] == 0) { return NULL; }\n");
+  printf("  }\n\n");
+  printf("  int s = catdef_seed[catdef_hash(command, len, 0) %% CATDEF_COUNT];\n");
+  printf("  const CATDEF *def = &catdef_table[s < 0 ? -s - 1 : (int)(catdef_hash(command, len, s) %% CATDEF_COUNT)];\n\n");
+  printf("  if (strncmp(def->name, command, len) != 0 || def->name[len] != 0) { return NULL; }\n\n");
+  printf("  return def;\n");
+  printf("}\n");
+  return 0;
+}
@@ -0,0 +1,110 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _CATDEF_H_
+#define _CATDEF_H_
+
+//
+// Table of the CAT commands documented in the CATDEF blocks in rigctl.c.
+// The table (src/catdef_table.c) is generated by catdef-gen at build time,
+// so the documentation is the only place where the command syntax is
+// written down.
+//
+// For each command, the lengths (including the terminating ';') of all
+// documented SET and READ forms are stored. If a form contains a
+// variable-length part ("yyy...yyy", only KY so far), varlen is the minimum
+// length of this form and any longer command is accepted as well.
+// readlen is the length of the READ form, such that queries can be
+// recognized. It is zero if there is no READ form, or if a SET form
+// has the same length.
+// id is the enum constant from the generated catdef_ids.h, it is used
+// to dispatch the command.
+//
+#define CATDEF_MAX_FORMS 4
+
+typedef struct _catdef {
+  const char *name;            // "FA", "ZZFA", "#S"
+  int id;                      // CAT_FA, CAT_ZZFA, CAT_SHARP_S
+  int nforms;                  // number of SET and READ forms
+  int len[CATDEF_MAX_FORMS];
+  int varlen;                  // 0 if there is no variable-length form
+  int readlen;                 // 0 if there is no (unambiguous) READ form
+} CATDEF;
+
+//
+// The SET and READ forms and the response of each command exactly as
+// written in its CATDEF block (lower-case letters stand for parameter
+// characters, NULL if there is no such form). This table
+// (src/catconform_table.c) is generated by catdef-gen -conform and is
+// only used by catbench -conform, which sends all forms to a running
+// piHPSDR and checks the replies. The table ends with name == NULL.
+//
+typedef struct _catconform {
+  const char *name;
+  const char *set[CATDEF_MAX_FORMS];
+  const char *read;
+  const char *resp;
+} CATCONFORM;
+
+extern const CATCONFORM catconform_table[];
+
+//
+// FNV-1a hash of the command name. It is used both by catdef-gen to
+// construct a minimal perfect hash and by catdef_lookup() at run time.
+// A non-zero seed replaces the FNV offset basis.
+//
+static inline unsigned int catdef_hash(const char *name, int len, unsigned int seed) {
+  unsigned int h = seed ? seed : 2166136261U;
+
+  for (int i = 0; i < len; i++) {
+    h = (h ^ (unsigned char) name[i]) * 16777619U;
+  }
+
+  return h;
+}
+
+//
+// Length of the command name: four characters for the ZZ commands,
+// two characters for all others.
+//
+static inline int catdef_namelen(const char *command) {
+  return (command[0] == 'Z' && command[1] == 'Z') ? 4 : 2;
+}
+
+//
+// catdef_lookup() returns the table entry of the command, or NULL if
+// the command is not documented.
+//
+extern const CATDEF *catdef_lookup(const char *command);
+
+//
+// catdef_valid() returns 1 if the length of the command matches one of
+// its documented forms, 0 if it does not, and -1 if the command is not
+// documented (def == NULL) or has no SET/READ forms.
+//
+static inline int catdef_valid(const CATDEF *def, int len) {
+  if (def == NULL || (def->nforms == 0 && def->varlen == 0)) { return -1; }
+
+  for (int i = 0; i < def->nforms; i++) {
+    if (def->len[i] == len) { return 1; }
+  }
+
+  return def->varlen > 0 && len >= def->varlen;
+}
+
+#endif
@@ -54,8 +54,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
 #include <net/if.h>
@@ -70,12 +72,16 @@
 #include <fcntl.h>
 #include <math.h>
 #include <errno.h>
+#include <limits.h>
 #include <openssl/rand.h>
 #include <openssl/sha.h>
 
 #include "adc.h"
 #include "audio.h"
+#include "audio_codec.h"
 #include "client_server.h"
+#include "command_batch.h"
+#include "command_queue.h"
 #include "band.h"
 #include "dac.h"
 #include "diversity_menu.h"
@@ -84,17 +90,22 @@
 #include "ext.h"
 #include "filter.h"
 #include "iambic.h"
+#include "jitter_buffer.h"
 #include "main.h"
 #include "message.h"
+#include "net_poll.h"
 #include "new_protocol.h"
 #include "noise_menu.h"
+#include "notify.h"
 #include "radio.h"
 #include "radio_menu.h"
 #include "receiver.h"
+#include "remote_dsp.h"
 #include "sliders.h"
 #ifdef SOAPYSDR
   #include "soapy_protocol.h"
 #endif
+#include "spectrum_codec.h"
 #include "store.h"
 #include "store_menu.h"
 #include "transmitter.h"
@@ -113,9 +124,36 @@ static uint8_t syncbytes[4] = {0xFA, 0xFA, 0xAF, 0xAF};
 
 int listen_port = LISTEN_PORT;
 
-REMOTE_CLIENT remoteclient = { 0 };
+REMOTE_CLIENT remoteclients[MAX_REMOTE_CLIENTS];
+int remote_clients = 0;     // number of running clients
 
-GMutex client_mutex;
+GMutex client_mutex;        // protects remoteclients[]
+
+//
+// These are incremented whenever the RX audio or spectrum streams
+// have to be set up again (see remote_rxaudio and remote_send_rxspectrum)
+//
+static volatile int audio_config_gen = 1;
+static volatile int spectrum_config_gen = 1;
+
+static guint periodic_timer_id = 0;
+
+//
+// Link statistics (see link_stats.h). If remote_link_log is set, they are
+// written to LINK_STATS_FILE every LINK_STATS_INTERVAL seconds.
+//
+#define LINK_STATS_FILE "link_stats.jsonl"
+
+int remote_link_log = 0;
+static guint link_timer_id = 0;
+
+//
+// Server side: the initial sync is collected by "sending" it to
+// REMOTE_CAPTURE, which appends to capture_buffer.
+//
+static GMutex capture_mutex;
+static GByteArray *capture_buffer = NULL;
+static int old_cw_keyer_internal;
 
 static char title[256];
 
@@ -132,28 +170,162 @@ static int server_running = 0;
 static int client_running = 0;
 static int listen_socket = -1;
 
+//
+// Server I/O: one thread does all the network I/O with the clients,
+// and commands are passed on to the GTK thread through a queue.
+//
+#define SERVER_COMMANDS   256       // max. commands waiting for the GTK thread
+#define REMOTE_INPUT_SIZE 65536     // input buffer, larger than any packet
+#define IO_IOV_MAX        64        // max. packets sent with one system call
+
+#ifdef MSG_NOSIGNAL
+  #define IO_SEND_FLAGS MSG_NOSIGNAL
+#else
+  #define IO_SEND_FLAGS 0
+#endif
+
+static GThread *io_thread_id;
+static NET_POLL *io_poll = NULL;
+static int io_pipe[2] = { -1, -1 };
+static COMMAND_QUEUE server_commands;
+
+//
+// State changes on the server side (e.g. from CAT, TCI or the knobs
+// at the radio) are pushed to the clients. What has last been
+// broadcast is remembered, such that only real changes are sent.
+//
+static int server_notify_id = 0;
+static VFO_DATA server_vfo_sent[2];
+static int server_split_sent = -1;
+static int server_mox_sent = -1;
+
+//
+// The optional UDP side channel uses one socket (bound to the listen port)
+// for all clients. Clients are told apart by the token they got over TCP.
+//
+static int udp_socket = -1;
+
 //
 // Audio
 //
-#define MIC_RING_BUFFER_SIZE 9600
-#define MIC_RING_LOW         3000
+// Mic samples from the client go through an adaptive jitter buffer, which
+// also compensates the clock difference between the client's sound card
+// and the radio. The same is done on the client side for RX audio, where
+// the samples are played out by a thread (one block of AUDIO_PLAYOUT_SIZE
+// samples at a time) running on the local clock.
+//
+#define AUDIO_PLAYOUT_SIZE 128
 
-static short *mic_ring_buffer;
-static volatile short  mic_ring_outpt = 0;
-static volatile short  mic_ring_inpt = 0;
+static JITTER_BUFFER *mic_jitter_buffer = NULL;
+static JITTER_BUFFER *rxaudio_jitter_buffer[2] = { NULL, NULL };
+static GThread *playout_thread_id = NULL;
 
 static int txaudio_buffer_index = 0;
-static int rxaudio_buffer_index[2] = { 0, 0};
-RXAUDIO_DATA rxaudio_data[2];  // for up to 2 receivers
 
 TXAUDIO_DATA txaudio_data;
 
+//
+// Compressed RX audio. The encoders are only used in the RX thread(s)
+// of the server, the decoders only in the client thread.
+//
+int remote_audio_choice = 1;  // client side: index into audio_codec_choices
+int remote_audio_frame = 240; // client side: samples per audio packet (RX and TX)
+static CODED_RXAUDIO_DATA coded_rxaudio_data[2];
+static AUDIO_CODEC *rxaudio_decoder[2] = { NULL, NULL };
+
+//
+// Compressed spectrum, client side. remote_spectrum_choice selects
+// the resolution (0: full, 1: reduced, 2: low bandwidth).
+//
+int remote_spectrum_choice = 1;
+static SPECTRUM_CODEC *spectrum_decoder[SPECTRUM_TX + 1];
+static SPECTRUM_FORMAT client_spectrum_format[SPECTRUM_TX + 1];
+static int client_audio_frame[2] = { 0, 0 };  // samples in the last RX audio packet
+static GMutex media_mutex;
+
+//
+// UDP side channel, client side. remote_transport selects TCP only (0),
+// UDP (1) or UDP with FEC for the audio (2). Control data always goes
+// over TCP. Setting the environment variable PIHPSDR_UDP_LOSS to a
+// percentage drops that many received datagrams (for testing).
+//
+#define UDP_FEC_GROUP 4
+
+int remote_transport = 0;
+static int udp_client_socket = -1;
+static int udp_running = FALSE;
+static GThread *udp_thread_id = NULL;
+static struct sockaddr_in udp_server_address;
+static uint32_t udp_client_token;
+static UDP_RECEIVER *udp_receiver[UDP_CHANNELS];
+static gint64 udp_keyframe_time[SPECTRUM_TX + 1];
+static int udp_loss = 0;
+static long udp_audio_lost = 0;
+static long udp_audio_recovered = 0;
+static long client_spectrum_lost = 0;
+
+//
+// Client side: radio state of the last session with this server (see
+// state_cache.h). The sections of the initial sync are put into
+// client_replay, from which recv_bytes() reads before it reads from
+// the socket. So they are processed exactly as if they came from the
+// server one by one.
+//
+static STATE_SNAPSHOT client_state;
+static char client_state_file[256];
+static GByteArray *client_replay = NULL;
+static guint client_replay_pos = 0;
+
+//
+// Remote IQ, client side. remote_iq_choice selects whether the server
+// demodulates (0), or the client gets IQ data at 48 kHz (1) or at the
+// full sample rate (2, this also feeds the panadapter).
+//
+int remote_iq_choice = 0;
+static int client_iq_rate[2] = { 0, 0 };
+
+//
+// RX audio statistics. On the server this counts what has been sent,
+// on the client what has been received. The figures are updated every
+// AUDIO_STATS_INTERVAL seconds and logged every AUDIO_STATS_LOG seconds.
+//
+#define AUDIO_STATS_INTERVAL 2
+#define AUDIO_STATS_LOG      60
+
+typedef struct _audio_stats {
+  GMutex mutex;
+  int codec;
+  int bitrate;
+  int frame;                  // samples per packet
+  gint64 start;               // start of the current interval (usec)
+  gint64 last_log;
+  long long bytes;            // bytes transferred in the current interval
+  int packets;
+  gint64 codec_time;          // usec spent in encoder or decoder
+  uint32_t delay_base;        // client only: offset between server and client clock
+  int delay_min;              // client only: transport delay relative to delay_base (msec)
+  int delay_max;
+  long long delay_sum;
+  //
+  // Results of the last complete interval
+  //
+  double kbps;
+  double codec_ms;            // per packet
+  double jitter_ms;           // client only: average transport delay above the minimum
+  double max_jitter_ms;       // client only: maximum transport delay above the minimum
+} AUDIO_STATS;
+
+static AUDIO_STATS audio_stats;
+
 static int remote_command(void * data);
 
-static GMutex accumulated_mutex;
-static int accumulated_steps[2] = {0, 0};
-static long long accumulated_hz[2] = {0LL, 0LL};
-static int accumulated_round[2] = {FALSE, FALSE};
+//
+// Client side: settings are coalesced and sent every CLIENT_BATCH_TICK msec.
+// All sending on the client is serialised by send_mutex.
+//
+static GMutex send_mutex;
+static COMMAND_BATCH client_batch;
+static int client_batching = FALSE;
 guint check_vfo_timer_id = 0;
 
 //
@@ -334,6 +506,17 @@ static int recv_bytes(int s, char *buffer, int bytes) {
   int bytes_read = 0;
   int count = 0;
 
+  if (client_replay != NULL && s == client_socket) {
+    bytes_read = MIN(bytes, (int)(client_replay->len - client_replay_pos));
+    memcpy(buffer, client_replay->data + client_replay_pos, bytes_read);
+    client_replay_pos += bytes_read;
+
+    if (client_replay_pos >= client_replay->len) {
+      g_byte_array_free(client_replay, TRUE);
+      client_replay = NULL;
+    }
+  }
+
   while (bytes_read != bytes) {
     int rc = recv(s, &buffer[bytes_read], bytes - bytes_read, 0);
 
@@ -348,14 +531,6 @@ static int recv_bytes(int s, char *buffer, int bytes) {
       t_print("%s: read %d bytes, but expected %d.\n", __FUNCTION__, bytes_read, bytes);
       bytes_read = -1;
       t_perror("recv_bytes");
-
-      if (!radio_is_remote) {
-        //
-        // This is the server. Note client's death.
-        //
-        remoteclient.running = FALSE;
-      }
-
       break;
     } else {
       bytes_read += rc;
@@ -365,19 +540,123 @@ static int recv_bytes(int s, char *buffer, int bytes) {
   return bytes_read;
 }
 
+static void io_wakeup(void *arg);
+
 //
-// This function is called from within the GTK queue but
-// also from the receive thread (via remote_rxaudio).
-// To make this bullet proof, we need a mutex here in case a
-// remote_rxaudio occurs while sending another packet.
+// Stop a client: nothing more is queued for it, and the I/O thread
+// removes it.
 //
-static int send_bytes(int s, char *buffer, int bytes) {
-  static GMutex send_mutex;  // static so correctly initialised
-  int bytes_sent = 0;
+static void client_disconnect(REMOTE_CLIENT *client) {
+  client->running = FALSE;
+  send_queue_close(&client->queue);
+  shutdown(client->socket, SHUT_RDWR);
+  io_wakeup(NULL);
+}
 
-  if (s < 0) { return -1; }
+//
+// Send an audio or spectrum packet as a datagram, followed by the parity
+// datagram if this completes a FEC group. This never blocks: if the
+// socket buffer is full, the datagram is lost, and the client deals with
+// that. Called with client_mutex locked.
+//
+static void client_udp_send(REMOTE_CLIENT *client, SEND_PACKET *p) {
+  UDP_SENDER *sender = &client->udp_sender[p->channel];
+  UDP_HEADER hdr, parity_hdr;
+  struct iovec iov[2];
+  struct msghdr msg;
+  udp_header_init(&hdr, UDP_DATA, p->channel, client->udp_token);
+  int parity = udp_sender_packet(sender, p->data, p->len, &hdr, &parity_hdr);
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = &client->udp_address;
+  msg.msg_namelen = sizeof(client->udp_address);
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 2;
+  iov[0].iov_base = &hdr;
+  iov[0].iov_len = sizeof(hdr);
+  iov[1].iov_base = p->data;
+  iov[1].iov_len = p->len;
+
+  if (sendmsg(udp_socket, &msg, MSG_DONTWAIT | IO_SEND_FLAGS) < 0) { client->udp_dropped++; }
+
+  if (parity > 0) {
+    iov[0].iov_base = &parity_hdr;
+    iov[1].iov_base = sender->parity;
+    iov[1].iov_len = parity;
+
+    if (sendmsg(udp_socket, &msg, MSG_DONTWAIT | IO_SEND_FLAGS) < 0) { client->udp_dropped++; }
+  }
+}
 
-  g_mutex_lock(&send_mutex);
+//
+// Message class of a packet, for the link statistics
+//
+static int link_class(const uint8_t *packet) {
+  const HEADER *header = (const HEADER *)packet;
+
+  switch (from_short(header->data_type)) {
+  case INFO_RXAUDIO:
+  case INFO_RXAUDIO_CODED:
+  case INFO_TXAUDIO:
+    return LINK_AUDIO;
+
+  case INFO_IQ:
+    return LINK_IQ;
+
+  case INFO_RX_SPECTRUM:
+  case INFO_TX_SPECTRUM:
+  case INFO_SPECTRUM_CODED:
+    return LINK_SPECTRUM;
+
+  default:
+    return LINK_CONTROL;
+  }
+}
+
+//
+// Queue a packet for a client. Called with client_mutex locked.
+//
+static void client_queue_push(REMOTE_CLIENT *client, SEND_PACKET *p) {
+  link_stats_tx(&client->link, link_class(p->data), p->len);
+
+  if (client->queue.bytes > client->link.queue_max) { client->link.queue_max = client->queue.bytes; }
+
+  if (client->udp_active && p->channel >= 0 && p->len <= UDP_MAX_PAYLOAD) {
+    client_udp_send(client, p);
+    return;
+  }
+
+  if (send_queue_push(&client->queue, p) < 0) {
+    t_print("%s: client cannot keep up, disconnecting\n", __FUNCTION__);
+    client_disconnect(client);
+  }
+}
+
+//
+// Queue a packet for one client (identified by its socket) or all clients.
+// Returns FALSE if there is no such client.
+//
+static int server_queue(int s, SEND_PACKET *p) {
+  int found = FALSE;
+  g_mutex_lock(&client_mutex);
+
+  for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+    REMOTE_CLIENT *client = &remoteclients[i];
+
+    if (client->running && (s == REMOTE_BROADCAST || s == client->socket)) {
+      client_queue_push(client, p);
+      found = TRUE;
+    }
+  }
+
+  g_mutex_unlock(&client_mutex);
+  return found;
+}
+
+//
+// Blocking send of a complete buffer. Called with send_mutex locked.
+//
+static int send_all(int s, const char *buffer, int bytes) {
+  int bytes_sent = 0;
 
   while (bytes_sent != bytes) {
     int rc = send(s, &buffer[bytes_sent], bytes - bytes_sent, 0);
@@ -388,53 +667,213 @@ static int send_bytes(int s, char *buffer, int bytes) {
       t_print("%s: sent %d bytes, but tried %d.\n", __FUNCTION__, bytes_sent, bytes);
       bytes_sent = -1;
       t_perror("send_bytes");
-
-      if (!radio_is_remote) {
-        //
-        // This is the server. Note client's death.
-        //
-        remoteclient.running = FALSE;
-      }
-
       break;
     } else {
       bytes_sent += rc;
     }
   }
 
-  g_mutex_unlock(&send_mutex);
   return bytes_sent;
 }
 
-short remote_get_mic_sample() {
-  //
-  // return one sample from the  microphone audio ring buffer
-  // If it is empty, return a zero, and continue to return
-  // zero until it is at least filled with  MIC_RING_LOW samples
-  //
-  short sample;
-  static int is_empty = 1;
-  int numsamples = mic_ring_outpt - mic_ring_inpt;
+//
+// Client side: the commands the client coalesces, and what makes two
+// commands "the same setting". Commands that move a VFO are in one
+// group per VFO, since their order matters.
+//
+enum _batch_key_enum {
+  BATCH_KEY_TYPE = 0,       // one setting per command type
+  BATCH_KEY_B1,             // receiver/VFO in header.b1
+  BATCH_KEY_B1B2,           // e.g. mode and filter
+  BATCH_KEY_ID,             // receiver in the byte following the header
+  BATCH_KEY_VFO             // VFO in header.b1, VFO group
+};
+
+static void batch_merge_step(uint8_t *pending, const uint8_t *command, int len) {
+  HEADER p, c;
+  memcpy(&p, pending, sizeof(HEADER));
+  memcpy(&c, command, sizeof(HEADER));
+  int steps = from_short(p.s1) + from_short(c.s1);
+
+  if (steps > 32767) { steps = 32767; }
+
+  if (steps < -32767) { steps = -32767; }
+
+  p.s1 = to_short(steps);
+  memcpy(pending, &p, sizeof(HEADER));
+}
+
+static void batch_merge_move(uint8_t *pending, const uint8_t *command, int len) {
+  U64_COMMAND p, c;
+  memcpy(&p, pending, sizeof(U64_COMMAND));
+  memcpy(&c, command, sizeof(U64_COMMAND));
+  p.header.b2 = c.header.b2;   // the last "round" flag wins
+  p.u64 = to_ll(from_ll(p.u64) + from_ll(c.u64));
+  memcpy(pending, &p, sizeof(U64_COMMAND));
+}
+
+static const struct {
+  int type;
+  int key;
+  COMMAND_MERGE merge;
+} batch_commands[] = {
+  { CMD_AGC_GAIN,       BATCH_KEY_ID,   NULL },
+  { CMD_AMCARRIER,      BATCH_KEY_TYPE, NULL },
+  { CMD_ATTENUATION,    BATCH_KEY_B1,   NULL },
+  { CMD_COMPRESSOR,     BATCH_KEY_TYPE, NULL },
+  { CMD_DEVIATION,      BATCH_KEY_B1,   NULL },
+  { CMD_DEXP,           BATCH_KEY_TYPE, NULL },
+  { CMD_DIGIMAX,        BATCH_KEY_TYPE, NULL },
+  { CMD_DIVERSITY,      BATCH_KEY_TYPE, NULL },
+  { CMD_DRIVE,          BATCH_KEY_TYPE, NULL },
+  { CMD_FILTER_VAR,     BATCH_KEY_B1B2, NULL },
+  { CMD_FREQ,           BATCH_KEY_VFO,  NULL },
+  { CMD_MICGAIN,        BATCH_KEY_TYPE, NULL },
+  { CMD_MOVE,           BATCH_KEY_VFO,  batch_merge_move },
+  { CMD_MOVETO,         BATCH_KEY_VFO,  NULL },
+  { CMD_NOISE,          BATCH_KEY_ID,   NULL },
+  { CMD_PAN,            BATCH_KEY_B1,   NULL },
+  { CMD_RFGAIN,         BATCH_KEY_B1,   NULL },
+  { CMD_RIT,            BATCH_KEY_B1,   NULL },
+  { CMD_RX_EQ,          BATCH_KEY_ID,   NULL },
+  { CMD_RX_FILTER_CUT,  BATCH_KEY_B1,   NULL },
+  { CMD_SIDETONEFREQ,   BATCH_KEY_TYPE, NULL },
+  { CMD_SQUELCH,        BATCH_KEY_B1,   NULL },
+  { CMD_STEP,           BATCH_KEY_VFO,  batch_merge_step },
+  { CMD_TX_EQ,          BATCH_KEY_TYPE, NULL },
+  { CMD_TX_FILTER_CUT,  BATCH_KEY_TYPE, NULL },
+  { CMD_VOLUME,         BATCH_KEY_B1,   NULL },
+  { CMD_XIT,            BATCH_KEY_B1,   NULL },
+  { CMD_ZOOM,           BATCH_KEY_B1,   NULL },
+};
+
+//
+// Put a command into the batch. Returns FALSE if the command is not
+// coalesced (or the batch is full) and has to be sent right away.
+// Called with send_mutex locked.
+//
+static int client_batch_add(const char *buffer, int bytes) {
+  HEADER header;
+
+  if (bytes < (int)sizeof(HEADER)) { return FALSE; }
+
+  memcpy(&header, buffer, sizeof(HEADER));
+  int type = from_short(header.data_type);
+
+  for (size_t i = 0; i < G_N_ELEMENTS(batch_commands); i++) {
+    if (batch_commands[i].type != type) { continue; }
+
+    uint32_t key = (uint32_t)type << 16;
+    uint32_t group;
+
+    switch (batch_commands[i].key) {
+    case BATCH_KEY_B1:
+      key |= header.b1;
+      break;
+
+    case BATCH_KEY_B1B2:
+      key |= (header.b1 << 8) | header.b2;
+      break;
+
+    case BATCH_KEY_ID:
+      if (bytes > (int)sizeof(HEADER)) { key |= (uint8_t)buffer[sizeof(HEADER)]; }
+
+      break;
 
-  if (numsamples < 0) { numsamples += MIC_RING_BUFFER_SIZE; }
+    case BATCH_KEY_VFO:
+      key |= header.b1;
+      break;
+    }
+
+    group = (batch_commands[i].key == BATCH_KEY_VFO) ? 0x80000000U | header.b1 : key;
+    return command_batch_add(&client_batch, key, group, buffer, bytes, batch_commands[i].merge);
+  }
+
+  return FALSE;
+}
+
+//
+// Send the pending commands: a single one as it is, several in a CMD_BATCH
+// packet. Called with send_mutex locked.
+//
+static void client_batch_flush(int s) {
+  uint8_t packet[sizeof(HEADER) + COMMAND_BATCH_SIZE];
+
+  if (client_batch.count == 0) { return; }
+
+  if (client_batch.count == 1) {
+    send_all(s, (char *)client_batch.data, client_batch.length);
+  } else {
+    HEADER header;
+    memset(&header, 0, sizeof(HEADER));
+    SYNC(header.sync);
+    header.data_type = to_short(CMD_BATCH);
+    header.b1 = client_batch.count;
+    header.s1 = to_short(client_batch.length);
+    memcpy(packet, &header, sizeof(HEADER));
+    memcpy(packet + sizeof(HEADER), client_batch.data, client_batch.length);
+    send_all(s, (char *)packet, sizeof(HEADER) + client_batch.length);
+  }
+
+  command_batch_clear(&client_batch);
+}
+
+//
+// This sends a packet. On the server, once the client is running, the packet
+// goes to the send queue of the client, and the I/O thread does the
+// actual sending, such that neither the GTK thread nor the
+// RX thread ever wait for the network. Otherwise (on the client, and during
+// the handshake on the server) this does a blocking send, which is
+// protected by a mutex. On the client, settings are not sent right away
+// but collected in a batch. Any other command sends the batch first, so
+// the order is kept.
+//
+static int send_bytes(int s, char *buffer, int bytes) {
+  int bytes_sent;
+
+  if (s == REMOTE_CAPTURE) {
+    g_byte_array_append(capture_buffer, (guint8 *)buffer, bytes);
+    return bytes;
+  }
+
+  if (s == REMOTE_BROADCAST || (!radio_is_remote && remote_clients > 0)) {
+    SEND_PACKET *p = send_packet_new(SEND_CONTROL, buffer, bytes);
+    int found = server_queue(s, p);
+    send_packet_unref(p);
 
-  if (numsamples <= 0) { is_empty = 1; }
+    if (found || s == REMOTE_BROADCAST) { return bytes; }
+  }
+
+  if (s < 0) { return -1; }
+
+  g_mutex_lock(&send_mutex);
+
+  if (client_batching && s == client_socket) {
+    if (client_batch_add(buffer, bytes)) {
+      g_mutex_unlock(&send_mutex);
+      return bytes;
+    }
 
-  if (is_empty && numsamples < MIC_RING_LOW) {
-    return 0;
+    client_batch_flush(s);
   }
 
-  is_empty = 0;
-  int newpt = mic_ring_outpt + 1;
+  bytes_sent = send_all(s, buffer, bytes);
+  g_mutex_unlock(&send_mutex);
+  return bytes_sent;
+}
+
+short remote_get_mic_sample() {
+  //
+  // return one sample from the microphone jitter buffer.
+  // This delivers zeroes if the client does not send
+  // mic samples.
+  //
+  double left, right;
 
-  if (newpt == MIC_RING_BUFFER_SIZE) { newpt = 0; }
+  if (mic_jitter_buffer == NULL) { return 0; }
 
-  MEMORY_BARRIER;
-  sample = mic_ring_buffer[mic_ring_outpt];
-  // atomic update of read pointer
-  MEMORY_BARRIER;
-  mic_ring_outpt = newpt;
-  return sample;
+  jitter_buffer_get(mic_jitter_buffer, &left, &right);
+  return (short)(left * 32767.0);
 }
 
 void server_tx_audio(short sample) {
@@ -456,19 +895,30 @@ void server_tx_audio(short sample) {
 
   txaudio_data.samples[txaudio_buffer_index++] = to_short(sample);
 
-  if (txaudio_buffer_index >= AUDIO_DATA_SIZE) {
+  //
+  // Small packets keep the latency low, the jitter buffer on the
+  // server side takes care of the packet arrival jitter.
+  //
+  int frame = remote_audio_frame;
+
+  if (frame < 64 || frame > AUDIO_DATA_SIZE) { frame = AUDIO_DATA_SIZE; }
+
+  if (txaudio_buffer_index >= frame) {
     int txmode = vfo_get_tx_mode();
 
     if (radio_is_transmitting() && txmode != modeCWU && txmode != modeCWL && !tune && !transmitter->twotone) {
       //
       // The actual transmission of the mic audio samples only takes  place
-      // if we *need* them (note VOX is handled locally)
+      // if we *need* them (note VOX is handled locally). The packet has
+      // a variable length, the payload length goes to the header.
       //
+      int payload = sizeof(TXAUDIO_DATA) - sizeof(HEADER) - (AUDIO_DATA_SIZE - txaudio_buffer_index) * sizeof(uint16_t);
       SYNC(txaudio_data.header.sync);
       txaudio_data.header.data_type = to_short(INFO_TXAUDIO);
-      txaudio_data.numsamples = from_short(txaudio_buffer_index);
+      txaudio_data.header.s1 = to_short(payload);
+      txaudio_data.numsamples = to_short(txaudio_buffer_index);
 
-      if (send_bytes(client_socket, (char *)&txaudio_data, sizeof(TXAUDIO_DATA)) < 0) {
+      if (send_bytes(client_socket, (char *)&txaudio_data, payload + sizeof(HEADER)) < 0) {
         t_perror("server_txaudio");
         client_socket = -1;
       }
@@ -479,8 +929,8 @@ void server_tx_audio(short sample) {
       // Since we are NOT transmitting, delete first half of the buffer
       // so that if a RX/TX transition occurs, there  is "some" data available
       //
-      memcpy(txaudio_data.samples, txaudio_data.samples + (AUDIO_DATA_SIZE / 2), (AUDIO_DATA_SIZE / 2) * sizeof(uint16_t));
-      txaudio_buffer_index = (AUDIO_DATA_SIZE / 2);
+      memmove(txaudio_data.samples, txaudio_data.samples + (frame / 2), (txaudio_buffer_index - frame / 2) * sizeof(uint16_t));
+      txaudio_buffer_index -= (frame / 2);
     }
 
     vox_update((double)speak * 0.00003051);
@@ -488,451 +938,1150 @@ void server_tx_audio(short sample) {
   }
 }
 
-void remote_rxaudio(const RECEIVER *rx, short left_sample, short right_sample) {
-  int id = rx->id;
-  int i = rxaudio_buffer_index[id] * 2;
+static void audio_stats_reset() {
+  g_mutex_lock(&audio_stats.mutex);
+  audio_stats.codec = AUDIO_CODEC_PCM;
+  audio_stats.frame = 0;
+  audio_stats.start = audio_stats.last_log = g_get_monotonic_time();
+  audio_stats.bytes = 0;
+  audio_stats.packets = 0;
+  audio_stats.codec_time = 0;
+  audio_stats.delay_base = 0;
+  audio_stats.delay_min = INT_MAX;
+  audio_stats.delay_max = INT_MIN;
+  audio_stats.delay_sum = 0;
+  audio_stats.kbps = 0.0;
+  audio_stats.codec_ms = 0.0;
+  audio_stats.jitter_ms = 0.0;
+  audio_stats.max_jitter_ms = 0.0;
+  g_mutex_unlock(&audio_stats.mutex);
+}
 
-  if (!remoteclient.running) {
-    return;
-  }
+static void audio_stats_format(char *text, size_t len) {
+  double frame_ms = audio_stats.frame / 48.0;
 
-  rxaudio_data[id].samples[i] = to_short(left_sample);
-  rxaudio_data[id].samples[i + 1] = to_short(right_sample);
-  rxaudio_buffer_index[id]++;
+  if (radio_is_remote) {
+    double buffer_ms = rxaudio_jitter_buffer[0] ? jitter_buffer_delay(rxaudio_jitter_buffer[0]) : 0.0;
+    snprintf(text, len, "RX audio %s: received %.0f kbit/s, %.1f ms/packet, decode %.2f ms, delay variation %.1f ms (max %.1f ms), jitter buffer %.0f ms",
+             audio_codec_name(audio_stats.codec), audio_stats.kbps, frame_ms, audio_stats.codec_ms,
+             audio_stats.jitter_ms, audio_stats.max_jitter_ms, buffer_ms);
 
-  if (rxaudio_buffer_index[id] >= AUDIO_DATA_SIZE) {
-    SYNC(rxaudio_data[id].header.sync);
-    rxaudio_data[id].header.data_type = to_short(INFO_RXAUDIO);
-    rxaudio_data[id].rx = id;
-    rxaudio_data[id].numsamples = from_short(rxaudio_buffer_index[id]);
-    send_bytes(remoteclient.socket, (char *)&rxaudio_data[id], sizeof(RXAUDIO_DATA));
-    rxaudio_buffer_index[id] = 0;
+    if (udp_client_socket >= 0) {
+      size_t l = strlen(text);
+      snprintf(text + l, len - l, ", UDP: %ld lost, %ld recovered", udp_audio_lost, udp_audio_recovered);
+    }
+  } else {
+    snprintf(text, len, "RX audio %s: sent %.0f kbit/s, %.1f ms/packet, encode %.2f ms",
+             audio_codec_name(audio_stats.codec), audio_stats.kbps, frame_ms, audio_stats.codec_ms);
   }
 }
 
+void remote_audio_stats(char *text, size_t len) {
+  g_mutex_lock(&audio_stats.mutex);
+  audio_stats_format(text, len);
+  g_mutex_unlock(&audio_stats.mutex);
+}
+
 //
-// Note that this is now only called when
-// - display mutex is locked
-// - displaying is set and a pixel_samples contain valid data
+// Account for one RX audio packet (frame: number of samples, bytes: packet length,
+// codec_time: time spent in encoder/decoder). The time stamp is only
+// available on the client side. Since server and client clocks are not
+// synchronised, only the variation of the transport delay can be measured.
 //
-void remote_send_rxspectrum(int id) {
-  const float *samples;
-  SPECTRUM_DATA spectrum_data;
-  int numsamples = 0;
+static void audio_stats_add(int codec, int frame, int bytes, gint64 codec_time, int has_timestamp, uint32_t timestamp) {
+  gint64 now = g_get_monotonic_time();
+  g_mutex_lock(&audio_stats.mutex);
 
-  if (!remoteclient.send_rx_spectrum[id] || id >= receivers || !remoteclient.running) {
-    return;
+  if (codec != audio_stats.codec || frame != audio_stats.frame) {
+    audio_stats.codec = codec;
+    audio_stats.frame = frame;
+    audio_stats.packets = 0;
   }
 
-  SYNC(spectrum_data.header.sync);
-  spectrum_data.header.data_type = to_short(INFO_RX_SPECTRUM);
-  spectrum_data.vfo_a_freq = to_ll(vfo[VFO_A].frequency);
-  spectrum_data.vfo_b_freq = to_ll(vfo[VFO_B].frequency);
-  spectrum_data.vfo_a_ctun_freq = to_ll(vfo[VFO_A].ctun_frequency);
-  spectrum_data.vfo_b_ctun_freq = to_ll(vfo[VFO_B].ctun_frequency);
-  spectrum_data.vfo_a_offset = to_ll(vfo[VFO_A].offset);
-  spectrum_data.vfo_b_offset = to_ll(vfo[VFO_B].offset);
-  //
-  spectrum_data.id = id;
-  const RECEIVER *rx = receiver[id];
-  spectrum_data.zoom  = rx->zoom;
-  spectrum_data.pan   = to_short(rx->pan);
-  spectrum_data.meter = to_double(rx->meter);
-  spectrum_data.width = to_short(rx->width);
-  samples = rx->pixel_samples;
-  numsamples = rx->width;
+  if (audio_stats.packets == 0) {
+    audio_stats.start = now;
+    audio_stats.bytes = 0;
+    audio_stats.codec_time = 0;
+    audio_stats.delay_min = INT_MAX;
+    audio_stats.delay_max = INT_MIN;
+    audio_stats.delay_sum = 0;
+  }
 
-  if (numsamples > SPECTRUM_DATA_SIZE) { numsamples = SPECTRUM_DATA_SIZE; }
+  audio_stats.bytes += bytes;
+  audio_stats.packets++;
+  audio_stats.codec_time += codec_time;
 
-  for (int i = 0; i < numsamples; i++) {
-    int s = ((int) samples[i + rx->pan]) + 200;  // -200dBm ... 55dBm maps to 0 ... 55
+  if (has_timestamp) {
+    uint32_t raw = (uint32_t)(now / 1000) - timestamp;
 
-    if (s < 0) { s = 0; }
+    if (audio_stats.delay_min == INT_MAX) {
+      audio_stats.delay_base = raw;
+    }
 
-    if (s > 255) { s = 255; }
+    int delay = (int32_t)(raw - audio_stats.delay_base);
 
-    spectrum_data.sample[i] = (uint8_t) s;
+    if (delay < audio_stats.delay_min) { audio_stats.delay_min = delay; }
+
+    if (delay > audio_stats.delay_max) { audio_stats.delay_max = delay; }
+
+    audio_stats.delay_sum += delay;
   }
 
-  if (numsamples > 0) {
-    //
-    // spectrum commands have a variable length, since this depends on the
-    // width of the screen. To this end, calculate the total number of bytes
-    // in THIS command (xferlen) and the length  of the payload.
-    //
-    int xferlen = sizeof(spectrum_data) - (SPECTRUM_DATA_SIZE - numsamples) * sizeof(uint8_t);
-    int payload = xferlen - sizeof(HEADER);
+  double secs = 1.0E-6 * (now - audio_stats.start);
 
-    //cppcheck-suppress knownConditionTrueFalse
-    if (payload > 32000) { fatal_error("FATAL: Spectrum payload too large"); }
+  if (secs >= AUDIO_STATS_INTERVAL) {
+    audio_stats.kbps = 8.0E-3 * audio_stats.bytes / secs;
+    audio_stats.codec_ms = 1.0E-3 * audio_stats.codec_time / audio_stats.packets;
 
-    spectrum_data.header.s1 = to_short(payload);
-    send_bytes(remoteclient.socket, (char *)&spectrum_data, xferlen);
-  }
-}
+    if (has_timestamp) {
+      audio_stats.jitter_ms = (double) audio_stats.delay_sum / audio_stats.packets - audio_stats.delay_min;
+      audio_stats.max_jitter_ms = audio_stats.delay_max - audio_stats.delay_min;
+    }
 
-void remote_send_txspectrum() {
-  const float *samples;
-  SPECTRUM_DATA spectrum_data;
-  int numsamples = 0;
+    audio_stats.packets = 0;
 
-  if (!remoteclient.send_tx_spectrum || !can_transmit || !remoteclient.running) {
-    return;
+    if (now - audio_stats.last_log >= AUDIO_STATS_LOG * 1000000LL) {
+      char text[256];
+      audio_stats.last_log = now;
+      audio_stats_format(text, sizeof(text));
+      t_print("%s\n", text);
+    }
   }
 
-  SYNC(spectrum_data.header.sync);
-  spectrum_data.header.data_type = to_short(INFO_TX_SPECTRUM);
-  spectrum_data.vfo_a_freq = to_ll(vfo[VFO_A].frequency);
-  spectrum_data.vfo_b_freq = to_ll(vfo[VFO_B].frequency);
-  spectrum_data.vfo_a_ctun_freq = to_ll(vfo[VFO_A].ctun_frequency);
-  spectrum_data.vfo_b_ctun_freq = to_ll(vfo[VFO_B].ctun_frequency);
-  spectrum_data.vfo_a_offset = to_ll(vfo[VFO_A].offset);
-  spectrum_data.vfo_b_offset = to_ll(vfo[VFO_B].offset);
-  //
-  const TRANSMITTER *tx = transmitter;
-  spectrum_data.alc   = to_double(tx->alc);
-  spectrum_data.fwd   = to_double(tx->fwd);
-  spectrum_data.swr   = to_double(tx->swr);
-  spectrum_data.width = to_short(tx->width);
-  samples = tx->pixel_samples;
-  numsamples = tx->width;
+  g_mutex_unlock(&audio_stats.mutex);
+}
 
-  if (numsamples > SPECTRUM_DATA_SIZE) { numsamples = SPECTRUM_DATA_SIZE; }
+//
+// RX audio streams. For each receiver, there is one stream per distinct
+// format (codec, bitrate, packet size) requested by the clients, so each
+// packet is encoded only once and then queued for all clients that
+// use this format. The streams are set up again in the RX thread
+// whenever audio_config_gen changes (a client has connected, disconnected,
+// or requested another format).
+//
+typedef struct _audio_stream {
+  int users;                // 0: stream is not used
+  int codec;
+  int bitrate;
+  int frame;                // 0: uncompressed INFO_RXAUDIO packets
+  AUDIO_CODEC *encoder;
+  int size;                 // samples per packet
+  int index;
+  short pcm[2 * AUDIO_CODEC_MAX_FRAME];
+} AUDIO_STREAM;
+
+static AUDIO_STREAM audio_streams[2][MAX_REMOTE_CLIENTS];
+static int audio_streams_gen[2] = { 0, 0 };
+
+static void audio_streams_setup(int id) {
+  AUDIO_STREAM *streams = audio_streams[id];
+
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    audio_codec_free(streams[k].encoder);
+    streams[k].encoder = NULL;
+    streams[k].users = 0;
+    streams[k].index = 0;
+  }
+
+  g_mutex_lock(&client_mutex);
+  audio_streams_gen[id] = audio_config_gen;
+
+  for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+    REMOTE_CLIENT *client = &remoteclients[i];
+    int k;
+    client->audio_stream[id] = -1;
 
-  //
-  // When running duplex, tx->pixels > tx->width, so transfer only central part
-  //
-  int offset = (tx->pixels - tx->width) / 2;
+    //
+    // Clients that get IQ data for this receiver need no audio
+    //
+    if (!client->running || client->iq_rate[id] != 0) { continue; }
 
-  for (int i = 0; i < numsamples; i++) {
-    int s = ((int) samples[i + offset]) + 200;  // -200dBm ... 55dBm maps to 0 ... 55
+    for (k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+      if (streams[k].users > 0 && streams[k].codec == client->audio_codec
+          && streams[k].bitrate == client->audio_bitrate && streams[k].frame == client->audio_frame) {
+        break;
+      }
+    }
 
-    if (s < 0) { s = 0; }
+    if (k == MAX_REMOTE_CLIENTS) {
+      for (k = 0; streams[k].users > 0; k++) {}
 
-    if (s > 255) { s = 255; }
+      streams[k].codec = client->audio_codec;
+      streams[k].bitrate = client->audio_bitrate;
+      streams[k].frame = client->audio_frame;
+    }
 
-    spectrum_data.sample[i] = (uint8_t) s;
+    streams[k].users++;
+    client->audio_stream[id] = k;
   }
 
-  if (numsamples > 0) {
-    //
-    // spectrum commands have a variable length, since this depends on the
-    // width of the screen. To this end, calculate the total number of bytes
-    // in THIS command (xferlen) and the length  of the payload.
-    //
-    int xferlen = sizeof(spectrum_data) - (SPECTRUM_DATA_SIZE - numsamples) * sizeof(uint8_t);
-    int payload = xferlen - sizeof(HEADER);
+  g_mutex_unlock(&client_mutex);
 
-    //cppcheck-suppress knownConditionTrueFalse
-    if (payload > 32000) { fatal_error("FATAL: Spectrum payload too large"); }
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    streams[k].size = AUDIO_DATA_SIZE;
 
-    spectrum_data.header.s1 = to_short(payload);
-    send_bytes(remoteclient.socket, (char *)&spectrum_data, xferlen);
+    if (streams[k].users > 0 && streams[k].frame > 0) {
+      streams[k].encoder = audio_encoder_new(streams[k].codec, streams[k].bitrate, streams[k].frame);
+
+      if (streams[k].encoder != NULL) {
+        streams[k].size = audio_codec_frame_size(streams[k].encoder);
+      }
+    }
   }
 }
 
-static int send_periodic_data(gpointer arg) {
-  //
-  // Use this periodic function to update PS and display info
-  //
-  if (!remoteclient.running) {
-    return TRUE;
-  }
+//
+// Queue an audio packet for all clients using stream k
+//
+static void audio_stream_send(int id, int k, SEND_PACKET *p) {
+  p->channel = UDP_CHANNEL_AUDIO + id;
+  g_mutex_lock(&client_mutex);
 
-  if (can_transmit) {
-    if (transmitter->puresignal) {
-      PS_DATA ps_data;
-      SYNC(ps_data.header.sync);
-      ps_data.header.data_type = to_short(INFO_PS);
-      tx_ps_getinfo(transmitter);
+  if (audio_streams_gen[id] == audio_config_gen) {
+    for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+      REMOTE_CLIENT *client = &remoteclients[i];
 
-      for (int i = 0; i < 16; i++) {
-        ps_data.psinfo[i] = to_short(transmitter->psinfo[i]);
+      if (client->running && client->audio_stream[id] == k) {
+        client_queue_push(client, p);
       }
-
-      ps_data.attenuation = to_short(transmitter->attenuation);
-      tx_ps_getpk(transmitter);
-      ps_data.ps_getpk = to_double(transmitter->ps_getpk);
-      tx_ps_getmx(transmitter);
-      ps_data.ps_getmx = to_double(transmitter->ps_getmx);
-      send_bytes(remoteclient.socket, (char *)&ps_data, sizeof(PS_DATA));
     }
   }
 
-  //
-  // Use this to periodically transfer data that is usually displayed
-  // as "warning" message on the panadapter. The "txzero" is included
-  // here to inform the client when the server has moved the drive slider
-  // to zero (SWR protection measure)
-  //
-  DISPLAY_DATA disp_data;
-  SYNC(disp_data.header.sync);
-  disp_data.header.data_type = to_short(INFO_DISPLAY);
-  disp_data.adc0_overload = adc0_overload;
-  disp_data.adc1_overload = adc1_overload;
-  disp_data.high_swr_seen = high_swr_seen;
-  disp_data.tx_fifo_overrun = tx_fifo_overrun;
-  disp_data.tx_fifo_underrun = tx_fifo_underrun;
-  disp_data.TxInhibit = TxInhibit;
-  disp_data.txzero = can_transmit ? (transmitter->drive < 0.5) : 0;
-  disp_data.capture_state = capture_state;
-  disp_data.exciter_power = to_short(exciter_power);
-  disp_data.ADC0 = to_short(ADC0);
-  disp_data.ADC1 = to_short(ADC1);
-  disp_data.sequence_errors = to_short(sequence_errors);
-  disp_data.capture_record_pointer = to_int(capture_record_pointer);
-  disp_data.capture_replay_pointer = to_int(capture_replay_pointer);
-  send_bytes(remoteclient.socket, (char *)&disp_data, sizeof(DISPLAY_DATA));
-
-  //
-  // if sending the data failed due to an interrupted connection,
-  // server_loop() will terminate and this source ID be removed
-  // elsewhere.
-  //
-  return TRUE;
+  g_mutex_unlock(&client_mutex);
 }
 
-static void send_start_radio(int sock) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_START_RADIO);
-  send_bytes(sock, (char *)&header, sizeof(HEADER));
-}
+static void audio_stream_flush(int id, int k) {
+  AUDIO_STREAM *stream = &audio_streams[id][k];
+  SEND_PACKET *p;
 
-void send_rxmenu(int sock, int id) {
-  RXMENU_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(CMD_RXMENU);
-  data.id = id;
-  data.dither = receiver[id]->dither;
-  data.random = receiver[id]->random;
-  data.preamp = receiver[id]->preamp;
-  data.adc0_filter_bypass = adc0_filter_bypass;
-  data.adc1_filter_bypass = adc1_filter_bypass;
-  send_bytes(sock, (char *)&data, sizeof(RXMENU_DATA));
-}
+  if (stream->encoder == NULL) {
+    //
+    // Uncompressed audio
+    //
+    p = send_packet_new(SEND_AUDIO, NULL, sizeof(RXAUDIO_DATA));
+    RXAUDIO_DATA *data = (RXAUDIO_DATA *)p->data;
+    SYNC(data->header.sync);
+    data->header.data_type = to_short(INFO_RXAUDIO);
+    data->rx = id;
+    data->numsamples = to_short(stream->size);
 
-void send_radiomenu(int sock) {
-  RADIOMENU_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(CMD_RADIOMENU);
-  data.mic_ptt_tip_bias_ring = mic_ptt_tip_bias_ring;
-  data.sat_mode = sat_mode;
-  data.mic_input_xlr = mic_input_xlr;
-  data.atlas_clock_source_10mhz = atlas_clock_source_10mhz;
-  data.atlas_clock_source_128mhz = atlas_clock_source_128mhz;
-  data.atlas_mic_source = atlas_mic_source;
-  data.atlas_penelope = atlas_penelope;
-  data.atlas_janus = atlas_janus;
-  data.mic_ptt_enabled = mic_ptt_enabled;
-  data.mic_bias_enabled = mic_bias_enabled;
-  data.pa_enabled = pa_enabled;
-  data.mute_spkr_amp = mute_spkr_amp;
-  data.hl2_audio_codec = hl2_audio_codec;
-  data.soapy_iqswap = soapy_iqswap;
-  data.enable_tx_inhibit = enable_tx_inhibit;
-  data.enable_auto_tune = enable_auto_tune;
-  data.new_pa_board = new_pa_board;
-  data.tx_out_of_band_allowed = tx_out_of_band_allowed;
-  data.OCtune = OCtune;
-  //
-  data.rx_gain_calibration = to_short(rx_gain_calibration);
-  data.OCfull_tune_time = to_short(OCfull_tune_time);
-  data.OCmemory_tune_time = to_short(OCmemory_tune_time);
-  //
-  data.frequency_calibration = to_ll(frequency_calibration);
-  send_bytes(sock, (char *)&data, sizeof(RADIOMENU_DATA));
-}
+    for (int i = 0; i < 2 * stream->size; i++) {
+      data->samples[i] = to_short(stream->pcm[i]);
+    }
 
-void send_memory_data(int sock, int index) {
-  MEMORY_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(INFO_MEMORY);
-  data.index              = index;
-  data.sat_mode           = mem[index].sat_mode;
-  data.ctun               = mem[index].ctun;
-  data.mode               = mem[index].mode;
-  data.filter             = mem[index].filter;
-  data.bd                 = mem[index].bd;
-  data.alt_ctun           = mem[index].alt_ctun;
-  data.alt_mode           = mem[index].alt_mode;
-  data.alt_filter         = mem[index].alt_filter;
-  data.alt_bd             = mem[index].alt_bd;
-  data.ctcss_enabled      = mem[index].ctcss_enabled;
-  data.ctcss              = mem[index].ctcss;
-  //
-  data.deviation          = to_short(mem[index].deviation);
-  data.alt_deviation      = to_short(mem[index].alt_deviation);
-  //
-  data.frequency          = to_ll(mem[index].frequency);
-  data.ctun_frequency     = to_ll(mem[index].ctun_frequency);
-  data.alt_frequency      = to_ll(mem[index].frequency);
-  data.alt_ctun_frequency = to_ll(mem[index].ctun_frequency);
-  send_bytes(sock, (char *)&data, sizeof(MEMORY_DATA));
-}
+    if (k == 0) { audio_stats_add(AUDIO_CODEC_PCM, stream->size, sizeof(RXAUDIO_DATA), 0, 0, 0); }
+  } else {
+    CODED_RXAUDIO_DATA *data = &coded_rxaudio_data[id];
+    gint64 t0 = g_get_monotonic_time();
+    int len = audio_encode(stream->encoder, stream->pcm, data->data);
+    gint64 t1 = g_get_monotonic_time();
 
-void send_band_data(int sock, int b) {
-  BAND_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(INFO_BAND);
-  BAND *band = band_get_band(b);
-  snprintf(data.title, sizeof(data.title), "%s", band->title);
-  data.band = b;
-  data.OCrx = band->OCrx;
-  data.OCtx = band->OCtx;
-  data.alexRxAntenna = band->alexRxAntenna;
-  data.alexTxAntenna = band->alexTxAntenna;
-  data.alexAttenuation = band->alexAttenuation;
-  data.disablePA = band->disablePA;
-  data.current = band->bandstack->current_entry;
-  data.gain = to_short(band->gain);
-  data.pa_calibration = to_double(band->pa_calibration);
-  data.frequencyMin = to_ll(band->frequencyMin);
-  data.frequencyMax = to_ll(band->frequencyMax);
-  data.frequencyLO = to_ll(band->frequencyLO);
-  data.errorLO = to_ll(band->errorLO);
-  send_bytes(sock, (char *)&data, sizeof(BAND_DATA));
-}
+    if (len <= 0) { return; }
 
-void send_xvtr_changed(int sock) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_XVTR);
-  send_bytes(sock, (char *)&header, sizeof(HEADER));
-}
+    //
+    // The packet has a variable length, the payload length
+    // goes to the header.
+    //
+    int xferlen = sizeof(CODED_RXAUDIO_DATA) - AUDIO_CODEC_MAX_BYTES + len;
+    SYNC(data->header.sync);
+    data->header.data_type = to_short(INFO_RXAUDIO_CODED);
+    data->header.b1 = stream->codec;
+    data->header.s1 = to_short(xferlen - sizeof(HEADER));
+    data->rx = id;
+    data->numsamples = to_short(stream->size);
+    data->timestamp = htonl((uint32_t)(t1 / 1000));
+    p = send_packet_new(SEND_AUDIO, data, xferlen);
 
-void send_bandstack_data(int sock, int b, int stack) {
-  BANDSTACK_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(INFO_BANDSTACK);
-  BAND *band = band_get_band(b);
-  BANDSTACK_ENTRY *entry = band->bandstack->entry;
-  entry += stack;
-  data.band = b;
-  data.stack = stack;
-  data.mode = entry->mode;
-  data.filter = entry->filter;
-  data.ctun = entry->ctun;
-  data.ctcss_enabled = entry->ctcss_enabled;
-  data.ctcss = entry->ctcss;
-  data.deviation = to_short(entry->deviation);
-  data.frequency = to_ll(entry->frequency);
-  data.ctun_frequency = to_ll(entry->ctun_frequency);
-  send_bytes(sock, (char *)&data, sizeof(BANDSTACK_DATA));
+    if (k == 0) { audio_stats_add(stream->codec, stream->size, xferlen, t1 - t0, 0, 0); }
+  }
+
+  audio_stream_send(id, k, p);
+  send_packet_unref(p);
 }
 
-void send_radio_data(int sock) {
-  RADIO_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(INFO_RADIO);
-  snprintf(data.name, sizeof(data.name), "%s", radio->name);
-  data.locked = locked;
-  data.protocol = protocol;
-  data.supported_receivers = radio->supported_receivers;
-  data.receivers = receivers;
-  data.filter_board = filter_board;
-  data.enable_auto_tune = enable_auto_tune;
-  data.new_pa_board = new_pa_board;
-  data.region = region;
-  data.atlas_penelope = atlas_penelope;
-  data.atlas_clock_source_10mhz = atlas_clock_source_10mhz;
-  data.atlas_clock_source_128mhz = atlas_clock_source_128mhz;
-  data.atlas_mic_source = atlas_mic_source;
-  data.atlas_janus = atlas_janus;
-  data.hl2_audio_codec = hl2_audio_codec;
-  data.anan10E = anan10E;
-  data.tx_out_of_band_allowed = tx_out_of_band_allowed;
-  data.pa_enabled = pa_enabled;
-  data.mic_boost = mic_boost;
-  data.mic_linein = mic_linein;
-  data.mic_ptt_enabled = mic_ptt_enabled;
-  data.mic_bias_enabled = mic_bias_enabled;
-  data.mic_ptt_tip_bias_ring = mic_ptt_tip_bias_ring;
-  data.mic_input_xlr = mic_input_xlr;
-  data.cw_keyer_sidetone_volume = cw_keyer_sidetone_volume;
-  data.OCtune = OCtune;
-  data.mute_rx_while_transmitting = mute_rx_while_transmitting;
-  data.mute_spkr_amp = mute_spkr_amp;
-  data.adc0_filter_bypass = adc0_filter_bypass;
-  data.adc1_filter_bypass = adc1_filter_bypass;
-  data.split = split;
-  data.sat_mode = sat_mode;
-  data.duplex = duplex;
-  data.have_rx_gain = have_rx_gain;
-  data.have_rx_att = have_rx_att;
-  data.have_alex_att = have_alex_att;
-  data.have_preamp = have_preamp;
-  data.have_dither = have_dither;
-  data.have_saturn_xdma = have_saturn_xdma;
-  data.rx_stack_horizontal = rx_stack_horizontal;
-  data.n_adc = n_adc;
-  data.diversity_enabled = diversity_enabled;
-  data.soapy_iqswap = soapy_iqswap;
-  data.soapy_rx_antennas = radio->info.soapy.rx_antennas;
-  data.soapy_tx_antennas = radio->info.soapy.tx_antennas;
-  data.soapy_rx_gains = radio->info.soapy.rx_gains;
-  data.soapy_tx_gains = radio->info.soapy.tx_gains;
-  data.soapy_tx_channels = radio->info.soapy.tx_channels;
-  data.soapy_rx_has_automatic_gain = radio->info.soapy.rx_has_automatic_gain;
-  //
-  memcpy(data.soapy_hardware_key, radio->info.soapy.hardware_key, 64);
-  memcpy(data.soapy_driver_key, radio->info.soapy.driver_key, 64);
+void remote_rxaudio(const RECEIVER *rx, short left_sample, short right_sample) {
+  int id = rx->id;
 
-  for (int i = 0; i < radio->info.soapy.rx_antennas; i++) {
-    memcpy(data.soapy_rx_antenna[i], radio->info.soapy.rx_antenna[i], 64);
+  if (remote_clients == 0 || id > 1) {
+    return;
   }
 
-  for (int i = 0; i < radio->info.soapy.tx_antennas; i++) {
-    memcpy(data.soapy_tx_antenna[i], radio->info.soapy.tx_antenna[i], 64);
+  if (audio_streams_gen[id] != audio_config_gen) {
+    audio_streams_setup(id);
   }
 
-  for (int i = 0; i < radio->info.soapy.rx_gains; i++) {
-    memcpy(data.soapy_rx_gain_elem_name[i], radio->info.soapy.rx_gain_elem_name[i], 64);
-  }
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    AUDIO_STREAM *stream = &audio_streams[id][k];
 
-  for (int i = 0; i < radio->info.soapy.tx_gains; i++) {
-    memcpy(data.soapy_tx_gain_elem_name[i], radio->info.soapy.tx_gain_elem_name[i], 64);
-  }
+    if (stream->users == 0) { continue; }
 
-  //
-  data.pa_power = to_short(pa_power);
-  data.OCfull_tune_time = to_short(OCfull_tune_time);
-  data.OCmemory_tune_time = to_short(OCmemory_tune_time);
-  data.cw_keyer_sidetone_frequency = to_short(cw_keyer_sidetone_frequency);
-  data.rx_gain_calibration = to_short(rx_gain_calibration);
-  data.device = to_short(device);
-  data.display_width = to_short(display_width);
-  //
-  data.drive_min = to_double(drive_min);
-  data.drive_max = to_double(drive_max);
-  data.drive_digi_max = to_double(drive_digi_max);
-  data.div_gain = to_double(div_gain);
-  data.div_phase = to_double(div_phase);
+    stream->pcm[2 * stream->index] = left_sample;
+    stream->pcm[2 * stream->index + 1] = right_sample;
 
-  for (int i = 0; i < 11; i++) {
-    data.pa_trim[i] = to_double(pa_trim[i]);
+    if (++stream->index >= stream->size) {
+      audio_stream_flush(id, k);
+      stream->index = 0;
+    }
   }
+}
 
-  data.soapy_rx_gain_step = to_double(radio->info.soapy.rx_gain_step);
-  data.soapy_rx_gain_min  = to_double(radio->info.soapy.rx_gain_min );
-  data.soapy_rx_gain_max  = to_double(radio->info.soapy.rx_gain_max );
-  data.soapy_tx_gain_step = to_double(radio->info.soapy.tx_gain_step);
-  data.soapy_tx_gain_min  = to_double(radio->info.soapy.tx_gain_min );
-  data.soapy_tx_gain_max  = to_double(radio->info.soapy.tx_gain_max );
+//
+// IQ streams. A client that demodulates on its own gets the IQ data of the
+// receiver instead of the audio. There is one stream per receiver and
+// decimation factor, set up again in the RX thread whenever
+// audio_config_gen or the sample rate changes.
+//
+typedef struct _iq_stream {
+  int users;
+  int factor;               // decimation
+  IQ_DECIMATOR *decimator;
+  int index;
+  double iq[2 * IQ_DATA_SIZE];
+} IQ_STREAM;
+
+static IQ_STREAM iq_streams[2][MAX_REMOTE_CLIENTS];
+static int iq_streams_gen[2] = { 0, 0 };
+static int iq_streams_rate[2] = { 0, 0 };
 
-  for (int i = 0; i < radio->info.soapy.rx_gains; i++) {
-    data.soapy_rx_gain_elem_step[i] = to_double(radio->info.soapy.rx_gain_elem_step[i]);
-    data.soapy_rx_gain_elem_min[i] = to_double(radio->info.soapy.rx_gain_elem_min[i]);
-    data.soapy_rx_gain_elem_max[i] = to_double(radio->info.soapy.rx_gain_elem_max[i]);
+//
+// Largest power of two by which the sample rate can be divided
+// without going below the requested rate (rate < 0: full rate)
+//
+static int iq_decimation(int sample_rate, int rate) {
+  int factor = 1;
+
+  if (rate > 0) {
+    while (factor < (1 << IQ_CODEC_MAX_STAGES) && sample_rate / (2 * factor) >= rate) { factor *= 2; }
   }
 
-  for (int i = 0; i < radio->info.soapy.tx_gains; i++) {
-    data.soapy_tx_gain_elem_step[i] = to_double(radio->info.soapy.tx_gain_elem_step[i]);
-    data.soapy_tx_gain_elem_min[i] = to_double(radio->info.soapy.tx_gain_elem_min[i]);
-    data.soapy_tx_gain_elem_max[i] = to_double(radio->info.soapy.tx_gain_elem_max[i]);
+  return factor;
+}
+
+static void iq_streams_setup(const RECEIVER *rx) {
+  int id = rx->id;
+  IQ_STREAM *streams = iq_streams[id];
+
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    iq_decimator_free(streams[k].decimator);
+    streams[k].decimator = NULL;
+    streams[k].users = 0;
+    streams[k].index = 0;
   }
 
-  //
+  g_mutex_lock(&client_mutex);
+  iq_streams_gen[id] = audio_config_gen;
+  iq_streams_rate[id] = rx->sample_rate;
+
+  for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+    REMOTE_CLIENT *client = &remoteclients[i];
+    int k;
+    client->iq_stream[id] = -1;
+
+    if (!client->running || client->iq_rate[id] == 0) { continue; }
+
+    int factor = iq_decimation(rx->sample_rate, client->iq_rate[id]);
+
+    for (k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+      if (streams[k].users > 0 && streams[k].factor == factor) { break; }
+    }
+
+    if (k == MAX_REMOTE_CLIENTS) {
+      for (k = 0; streams[k].users > 0; k++) {}
+
+      streams[k].factor = factor;
+    }
+
+    streams[k].users++;
+    client->iq_stream[id] = k;
+  }
+
+  g_mutex_unlock(&client_mutex);
+
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    if (streams[k].users > 0) {
+      streams[k].decimator = iq_decimator_new(streams[k].factor);
+      t_print("%s: RX%d IQ stream at %d Hz, %d client(s)\n", __FUNCTION__, id + 1,
+              rx->sample_rate / streams[k].factor, streams[k].users);
+    }
+  }
+}
+
+static void iq_stream_flush(const RECEIVER *rx, int k) {
+  int id = rx->id;
+  IQ_STREAM *stream = &iq_streams[id][k];
+  short mantissa[2 * IQ_DATA_SIZE];
+  int exponent = iq_encode(stream->iq, IQ_DATA_SIZE, mantissa);
+  SEND_PACKET *p = send_packet_new(SEND_AUDIO, NULL, sizeof(IQ_DATA));
+  IQ_DATA *data = (IQ_DATA *)p->data;
+  SYNC(data->header.sync);
+  data->header.data_type = to_short(INFO_IQ);
+  data->header.b1 = id;
+  data->header.b2 = 0;
+  data->header.s1 = to_short(sizeof(IQ_DATA) - sizeof(HEADER));
+  data->header.s2 = to_short(0);
+  data->sample_rate = to_int(rx->sample_rate / stream->factor);
+  data->exponent = (uint8_t)(int8_t) exponent;
+
+  for (int i = 0; i < 2 * IQ_DATA_SIZE; i++) {
+    data->samples[i] = to_short(mantissa[i]);
+  }
+
+  p->channel = UDP_CHANNEL_IQ + id;
+  g_mutex_lock(&client_mutex);
+
+  if (iq_streams_gen[id] == audio_config_gen) {
+    for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+      REMOTE_CLIENT *client = &remoteclients[i];
+
+      if (client->running && client->iq_stream[id] == k) {
+        client_queue_push(client, p);
+      }
+    }
+  }
+
+  g_mutex_unlock(&client_mutex);
+  send_packet_unref(p);
+}
+
+//
+// Called from the RX thread with each buffer of (raw) IQ samples
+//
+void remote_rxiq(const RECEIVER *rx, const double *iq, int n) {
+  int id = rx->id;
+  double out[2 * IQ_DATA_SIZE];
+
+  if (remote_clients == 0 || id > 1) {
+    return;
+  }
+
+  if (iq_streams_gen[id] != audio_config_gen || iq_streams_rate[id] != rx->sample_rate) {
+    iq_streams_setup(rx);
+  }
+
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    IQ_STREAM *stream = &iq_streams[id][k];
+
+    if (stream->users == 0) { continue; }
+
+    for (int j = 0; j < n; j += IQ_DATA_SIZE) {
+      int m = iq_decimate(stream->decimator, iq + 2 * j, MIN(IQ_DATA_SIZE, n - j), out);
+
+      for (int i = 0; i < m; i++) {
+        stream->iq[2 * stream->index] = out[2 * i];
+        stream->iq[2 * stream->index + 1] = out[2 * i + 1];
+
+        if (++stream->index >= IQ_DATA_SIZE) {
+          iq_stream_flush(rx, k);
+          stream->index = 0;
+        }
+      }
+    }
+  }
+}
+
+//
+// Spectrum streams. As for the audio, there is one stream per panadapter
+// and distinct format requested by the clients. Since coded frames depend
+// on the previous frame, the frame rate is part of the format. If frames
+// had to be dropped for a client, it gets no more frames of this stream
+// until the next key frame, which is then requested from the encoder.
+// The streams are only accessed from the display timers (GTK thread).
+//
+typedef struct _spectrum_stream {
+  int users;
+  SPECTRUM_FORMAT format;   // format.active == 0: uncompressed SPECTRUM_DATA packets
+  SPECTRUM_CODEC *encoder;
+  gint64 last_frame;
+  int force_key;
+  int vfo_valid;
+  SPECTRUM_VFO vfo;         // VFO data last sent
+} SPECTRUM_STREAM;
+
+static SPECTRUM_STREAM spectrum_streams[SPECTRUM_TX + 1][MAX_REMOTE_CLIENTS];
+static int spectrum_streams_gen[SPECTRUM_TX + 1];
+
+static int spectrum_format_equal(const SPECTRUM_FORMAT *a, const SPECTRUM_FORMAT *b) {
+  if (!a->active || !b->active) { return a->active == b->active; }
+
+  return a->width == b->width && a->fps == b->fps && a->low == b->low && a->high == b->high
+         && a->deadband == b->deadband;
+}
+
+static void spectrum_streams_setup(int slot) {
+  SPECTRUM_STREAM *streams = spectrum_streams[slot];
+
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    spectrum_codec_free(streams[k].encoder);
+    streams[k].encoder = NULL;
+    streams[k].users = 0;
+    streams[k].last_frame = 0;
+    streams[k].force_key = 0;
+    streams[k].vfo_valid = 0;
+  }
+
+  g_mutex_lock(&client_mutex);
+  spectrum_streams_gen[slot] = spectrum_config_gen;
+
+  for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+    REMOTE_CLIENT *client = &remoteclients[i];
+    int want = (slot == SPECTRUM_TX) ? client->send_tx_spectrum : client->send_rx_spectrum[slot];
+    int k;
+    client->spectrum_stream[slot] = -1;
+
+    if (!client->running || !want) { continue; }
+
+    for (k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+      if (streams[k].users > 0 && spectrum_format_equal(&streams[k].format, &client->spectrum_format[slot])) {
+        break;
+      }
+    }
+
+    if (k == MAX_REMOTE_CLIENTS) {
+      for (k = 0; streams[k].users > 0; k++) {}
+
+      streams[k].format = client->spectrum_format[slot];
+    }
+
+    streams[k].users++;
+    client->spectrum_stream[slot] = k;
+    client->spectrum_resync[slot] = 0;
+  }
+
+  g_mutex_unlock(&client_mutex);
+}
+
+//
+// Queue a spectrum frame for all clients using stream k
+//
+static void spectrum_stream_send(int slot, int k, SEND_PACKET *p) {
+  SPECTRUM_STREAM *stream = &spectrum_streams[slot][k];
+  p->channel = UDP_CHANNEL_SPECTRUM + slot;
+  g_mutex_lock(&client_mutex);
+
+  for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+    REMOTE_CLIENT *client = &remoteclients[i];
+
+    if (!client->running || client->spectrum_stream[slot] != k) { continue; }
+
+    if (client->spectrum_dropped != client->queue.spectrum_dropped) {
+      client->spectrum_dropped = client->queue.spectrum_dropped;
+
+      for (int j = 0; j <= SPECTRUM_TX; j++) {
+        client->spectrum_resync[j] = 1;
+      }
+    }
+
+    if (client->spectrum_resync[slot]) {
+      if (!p->key) {
+        stream->force_key = 1;
+        continue;
+      }
+
+      client->spectrum_resync[slot] = 0;
+    }
+
+    client_queue_push(client, p);
+  }
+
+  g_mutex_unlock(&client_mutex);
+}
+
+//
+// Make a coded spectrum frame for stream k. The caller has filled in the
+// "meta" data (id, zoom, meter, ...) of the packet. Returns NULL if
+// no frame is due.
+//
+static SEND_PACKET *coded_spectrum_packet(CODED_SPECTRUM_DATA *data, SPECTRUM_STREAM *stream,
+    const float *samples, int numsamples) {
+  const SPECTRUM_FORMAT *format = &stream->format;
+  uint8_t pixels[SPECTRUM_DATA_SIZE];
+  SPECTRUM_VFO vfo_data;
+  gint64 now = g_get_monotonic_time();
+
+  //
+  // Reduce the frame rate to what the client wants. Allow for some
+  // timing jitter such that a frame is not skipped if the client
+  // runs at the same rate as the server.
+  //
+  if (format->fps > 0 && now - stream->last_frame < 750000 / format->fps) {
+    return NULL;
+  }
+
+  stream->last_frame = now;
+
+  if (numsamples > SPECTRUM_DATA_SIZE) { numsamples = SPECTRUM_DATA_SIZE; }
+
+  int width = spectrum_quantize(samples, numsamples, format->width, format->low, format->high, pixels);
+
+  if (width <= 0) { return NULL; }
+
+  if (stream->encoder == NULL || stream->encoder->width != width) {
+    spectrum_codec_free(stream->encoder);
+    stream->encoder = spectrum_codec_new(width, format->deadband);
+  }
+
+  if (stream->force_key) {
+    spectrum_codec_force_key(stream->encoder);
+    stream->vfo_valid = 0;
+    stream->force_key = 0;
+  }
+
+  //
+  // VFO frequencies are only included if they have changed
+  //
+  uint8_t *p = data->data;
+  int flags;
+  vfo_data.vfo_a_freq = to_ll(vfo[VFO_A].frequency);
+  vfo_data.vfo_b_freq = to_ll(vfo[VFO_B].frequency);
+  vfo_data.vfo_a_ctun_freq = to_ll(vfo[VFO_A].ctun_frequency);
+  vfo_data.vfo_b_ctun_freq = to_ll(vfo[VFO_B].ctun_frequency);
+  vfo_data.vfo_a_offset = to_ll(vfo[VFO_A].offset);
+  vfo_data.vfo_b_offset = to_ll(vfo[VFO_B].offset);
+  int send_vfo = !stream->vfo_valid || memcmp(&vfo_data, &stream->vfo, sizeof(SPECTRUM_VFO)) != 0;
+
+  if (send_vfo) {
+    memcpy(p, &vfo_data, sizeof(SPECTRUM_VFO));
+    memcpy(&stream->vfo, &vfo_data, sizeof(SPECTRUM_VFO));
+    stream->vfo_valid = 1;
+    p += sizeof(SPECTRUM_VFO);
+  }
+
+  int len = spectrum_encode(stream->encoder, pixels, p, &flags);
+
+  if (send_vfo) { flags |= SPECTRUM_FLAG_VFO; }
+
+  SYNC(data->header.sync);
+  data->header.data_type = to_short(INFO_SPECTRUM_CODED);
+  data->flags = flags;
+  data->width = to_short(width);
+  data->low = to_short(format->low);
+  int xferlen = (p - (uint8_t *)data) + len;
+  data->header.s1 = to_short(xferlen - sizeof(HEADER));
+  SEND_PACKET *packet = send_packet_new(SEND_SPECTRUM, data, xferlen);
+  packet->key = (flags & SPECTRUM_FLAG_KEY) != 0;
+  return packet;
+}
+
+//
+// Uncompressed spectrum frame (for clients that have not requested a format)
+//
+static SEND_PACKET *spectrum_packet(SPECTRUM_DATA *spectrum_data, const float *samples, int numsamples) {
+  SYNC(spectrum_data->header.sync);
+  spectrum_data->vfo_a_freq = to_ll(vfo[VFO_A].frequency);
+  spectrum_data->vfo_b_freq = to_ll(vfo[VFO_B].frequency);
+  spectrum_data->vfo_a_ctun_freq = to_ll(vfo[VFO_A].ctun_frequency);
+  spectrum_data->vfo_b_ctun_freq = to_ll(vfo[VFO_B].ctun_frequency);
+  spectrum_data->vfo_a_offset = to_ll(vfo[VFO_A].offset);
+  spectrum_data->vfo_b_offset = to_ll(vfo[VFO_B].offset);
+
+  if (numsamples > SPECTRUM_DATA_SIZE) { numsamples = SPECTRUM_DATA_SIZE; }
+
+  if (numsamples <= 0) { return NULL; }
+
+  for (int i = 0; i < numsamples; i++) {
+    int s = ((int) samples[i]) + 200;  // -200dBm ... 55dBm maps to 0 ... 55
+
+    if (s < 0) { s = 0; }
+
+    if (s > 255) { s = 255; }
+
+    spectrum_data->sample[i] = (uint8_t) s;
+  }
+
+  //
+  // spectrum commands have a variable length, since this depends on the
+  // width of the screen. To this end, calculate the total number of bytes
+  // in THIS command (xferlen) and the length  of the payload.
+  //
+  int xferlen = sizeof(SPECTRUM_DATA) - (SPECTRUM_DATA_SIZE - numsamples) * sizeof(uint8_t);
+  int payload = xferlen - sizeof(HEADER);
+
+  //cppcheck-suppress knownConditionTrueFalse
+  if (payload > 32000) { fatal_error("FATAL: Spectrum payload too large"); }
+
+  spectrum_data->header.s1 = to_short(payload);
+  return send_packet_new(SEND_SPECTRUM, spectrum_data, xferlen);
+}
+
+//
+// Note that this is now only called when
+// - display mutex is locked
+// - displaying is set and a pixel_samples contain valid data
+//
+void remote_send_rxspectrum(int id) {
+  if (id >= receivers || remote_clients == 0) {
+    return;
+  }
+
+  const RECEIVER *rx = receiver[id];
+  const float *samples = rx->pixel_samples + rx->pan;
+
+  if (spectrum_streams_gen[id] != spectrum_config_gen) {
+    spectrum_streams_setup(id);
+  }
+
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    SPECTRUM_STREAM *stream = &spectrum_streams[id][k];
+    SEND_PACKET *p;
+
+    if (stream->users == 0) { continue; }
+
+    if (stream->format.active) {
+      CODED_SPECTRUM_DATA data;
+      data.id = id;
+      data.zoom = rx->zoom;
+      data.pan = to_short(rx->pan);
+      data.meter = to_double(rx->meter);
+      data.alc = data.fwd = data.swr = to_double(0.0);
+      p = coded_spectrum_packet(&data, stream, samples, rx->width);
+    } else {
+      SPECTRUM_DATA spectrum_data;
+      spectrum_data.header.data_type = to_short(INFO_RX_SPECTRUM);
+      spectrum_data.id = id;
+      spectrum_data.zoom  = rx->zoom;
+      spectrum_data.pan   = to_short(rx->pan);
+      spectrum_data.meter = to_double(rx->meter);
+      spectrum_data.width = to_short(rx->width);
+      p = spectrum_packet(&spectrum_data, samples, rx->width);
+    }
+
+    if (p != NULL) {
+      spectrum_stream_send(id, k, p);
+      send_packet_unref(p);
+    }
+  }
+}
+
+void remote_send_txspectrum() {
+  if (!can_transmit || remote_clients == 0) {
+    return;
+  }
+
+  const TRANSMITTER *tx = transmitter;
+  //
+  // When running duplex, tx->pixels > tx->width, so transfer only central part
+  //
+  const float *samples = tx->pixel_samples + (tx->pixels - tx->width) / 2;
+
+  if (spectrum_streams_gen[SPECTRUM_TX] != spectrum_config_gen) {
+    spectrum_streams_setup(SPECTRUM_TX);
+  }
+
+  for (int k = 0; k < MAX_REMOTE_CLIENTS; k++) {
+    SPECTRUM_STREAM *stream = &spectrum_streams[SPECTRUM_TX][k];
+    SEND_PACKET *p;
+
+    if (stream->users == 0) { continue; }
+
+    if (stream->format.active) {
+      CODED_SPECTRUM_DATA data;
+      data.id = SPECTRUM_TX;
+      data.zoom = 1;
+      data.pan = to_short(0);
+      data.meter = to_double(0.0);
+      data.alc = to_double(tx->alc);
+      data.fwd = to_double(tx->fwd);
+      data.swr = to_double(tx->swr);
+      p = coded_spectrum_packet(&data, stream, samples, tx->width);
+    } else {
+      SPECTRUM_DATA spectrum_data;
+      spectrum_data.header.data_type = to_short(INFO_TX_SPECTRUM);
+      spectrum_data.id = SPECTRUM_TX;
+      spectrum_data.alc   = to_double(tx->alc);
+      spectrum_data.fwd   = to_double(tx->fwd);
+      spectrum_data.swr   = to_double(tx->swr);
+      spectrum_data.width = to_short(tx->width);
+      p = spectrum_packet(&spectrum_data, samples, tx->width);
+    }
+
+    if (p != NULL) {
+      spectrum_stream_send(SPECTRUM_TX, k, p);
+      send_packet_unref(p);
+    }
+  }
+}
+
+static int send_periodic_data(gpointer arg) {
+  //
+  // Use this periodic function to update PS and display info
+  //
+  if (remote_clients == 0) {
+    return TRUE;
+  }
+
+  if (can_transmit) {
+    if (transmitter->puresignal) {
+      PS_DATA ps_data;
+      SYNC(ps_data.header.sync);
+      ps_data.header.data_type = to_short(INFO_PS);
+      tx_ps_getinfo(transmitter);
+
+      for (int i = 0; i < 16; i++) {
+        ps_data.psinfo[i] = to_short(transmitter->psinfo[i]);
+      }
+
+      ps_data.attenuation = to_short(transmitter->attenuation);
+      tx_ps_getpk(transmitter);
+      ps_data.ps_getpk = to_double(transmitter->ps_getpk);
+      tx_ps_getmx(transmitter);
+      ps_data.ps_getmx = to_double(transmitter->ps_getmx);
+      send_bytes(REMOTE_BROADCAST, (char *)&ps_data, sizeof(PS_DATA));
+    }
+  }
+
+  //
+  // Use this to periodically transfer data that is usually displayed
+  // as "warning" message on the panadapter. The "txzero" is included
+  // here to inform the client when the server has moved the drive slider
+  // to zero (SWR protection measure)
+  //
+  DISPLAY_DATA disp_data;
+  SYNC(disp_data.header.sync);
+  disp_data.header.data_type = to_short(INFO_DISPLAY);
+  disp_data.adc0_overload = adc0_overload;
+  disp_data.adc1_overload = adc1_overload;
+  disp_data.high_swr_seen = high_swr_seen;
+  disp_data.tx_fifo_overrun = tx_fifo_overrun;
+  disp_data.tx_fifo_underrun = tx_fifo_underrun;
+  disp_data.TxInhibit = TxInhibit;
+  disp_data.txzero = can_transmit ? (transmitter->drive < 0.5) : 0;
+  disp_data.capture_state = capture_state;
+  disp_data.exciter_power = to_short(exciter_power);
+  disp_data.ADC0 = to_short(ADC0);
+  disp_data.ADC1 = to_short(ADC1);
+  disp_data.sequence_errors = to_short(sequence_errors);
+  disp_data.capture_record_pointer = to_int(capture_record_pointer);
+  disp_data.capture_replay_pointer = to_int(capture_replay_pointer);
+  send_bytes(REMOTE_BROADCAST, (char *)&disp_data, sizeof(DISPLAY_DATA));
+
+  //
+  // This timer is removed when the last client has disconnected.
+  //
+  return TRUE;
+}
+
+//
+// Link statistics: ping the clients, update the rates, and if requested,
+// append one JSON line per client to LINK_STATS_FILE.
+//
+static int link_stats_timer(gpointer arg) {
+  char json[MAX_REMOTE_CLIENTS][1024];
+  int count = 0;
+  PING_COMMAND ping;
+  SYNC(ping.header.sync);
+  ping.header.data_type = to_short(CMD_PING);
+  ping.header.b1 = 0;
+  ping.header.b2 = 0;
+  ping.header.s1 = to_short(0);
+  ping.header.s2 = to_short(0);
+  ping.timestamp = to_ll(g_get_monotonic_time());
+  ping.underruns = to_int(0);
+  ping.audio_lost = to_int(0);
+  ping.spectrum_lost = to_int(0);
+  SEND_PACKET *p = send_packet_new(SEND_CONTROL, &ping, sizeof(PING_COMMAND));
+  g_mutex_lock(&client_mutex);
+
+  for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+    REMOTE_CLIENT *client = &remoteclients[i];
+    LINK_STATS *stats = &client->link;
+
+    if (!client->running) { continue; }
+
+    stats->queue_bytes = client->queue.bytes;
+    stats->spectrum_dropped = client->queue.spectrum_dropped;
+    stats->audio_dropped = client->queue.audio_dropped;
+    stats->udp_dropped = client->udp_dropped;
+    link_stats_update(stats);
+
+    if (remote_link_log) {
+      char peer[INET_ADDRSTRLEN];
+      inet_ntop(AF_INET, &client->address.sin_addr, peer, sizeof(peer));
+      link_stats_json(stats, peer, client->controlling, json[count++], sizeof(json[0]));
+    }
+
+    stats->pings++;
+    client_queue_push(client, p);
+  }
+
+  g_mutex_unlock(&client_mutex);
+  send_packet_unref(p);
+
+  if (count > 0) {
+    FILE *f = fopen(LINK_STATS_FILE, "a");
+
+    if (f == NULL) {
+      t_perror("link_stats_timer");
+    } else {
+      for (int i = 0; i < count; i++) {
+        fprintf(f, "%s\n", json[i]);
+      }
+
+      fclose(f);
+    }
+  }
+
+  return TRUE;
+}
+
+void remote_link_stats(char *text, size_t len) {
+  size_t n = 0;
+  *text = 0;
+  g_mutex_lock(&client_mutex);
+
+  for (int i = 0; i < MAX_REMOTE_CLIENTS && n < len; i++) {
+    const REMOTE_CLIENT *client = &remoteclients[i];
+    char peer[INET_ADDRSTRLEN];
+    char line[256];
+
+    if (!client->running) { continue; }
+
+    inet_ntop(AF_INET, &client->address.sin_addr, peer, sizeof(peer));
+    link_stats_format(&client->link, line, sizeof(line));
+    int rc = snprintf(text + n, len - n, "%s%s%s: %s", n > 0 ? "\n" : "", peer,
+                      client->controlling ? " (control)" : "", line);
+
+    if (rc < 0) { break; }
+
+    n += rc;
+  }
+
+  g_mutex_unlock(&client_mutex);
+}
+
+void send_rxmenu(int sock, int id) {
+  RXMENU_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(CMD_RXMENU);
+  data.id = id;
+  data.dither = receiver[id]->dither;
+  data.random = receiver[id]->random;
+  data.preamp = receiver[id]->preamp;
+  data.adc0_filter_bypass = adc0_filter_bypass;
+  data.adc1_filter_bypass = adc1_filter_bypass;
+  send_bytes(sock, (char *)&data, sizeof(RXMENU_DATA));
+}
+
+void send_radiomenu(int sock) {
+  RADIOMENU_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(CMD_RADIOMENU);
+  data.mic_ptt_tip_bias_ring = mic_ptt_tip_bias_ring;
+  data.sat_mode = sat_mode;
+  data.mic_input_xlr = mic_input_xlr;
+  data.atlas_clock_source_10mhz = atlas_clock_source_10mhz;
+  data.atlas_clock_source_128mhz = atlas_clock_source_128mhz;
+  data.atlas_mic_source = atlas_mic_source;
+  data.atlas_penelope = atlas_penelope;
+  data.atlas_janus = atlas_janus;
+  data.mic_ptt_enabled = mic_ptt_enabled;
+  data.mic_bias_enabled = mic_bias_enabled;
+  data.pa_enabled = pa_enabled;
+  data.mute_spkr_amp = mute_spkr_amp;
+  data.hl2_audio_codec = hl2_audio_codec;
+  data.soapy_iqswap = soapy_iqswap;
+  data.enable_tx_inhibit = enable_tx_inhibit;
+  data.enable_auto_tune = enable_auto_tune;
+  data.new_pa_board = new_pa_board;
+  data.tx_out_of_band_allowed = tx_out_of_band_allowed;
+  data.OCtune = OCtune;
+  //
+  data.rx_gain_calibration = to_short(rx_gain_calibration);
+  data.OCfull_tune_time = to_short(OCfull_tune_time);
+  data.OCmemory_tune_time = to_short(OCmemory_tune_time);
+  //
+  data.frequency_calibration = to_ll(frequency_calibration);
+  send_bytes(sock, (char *)&data, sizeof(RADIOMENU_DATA));
+}
+
+void send_memory_data(int sock, int index) {
+  MEMORY_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_MEMORY);
+  data.index              = index;
+  data.sat_mode           = mem[index].sat_mode;
+  data.ctun               = mem[index].ctun;
+  data.mode               = mem[index].mode;
+  data.filter             = mem[index].filter;
+  data.bd                 = mem[index].bd;
+  data.alt_ctun           = mem[index].alt_ctun;
+  data.alt_mode           = mem[index].alt_mode;
+  data.alt_filter         = mem[index].alt_filter;
+  data.alt_bd             = mem[index].alt_bd;
+  data.ctcss_enabled      = mem[index].ctcss_enabled;
+  data.ctcss              = mem[index].ctcss;
+  //
+  data.deviation          = to_short(mem[index].deviation);
+  data.alt_deviation      = to_short(mem[index].alt_deviation);
+  //
+  data.frequency          = to_ll(mem[index].frequency);
+  data.ctun_frequency     = to_ll(mem[index].ctun_frequency);
+  data.alt_frequency      = to_ll(mem[index].frequency);
+  data.alt_ctun_frequency = to_ll(mem[index].ctun_frequency);
+  send_bytes(sock, (char *)&data, sizeof(MEMORY_DATA));
+}
+
+void send_band_data(int sock, int b) {
+  BAND_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_BAND);
+  BAND *band = band_get_band(b);
+  snprintf(data.title, sizeof(data.title), "%s", band->title);
+  data.band = b;
+  data.OCrx = band->OCrx;
+  data.OCtx = band->OCtx;
+  data.alexRxAntenna = band->alexRxAntenna;
+  data.alexTxAntenna = band->alexTxAntenna;
+  data.alexAttenuation = band->alexAttenuation;
+  data.disablePA = band->disablePA;
+  data.current = band->bandstack->current_entry;
+  data.gain = to_short(band->gain);
+  data.pa_calibration = to_double(band->pa_calibration);
+  data.frequencyMin = to_ll(band->frequencyMin);
+  data.frequencyMax = to_ll(band->frequencyMax);
+  data.frequencyLO = to_ll(band->frequencyLO);
+  data.errorLO = to_ll(band->errorLO);
+  send_bytes(sock, (char *)&data, sizeof(BAND_DATA));
+}
+
+void send_xvtr_changed(int sock) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_XVTR);
+  send_bytes(sock, (char *)&header, sizeof(HEADER));
+}
+
+void send_bandstack_data(int sock, int b, int stack) {
+  BANDSTACK_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_BANDSTACK);
+  BAND *band = band_get_band(b);
+  BANDSTACK_ENTRY *entry = band->bandstack->entry;
+  entry += stack;
+  data.band = b;
+  data.stack = stack;
+  data.mode = entry->mode;
+  data.filter = entry->filter;
+  data.ctun = entry->ctun;
+  data.ctcss_enabled = entry->ctcss_enabled;
+  data.ctcss = entry->ctcss;
+  data.deviation = to_short(entry->deviation);
+  data.frequency = to_ll(entry->frequency);
+  data.ctun_frequency = to_ll(entry->ctun_frequency);
+  send_bytes(sock, (char *)&data, sizeof(BANDSTACK_DATA));
+}
+
+void send_radio_data(int sock) {
+  RADIO_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_RADIO);
+  snprintf(data.name, sizeof(data.name), "%s", radio->name);
+  data.locked = locked;
+  data.protocol = protocol;
+  data.supported_receivers = radio->supported_receivers;
+  data.receivers = receivers;
+  data.filter_board = filter_board;
+  data.enable_auto_tune = enable_auto_tune;
+  data.new_pa_board = new_pa_board;
+  data.region = region;
+  data.atlas_penelope = atlas_penelope;
+  data.atlas_clock_source_10mhz = atlas_clock_source_10mhz;
+  data.atlas_clock_source_128mhz = atlas_clock_source_128mhz;
+  data.atlas_mic_source = atlas_mic_source;
+  data.atlas_janus = atlas_janus;
+  data.hl2_audio_codec = hl2_audio_codec;
+  data.anan10E = anan10E;
+  data.tx_out_of_band_allowed = tx_out_of_band_allowed;
+  data.pa_enabled = pa_enabled;
+  data.mic_boost = mic_boost;
+  data.mic_linein = mic_linein;
+  data.mic_ptt_enabled = mic_ptt_enabled;
+  data.mic_bias_enabled = mic_bias_enabled;
+  data.mic_ptt_tip_bias_ring = mic_ptt_tip_bias_ring;
+  data.mic_input_xlr = mic_input_xlr;
+  data.cw_keyer_sidetone_volume = cw_keyer_sidetone_volume;
+  data.OCtune = OCtune;
+  data.mute_rx_while_transmitting = mute_rx_while_transmitting;
+  data.mute_spkr_amp = mute_spkr_amp;
+  data.adc0_filter_bypass = adc0_filter_bypass;
+  data.adc1_filter_bypass = adc1_filter_bypass;
+  data.split = split;
+  data.sat_mode = sat_mode;
+  data.duplex = duplex;
+  data.have_rx_gain = have_rx_gain;
+  data.have_rx_att = have_rx_att;
+  data.have_alex_att = have_alex_att;
+  data.have_preamp = have_preamp;
+  data.have_dither = have_dither;
+  data.have_saturn_xdma = have_saturn_xdma;
+  data.rx_stack_horizontal = rx_stack_horizontal;
+  data.n_adc = n_adc;
+  data.diversity_enabled = diversity_enabled;
+  data.soapy_iqswap = soapy_iqswap;
+  data.soapy_rx_antennas = radio->info.soapy.rx_antennas;
+  data.soapy_tx_antennas = radio->info.soapy.tx_antennas;
+  data.soapy_rx_gains = radio->info.soapy.rx_gains;
+  data.soapy_tx_gains = radio->info.soapy.tx_gains;
+  data.soapy_tx_channels = radio->info.soapy.tx_channels;
+  data.soapy_rx_has_automatic_gain = radio->info.soapy.rx_has_automatic_gain;
+  //
+  memcpy(data.soapy_hardware_key, radio->info.soapy.hardware_key, 64);
+  memcpy(data.soapy_driver_key, radio->info.soapy.driver_key, 64);
+
+  for (int i = 0; i < radio->info.soapy.rx_antennas; i++) {
+    memcpy(data.soapy_rx_antenna[i], radio->info.soapy.rx_antenna[i], 64);
+  }
+
+  for (int i = 0; i < radio->info.soapy.tx_antennas; i++) {
+    memcpy(data.soapy_tx_antenna[i], radio->info.soapy.tx_antenna[i], 64);
+  }
+
+  for (int i = 0; i < radio->info.soapy.rx_gains; i++) {
+    memcpy(data.soapy_rx_gain_elem_name[i], radio->info.soapy.rx_gain_elem_name[i], 64);
+  }
+
+  for (int i = 0; i < radio->info.soapy.tx_gains; i++) {
+    memcpy(data.soapy_tx_gain_elem_name[i], radio->info.soapy.tx_gain_elem_name[i], 64);
+  }
+
+  //
+  data.pa_power = to_short(pa_power);
+  data.OCfull_tune_time = to_short(OCfull_tune_time);
+  data.OCmemory_tune_time = to_short(OCmemory_tune_time);
+  data.cw_keyer_sidetone_frequency = to_short(cw_keyer_sidetone_frequency);
+  data.rx_gain_calibration = to_short(rx_gain_calibration);
+  data.device = to_short(device);
+  data.display_width = to_short(display_width);
+  //
+  data.drive_min = to_double(drive_min);
+  data.drive_max = to_double(drive_max);
+  data.drive_digi_max = to_double(drive_digi_max);
+  data.div_gain = to_double(div_gain);
+  data.div_phase = to_double(div_phase);
+
+  for (int i = 0; i < 11; i++) {
+    data.pa_trim[i] = to_double(pa_trim[i]);
+  }
+
+  data.soapy_rx_gain_step = to_double(radio->info.soapy.rx_gain_step);
+  data.soapy_rx_gain_min  = to_double(radio->info.soapy.rx_gain_min );
+  data.soapy_rx_gain_max  = to_double(radio->info.soapy.rx_gain_max );
+  data.soapy_tx_gain_step = to_double(radio->info.soapy.tx_gain_step);
+  data.soapy_tx_gain_min  = to_double(radio->info.soapy.tx_gain_min );
+  data.soapy_tx_gain_max  = to_double(radio->info.soapy.tx_gain_max );
+
+  for (int i = 0; i < radio->info.soapy.rx_gains; i++) {
+    data.soapy_rx_gain_elem_step[i] = to_double(radio->info.soapy.rx_gain_elem_step[i]);
+    data.soapy_rx_gain_elem_min[i] = to_double(radio->info.soapy.rx_gain_elem_min[i]);
+    data.soapy_rx_gain_elem_max[i] = to_double(radio->info.soapy.rx_gain_elem_max[i]);
+  }
+
+  for (int i = 0; i < radio->info.soapy.tx_gains; i++) {
+    data.soapy_tx_gain_elem_step[i] = to_double(radio->info.soapy.tx_gain_elem_step[i]);
+    data.soapy_tx_gain_elem_min[i] = to_double(radio->info.soapy.tx_gain_elem_min[i]);
+    data.soapy_tx_gain_elem_max[i] = to_double(radio->info.soapy.tx_gain_elem_max[i]);
+  }
+
+  //
   data.frequency_calibration = to_ll(frequency_calibration);
   data.soapy_radio_sample_rate = to_ll(soapy_radio_sample_rate);
   data.radio_frequency_min = to_ll(radio->frequency_min);
@@ -940,1788 +2089,3299 @@ void send_radio_data(int sock) {
   send_bytes(sock, (char *)&data, sizeof(RADIO_DATA));
 }
 
-void send_dac_data(int sock) {
-  DAC_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(INFO_DAC);
-  data.antenna = dac.antenna;
-  data.gain    = to_double(dac.gain);
-  send_bytes(sock, (char *)&data, sizeof(DAC_DATA));
+void send_dac_data(int sock) {
+  DAC_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_DAC);
+  data.antenna = dac.antenna;
+  data.gain    = to_double(dac.gain);
+  send_bytes(sock, (char *)&data, sizeof(DAC_DATA));
+}
+
+void send_adc_data(int sock, int i) {
+  ADC_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_ADC);
+  data.adc = i;
+  data.antenna = to_short(adc[i].antenna);
+  data.attenuation = to_short(adc[i].attenuation);
+  data.gain = to_double(adc[i].gain);
+  data.min_gain = to_double(adc[i].min_gain);
+  data.max_gain = to_double(adc[i].max_gain);
+  send_bytes(sock, (char *)&data, sizeof(ADC_DATA));
+}
+
+static void send_tx_data(int sock) {
+  if (can_transmit) {
+    TRANSMITTER_DATA data;
+    const TRANSMITTER *tx = transmitter;
+    SYNC(data.header.sync);
+    data.header.data_type = to_short(INFO_TRANSMITTER);
+    //
+    data.id = tx->id;
+    data.dac = tx->dac;
+    data.display_detector_mode = tx->display_detector_mode;
+    data.display_average_mode = tx->display_average_mode;
+    data.use_rx_filter = tx->use_rx_filter;
+    data.alex_antenna = tx->alex_antenna;
+    data.puresignal = tx->puresignal;
+    data.feedback = tx->feedback;
+    data.auto_on = tx->auto_on;
+    data.ps_oneshot = tx->ps_oneshot;
+    data.ctcss_enabled = tx->ctcss_enabled;
+    data.ctcss = tx->ctcss;
+    data.pre_emphasize = tx->pre_emphasize;
+    data.drive = tx->drive;
+    data.tune_use_drive = tx->tune_use_drive;
+    data.tune_drive = tx->tune_drive;
+    data.compressor = tx->compressor;
+    data.cfc = tx->cfc;
+    data.cfc_eq = tx->cfc_eq;
+    data.dexp = tx->dexp;
+    data.dexp_filter = tx->dexp_filter;
+    data.eq_enable = tx->eq_enable;
+    data.alcmode = tx->alcmode;
+    data.swr_protection = tx->swr_protection;
+    //
+    data.fps = to_short(tx->fps);
+    data.dexp_filter_low = to_short(tx->dexp_filter_low);
+    data.dexp_filter_high = to_short(tx->dexp_filter_high);
+    data.dexp_trigger = to_short(tx->dexp_trigger);
+    data.dexp_exp = to_short(tx->dexp_exp);
+    data.filter_low = to_short(tx->filter_low);
+    data.filter_high = to_short(tx->filter_high);
+    data.deviation = to_short(tx->deviation);
+    data.width = to_short(tx->width);
+    data.height = to_short(tx->height);
+    data.attenuation = to_short(tx->attenuation);
+    data.tx_default_filter_low = to_short(tx->default_filter_low);
+    data.tx_default_filter_high = to_short(tx->default_filter_high);
+    data.fft_size = to_ll(tx->fft_size);
+
+    //
+    for (int i = 0; i < 11; i++) {
+      data.eq_freq[i] =  to_double(tx->eq_freq[i]);
+      data.eq_gain[i] =  to_double(tx->eq_gain[i]);
+      data.cfc_freq[i] =  to_double(tx->cfc_freq[i]);
+      data.cfc_lvl[i] =  to_double(tx->cfc_lvl[i]);
+      data.cfc_post[i] =  to_double(tx->cfc_post[i]);
+    }
+
+    data.swr_alarm = to_double(tx->swr_alarm);
+    data.dexp_tau =  to_double(tx->dexp_tau);
+    data.dexp_attack =  to_double(tx->dexp_attack);
+    data.dexp_release =  to_double(tx->dexp_release);
+    data.dexp_hold =  to_double(tx->dexp_hold);
+    data.dexp_hyst =  to_double(tx->dexp_hyst);
+    data.mic_gain =  to_double(tx->mic_gain);
+    data.compressor_level =  to_double(tx->compressor_level);
+    data.am_carrier_level = to_double(tx->am_carrier_level);
+    data.display_average_time =  to_double(tx->display_average_time);
+    data.ps_ampdelay =  to_double(tx->ps_ampdelay);
+    data.ps_moxdelay =  to_double(tx->ps_moxdelay);
+    data.ps_loopdelay =  to_double(tx->ps_loopdelay);
+    send_bytes(sock, (char *)&data, sizeof(TRANSMITTER_DATA));
+  }
+}
+
+static void send_rx_data(int sock, int id) {
+  RECEIVER_DATA data;
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_RECEIVER);
+  const RECEIVER *rx = receiver[id];
+  data.id                    = rx->id;
+  data.adc                   = rx->adc;
+  data.agc                   = rx->agc;
+  data.nb                    = rx->nb;
+  data.nb2_mode              = rx->nb2_mode;
+  data.nr                    = rx->nr;
+  data.nr_agc                = rx->nr_agc;
+  data.nr2_ae                = rx->nr2_ae;
+  data.nr2_gain_method       = rx->nr2_gain_method;
+  data.nr2_npe_method        = rx->nr2_npe_method;
+  data.anf                   = rx->anf;
+  data.snb                   = rx->snb;
+  data.display_detector_mode = rx->display_detector_mode;
+  data.display_average_mode  = rx->display_average_mode;
+  data.zoom                  = rx->zoom;
+  data.dither                = rx->dither;
+  data.random                = rx->random;
+  data.preamp                = rx->preamp;
+  data.alex_antenna          = rx->alex_antenna;
+  data.alex_attenuation      = rx->alex_attenuation;
+  data.squelch_enable        = rx->squelch_enable;
+  data.binaural              = rx->binaural;
+  data.eq_enable             = rx->eq_enable;
+  data.smetermode            = rx->smetermode;
+  data.low_latency           = rx->low_latency;
+  //
+  data.fps                   = to_short(rx->fps);
+  data.filter_low            = to_short(rx->filter_low);
+  data.filter_high           = to_short(rx->filter_high);
+  data.deviation             = to_short(rx->deviation);
+  data.pan                   = to_short(rx->pan);
+  data.width                 = to_short(rx->width);
+  //
+  data.hz_per_pixel          = to_double(rx->hz_per_pixel);
+  data.squelch               = to_double(rx->squelch);
+  data.display_average_time  = to_double(rx->display_average_time);
+  data.volume                = to_double(rx->volume);
+  data.agc_gain              = to_double(rx->agc_gain);
+  data.agc_hang              = to_double(rx->agc_hang);
+  data.agc_thresh            = to_double(rx->agc_thresh);
+  data.agc_hang_threshold    = to_double(rx->agc_hang_threshold);
+  data.nr2_trained_threshold = to_double(rx->nr2_trained_threshold);
+  data.nr2_trained_t2        = to_double(rx->nr2_trained_t2);
+  data.nb_tau                = to_double(rx->nb_tau);
+  data.nb_hang               = to_double(rx->nb_hang);
+  data.nb_advtime            = to_double(rx->nb_advtime);
+  data.nb_thresh             = to_double(rx->nb_thresh);
+#ifdef EXTNR
+  data.nr4_reduction_amount  = to_double(rx->nr4_reduction_amount);
+  data.nr4_smoothing_factor  = to_double(rx->nr4_smoothing_factor);
+  data.nr4_whitening_factor  = to_double(rx->nr4_whitening_factor);
+  data.nr4_noise_rescale     = to_double(rx->nr4_noise_rescale);
+  data.nr4_post_threshold    = to_double(rx->nr4_post_threshold);
+#else
+  //
+  // If this side is not compiled with EXTNR, fill in default values
+  //
+  data.nr4_reduction_amount  = to_double(10.0);
+  data.nr4_smoothing_factor  = to_double(0.0);
+  data.nr4_whitening_factor  = to_double(0.0);
+  data.nr4_noise_rescale     = to_double(2.0);
+  data.nr4_post_threshold    = to_double(-10.0);
+#endif
+
+  for (int i = 0; i < 11; i++) {
+    data.eq_freq[i]          = to_double(rx->eq_freq[i]);
+    data.eq_gain[i]          = to_double(rx->eq_gain[i]);
+  }
+
+  data.fft_size              = to_ll(rx->fft_size);
+  data.sample_rate           = to_ll(rx->sample_rate);
+  send_bytes(sock, (char *)&data, sizeof(RECEIVER_DATA));
+}
+
+static void vfo_data_fill(VFO_DATA *d, int v) {
+  VFO_DATA vfo_data;
+  memset(&vfo_data, 0, sizeof(vfo_data));
+  SYNC(vfo_data.header.sync);
+  vfo_data.header.data_type = to_short(INFO_VFO);
+  vfo_data.vfo = v;
+  vfo_data.band = vfo[v].band;
+  vfo_data.bandstack = vfo[v].bandstack;
+  vfo_data.mode = vfo[v].mode;
+  vfo_data.filter = vfo[v].filter;
+  vfo_data.ctun = vfo[v].ctun;
+  vfo_data.rit_enabled = vfo[v].rit_enabled;
+  vfo_data.xit_enabled = vfo[v].xit_enabled;
+  vfo_data.cwAudioPeakFilter = vfo[v].cwAudioPeakFilter;
+  //
+  vfo_data.rit_step  = to_short(vfo[v].rit_step);
+  vfo_data.deviation = to_short(vfo[v].deviation);
+  //
+  vfo_data.frequency = to_ll(vfo[v].frequency);
+  vfo_data.ctun_frequency = to_ll(vfo[v].ctun_frequency);
+  vfo_data.rit = to_ll(vfo[v].rit);
+  vfo_data.xit = to_ll(vfo[v].xit);
+  vfo_data.lo = to_ll(vfo[v].lo);
+  vfo_data.offset = to_ll(vfo[v].offset);
+  vfo_data.step   = to_ll(vfo[v].step);
+  *d = vfo_data;
+}
+
+void send_vfo_data(int sock, int v) {
+  VFO_DATA vfo_data;
+  vfo_data_fill(&vfo_data, v);
+
+  if (sock == REMOTE_BROADCAST && v >= 0 && v < 2) { server_vfo_sent[v] = vfo_data; }
+
+  send_bytes(sock, (char *)&vfo_data, sizeof(vfo_data));
+}
+
+//
+// The server code is running on the "local" computer
+// (with direct cable connection to the radio hardware)
+//
+//
+// Commands that change the radio are only accepted from the controlling
+// client. They are passed to the GTK thread through a lock-free queue
+// and executed there in batches.
+//
+static void server_command(const REMOTE_CLIENT *client, void *command) {
+  if (!client->controlling || !command_queue_push(&server_commands, command)) {
+    g_free(command);
+  }
+}
+
+//
+// The sections of the initial sync, see state_cache.h
+//
+static void server_sync_section(int section) {
+  switch (section) {
+  case STATE_RADIO:
+    //
+    // Global variables, ADC and DAC data, and the
+    // filter edges of the Var1 and Var2 filters
+    //
+    send_radio_data(REMOTE_CAPTURE);
+    send_adc_data(REMOTE_CAPTURE, 0);
+    send_adc_data(REMOTE_CAPTURE, 1);
+    send_dac_data(REMOTE_CAPTURE);
+
+    for (int m = 0; m < MODES;  m++) {
+      send_filter_var(REMOTE_CAPTURE, m, filterVar1);
+      send_filter_var(REMOTE_CAPTURE, m, filterVar2);
+    }
+
+    break;
+
+  case STATE_RX:
+    //
+    // Receiver data. For HPSDR, this includes the PS RX feedback
+    // receiver since it has a setting (antenna used for feedpack) that
+    // can be changed through the GUI
+    //
+    for (int i = 0; i < RECEIVERS; i++) {
+      send_rx_data(REMOTE_CAPTURE, i);
+    }
+
+    if (protocol == ORIGINAL_PROTOCOL || protocol == NEW_PROTOCOL) {
+      send_rx_data(REMOTE_CAPTURE, PS_RX_FEEDBACK);
+    }
+
+    break;
+
+  case STATE_VFO:
+    send_vfo_data(REMOTE_CAPTURE, VFO_A);
+    send_vfo_data(REMOTE_CAPTURE, VFO_B);
+    break;
+
+  case STATE_BAND:
+    for (int b = 0; b < BANDS + XVTRS; b++) {
+      send_band_data(REMOTE_CAPTURE, b);
+      const BAND *band = band_get_band(b);
+
+      for (int s = 0; s < band->bandstack->entries; s++) {
+        send_bandstack_data(REMOTE_CAPTURE, b, s);
+      }
+    }
+
+    break;
+
+  case STATE_MEMORY:
+    for (int i = 0; i < NUM_OF_MEMORYS; i++) {
+      send_memory_data(REMOTE_CAPTURE, i);
+    }
+
+    break;
+
+  case STATE_TX:
+    send_tx_data(REMOTE_CAPTURE);
+    break;
+  }
+}
+
+static void server_sync(REMOTE_CLIENT *client, const STATE_RESUME *resume) {
+  STATE_DATA data;
+  int valid = resume->header.b1;
+  t_print("%s: Client connected on port %d\n", __FUNCTION__, client->address.sin_port);
+  //
+  // Allocate jitter buffer for TX mic data. It is never
+  // destroyed since the TX thread may access it at any time.
+  //
+  if (mic_jitter_buffer == NULL) {
+    mic_jitter_buffer = jitter_buffer_new(AUDIO_DATA_SIZE, AUDIO_PLAYOUT_SIZE);
+  }
+
+  //
+  // Collect the sections, and put those the client does not
+  // have yet into one packet.
+  //
+  GByteArray *payload = g_byte_array_new();
+  SYNC(data.header.sync);
+  data.header.data_type = to_short(INFO_STATE);
+  data.header.b1 = 0;
+  data.header.b2 = 0;
+  data.header.s1 = to_short(0);
+  data.header.s2 = to_short(0);
+  g_mutex_lock(&capture_mutex);
+
+  for (int i = 0; i < STATE_SECTIONS; i++) {
+    capture_buffer = g_byte_array_new();
+    server_sync_section(i);
+    uint64_t hash = state_hash(capture_buffer->data, capture_buffer->len);
+    data.hash[i] = to_ll(hash);
+    data.section_length[i] = to_int(0);
+
+    if (!(valid & (1 << i)) || (uint64_t) from_ll(resume->hash[i]) != hash) {
+      data.header.b1 |= 1 << i;
+      data.section_length[i] = to_int(capture_buffer->len);
+      g_byte_array_append(payload, capture_buffer->data, capture_buffer->len);
+    }
+
+    g_byte_array_free(capture_buffer, TRUE);
+  }
+
+  capture_buffer = NULL;
+  g_mutex_unlock(&capture_mutex);
+  data.raw_length = to_int(payload->len);
+  GByteArray *compressed = state_compress(payload->data, payload->len);
+
+  if (compressed != NULL && compressed->len < payload->len) {
+    data.header.b2 = 1;
+    g_byte_array_free(payload, TRUE);
+    payload = compressed;
+  } else if (compressed != NULL) {
+    g_byte_array_free(compressed, TRUE);
+  }
+
+  t_print("%s: initial sync: sections %02x, %u bytes (%u uncompressed)\n", __FUNCTION__,
+          data.header.b1, payload->len, from_int(data.raw_length));
+  data.length = to_int(payload->len);
+  g_byte_array_prepend(payload, (guint8 *)&data, sizeof(STATE_DATA));
+  HEADER start;
+  SYNC(start.sync);
+  start.data_type = to_short(CMD_START_RADIO);
+  SEND_PACKET *state = send_packet_new(SEND_CONTROL, (char *)payload->data, payload->len);
+  SEND_PACKET *go = send_packet_new(SEND_CONTROL, (char *)&start, sizeof(HEADER));
+  g_byte_array_free(payload, TRUE);
+  //
+  // Queue the state and the command that starts the radio, and only
+  // then mark the client as running. Since spectrum and audio are
+  // queued with client_mutex locked as well, they cannot get ahead
+  // of INFO_STATE.
+  //
+  g_mutex_lock(&client_mutex);
+  client->running = TRUE;
+  client_queue_push(client, state);
+  client_queue_push(client, go);
+  remote_clients++;
+  audio_config_gen++;
+  spectrum_config_gen++;
+  g_mutex_unlock(&client_mutex);
+  send_packet_unref(state);
+  send_packet_unref(go);
+}
+
+//
+// Total length of a packet from the client, derived from its header.
+// Returns -1 for unknown packet types.
+//
+static int server_packet_length(const HEADER *header) {
+  switch (from_short(header->data_type)) {
+  case CMD_ADC:
+  case CMD_AGC:
+  case CMD_ANAN10E:
+  case CMD_ATTENUATION:
+  case CMD_AUDIO_CODEC:
+  case CMD_BANDSTACK:
+  case CMD_BAND_SEL:
+  case CMD_BINAURAL:
+  case CMD_CAPTURE:
+  case CMD_CTCSS:
+  case CMD_CTUN:
+  case CMD_CW:
+  case CMD_CWPEAK:
+  case CMD_DEVIATION:
+  case CMD_DUP:
+  case CMD_FILTER_BOARD:
+  case CMD_FILTER_SEL:
+  case CMD_FILTER_VAR:
+  case CMD_HEARTBEAT:
+  case CMD_IQ_STREAM:
+  case CMD_LOCK:
+  case CMD_METER:
+  case CMD_MODE:
+  case CMD_MOX:
+  case CMD_MUTE_RX:
+  case CMD_PAN:
+  case CMD_PREEMP:
+  case CMD_PSATT:
+  case CMD_PSONOFF:
+  case CMD_PSRESET:
+  case CMD_PSRESUME:
+  case CMD_RCL:
+  case CMD_RECEIVERS:
+  case CMD_REGION:
+  case CMD_RIT:
+  case CMD_RIT_STEP:
+  case CMD_RX_FILTER_CUT:
+  case CMD_RX_FPS:
+  case CMD_RX_SELECT:
+  case CMD_RX_SPECTRUM:
+  case CMD_SAT:
+  case CMD_SCREEN:
+  case CMD_SIDETONEFREQ:
+  case CMD_SOAPY_AGC:
+  case CMD_SOAPY_RXANT:
+  case CMD_SOAPY_TXANT:
+  case CMD_SPLIT:
+  case CMD_STEP:
+  case CMD_STORE:
+  case CMD_TOGGLE_MOX:
+  case CMD_TOGGLE_TUNE:
+  case CMD_TUNE:
+  case CMD_TWOTONE:
+  case CMD_TXFILTER:
+  case CMD_TX_FILTER_CUT:
+  case CMD_TX_FPS:
+  case CMD_TX_SPECTRUM:
+  case CMD_VFO_A_TO_B:
+  case CMD_VFO_B_TO_A:
+  case CMD_VFO_SWAP:
+  case CMD_VOX:
+  case CMD_XIT:
+  case CMD_XVTR:
+  case CMD_ZOOM:
+    return sizeof(HEADER);
+
+  case INFO_BAND:
+    return sizeof(BAND_DATA);
+
+  case INFO_BANDSTACK:
+    return sizeof(BANDSTACK_DATA);
+
+  case INFO_ADC:
+    return sizeof(ADC_DATA);
+
+  case INFO_DAC:
+    return sizeof(DAC_DATA);
+
+  case CMD_SPECTRUM_FORMAT:
+    return sizeof(SPECTRUM_FORMAT_COMMAND);
+
+  case CMD_PING:
+    return sizeof(PING_COMMAND);
+
+  case CMD_UDP:
+    return sizeof(UDP_COMMAND);
+
+  case CMD_BATCH: {
+    int payload = from_short(header->s1);
+
+    if (payload < (int)sizeof(HEADER) || payload > COMMAND_BATCH_SIZE) {
+      t_print("%s: invalid batch length %d\n", __FUNCTION__, payload);
+      return -1;
+    }
+
+    return sizeof(HEADER) + payload;
+  }
+
+  case CMD_AGC_GAIN:
+    return sizeof(AGC_GAIN_COMMAND);
+
+  case CMD_NOISE:
+    return sizeof(NOISE_COMMAND);
+
+  case CMD_RX_EQ:
+  case CMD_TX_EQ:
+    return sizeof(EQUALIZER_COMMAND);
+
+  case CMD_RADIOMENU:
+    return sizeof(RADIOMENU_DATA);
+
+  case CMD_RXMENU:
+    return sizeof(RXMENU_DATA);
+
+  case CMD_DIVERSITY:
+    return sizeof(DIVERSITY_COMMAND);
+
+  case CMD_DEXP:
+    return sizeof(DEXP_DATA);
+
+  case CMD_COMPRESSOR:
+    return sizeof(COMPRESSOR_DATA);
+
+  case CMD_TXMENU:
+    return sizeof(TXMENU_DATA);
+
+  case CMD_PSPARAMS:
+    return sizeof(PS_PARAMS);
+
+  case CMD_PATRIM:
+    return sizeof(PATRIM_DATA);
+
+  case CMD_DRIVE:
+  case CMD_DIGIMAX:
+  case CMD_SQUELCH:
+  case CMD_MICGAIN:
+  case CMD_RFGAIN:
+  case CMD_VOLUME:
+  case CMD_RX_DISPLAY:
+  case CMD_AMCARRIER:
+  case CMD_TX_DISPLAY:
+    return sizeof(DOUBLE_COMMAND);
+
+  case CMD_SAMPLE_RATE:
+  case CMD_VFO_STEPSIZE:
+  case CMD_MOVETO:
+  case CMD_RXFFT:
+  case CMD_TXFFT:
+  case CMD_FREQ:
+  case CMD_MOVE:
+    return sizeof(U64_COMMAND);
+
+  case INFO_TXAUDIO: {
+    int payload = from_short(header->s1);
+
+    if (payload < 3 || payload > (int)(sizeof(TXAUDIO_DATA) - sizeof(HEADER))) {
+      t_print("%s: invalid TX audio payload length %d\n", __FUNCTION__, payload);
+      return -1;
+    }
+
+    return sizeof(HEADER) + payload;
+  }
+
+  default:
+    t_print("%s: UNKNOWN command: %d\n", __FUNCTION__, from_short(header->data_type));
+    return -1;
+  }
+}
+
+//
+// The client requests the UDP side channel. Data keeps flowing over TCP
+// until its hello datagram has arrived (see io_udp_read()). If there is
+// no UDP socket, the reply has port 0 and the client stays on TCP.
+//
+static void server_udp_open(REMOTE_CLIENT *client, int fec) {
+  UDP_COMMAND reply;
+  g_mutex_lock(&client_mutex);
+
+  if (client->udp_sender == NULL) { client->udp_sender = g_new(UDP_SENDER, UDP_CHANNELS); }
+
+  //
+  // FEC only for audio and IQ: a lost spectrum frame is simply replaced by the next one
+  //
+  for (int i = 0; i < UDP_CHANNELS; i++) {
+    udp_sender_init(&client->udp_sender[i], (i < UDP_CHANNEL_SPECTRUM || i >= UDP_CHANNEL_IQ) ? fec : 0);
+  }
+
+  client->udp_active = FALSE;
+  client->udp_token = g_random_int();
+  client->udp_dropped = 0;
+  g_mutex_unlock(&client_mutex);
+  SYNC(reply.header.sync);
+  reply.header.data_type = to_short(CMD_UDP);
+  reply.header.b1 = client->udp_sender[UDP_CHANNEL_AUDIO].fec;
+  reply.header.b2 = UDP_OPEN;
+  reply.header.s1 = to_short(udp_socket >= 0 ? listen_port : 0);
+  reply.token = to_int(client->udp_token);
+  send_bytes(client->socket, (char *)&reply, sizeof(reply));
+}
+
+//
+// Process one complete packet from the client
+//
+static void server_packet(REMOTE_CLIENT *client, const uint8_t *packet) {
+  HEADER header;
+  memcpy(&header, packet, sizeof(HEADER));
+  int data_type = from_short(header.data_type);
+  //t_print("%s: received header: type=%d\n", __FUNCTION__, data_type);
+
+  switch (data_type) {
+  case CMD_HEARTBEAT:
+    // periodically sent to  keep  connection alive
+    break;
+
+  case CMD_AUDIO_CODEC: {
+    //
+    // The client requests a codec for the RX audio. If this codec is not
+    // available here, use ADPCM instead. The codec that is actually used
+    // is reported back to the client. The audio streams are set up again
+    // in the RX thread(s).
+    //
+    int codec = header.b1;
+    int bitrate = from_short(header.s1);
+    int frame = from_short(header.s2);
+
+    if (frame < 64 || frame > AUDIO_CODEC_MAX_FRAME) { frame = AUDIO_DATA_SIZE; }
+
+    if (!audio_codec_supported(codec)) {
+      t_print("%s: RX audio codec %d not available, using ADPCM\n", __FUNCTION__, codec);
+      codec = AUDIO_CODEC_ADPCM;
+      bitrate = 384;
+    }
+
+    t_print("%s: RX audio codec %s, %d kbit/s, %d samples per packet\n", __FUNCTION__, audio_codec_name(codec),
+            bitrate, frame);
+    g_mutex_lock(&client_mutex);
+    client->audio_codec = codec;
+    client->audio_bitrate = bitrate;
+    client->audio_frame = frame;
+    client->audio_stream[0] = client->audio_stream[1] = -1;
+    audio_config_gen++;
+    g_mutex_unlock(&client_mutex);
+    header.b1 = codec;
+    header.s1 = to_short(bitrate);
+    send_bytes(client->socket, (char *)&header, sizeof(HEADER));
+  }
+  break;
+
+  case INFO_TXAUDIO: {
+    //
+    // TX audio data is IMMEDIATELY (not through the GTK queue) put to the
+    // jitter buffer. The packets have a variable length, the payload length
+    // is in the header (and has been checked by server_packet_length).
+    //
+    const TXAUDIO_DATA *data = (const TXAUDIO_DATA *)packet;
+    int payload = from_short(header.s1);
+    short samples[AUDIO_DATA_SIZE];
+    int numsamples = from_short(data->numsamples);
+
+    if (numsamples > (payload - 3) / 2) { numsamples = (payload - 3) / 2; }
+
+    for (int i = 0; i < numsamples; i++) {
+      samples[i] = from_short(data->samples[i]);
+    }
+
+    //
+    // Only the controlling client may transmit
+    //
+    if (numsamples > 0 && client->controlling) {
+      jitter_buffer_put(mic_jitter_buffer, samples, numsamples, 1);
+    }
+  }
+  break;
+
+  case INFO_BAND: {
+    BAND_DATA *command = g_new(BAND_DATA, 1);
+    memcpy(command, packet, sizeof(BAND_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case INFO_BANDSTACK: {
+    BANDSTACK_DATA *command = g_new(BANDSTACK_DATA, 1);
+    memcpy(command, packet, sizeof(BANDSTACK_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case INFO_ADC: {
+    //
+    // Sending ADC data from the client to the server has a very limited scope:
+    // - antenna (for SoapySDR)
+    //
+    ADC_DATA *command = g_new(ADC_DATA, 1);
+    memcpy(command, packet, sizeof(ADC_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case INFO_DAC: {
+    //
+    // Sending DAC data from the client to the server has a very limited scope:
+    // - antenna (for SoapySDR)
+    //
+    DAC_DATA *command = g_new(DAC_DATA, 1);
+    memcpy(command, packet, sizeof(DAC_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_PING: {
+    //
+    // Reply to our ping: round trip time, and the client's own counters
+    //
+    const PING_COMMAND *ping = (const PING_COMMAND *)packet;
+
+    if (header.b1 != 1) { break; }
+
+    double rtt = 1.0E-3 * (double)(g_get_monotonic_time() - from_ll(ping->timestamp));
+    g_mutex_lock(&client_mutex);
+    link_stats_rtt(&client->link, rtt);
+    client->link.client_underruns = from_int(ping->underruns);
+    client->link.client_audio_lost = from_int(ping->audio_lost);
+    client->link.client_spectrum_lost = from_int(ping->spectrum_lost);
+    g_mutex_unlock(&client_mutex);
+  }
+  break;
+
+  case CMD_IQ_STREAM: {
+    //
+    // The client wants to demodulate receiver b1 on its own, or not any
+    // longer. This does not change the radio, so it is also accepted from
+    // clients that are only listening.
+    //
+    int id = header.b1;
+    int rate = from_short(header.s1);
+
+    if (id > 1) { break; }
+
+    g_mutex_lock(&client_mutex);
+    client->iq_rate[id] = header.b2 ? (rate > 0 ? 1000 * rate : -1) : 0;
+    client->iq_stream[id] = -1;
+    audio_config_gen++;
+    g_mutex_unlock(&client_mutex);
+    t_print("%s: RX%d IQ stream %s\n", __FUNCTION__, id + 1, header.b2 ? "requested" : "stopped");
+  }
+  break;
+
+  case CMD_RX_SPECTRUM: {
+    int id = header.b1;
+    int state = header.b2;
+
+    if (id < 0 || id >= 8) { break; }
+
+    g_mutex_lock(&client_mutex);
+    client->send_rx_spectrum[id] = state;
+    spectrum_config_gen++;
+    g_mutex_unlock(&client_mutex);
+  }
+  break;
+
+  case CMD_TX_SPECTRUM: {
+    int state = header.b2;
+    g_mutex_lock(&client_mutex);
+    client->send_tx_spectrum = state;
+    spectrum_config_gen++;
+    g_mutex_unlock(&client_mutex);
+  }
+  break;
+
+  case CMD_SPECTRUM_FORMAT: {
+    //
+    // The client requests a panadapter format. Applied in the
+    // display timer when the next frame is sent.
+    //
+    const SPECTRUM_FORMAT_COMMAND *command = (const SPECTRUM_FORMAT_COMMAND *)packet;
+    int id = command->id;
+
+    if (id > SPECTRUM_TX) { break; }
+
+    SPECTRUM_FORMAT *format = &client->spectrum_format[id];
+    g_mutex_lock(&client_mutex);
+    format->width = from_short(command->width);
+    format->fps = command->fps;
+    format->low = from_short(command->low);
+    format->high = from_short(command->high);
+    format->deadband = command->deadband;
+    format->active = 1;
+    spectrum_config_gen++;
+    g_mutex_unlock(&client_mutex);
+    t_print("%s: spectrum %d: width=%d fps=%d range=%d...%d deadband=%d\n", __FUNCTION__, id,
+            format->width, format->fps, format->low, format->high, format->deadband);
+  }
+  break;
+
+  case CMD_BATCH: {
+    //
+    // Several commands in one packet, processed as if they had come
+    // one by one. Batches cannot be nested.
+    //
+    const uint8_t *p = packet + sizeof(HEADER);
+    int rest = from_short(header.s1);
+
+    while (rest >= (int)sizeof(HEADER)) {
+      const HEADER *h = (const HEADER *)p;
+      int len = -1;
+
+      if (memcmp(h->sync, syncbytes, sizeof(syncbytes)) == 0 && from_short(h->data_type) != CMD_BATCH) {
+        len = server_packet_length(h);
+      }
+
+      if (len < 0 || len > rest) {
+        t_print("%s: invalid command in batch\n", __FUNCTION__);
+        break;
+      }
+
+      server_packet(client, p);
+      p += len;
+      rest -= len;
+    }
+  }
+  break;
+
+  case CMD_UDP:
+    if (header.b2 == UDP_OPEN) {
+      server_udp_open(client, header.b1);
+    } else if (header.b2 == UDP_KEYFRAME && header.b1 <= SPECTRUM_TX) {
+      //
+      // A datagram of this panadapter has been lost
+      //
+      g_mutex_lock(&client_mutex);
+      client->spectrum_resync[header.b1] = 1;
+      g_mutex_unlock(&client_mutex);
+    }
+
+    break;
+
+  case CMD_AGC_GAIN: {
+    AGC_GAIN_COMMAND *command = g_new(AGC_GAIN_COMMAND, 1);
+    memcpy(command, packet, sizeof(AGC_GAIN_COMMAND));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_NOISE: {
+    NOISE_COMMAND *command = g_new(NOISE_COMMAND, 1);
+    memcpy(command, packet, sizeof(NOISE_COMMAND));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_RX_EQ:
+  case CMD_TX_EQ: {
+    EQUALIZER_COMMAND *command = g_new(EQUALIZER_COMMAND, 1);
+    memcpy(command, packet, sizeof(EQUALIZER_COMMAND));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_RADIOMENU: {
+    RADIOMENU_DATA *command = g_new(RADIOMENU_DATA, 1);
+    memcpy(command, packet, sizeof(RADIOMENU_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_RXMENU: {
+    RXMENU_DATA *command = g_new(RXMENU_DATA, 1);
+    memcpy(command, packet, sizeof(RXMENU_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_DIVERSITY: {
+    DIVERSITY_COMMAND *command = g_new(DIVERSITY_COMMAND, 1);
+    memcpy(command, packet, sizeof(DIVERSITY_COMMAND));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_DEXP: {
+    DEXP_DATA *command = g_new(DEXP_DATA, 1);
+    memcpy(command, packet, sizeof(DEXP_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_COMPRESSOR: {
+    COMPRESSOR_DATA *command = g_new(COMPRESSOR_DATA, 1);
+    memcpy(command, packet, sizeof(COMPRESSOR_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_TXMENU: {
+    TXMENU_DATA *command = g_new(TXMENU_DATA, 1);
+    memcpy(command, packet, sizeof(TXMENU_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_PSPARAMS: {
+    PS_PARAMS *command = g_new(PS_PARAMS, 1);
+    memcpy(command, packet, sizeof(PS_PARAMS));
+    server_command(client, command);
+  }
+  break;
+
+  case CMD_PATRIM: {
+    PATRIM_DATA *command = g_new(PATRIM_DATA, 1);
+    memcpy(command, packet, sizeof(PATRIM_DATA));
+    server_command(client, command);
+  }
+  break;
+
+  //
+  // All commands with a single  "double" in the body
+  //
+  case CMD_DRIVE:
+  case CMD_DIGIMAX:
+  case CMD_SQUELCH:
+  case CMD_MICGAIN:
+  case CMD_RFGAIN:
+  case CMD_VOLUME:
+  case CMD_RX_DISPLAY:
+  case CMD_AMCARRIER:
+  case CMD_TX_DISPLAY: {
+    DOUBLE_COMMAND *command = g_new(DOUBLE_COMMAND, 1);
+    memcpy(command, packet, sizeof(DOUBLE_COMMAND));
+    server_command(client, command);
+  }
+  break;
+
+  //
+  // All commands with a single uint64_t in the command  body
+  //
+  case CMD_SAMPLE_RATE:
+  case CMD_VFO_STEPSIZE:
+  case CMD_MOVETO:
+  case CMD_RXFFT:
+  case CMD_TXFFT:
+  case CMD_FREQ:
+  case CMD_MOVE: {
+    U64_COMMAND *command = g_new(U64_COMMAND, 1);
+    memcpy(command, packet, sizeof(U64_COMMAND));
+    server_command(client, command);
+  }
+  break;
+
+  //
+  // All "header-only" commands simply make a copy of the header and
+  // submit that copy  to remote_command().
+  //
+  case CMD_ADC:
+  case CMD_AGC:
+  case CMD_ANAN10E:
+  case CMD_ATTENUATION:
+  case CMD_BANDSTACK:
+  case CMD_BAND_SEL:
+  case CMD_BINAURAL:
+  case CMD_CAPTURE:
+  case CMD_CTCSS:
+  case CMD_CTUN:
+  case CMD_CW:
+  case CMD_CWPEAK:
+  case CMD_DEVIATION:
+  case CMD_DUP:
+  case CMD_FILTER_BOARD:
+  case CMD_RX_FILTER_CUT:
+  case CMD_TX_FILTER_CUT:
+  case CMD_FILTER_SEL:
+  case CMD_FILTER_VAR:
+  case CMD_LOCK:
+  case CMD_METER:
+  case CMD_MODE:
+  case CMD_MOX:
+  case CMD_MUTE_RX:
+  case CMD_PAN:
+  case CMD_PREEMP:
+  case CMD_PSATT:
+  case CMD_PSONOFF:
+  case CMD_PSRESET:
+  case CMD_PSRESUME:
+  case CMD_RCL:
+  case CMD_RECEIVERS:
+  case CMD_REGION:
+  case CMD_RIT:
+  case CMD_RIT_STEP:
+  case CMD_RX_FPS:
+  case CMD_RX_SELECT:
+  case CMD_SAT:
+  case CMD_SCREEN:
+  case CMD_SIDETONEFREQ:
+  case CMD_SOAPY_AGC:
+  case CMD_SOAPY_RXANT:
+  case CMD_SOAPY_TXANT:
+  case CMD_SPLIT:
+  case CMD_STEP:
+  case CMD_STORE:
+  case CMD_TOGGLE_MOX:
+  case CMD_TOGGLE_TUNE:
+  case CMD_TUNE:
+  case CMD_TWOTONE:
+  case CMD_TX_FPS:
+  case CMD_TXFILTER:
+  case CMD_VFO_A_TO_B:
+  case CMD_VFO_B_TO_A:
+  case CMD_VFO_SWAP:
+  case CMD_VOX:
+  case CMD_XIT:
+  case CMD_XVTR:
+  case CMD_ZOOM: {
+    HEADER *command = g_new(HEADER, 1);
+    *command = header;
+    server_command(client, command);
+  }
+  break;
+
+  default:
+    // cannot happen, server_packet_length() has checked the type
+    break;
+  }
+}
+
+void send_startstop_rxspectrum(int s, int id, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_RX_SPECTRUM);
+  header.b1 = id;
+  header.b2 = state;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_startstop_txspectrum(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_TX_SPECTRUM);
+  header.b2 = state;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_spectrum_format(int s, int id, int width, int fps, int low, int high, int deadband) {
+  SPECTRUM_FORMAT_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_SPECTRUM_FORMAT);
+  command.id = id;
+  command.fps = fps;
+  command.deadband = deadband;
+  command.width = to_short(width);
+  command.low = to_short(low);
+  command.high = to_short(high);
+  send_bytes(s, (char *)&command, sizeof(SPECTRUM_FORMAT_COMMAND));
+}
+
+void send_vfo_frequency(int s, int v, long long hz) {
+  U64_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_FREQ);
+  command.header.b1 = v;
+  command.u64 = to_ll(hz);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_vfo_move_to(int s, int v, long long hz) {
+  U64_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_MOVETO);
+  command.header.b1 = v;
+  command.u64 = to_ll(hz);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+static void send_vfo_move(int s, int id, long long hz, int round) {
+  U64_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_MOVE);
+  command.header.b1 = id;
+  command.header.b2 = round;
+  command.u64 = to_ll(hz);
+  send_bytes(s, (char *)&command, sizeof(command));
 }
 
-void send_adc_data(int sock, int i) {
-  ADC_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(INFO_ADC);
-  data.adc = i;
-  data.antenna = to_short(adc[i].antenna);
-  data.attenuation = to_short(adc[i].attenuation);
-  data.gain = to_double(adc[i].gain);
-  data.min_gain = to_double(adc[i].min_gain);
-  data.max_gain = to_double(adc[i].max_gain);
-  send_bytes(sock, (char *)&data, sizeof(ADC_DATA));
+//
+// VFO moves and steps are added up in the batch
+//
+void update_vfo_move(int v, long long hz, int round) {
+  send_vfo_move(client_socket, v, hz, round);
 }
 
-static void send_tx_data(int sock) {
-  if (can_transmit) {
-    TRANSMITTER_DATA data;
-    const TRANSMITTER *tx = transmitter;
-    SYNC(data.header.sync);
-    data.header.data_type = to_short(INFO_TRANSMITTER);
-    //
-    data.id = tx->id;
-    data.dac = tx->dac;
-    data.display_detector_mode = tx->display_detector_mode;
-    data.display_average_mode = tx->display_average_mode;
-    data.use_rx_filter = tx->use_rx_filter;
-    data.alex_antenna = tx->alex_antenna;
-    data.puresignal = tx->puresignal;
-    data.feedback = tx->feedback;
-    data.auto_on = tx->auto_on;
-    data.ps_oneshot = tx->ps_oneshot;
-    data.ctcss_enabled = tx->ctcss_enabled;
-    data.ctcss = tx->ctcss;
-    data.pre_emphasize = tx->pre_emphasize;
-    data.drive = tx->drive;
-    data.tune_use_drive = tx->tune_use_drive;
-    data.tune_drive = tx->tune_drive;
-    data.compressor = tx->compressor;
-    data.cfc = tx->cfc;
-    data.cfc_eq = tx->cfc_eq;
-    data.dexp = tx->dexp;
-    data.dexp_filter = tx->dexp_filter;
-    data.eq_enable = tx->eq_enable;
-    data.alcmode = tx->alcmode;
-    data.swr_protection = tx->swr_protection;
-    //
-    data.fps = to_short(tx->fps);
-    data.dexp_filter_low = to_short(tx->dexp_filter_low);
-    data.dexp_filter_high = to_short(tx->dexp_filter_high);
-    data.dexp_trigger = to_short(tx->dexp_trigger);
-    data.dexp_exp = to_short(tx->dexp_exp);
-    data.filter_low = to_short(tx->filter_low);
-    data.filter_high = to_short(tx->filter_high);
-    data.deviation = to_short(tx->deviation);
-    data.width = to_short(tx->width);
-    data.height = to_short(tx->height);
-    data.attenuation = to_short(tx->attenuation);
-    data.tx_default_filter_low = to_short(tx->default_filter_low);
-    data.tx_default_filter_high = to_short(tx->default_filter_high);
-    data.fft_size = to_ll(tx->fft_size);
+void send_store(int s, int index) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_STORE);
+  header.b1 = index;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_recall(int s, int index) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_RCL);
+  header.b1 = index;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_vfo_stepsize(int s, int v, int stepsize) {
+  U64_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_VFO_STEPSIZE);
+  command.header.b1 = v;
+  command.u64 = to_ll(stepsize);
+  send_bytes(s, (char *)&command, sizeof(U64_COMMAND));
+}
+
+void send_vfo_step(int s, int v, int steps) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_STEP);
+  header.b1 = v;
+  header.s1 = to_short(steps);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void update_vfo_step(int v, int steps) {
+  send_vfo_step(client_socket, v, steps);
+}
+
+void send_zoom(int s, const RECEIVER *rx) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_ZOOM);
+  header.b1 = rx->id;
+  header.b2 = rx->zoom;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_meter(int s, int metermode, int alcmode) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_METER);
+  header.b1 = metermode;
+  header.b2 = alcmode;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_screen(int s, int hstack, int width) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_SCREEN);
+  header.b1 = hstack;
+  header.s1 = to_short(width);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_pan(int s, const RECEIVER *rx) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_PAN);
+  header.b1 = rx->id;
+  header.s1 = to_short(rx->pan);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_drive(int s, double value) {
+  DOUBLE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_DRIVE);
+  command.dbl = to_double(value);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_micgain(int s, double gain) {
+  DOUBLE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_MICGAIN);
+  command.dbl = to_double(gain);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_volume(int s, int id, double volume) {
+  DOUBLE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_VOLUME);
+  command.header.b1 = id;
+  command.dbl = to_double(volume);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_diversity(int s, int enabled, double gain, double phase) {
+  DIVERSITY_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_DIVERSITY);
+  command.diversity_enabled = enabled;
+  command.div_gain = to_double(gain);
+  command.div_phase =  to_double(phase);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_agc(int s, int id, int agc) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_AGC);
+  header.b1 = id;
+  header.b2 = agc;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_agc_gain(int s, const RECEIVER *rx) {
+  AGC_GAIN_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_AGC_GAIN);
+  command.id = rx->id;
+  command.gain = to_double(rx->agc_gain);
+  command.hang = to_double(rx->agc_hang);
+  command.thresh = to_double(rx->agc_thresh);
+  command.hang_thresh = to_double(rx->agc_hang_threshold);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_rfgain(int s, int id, double gain) {
+  DOUBLE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_RFGAIN);
+  command.header.b1 = id;
+  command.dbl = to_double(gain);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_attenuation(int s, int id, int attenuation) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_ATTENUATION);
+  header.b1 = id;
+  header.s1 = to_short(attenuation);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_squelch(int s, int id, int enable, double squelch) {
+  DOUBLE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_SQUELCH);
+  command.header.b1 = id;
+  command.header.b2 = enable;
+  command.dbl = to_double(squelch);
+  send_bytes(s, (char *)&command, sizeof(command));
+}
+
+void send_eq(int s, int id) {
+  //
+  // The client sends this whenever an equaliser is changed
+  //
+  EQUALIZER_COMMAND command;
+  SYNC(command.header.sync);
+  command.id     = id;
+
+  if (id < RECEIVERS) {
+    const RECEIVER *rx = receiver[id];
+    command.header.data_type = to_short(CMD_RX_EQ);
+    command.enable = rx->eq_enable;
 
-    //
     for (int i = 0; i < 11; i++) {
-      data.eq_freq[i] =  to_double(tx->eq_freq[i]);
-      data.eq_gain[i] =  to_double(tx->eq_gain[i]);
-      data.cfc_freq[i] =  to_double(tx->cfc_freq[i]);
-      data.cfc_lvl[i] =  to_double(tx->cfc_lvl[i]);
-      data.cfc_post[i] =  to_double(tx->cfc_post[i]);
+      command.freq[i] = to_double(rx->eq_freq[i]);
+      command.gain[i] = to_double(rx->eq_gain[i]);
     }
+  } else if (id == 8) {
+    command.header.data_type = to_short(CMD_TX_EQ);
 
-    data.swr_alarm = to_double(tx->swr_alarm);
-    data.dexp_tau =  to_double(tx->dexp_tau);
-    data.dexp_attack =  to_double(tx->dexp_attack);
-    data.dexp_release =  to_double(tx->dexp_release);
-    data.dexp_hold =  to_double(tx->dexp_hold);
-    data.dexp_hyst =  to_double(tx->dexp_hyst);
-    data.mic_gain =  to_double(tx->mic_gain);
-    data.compressor_level =  to_double(tx->compressor_level);
-    data.am_carrier_level = to_double(tx->am_carrier_level);
-    data.display_average_time =  to_double(tx->display_average_time);
-    data.ps_ampdelay =  to_double(tx->ps_ampdelay);
-    data.ps_moxdelay =  to_double(tx->ps_moxdelay);
-    data.ps_loopdelay =  to_double(tx->ps_loopdelay);
-    send_bytes(sock, (char *)&data, sizeof(TRANSMITTER_DATA));
+    if (can_transmit) {
+      command.enable = transmitter->eq_enable;
+
+      for (int i = 0; i < 11; i++) {
+        command.freq[i] = to_double(transmitter->eq_freq[i]);
+        command.gain[i] = to_double(transmitter->eq_gain[i]);
+      }
+    }
   }
+
+  send_bytes(s, (char *)&command, sizeof(command));
 }
 
-static void send_rx_data(int sock, int id) {
-  RECEIVER_DATA data;
-  SYNC(data.header.sync);
-  data.header.data_type = to_short(INFO_RECEIVER);
-  const RECEIVER *rx = receiver[id];
-  data.id                    = rx->id;
-  data.adc                   = rx->adc;
-  data.agc                   = rx->agc;
-  data.nb                    = rx->nb;
-  data.nb2_mode              = rx->nb2_mode;
-  data.nr                    = rx->nr;
-  data.nr_agc                = rx->nr_agc;
-  data.nr2_ae                = rx->nr2_ae;
-  data.nr2_gain_method       = rx->nr2_gain_method;
-  data.nr2_npe_method        = rx->nr2_npe_method;
-  data.anf                   = rx->anf;
-  data.snb                   = rx->snb;
-  data.display_detector_mode = rx->display_detector_mode;
-  data.display_average_mode  = rx->display_average_mode;
-  data.zoom                  = rx->zoom;
-  data.dither                = rx->dither;
-  data.random                = rx->random;
-  data.preamp                = rx->preamp;
-  data.alex_antenna          = rx->alex_antenna;
-  data.alex_attenuation      = rx->alex_attenuation;
-  data.squelch_enable        = rx->squelch_enable;
-  data.binaural              = rx->binaural;
-  data.eq_enable             = rx->eq_enable;
-  data.smetermode            = rx->smetermode;
-  data.low_latency           = rx->low_latency;
+void send_noise(int s, const RECEIVER *rx) {
   //
-  data.fps                   = to_short(rx->fps);
-  data.filter_low            = to_short(rx->filter_low);
-  data.filter_high           = to_short(rx->filter_high);
-  data.deviation             = to_short(rx->deviation);
-  data.pan                   = to_short(rx->pan);
-  data.width                 = to_short(rx->width);
+  // The client sends this whenever a noise reduction
+  // setting is changed.
   //
-  data.hz_per_pixel          = to_double(rx->hz_per_pixel);
-  data.squelch               = to_double(rx->squelch);
-  data.display_average_time  = to_double(rx->display_average_time);
-  data.volume                = to_double(rx->volume);
-  data.agc_gain              = to_double(rx->agc_gain);
-  data.agc_hang              = to_double(rx->agc_hang);
-  data.agc_thresh            = to_double(rx->agc_thresh);
-  data.agc_hang_threshold    = to_double(rx->agc_hang_threshold);
-  data.nr2_trained_threshold = to_double(rx->nr2_trained_threshold);
-  data.nr2_trained_t2        = to_double(rx->nr2_trained_t2);
-  data.nb_tau                = to_double(rx->nb_tau);
-  data.nb_hang               = to_double(rx->nb_hang);
-  data.nb_advtime            = to_double(rx->nb_advtime);
-  data.nb_thresh             = to_double(rx->nb_thresh);
+  NOISE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_NOISE);
+  command.id                        = rx->id;
+  command.nb                        = rx->nb;
+  command.nr                        = rx->nr;
+  command.anf                       = rx->anf;
+  command.snb                       = rx->snb;
+  command.nb2_mode                  = rx->nb2_mode;
+  command.nr_agc                    = rx->nr_agc;
+  command.nr2_gain_method           = rx->nr2_gain_method;
+  command.nr2_npe_method            = rx->nr2_npe_method;
+  command.nr2_ae                    = rx->nr2_ae;
+  command.nb_tau                    = to_double(rx->nb_tau);
+  command.nb_hang                   = to_double(rx->nb_hang);
+  command.nb_advtime                = to_double(rx->nb_advtime);
+  command.nb_thresh                 = to_double(rx->nb_thresh);
+  command.nr2_trained_threshold     = to_double(rx->nr2_trained_threshold);
+  command.nr2_trained_t2            = to_double(rx->nr2_trained_t2);
 #ifdef EXTNR
-  data.nr4_reduction_amount  = to_double(rx->nr4_reduction_amount);
-  data.nr4_smoothing_factor  = to_double(rx->nr4_smoothing_factor);
-  data.nr4_whitening_factor  = to_double(rx->nr4_whitening_factor);
-  data.nr4_noise_rescale     = to_double(rx->nr4_noise_rescale);
-  data.nr4_post_threshold    = to_double(rx->nr4_post_threshold);
+  command.nr4_reduction_amount      = to_double(rx->nr4_reduction_amount);
+  command.nr4_smoothing_factor      = to_double(rx->nr4_smoothing_factor);
+  command.nr4_whitening_factor      = to_double(rx->nr4_whitening_factor);
+  command.nr4_noise_rescale         = to_double(rx->nr4_noise_rescale);
+  command.nr4_post_threshold        = to_double(rx->nr4_post_threshold);
 #else
   //
   // If this side is not compiled with EXTNR, fill in default values
   //
-  data.nr4_reduction_amount  = to_double(10.0);
-  data.nr4_smoothing_factor  = to_double(0.0);
-  data.nr4_whitening_factor  = to_double(0.0);
-  data.nr4_noise_rescale     = to_double(2.0);
-  data.nr4_post_threshold    = to_double(-10.0);
+  command.nr4_reduction_amount      = to_double(10.0);
+  command.nr4_smoothing_factor      = to_double(0.0);
+  command.nr4_whitening_factor      = to_double(0.0);
+  command.nr4_noise_rescale         = to_double(2.0);
+  command.nr4_post_threshold        = to_double(-10.0);
 #endif
+  send_bytes(s, (char *)&command, sizeof(command));
+}
 
-  for (int i = 0; i < 11; i++) {
-    data.eq_freq[i]          = to_double(rx->eq_freq[i]);
-    data.eq_gain[i]          = to_double(rx->eq_gain[i]);
-  }
+void send_capture(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_CAPTURE);
+  send_bytes(s, (char *)&header, sizeof(header));
+}
 
-  data.fft_size              = to_ll(rx->fft_size);
-  data.sample_rate           = to_ll(rx->sample_rate);
-  send_bytes(sock, (char *)&data, sizeof(RECEIVER_DATA));
+void send_bandstack(int s, int old, int new) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_BANDSTACK);
+  header.b1 = old;
+  header.b2 = new;
+  send_bytes(s, (char *)&header, sizeof(header));
 }
 
-void send_vfo_data(int sock, int v) {
-  VFO_DATA vfo_data;
-  SYNC(vfo_data.header.sync);
-  vfo_data.header.data_type = to_short(INFO_VFO);
-  vfo_data.vfo = v;
-  vfo_data.band = vfo[v].band;
-  vfo_data.bandstack = vfo[v].bandstack;
-  vfo_data.mode = vfo[v].mode;
-  vfo_data.filter = vfo[v].filter;
-  vfo_data.ctun = vfo[v].ctun;
-  vfo_data.rit_enabled = vfo[v].rit_enabled;
-  vfo_data.xit_enabled = vfo[v].xit_enabled;
-  vfo_data.cwAudioPeakFilter = vfo[v].cwAudioPeakFilter;
-  //
-  vfo_data.rit_step  = to_short(vfo[v].rit_step);
-  vfo_data.deviation = to_short(vfo[v].deviation);
-  //
-  vfo_data.frequency = to_ll(vfo[v].frequency);
-  vfo_data.ctun_frequency = to_ll(vfo[v].ctun_frequency);
-  vfo_data.rit = to_ll(vfo[v].rit);
-  vfo_data.xit = to_ll(vfo[v].xit);
-  vfo_data.lo = to_ll(vfo[v].lo);
-  vfo_data.offset = to_ll(vfo[v].offset);
-  vfo_data.step   = to_ll(vfo[v].step);
-  send_bytes(sock, (char *)&vfo_data, sizeof(vfo_data));
+void send_audio_codec(int s, int choice, int frame) {
+  HEADER header;
+
+  if (choice < 0 || choice >= audio_codec_num_choices()) { choice = 0; }
+
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_AUDIO_CODEC);
+  header.b1 = audio_codec_choices[choice].codec;
+  header.s1 = to_short(audio_codec_choices[choice].bitrate);
+  header.s2 = to_short(frame);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-//
-// server_loop is running on the "local" computer
-// (with direct cable connection to the radio hardware)
-//
-static void server_loop() {
+void send_udp(int s, int command, int arg) {
+  UDP_COMMAND udp;
+  SYNC(udp.header.sync);
+  udp.header.data_type = to_short(CMD_UDP);
+  udp.header.b1 = arg;
+  udp.header.b2 = command;
+  udp.header.s1 = to_short(0);
+  udp.token = to_int(0);
+  send_bytes(s, (char *)&udp, sizeof(UDP_COMMAND));
+}
+
+void send_iq_stream(int s, int id, int state, int rate) {
   HEADER header;
-  t_print("%s: Client connected on port %d\n", __FUNCTION__, remoteclient.address.sin_port);
-  //
-  // Allocate ring buffer for TX mic data
-  //
-  mic_ring_buffer = g_new(short, MIC_RING_BUFFER_SIZE);
-  mic_ring_outpt = 0;
-  mic_ring_inpt = 0;
-  //
-  // The server starts with sending  a lot of data to initialise
-  // the data on the client side.
-  //
-  //
-  // Send global variables
-  //
-  send_radio_data(remoteclient.socket);
-  //
-  // send ADC data structure
-  //
-  send_adc_data(remoteclient.socket, 0);
-  send_adc_data(remoteclient.socket, 1);
-  //
-  // send DAC data structure
-  //
-  send_dac_data(remoteclient.socket);
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_IQ_STREAM);
+  header.b1 = id;
+  header.b2 = state;
+  header.s1 = to_short(rate);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
+
+void send_band(int s, int v, int band) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_BAND_SEL);
+  header.b1 = v;
+  header.b2 = band;
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_twotone(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_TWOTONE);
+  header.b1 = state;
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_tune(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_TUNE);
+  header.b1 = state;
+  header.s1 = to_short(full_tune);
+  header.s2 = to_short(memory_tune);
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_vox(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_VOX);
+  header.b1 = state;
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_toggle_mox(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_TOGGLE_MOX);
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_toggle_tune(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_TOGGLE_TUNE);
+  header.s1 = to_short(full_tune);
+  header.s2 = to_short(memory_tune);
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_mox(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_MOX);
+  header.b1 = state;
+
+  if (s == REMOTE_BROADCAST) { server_mox_sent = state; }
+
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_mode(int s, int v, int mode) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_MODE);
+  header.b1 = v;
+  header.b2 = mode;
+  send_bytes(s, (char *)&header, sizeof(header));
+}
 
+void send_filter_var(int s, int m, int f) {
   //
-  // Send filter edges of the Var1 and Var2 filters
+  // Change filter edges for filter f for  mode m
+  // This is intended for Var1/Var2 and does not do
+  // anything else.
   //
-  for (int m = 0; m < MODES;  m++) {
-    send_filter_var(remoteclient.socket, m, filterVar1);
-    send_filter_var(remoteclient.socket, m, filterVar2);
+  if (f == filterVar1 || f == filterVar2) {
+    HEADER header;
+    SYNC(header.sync);
+    header.data_type = to_short(CMD_FILTER_VAR);
+    header.b1 = m;
+    header.b2 = f;
+    header.s1 = to_short(filters[m][f].low);
+    header.s2 = to_short(filters[m][f].high);
+    send_bytes(s, (char *)&header, sizeof(HEADER));
   }
+}
 
+void send_rx_filter_cut(int s, int id) {
   //
-  // Send receiver data. For HPSDR, this includes the PS RX feedback
-  // receiver since it has a setting (antenna used for feedpack) that
-  // can be changed through the GUI
+  // This changes the filter cuts in the receiver
   //
-  for (int i = 0; i < RECEIVERS; i++) {
-    send_rx_data(remoteclient.socket, i);
-  }
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_RX_FILTER_CUT);
+  header.b1 = id;
 
-  if (protocol == ORIGINAL_PROTOCOL || protocol == NEW_PROTOCOL) {
-    send_rx_data(remoteclient.socket, PS_RX_FEEDBACK);
+  if (id < receivers) {
+    header.s1  =  to_short(receiver[id]->filter_low);
+    header.s2  =  to_short(receiver[id]->filter_high);
   }
 
-  //
-  // Send VFO data
-  //
-  send_vfo_data(remoteclient.socket, VFO_A);    // send INFO_VFO packet
-  send_vfo_data(remoteclient.socket, VFO_B);    // send INFO_VFO packet
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
+void send_tx_filter_cut(int s) {
   //
-  // Send Band and Bandstack data
+  // This changes the filter cuts in the transmitter
   //
-  for (int b = 0; b < BANDS + XVTRS; b++) {
-    send_band_data(remoteclient.socket, b);
-    const BAND *band = band_get_band(b);
-
-    for (int s = 0; s < band->bandstack->entries; s++) {
-      send_bandstack_data(remoteclient.socket, b, s);
-    }
-  }
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_TX_FILTER_CUT);
 
-  //
-  // Send memory slots
-  //
-  for (int i = 0; i < NUM_OF_MEMORYS; i++) {
-    send_memory_data(remoteclient.socket, i);
+  if (can_transmit) {
+    header.s1  =  to_short(transmitter->filter_low);
+    header.s2  =  to_short(transmitter->filter_high);
   }
 
-  //
-  // Send transmitter data
-  //
-  send_tx_data(remoteclient.socket);
-  //
-  // If everything has been sent, start the radio
-  //
-  send_start_radio(remoteclient.socket);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
+void send_filter_sel(int s, int v, int f) {
   //
-  // Now, enter an "inifinte" loop, get and parse commands from the client.
-  // This loop is (only) left if there is an I/O error.
-  // If a complete command has been received, put a "remote_command()" with that
-  // command into the GTK idle queue.
+  // Change filter of VFO v to filter f
   //
-  while (remoteclient.running) {
-    //
-    // Getting out-of-sync data is a very rare event with TCP
-    // (I am not sure whether this can happen unless there is a program error)
-    // so try first to read a complete header in one shot, and if this files,
-    // do a re-sync
-    //
-    int bytes_read = recv_bytes(remoteclient.socket, (char *)&header, sizeof(HEADER));
-
-    if (bytes_read <= 0) {
-      t_print("%s: ReadErr for HEADER SYNC\n", __FUNCTION__);
-      remoteclient.running = FALSE;
-      continue;
-    }
-
-    if (memcmp(header.sync, syncbytes, sizeof(syncbytes))  != 0) {
-      t_print("%s: header.sync mismatch: %02x %02x %02x %02x\n",
-              __FUNCTION__,
-              header.sync[0],
-              header.sync[1],
-              header.sync[2],
-              header.sync[3]);
-      int syncs = 0;
-      uint8_t c;
-
-      while (syncs != sizeof(syncbytes) && remoteclient.running) {
-        bytes_read = recv_bytes(remoteclient.socket, (char *)&c, 1);
-
-        if (bytes_read <= 0) {
-          t_print("%: ReadErr for HEADER RESYNC\n", __FUNCTION__);
-          remoteclient.running = FALSE;
-          break;
-        }
-
-        if (c == syncbytes[syncs]) {
-          syncs++;
-        } else {
-          syncs = 0;
-        }
-      }
-
-      if (recv_bytes(remoteclient.socket, (char *)&header + sizeof(header.sync), sizeof(header) - sizeof(header.sync)) <= 0) {
-        remoteclient.running = FALSE;
-      }
-
-      if (remoteclient.running) {
-        t_print("%s: Re-SYNC was successful!\n", __FUNCTION__);
-      } else {
-        t_print("%s: Re-SYNC failed.\n", __FUNCTION__);
-      }
-    }
-
-    if (!remoteclient.running) { break; }
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_FILTER_SEL);
+  header.b1 = v;
+  header.b2 = f;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    //
-    // Now we have a valid header
-    //
-    int data_type = from_short(header.data_type);
-    //t_print("%s: received header: type=%d\n", __FUNCTION__, data_type);
+void send_sidetone_freq(int s, int f) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_SIDETONEFREQ);
+  header.s1 = to_short(f);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    switch (data_type) {
-    case CMD_HEARTBEAT:
-      // periodically sent to  keep  connection alive
-      break;
+void send_cwpeak(int s, int v, int p) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_CWPEAK);
+  header.b1 = v;
+  header.b2 = p;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    case INFO_TXAUDIO: {
-      //
-      // The txaudio  command is statically allocated and the data will be IMMEDIATELY
-      // (not through the GTK queue) put  to the ring buffer
-      //
-      if (recv_bytes(remoteclient.socket, (char *)&txaudio_data + sizeof(HEADER),
-                     sizeof(TXAUDIO_DATA) - sizeof(HEADER)) > 0) {
-        unsigned int numsamples = from_short(txaudio_data.numsamples);
-
-        for (unsigned int i = 0; i < numsamples; i++) {
-          int newpt = mic_ring_inpt + 1;
-
-          if (newpt == MIC_RING_BUFFER_SIZE) { newpt = 0; }
-
-          if (newpt != mic_ring_outpt) {
-            MEMORY_BARRIER;
-            // buffer space available, do the write
-            mic_ring_buffer[mic_ring_inpt] = from_short(txaudio_data.samples[i]);
-            MEMORY_BARRIER;
-            // atomic update of mic_ring_inpt
-            mic_ring_inpt = newpt;
-          }
-        }
-      }
-    }
-    break;
+void send_digidrivemax(int s) {
+  DOUBLE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_DIGIMAX);
+  command.dbl = to_double(drive_digi_max);
+  send_bytes(s, (char *)&command, sizeof(DOUBLE_COMMAND));
+}
 
-    case INFO_BAND: {
-      BAND_DATA *command = g_new(BAND_DATA, 1);
-      command->header = header;
+void send_am_carrier(int s) {
+  if (can_transmit) {
+    DOUBLE_COMMAND command;
+    SYNC(command.header.sync);
+    command.header.data_type = to_short(CMD_AMCARRIER);
+    command.dbl = to_double(transmitter->am_carrier_level);
+    send_bytes(s, (char *)&command, sizeof(DOUBLE_COMMAND));
+  }
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(BAND_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_dexp(int s) {
+  if (can_transmit) {
+    DEXP_DATA command;
+    SYNC(command.header.sync);
+    command.header.data_type = to_short(CMD_DEXP);
+    command.dexp = transmitter->dexp;
+    command.dexp_filter = transmitter->dexp_filter;
+    command.dexp_trigger = to_short(transmitter->dexp_trigger);
+    command.dexp_exp = to_short(transmitter->dexp_exp);
+    command.dexp_filter_low = to_short(transmitter->dexp_filter_low);
+    command.dexp_filter_high = to_short(transmitter->dexp_filter_high);
+    command.dexp_tau = to_double(transmitter->dexp_tau);
+    command.dexp_attack = to_double(transmitter->dexp_attack);
+    command.dexp_release = to_double(transmitter->dexp_release);
+    command.dexp_hold = to_double(transmitter->dexp_hold);
+    command.dexp_hyst = to_double(transmitter->dexp_hyst);
+    send_bytes(s, (char *)&command, sizeof(DEXP_DATA));
+  }
+}
 
-    case INFO_BANDSTACK: {
-      BANDSTACK_DATA *command = g_new(BANDSTACK_DATA, 1);
-      command->header = header;
+void send_tx_compressor(int s) {
+  if (can_transmit) {
+    COMPRESSOR_DATA command;
+    SYNC(command.header.sync);
+    command.header.data_type = to_short(CMD_COMPRESSOR);
+    command.compressor = transmitter->compressor;
+    command.cfc = transmitter->cfc;
+    command.cfc_eq = transmitter->cfc_eq;
+    command.compressor_level = to_double(transmitter->compressor_level);
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(BANDSTACK_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
+    for (int i = 0; i < 11; i++) {
+      command.cfc_freq[i] = to_double(transmitter->cfc_freq[i]);
+      command.cfc_lvl [i] = to_double(transmitter->cfc_lvl [i]);
+      command.cfc_post[i] = to_double(transmitter->cfc_post[i]);
     }
-    break;
 
-    case INFO_ADC: {
-      //
-      // Sending ADC data from the client to the server has a very limited scope:
-      // - antenna (for SoapySDR)
-      //
-      ADC_DATA *command = g_new(ADC_DATA, 1);
-      command->header = header;
+    send_bytes(s, (char *)&command, sizeof(COMPRESSOR_DATA));
+  }
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(ADC_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_txmenu(int s) {
+  if (can_transmit) {
+    TXMENU_DATA command;
+    SYNC(command.header.sync);
+    command.header.data_type = to_short(CMD_TXMENU);
+    command.tune_drive = transmitter->tune_drive;
+    command.tune_use_drive = transmitter->tune_use_drive;
+    command.swr_protection = transmitter->swr_protection;
+    command.mic_boost = mic_boost;
+    command.mic_linein = mic_linein;
+    command.linein_gain = to_double(linein_gain);
+    command.swr_alarm = to_double(transmitter->swr_alarm);
+    send_bytes(s, (char *)&command, sizeof(TXMENU_DATA));
+  }
+}
 
-    case INFO_DAC: {
-      //
-      // Sending DAC data from the client to the server has a very limited scope:
-      // - antenna (for SoapySDR)
-      //
-      DAC_DATA *command = g_new(DAC_DATA, 1);
-      command->header = header;
+void send_ctcss(int s) {
+  if (can_transmit) {
+    HEADER header;
+    SYNC(header.sync);
+    header.data_type = to_short(CMD_CTCSS);
+    header.b1 = transmitter->ctcss_enabled;
+    header.b2 = transmitter->ctcss;
+    send_bytes(s, (char *)&header, sizeof(HEADER));
+  }
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(DAC_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_txfilter(int s) {
+  if (can_transmit) {
+    HEADER header;
+    SYNC(header.sync);
+    header.data_type = to_short(CMD_TXFILTER);
+    header.b1 = transmitter->use_rx_filter;
+    header.s1 = to_short(transmitter->default_filter_low);
+    header.s2 = to_short(transmitter->default_filter_high);
+    send_bytes(s, (char *)&header, sizeof(HEADER));
+  }
+}
 
-    case CMD_RX_SPECTRUM: {
-      int id = header.b1;
-      int state = header.b2;
-      remoteclient.send_rx_spectrum[id] = state;
-    }
-    break;
+void send_preemp(int s) {
+  if (can_transmit) {
+    HEADER header;
+    SYNC(header.sync);
+    header.data_type = to_short(CMD_PREEMP);
+    header.b1 = transmitter->pre_emphasize;
+    send_bytes(s, (char *)&header, sizeof(HEADER));
+  }
+}
 
-    case CMD_TX_SPECTRUM: {
-      int state = header.b2;
-      remoteclient.send_tx_spectrum = state;
-    }
-    break;
+void send_psparams(int s, const TRANSMITTER *tx) {
+  PS_PARAMS params;
+  SYNC(params.header.sync);
+  params.header.data_type = to_short(CMD_PSPARAMS);
+  params.ps_ptol = tx->ps_ptol;
+  params.ps_oneshot = tx->ps_oneshot;
+  params.ps_map = tx->ps_map;
+  params.ps_setpk = to_double(tx->ps_setpk);
+  send_bytes(s, (char *)&params, sizeof(PS_PARAMS));
+}
 
-    case CMD_AGC_GAIN: {
-      AGC_GAIN_COMMAND *command = g_new(AGC_GAIN_COMMAND, 1);
-      command->header = header;
+void send_psresume(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_PSRESUME);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(AGC_GAIN_COMMAND) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_psreset(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_PSRESET);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    case CMD_NOISE: {
-      NOISE_COMMAND *command = g_new(NOISE_COMMAND, 1);
-      command->header = header;
+void send_psonoff(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_PSONOFF);
+  header.b1 = state;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(NOISE_COMMAND) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_psatt(int s) {
+  //
+  // This sends TX attenuation, PS auto-att, feedback, and PS ant
+  if (can_transmit) {
+    HEADER header;
+    SYNC(header.sync);
+    header.data_type = to_short(CMD_PSATT);
+    header.b1 = transmitter->auto_on;
+    header.b2 = transmitter->feedback;
+    header.s1 = to_short(transmitter->attenuation);
+    header.s2 = to_short(receiver[PS_RX_FEEDBACK]->alex_antenna);
+    send_bytes(s, (char *)&header, sizeof(HEADER));
+  }
+}
 
-    case CMD_RX_EQ:
-    case CMD_TX_EQ: {
-      EQUALIZER_COMMAND *command = g_new(EQUALIZER_COMMAND, 1);
-      command->header = header;
+void send_afbinaural(int s, const RECEIVER *rx) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_BINAURAL);
+  header.b1 = rx->id;
+  header.b2 = rx->binaural;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(EQUALIZER_COMMAND) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_rx_fft(int s, const RECEIVER *rx) {
+  U64_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_RXFFT);
+  command.header.b1 = rx->id;
+  command.header.b2 = rx->low_latency;
+  command.u64 = to_ll(rx->fft_size);
+  send_bytes(s, (char *)&command, sizeof(U64_COMMAND));
+}
 
-    case CMD_RADIOMENU: {
-      RADIOMENU_DATA *command = g_new(RADIOMENU_DATA, 1);
-      command->header = header;
+void send_tx_fft(int s, const TRANSMITTER *tx) {
+  U64_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_TXFFT);
+  command.header.b1 = tx->id;
+  command.u64 = to_ll(tx->fft_size);
+  send_bytes(s, (char *)&command, sizeof(U64_COMMAND));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(RADIOMENU_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_patrim(int s) {
+  PATRIM_DATA command;
+  SYNC(command.header.sync);
+  command.header.data_type = to_short(CMD_PATRIM);
+  command.pa_power = pa_power;
 
-    case CMD_RXMENU: {
-      RXMENU_DATA *command = g_new(RXMENU_DATA, 1);
-      command->header = header;
+  for (int i = 0; i < 11; i++) {
+    command.pa_trim[i] = to_double(pa_trim[i]);
+  }
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(RXMENU_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+  send_bytes(s, (char *)&command, sizeof(PATRIM_DATA));
+}
 
-    case CMD_DIVERSITY: {
-      DIVERSITY_COMMAND *command = g_new(DIVERSITY_COMMAND, 1);
-      command->header = header;
+void send_deviation(int s, int v, int dev) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_DEVIATION);
+  header.b1 = v;
+  header.s1 = to_short(dev);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(DIVERSITY_COMMAND) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_vfo_atob(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_VFO_A_TO_B);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    case CMD_DEXP: {
-      DEXP_DATA *command = g_new(DEXP_DATA, 1);
-      command->header = header;
+void send_vfo_btoa(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_VFO_B_TO_A);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(DEXP_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_vfo_swap(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_VFO_SWAP);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    case CMD_COMPRESSOR: {
-      COMPRESSOR_DATA *command = g_new(COMPRESSOR_DATA, 1);
-      command->header = header;
+void send_heartbeat(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_HEARTBEAT);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(COMPRESSOR_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_soapy_rxant(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_SOAPY_RXANT);
+  header.b1 = adc[0].antenna;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    case CMD_TXMENU: {
-      TXMENU_DATA *command = g_new(TXMENU_DATA, 1);
-      command->header = header;
+void send_soapy_txant(int s) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_SOAPY_TXANT);
+  header.b1 = dac.antenna;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(TXMENU_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_soapy_agc(int s, int id) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_SOAPY_AGC);
+  header.b1 = id;
+  header.b2 = adc[id].agc;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    case CMD_PSPARAMS: {
-      PS_PARAMS *command = g_new(PS_PARAMS, 1);
-      command->header = header;
+void send_split(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_SPLIT);
+  header.b1 = state;
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(PS_PARAMS) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+  if (s == REMOTE_BROADCAST) { server_split_sent = state; }
 
-    case CMD_PATRIM: {
-      PATRIM_DATA *command = g_new(PATRIM_DATA, 1);
-      command->header = header;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(PATRIM_DATA) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_cw(int s, int state, int wait) {
+  //
+  // Send this in one header although wait may exceed a short
+  //
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_CW);
+  header.b1  = state;
+  header.s1 = to_short(wait >> 12);
+  header.s2 = to_short(wait & 0xFFF);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    //
-    // All commands with a single  "double" in the body
-    //
-    case CMD_DRIVE:
-    case CMD_DIGIMAX:
-    case CMD_SQUELCH:
-    case CMD_MICGAIN:
-    case CMD_RFGAIN:
-    case CMD_VOLUME:
-    case CMD_RX_DISPLAY:
-    case CMD_AMCARRIER:
-    case CMD_TX_DISPLAY: {
-      DOUBLE_COMMAND *command = g_new(DOUBLE_COMMAND, 1);
-      command->header = header;
-
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(DOUBLE_COMMAND) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_sat(int s, int sat) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_SAT);
+  header.b1  = sat;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    //
-    // All commands with a single uint64_t in the command  body
-    //
-    case CMD_SAMPLE_RATE:
-    case CMD_VFO_STEPSIZE:
-    case CMD_MOVETO:
-    case CMD_RXFFT:
-    case CMD_TXFFT:
-    case CMD_FREQ:
-    case CMD_MOVE: {
-      U64_COMMAND *command = g_new(U64_COMMAND, 1);
-      command->header = header;
-
-      if (recv_bytes(remoteclient.socket, (char *)command + sizeof(HEADER), sizeof(U64_COMMAND) - sizeof(HEADER)) > 0) {
-        g_idle_add(remote_command, command);
-      }
-    }
-    break;
+void send_duplex(int s, int state) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_DUP);
+  header.b1 = state;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
+}
 
-    //
-    // All "header-only" commands simply make a copy of the header and
-    // submit that copy  to remote_command().
-    //
-    case CMD_ADC:
-    case CMD_AGC:
-    case CMD_ANAN10E:
-    case CMD_ATTENUATION:
-    case CMD_BANDSTACK:
-    case CMD_BAND_SEL:
-    case CMD_BINAURAL:
-    case CMD_CAPTURE:
-    case CMD_CTCSS:
-    case CMD_CTUN:
-    case CMD_CW:
-    case CMD_CWPEAK:
-    case CMD_DEVIATION:
-    case CMD_DUP:
-    case CMD_FILTER_BOARD:
-    case CMD_RX_FILTER_CUT:
-    case CMD_TX_FILTER_CUT:
-    case CMD_FILTER_SEL:
-    case CMD_FILTER_VAR:
-    case CMD_LOCK:
-    case CMD_METER:
-    case CMD_MODE:
-    case CMD_MOX:
-    case CMD_MUTE_RX:
-    case CMD_PAN:
-    case CMD_PREEMP:
-    case CMD_PSATT:
-    case CMD_PSONOFF:
-    case CMD_PSRESET:
-    case CMD_PSRESUME:
-    case CMD_RCL:
-    case CMD_RECEIVERS:
-    case CMD_REGION:
-    case CMD_RIT:
-    case CMD_RIT_STEP:
-    case CMD_RX_FPS:
-    case CMD_RX_SELECT:
-    case CMD_SAT:
-    case CMD_SCREEN:
-    case CMD_SIDETONEFREQ:
-    case CMD_SOAPY_AGC:
-    case CMD_SOAPY_RXANT:
-    case CMD_SOAPY_TXANT:
-    case CMD_SPLIT:
-    case CMD_STEP:
-    case CMD_STORE:
-    case CMD_TOGGLE_MOX:
-    case CMD_TOGGLE_TUNE:
-    case CMD_TUNE:
-    case CMD_TWOTONE:
-    case CMD_TX_FPS:
-    case CMD_TXFILTER:
-    case CMD_VFO_A_TO_B:
-    case CMD_VFO_B_TO_A:
-    case CMD_VFO_SWAP:
-    case CMD_VOX:
-    case CMD_XIT:
-    case CMD_XVTR:
-    case CMD_ZOOM: {
-      HEADER *command = g_new(HEADER, 1);
-      *command = header;
-      g_idle_add(remote_command, command);
-    }
-    break;
+void send_display(int s, int id) {
+  DOUBLE_COMMAND command;
+  SYNC(command.header.sync);
+  command.header.b1 = id;
 
-    default:
-      t_print("%s: UNKNOWN command: %d\n", __FUNCTION__, from_short(header.data_type));
-      remoteclient.running = FALSE;
-      break;
-    }
+  if (id < RECEIVERS) {
+    command.header.data_type = to_short(CMD_RX_DISPLAY);
+    command.header.b2 = receiver[id]->display_detector_mode;
+    command.header.s1 = to_short(receiver[id]->display_average_mode);
+    command.dbl = to_double(receiver[id]->display_average_time);
+  } else if (can_transmit) {
+    command.header.data_type = to_short(CMD_TX_DISPLAY);
+    command.header.b2 = transmitter->display_detector_mode;
+    command.header.s1 = to_short(transmitter->display_average_mode);
+    command.dbl = to_double(transmitter->display_average_time);
   }
 
-  t_print("%s: Terminating\n", __FUNCTION__);
+  send_bytes(s, (char *)&command, sizeof(DOUBLE_COMMAND));
 }
 
-void send_startstop_rxspectrum(int s, int id, int state) {
+void send_rxfps(int s, int id, int fps) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_RX_SPECTRUM);
+  header.data_type = to_short(CMD_RX_FPS);
   header.b1 = id;
-  header.b2 = state;
+  header.b2 = fps;
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_startstop_txspectrum(int s, int state) {
+void send_txfps(int s, int fps) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_TX_SPECTRUM);
-  header.b2 = state;
+  header.data_type = to_short(CMD_TX_FPS);
+  header.b2 = fps;
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_vfo_frequency(int s, int v, long long hz) {
-  U64_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_FREQ);
-  command.header.b1 = v;
-  command.u64 = to_ll(hz);
-  send_bytes(s, (char *)&command, sizeof(command));
-}
-
-void send_vfo_move_to(int s, int v, long long hz) {
-  U64_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_MOVETO);
-  command.header.b1 = v;
-  command.u64 = to_ll(hz);
-  send_bytes(s, (char *)&command, sizeof(command));
-}
-
-static void send_vfo_move(int s, int id, long long hz, int round) {
-  U64_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_MOVE);
-  command.header.b1 = id;
-  command.header.b2 = round;
-  command.u64 = to_ll(hz);
-  send_bytes(s, (char *)&command, sizeof(command));
+void send_lock(int s, int lock) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_LOCK);
+  header.b1 = lock;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void update_vfo_move(int v, long long hz, int round) {
-  g_mutex_lock(&accumulated_mutex);
-  accumulated_hz[v] += hz;
-  accumulated_round[v] = round;
-  g_mutex_unlock(&accumulated_mutex);
+void send_ctun(int s, int vfo, int ctun) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_CTUN);
+  header.b1 = vfo;
+  header.b2 = ctun;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_store(int s, int index) {
+void send_rx_select(int s, int id) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_STORE);
-  header.b1 = index;
+  header.data_type = to_short(CMD_RX_SELECT);
+  header.b1 = id;
+  send_bytes(s, (char *)&header, sizeof(header));
+}
+
+void send_rit(int s, int id) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_RIT);
+  header.b1 = id;
+  header.b2 = vfo[id].rit_enabled;
+  header.s1 = to_short(vfo[id].rit);
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_recall(int s, int index) {
+void send_xit(int s, int id) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_RCL);
-  header.b1 = index;
+  header.data_type = to_short(CMD_XIT);
+  header.b1 = id;
+  header.b2 = vfo[id].xit_enabled;
+  header.s1 = to_short(vfo[id].xit);
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_vfo_stepsize(int s, int v, int stepsize) {
+void send_sample_rate(int s, int id, int sample_rate) {
   U64_COMMAND command;
+  long long rate = (long long)sample_rate;
   SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_VFO_STEPSIZE);
-  command.header.b1 = v;
-  command.u64 = to_ll(stepsize);
-  send_bytes(s, (char *)&command, sizeof(U64_COMMAND));
+  command.header.data_type = to_short(CMD_SAMPLE_RATE);
+  command.header.b1 = id;
+  command.u64 = to_ll(rate);
+  send_bytes(s, (char *)&command, sizeof(command));
 }
 
-void send_vfo_step(int s, int v, int steps) {
+void send_receivers(int s, int receivers) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_STEP);
-  header.b1 = v;
-  header.s1 = to_short(steps);
+  header.data_type = to_short(CMD_RECEIVERS);
+  header.b1 = receivers;
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void update_vfo_step(int v, int steps) {
-  g_mutex_lock(&accumulated_mutex);
-  accumulated_steps[v] += steps;
-  g_mutex_unlock(&accumulated_mutex);
+void send_rit_step(int s, int v, int step) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_RIT_STEP);
+  header.b1 = v;
+  header.s1 = to_short(step);
+  send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_zoom(int s, const RECEIVER *rx) {
+void send_filter_board(int s, int filter_board) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_ZOOM);
-  header.b1 = rx->id;
-  header.b2 = rx->zoom;
+  header.data_type = to_short(CMD_FILTER_BOARD);
+  header.b1 = filter_board;
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_meter(int s, int metermode, int alcmode) {
+void send_adc(int s, int id, int adc) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_METER);
-  header.b1 = metermode;
-  header.b2 = alcmode;
+  header.data_type = to_short(CMD_ADC);
+  header.b1 = id;
+  header.b2 = adc;
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_screen(int s, int hstack, int width) {
+void send_anan10E(int s, int new) {
   HEADER header;
   SYNC(header.sync);
-  header.data_type = to_short(CMD_SCREEN);
-  header.b1 = hstack;
-  header.s1 = to_short(width);
+  header.data_type = to_short(CMD_ANAN10E);
+  header.b1 = new;
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_pan(int s, const RECEIVER *rx) {
+void send_region(int s, int region) {
   HEADER header;
+  //
+  // prepeare for bandstack reorganisation
+  //
+  radio_change_region(region);
   SYNC(header.sync);
-  header.data_type = to_short(CMD_PAN);
-  header.b1 = rx->id;
-  header.s1 = to_short(rx->pan);
+  header.data_type = to_short(CMD_REGION);
+  header.b1 = region;
   send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_drive(int s, double value) {
-  DOUBLE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_DRIVE);
-  command.dbl = to_double(value);
-  send_bytes(s, (char *)&command, sizeof(command));
+void send_mute_rx(int s, int id, int mute) {
+  HEADER header;
+  SYNC(header.sync);
+  header.data_type = to_short(CMD_MUTE_RX);
+  header.b1 = id;
+  header.b2 = mute;
+  send_bytes(s, (char *)&header, sizeof(HEADER));
 }
 
-void send_micgain(int s, double gain) {
-  DOUBLE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_MICGAIN);
-  command.dbl = to_double(gain);
-  send_bytes(s, (char *)&command, sizeof(command));
-}
+//
+// Start and stop the "server session" (periodic data, keyer settings)
+// when the first client has connected or the last one has disconnected.
+// Runs in the GTK thread and looks at the actual number of clients, so
+// it does not matter if a client connects while another one is just
+// leaving.
+//
+static gboolean server_session_update(gpointer arg) {
+  static int active = FALSE;
 
-void send_volume(int s, int id, double volume) {
-  DOUBLE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_VOLUME);
-  command.header.b1 = id;
-  command.dbl = to_double(volume);
-  send_bytes(s, (char *)&command, sizeof(command));
-}
+  if (remote_clients > 0 && !active) {
+    active = TRUE;
+    //
+    // Setting this has to be post-poned until HERE, since now
+    // the RX thread starts to send audio data. If we were TXing
+    // when the client successfully connects, go RX.
+    //
+    ext_set_mox(GINT_TO_POINTER(0));
+    audio_stats_reset();
+    //
+    // Send PS and on-display data periodically
+    //
+    periodic_timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, 150, send_periodic_data, NULL, NULL);
+    link_timer_id = g_timeout_add(LINK_STATS_INTERVAL * 1000, link_stats_timer, NULL);
+    //
+    // We disable "CW handled in Radio" since this makes no sense
+    // for remote operation.
+    //
+    old_cw_keyer_internal = cw_keyer_internal;
+    cw_keyer_internal = 1;
+    keyer_update();  // shut down iambic keyer
+    cw_keyer_internal = 0;
+    schedule_transmit_specific();
+  } else if (remote_clients == 0 && active) {
+    active = FALSE;
+    cw_keyer_internal = old_cw_keyer_internal;
+    keyer_update();  // possibly restart iambic keyer
+    schedule_transmit_specific();
 
-void send_diversity(int s, int enabled, double gain, double phase) {
-  DIVERSITY_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_DIVERSITY);
-  command.diversity_enabled = enabled;
-  command.div_gain = to_double(gain);
-  command.div_phase =  to_double(phase);
-  send_bytes(s, (char *)&command, sizeof(command));
+    //
+    // Stop sending periodic data
+    //
+    if (periodic_timer_id != 0) {
+      g_source_remove(periodic_timer_id);
+      periodic_timer_id = 0;
+    }
+
+    if (link_timer_id != 0) {
+      g_source_remove(link_timer_id);
+      link_timer_id = 0;
+    }
+  }
+
+  return G_SOURCE_REMOVE;
 }
 
-void send_agc(int s, int id, int agc) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_AGC);
-  header.b1 = id;
-  header.b2 = agc;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+//
+// Parse the bytes received from a client. Complete packets are processed,
+// an incomplete one remains in the input buffer. Returns -1 if the client
+// has to be disconnected, and 1 if parsing has stopped because the
+// command queue is full.
+//
+static int server_input(REMOTE_CLIENT *client) {
+  int pos = 0;
+  int rc = 0;
+
+  while (client->input_length - pos >= (int)sizeof(HEADER)) {
+    const uint8_t *packet = client->input + pos;
+
+    if (memcmp(packet, syncbytes, sizeof(syncbytes)) != 0) {
+      //
+      // Getting out-of-sync data is a very rare event with TCP
+      // (I am not sure whether this can happen unless there is a program error)
+      // so simply skip bytes until the sync bytes show up again
+      //
+      if (!client->input_resync) {
+        t_print("%s: header.sync mismatch: %02x %02x %02x %02x\n", __FUNCTION__,
+                packet[0], packet[1], packet[2], packet[3]);
+        client->input_resync = TRUE;
+      }
+
+      pos++;
+      continue;
+    }
+
+    if (client->input_resync) {
+      t_print("%s: Re-SYNC was successful!\n", __FUNCTION__);
+      client->input_resync = FALSE;
+    }
+
+    const HEADER *header = (const HEADER *)packet;
+    int len = server_packet_length(header);
+
+    if (len < 0) {
+      rc = -1;
+      break;
+    }
+
+    if (client->input_length - pos < len) { break; }
+
+    //
+    // If the GTK thread lags behind, leave the rest in the
+    // buffer until the command queue has room again.
+    //
+    int needed = (from_short(header->data_type) == CMD_BATCH) ? header->b1 : 1;
+
+    if (command_queue_length(&server_commands) >= SERVER_COMMANDS - needed) {
+      rc = 1;
+      break;
+    }
+
+    g_mutex_lock(&client_mutex);
+    link_stats_rx(&client->link, link_class(packet), len);
+    g_mutex_unlock(&client_mutex);
+    server_packet(client, packet);
+    pos += len;
+  }
+
+  if (pos > 0) {
+    memmove(client->input, client->input + pos, client->input_length - pos);
+    client->input_length -= pos;
+  }
+
+  return rc;
 }
 
-void send_agc_gain(int s, const RECEIVER *rx) {
-  AGC_GAIN_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_AGC_GAIN);
-  command.id = rx->id;
-  command.gain = to_double(rx->agc_gain);
-  command.hang = to_double(rx->agc_hang);
-  command.thresh = to_double(rx->agc_thresh);
-  command.hang_thresh = to_double(rx->agc_hang_threshold);
-  send_bytes(s, (char *)&command, sizeof(command));
+//
+// The I/O thread is woken up through a pipe if a send queue
+// receives data while the thread does not wait for it.
+//
+static void io_wakeup(void *arg) {
+  char c = 0;
+
+  // non-blocking: if the pipe is full, a wakeup is pending anyway
+  if (write(io_pipe[1], &c, 1) < 0) { return; }
 }
 
-void send_rfgain(int s, int id, double gain) {
-  DOUBLE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_RFGAIN);
-  command.header.b1 = id;
-  command.dbl = to_double(gain);
-  send_bytes(s, (char *)&command, sizeof(command));
+static int io_read(REMOTE_CLIENT *client) {
+  int rc = recv(client->socket, client->input + client->input_length, REMOTE_INPUT_SIZE - client->input_length, 0);
+
+  if (rc == 0) {
+    t_print("%s: connection closed by client\n", __FUNCTION__);
+    return -1;
+  }
+
+  if (rc < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) { return 0; }
+
+    t_perror("io_read");
+    return -1;
+  }
+
+  client->input_length += rc;
+  client->last_input = g_get_monotonic_time();
+  return server_input(client);
 }
 
-void send_attenuation(int s, int id, int attenuation) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_ATTENUATION);
-  header.b1 = id;
-  header.s1 = to_short(attenuation);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+//
+// Send as much of the queue as the socket takes, several packets with
+// one system call. If the socket is full, wait until it is writable.
+//
+static int io_write(REMOTE_CLIENT *client) {
+  struct iovec iov[IO_IOV_MAX];
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+
+  for (;;) {
+    int n = send_queue_iov(&client->queue, iov, IO_IOV_MAX);
+
+    if (n == 0) {
+      client->writing = FALSE;
+      return 0;
+    }
+
+    msg.msg_iovlen = n;
+    ssize_t rc = sendmsg(client->socket, &msg, IO_SEND_FLAGS);
+
+    if (rc < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        client->writing = TRUE;
+        return 0;
+      }
+
+      if (errno == EINTR) { continue; }
+
+      t_perror("io_write");
+      return -1;
+    }
+
+    send_queue_consume(&client->queue, rc);
+  }
 }
 
-void send_squelch(int s, int id, int enable, double squelch) {
-  DOUBLE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_SQUELCH);
-  command.header.b1 = id;
-  command.header.b2 = enable;
-  command.dbl = to_double(squelch);
-  send_bytes(s, (char *)&command, sizeof(command));
+//
+// Hello datagrams from the clients: the token tells which client it is,
+// and the source address is where the datagrams go. Since the hello is
+// repeated, this also follows NAT re-mappings. The source must be the
+// host of the TCP connection.
+//
+static void io_udp_read() {
+  uint8_t buf[sizeof(UDP_HEADER) + 64];
+  struct sockaddr_in address;
+
+  for (;;) {
+    socklen_t address_length = sizeof(address);
+    int rc = recvfrom(udp_socket, buf, sizeof(buf), 0, (struct sockaddr *)&address, &address_length);
+
+    if (rc < 0) { break; }
+
+    const UDP_HEADER *hdr = (const UDP_HEADER *)buf;
+
+    if (udp_header_check(hdr, rc) < 0 || hdr->type != UDP_HELLO) { continue; }
+
+    uint32_t token = from_int(hdr->token);
+    g_mutex_lock(&client_mutex);
+
+    for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+      REMOTE_CLIENT *client = &remoteclients[i];
+
+      if (!client->running || client->udp_sender == NULL || client->udp_token != token ||
+          client->address.sin_addr.s_addr != address.sin_addr.s_addr) { continue; }
+
+      if (!client->udp_active) {
+        t_print("%s: UDP channel of client in slot %d is open\n", __FUNCTION__, i);
+
+        //
+        // The first frame over UDP must be a key frame
+        //
+        for (int j = 0; j <= SPECTRUM_TX; j++) {
+          client->spectrum_resync[j] = 1;
+        }
+      }
+
+      client->udp_address = address;
+      client->udp_active = TRUE;
+    }
+
+    g_mutex_unlock(&client_mutex);
+  }
 }
 
-void send_eq(int s, int id) {
+//
+// Remove a client. If it was the controlling one, hand over to
+// the client that has been connected longest.
+//
+static void io_close(REMOTE_CLIENT *client) {
+  net_poll_remove(io_poll, client->socket);
+  client->registered = FALSE;
+  g_mutex_lock(&client_mutex);
+  client->running = FALSE;
+  remote_clients--;
+  int was_controlling = client->controlling;
+  client->controlling = FALSE;
+
+  if (was_controlling) {
+    for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+      if (remoteclients[i].running) {
+        remoteclients[i].controlling = TRUE;
+        t_print("%s: client in slot %d now controls the radio\n", __FUNCTION__, i);
+        break;
+      }
+    }
+  }
+
+  audio_config_gen++;
+  spectrum_config_gen++;
+  g_mutex_unlock(&client_mutex);
   //
-  // The client sends this whenever an equaliser is changed
+  // Nobody queues packets for this client any more
   //
-  EQUALIZER_COMMAND command;
-  SYNC(command.header.sync);
-  command.id     = id;
+  send_queue_close(&client->queue);
+  send_queue_destroy(&client->queue);
+  close(client->socket);
+  g_free(client->input);
+  client->input = NULL;
+  g_mutex_lock(&client_mutex);
+  client->udp_active = FALSE;
+  g_free(client->udp_sender);
+  client->udp_sender = NULL;
+  g_mutex_unlock(&client_mutex);
+  t_print("%s: client disconnected, %d client(s) left\n", __FUNCTION__, remote_clients);
 
-  if (id < RECEIVERS) {
-    const RECEIVER *rx = receiver[id];
-    command.header.data_type = to_short(CMD_RX_EQ);
-    command.enable = rx->eq_enable;
+  //
+  // If the connection breaks while transmitting, go RX
+  //
+  if (was_controlling) { g_idle_add(ext_set_mox, GINT_TO_POINTER(0)); }
 
-    for (int i = 0; i < 11; i++) {
-      command.freq[i] = to_double(rx->eq_freq[i]);
-      command.gain[i] = to_double(rx->eq_gain[i]);
+  g_idle_add(server_session_update, NULL);
+  g_mutex_lock(&client_mutex);
+  client->socket = -1;
+  client->in_use = FALSE;
+  g_mutex_unlock(&client_mutex);
+}
+
+//
+// The I/O thread does all the network I/O with the clients: sockets are
+// non-blocking, and a single thread waits for all of them. Neither the
+// RX thread nor the GTK thread ever wait for the network, they only put
+// packets into the send queues.
+//
+static gpointer io_thread(gpointer arg) {
+  NET_POLL_EVENT ev[MAX_REMOTE_CLIENTS + 2];
+  int timeout = 1000;
+
+  while (server_running) {
+    int n = net_poll_wait(io_poll, ev, MAX_REMOTE_CLIENTS + 2, timeout);
+
+    if (n < 0) {
+      t_perror("io_thread");
+      break;
     }
-  } else if (id == 8) {
-    command.header.data_type = to_short(CMD_TX_EQ);
 
-    if (can_transmit) {
-      command.enable = transmitter->eq_enable;
+    timeout = 1000;
 
-      for (int i = 0; i < 11; i++) {
-        command.freq[i] = to_double(transmitter->eq_freq[i]);
-        command.gain[i] = to_double(transmitter->eq_gain[i]);
+    for (int i = 0; i < n; i++) {
+      REMOTE_CLIENT *client = (REMOTE_CLIENT *)ev[i].data;
+
+      if (client == NULL) {
+        //
+        // Wakeup: empty the pipe. The clients are looked at below.
+        //
+        char buf[64];
+
+        while (read(io_pipe[0], buf, sizeof(buf)) > 0) {}
+
+        continue;
+      }
+
+      if (ev[i].data == &udp_socket) {
+        io_udp_read();
+        continue;
+      }
+
+      if (!client->registered || !client->running) { continue; }
+
+      if (ev[i].events & NET_POLL_ERR) {
+        client_disconnect(client);
+      } else if ((ev[i].events & NET_POLL_IN) && io_read(client) < 0) {
+        client_disconnect(client);
+      }
+    }
+
+    //
+    // Take new clients, drop dead ones, send pending data.
+    //
+    gint64 now = g_get_monotonic_time();
+
+    for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+      REMOTE_CLIENT *client = &remoteclients[i];
+
+      if (client->running && !client->registered) {
+        client->registered = TRUE;
+        client->writing = FALSE;
+        client->last_input = now;
+        net_poll_add(io_poll, client->socket, NET_POLL_IN, client);
+      }
+
+      if (!client->registered) { continue; }
+
+      //
+      // The client is supposed to send a heart-beat packet
+      // at least every 15 sec
+      //
+      if (client->running && now - client->last_input > 30000000) {
+        t_print("%s: client timed out\n", __FUNCTION__);
+        client_disconnect(client);
+      }
+
+      int was_writing = client->writing;
+
+      if (client->running && io_write(client) < 0) {
+        client_disconnect(client);
+      }
+
+      if (!client->running) {
+        io_close(client);
+        continue;
+      }
+
+      if (client->writing != was_writing) {
+        net_poll_modify(io_poll, client->socket, NET_POLL_IN | (client->writing ? NET_POLL_OUT : 0), client);
+        g_mutex_lock(&client_mutex);
+        link_stats_stall(&client->link, client->writing);
+        g_mutex_unlock(&client_mutex);
+      }
+
+      //
+      // Parsing stopped since the command queue was full: try again soon
+      //
+      if (client->input_length >= (int)sizeof(HEADER) && server_input(client) > 0) {
+        timeout = 10;
       }
     }
   }
 
-  send_bytes(s, (char *)&command, sizeof(command));
+  if (udp_socket >= 0) {
+    net_poll_remove(io_poll, udp_socket);
+    close(udp_socket);
+    udp_socket = -1;
+  }
+
+  return NULL;
 }
 
-void send_noise(int s, const RECEIVER *rx) {
+//
+// One (short-lived) thread per client does the handshake
+// and queues the initial data.
+//
+static gpointer client_session(gpointer arg) {
+  REMOTE_CLIENT *client = (REMOTE_CLIENT *)arg;
+  struct timeval timeout;
+  unsigned char s[2 * SHA512_DIGEST_LENGTH];
+  unsigned char sha[SHA512_DIGEST_LENGTH];
   //
-  // The client sends this whenever a noise reduction
-  // setting is changed.
+  // Set a time-out of 30 seconds for the handshake.
   //
-  NOISE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_NOISE);
-  command.id                        = rx->id;
-  command.nb                        = rx->nb;
-  command.nr                        = rx->nr;
-  command.anf                       = rx->anf;
-  command.snb                       = rx->snb;
-  command.nb2_mode                  = rx->nb2_mode;
-  command.nr_agc                    = rx->nr_agc;
-  command.nr2_gain_method           = rx->nr2_gain_method;
-  command.nr2_npe_method            = rx->nr2_npe_method;
-  command.nr2_ae                    = rx->nr2_ae;
-  command.nb_tau                    = to_double(rx->nb_tau);
-  command.nb_hang                   = to_double(rx->nb_hang);
-  command.nb_advtime                = to_double(rx->nb_advtime);
-  command.nb_thresh                 = to_double(rx->nb_thresh);
-  command.nr2_trained_threshold     = to_double(rx->nr2_trained_threshold);
-  command.nr2_trained_t2            = to_double(rx->nr2_trained_t2);
-#ifdef EXTNR
-  command.nr4_reduction_amount      = to_double(rx->nr4_reduction_amount);
-  command.nr4_smoothing_factor      = to_double(rx->nr4_smoothing_factor);
-  command.nr4_whitening_factor      = to_double(rx->nr4_whitening_factor);
-  command.nr4_noise_rescale         = to_double(rx->nr4_noise_rescale);
-  command.nr4_post_threshold        = to_double(rx->nr4_post_threshold);
-#else
+  timeout.tv_sec = 30;
+  timeout.tv_usec = 0;
+  SETSOCKOPT(client->socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  timeout.tv_sec =  1;
+  SETSOCKOPT(client->socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  inet_ntop(AF_INET, &(((struct sockaddr_in *)&client->address)->sin_addr), (char *)s, 2 * SHA512_DIGEST_LENGTH);
+  t_print("%s: client_connected from %s\n", __FUNCTION__, s);
   //
-  // If this side is not compiled with EXTNR, fill in default values
+  // send version number to the client
   //
-  command.nr4_reduction_amount      = to_double(10.0);
-  command.nr4_smoothing_factor      = to_double(0.0);
-  command.nr4_whitening_factor      = to_double(0.0);
-  command.nr4_noise_rescale         = to_double(2.0);
-  command.nr4_post_threshold        = to_double(-10.0);
-#endif
-  send_bytes(s, (char *)&command, sizeof(command));
-}
+  s[0] = (CLIENT_SERVER_VERSION >> 24) & 0xFF;
+  s[1] = (CLIENT_SERVER_VERSION >> 16) & 0xFF;
+  s[2] = (CLIENT_SERVER_VERSION >>  8) & 0xFF;
+  s[3] = (CLIENT_SERVER_VERSION      ) & 0xFF;
+  send_bytes(client->socket, (char *)s, 4);
+  int ok = (RAND_bytes(s, SHA512_DIGEST_LENGTH) == 1);
+  send_bytes(client->socket, (char *)s, SHA512_DIGEST_LENGTH);
+  generate_pwd_hash(s, sha, hpsdr_pwd);
 
-void send_capture(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_CAPTURE);
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+  if (recv_bytes(client->socket, (char *)s, SHA512_DIGEST_LENGTH) < 0) {
+    t_print("%s: could not receive Passwd Response\n", __FUNCTION__);
+    ok = FALSE;
+  }
 
-void send_bandstack(int s, int old, int new) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_BANDSTACK);
-  header.b1 = old;
-  header.b2 = new;
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+  //
+  // Handle too-short server passwords as if the passwords did not match
+  //
+  if (!ok || memcmp(sha, s, SHA512_DIGEST_LENGTH)  != 0 || strlen(hpsdr_pwd) < 5) {
+    t_print("%s: ATTENTION: Wrong Password from Client.\n", __FUNCTION__);
+    sleep(1);
+    *s = 0xF7;
+  } else {
+    *s = 0x7F;
+  }
 
-void send_band(int s, int v, int band) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_BAND_SEL);
-  header.b1 = v;
-  header.b2 = band;
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+  send_bytes(client->socket, (char *)s, 1);
 
-void send_twotone(int s, int state) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_TWOTONE);
-  header.b1 = state;
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+  //
+  // The client reports what it has cached from an earlier session
+  //
+  STATE_RESUME resume;
 
-void send_tune(int s, int state) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_TUNE);
-  header.b1 = state;
-  header.s1 = to_short(full_tune);
-  header.s2 = to_short(memory_tune);
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+  if (*s == 0x7F && (recv_bytes(client->socket, (char *)&resume, sizeof(STATE_RESUME)) < 0 ||
+                     from_short(resume.header.data_type) != CMD_STATE_RESUME)) {
+    t_print("%s: could not receive state resume request\n", __FUNCTION__);
+    *s = 0;
+  }
 
-void send_vox(int s, int state) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_VOX);
-  header.b1 = state;
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+  if (*s == 0x7F) {
+    //
+    // Uncompressed RX audio and spectrum until the client requests a format
+    //
+    client->audio_codec = AUDIO_CODEC_PCM;
+    client->audio_bitrate = 0;
+    client->audio_frame = 0;
+    client->audio_stream[0] = client->audio_stream[1] = -1;
+    link_stats_init(&client->link);
+    client->iq_rate[0] = client->iq_rate[1] = 0;
+    client->iq_stream[0] = client->iq_stream[1] = -1;
+
+    for (int id = 0; id <= SPECTRUM_TX; id++) {
+      client->spectrum_format[id].active = 0;
+      client->spectrum_stream[id] = -1;
+      client->spectrum_resync[id] = 0;
+    }
+
+    for (int id = 0; id < 8; id++) {
+      client->send_rx_spectrum[id] = FALSE;
+    }
+
+    client->send_tx_spectrum = FALSE;
+    send_queue_init(&client->queue, io_wakeup, NULL);
+    client->spectrum_dropped = 0;
+    client->input = g_malloc(REMOTE_INPUT_SIZE);
+    client->input_length = 0;
+    client->input_resync = FALSE;
+    //
+    // From now on, the I/O thread does all the sending and receiving
+    //
+    fcntl(client->socket, F_SETFL, fcntl(client->socket, F_GETFL, 0) | O_NONBLOCK);
+    //
+    // The first client controls the radio
+    //
+    int controllers = 0;
+    g_mutex_lock(&client_mutex);
 
-void send_toggle_mox(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_TOGGLE_MOX);
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+    for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+      if (remoteclients[i].in_use && remoteclients[i].controlling) { controllers++; }
+    }
 
-void send_toggle_tune(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_TOGGLE_TUNE);
-  header.s1 = to_short(full_tune);
-  header.s2 = to_short(memory_tune);
-  send_bytes(s, (char *)&header, sizeof(header));
+    client->controlling = (controllers == 0);
+    g_mutex_unlock(&client_mutex);
+    //
+    // Queue the initial data. This makes the client "running", and the
+    // I/O thread picks it up when it is woken up by the first packet.
+    //
+    server_sync(client, &resume);
+    t_print("%s: %d client(s), this one is %s\n", __FUNCTION__, remote_clients,
+            client->controlling ? "controlling the radio" : "watching");
+    g_idle_add(server_session_update, NULL);
+    return NULL;
+  }
+
+  close(client->socket);
+  g_mutex_lock(&client_mutex);
+  client->socket = -1;
+  client->in_use = FALSE;
+  g_mutex_unlock(&client_mutex);
+  return NULL;
 }
 
-void send_mox(int s, int state) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_MOX);
-  header.b1 = state;
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+static void *listen_thread(void *arg) {
+  struct sockaddr_in address;
+  int on = 1;
+  t_print("%s: listening on port %d\n", __FUNCTION__, listen_port);
+  // create TCP socket to listen on
+  listen_socket = socket(AF_INET, SOCK_STREAM, 0);
 
-void send_mode(int s, int v, int mode) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_MODE);
-  header.b1 = v;
-  header.b2 = mode;
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+  if (listen_socket < 0) {
+    t_print("%s: socket() failed\n", __FUNCTION__);
+    return NULL;
+  }
 
-void send_filter_var(int s, int m, int f) {
-  //
-  // Change filter edges for filter f for  mode m
-  // This is intended for Var1/Var2 and does not do
-  // anything else.
-  //
-  if (f == filterVar1 || f == filterVar2) {
-    HEADER header;
-    SYNC(header.sync);
-    header.data_type = to_short(CMD_FILTER_VAR);
-    header.b1 = m;
-    header.b2 = f;
-    header.s1 = to_short(filters[m][f].low);
-    header.s2 = to_short(filters[m][f].high);
-    send_bytes(s, (char *)&header, sizeof(HEADER));
+  SETSOCKOPT(listen_socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  SETSOCKOPT(listen_socket, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+  // bind to listening port
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = INADDR_ANY;
+  address.sin_port = to_short(listen_port);
+
+  if (bind(listen_socket, (struct sockaddr * )&address, sizeof(address)) < 0) {
+    t_print("%s: bind() failed\n", __FUNCTION__);
+    return NULL;
   }
-}
 
-void send_rx_filter_cut(int s, int id) {
-  //
-  // This changes the filter cuts in the receiver
-  //
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_RX_FILTER_CUT);
-  header.b1 = id;
+  // listen for connections
+  if (listen(listen_socket, 5) < 0) {
+    t_print("%s: listen() failed\n", __FUNCTION__);
+    return NULL;
+  }
+
+  while (server_running) {
+    struct sockaddr_in client_address;
+    socklen_t client_address_length = sizeof(client_address);
+    t_print("%s: accepting connections...\n", __FUNCTION__);
+    int sock = accept(listen_socket, (struct sockaddr * )&client_address, &client_address_length);
+
+    if (sock < 0) {
+      t_print("%s: accept() failed\n", __FUNCTION__);
+      break;
+    }
+
+    REMOTE_CLIENT *client = NULL;
+    g_mutex_lock(&client_mutex);
+
+    for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+      if (!remoteclients[i].in_use) {
+        client = &remoteclients[i];
+        client->in_use = TRUE;
+        client->running = FALSE;
+        client->controlling = FALSE;
+        client->socket = sock;
+        client->address = client_address;
+        client->address_length = client_address_length;
+        break;
+      }
+    }
+
+    g_mutex_unlock(&client_mutex);
 
-  if (id < receivers) {
-    header.s1  =  to_short(receiver[id]->filter_low);
-    header.s2  =  to_short(receiver[id]->filter_high);
+    if (client == NULL) {
+      t_print("%s: too many clients, connection refused\n", __FUNCTION__);
+      close(sock);
+      continue;
+    }
+
+    g_thread_unref(g_thread_new("remote_session", client_session, client));
   }
 
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  close(listen_socket);
+  listen_socket = -1;
+  return NULL;
 }
 
-void send_tx_filter_cut(int s) {
-  //
-  // This changes the filter cuts in the transmitter
-  //
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_TX_FILTER_CUT);
+//
+// Address of the controlling client, with the number of other clients
+//
+void remote_client_address(char *text, size_t len) {
+  *text = 0;
+  g_mutex_lock(&client_mutex);
 
-  if (can_transmit) {
-    header.s1  =  to_short(transmitter->filter_low);
-    header.s2  =  to_short(transmitter->filter_high);
+  for (int i = 0; i < MAX_REMOTE_CLIENTS; i++) {
+    const REMOTE_CLIENT *client = &remoteclients[i];
+
+    if (client->running && client->controlling) {
+      inet_ntop(AF_INET, &client->address.sin_addr, text, len);
+    }
   }
 
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (remote_clients > 1) {
+    size_t l = strlen(text);
+    snprintf(text + l, len - l, " (+%d)", remote_clients - 1);
+  }
 
-void send_filter_sel(int s, int v, int f) {
-  //
-  // Change filter of VFO v to filter f
-  //
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_FILTER_SEL);
-  header.b1 = v;
-  header.b2 = f;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  g_mutex_unlock(&client_mutex);
 }
 
-void send_sidetone_freq(int s, int f) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_SIDETONEFREQ);
-  header.s1 = to_short(f);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+//
+// Called (in the GTK thread) upon state changes
+//
+static void server_notify(int changes, gpointer data) {
+  VFO_DATA vfo_data;
 
-void send_cwpeak(int s, int v, int p) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_CWPEAK);
-  header.b1 = v;
-  header.b2 = p;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (!server_running || remote_clients == 0) { return; }
 
-void send_digidrivemax(int s) {
-  DOUBLE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_DIGIMAX);
-  command.dbl = to_double(drive_digi_max);
-  send_bytes(s, (char *)&command, sizeof(DOUBLE_COMMAND));
-}
+  if (changes & (NOTIFY_VFO | NOTIFY_MODE | NOTIFY_FILTER)) {
+    for (int v = VFO_A; v <= VFO_B; v++) {
+      vfo_data_fill(&vfo_data, v);
 
-void send_am_carrier(int s) {
-  if (can_transmit) {
-    DOUBLE_COMMAND command;
-    SYNC(command.header.sync);
-    command.header.data_type = to_short(CMD_AMCARRIER);
-    command.dbl = to_double(transmitter->am_carrier_level);
-    send_bytes(s, (char *)&command, sizeof(DOUBLE_COMMAND));
+      if (memcmp(&vfo_data, &server_vfo_sent[v], sizeof(VFO_DATA))) {
+        send_vfo_data(REMOTE_BROADCAST, v);
+      }
+    }
   }
-}
 
-void send_dexp(int s) {
-  if (can_transmit) {
-    DEXP_DATA command;
-    SYNC(command.header.sync);
-    command.header.data_type = to_short(CMD_DEXP);
-    command.dexp = transmitter->dexp;
-    command.dexp_filter = transmitter->dexp_filter;
-    command.dexp_trigger = to_short(transmitter->dexp_trigger);
-    command.dexp_exp = to_short(transmitter->dexp_exp);
-    command.dexp_filter_low = to_short(transmitter->dexp_filter_low);
-    command.dexp_filter_high = to_short(transmitter->dexp_filter_high);
-    command.dexp_tau = to_double(transmitter->dexp_tau);
-    command.dexp_attack = to_double(transmitter->dexp_attack);
-    command.dexp_release = to_double(transmitter->dexp_release);
-    command.dexp_hold = to_double(transmitter->dexp_hold);
-    command.dexp_hyst = to_double(transmitter->dexp_hyst);
-    send_bytes(s, (char *)&command, sizeof(DEXP_DATA));
+  if ((changes & NOTIFY_SPLIT) && split != server_split_sent) {
+    send_split(REMOTE_BROADCAST, split);
+  }
+
+  if ((changes & NOTIFY_MOX) && mox != server_mox_sent) {
+    send_mox(REMOTE_BROADCAST, mox);
   }
 }
 
-void send_tx_compressor(int s) {
-  if (can_transmit) {
-    COMPRESSOR_DATA command;
-    SYNC(command.header.sync);
-    command.header.data_type = to_short(CMD_COMPRESSOR);
-    command.compressor = transmitter->compressor;
-    command.cfc = transmitter->cfc;
-    command.cfc_eq = transmitter->cfc_eq;
-    command.compressor_level = to_double(transmitter->compressor_level);
+int create_hpsdr_server() {
+  t_print("create_hpsdr_server\n");
+  g_mutex_init(&client_mutex);
 
-    for (int i = 0; i < 11; i++) {
-      command.cfc_freq[i] = to_double(transmitter->cfc_freq[i]);
-      command.cfc_lvl [i] = to_double(transmitter->cfc_lvl [i]);
-      command.cfc_post[i] = to_double(transmitter->cfc_post[i]);
+  if (io_poll == NULL) {
+    command_queue_init(&server_commands, SERVER_COMMANDS, 32, remote_command);
+    io_poll = net_poll_new();
+
+    if (io_poll == NULL || pipe(io_pipe) < 0) {
+      t_print("%s: cannot initialise server I/O\n", __FUNCTION__);
+      return -1;
     }
 
-    send_bytes(s, (char *)&command, sizeof(COMPRESSOR_DATA));
+    fcntl(io_pipe[0], F_SETFL, fcntl(io_pipe[0], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(io_pipe[1], F_SETFL, fcntl(io_pipe[1], F_GETFL, 0) | O_NONBLOCK);
+    net_poll_add(io_poll, io_pipe[0], NET_POLL_IN, NULL);
   }
-}
 
-void send_txmenu(int s) {
-  if (can_transmit) {
-    TXMENU_DATA command;
-    SYNC(command.header.sync);
-    command.header.data_type = to_short(CMD_TXMENU);
-    command.tune_drive = transmitter->tune_drive;
-    command.tune_use_drive = transmitter->tune_use_drive;
-    command.swr_protection = transmitter->swr_protection;
-    command.mic_boost = mic_boost;
-    command.mic_linein = mic_linein;
-    command.linein_gain = to_double(linein_gain);
-    command.swr_alarm = to_double(transmitter->swr_alarm);
-    send_bytes(s, (char *)&command, sizeof(TXMENU_DATA));
-  }
-}
+  //
+  // UDP side channel. Without it, the server still works (TCP only).
+  //
+  udp_socket = socket(AF_INET, SOCK_DGRAM, 0);
 
-void send_ctcss(int s) {
-  if (can_transmit) {
-    HEADER header;
-    SYNC(header.sync);
-    header.data_type = to_short(CMD_CTCSS);
-    header.b1 = transmitter->ctcss_enabled;
-    header.b2 = transmitter->ctcss;
-    send_bytes(s, (char *)&header, sizeof(HEADER));
+  if (udp_socket >= 0) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = to_short(listen_port);
+
+    if (bind(udp_socket, (struct sockaddr *)&address, sizeof(address)) < 0) {
+      t_perror("create_hpsdr_server: UDP bind");
+      close(udp_socket);
+      udp_socket = -1;
+    } else {
+      fcntl(udp_socket, F_SETFL, fcntl(udp_socket, F_GETFL, 0) | O_NONBLOCK);
+      net_poll_add(io_poll, udp_socket, NET_POLL_IN, &udp_socket);
+    }
   }
-}
 
-void send_txfilter(int s) {
-  if (can_transmit) {
-    HEADER header;
-    SYNC(header.sync);
-    header.data_type = to_short(CMD_TXFILTER);
-    header.b1 = transmitter->use_rx_filter;
-    header.s1 = to_short(transmitter->default_filter_low);
-    header.s2 = to_short(transmitter->default_filter_high);
-    send_bytes(s, (char *)&header, sizeof(HEADER));
+  server_running = TRUE;
+
+  if (server_notify_id == 0) {
+    server_notify_id = notify_subscribe(NOTIFY_VFO | NOTIFY_MODE | NOTIFY_FILTER | NOTIFY_SPLIT | NOTIFY_MOX,
+                                        server_notify, NULL);
   }
+
+  io_thread_id = g_thread_new("HPSDR_io", io_thread, NULL);
+  listen_thread_id = g_thread_new( "HPSDR_listen", listen_thread, NULL);
+  return 0;
 }
 
-void send_preemp(int s) {
-  if (can_transmit) {
-    HEADER header;
-    SYNC(header.sync);
-    header.data_type = to_short(CMD_PREEMP);
-    header.b1 = transmitter->pre_emphasize;
-    send_bytes(s, (char *)&header, sizeof(HEADER));
+int destroy_hpsdr_server() {
+  t_print("destroy_hpsdr_server\n");
+  server_running = FALSE;
+
+  if (server_notify_id != 0) {
+    notify_unsubscribe(server_notify_id);
+    server_notify_id = 0;
   }
-}
 
-void send_psparams(int s, const TRANSMITTER *tx) {
-  PS_PARAMS params;
-  SYNC(params.header.sync);
-  params.header.data_type = to_short(CMD_PSPARAMS);
-  params.ps_ptol = tx->ps_ptol;
-  params.ps_oneshot = tx->ps_oneshot;
-  params.ps_map = tx->ps_map;
-  params.ps_setpk = to_double(tx->ps_setpk);
-  send_bytes(s, (char *)&params, sizeof(PS_PARAMS));
+  if (io_poll != NULL) { io_wakeup(NULL); }
+  return 0;
 }
 
-void send_psresume(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_PSRESUME);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+// CLIENT Code
 
-void send_psreset(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_PSRESET);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+//
+// Not all VFO frequency updates and other settings generate a packet to be
+// sent by the client. Instead, they are "collected" and sent out (if necessary)
+// every CLIENT_BATCH_TICK milli seconds.
+// We use this periodic job to send a heart beat every 15 sec.
+//
+static int check_vfo(void *arg) {
+  static int count = 0;
 
-void send_psonoff(int s, int state) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_PSONOFF);
-  header.b1 = state;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (!client_running) { return FALSE; }
 
-void send_psatt(int s) {
-  //
-  // This sends TX attenuation, PS auto-att, feedback, and PS ant
-  if (can_transmit) {
-    HEADER header;
-    SYNC(header.sync);
-    header.data_type = to_short(CMD_PSATT);
-    header.b1 = transmitter->auto_on;
-    header.b2 = transmitter->feedback;
-    header.s1 = to_short(transmitter->attenuation);
-    header.s2 = to_short(receiver[PS_RX_FEEDBACK]->alex_antenna);
-    send_bytes(s, (char *)&header, sizeof(HEADER));
+  if (count++ >= 15000 / CLIENT_BATCH_TICK) {
+    send_heartbeat(client_socket);
+    count = 0;
   }
-}
 
-void send_afbinaural(int s, const RECEIVER *rx) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_BINAURAL);
-  header.b1 = rx->id;
-  header.b2 = rx->binaural;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  g_mutex_lock(&send_mutex);
+  client_batch_flush(client_socket);
+  g_mutex_unlock(&send_mutex);
+  return TRUE;
 }
 
-void send_rx_fft(int s, const RECEIVER *rx) {
-  U64_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_RXFFT);
-  command.header.b1 = rx->id;
-  command.header.b2 = rx->low_latency;
-  command.u64 = to_ll(rx->fft_size);
-  send_bytes(s, (char *)&command, sizeof(U64_COMMAND));
-}
+static char server_host[128];
 
-void send_tx_fft(int s, const TRANSMITTER *tx) {
-  U64_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_TXFFT);
-  command.header.b1 = tx->id;
-  command.u64 = to_ll(tx->fft_size);
-  send_bytes(s, (char *)&command, sizeof(U64_COMMAND));
+void start_vfo_timer() {
+  check_vfo_timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, CLIENT_BATCH_TICK, check_vfo, NULL, NULL);
+  t_print("check_vfo_timer_id %d\n", check_vfo_timer_id);
 }
 
-void send_patrim(int s) {
-  PATRIM_DATA command;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_PATRIM);
-  command.pa_power = pa_power;
+//
+// Output one RX audio sample received from the server.
+// Note CAPTURing is only done on the server side
+//
+static void client_rxaudio_sample(RECEIVER *rx, short left_sample, short right_sample) {
+  if (radio_is_transmitting() && (!duplex || mute_rx_while_transmitting)) {
+    left_sample = 0.0;
+    right_sample = 0.0;
+  }
 
-  for (int i = 0; i < 11; i++) {
-    command.pa_trim[i] = to_double(pa_trim[i]);
+  if (rx->mute_radio || (rx != active_receiver && rx->mute_when_not_active)) {
+    left_sample = 0;
+    right_sample = 0;
   }
 
-  send_bytes(s, (char *)&command, sizeof(PATRIM_DATA));
-}
+  if (rx->audio_channel == LEFT)  { right_sample = 0; }
 
-void send_deviation(int s, int v, int dev) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_DEVIATION);
-  header.b1 = v;
-  header.s1 = to_short(dev);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (rx->audio_channel == RIGHT) { left_sample  = 0; }
 
-void send_vfo_atob(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_VFO_A_TO_B);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  if (rx->local_audio) {
+    audio_write(rx, (float)left_sample / 32767.0, (float)right_sample / 32767.0);
+  }
 }
 
-void send_vfo_btoa(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_VFO_B_TO_A);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+//
+// Request the spectrum format that fits the panadapter/waterfall
+// settings of the client. Called whenever a spectrum frame arrives,
+// and a request is only sent if something has changed.
+//
+static void client_check_spectrum_format(int id) {
+  SPECTRUM_FORMAT *format = &client_spectrum_format[id];
+  int width, fps, low, high;
+  int deadband = remote_spectrum_choice > 0 ? remote_spectrum_choice : 0;
 
-void send_vfo_swap(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_VFO_SWAP);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (id == SPECTRUM_TX) {
+    const TRANSMITTER *tx = transmitter;
+    width = tx->width;
+    fps = tx->fps;
+    low = tx->panadapter_low - 10;
+    high = tx->panadapter_high;
+  } else {
+    const RECEIVER *rx = receiver[id];
+    width = rx->width;
+    fps = rx->fps;
+    low = (rx->panadapter_low < rx->waterfall_low ? rx->panadapter_low : rx->waterfall_low) - 10;
+    high = rx->panadapter_high > rx->waterfall_high ? rx->panadapter_high : rx->waterfall_high;
+  }
 
-void send_heartbeat(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_HEARTBEAT);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (remote_spectrum_choice > 1) { width = width / 2; }
 
-void send_soapy_rxant(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_SOAPY_RXANT);
-  header.b1 = adc[0].antenna;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (high - low > 255) { low = high - 255; }
 
-void send_soapy_txant(int s) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_SOAPY_TXANT);
-  header.b1 = dac.antenna;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (format->active && format->width == width && format->fps == fps && format->low == low
+      && format->high == high && format->deadband == deadband) {
+    return;
+  }
 
-void send_soapy_agc(int s, int id) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_SOAPY_AGC);
-  header.b1 = id;
-  header.b2 = adc[id].agc;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  format->active = 1;
+  format->width = width;
+  format->fps = fps;
+  format->low = low;
+  format->high = high;
+  format->deadband = deadband;
+  send_spectrum_format(client_socket, id, width, fps, low, high, deadband);
 }
 
-void send_split(int s, int state) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_SPLIT);
-  header.b1 = state;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+//
+// Apply the VFO frequencies that come with the spectrum data
+//
+static void client_spectrum_vfo(long long frequency_a, long long frequency_b, long long ctun_frequency_a,
+                                long long ctun_frequency_b, long long offset_a, long long offset_b) {
+  if (vfo[VFO_A].frequency != frequency_a || vfo[VFO_B].frequency != frequency_b
+      || vfo[VFO_A].ctun_frequency != ctun_frequency_a || vfo[VFO_B].ctun_frequency != ctun_frequency_b
+      || vfo[VFO_A].offset != offset_a || vfo[VFO_B].offset != offset_b) {
+    vfo[VFO_A].frequency = frequency_a;
+    vfo[VFO_B].frequency = frequency_b;
+    vfo[VFO_A].ctun_frequency = ctun_frequency_a;
+    vfo[VFO_B].ctun_frequency = ctun_frequency_b;
+    vfo[VFO_A].offset = offset_a;
+    vfo[VFO_B].offset = offset_b;
+    g_idle_add(ext_vfo_update, NULL);
+  }
 }
 
-void send_cw(int s, int state, int wait) {
-  //
-  // Send this in one header although wait may exceed a short
-  //
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_CW);
-  header.b1  = state;
-  header.s1 = to_short(wait >> 12);
-  header.s2 = to_short(wait & 0xFFF);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+//
+// Put RX audio received from the server into the jitter buffer
+//
+static void client_rxaudio_put(int id, const short *samples, int numsamples) {
+  if (id < 0 || id > 1 || numsamples <= 0) { return; }
 
-void send_sat(int s, int sat) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_SAT);
-  header.b1  = sat;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (rxaudio_jitter_buffer[id] == NULL) {
+    rxaudio_jitter_buffer[id] = jitter_buffer_new(numsamples, AUDIO_PLAYOUT_SIZE);
+  }
 
-void send_duplex(int s, int state) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_DUP);
-  header.b1 = state;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  jitter_buffer_put(rxaudio_jitter_buffer[id], samples, numsamples, 2);
 }
 
-void send_display(int s, int id) {
-  DOUBLE_COMMAND command;
-  SYNC(command.header.sync);
-  command.header.b1 = id;
+//
+// The audio back-ends do not ask for data, so the RX audio is
+// pushed to them in blocks of AUDIO_PLAYOUT_SIZE samples, paced by
+// the local clock. The difference between this clock and the clock
+// of the radio is compensated by the jitter buffers. If this thread
+// falls behind by more than 50 msec (e.g. a blocking audio_write),
+// it does not try to catch up.
+//
+static gpointer playout_thread(gpointer arg) {
+  const gint64 period = 1000000LL * AUDIO_PLAYOUT_SIZE / 48000;
+  gint64 deadline = g_get_monotonic_time();
 
-  if (id < RECEIVERS) {
-    command.header.data_type = to_short(CMD_RX_DISPLAY);
-    command.header.b2 = receiver[id]->display_detector_mode;
-    command.header.s1 = to_short(receiver[id]->display_average_mode);
-    command.dbl = to_double(receiver[id]->display_average_time);
-  } else if (can_transmit) {
-    command.header.data_type = to_short(CMD_TX_DISPLAY);
-    command.header.b2 = transmitter->display_detector_mode;
-    command.header.s1 = to_short(transmitter->display_average_mode);
-    command.dbl = to_double(transmitter->display_average_time);
-  }
+  while (client_running) {
+    deadline += period;
+    gint64 now = g_get_monotonic_time();
 
-  send_bytes(s, (char *)&command, sizeof(DOUBLE_COMMAND));
-}
+    if (deadline > now) {
+      g_usleep(deadline - now);
+    } else if (now - deadline > 50000) {
+      deadline = now;
+    }
 
-void send_rxfps(int s, int id, int fps) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_RX_FPS);
-  header.b1 = id;
-  header.b2 = fps;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+    for (int id = 0; id < 2; id++) {
+      JITTER_BUFFER *jb = rxaudio_jitter_buffer[id];
 
-void send_txfps(int s, int fps) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_TX_FPS);
-  header.b2 = fps;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+      if (jb == NULL || receiver[id] == NULL) { continue; }
 
-void send_lock(int s, int lock) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_LOCK);
-  header.b1 = lock;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+      for (int i = 0; i < AUDIO_PLAYOUT_SIZE; i++) {
+        double left, right;
 
-void send_ctun(int s, int vfo, int ctun) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_CTUN);
-  header.b1 = vfo;
-  header.b2 = ctun;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+        if (!jitter_buffer_get(jb, &left, &right)) { break; }
 
-void send_rx_select(int s, int id) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_RX_SELECT);
-  header.b1 = id;
-  send_bytes(s, (char *)&header, sizeof(header));
-}
+        client_rxaudio_sample(receiver[id], (short)(left * 32767.0), (short)(right * 32767.0));
+      }
+    }
+  }
 
-void send_rit(int s, int id) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_RIT);
-  header.b1 = id;
-  header.b2 = vfo[id].rit_enabled;
-  header.s1 = to_short(vfo[id].rit);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  return NULL;
 }
 
-void send_xit(int s, int id) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_XIT);
-  header.b1 = id;
-  header.b2 = vfo[id].xit_enabled;
-  header.s1 = to_short(vfo[id].xit);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+//
+// Payload length (the bytes following the header) of an audio or
+// spectrum packet, or -1 if the header is invalid
+//
+static int client_media_payload(const HEADER *header) {
+  int payload = from_short(header->s1);
+  int min, max;
+
+  switch (from_short(header->data_type)) {
+  case INFO_RX_SPECTRUM:
+  case INFO_TX_SPECTRUM:
+    min = offsetof(SPECTRUM_DATA, sample) - sizeof(HEADER);
+    max = sizeof(SPECTRUM_DATA) - sizeof(HEADER);
+    break;
 
-void send_sample_rate(int s, int id, int sample_rate) {
-  U64_COMMAND command;
-  long long rate = (long long)sample_rate;
-  SYNC(command.header.sync);
-  command.header.data_type = to_short(CMD_SAMPLE_RATE);
-  command.header.b1 = id;
-  command.u64 = to_ll(rate);
-  send_bytes(s, (char *)&command, sizeof(command));
-}
+  case INFO_SPECTRUM_CODED:
+    min = offsetof(CODED_SPECTRUM_DATA, data) - sizeof(HEADER);
+    max = sizeof(CODED_SPECTRUM_DATA) - sizeof(HEADER);
+    break;
 
-void send_receivers(int s, int receivers) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_RECEIVERS);
-  header.b1 = receivers;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  case INFO_RXAUDIO:
+    return sizeof(RXAUDIO_DATA) - sizeof(HEADER);
 
-void send_rit_step(int s, int v, int step) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_RIT_STEP);
-  header.b1 = v;
-  header.s1 = to_short(step);
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  case INFO_IQ:
+    return sizeof(IQ_DATA) - sizeof(HEADER);
 
-void send_filter_board(int s, int filter_board) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_FILTER_BOARD);
-  header.b1 = filter_board;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  case INFO_RXAUDIO_CODED:
+    min = offsetof(CODED_RXAUDIO_DATA, data) - sizeof(HEADER);
+    max = sizeof(CODED_RXAUDIO_DATA) - sizeof(HEADER);
+    break;
 
-void send_adc(int s, int id, int adc) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_ADC);
-  header.b1 = id;
-  header.b2 = adc;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  default:
+    return -1;
+  }
 
-void send_anan10E(int s, int new) {
-  HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_ANAN10E);
-  header.b1 = new;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
+  if (payload < min || payload > max) {
+    t_print("%s: invalid payload length %d\n", __FUNCTION__, payload);
+    return -1;
+  }
 
-void send_region(int s, int region) {
-  HEADER header;
-  //
-  // prepeare for bandstack reorganisation
-  //
-  radio_change_region(region);
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_REGION);
-  header.b1 = region;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
+  return payload;
 }
 
-void send_mute_rx(int s, int id, int mute) {
+//
+// Process one audio or spectrum packet (header included). These come
+// from the client thread (TCP) or the UDP thread, so this is serialised
+// by a mutex.
+//
+static void client_media(const uint8_t *packet, int len) {
   HEADER header;
-  SYNC(header.sync);
-  header.data_type = to_short(CMD_MUTE_RX);
-  header.b1 = id;
-  header.b2 = mute;
-  send_bytes(s, (char *)&header, sizeof(HEADER));
-}
 
-static void *listen_thread(void *arg) {
-  struct sockaddr_in address;
-  struct timeval timeout;
-  int on = 1;
-  t_print("%s: listening on port %d\n", __FUNCTION__, listen_port);
+  if (len < (int)sizeof(HEADER)) { return; }
 
-  while (server_running) {
-    if (listen_socket >= 0) { close(listen_socket); }
+  memcpy(&header, packet, sizeof(HEADER));
+  int type = from_short(header.data_type);
+  int payload = client_media_payload(&header);
 
-    // create TCP socket to listen on
-    listen_socket = socket(AF_INET, SOCK_STREAM, 0);
+  if (payload < 0 || len < (int)sizeof(HEADER) + payload) { return; }
 
-    if (listen_socket < 0) {
-      t_print("%s: socket() failed\n", __FUNCTION__);
-      return NULL;
-    }
+  g_mutex_lock(&media_mutex);
 
-    SETSOCKOPT(listen_socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
-    SETSOCKOPT(listen_socket, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
-    // bind to listening port
-    memset(&address, 0, sizeof(address));
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = to_short(listen_port);
+  switch (type) {
+  case INFO_RX_SPECTRUM:
+  case INFO_TX_SPECTRUM: {
+    SPECTRUM_DATA spectrum_data;
+    memcpy(&spectrum_data, packet, sizeof(HEADER) + payload);
+    //
+    // We load the current VFO frequencies on top of the spectrum data packets,
+    // so we can apply this info *before* drawing the spectrum. Normally the
+    // data should not have changed.
+    //
+    client_spectrum_vfo(from_ll(spectrum_data.vfo_a_freq), from_ll(spectrum_data.vfo_b_freq),
+                        from_ll(spectrum_data.vfo_a_ctun_freq), from_ll(spectrum_data.vfo_b_ctun_freq),
+                        from_ll(spectrum_data.vfo_a_offset), from_ll(spectrum_data.vfo_b_offset));
+    int width = from_short(spectrum_data.width);
 
-    if (bind(listen_socket, (struct sockaddr * )&address, sizeof(address)) < 0) {
-      t_print("%s: bind() failed\n", __FUNCTION__);
-      return NULL;
-    }
+    if (width > payload - (int)(offsetof(SPECTRUM_DATA, sample) - sizeof(HEADER))) { break; }
 
-    // listen for connections
-    if (listen(listen_socket, 5) < 0) {
-      t_print("%s: listen() failed\n", __FUNCTION__);
-      break;
-    }
+    if (type == INFO_RX_SPECTRUM && spectrum_data.id < receivers) {
+      RECEIVER *rx = receiver[spectrum_data.id];
+      client_check_spectrum_format(spectrum_data.id);
+      rx->zoom = spectrum_data.zoom;
+      rx->pan  = from_short(spectrum_data.pan);
+      rx->meter = from_double(spectrum_data.meter);
 
-    remoteclient.address_length = sizeof(remoteclient.address);
-    t_print("%s: accepting connections...\n", __FUNCTION__);
+      //
+      // With a local analyzer (remote IQ), only the meter is used
+      //
+      if (width == rx->width && !remote_dsp_analyzer(spectrum_data.id)) {
+        g_mutex_lock(&rx->display_mutex);
 
-    if ((remoteclient.socket = accept(listen_socket, (struct sockaddr * )&remoteclient.address,
-                                      &remoteclient.address_length)) < 0) {
-      t_print("%s: accept() failed\n");
-      break;
+        if (rx->pixel_samples == NULL) {
+          rx->pixel_samples = g_new(float, (int) rx->width);
+        }
+
+        for (int i = 0; i < rx->width; i++) {
+          rx->pixel_samples[i] = (float)((int)spectrum_data.sample[i] - 200);
+        }
+
+        g_mutex_unlock(&rx->display_mutex);
+        g_idle_add(ext_rx_remote_update_display, rx);
+      }
     }
 
+    if (type == INFO_TX_SPECTRUM && can_transmit) {
+      TRANSMITTER *tx = transmitter;
+      client_check_spectrum_format(SPECTRUM_TX);
+      tx->alc = from_double(spectrum_data.alc);
+      tx->fwd = from_double(spectrum_data.fwd);
+      tx->swr = from_double(spectrum_data.swr);
 
-    //
-    // Set a time-out of 30 seconds. The client is supposed to send a heart-beat packet at least
-    // every 15 sec
-    //
-    timeout.tv_sec = 30;
-    timeout.tv_usec = 0;
-    SETSOCKOPT(remoteclient.socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    timeout.tv_sec =  1;
-    SETSOCKOPT(remoteclient.socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-    unsigned char s[2 * SHA512_DIGEST_LENGTH];
-    unsigned char sha[SHA512_DIGEST_LENGTH];
-    inet_ntop(AF_INET, &(((struct sockaddr_in *)&remoteclient.address)->sin_addr), (char *)s, 2 * SHA512_DIGEST_LENGTH);
-    t_print("%s: client_connected from %s\n", __FUNCTION__, s);
-    //
-    // send version number to the client
-    //
-    s[0] = (CLIENT_SERVER_VERSION >> 24) & 0xFF;
-    s[1] = (CLIENT_SERVER_VERSION >> 16) & 0xFF;
-    s[2] = (CLIENT_SERVER_VERSION >>  8) & 0xFF;
-    s[3] = (CLIENT_SERVER_VERSION      ) & 0xFF;
-    send_bytes(remoteclient.socket, (char *)s, 4);
+      if (tx->pixel_samples == NULL) {
+        tx->pixel_samples = g_new(float, (int) tx->width);
+      }
+
+      if (width == tx->width) {
+        for (int i = 0; i < tx->width; i++) {
+          tx->pixel_samples[i] = (float)((int)spectrum_data.sample[i] - 200);
+        }
 
-    if (RAND_bytes(s, SHA512_DIGEST_LENGTH) != 1) {
-      remoteclient.running = FALSE;
+        g_idle_add(ext_tx_remote_update_display, tx);
+      }
     }
+  }
+  break;
+
+  case INFO_SPECTRUM_CODED: {
+    CODED_SPECTRUM_DATA spectrum_data;
+    int fixed = offsetof(CODED_SPECTRUM_DATA, data) - sizeof(HEADER);
+    memcpy(&spectrum_data, packet, sizeof(HEADER) + payload);
+    int id = spectrum_data.id;
+    int flags = spectrum_data.flags;
+    const uint8_t *p = spectrum_data.data;
+    int n = payload - fixed;
 
-    send_bytes(remoteclient.socket, (char *)s, SHA512_DIGEST_LENGTH);
-    generate_pwd_hash(s, sha, hpsdr_pwd);
+    if (id > SPECTRUM_TX) { break; }
 
-    if (recv_bytes(remoteclient.socket, (char *)s, SHA512_DIGEST_LENGTH) < 0) {
-      t_print("%s: could not receive Passwd Response\n", __FUNCTION__);
-      remoteclient.running = FALSE;
+    if (flags & SPECTRUM_FLAG_VFO) {
+      SPECTRUM_VFO vfo_data;
+
+      if (n < (int)sizeof(SPECTRUM_VFO)) { break; }
+
+      memcpy(&vfo_data, p, sizeof(SPECTRUM_VFO));
+      p += sizeof(SPECTRUM_VFO);
+      n -= sizeof(SPECTRUM_VFO);
+      client_spectrum_vfo(from_ll(vfo_data.vfo_a_freq), from_ll(vfo_data.vfo_b_freq),
+                          from_ll(vfo_data.vfo_a_ctun_freq), from_ll(vfo_data.vfo_b_ctun_freq),
+                          from_ll(vfo_data.vfo_a_offset), from_ll(vfo_data.vfo_b_offset));
     }
 
-    //
-    // Handle too-short server passwords as if the passwords did not match
-    //
-    if (memcmp(sha, s, SHA512_DIGEST_LENGTH)  != 0 || strlen(hpsdr_pwd) < 5) {
-      t_print("%s: ATTENTION: Wrong Password from Client.\n", __FUNCTION__);
-      sleep(1);
-      *s = 0xF7;
-    } else {
-      *s = 0x7F;
+    if (spectrum_decoder[id] == NULL) {
+      spectrum_decoder[id] = spectrum_codec_new(0, 0);
     }
 
-    send_bytes(remoteclient.socket, (char *)s, 1);
+    int width = from_short(spectrum_data.width);
+    int low = from_short(spectrum_data.low);
 
-    if (*s == 0x7F) {
+    if (spectrum_decode(spectrum_decoder[id], p, n, width, flags & ~SPECTRUM_FLAG_VFO) < 0) {
       //
-      // Setting this has to be post-poned until HERE, since now
-      // the RX thread starts to send audio data. If we were TXing
-      // when the client successfully connects, go RX.
+      // Over UDP, this happens after a lost frame until the key frame arrives
       //
-      g_idle_add(ext_set_mox, GINT_TO_POINTER(0));
-      remoteclient.running = TRUE;
+      if (udp_client_socket < 0) { t_print("%s: could not decode spectrum frame\n", __FUNCTION__); }
+
+      client_spectrum_lost++;
+      break;
+    }
 
-      for (int id = 0; id < RECEIVERS; id++) {
-        remoteclient.send_rx_spectrum[id] = FALSE;
+    const uint8_t *pixels = spectrum_decoder[id]->ref;
+
+    if (id == SPECTRUM_TX) {
+      if (!can_transmit) { break; }
+
+      TRANSMITTER *tx = transmitter;
+      client_check_spectrum_format(SPECTRUM_TX);
+      tx->alc = from_double(spectrum_data.alc);
+      tx->fwd = from_double(spectrum_data.fwd);
+      tx->swr = from_double(spectrum_data.swr);
+
+      if (tx->pixel_samples == NULL) {
+        tx->pixel_samples = g_new(float, (int) tx->width);
       }
 
-      remoteclient.send_tx_spectrum = FALSE;
-      //
-      // Send PS and on-display data periodically
-      //
-      remoteclient.timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, 150, send_periodic_data, NULL, NULL);
-      //
-      // We disable "CW handled in Radio" since this makes no sense
-      // for remote operation.
-      //
-      int old_cwi = cw_keyer_internal;
-      cw_keyer_internal = 1;
-      keyer_update();  // shut down iambic keyer
-      cw_keyer_internal = 0;
-      schedule_transmit_specific();
-      server_loop();
-      cw_keyer_internal = old_cwi;
-      keyer_update();  // possibly restart iambic keyer
-      schedule_transmit_specific();
-      //
-      // If the connection breaks while transmitting, go RX
-      //
-      g_idle_add(ext_set_mox, GINT_TO_POINTER(0));
+      for (int i = 0; i < tx->width; i++) {
+        tx->pixel_samples[i] = (float)(low + pixels[(long)i * width / tx->width]);
+      }
+
+      g_idle_add(ext_tx_remote_update_display, tx);
+    } else if (id < receivers) {
+      RECEIVER *rx = receiver[id];
+      client_check_spectrum_format(id);
+      rx->zoom = spectrum_data.zoom;
+      rx->pan  = from_short(spectrum_data.pan);
+      rx->meter = from_double(spectrum_data.meter);
+
+      if (remote_dsp_analyzer(id)) { break; }
+
+      g_mutex_lock(&rx->display_mutex);
+
+      if (rx->pixel_samples == NULL) {
+        rx->pixel_samples = g_new(float, (int) rx->width);
+      }
 
       //
-      // Stop sending periodic data
+      // If the client has requested a reduced width, stretch
       //
-      if (remoteclient.timer_id != 0) {
-        g_source_remove(remoteclient.timer_id);
-        remoteclient.timer_id = 0;
+      for (int i = 0; i < rx->width; i++) {
+        rx->pixel_samples[i] = (float)(low + pixels[(long)i * width / rx->width]);
       }
+
+      g_mutex_unlock(&rx->display_mutex);
+      g_idle_add(ext_rx_remote_update_display, rx);
     }
+  }
+  break;
+
+  case INFO_RXAUDIO: {
+    RXAUDIO_DATA adata;
+    memcpy(&adata, packet, sizeof(RXAUDIO_DATA));
+    short pcm[2 * AUDIO_DATA_SIZE];
+    int numsamples = from_short(adata.numsamples);
+
+    if (numsamples > AUDIO_DATA_SIZE) { numsamples = AUDIO_DATA_SIZE; }
 
-    if (remoteclient.socket != -1) {
-      close(remoteclient.socket);
-      remoteclient.socket = -1;
+    if (adata.rx > 1) { break; }
+
+    audio_stats_add(AUDIO_CODEC_PCM, numsamples, sizeof(RXAUDIO_DATA), 0, 0, 0);
+
+    for (int i = 0; i < 2 * numsamples; i++) {
+      pcm[i] = from_short(adata.samples[i]);
     }
+
+    client_audio_frame[adata.rx] = numsamples;
+    client_rxaudio_put(adata.rx, pcm, numsamples);
   }
+  break;
 
-  return NULL;
-}
+  case INFO_RXAUDIO_CODED: {
+    CODED_RXAUDIO_DATA adata;
+    short pcm[2 * AUDIO_CODEC_MAX_FRAME];
+    int n = payload - (offsetof(CODED_RXAUDIO_DATA, data) - sizeof(HEADER));
+    memcpy(&adata, packet, sizeof(HEADER) + payload);
+    int id = adata.rx;
+    int codec = header.b1;
 
-int create_hpsdr_server() {
-  t_print("create_hpsdr_server\n");
-  g_mutex_init(&client_mutex);
-  server_running = TRUE;
-  listen_thread_id = g_thread_new( "HPSDR_listen", listen_thread, NULL);
-  return 0;
+    if (id > 1) { break; }
+
+    if (rxaudio_decoder[id] == NULL || audio_codec_get_codec(rxaudio_decoder[id]) != codec) {
+      audio_codec_free(rxaudio_decoder[id]);
+      rxaudio_decoder[id] = audio_decoder_new(codec);
+    }
+
+    if (rxaudio_decoder[id] == NULL) { break; }
+
+    gint64 t0 = g_get_monotonic_time();
+    int numsamples = audio_decode(rxaudio_decoder[id], adata.data, n, pcm);
+    gint64 t1 = g_get_monotonic_time();
+    audio_stats_add(codec, numsamples, payload + sizeof(HEADER), t1 - t0, 1, ntohl(adata.timestamp));
+
+    if (numsamples > 0) { client_audio_frame[id] = numsamples; }
+
+    client_rxaudio_put(id, pcm, numsamples);
+  }
+  break;
+
+  case INFO_IQ: {
+    IQ_DATA iqdata;
+    short mantissa[2 * IQ_DATA_SIZE];
+    double iq[2 * IQ_DATA_SIZE];
+    short pcm[2 * IQ_DATA_SIZE];
+    memcpy(&iqdata, packet, sizeof(IQ_DATA));
+    int id = iqdata.header.b1;
+
+    if (id > 1 || id >= receivers) { break; }
+
+    for (int i = 0; i < 2 * IQ_DATA_SIZE; i++) {
+      mantissa[i] = from_short(iqdata.samples[i]);
+    }
+
+    iq_decode(mantissa, IQ_DATA_SIZE, (int8_t) iqdata.exponent, iq);
+    client_iq_rate[id] = from_int(iqdata.sample_rate);
+    int numsamples = remote_dsp_process(receiver[id], client_iq_rate[id], iq, IQ_DATA_SIZE, pcm, IQ_DATA_SIZE);
+    client_rxaudio_put(id, pcm, numsamples);
+  }
+  break;
+  }
+
+  g_mutex_unlock(&media_mutex);
 }
 
-int destroy_hpsdr_server() {
-  t_print("destroy_hpsdr_server\n");
-  server_running = FALSE;
-  return 0;
+//
+// UDP side channel. A lost audio datagram is replaced by the codec's loss
+// concealment (uncompressed audio: silence), such that the jitter buffer
+// does not run dry. After a lost spectrum datagram, the decoder has no
+// valid reference until the next key frame, so request one.
+//
+static void client_udp_deliver(int channel, const uint8_t *payload, int len) {
+  client_media(payload, len);
 }
 
-// CLIENT Code
+static void client_udp_lost(int channel) {
+  g_mutex_lock(&media_mutex);
+
+  if (channel < UDP_CHANNEL_SPECTRUM) {
+    int id = channel - UDP_CHANNEL_AUDIO;
+    int n = client_audio_frame[id];
+    short pcm[2 * AUDIO_DATA_SIZE];
+
+    if (n > AUDIO_DATA_SIZE) { n = AUDIO_DATA_SIZE; }
+
+    if (rxaudio_decoder[id] != NULL && n <= AUDIO_CODEC_MAX_FRAME) {
+      n = audio_conceal(rxaudio_decoder[id], n, pcm);
+    } else {
+      memset(pcm, 0, 2 * n * sizeof(short));
+    }
+
+    client_rxaudio_put(id, pcm, n);
+  } else if (channel >= UDP_CHANNEL_IQ) {
+    //
+    // Lost IQ data is replaced by silence, which keeps the local
+    // demodulator (and the audio) running
+    //
+    int id = channel - UDP_CHANNEL_IQ;
+    double iq[2 * IQ_DATA_SIZE];
+    short pcm[2 * IQ_DATA_SIZE];
+
+    if (client_iq_rate[id] > 0 && id < receivers) {
+      memset(iq, 0, sizeof(iq));
+      int n = remote_dsp_process(receiver[id], client_iq_rate[id], iq, IQ_DATA_SIZE, pcm, IQ_DATA_SIZE);
+      client_rxaudio_put(id, pcm, n);
+    }
+  } else {
+    int id = channel - UDP_CHANNEL_SPECTRUM;
+    gint64 now = g_get_monotonic_time();
+
+    if (spectrum_decoder[id] != NULL) { spectrum_decoder[id]->valid = 0; }
+
+    client_spectrum_lost++;
+
+    if (now - udp_keyframe_time[id] > 100000) {
+      udp_keyframe_time[id] = now;
+      send_udp(client_socket, UDP_KEYFRAME, id);
+    }
+  }
+
+  g_mutex_unlock(&media_mutex);
+}
 
 //
-// Not all VFO frequency updates generate a packet to be sent by the client.
-// Instead, frequency updates are "collected" and sent out  (if necessary)
-// every 100 milli seconds.
-// We use this periodic job to send a heart beat every 15 sec.
+// The UDP thread sends the hello datagram (every second until data
+// arrives, then every 5 seconds to keep NAT mappings alive) and feeds
+// the received datagrams into the receivers.
 //
-static int check_vfo(void *arg) {
-  static int count = 0;
+static gpointer udp_thread(gpointer arg) {
+  uint8_t buf[sizeof(UDP_HEADER) + UDP_MAX_PAYLOAD];
+  UDP_HEADER hello;
+  struct timeval timeout;
+  gint64 last_hello = 0;
+  gint64 last_data = 0;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = 200000;
+  SETSOCKOPT(udp_client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  udp_header_init(&hello, UDP_HELLO, 0, udp_client_token);
 
-  if (!client_running) { return FALSE; }
+  while (client_running && udp_running) {
+    gint64 now = g_get_monotonic_time();
 
-  if (count++ >= 150) {
-    send_heartbeat(client_socket);
-    count = 0;
-  }
+    if (now - last_hello > (now - last_data < 5000000 ? 5000000 : 1000000)) {
+      if (send(udp_client_socket, &hello, sizeof(hello), 0) < 0) { t_perror("udp_thread"); }
+
+      last_hello = now;
+    }
 
-  g_mutex_lock(&accumulated_mutex);
+    int rc = recv(udp_client_socket, buf, sizeof(buf), 0);
 
-  for (int v = 0; v < 2; v++) {
-    if (accumulated_steps[v] != 0) {
-      send_vfo_step(client_socket, v, accumulated_steps[v]);
-      accumulated_steps[v] = 0;
+    if (rc < 0) { continue; }
+
+    const UDP_HEADER *hdr = (const UDP_HEADER *)buf;
+
+    if (udp_header_check(hdr, rc) < 0 || hdr->type == UDP_HELLO || (uint32_t)from_int(hdr->token) != udp_client_token) {
+      continue;
     }
 
-    if (accumulated_hz[v] != 0LL || accumulated_round[v]) {
-      send_vfo_move(client_socket, v, accumulated_hz[v], accumulated_round[v]);
-      accumulated_hz[v] = 0LL;
-      accumulated_round[v] = FALSE;
+    last_data = now;
+
+    //
+    // For testing: simulate a lossy network
+    //
+    if (udp_loss > 0 && g_random_int_range(0, 100) < udp_loss) { continue; }
+
+    udp_receiver_input(udp_receiver[hdr->channel], hdr, buf + sizeof(UDP_HEADER), rc - sizeof(UDP_HEADER));
+
+    if (hdr->channel < UDP_CHANNEL_SPECTRUM) {
+      udp_audio_lost = udp_receiver[0]->missing + udp_receiver[1]->missing;
+      udp_audio_recovered = udp_receiver[0]->recovered + udp_receiver[1]->recovered;
     }
   }
 
-  g_mutex_unlock(&accumulated_mutex);
-  return TRUE;
+  close(udp_client_socket);
+  udp_client_socket = -1;
+  return NULL;
 }
 
-static char server_host[128];
+//
+// The server has accepted the UDP side channel
+//
+static void client_udp_open(const UDP_COMMAND *command) {
+  int port = from_short(command->header.s1);
 
-void start_vfo_timer() {
-  g_mutex_init(&accumulated_mutex);
-  check_vfo_timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, 100, check_vfo, NULL, NULL);
-  t_print("check_vfo_timer_id %d\n", check_vfo_timer_id);
+  if (port == 0) {
+    t_print("%s: server has no UDP channel, staying with TCP\n", __FUNCTION__);
+    return;
+  }
+
+  if (udp_thread_id != NULL) {
+    udp_running = FALSE;
+    g_thread_join(udp_thread_id);
+    udp_thread_id = NULL;
+  }
+
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+
+  if (sock < 0) {
+    t_perror("client_udp_open");
+    return;
+  }
+
+  udp_server_address.sin_port = to_short(port);
+
+  if (connect(sock, (struct sockaddr *)&udp_server_address, sizeof(udp_server_address)) < 0) {
+    t_perror("client_udp_open");
+    close(sock);
+    return;
+  }
+
+  for (int i = 0; i < UDP_CHANNELS; i++) {
+    udp_receiver_free(udp_receiver[i]);
+    udp_receiver[i] = udp_receiver_new(i, client_udp_deliver, client_udp_lost);
+  }
+
+  const char *loss = getenv("PIHPSDR_UDP_LOSS");
+  udp_loss = loss ? atoi(loss) : 0;
+  udp_audio_lost = udp_audio_recovered = 0;
+  client_spectrum_lost = 0;
+  udp_client_token = from_int(command->token);
+  udp_client_socket = sock;
+  udp_running = TRUE;
+  udp_thread_id = g_thread_new("remote_udp", udp_thread, NULL);
+  t_print("%s: UDP channel to port %d, FEC group %d, simulated loss %d%%\n", __FUNCTION__, port,
+          command->header.b1, udp_loss);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -2735,6 +5395,119 @@ void start_vfo_timer() {
 //
 ////////////////////////////////////////////////////////////////////////////
 
+//
+// Tell the server which sections of the initial sync we have cached
+//
+static void send_state_resume(int sock) {
+  STATE_RESUME resume;
+  SYNC(resume.header.sync);
+  resume.header.data_type = to_short(CMD_STATE_RESUME);
+  resume.header.b1 = 0;
+  resume.header.b2 = 0;
+  resume.header.s1 = to_short(0);
+  resume.header.s2 = to_short(0);
+  state_cache_load(&client_state, client_state_file, CLIENT_SERVER_VERSION);
+
+  for (int i = 0; i < STATE_SECTIONS; i++) {
+    if (client_state.data[i] != NULL) { resume.header.b1 |= 1 << i; }
+
+    resume.hash[i] = to_ll(client_state.hash[i]);
+  }
+
+  send_bytes(sock, (char *)&resume, sizeof(STATE_RESUME));
+}
+
+//
+// Receive the initial sync, merge it with the cache, and
+// queue all sections for processing.
+//
+static int client_state_receive(const HEADER *header) {
+  STATE_DATA data;
+  memcpy(&data, header, sizeof(HEADER));
+
+  if (recv_bytes(client_socket, (char *)&data + sizeof(HEADER), sizeof(STATE_DATA) - sizeof(HEADER)) < 0) { return -1; }
+
+  unsigned int length = from_int(data.length);
+  unsigned int raw_length = from_int(data.raw_length);
+
+  if (length > 4194304 || raw_length > 4194304) {
+    t_print("%s: initial sync too large (%u bytes)\n", __FUNCTION__, length);
+    return -1;
+  }
+
+  //
+  // recv_bytes() gives up after ten partial reads, so read in chunks
+  //
+  GByteArray *payload = g_byte_array_sized_new(length);
+  g_byte_array_set_size(payload, length);
+
+  for (unsigned int pos = 0; pos < length; pos += 1024) {
+    if (recv_bytes(client_socket, (char *)payload->data + pos, MIN(1024, length - pos)) < 0) {
+      g_byte_array_free(payload, TRUE);
+      return -1;
+    }
+  }
+
+  if (data.header.b2) {
+    GByteArray *raw = state_uncompress(payload->data, payload->len, raw_length);
+    g_byte_array_free(payload, TRUE);
+
+    if (raw == NULL) { return -1; }
+
+    payload = raw;
+  } else if (length != raw_length) {
+    g_byte_array_free(payload, TRUE);
+    return -1;
+  }
+
+  t_print("%s: sections %02x, %u bytes received, %u uncompressed\n", __FUNCTION__,
+          data.header.b1, length, raw_length);
+  unsigned int pos = 0;
+  int ok = 1;
+
+  for (int i = 0; i < STATE_SECTIONS && ok; i++) {
+    unsigned int len = from_int(data.section_length[i]);
+
+    if (data.header.b1 & (1 << i)) {
+      ok = (pos + len <= payload->len);
+
+      if (ok) { state_snapshot_set(&client_state, i, payload->data + pos, len); }
+
+      pos += len;
+    }
+
+    ok = ok && client_state.data[i] != NULL && client_state.hash[i] == (uint64_t) from_ll(data.hash[i]);
+  }
+
+  g_byte_array_free(payload, TRUE);
+
+  if (!ok) {
+    //
+    // The cache does not match what the server has, so it is of no use
+    // for the next connection either.
+    //
+    t_print("%s: initial sync incomplete\n", __FUNCTION__);
+    state_snapshot_clear(&client_state);
+    remove(client_state_file);
+    return -1;
+  }
+
+  state_cache_save(&client_state, client_state_file, CLIENT_SERVER_VERSION);
+  client_replay = g_byte_array_new();
+  client_replay_pos = 0;
+
+  for (int i = 0; i < STATE_SECTIONS; i++) {
+    g_byte_array_append(client_replay, client_state.data[i]->data, client_state.data[i]->len);
+  }
+
+  if (client_replay->len == 0) {
+    g_byte_array_free(client_replay, TRUE);
+    client_replay = NULL;
+  }
+
+  return 0;
+}
+
 static void *client_thread(void* arg) {
   int bytes_read;
   HEADER header;
@@ -2811,6 +5584,10 @@ static void *client_thread(void* arg) {
     rx->id = PS_RX_FEEDBACK;
   }
 
+  if (playout_thread_id == NULL) {
+    playout_thread_id = g_thread_new("remote_playout", playout_thread, NULL);
+  }
+
   while (client_running) {
     int type;
     bytes_read = recv_bytes(client_socket, (char *)&header, sizeof(header));
@@ -3334,118 +6111,74 @@ static void *client_thread(void* arg) {
     break;
 
     case INFO_RX_SPECTRUM:
-    case INFO_TX_SPECTRUM: {
-      SPECTRUM_DATA spectrum_data;
-      //
-      // The length of the payload is included in the header, only
-      // read the number of bytes specified there.
+    case INFO_TX_SPECTRUM:
+    case INFO_SPECTRUM_CODED:
+    case INFO_RXAUDIO:
+    case INFO_RXAUDIO_CODED:
+    case INFO_IQ: {
       //
-      size_t payload = from_short(header.s1);
-
-      if (recv_bytes(client_socket, (char *)&spectrum_data + sizeof(HEADER), payload) < 0) { return NULL; }
-
+      // Audio and spectrum may also arrive over UDP, so they are
+      // processed elsewhere
       //
-      // We load the current VFO frequencies on top of the spectrum data packets,
-      // so we can apply this info *before* drawing the spectrum. Normally the
-      // data should not have changed.
-      //
-      long long frequency_a = from_ll(spectrum_data.vfo_a_freq);
-      long long frequency_b = from_ll(spectrum_data.vfo_b_freq);
-      long long ctun_frequency_a = from_ll(spectrum_data.vfo_a_ctun_freq);
-      long long ctun_frequency_b = from_ll(spectrum_data.vfo_b_ctun_freq);
-      long long offset_a = from_ll(spectrum_data.vfo_a_offset);
-      long long offset_b = from_ll(spectrum_data.vfo_b_offset);
-
-      if (vfo[VFO_A].frequency != frequency_a || vfo[VFO_B].frequency != frequency_b
-          || vfo[VFO_A].ctun_frequency != ctun_frequency_a || vfo[VFO_B].ctun_frequency != ctun_frequency_b
-          || vfo[VFO_A].offset != offset_a || vfo[VFO_B].offset != offset_b) {
-        vfo[VFO_A].frequency = frequency_a;
-        vfo[VFO_B].frequency = frequency_b;
-        vfo[VFO_A].ctun_frequency = ctun_frequency_a;
-        vfo[VFO_B].ctun_frequency = ctun_frequency_b;
-        vfo[VFO_A].offset = offset_a;
-        vfo[VFO_B].offset = offset_b;
-        g_idle_add(ext_vfo_update, NULL);
-      }
+      uint8_t packet[sizeof(HEADER) + UDP_MAX_PAYLOAD];
+      int payload = client_media_payload(&header);
 
-      if (type == INFO_RX_SPECTRUM && spectrum_data.id < receivers) {
-        RECEIVER *rx = receiver[spectrum_data.id];
-        rx->zoom = spectrum_data.zoom;
-        rx->pan  = from_short(spectrum_data.pan);
-        rx->meter = from_double(spectrum_data.meter);
-        int width = from_short(spectrum_data.width);
+      if (payload < 0 || payload > UDP_MAX_PAYLOAD) { return NULL; }
 
-        if (width == rx->width) {
-          g_mutex_lock(&rx->display_mutex);
+      memcpy(packet, &header, sizeof(HEADER));
 
-          if (rx->pixel_samples == NULL) {
-            rx->pixel_samples = g_new(float, (int) rx->width);
-          }
+      if (recv_bytes(client_socket, (char *)packet + sizeof(HEADER), payload) < 0) { return NULL; }
 
-          for (int i = 0; i < rx->width; i++) {
-            rx->pixel_samples[i] = (float)((int)spectrum_data.sample[i] - 200);
-          }
-
-          g_mutex_unlock(&rx->display_mutex);
-          g_idle_add(ext_rx_remote_update_display, rx);
-        }
-      }
-
-      if (type == INFO_TX_SPECTRUM && can_transmit) {
-        TRANSMITTER *tx = transmitter;
-        tx->alc = from_double(spectrum_data.alc);
-        tx->fwd = from_double(spectrum_data.fwd);
-        tx->swr = from_double(spectrum_data.swr);
-        int width = from_short(spectrum_data.width);
+      client_media(packet, sizeof(HEADER) + payload);
+    }
+    break;
 
-        if (tx->pixel_samples == NULL) {
-          tx->pixel_samples = g_new(float, (int) tx->width);
-        }
+    case CMD_UDP: {
+      UDP_COMMAND command;
+      memcpy(&command, &header, sizeof(HEADER));
 
-        if (width == tx->width) {
-          for (int i = 0; i < tx->width; i++) {
-            tx->pixel_samples[i] = (float)((int)spectrum_data.sample[i] - 200);
-          }
+      if (recv_bytes(client_socket, (char *)&command + sizeof(HEADER), sizeof(UDP_COMMAND) - sizeof(HEADER)) < 0) { return NULL; }
 
-          g_idle_add(ext_tx_remote_update_display, tx);
-        }
-      }
+      client_udp_open(&command);
     }
     break;
 
-    case INFO_RXAUDIO: {
-      RXAUDIO_DATA adata;
-
-      if (recv_bytes(client_socket, (char *)&adata + sizeof(HEADER), sizeof(RXAUDIO_DATA) - sizeof(HEADER)) < 0) { return NULL; }
+    case INFO_STATE:
+      if (client_state_receive(&header) < 0) {
+        t_print("%s: could not receive the initial sync\n", __FUNCTION__);
+        return NULL;
+      }
 
-      RECEIVER *rx = receiver[adata.rx];
-      int numsamples = from_short(adata.numsamples);
+      break;
 
+    case CMD_PING: {
       //
-      // Note CAPTURing is only done on the server side
+      // Send the ping back, together with our own loss counters
       //
-      for (int i = 0; i < numsamples; i++) {
-        short left_sample = from_short(adata.samples[(i * 2)]);
-        short right_sample = from_short(adata.samples[(i * 2) + 1]);
-
-        if (radio_is_transmitting() && (!duplex || mute_rx_while_transmitting)) {
-          left_sample = 0.0;
-          right_sample = 0.0;
-        }
+      PING_COMMAND ping;
+      long underruns = 0;
+      memcpy(&ping, &header, sizeof(HEADER));
 
-        if (rx->mute_radio || (rx != active_receiver && rx->mute_when_not_active)) {
-          left_sample = 0;
-          right_sample = 0;
-        }
+      if (recv_bytes(client_socket, (char *)&ping + sizeof(HEADER), sizeof(PING_COMMAND) - sizeof(HEADER)) < 0) { return NULL; }
 
-        if (rx->audio_channel == LEFT)  { right_sample = 0; }
+      for (int i = 0; i < 2; i++) {
+        if (rxaudio_jitter_buffer[i] != NULL) { underruns += rxaudio_jitter_buffer[i]->underflows; }
+      }
 
-        if (rx->audio_channel == RIGHT) { left_sample  = 0; }
+      ping.header.b1 = 1;
+      ping.underruns = to_int(underruns);
+      ping.audio_lost = to_int(udp_audio_lost);
+      ping.spectrum_lost = to_int(client_spectrum_lost);
+      send_bytes(client_socket, (char *)&ping, sizeof(PING_COMMAND));
+    }
+    break;
 
-        if (rx->local_audio) {
-          audio_write(rx, (float)left_sample / 32767.0, (float)right_sample / 32767.0);
-        }
-      }
+    case CMD_AUDIO_CODEC: {
+      //
+      // The server reports the RX audio codec it actually uses
+      //
+      t_print("%s: server uses RX audio codec %s, %d kbit/s\n", __FUNCTION__, audio_codec_name(header.b1),
+              from_short(header.s1));
     }
     break;
 
@@ -3755,6 +6488,29 @@ int radio_connect_remote(char *host, int port, const char *pwd) {
     return -5;
   }
 
+  snprintf(client_state_file, sizeof(client_state_file), "remote@%s:%d.state", host, port);
+  send_state_resume(client_socket);
+
+  //
+  // Request the RX audio codec. The server processes this
+  // after it has sent the initial data.
+  //
+  audio_stats_reset();
+  g_mutex_lock(&send_mutex);
+  command_batch_init(&client_batch);
+  client_batching = TRUE;
+  g_mutex_unlock(&send_mutex);
+  send_audio_codec(client_socket, remote_audio_choice, remote_audio_frame);
+  udp_server_address = server_address;
+
+  if (remote_transport > 0) {
+    send_udp(client_socket, UDP_OPEN, remote_transport > 1 ? UDP_FEC_GROUP : 0);
+  }
+
+  if (remote_iq_choice > 0) {
+    send_iq_stream(client_socket, 0, 1, remote_iq_choice == 1 ? 48 : 0);
+    send_iq_stream(client_socket, 1, 1, remote_iq_choice == 1 ? 48 : 0);
+  }
   snprintf(server_host, sizeof(server_host), "%s:%d", host, port);
   client_thread_id = g_thread_new("remote_client", client_thread, &server_host);
   return 0;
@@ -3886,11 +6642,11 @@ static int remote_command(void *data) {
     long long f = from_ll(command->u64);
     vfo_id_set_frequency(v, f);
     vfo_update();
-    send_vfo_data(remoteclient.socket, VFO_A);  // need both in case of SAT/RSAT
-    send_vfo_data(remoteclient.socket, VFO_B);  // need both in case of SAT/RSAT
+    send_vfo_data(REMOTE_BROADCAST, VFO_A);  // need both in case of SAT/RSAT
+    send_vfo_data(REMOTE_BROADCAST, VFO_B);  // need both in case of SAT/RSAT
 
     if (pan != active_receiver->pan) {
-      send_pan(remoteclient.socket, active_receiver);
+      send_pan(REMOTE_BROADCAST, active_receiver);
     }
   }
   break;
@@ -3899,9 +6655,9 @@ static int remote_command(void *data) {
     int id = header->b1;
     int steps = from_short(header->s1);
     vfo_id_step(id, steps);
-    send_rx_data(remoteclient.socket, id);
-    send_vfo_data(remoteclient.socket, VFO_A);  // need both in case of SAT/RSAT
-    send_vfo_data(remoteclient.socket, VFO_B);  // need both in case of SAT/RSAT
+    send_rx_data(REMOTE_BROADCAST, id);
+    send_vfo_data(REMOTE_BROADCAST, VFO_A);  // need both in case of SAT/RSAT
+    send_vfo_data(REMOTE_BROADCAST, VFO_B);  // need both in case of SAT/RSAT
   }
   break;
 
@@ -3910,11 +6666,11 @@ static int remote_command(void *data) {
     int pan = active_receiver->pan;
     long long hz = from_ll(command->u64);
     vfo_move(hz, command->header.b2);
-    send_vfo_data(remoteclient.socket, VFO_A);  // need both in case of SAT/RSAT
-    send_vfo_data(remoteclient.socket, VFO_B);  // need both in case of SAT/RSAT
+    send_vfo_data(REMOTE_BROADCAST, VFO_A);  // need both in case of SAT/RSAT
+    send_vfo_data(REMOTE_BROADCAST, VFO_B);  // need both in case of SAT/RSAT
 
     if (pan != active_receiver->pan) {
-      send_pan(remoteclient.socket, active_receiver);
+      send_pan(REMOTE_BROADCAST, active_receiver);
     }
   }
   break;
@@ -3924,11 +6680,11 @@ static int remote_command(void *data) {
     int pan = active_receiver->pan;
     long long hz = from_ll(command->u64);
     vfo_move_to(hz);
-    send_vfo_data(remoteclient.socket, VFO_A);  // need both in case of SAT/RSAT
-    send_vfo_data(remoteclient.socket, VFO_B);  // need both in case of SAT/RSAT
+    send_vfo_data(REMOTE_BROADCAST, VFO_A);  // need both in case of SAT/RSAT
+    send_vfo_data(REMOTE_BROADCAST, VFO_B);  // need both in case of SAT/RSAT
 
     if (pan != active_receiver->pan) {
-      send_pan(remoteclient.socket, active_receiver);
+      send_pan(REMOTE_BROADCAST, active_receiver);
     }
   }
   break;
@@ -3936,8 +6692,8 @@ static int remote_command(void *data) {
   case CMD_ZOOM: {
     int id = header->b1;
     set_zoom(id, (double)header->b2);
-    send_zoom(remoteclient.socket, active_receiver);
-    send_pan(remoteclient.socket, active_receiver);
+    send_zoom(REMOTE_BROADCAST, active_receiver);
+    send_pan(REMOTE_BROADCAST, active_receiver);
   }
   break;
 
@@ -3967,7 +6723,7 @@ static int remote_command(void *data) {
   case CMD_STORE: {
     int index = header->b1;
     store_memory_slot(index);
-    send_memory_data(remoteclient.socket, index);
+    send_memory_data(REMOTE_BROADCAST, index);
   }
   break;
 
@@ -3975,9 +6731,9 @@ static int remote_command(void *data) {
     int index = header->b1;
     int id = active_receiver->id;
     recall_memory_slot(index);
-    send_vfo_data(remoteclient.socket, id);
-    send_rx_data(remoteclient.socket, id);
-    send_tx_data(remoteclient.socket);
+    send_vfo_data(REMOTE_BROADCAST, id);
+    send_rx_data(REMOTE_BROADCAST, id);
+    send_tx_data(REMOTE_BROADCAST);
   }
   break;
 
@@ -3991,7 +6747,7 @@ static int remote_command(void *data) {
   case CMD_PAN: {
     int id = header->b1;
     set_pan(id, (double)from_short(header->s1));
-    send_pan(remoteclient.socket, receiver[id]);
+    send_pan(REMOTE_BROADCAST, receiver[id]);
   }
   break;
 
@@ -4020,7 +6776,7 @@ static int remote_command(void *data) {
       RECEIVER *rx = receiver[r];
       rx->agc = header->b2;
       rx_set_agc(rx);
-      send_agc(remoteclient.socket, rx->id, rx->agc);
+      send_agc(REMOTE_BROADCAST, rx->id, rx->agc);
       g_idle_add(ext_vfo_update, NULL);
     }
   }
@@ -4031,21 +6787,21 @@ static int remote_command(void *data) {
     memory_tune = from_short(header->s2);
     radio_toggle_tune();
     g_idle_add(ext_vfo_update, NULL);
-    send_tune(remoteclient.socket, tune);
+    send_tune(REMOTE_BROADCAST, tune);
   }
   break;
 
   case CMD_TOGGLE_MOX: {
     radio_toggle_mox();
     g_idle_add(ext_vfo_update, NULL);
-    send_mox(remoteclient.socket, mox);
+    send_mox(REMOTE_BROADCAST, mox);
   }
   break;
 
   case CMD_MOX: {
     radio_set_mox(header->b1);
     g_idle_add(ext_vfo_update, NULL);
-    send_mox(remoteclient.socket, mox);
+    send_mox(REMOTE_BROADCAST, mox);
   }
   break;
 
@@ -4056,7 +6812,7 @@ static int remote_command(void *data) {
     //
     radio_set_mox(header->b1);
     g_idle_add(ext_vfo_update, NULL);
-    send_vox(remoteclient.socket, mox);
+    send_vox(REMOTE_BROADCAST, mox);
   }
   break;
 
@@ -4065,7 +6821,7 @@ static int remote_command(void *data) {
     memory_tune = from_short(header->s2);
     radio_set_tune(header->b1);
     g_idle_add(ext_vfo_update, NULL);
-    send_tune(remoteclient.socket, tune);
+    send_tune(REMOTE_BROADCAST, tune);
   }
   break;
 
@@ -4073,7 +6829,7 @@ static int remote_command(void *data) {
     if (can_transmit) {
       radio_set_twotone(transmitter, header->b1);
       g_idle_add(ext_vfo_update, NULL);
-      send_twotone(remoteclient.socket, transmitter->twotone);
+      send_twotone(REMOTE_BROADCAST, transmitter->twotone);
     }
   }
   break;
@@ -4093,7 +6849,7 @@ static int remote_command(void *data) {
       //
       // Now hang and thresh have been calculated and need be sent back
       //
-      send_agc_gain(remoteclient.socket, rx);
+      send_agc_gain(REMOTE_BROADCAST, rx);
     }
   }
   break;
@@ -4107,7 +6863,7 @@ static int remote_command(void *data) {
   case CMD_ATTENUATION: {
     int att = from_short(header->s1);
     set_attenuation_value((double)att);
-    send_attenuation(remoteclient.socket, active_receiver->id, att);
+    send_attenuation(REMOTE_BROADCAST, active_receiver->id, att);
   }
   break;
 
@@ -4152,7 +6908,7 @@ static int remote_command(void *data) {
       rx->nr4_post_threshold     = from_double(command->nr4_post_threshold);
 #endif
       rx_set_noise(rx);
-      send_rx_data(remoteclient.socket, id);
+      send_rx_data(REMOTE_BROADCAST, id);
     }
   }
   break;
@@ -4178,9 +6934,9 @@ static int remote_command(void *data) {
     // The "old" bandstack may have changed.
     // The mode, and thus all mode settings, may have changed
     //
-    send_bandstack_data(remoteclient.socket, b, old);
-    send_vfo_data(remoteclient.socket, id);
-    send_rx_data(remoteclient.socket, id);
+    send_bandstack_data(REMOTE_BROADCAST, b, old);
+    send_vfo_data(REMOTE_BROADCAST, id);
+    send_rx_data(REMOTE_BROADCAST, id);
     send_tx_data(client_socket);
   }
   break;
@@ -4196,11 +6952,11 @@ static int remote_command(void *data) {
     const BAND *band = band_get_band(oldband);
 
     for (int s = 0; s < band->bandstack->entries; s++) {
-      send_bandstack_data(remoteclient.socket, oldband, s);
+      send_bandstack_data(REMOTE_BROADCAST, oldband, s);
     }
 
-    send_vfo_data(remoteclient.socket, VFO_A);
-    send_vfo_data(remoteclient.socket, VFO_B);
+    send_vfo_data(REMOTE_BROADCAST, VFO_A);
+    send_vfo_data(REMOTE_BROADCAST, VFO_B);
   }
   break;
 
@@ -4213,9 +6969,9 @@ static int remote_command(void *data) {
     // those "stored with the mode" are changed as well. So we need
     // to send back VFO, receiver, and transmitter data
     //
-    send_vfo_data(remoteclient.socket, v);
-    send_rx_data(remoteclient.socket, v);
-    send_tx_data(remoteclient.socket);
+    send_vfo_data(REMOTE_BROADCAST, v);
+    send_rx_data(REMOTE_BROADCAST, v);
+    send_tx_data(REMOTE_BROADCAST);
   }
   break;
 
@@ -4238,12 +6994,12 @@ static int remote_command(void *data) {
     for (int v = 0; v < receivers; v++) {
       if ((vfo[v].mode == m) && (vfo[v].filter == f)) {
         vfo_id_filter_changed(v, f);
-        send_rx_filter_cut(remoteclient.socket, v);
+        send_rx_filter_cut(REMOTE_BROADCAST, v);
       }
     }
 
     if (can_transmit) {
-      send_tx_filter_cut(remoteclient.socket);
+      send_tx_filter_cut(REMOTE_BROADCAST);
     }
   }
   break;
@@ -4261,12 +7017,12 @@ static int remote_command(void *data) {
     // filter edges in receiver(s) may have changed
     //
     for (int id = 0; id < receivers; id++) {
-      send_rx_filter_cut(remoteclient.socket, id);
-      send_agc_gain(remoteclient.socket, receiver[id]);
+      send_rx_filter_cut(REMOTE_BROADCAST, id);
+      send_agc_gain(REMOTE_BROADCAST, receiver[id]);
     }
 
     if (can_transmit) {
-      send_tx_filter_cut(remoteclient.socket);
+      send_tx_filter_cut(REMOTE_BROADCAST);
     }
 
     g_idle_add(ext_vfo_update, NULL);
@@ -4279,12 +7035,12 @@ static int remote_command(void *data) {
 
     if (id < receivers) {
       rx_set_filter(receiver[id]);
-      send_rx_filter_cut(remoteclient.socket, id);
+      send_rx_filter_cut(REMOTE_BROADCAST, id);
     }
 
     if (can_transmit) {
       tx_set_filter(transmitter);
-      send_tx_filter_cut(remoteclient.socket);
+      send_tx_filter_cut(REMOTE_BROADCAST);
     }
 
     g_idle_add(ext_vfo_update, NULL);
@@ -4331,8 +7087,8 @@ static int remote_command(void *data) {
       split = header->b1;
       tx_set_mode(transmitter, vfo_get_tx_mode());
       g_idle_add(ext_vfo_update, NULL);
-      send_tx_data(remoteclient.socket);
-      send_rx_data(remoteclient.socket, 0);
+      send_tx_data(REMOTE_BROADCAST);
+      send_rx_data(REMOTE_BROADCAST, 0);
     }
   }
   break;
@@ -4353,7 +7109,7 @@ static int remote_command(void *data) {
   case CMD_SAT: {
     sat_mode = header->b1;
     g_idle_add(ext_vfo_update, NULL);
-    send_sat(remoteclient.socket, sat_mode);
+    send_sat(REMOTE_BROADCAST, sat_mode);
   }
   break;
 
@@ -4367,7 +7123,7 @@ static int remote_command(void *data) {
   case CMD_LOCK: {
     locked = header->b1;
     g_idle_add(ext_vfo_update, NULL);
-    send_lock(remoteclient.socket, locked);
+    send_lock(REMOTE_BROADCAST, locked);
   }
   break;
 
@@ -4382,7 +7138,7 @@ static int remote_command(void *data) {
     vfo[v].ctun_frequency = vfo[v].frequency;
     rx_set_offset(active_receiver, vfo[v].offset);
     g_idle_add(ext_vfo_update, NULL);
-    send_vfo_data(remoteclient.socket, v);
+    send_vfo_data(REMOTE_BROADCAST, v);
   }
   break;
 
@@ -4415,41 +7171,41 @@ static int remote_command(void *data) {
 
   case CMD_VFO_A_TO_B: {
     vfo_a_to_b();
-    send_vfo_data(remoteclient.socket, VFO_B);
+    send_vfo_data(REMOTE_BROADCAST, VFO_B);
 
     if (receivers > 1) {
-      send_rx_data(remoteclient.socket, 1);
+      send_rx_data(REMOTE_BROADCAST, 1);
     }
 
     if (can_transmit) {
-      send_tx_data(remoteclient.socket);
+      send_tx_data(REMOTE_BROADCAST);
     }
   }
   break;
 
   case CMD_VFO_B_TO_A: {
     vfo_b_to_a();
-    send_vfo_data(remoteclient.socket, VFO_A);
-    send_rx_data(remoteclient.socket, 0);
+    send_vfo_data(REMOTE_BROADCAST, VFO_A);
+    send_rx_data(REMOTE_BROADCAST, 0);
 
     if (can_transmit) {
-      send_tx_data(remoteclient.socket);
+      send_tx_data(REMOTE_BROADCAST);
     }
   }
   break;
 
   case CMD_VFO_SWAP: {
     vfo_a_swap_b();
-    send_vfo_data(remoteclient.socket, VFO_A);
-    send_vfo_data(remoteclient.socket, VFO_B);
-    send_rx_data(remoteclient.socket, 0);
+    send_vfo_data(REMOTE_BROADCAST, VFO_A);
+    send_vfo_data(REMOTE_BROADCAST, VFO_B);
+    send_rx_data(REMOTE_BROADCAST, 0);
 
     if (receivers > 1) {
-      send_rx_data(remoteclient.socket, 1);
+      send_rx_data(REMOTE_BROADCAST, 1);
     }
 
     if (can_transmit) {
-      send_tx_data(remoteclient.socket);
+      send_tx_data(REMOTE_BROADCAST);
     }
   }
   break;
@@ -4458,7 +7214,7 @@ static int remote_command(void *data) {
     int id = header->b1;
     vfo_id_rit_value(id, from_short(header->s1));
     vfo_id_rit_onoff(id, header->b2);
-    send_vfo_data(remoteclient.socket, id);
+    send_vfo_data(REMOTE_BROADCAST, id);
   }
   break;
 
@@ -4466,7 +7222,7 @@ static int remote_command(void *data) {
     int id = header->b1;
     vfo_id_xit_value(id, from_short(header->s1));
     vfo_id_xit_onoff(id, header->b2);
-    send_vfo_data(remoteclient.socket, id);
+    send_vfo_data(REMOTE_BROADCAST, id);
   }
   break;
 
@@ -4483,7 +7239,7 @@ static int remote_command(void *data) {
         radio_change_sample_rate((int)rate);
       }
 
-      send_sample_rate(remoteclient.socket, id, receiver[id]->sample_rate);
+      send_sample_rate(REMOTE_BROADCAST, id, receiver[id]->sample_rate);
     }
   }
   break;
@@ -4491,11 +7247,11 @@ static int remote_command(void *data) {
   case CMD_RECEIVERS: {
     int r = header->b1;
     radio_change_receivers(r);
-    send_receivers(remoteclient.socket, receivers);
+    send_receivers(REMOTE_BROADCAST, receivers);
 
     // In P1, activating RX2 aligns its sample rate with RX1
     if (receivers == 2) {
-      send_rx_data(remoteclient.socket, 1);
+      send_rx_data(REMOTE_BROADCAST, 1);
     }
   }
   break;
@@ -4504,19 +7260,19 @@ static int remote_command(void *data) {
     int v = header->b1;
     int step = from_short(header->s1);
     vfo_id_set_rit_step(v, step);
-    send_vfo_data(remoteclient.socket, v);
+    send_vfo_data(REMOTE_BROADCAST, v);
   }
   break;
 
   case CMD_FILTER_BOARD: {
     filter_board = header->b1;
     load_filters();
-    send_radio_data(remoteclient.socket);
+    send_radio_data(REMOTE_BROADCAST);
 
     if (filter_board == N2ADR) {
       // OC settings for 160m ... 10m have been set
       for (int b = band160; b <= band10; b++) {
-        send_band_data(remoteclient.socket, b);
+        send_band_data(REMOTE_BROADCAST, b);
       }
     }
   }
@@ -4528,7 +7284,7 @@ static int remote_command(void *data) {
     const BAND *band = band_get_band(band60);
 
     for (int s = 0; s < band->bandstack->entries; s++) {
-      send_bandstack_data(remoteclient.socket, band60, s);
+      send_bandstack_data(REMOTE_BROADCAST, band60, s);
     }
   }
   break;
@@ -4540,7 +7296,7 @@ static int remote_command(void *data) {
 
   case CMD_ANAN10E: {
     radio_set_anan10E(header->b1);
-    send_radio_data(remoteclient.socket);
+    send_radio_data(REMOTE_BROADCAST);
   }
   break;
 
@@ -4685,7 +7441,7 @@ static int remote_command(void *data) {
       transmitter->ctcss_enabled = header->b1;
       transmitter->ctcss = header->b2;
       tx_set_ctcss(transmitter);
-      send_tx_data(remoteclient.socket);
+      send_tx_data(REMOTE_BROADCAST);
       g_idle_add(ext_vfo_update, NULL);
     }
   }
@@ -4696,7 +7452,7 @@ static int remote_command(void *data) {
       const DOUBLE_COMMAND *command = (DOUBLE_COMMAND *)data;
       transmitter->am_carrier_level = from_double(command->dbl);
       tx_set_am_carrier_level(transmitter);
-      send_tx_data(remoteclient.socket);
+      send_tx_data(REMOTE_BROADCAST);
     }
   }
   break;
@@ -4723,7 +7479,7 @@ static int remote_command(void *data) {
       mic_linein = command->mic_linein;
       linein_gain = from_double(command->linein_gain);
       schedule_transmit_specific();
-      send_tx_data(remoteclient.socket);
+      send_tx_data(REMOTE_BROADCAST);
     }
   }
   break;
@@ -4862,7 +7618,7 @@ static int remote_command(void *data) {
       rx->filter_high = from_short(header->s2);
       rx_set_bandpass(rx);
       rx_set_agc(rx);
-      send_agc_gain(remoteclient.socket, rx);
+      send_agc_gain(REMOTE_BROADCAST, rx);
       g_idle_add(ext_vfo_update, NULL);
     }
   }
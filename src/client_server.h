@@ -24,6 +24,13 @@
 #include <stdint.h>
 #include <netinet/in.h>
 
+#include "audio_codec.h"
+#include "iq_codec.h"
+#include "link_stats.h"
+#include "send_queue.h"
+#include "spectrum_codec.h"
+#include "state_cache.h"
+#include "udp_channel.h"
 #include "mode.h"
 #include "receiver.h"
 #include "transmitter.h"
@@ -37,8 +44,10 @@ enum _header_type_enum {
   CMD_AMCARRIER,
   CMD_ANAN10E,
   CMD_ATTENUATION,
+  CMD_AUDIO_CODEC,
   CMD_BAND_SEL,
   CMD_BANDSTACK,
+  CMD_BATCH,
   CMD_BINAURAL,
   CMD_CAPTURE,
   CMD_COMPRESSOR,
@@ -57,6 +66,7 @@ enum _header_type_enum {
   CMD_FILTER_VAR,
   CMD_FREQ,
   CMD_HEARTBEAT,
+  CMD_IQ_STREAM,
   CMD_LOCK,
   CMD_METER,
   CMD_MICGAIN,
@@ -68,6 +78,7 @@ enum _header_type_enum {
   CMD_NOISE,
   CMD_PAN,
   CMD_PATRIM,
+  CMD_PING,
   CMD_PREEMP,
   CMD_PSATT,
   CMD_PSONOFF,
@@ -96,9 +107,11 @@ enum _header_type_enum {
   CMD_SOAPY_AGC,
   CMD_SOAPY_RXANT,
   CMD_SOAPY_TXANT,
+  CMD_SPECTRUM_FORMAT,
   CMD_SPLIT,
   CMD_SQUELCH,
   CMD_START_RADIO,
+  CMD_STATE_RESUME,
   CMD_STEP,
   CMD_STORE,
   CMD_TOGGLE_MOX,
@@ -113,6 +126,7 @@ enum _header_type_enum {
   CMD_TX_FILTER_CUT,
   CMD_TX_FPS,
   CMD_TX_SPECTRUM,
+  CMD_UDP,
   CMD_VFO_A_TO_B,
   CMD_VFO_B_TO_A,
   CMD_VFO_STEPSIZE,
@@ -127,12 +141,16 @@ enum _header_type_enum {
   INFO_BANDSTACK,
   INFO_DAC,
   INFO_DISPLAY,
+  INFO_IQ,
   INFO_MEMORY,
   INFO_PS,
   INFO_RADIO,
   INFO_RECEIVER,
   INFO_RXAUDIO,
+  INFO_RXAUDIO_CODED,
   INFO_RX_SPECTRUM,
+  INFO_SPECTRUM_CODED,
+  INFO_STATE,
   INFO_TX_SPECTRUM,
   INFO_TRANSMITTER,
   INFO_TXAUDIO,
@@ -140,19 +158,72 @@ enum _header_type_enum {
   CLIENT_SERVER_COMMANDS,
 };
 
-#define CLIENT_SERVER_VERSION 0x01000011 // 32-bit version number
+#define CLIENT_SERVER_VERSION 0x01000019 // 32-bit version number
 #define SPECTRUM_DATA_SIZE 4096          // Maximum width of a panadapter
 #define AUDIO_DATA_SIZE 1024             // 1024 stereo samples
+#define IQ_DATA_SIZE 512                 // IQ samples per INFO_IQ packet
+
+//
+// Spectrum format requested by the client for one panadapter.
+// Until the client has sent a request, uncompressed full-width
+// frames are sent at the frame rate of the server.
+//
+typedef struct _spectrum_format {
+  int active;               // client has requested this format
+  int width;                // 0: full width
+  int fps;                  // 0: each frame
+  int low;                  // dB range
+  int high;
+  int deadband;             // see spectrum_codec.h
+} SPECTRUM_FORMAT;
+
+#define SPECTRUM_TX 8       // index of the TX panadapter in spectrum_format[]
+
+//
+// The server accepts up to MAX_REMOTE_CLIENTS clients. The first one
+// controls the radio, the others can only listen and watch (their
+// commands are ignored) until they become the controlling client.
+// Each client has its own send queue, which is emptied by the I/O
+// thread, so a slow client does not slow down the others nor the radio.
+// If the client has opened the UDP side channel, audio and spectrum
+// packets bypass the queue and go out as datagrams.
+//
+#define MAX_REMOTE_CLIENTS 4
+#define REMOTE_BROADCAST  -2      // "socket" for sending to all clients
+#define REMOTE_CAPTURE    -3      // "socket" for collecting the initial sync
 
 typedef struct _remote_client {
-  int running;
-  int authorised;
+  int in_use;               // slot is taken (possibly still in the handshake)
+  int running;              // authorised and receiving data
+  int controlling;          // this client controls the radio
   int socket;
   socklen_t address_length;
   struct sockaddr_in address;
-  guint timer_id;
+  SEND_QUEUE queue;
+  int registered;           // handled by the I/O thread
+  int writing;              // I/O thread waits until the socket is writable
+  uint8_t *input;           // received bytes not yet parsed
+  int input_length;
+  int input_resync;         // searching for the sync bytes
+  gint64 last_input;        // time when data was last received
   int send_rx_spectrum[8];
   int send_tx_spectrum;
+  int audio_codec;          // RX audio codec requested by the client
+  int audio_bitrate;        // in kbit/s (only used for Opus)
+  int audio_frame;          // samples per RX audio packet (0: not requested)
+  int audio_stream[2];      // RX audio streams the client is subscribed to
+  SPECTRUM_FORMAT spectrum_format[SPECTRUM_TX + 1];
+  int spectrum_stream[SPECTRUM_TX + 1];
+  int spectrum_resync[SPECTRUM_TX + 1];  // frames have been dropped, wait for a key frame
+  int spectrum_dropped;     // last seen value of queue.spectrum_dropped
+  int udp_active;           // client has sent its UDP hello
+  uint32_t udp_token;       // expected in the UDP hello and all datagrams
+  struct sockaddr_in udp_address;
+  UDP_SENDER *udp_sender;   // one per UDP channel (NULL: no UDP requested)
+  int udp_dropped;          // datagrams the socket did not take
+  int iq_rate[2];           // IQ requested (0: no, -1: full rate, else in Hz)
+  int iq_stream[2];         // IQ streams the client is subscribed to
+  LINK_STATS link;          // protected by client_mutex
 } REMOTE_CLIENT;
 
 typedef struct __attribute__((__packed__)) _header {
@@ -651,6 +722,131 @@ typedef struct __attribute__((__packed__)) _spectrum_data {
   uint8_t sample[SPECTRUM_DATA_SIZE];
 } SPECTRUM_DATA;
 
+//
+// Compressed panadapter data (RX or TX, id = 0,1 or SPECTRUM_TX) in the
+// format requested with CMD_SPECTRUM_FORMAT. The data section begins with the
+// VFO frequencies if SPECTRUM_FLAG_VFO is set (this is only the case if
+// they have changed), followed by the coded frame of "width" pixels. Pixel
+// values are in dB above "low". The packet has a variable length, the
+// payload length is in header.s1.
+//
+#define SPECTRUM_FLAG_VFO 0x80
+
+typedef struct __attribute__((__packed__)) _spectrum_vfo {
+  uint64_t vfo_a_freq;
+  uint64_t vfo_b_freq;
+  uint64_t vfo_a_ctun_freq;
+  uint64_t vfo_b_ctun_freq;
+  uint64_t vfo_a_offset;
+  uint64_t vfo_b_offset;
+} SPECTRUM_VFO;
+
+typedef struct __attribute__((__packed__)) _coded_spectrum_data {
+  HEADER header;
+  uint8_t id;
+  uint8_t zoom;
+  uint8_t flags;
+  uint16_t width;
+  uint16_t pan;
+  uint16_t low;
+  //
+  mydouble meter;
+  mydouble alc;
+  mydouble fwd;
+  mydouble swr;
+  //
+  uint8_t data[sizeof(SPECTRUM_VFO) + SPECTRUM_DATA_SIZE];
+} CODED_SPECTRUM_DATA;
+
+typedef struct __attribute__((__packed__)) _spectrum_format_command {
+  HEADER header;
+  uint8_t id;
+  uint8_t fps;
+  uint8_t deadband;
+  uint16_t width;
+  uint16_t low;
+  uint16_t high;
+} SPECTRUM_FORMAT_COMMAND;
+
+//
+// CMD_BATCH: several complete commands (each with its own header) in one
+// packet. b1 is the number of commands, s1 the length of the payload
+// (at most COMMAND_BATCH_SIZE bytes). The client collects settings
+// (volume, gains, filter edges, VFO steps, ...) for CLIENT_BATCH_TICK
+// msec and sends them this way, see command_batch.h.
+//
+#define CLIENT_BATCH_TICK 50
+
+//
+// CMD_UDP: the client requests the UDP side channel (b2 = UDP_OPEN,
+// b1 = FEC group size for audio) and the server replies with the same
+// command, its UDP port in s1 and the token the client has to put into
+// its datagrams. UDP_KEYFRAME asks for a spectrum key frame after a lost
+// datagram.
+//
+enum _udp_command_enum {
+  UDP_OPEN = 0,
+  UDP_KEYFRAME
+};
+
+typedef struct __attribute__((__packed__)) _udp_command {
+  HEADER header;
+  uint32_t token;
+} UDP_COMMAND;
+
+//
+// CMD_IQ_STREAM: the client requests IQ data of receiver b1 (b2 = 1) or
+// goes back to receiving audio (b2 = 0). s1 is the lowest acceptable
+// sample rate in kHz (0: full sample rate of the receiver). The server
+// decimates by a power of two and sends INFO_IQ packets instead of the
+// RX audio of this receiver, so the client can demodulate on its own.
+//
+// INFO_IQ: IQ_DATA_SIZE samples of receiver b1 in block floating point
+// (see iq_codec.h). Over UDP, this goes to channel UDP_CHANNEL_IQ + b1.
+//
+typedef struct __attribute__((__packed__)) _iq_data {
+  HEADER header;
+  uint32_t sample_rate;
+  uint8_t exponent;         // two's complement
+  uint16_t samples[2 * IQ_DATA_SIZE];
+} IQ_DATA;
+
+//
+// CMD_PING: sent by the server every LINK_STATS_INTERVAL seconds with its
+// time stamp (usec). The client returns it unchanged with b1 = 1, and adds
+// its counters of RX audio underruns and of lost audio and spectrum packets.
+//
+typedef struct __attribute__((__packed__)) _ping_command {
+  HEADER header;
+  uint64_t timestamp;
+  uint32_t underruns;
+  uint32_t audio_lost;
+  uint32_t spectrum_lost;
+} PING_COMMAND;
+
+//
+// Initial sync (see state_cache.h). Right after the password has been
+// accepted, the client sends CMD_STATE_RESUME with the hashes of the
+// sections it has cached for this server (b1: bit mask of the valid ones).
+// The server answers with a single INFO_STATE packet which contains all
+// sections whose hash differs, in section order, followed by
+// CMD_START_RADIO. b1 is the bit mask of the sections included, b2 is 1
+// if the payload is zlib-compressed. The hashes of all sections are sent
+// such that the client can check its cache.
+//
+typedef struct __attribute__((__packed__)) _state_resume {
+  HEADER header;
+  uint64_t hash[STATE_SECTIONS];
+} STATE_RESUME;
+
+typedef struct __attribute__((__packed__)) _state_data {
+  HEADER header;
+  uint32_t length;                       // payload bytes following this struct
+  uint32_t raw_length;                   // payload bytes after decompression
+  uint32_t section_length[STATE_SECTIONS];
+  uint64_t hash[STATE_SECTIONS];
+} STATE_DATA;
+
 //
 // The difference between RX and TX audio is that the latter is mono
 // (this saves Client==>Server bandwidth)
@@ -669,6 +865,20 @@ typedef struct __attribute__((__packed__)) _rxaudio_data {
   uint16_t samples[AUDIO_DATA_SIZE * 2];
 } RXAUDIO_DATA;
 
+//
+// Compressed RX audio. This has a variable length, the length of
+// the payload is in header.s1 and the codec in header.b1.
+// The time stamp (server time in msec) is used by the client to
+// measure the variation of the transport delay.
+//
+typedef struct __attribute__((__packed__)) _coded_rxaudio_data {
+  HEADER header;
+  uint8_t rx;
+  uint16_t numsamples;
+  uint32_t timestamp;
+  uint8_t data[AUDIO_CODEC_MAX_BYTES];
+} CODED_RXAUDIO_DATA;
+
 
 //
 // There are many more such parameters, but they currently
@@ -800,7 +1010,14 @@ extern int start_spectrum(void *data);
 extern void start_vfo_timer(void);
 extern gboolean remote_started;
 
-extern REMOTE_CLIENT remoteclient;
+extern REMOTE_CLIENT remoteclients[MAX_REMOTE_CLIENTS];
+extern int remote_clients;
+extern void remote_client_address(char *text, size_t len);
+extern int remote_audio_choice;
+extern int remote_audio_frame;
+extern int remote_spectrum_choice;
+extern int remote_transport;
+extern int remote_iq_choice;
 
 extern int listen_port;
 
@@ -809,10 +1026,14 @@ extern int destroy_hpsdr_server(void);
 
 extern int radio_connect_remote(char *host, int port, const char *pwd);
 extern void remote_rxaudio(const RECEIVER *rx, short left_sample, short right_sample);
+extern void remote_rxiq(const RECEIVER *rx, const double *iq, int n);
 extern void server_tx_audio(short sample);
 extern short remote_get_mic_sample();
 extern void  remote_send_rxspectrum(int id);
 extern void  remote_send_txspectrum(void);
+extern void  remote_audio_stats(char *text, size_t len);
+extern void  remote_link_stats(char *text, size_t len);
+extern int   remote_link_log;
 
 extern void send_adc(int s, int id, int adc);
 extern void send_adc_data(int sock, int i);
@@ -822,6 +1043,7 @@ extern void send_agc_gain(int s, const RECEIVER *rx);
 extern void send_am_carrier(int s);
 extern void send_anan10E(int s, int new);
 extern void send_attenuation(int s, int rx, int attenuation);
+extern void send_audio_codec(int s, int choice, int frame);
 extern void send_band(int s, int rx, int band);
 extern void send_band_data(int s, int band);
 extern void send_bandstack(int s, int old, int new);
@@ -848,6 +1070,7 @@ extern void send_filter_var(int s, int mode, int filter);
 extern void send_rxfps(int s, int rx, int fps);
 extern void send_txfps(int s, int fps);
 extern void send_heartbeat(int s);
+extern void send_iq_stream(int s, int id, int state, int rate);
 extern void send_lock(int s, int lock);
 extern void send_memory_data(int sock, int index);
 extern void send_meter(int s, int metermode, int alcmode);
@@ -887,12 +1110,14 @@ extern void send_split(int s, int state);
 extern void send_squelch(int s, int rx, int enable, double squelch);
 extern void send_startstop_rxspectrum(int s, int id, int state);
 extern void send_startstop_txspectrum(int s, int state);
+extern void send_spectrum_format(int s, int id, int width, int fps, int low, int high, int deadband);
 extern void send_store(int s, int index);
 extern void send_swap_iq(int s, int swap_iq);
 extern void send_toggle_mox(int s);
 extern void send_toggle_tune(int s);
 extern void send_tune(int s, int state);
 extern void send_twotone(int s, int state);
+extern void send_udp(int s, int command, int arg);
 extern void send_tx_compressor(int s);
 extern void send_tx_fft(int s, const TRANSMITTER *tx);
 extern void send_txfilter(int s);
@@ -0,0 +1,71 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "command_batch.h"
+
+void command_batch_init(COMMAND_BATCH *b) {
+  b->length = 0;
+  b->count = 0;
+  b->commands = 0;
+  b->sent = 0;
+}
+
+void command_batch_clear(COMMAND_BATCH *b) {
+  b->sent += b->count;
+  b->length = 0;
+  b->count = 0;
+}
+
+int command_batch_add(COMMAND_BATCH *b, uint32_t key, uint32_t group, const void *command, int len,
+                      COMMAND_MERGE merge) {
+  //
+  // A batch is small, so a linear search is good enough. Search backwards,
+  // and stop at a different command of the same group.
+  //
+  for (int i = b->count - 1; i >= 0; i--) {
+    if (b->key[i] != key || b->size[i] != len) {
+      if (b->group[i] == group) { break; }
+
+      continue;
+    }
+
+    if (merge != NULL) {
+      merge(b->data + b->offset[i], command, len);
+    } else {
+      memcpy(b->data + b->offset[i], command, len);
+    }
+
+    b->commands++;
+    return TRUE;
+  }
+
+  if (b->count >= COMMAND_BATCH_MAX || b->length + len > COMMAND_BATCH_SIZE) { return FALSE; }
+
+  b->key[b->count] = key;
+  b->group[b->count] = group;
+  b->offset[b->count] = b->length;
+  b->size[b->count] = len;
+  memcpy(b->data + b->length, command, len);
+  b->length += len;
+  b->count++;
+  b->commands++;
+  return TRUE;
+}
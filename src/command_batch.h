@@ -0,0 +1,65 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _COMMAND_BATCH_H_
+#define _COMMAND_BATCH_H_
+
+#include <stdint.h>
+
+//
+// Coalescing of outgoing commands. Commands that set a value are
+// collected for a short time and then sent together. Each command
+// has a key (e.g. command type and receiver), and a command replaces
+// a pending one with the same key ("last value wins"), unless a merge
+// function is given, which then combines the two (e.g. adds up VFO steps).
+// The order of the commands is the order of their first occurrence.
+// Commands that depend on each other (e.g. all that change the frequency
+// of one VFO) are put into the same group: a command is never merged
+// across a later command of its group.
+//
+#define COMMAND_BATCH_SIZE 4096     // max. bytes per batch
+#define COMMAND_BATCH_MAX  64       // max. commands per batch
+
+typedef void (*COMMAND_MERGE)(uint8_t *pending, const uint8_t *command, int len);
+
+typedef struct _command_batch {
+  uint8_t data[COMMAND_BATCH_SIZE];
+  int length;                       // bytes in data
+  int count;                        // commands in data
+  uint32_t key[COMMAND_BATCH_MAX];
+  uint32_t group[COMMAND_BATCH_MAX];
+  int offset[COMMAND_BATCH_MAX];
+  int size[COMMAND_BATCH_MAX];
+  //
+  // statistics
+  //
+  long long commands;               // commands added
+  long long sent;                   // commands actually sent
+} COMMAND_BATCH;
+
+extern void command_batch_init(COMMAND_BATCH *b);
+extern void command_batch_clear(COMMAND_BATCH *b);
+
+//
+// command_batch_add() returns FALSE if there is no room, then the
+// caller has to send the batch and try again.
+//
+extern int command_batch_add(COMMAND_BATCH *b, uint32_t key, uint32_t group, const void *command, int len,
+                             COMMAND_MERGE merge);
+
+#endif
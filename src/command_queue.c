@@ -0,0 +1,108 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+
+#include <gtk/gtk.h>
+
+#include "command_queue.h"
+
+//
+// The glib atomic operations imply a full memory barrier, so a slot
+// is written before the tail index is advanced, and read before the
+// head index is advanced.
+//
+void command_queue_init(COMMAND_QUEUE *q, int size, int batch, GSourceFunc handler) {
+  int n = 1;
+
+  while (n < size) { n <<= 1; }
+
+  q->slots = g_new0(gpointer, n);
+  q->size = n;
+  q->head = 0;
+  q->tail = 0;
+  q->scheduled = 0;
+  q->batch = batch;
+  q->handler = handler;
+  q->flush = NULL;
+  q->flush_data = NULL;
+}
+
+void command_queue_set_flush(COMMAND_QUEUE *q, GSourceFunc flush, gpointer data) {
+  q->flush = flush;
+  q->flush_data = data;
+}
+
+int command_queue_length(COMMAND_QUEUE *q) {
+  return g_atomic_int_get(&q->tail) - g_atomic_int_get(&q->head);
+}
+
+static gboolean command_queue_drain(gpointer data) {
+  COMMAND_QUEUE *q = (COMMAND_QUEUE *)data;
+  int head = g_atomic_int_get(&q->head);
+  int tail = g_atomic_int_get(&q->tail);
+  int n = 0;
+
+  while (n < q->batch && head + n != tail) {
+    q->handler(q->slots[(head + n) & (q->size - 1)]);
+    n++;
+  }
+
+  if (q->flush != NULL) { q->flush(q->flush_data); }
+
+  head += n;
+  g_atomic_int_set(&q->head, head);
+
+  if (head != g_atomic_int_get(&q->tail)) { return G_SOURCE_CONTINUE; }
+
+  //
+  // Before giving up, check again: the producer may have added a
+  // command while "scheduled" was still set.
+  //
+  g_atomic_int_set(&q->scheduled, 0);
+
+  if (head != g_atomic_int_get(&q->tail) && g_atomic_int_compare_and_exchange(&q->scheduled, 0, 1)) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+int command_queue_push(COMMAND_QUEUE *q, gpointer command) {
+  int tail = g_atomic_int_get(&q->tail);
+
+  if (tail - g_atomic_int_get(&q->head) >= q->size) { return FALSE; }
+
+  q->slots[tail & (q->size - 1)] = command;
+  g_atomic_int_set(&q->tail, tail + 1);
+
+  if (q->handler != NULL && g_atomic_int_compare_and_exchange(&q->scheduled, 0, 1)) {
+    g_idle_add(command_queue_drain, q);
+  }
+
+  return TRUE;
+}
+
+gpointer command_queue_pop(COMMAND_QUEUE *q) {
+  int head = g_atomic_int_get(&q->head);
+
+  if (head == g_atomic_int_get(&q->tail)) { return NULL; }
+
+  gpointer command = q->slots[head & (q->size - 1)];
+  g_atomic_int_set(&q->head, head + 1);
+  return command;
+}
@@ -0,0 +1,66 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+
+#ifndef _COMMAND_QUEUE_H_
+#define _COMMAND_QUEUE_H_
+
+#include <gtk/gtk.h>
+
+//
+// Bounded lock-free queue of pointers with a single producer thread
+// and a single consumer thread.
+//
+// If there is a handler, the consumer is the GTK main loop: the queue is
+// drained in batches by an idle callback, which is scheduled by the
+// producer only when needed. The commands of a batch are removed from
+// the queue only after the handler has been called for all of them and
+// then the flush function (if any) for the batch as a whole. So the
+// producer sees an empty queue only when everything has been processed.
+//
+// Without a handler, the consumer is some other thread that fetches the
+// commands with command_queue_pop().
+//
+typedef struct _command_queue {
+  gpointer *slots;
+  int size;                      // a power of two
+  volatile gint head;            // written by the consumer only
+  volatile gint tail;            // written by the producer only
+  volatile gint scheduled;       // idle callback is pending
+  int batch;                     // max. commands per idle callback
+  GSourceFunc handler;           // called (in the GTK thread) for each command
+  GSourceFunc flush;             // called (in the GTK thread) after each batch
+  gpointer flush_data;
+} COMMAND_QUEUE;
+
+extern void command_queue_init(COMMAND_QUEUE *q, int size, int batch, GSourceFunc handler);
+extern void command_queue_set_flush(COMMAND_QUEUE *q, GSourceFunc flush, gpointer data);
+
+//
+// command_queue_push() returns FALSE (and the command remains with the
+// caller) if the queue is full.
+//
+extern int command_queue_push(COMMAND_QUEUE *q, gpointer command);
+extern int command_queue_length(COMMAND_QUEUE *q);
+
+//
+// Only for queues without a handler: returns NULL if the queue is empty.
+//
+extern gpointer command_queue_pop(COMMAND_QUEUE *q);
+
+#endif
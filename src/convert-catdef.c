@@ -199,12 +199,20 @@ int main(int argc, char **argv) {
       strcpy(catdescr, pos);
     }
 
+    //
+    // Some commands have more than one form, these
+    // come as multiple SET or READ lines
+    //
     if (strstr(line, "//SET")  != NULL) {
-      strcpy(catset, pos);
+      if (*catset) { strcat(catset, " or "); }
+
+      strcat(catset, pos);
     }
 
     if (strstr(line, "//READ")  != NULL) {
-      strcpy(catread, pos);
+      if (*catread) { strcat(catread, " or "); }
+
+      strcat(catread, pos);
     }
 
     if (strstr(line, "//RESP")  != NULL) {
@@ -0,0 +1,102 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <time.h>
+
+#include "cw_timeline.h"
+
+#define NSEC_PER_SEC 1000000000L
+
+static CW_QUEUE_FUNC cw_queue;
+static struct timespec cw_t0;       // time of sample zero of the timeline
+static long cw_time;                // timeline position up to which elements are queued
+static long cw_last;                // timeline position of the last event queued
+static long cw_max_late;            // statistics: max. wakeup latency (samples)
+static int cw_underruns;            // statistics: number of underruns
+
+static long cw_elapsed(const struct timespec *ts) {
+  return (ts->tv_sec - cw_t0.tv_sec) * 48000L + (long)(((long long)(ts->tv_nsec - cw_t0.tv_nsec) * 3LL) / 62500LL);
+}
+
+//
+// Sleep until the timeline has reached position "when"
+//
+static void cw_timeline_wait(long when) {
+  struct timespec ts;
+  ts.tv_sec = cw_t0.tv_sec + when / 48000L;
+  ts.tv_nsec = cw_t0.tv_nsec + (long)(((long long)(when % 48000L) * 62500LL) / 3LL);
+
+  while (ts.tv_nsec >= NSEC_PER_SEC) {
+    ts.tv_nsec -= NSEC_PER_SEC;
+    ts.tv_sec++;
+  }
+
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+void cw_timeline_start(CW_QUEUE_FUNC queue) {
+  cw_queue = queue;
+  clock_gettime(CLOCK_MONOTONIC, &cw_t0);
+  cw_time = 0;
+  cw_last = 0;
+  cw_max_late = 0;
+  cw_underruns = 0;
+}
+
+void cw_timeline_element(int down, int up) {
+  struct timespec now;
+  long deadline = cw_time - CW_LEAD;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  if (cw_elapsed(&now) < deadline) {
+    cw_timeline_wait(deadline);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long late = cw_elapsed(&now) - deadline;
+
+    if (late > cw_max_late) { cw_max_late = late; }
+
+    if (late > CW_LEAD) { cw_underruns++; }
+  }
+
+  if (cw_elapsed(&now) > cw_time) {
+    //
+    // The transmitter has run out of events (because of a late wakeup,
+    // or because there was nothing to send): re-anchor the timeline
+    //
+    cw_t0 = now;
+    cw_last -= cw_time;
+    cw_time = 0;
+  }
+
+  if (down > 0) {
+    cw_queue(1, cw_time - cw_last);
+    cw_queue(0, down);
+    cw_last = cw_time + down;
+  }
+
+  cw_time += down + up;
+}
+
+void cw_timeline_drain() {
+  cw_timeline_wait(cw_time);
+}
+
+void cw_timeline_stats(long *max_late, int *underruns) {
+  *max_late = cw_max_late;
+  *underruns = cw_underruns;
+}
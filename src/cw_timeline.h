@@ -0,0 +1,65 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _CW_TIMELINE_H_
+#define _CW_TIMELINE_H_
+
+//
+// CAT CW is keyed along a timeline counted in samples (48 kHz).
+// The elements are put into the CW ring buffer of the transmitter
+// as events with the distance (in samples) to the previous event,
+// and the TX engine executes them exactly at that sample (see
+// tx_add_mic_sample()). So the CW thread need not sleep for the
+// exact duration of an element, it only has to queue the events
+// in time. It runs CW_LEAD samples ahead of the transmitter, such
+// that wakeups which come late by less than that do not affect the
+// CW timing at all.
+// If a wakeup is even later ("underrun"), the next element starts
+// late but still has the correct length, and the timeline is
+// re-anchored to the current time.
+//
+// The events go to the function given to cw_timeline_start(), which
+// is tx_queue_cw_event() in piHPSDR and a recorder in cwbench.
+// This file does not depend on anything else in piHPSDR, so cwbench
+// can measure the timing of exactly this code.
+//
+#define CW_LEAD 2400                // samples (50 msec)
+
+typedef void (*CW_QUEUE_FUNC)(int down, int wait);
+
+extern void cw_timeline_start(CW_QUEUE_FUNC queue);
+
+//
+// cw_timeline_element(down, up) sends a "key-down" of "down" samples
+// followed by a "key-up" of "up" samples. If down is zero, it only
+// produces a pause.
+//
+extern void cw_timeline_element(int down, int up);
+
+//
+// Wait until all queued elements have been sent
+//
+extern void cw_timeline_drain(void);
+
+//
+// Statistics since cw_timeline_start(): the maximum wakeup latency
+// (samples) and the number of underruns
+//
+extern void cw_timeline_stats(long *max_late, int *underruns);
+
+#endif
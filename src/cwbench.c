@@ -0,0 +1,343 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+/*
+ * CAT CW timing benchmark.
+ *
+ * This program keys a text through the CAT CW timeline (cw_timeline.c,
+ * the very code piHPSDR uses for KY and TCI cw_macros) in the same way
+ * as rigctl.c does, but the events go to a recorder instead of the CW
+ * ring buffer of the transmitter. The recorder notes the time each event
+ * arrives, and after the run the TX engine is replayed: an event is
+ * executed when its wait (counted in samples since the previous event)
+ * has passed, but not before it has arrived. The key edges obtained this
+ * way are compared with the ideal ones, and the deviation of the element
+ * and space lengths is reported.
+ *
+ * Late wakeups of the CW thread are what spoils CW timing, so they can be
+ * provoked: with -jitter, a random delay (reproducible, see -seed) is
+ * inserted before each element is queued, and with -load, CPU hogs compete
+ * with the CW thread. With -legacy, the keying that was used before the
+ * timeline (queue an element, then sleep for its duration) is measured
+ * under the same conditions.
+ *
+ * Options:
+ *
+ * -wpm    <n>  speed in words per minute (default: 30)
+ * -text   <s>  text to send (default: "PARIS PARIS PARIS PARIS PARIS")
+ * -jitter <n>  max. random delay (usec) before each element (default: 0)
+ * -seed   <n>  seed for the random delays (default: 1)
+ * -load   <n>  number of CPU hog threads (default: 0)
+ * -legacy      measure the keying used before the timeline
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cw_timeline.h"
+
+#define MAX_EVENTS 65536
+
+typedef struct _cw_event {
+  int down;
+  int wait;                    // samples since the previous event
+  long arrival;                // sample at which the event was queued
+} CW_EVENT;
+
+typedef struct _cw_edge {
+  int down;
+  long time;                   // sample
+} CW_EDGE;
+
+static CW_EVENT events[MAX_EVENTS];
+static int nevents = 0;
+static CW_EDGE ideal[MAX_EVENTS];
+static int nideal = 0;
+static long ideal_time = 0;
+
+static struct timespec bench_t0;
+static unsigned int rnd = 1;
+static int jitter = 0;
+static int legacy = 0;
+static volatile int running = 1;
+
+static const char *morse[36] = {
+  ".-", "-...", "-.-.", "-..", ".", "..-.", "--.", "....", "..", ".---", "-.-", ".-..", "--",
+  "-.", "---", ".--.", "--.-", ".-.", "...", "-", "..-", "...-", ".--", "-..-", "-.--", "--..",
+  "-----", ".----", "..---", "...--", "....-", ".....", "-....", "--...", "---..", "----."
+};
+
+static long now_samples() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec - bench_t0.tv_sec) * 48000L + (long)(((long long)(ts.tv_nsec - bench_t0.tv_nsec) * 3LL) / 62500LL);
+}
+
+static void t_print(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  fprintf(stderr, "%10.3f ", now_samples() / 48000.0);
+  vfprintf(stderr, format, args);
+  va_end(args);
+}
+
+//
+// Stands in for tx_queue_cw_event()
+//
+static void record_event(int down, int wait) {
+  if (nevents >= MAX_EVENTS) { return; }
+
+  events[nevents].down = down;
+  events[nevents].wait = wait;
+  events[nevents].arrival = now_samples();
+  nevents++;
+}
+
+//
+// The keying used before the timeline: queue the element,
+// then sleep for its duration
+//
+static void legacy_element(int down, int up) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  if (down > 0) {
+    record_event(1, 0);
+    record_event(0, down);
+    record_event(0, up);
+  } else {
+    record_event(0, up);
+  }
+
+  ts.tv_nsec += (down + up) * 20833;
+
+  while (ts.tv_nsec >= 1000000000L) {
+    ts.tv_nsec -= 1000000000L;
+    ts.tv_sec++;
+  }
+
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static void element(int down, int up) {
+  if (down > 0 && nideal < MAX_EVENTS - 1) {
+    ideal[nideal].down = 1;
+    ideal[nideal++].time = ideal_time;
+    ideal[nideal].down = 0;
+    ideal[nideal++].time = ideal_time + down;
+  }
+
+  ideal_time += down + up;
+
+  if (jitter > 0) {
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 17;
+    rnd ^= rnd << 5;
+    usleep(rnd % (jitter + 1));
+  }
+
+  if (legacy) {
+    legacy_element(down, up);
+  } else {
+    cw_timeline_element(down, up);
+  }
+}
+
+//
+// Same elements and spaces as rigctl_send_cw_char()
+//
+static void send_text(const char *text, int dot, int dash) {
+  for (const char *p = text; *p != 0; p++) {
+    const char *pattern = NULL;
+
+    if (*p >= 'A' && *p <= 'Z') { pattern = morse[*p - 'A']; }
+
+    if (*p >= 'a' && *p <= 'z') { pattern = morse[*p - 'a']; }
+
+    if (*p >= '0' && *p <= '9') { pattern = morse[26 + *p - '0']; }
+
+    if (*p == ' ') {
+      element(0, 6 * dot);
+    } else if (pattern != NULL) {
+      for (; *pattern != 0; pattern++) {
+        element(*pattern == '-' ? dash : dot, dot);
+      }
+
+      element(0, 2 * dot);
+    }
+  }
+}
+
+//
+// Replay the TX engine (tx_add_mic_sample()): an event is executed
+// when "wait" samples have passed since the previous one, or when it
+// arrives if that is later. Returns the number of key edges, and
+// the number of events that arrived late and the minimum lead with
+// which the others arrived.
+//
+static int replay(CW_EDGE *edges, int *late, long *min_lead) {
+  int n = 0;
+  int key = 0;
+  long t = 0;
+  *late = 0;
+  *min_lead = -1;
+
+  for (int i = 0; i < nevents; i++) {
+    t = (i == 0) ? events[i].arrival : t + events[i].wait;
+
+    if (events[i].arrival > t) {
+      if (i > 0) { (*late)++; }
+
+      t = events[i].arrival;
+    } else if (i > 0 && (*min_lead < 0 || t - events[i].arrival < *min_lead)) {
+      *min_lead = t - events[i].arrival;
+    }
+
+    if (events[i].down != key) {
+      key = events[i].down;
+      edges[n].down = key;
+      edges[n++].time = t;
+    }
+  }
+
+  return n;
+}
+
+static int cmp_long(const void *a, const void *b) {
+  long x = *(const long *) a;
+  long y = *(const long *) b;
+  return (x > y) - (x < y);
+}
+
+static void *hog_thread(void *arg) {
+  volatile unsigned long x = 0;
+
+  while (running) { x++; }
+
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  static CW_EDGE edges[MAX_EVENTS];
+  static long errors[MAX_EVENTS];
+  const char *text = "PARIS PARIS PARIS PARIS PARIS";
+  int wpm = 30;
+  int load = 0;
+  pthread_t hogs[64];
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-wpm") && i < argc - 1)    { wpm = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-text") && i < argc - 1)   { text = argv[++i]; continue; }
+
+    if (!strcmp(argv[i], "-jitter") && i < argc - 1) { jitter = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-seed") && i < argc - 1)   { rnd = (unsigned int) atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-load") && i < argc - 1)   { load = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-legacy"))                 { legacy = 1; continue; }
+
+    t_print("Unknown option: %s\n", argv[i]);
+    t_print("Usage: %s [-wpm n] [-text s] [-jitter n] [-seed n] [-load n] [-legacy]\n", argv[0]);
+    exit(1);
+  }
+
+  if (wpm < 1 || wpm > 60) { wpm = 30; }
+
+  if (rnd == 0) { rnd = 1; }
+
+  if (load < 0) { load = 0; }
+
+  if (load > 64) { load = 64; }
+
+  //
+  // rigctl.c, with a keyer weight of 50
+  //
+  int dot = 57600 / wpm;
+  int dash = (3456 * 50) / wpm;
+  clock_gettime(CLOCK_MONOTONIC, &bench_t0);
+
+  for (int i = 0; i < load; i++) {
+    if (pthread_create(&hogs[i], NULL, hog_thread, NULL) != 0) {
+      t_print("Cannot create load thread\n");
+      exit(1);
+    }
+  }
+
+  t_print("%s keying, %d wpm (dot=%d samples), jitter=%d usec, load=%d\n",
+          legacy ? "legacy" : "timeline", wpm, dot, jitter, load);
+
+  if (!legacy) { cw_timeline_start(record_event); }
+
+  send_text(text, dot, dash);
+
+  if (!legacy) { cw_timeline_drain(); }
+
+  running = 0;
+
+  for (int i = 0; i < load; i++) {
+    pthread_join(hogs[i], NULL);
+  }
+
+  int late;
+  long min_lead;
+  int n = replay(edges, &late, &min_lead);
+
+  if (n != nideal || n < 2) {
+    fprintf(stdout, "%d key edges sent, %d expected\n", n, nideal);
+    return 1;
+  }
+
+  //
+  // The error of each element or space is the deviation of the
+  // distance between two adjacent key edges from its ideal value
+  //
+  long sum = 0;
+  int bad = 0;
+
+  for (int i = 1; i < n; i++) {
+    long e = (edges[i].time - edges[i - 1].time) - (ideal[i].time - ideal[i - 1].time);
+    errors[i - 1] = e < 0 ? -e : e;
+    sum += errors[i - 1];
+
+    if (errors[i - 1] > 48) { bad++; }
+  }
+
+  qsort(errors, n - 1, sizeof(long), cmp_long);
+  fprintf(stdout, "%d elements and spaces, timing error (usec): mean %.1f, p50 %.1f, p99 %.1f, max %.1f\n",
+          n - 1, 1.0E6 * sum / (n - 1) / 48000.0, 1.0E6 * errors[(n - 1) / 2] / 48000.0,
+          1.0E6 * errors[((n - 1) * 99) / 100] / 48000.0, 1.0E6 * errors[n - 2] / 48000.0);
+  fprintf(stdout, "%d elements or spaces off by more than 1 msec\n", bad);
+  fprintf(stdout, "%d of %d events arrived late, min. lead of the others %.1f msec\n",
+          late, nevents - 1, min_lead / 48.0);
+
+  if (!legacy) {
+    long max_late;
+    int underruns;
+    cw_timeline_stats(&max_late, &underruns);
+    fprintf(stdout, "max. wakeup latency %.1f msec, %d underruns\n", max_late / 48.0, underruns);
+  }
+
+  return 0;
+}
@@ -249,6 +249,11 @@ static void save_hostlist() {
 
   SetPropI0("num_hosts", count);
   SetPropS0("current_host", host_addr);
+  SetPropI0("remote_audio_choice", remote_audio_choice);
+  SetPropI0("remote_audio_frame", remote_audio_frame);
+  SetPropI0("remote_spectrum_choice", remote_spectrum_choice);
+  SetPropI0("remote_transport", remote_transport);
+  SetPropI0("remote_iq_choice", remote_iq_choice);
   SetPropS0("property_version", "3.00");
   saveProperties("remote.props");
   gtk_combo_box_set_active(GTK_COMBO_BOX(host_combo), host_pos);
@@ -296,6 +301,44 @@ static void host_entry_cb(GtkWidget *widget, gpointer data) {
   save_hostlist();
 }
 
+static void audio_codec_cb(GtkWidget *widget, gpointer data) {
+  remote_audio_choice = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
+  save_hostlist();
+}
+
+static void audio_frame_cb(GtkWidget *widget, gpointer data) {
+  switch (gtk_combo_box_get_active(GTK_COMBO_BOX(widget))) {
+  case 0:
+    remote_audio_frame = 240;
+    break;
+
+  case 1:
+    remote_audio_frame = 480;
+    break;
+
+  default:
+    remote_audio_frame = 1024;
+    break;
+  }
+
+  save_hostlist();
+}
+
+static void spectrum_choice_cb(GtkWidget *widget, gpointer data) {
+  remote_spectrum_choice = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
+  save_hostlist();
+}
+
+static void transport_cb(GtkWidget *widget, gpointer data) {
+  remote_transport = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
+  save_hostlist();
+}
+
+static void iq_choice_cb(GtkWidget *widget, gpointer data) {
+  remote_iq_choice = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
+  save_hostlist();
+}
+
 static gboolean connect_cb(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
   char myhost[256];
   int  myport;
@@ -821,6 +864,11 @@ static void discovery() {
   //----------------------------------------------------+
   loadProperties("remote.props");
   GetPropS0("current_host", host_addr);
+  GetPropI0("remote_audio_choice", remote_audio_choice);
+  GetPropI0("remote_audio_frame", remote_audio_frame);
+  GetPropI0("remote_spectrum_choice", remote_spectrum_choice);
+  GetPropI0("remote_transport", remote_transport);
+  GetPropI0("remote_iq_choice", remote_iq_choice);
   t_print("current host: %s\n", host_addr);
   // Create a "Server" button
   GtkWidget *start_server_button = gtk_button_new_with_label("Use Server");
@@ -863,6 +911,33 @@ static void discovery() {
   GtkWidget *toggle_button = gtk_toggle_button_new_with_label("Show");
   g_signal_connect(toggle_button, "toggled", G_CALLBACK(password_visibility_cb), host_pwd);
   gtk_grid_attach(GTK_GRID(grid), toggle_button, 3, row, 1, 1);
+  //
+  // RX audio codec/bitrate requested from the server
+  //
+  GtkWidget *codec_combo = gtk_combo_box_text_new();
+
+  for (int i = 0; i < audio_codec_num_choices(); i++) {
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(codec_combo), NULL, audio_codec_choices[i].name);
+  }
+
+  if (remote_audio_choice < 0 || remote_audio_choice >= audio_codec_num_choices()) { remote_audio_choice = 1; }
+
+  gtk_combo_box_set_active(GTK_COMBO_BOX(codec_combo), remote_audio_choice);
+  my_combo_attach(GTK_GRID(grid), codec_combo, 4, row, 1, 1);
+  g_signal_connect(codec_combo, "changed", G_CALLBACK(audio_codec_cb), NULL);
+  //
+  // Transport of RX audio and spectrum for the client/server connection
+  //
+  GtkWidget *transport_combo = gtk_combo_box_text_new();
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(transport_combo), NULL, "TCP");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(transport_combo), NULL, "UDP");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(transport_combo), NULL, "UDP+FEC");
+
+  if (remote_transport < 0 || remote_transport > 2) { remote_transport = 0; }
+
+  gtk_combo_box_set_active(GTK_COMBO_BOX(transport_combo), remote_transport);
+  my_combo_attach(GTK_GRID(grid), transport_combo, 5, row, 1, 1);
+  g_signal_connect(transport_combo, "changed", G_CALLBACK(transport_cb), NULL);
   row++;
   controller = NO_CONTROLLER;
   gpioRestoreState();
@@ -884,6 +959,31 @@ static void discovery() {
   g_signal_connect (protocols_b, "button-press-event", G_CALLBACK(protocols_cb), NULL);
   gtk_grid_attach(GTK_GRID(grid), protocols_b, 2, row, 1, 1);
   //
+  // Audio packet size for the client/server connection
+  //
+  GtkWidget *frame_combo = gtk_combo_box_text_new();
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(frame_combo), NULL, "5 ms packets");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(frame_combo), NULL, "10 ms packets");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(frame_combo), NULL, "21 ms packets");
+
+  switch (remote_audio_frame) {
+  case 240:
+    gtk_combo_box_set_active(GTK_COMBO_BOX(frame_combo), 0);
+    break;
+
+  case 480:
+    gtk_combo_box_set_active(GTK_COMBO_BOX(frame_combo), 1);
+    break;
+
+  default:
+    remote_audio_frame = 1024;
+    gtk_combo_box_set_active(GTK_COMBO_BOX(frame_combo), 2);
+    break;
+  }
+
+  my_combo_attach(GTK_GRID(grid), frame_combo, 4, row, 1, 1);
+  g_signal_connect(frame_combo, "changed", G_CALLBACK(audio_frame_cb), NULL);
+  //
   row++;
   GtkWidget *tcp_b = gtk_label_new("Radio IP Addr ");
   gtk_widget_set_name(tcp_b, "boldlabel");
@@ -904,6 +1004,32 @@ static void discovery() {
   gtk_widget_set_name(exit_b, "close_button");
   g_signal_connect (exit_b, "button-press-event", G_CALLBACK(exit_cb), NULL);
   gtk_grid_attach(GTK_GRID(grid), exit_b, 3, row, 1, 1);
+  //
+  // Spectrum resolution for the client/server connection
+  //
+  GtkWidget *spectrum_combo = gtk_combo_box_text_new();
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(spectrum_combo), NULL, "Full Spectrum");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(spectrum_combo), NULL, "Reduced Spectrum");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(spectrum_combo), NULL, "Low-BW Spectrum");
+
+  if (remote_spectrum_choice < 0 || remote_spectrum_choice > 2) { remote_spectrum_choice = 1; }
+
+  gtk_combo_box_set_active(GTK_COMBO_BOX(spectrum_combo), remote_spectrum_choice);
+  my_combo_attach(GTK_GRID(grid), spectrum_combo, 4, row, 1, 1);
+  g_signal_connect(spectrum_combo, "changed", G_CALLBACK(spectrum_choice_cb), NULL);
+  //
+  // Demodulation on the server, or on the client with IQ data from the server
+  //
+  GtkWidget *iq_combo = gtk_combo_box_text_new();
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(iq_combo), NULL, "Server DSP");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(iq_combo), NULL, "Local DSP 48k");
+  gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(iq_combo), NULL, "Local DSP Full");
+
+  if (remote_iq_choice < 0 || remote_iq_choice > 2) { remote_iq_choice = 0; }
+
+  gtk_combo_box_set_active(GTK_COMBO_BOX(iq_combo), remote_iq_choice);
+  my_combo_attach(GTK_GRID(grid), iq_combo, 5, row, 1, 1);
+  g_signal_connect(iq_combo, "changed", G_CALLBACK(iq_choice_cb), NULL);
   gtk_container_add (GTK_CONTAINER (content), grid);
   gtk_widget_show_all(discovery_dialog);
   t_print("showing device dialog\n");
@@ -29,6 +29,7 @@
 #include "main.h"
 #include "new_menu.h"
 #include "radio.h"
+#include "spectrum_recorder.h"
 
 enum _containers {
   GENERAL_CONTAINER = 1,
@@ -51,6 +52,8 @@ static GtkWidget *peaks_container;
 //
 static RECEIVER *myrx;
 
+static GtkWidget *record_b = NULL;
+
 static void cleanup() {
   if (dialog != NULL) {
     GtkWidget *tmp = dialog;
@@ -241,6 +244,34 @@ static void display_panadapter_cb(GtkWidget *widget, gpointer data) {
   radio_reconfigure();
 }
 
+static void record_spectrum_cb(GtkWidget *widget, gpointer data) {
+  if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget))) {
+    spectrum_recorder_start(myrx, SPECREC_MINUTES);
+
+    if (!spectrum_recorder_running(myrx)) {
+      // replay active, or the file could not be created
+      gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widget), FALSE);
+    }
+  } else {
+    spectrum_recorder_stop(myrx);
+  }
+}
+
+static void replay_spectrum_cb(GtkWidget *widget, gpointer data) {
+  if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget))) {
+    //
+    // Starting a replay terminates a running recording
+    //
+    if (!spectrum_replay_start(myrx)) {
+      gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widget), FALSE);
+    }
+
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(record_b), spectrum_recorder_running(myrx));
+  } else {
+    spectrum_replay_stop(myrx);
+  }
+}
+
 static void waterfall_percent_cb(GtkWidget *widget, gpointer data) {
   myrx->waterfall_percent = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(widget));
   radio_reconfigure();
@@ -489,6 +520,21 @@ void display_menu(GtkWidget *parent) {
   gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (b_display_waterfall), myrx->display_waterfall);
   gtk_grid_attach(GTK_GRID(general_grid), b_display_waterfall, col + 1, row, 1, 1);
   g_signal_connect(b_display_waterfall, "toggled", G_CALLBACK(display_waterfall_cb), NULL);
+
+  if (!radio_is_remote && myrx->id < SPECREC_RECEIVERS) {
+    row++;
+    record_b = gtk_check_button_new_with_label("Record Spectrum");
+    gtk_widget_set_name (record_b, "boldlabel");
+    gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (record_b), spectrum_recorder_running(myrx));
+    gtk_grid_attach(GTK_GRID(general_grid), record_b, col, row, 1, 1);
+    g_signal_connect(record_b, "toggled", G_CALLBACK(record_spectrum_cb), NULL);
+    GtkWidget *replay_b = gtk_check_button_new_with_label("Replay Spectrum");
+    gtk_widget_set_name (replay_b, "boldlabel");
+    gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (replay_b), spectrum_replay_running(myrx));
+    gtk_grid_attach(GTK_GRID(general_grid), replay_b, col + 1, row, 1, 1);
+    g_signal_connect(replay_b, "toggled", G_CALLBACK(replay_spectrum_cb), NULL);
+  }
+
   //
   // Peaks container and controls therein
   //
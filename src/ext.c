@@ -29,6 +29,7 @@
 #include "main.h"
 #include "new_menu.h"
 #include "noise_menu.h"
+#include "notify.h"
 #include "radio.h"
 #include "radio_menu.h"
 #include "receiver.h"
@@ -51,9 +52,11 @@ int ext_start_radio(void *data) {
 
 //
 // ALL calls to vfo_update should go through g_idle_add(ext_vfo_update)
-// Here we take care that vfo_update() is called at most every 100 msec,
-// but that also after a g_idle_add(ext_vfo_update) the vfo_update is
-// called in the next 100 msec.
+// Here we take care that vfo_update() is called at most once per display
+// frame of the active receiver (but at least every 100 msec), and that
+// after a g_idle_add(ext_vfo_update) the vfo_update is called within the
+// next frame. So high-rate VFO changes (e.g. from CAT or TCI) are
+// coalesced to the display frame rate.
 //
 static guint vfo_timeout = 0;
 
@@ -69,12 +72,25 @@ static int vfo_timeout_cb(void * data) {
 }
 
 int ext_vfo_update(void *data) {
+  //
+  // Many code paths change VFO state directly and then
+  // come here, so report a change to the subscribers.
+  // They check what has actually changed.
+  //
+  notify_changed(NOTIFY_VFO | NOTIFY_MODE | NOTIFY_FILTER | NOTIFY_SPLIT);
+
   //
   // If no timeout is pending, then a vfo_update() is to
   // be scheduled soon.
   //
   if (vfo_timeout == 0) {
-    vfo_timeout = g_timeout_add(100, vfo_timeout_cb, NULL);
+    int interval = 100;
+
+    if (active_receiver && rx_get_display_fps(active_receiver) > 10) {
+      interval = 1000 / rx_get_display_fps(active_receiver);
+    }
+
+    vfo_timeout = g_timeout_add(interval, vfo_timeout_cb, NULL);
   }
 
   return G_SOURCE_REMOVE;
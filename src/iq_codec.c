@@ -0,0 +1,171 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+
+#include "iq_codec.h"
+
+static double hb_coeff[IQ_CODEC_HB_TAPS];
+static int hb_init = 0;
+
+//
+// Half-band low-pass filter (Blackman-windowed sinc), the same
+// design as in the 24 kHz audio codec.
+//
+static void hb_make_coeff() {
+  double sum = 0.0;
+
+  for (int i = 0; i < IQ_CODEC_HB_TAPS; i++) {
+    int n = i - (IQ_CODEC_HB_TAPS - 1) / 2;
+    double x = 0.5 * M_PI * n;
+    double s = (n == 0) ? 0.5 : 0.5 * sin(x) / x;
+    double w = 0.42 - 0.5 * cos(2.0 * M_PI * i / (IQ_CODEC_HB_TAPS - 1))
+               + 0.08 * cos(4.0 * M_PI * i / (IQ_CODEC_HB_TAPS - 1));
+    hb_coeff[i] = s * w;
+    sum += hb_coeff[i];
+  }
+
+  for (int i = 0; i < IQ_CODEC_HB_TAPS; i++) {
+    hb_coeff[i] /= sum;
+  }
+
+  hb_init = 1;
+}
+
+IQ_DECIMATOR *iq_decimator_new(int factor) {
+  IQ_DECIMATOR *d = g_new0(IQ_DECIMATOR, 1);
+
+  if (!hb_init) { hb_make_coeff(); }
+
+  while (factor > 1 && d->stages < IQ_CODEC_MAX_STAGES) {
+    d->stages++;
+    factor >>= 1;
+  }
+
+  return d;
+}
+
+void iq_decimator_free(IQ_DECIMATOR *d) {
+  g_free(d);
+}
+
+int iq_decimator_factor(const IQ_DECIMATOR *d) {
+  return 1 << d->stages;
+}
+
+//
+// Feed one sample into a half-band stage. Every second sample, the filter
+// output replaces *i and *q and 1 is returned. The history is shifted
+// by one sample each time, which is cheap enough for 31 taps.
+//
+static int hb_stage(IQ_DECIMATOR *d, int s, double *i, double *q) {
+  double *h = d->hist[s];
+  memmove(h, h + 2, 2 * (IQ_CODEC_HB_TAPS - 1) * sizeof(double));
+  h[2 * IQ_CODEC_HB_TAPS - 2] = *i;
+  h[2 * IQ_CODEC_HB_TAPS - 1] = *q;
+  d->phase[s] ^= 1;
+
+  if (d->phase[s]) { return 0; }
+
+  //
+  // Only the odd taps (and the center tap) are non-zero
+  //
+  const int c = (IQ_CODEC_HB_TAPS - 1) / 2;
+  double acc_i = hb_coeff[c] * h[2 * c];
+  double acc_q = hb_coeff[c] * h[2 * c + 1];
+
+  for (int k = 1; k <= c; k += 2) {
+    acc_i += hb_coeff[c + k] * (h[2 * (c + k)] + h[2 * (c - k)]);
+    acc_q += hb_coeff[c + k] * (h[2 * (c + k) + 1] + h[2 * (c - k) + 1]);
+  }
+
+  *i = acc_i;
+  *q = acc_q;
+  return 1;
+}
+
+int iq_decimate(IQ_DECIMATOR *d, const double *in, int n, double *out) {
+  int m = 0;
+
+  for (int k = 0; k < n; k++) {
+    double i = in[2 * k];
+    double q = in[2 * k + 1];
+    int s;
+
+    for (s = 0; s < d->stages; s++) {
+      if (!hb_stage(d, s, &i, &q)) { break; }
+    }
+
+    if (s == d->stages) {
+      out[2 * m] = i;
+      out[2 * m + 1] = q;
+      m++;
+    }
+  }
+
+  return m;
+}
+
+int iq_encode(const double *iq, int n, short *mantissa) {
+  double peak = 0.0;
+  int exponent;
+
+  for (int k = 0; k < 2 * n; k++) {
+    double a = fabs(iq[k]);
+
+    if (a > peak) { peak = a; }
+  }
+
+  if (peak == 0.0) {
+    memset(mantissa, 0, 2 * n * sizeof(short));
+    return 0;
+  }
+
+  //
+  // peak = f * 2^exponent with 0.5 <= f < 1
+  //
+  frexp(peak, &exponent);
+
+  if (exponent > 127) { exponent = 127; }
+
+  if (exponent < -127) { exponent = -127; }
+
+  double scale = ldexp(32767.0, -exponent);
+
+  for (int k = 0; k < 2 * n; k++) {
+    double v = round(iq[k] * scale);
+
+    if (v > 32767.0) { v = 32767.0; }
+
+    if (v < -32767.0) { v = -32767.0; }
+
+    mantissa[k] = (short) v;
+  }
+
+  return exponent;
+}
+
+void iq_decode(const short *mantissa, int n, int exponent, double *iq) {
+  double scale = ldexp(1.0 / 32767.0, exponent);
+
+  for (int k = 0; k < 2 * n; k++) {
+    iq[k] = scale * mantissa[k];
+  }
+}
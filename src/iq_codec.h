@@ -0,0 +1,59 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _IQ_CODEC_H_
+#define _IQ_CODEC_H_
+
+#include <stdint.h>
+
+//
+// IQ data for the client/server protocol (remote IQ streaming, where the
+// client demodulates on its own). The IQ samples of a receiver are
+// decimated by a power of two (a cascade of half-band filters) and then
+// sent in block floating point: one exponent per block, and 16-bit
+// mantissas scaled such that the largest sample of the block uses the
+// full range. This gives 90 dB of dynamic range within a block, and the
+// block exponent follows the signal level.
+//
+#define IQ_CODEC_MAX_STAGES      5                         // decimation by up to 32
+#define IQ_CODEC_HB_TAPS         31
+
+typedef struct _iq_decimator {
+  int stages;
+  int phase[IQ_CODEC_MAX_STAGES];
+  double hist[IQ_CODEC_MAX_STAGES][2 * IQ_CODEC_HB_TAPS];  // interleaved I/Q
+} IQ_DECIMATOR;
+
+//
+// "factor" is rounded down to a power of two (at most 2^IQ_CODEC_MAX_STAGES).
+// iq_decimate() takes n interleaved IQ samples and returns the number
+// of samples written to out (at most n / factor + 1).
+//
+extern IQ_DECIMATOR *iq_decimator_new(int factor);
+extern void iq_decimator_free(IQ_DECIMATOR *d);
+extern int iq_decimator_factor(const IQ_DECIMATOR *d);
+extern int iq_decimate(IQ_DECIMATOR *d, const double *in, int n, double *out);
+
+//
+// iq_encode() converts n interleaved IQ samples to mantissas and
+// returns the block exponent, iq_decode() does the reverse.
+//
+extern int iq_encode(const double *iq, int n, short *mantissa);
+extern void iq_decode(const short *mantissa, int n, int exponent, double *iq);
+
+#endif
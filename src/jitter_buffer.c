@@ -0,0 +1,292 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// Adaptive jitter buffer for remote audio.
+//
+// The ring buffer of the WDSP rmatch module starts half-filled, and rmatch
+// adjusts its variable resampler such that the filling stays there. So
+// the ring size is twice the buffering delay (the "target"). The target is
+// derived from the peak arrival jitter of the packets: it is increased at
+// once if the buffer runs dry, and decreased if the jitter has been
+// much smaller than the target for some time. Since changing the ring size
+// means re-creating rmatch (and losing its contents), this is done with
+// some hysteresis. The resampling ratio found so far is kept.
+//
+// The input may have a different nominal sample rate (TCI clients may
+// send TX audio at 12 or 24 kHz), rmatch then resamples to 48 kHz. The
+// target and the jitter are always counted in output samples.
+//
+// Packets may vary in length (TCI clients do not send fixed-size
+// frames), so the samples are collected in blocks of a fixed size
+// before they are passed to rmatch. rmatch is thus only re-created
+// if the sample rate or the target changes, or the stream re-starts.
+//
+// The consumer may run in a time-critical thread (e.g. the TX thread on
+// the server), so jitter_buffer_get() never waits for the mutex but
+// delivers silence if the buffer is just being re-configured.
+//
+
+#include <gtk/gtk.h>
+#include <string.h>
+#include <wdsp.h>
+
+#include "jitter_buffer.h"
+#include "message.h"
+
+#define JB_RATE       48000
+#define JB_IDLE       250000          // usec without packets after which the stream is considered stopped
+#define JB_WINDOW     2000000         // usec, window for measuring the arrival jitter
+#define JB_SHRINK     10000000        // usec, min. time between target decrements
+#define JB_MAX_TARGET (JB_RATE / 4)   // max. buffering delay 250 msec
+
+//
+// Length of n input samples in output samples
+//
+static inline int jb_output_samples(const JITTER_BUFFER *jb, int n) {
+  return (int)((long long)n * JB_RATE / jb->rate);
+}
+
+//
+// Length of n output samples in input samples
+//
+static inline int jb_input_samples(const JITTER_BUFFER *jb, int n) {
+  return (int)((long long)n * jb->rate / JB_RATE);
+}
+
+static void jitter_buffer_configure(JITTER_BUFFER *jb, int insize, int target) {
+  int min_target = jb_output_samples(jb, insize) + jb->outsize + jb_output_samples(jb, insize) / 8;
+
+  if (target < min_target) { target = min_target; }
+
+  if (target > JB_MAX_TARGET) { target = JB_MAX_TARGET; }
+
+  if (jb->rmatch != NULL) {
+    int underflows, overflows, ringsize, nring;
+    getRMatchDiags(jb->rmatch, &underflows, &overflows, &jb->var, &ringsize, &nring);
+    destroy_rmatchV(jb->rmatch);
+  }
+
+  if (insize != jb->insize) {
+    g_free(jb->in);
+    jb->in = g_new(double, 2 * insize);
+    jb->insize = insize;
+  }
+
+  jb->target = target;
+  jb->rmatch = create_rmatchV(insize, jb->outsize, jb->rate, JB_RATE, 2 * target, jb->var);
+  jb->last_change = g_get_monotonic_time();
+}
+
+JITTER_BUFFER *jitter_buffer_new(int insize, int outsize) {
+  JITTER_BUFFER *jb = g_new0(JITTER_BUFFER, 1);
+  g_mutex_init(&jb->mutex);
+  jb->outsize = outsize;
+  jb->out = g_new(double, 2 * outsize);
+  jb->outpt = outsize;
+  jb->var = 1.0;
+  jb->rate = JB_RATE;
+  jb->block = insize;
+  jitter_buffer_configure(jb, insize, 2 * insize);
+  return jb;
+}
+
+void jitter_buffer_destroy(JITTER_BUFFER *jb) {
+  if (jb == NULL) { return; }
+
+  destroy_rmatchV(jb->rmatch);
+  g_mutex_clear(&jb->mutex);
+  g_free(jb->in);
+  g_free(jb->out);
+  g_free(jb);
+}
+
+//
+// Measure the arrival jitter and adapt the target filling.
+// Called with the mutex locked after a packet has been put.
+//
+static void jitter_buffer_adapt(JITTER_BUFFER *jb, gint64 now) {
+  double late = now - jb->first_put - 1.0E6 * jb->samples_in / jb->rate;
+
+  if (late < jb->late_min) { jb->late_min = late; }
+
+  if (late > jb->late_max) { jb->late_max = late; }
+
+  if (now - jb->window_start < JB_WINDOW) { return; }
+
+  double jitter = 1.0E-6 * JB_RATE * (jb->late_max - jb->late_min);
+  jb->jitter = (jitter > jb->jitter) ? jitter : 0.8 * jb->jitter + 0.2 * jitter;
+  jb->window_start = now;
+  jb->late_min = late;
+  jb->late_max = late;
+  int underflows, overflows, ringsize, nring;
+  double var;
+  getRMatchDiags(jb->rmatch, &underflows, &overflows, &var, &ringsize, &nring);
+  resetRMatchDiags(jb->rmatch);
+  int needed = (int) jb->jitter + jb_output_samples(jb, jb->insize) + jb->outsize;
+
+  if (underflows > 0) {
+    jb->underflows += underflows;
+    int target = jb->target + jb->target / 2;
+
+    if (target < needed) { target = needed; }
+
+    if (target > jb->target && jb->target < JB_MAX_TARGET) {
+      t_print("%s: %d underflows, delay %d --> %d msec\n", __FUNCTION__, underflows,
+              1000 * jb->target / JB_RATE, 1000 * target / JB_RATE);
+      jitter_buffer_configure(jb, jb->insize, target);
+    }
+  } else if (2 * needed < jb->target && now - jb->last_change > JB_SHRINK) {
+    int target = (jb->target + needed) / 2;
+    t_print("%s: delay %d --> %d msec\n", __FUNCTION__, 1000 * jb->target / JB_RATE, 1000 * target / JB_RATE);
+    jitter_buffer_configure(jb, jb->insize, target);
+  }
+}
+
+//
+// Putting a packet of n samples into the buffer: jitter_buffer_begin()
+// locks the mutex and re-creates rmatch if the sample rate changes or
+// the stream re-starts, then the caller adds the samples one by one,
+// and jitter_buffer_end() does the statistics.
+//
+static void jitter_buffer_begin(JITTER_BUFFER *jb, int rate, gint64 now) {
+  g_mutex_lock(&jb->mutex);
+  int restart = (now - jb->last_put > JB_IDLE);
+
+  //
+  // If the stream (re-)starts, begin with a half-filled ring
+  //
+  if (rate != jb->rate) {
+    jb->rate = rate;
+    jb->var = 1.0;
+    jitter_buffer_configure(jb, jb_input_samples(jb, jb->block), jb->target);
+    jb->fill = 0;
+  } else if (restart && jb->last_put != 0) {
+    jitter_buffer_configure(jb, jb->insize, jb->target);
+    jb->fill = 0;
+  }
+
+  if (restart) {
+    jb->first_put = jb->window_start = now;
+    jb->samples_in = 0;
+    jb->late_min = jb->late_max = 0.0;
+  }
+}
+
+//
+// Add a sample, and pass the block to rmatch when it is complete
+//
+static inline void jitter_buffer_add(JITTER_BUFFER *jb, double left, double right) {
+  jb->in[2 * jb->fill]     = left;
+  jb->in[2 * jb->fill + 1] = right;
+
+  if (++jb->fill >= jb->insize) {
+    xrmatchIN(jb->rmatch, jb->in);
+    jb->fill = 0;
+  }
+}
+
+static void jitter_buffer_end(JITTER_BUFFER *jb, int n, gint64 now) {
+  jb->last_put = now;
+  jitter_buffer_adapt(jb, now);
+  jb->samples_in += n;
+  g_mutex_unlock(&jb->mutex);
+}
+
+//
+// Put a packet of n samples (mono or stereo, 48 kHz) into the buffer.
+//
+void jitter_buffer_put(JITTER_BUFFER *jb, const short *samples, int n, int channels) {
+  gint64 now = g_get_monotonic_time();
+  jitter_buffer_begin(jb, JB_RATE, now);
+
+  for (int i = 0; i < n; i++) {
+    if (channels == 2) {
+      jitter_buffer_add(jb, samples[2 * i] * 0.00003051, samples[2 * i + 1] * 0.00003051);
+    } else {
+      jitter_buffer_add(jb, samples[i] * 0.00003051, samples[i] * 0.00003051);
+    }
+  }
+
+  jitter_buffer_end(jb, n, now);
+}
+
+//
+// Little-endian float32 sample, need not be aligned
+//
+static inline double jb_float32(const unsigned char *p) {
+  guint32 u;
+  float f;
+  memcpy(&u, p, 4);
+  u = GUINT32_FROM_LE(u);
+  memcpy(&f, &u, 4);
+  return f;
+}
+
+//
+// The same for float samples (little-endian float32, as received
+// from the network) at an arbitrary sample rate
+//
+void jitter_buffer_put_float(JITTER_BUFFER *jb, const unsigned char *data, int n, int channels, int rate) {
+  gint64 now = g_get_monotonic_time();
+  jitter_buffer_begin(jb, rate, now);
+
+  for (int i = 0; i < n; i++) {
+    if (channels == 2) {
+      jitter_buffer_add(jb, jb_float32(data + 8 * i), jb_float32(data + 8 * i + 4));
+    } else {
+      jitter_buffer_add(jb, jb_float32(data + 4 * i), jb_float32(data + 4 * i));
+    }
+  }
+
+  jitter_buffer_end(jb, n, now);
+}
+
+//
+// Get the next sample. Returns zero (and delivers silence) if the
+// stream has stopped or the buffer is being re-configured.
+//
+int jitter_buffer_get(JITTER_BUFFER *jb, double *left, double *right) {
+  *left = *right = 0.0;
+
+  if (g_get_monotonic_time() - jb->last_put > JB_IDLE) {
+    return 0;
+  }
+
+  if (jb->outpt >= jb->outsize) {
+    if (!g_mutex_trylock(&jb->mutex)) {
+      return 0;
+    }
+
+    xrmatchOUT(jb->rmatch, jb->out);
+    jb->outpt = 0;
+    g_mutex_unlock(&jb->mutex);
+  }
+
+  *left = jb->out[2 * jb->outpt];
+  *right = jb->out[2 * jb->outpt + 1];
+  jb->outpt++;
+  return 1;
+}
+
+//
+// Current buffering delay in msec
+//
+double jitter_buffer_delay(JITTER_BUFFER *jb) {
+  return 1000.0 * jb->target / JB_RATE;
+}
@@ -0,0 +1,65 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _JITTER_BUFFER_H_
+#define _JITTER_BUFFER_H_
+
+#include <gtk/gtk.h>
+
+//
+// Adaptive jitter buffer for audio (48 kHz) received over the network.
+// Packets are put into the buffer by the network thread, and samples are
+// fetched by a thread running on a different clock (sound card, radio).
+// The clock difference is compensated by the WDSP rmatch variable resampler,
+// the buffer depth follows the measured packet arrival jitter.
+//
+typedef struct _jitter_buffer {
+  GMutex mutex;
+  void *rmatch;
+  int block;                   // samples per rmatch input block at 48 kHz
+  int insize;                  // samples per rmatch input block at the input rate
+  int fill;                    // samples in "in" not yet passed to rmatch
+  int rate;                    // nominal input sample rate
+  int outsize;                 // samples per block fetched from rmatch
+  int target;                  // target filling of the buffer (samples)
+  double *in;
+  double *out;
+  int outpt;                   // next sample to deliver from "out"
+  double var;                  // resampling ratio, kept when re-creating rmatch
+  //
+  // arrival time statistics
+  //
+  gint64 last_put;             // time of last packet (usec)
+  gint64 first_put;            // time of first packet after a pause
+  long long samples_in;        // samples received since first_put
+  gint64 window_start;
+  double late_min;             // arrival time relative to the nominal time (usec)
+  double late_max;
+  double jitter;               // peak arrival jitter (samples), slowly decaying
+  gint64 last_change;          // last change of the target filling
+  int underflows;              // total number of underflows
+} JITTER_BUFFER;
+
+extern JITTER_BUFFER *jitter_buffer_new(int insize, int outsize);
+extern void jitter_buffer_destroy(JITTER_BUFFER *jb);
+extern void jitter_buffer_put(JITTER_BUFFER *jb, const short *samples, int n, int channels);
+extern void jitter_buffer_put_float(JITTER_BUFFER *jb, const unsigned char *data, int n, int channels, int rate);
+extern int  jitter_buffer_get(JITTER_BUFFER *jb, double *left, double *right);
+extern double jitter_buffer_delay(JITTER_BUFFER *jb);
+
+#endif
@@ -0,0 +1,135 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "link_stats.h"
+
+static const char *link_class_names[LINK_CLASSES] = { "control", "audio", "iq", "spectrum" };
+
+void link_stats_init(LINK_STATS *s) {
+  memset(s, 0, sizeof(LINK_STATS));
+  s->start = s->last_update = g_get_monotonic_time();
+}
+
+void link_stats_tx(LINK_STATS *s, int cls, int bytes) {
+  s->tx_bytes[cls] += bytes;
+}
+
+void link_stats_rx(LINK_STATS *s, int cls, int bytes) {
+  s->rx_bytes[cls] += bytes;
+}
+
+//
+// Called by the I/O thread when the socket becomes full or writable again
+//
+void link_stats_stall(LINK_STATS *s, int stalled) {
+  gint64 now = g_get_monotonic_time();
+
+  if (stalled && s->stall_start == 0) {
+    s->stall_start = now;
+  } else if (!stalled && s->stall_start != 0) {
+    s->stall_total += now - s->stall_start;
+    s->stall_start = 0;
+  }
+}
+
+void link_stats_rtt(LINK_STATS *s, double rtt_ms) {
+  if (s->pongs == 0 || rtt_ms < s->rtt_min_ms) { s->rtt_min_ms = rtt_ms; }
+
+  if (s->pongs == 0 || rtt_ms > s->rtt_max_ms) { s->rtt_max_ms = rtt_ms; }
+
+  s->rtt_ms = rtt_ms;
+  s->pongs++;
+}
+
+void link_stats_update(LINK_STATS *s) {
+  gint64 now = g_get_monotonic_time();
+  double dt = 1.0E-6 * (double)(now - s->last_update);
+
+  if (dt <= 0.0) { return; }
+
+  for (int i = 0; i < LINK_CLASSES; i++) {
+    s->tx_rate[i] = (double)(s->tx_bytes[i] - s->last_tx[i]) / dt;
+    s->rx_rate[i] = (double)(s->rx_bytes[i] - s->last_rx[i]) / dt;
+    s->last_tx[i] = s->tx_bytes[i];
+    s->last_rx[i] = s->rx_bytes[i];
+  }
+
+  //
+  // A stall that is still going on counts up to now
+  //
+  gint64 stall = s->stall_total + (s->stall_start != 0 ? now - s->stall_start : 0);
+  s->stall_ms = 1.0E-3 * (double)(stall - s->last_stall) / dt;
+  s->last_stall = stall;
+  s->interval_queue_max = s->queue_max;
+  s->queue_max = s->queue_bytes;
+  s->last_update = now;
+}
+
+void link_stats_format(const LINK_STATS *s, char *text, size_t len) {
+  double tx = 0.0;
+  double rx = 0.0;
+
+  for (int i = 0; i < LINK_CLASSES; i++) {
+    tx += s->tx_rate[i];
+    rx += s->rx_rate[i];
+  }
+
+  snprintf(text, len,
+           "RTT %.0f ms (%.0f-%.0f), out %.1f kB/s (audio %.1f, IQ %.1f, spectrum %.1f), in %.1f kB/s,"
+           " queue %d kB, stall %.0f ms/s, dropped %d/%d, client underruns %d, lost %d/%d",
+           s->rtt_ms, s->rtt_min_ms, s->rtt_max_ms,
+           tx * 1.0E-3, s->tx_rate[LINK_AUDIO] * 1.0E-3, s->tx_rate[LINK_IQ] * 1.0E-3,
+           s->tx_rate[LINK_SPECTRUM] * 1.0E-3, rx * 1.0E-3,
+           s->interval_queue_max / 1000, s->stall_ms, s->spectrum_dropped, s->audio_dropped,
+           s->client_underruns, s->client_audio_lost, s->client_spectrum_lost);
+}
+
+void link_stats_json(const LINK_STATS *s, const char *peer, int controlling, char *text, size_t len) {
+  int n = snprintf(text, len,
+                   "{\"time\":%lld,\"peer\":\"%s\",\"controlling\":%d,\"uptime\":%lld,"
+                   "\"rtt_ms\":%.2f,\"rtt_min_ms\":%.2f,\"rtt_max_ms\":%.2f,\"pings\":%d,\"pongs\":%d,"
+                   "\"queue_bytes\":%d,\"queue_max\":%d,\"stall_ms_per_s\":%.1f,"
+                   "\"spectrum_dropped\":%d,\"audio_dropped\":%d,\"udp_dropped\":%d,"
+                   "\"client_underruns\":%d,\"client_audio_lost\":%d,\"client_spectrum_lost\":%d",
+                   (long long)(g_get_real_time() / 1000), peer, controlling,
+                   (long long)((s->last_update - s->start) / 1000000),
+                   s->rtt_ms, s->rtt_min_ms, s->rtt_max_ms, s->pings, s->pongs,
+                   s->queue_bytes, s->interval_queue_max, s->stall_ms,
+                   s->spectrum_dropped, s->audio_dropped, s->udp_dropped,
+                   s->client_underruns, s->client_audio_lost, s->client_spectrum_lost);
+
+  for (int dir = 0; dir < 2; dir++) {
+    const double *rate = dir ? s->rx_rate : s->tx_rate;
+
+    if (n < 0 || n >= (int)len) { return; }
+
+    n += snprintf(text + n, len - n, ",\"%s_bytes_per_s\":{", dir ? "rx" : "tx");
+
+    for (int i = 0; i < LINK_CLASSES && n < (int)len; i++) {
+      n += snprintf(text + n, len - n, "%s\"%s\":%.0f", i ? "," : "", link_class_names[i], rate[i]);
+    }
+
+    if (n < (int)len) { n += snprintf(text + n, len - n, "}"); }
+  }
+
+  if (n < (int)len) { snprintf(text + n, len - n, "}"); }
+}
@@ -0,0 +1,88 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _LINK_STATS_H_
+#define _LINK_STATS_H_
+
+#include <gtk/gtk.h>
+
+//
+// Statistics of one client/server connection, kept by the server for
+// each client. Bytes are counted per message class in both directions,
+// and link_stats_update() (called every LINK_STATS_INTERVAL seconds)
+// turns the counters into rates. The round trip time is measured with
+// CMD_PING, and the client reports its own counters (audio underruns,
+// lost audio and spectrum packets) in the ping reply.
+//
+#define LINK_STATS_INTERVAL 1      // seconds
+
+enum _link_class_enum {
+  LINK_CONTROL = 0,
+  LINK_AUDIO,                      // RX audio, and TX audio from the client
+  LINK_IQ,
+  LINK_SPECTRUM,
+  LINK_CLASSES
+};
+
+typedef struct _link_stats {
+  gint64 start;                    // time of connection (usec)
+  long long tx_bytes[LINK_CLASSES];  // server --> client
+  long long rx_bytes[LINK_CLASSES];  // client --> server
+  gint64 stall_start;              // socket full since then (0: not stalled)
+  gint64 stall_total;              // usec
+  int queue_bytes;                 // send queue, updated by the caller
+  int queue_max;                   // largest queue_bytes seen in the interval
+  int spectrum_dropped;            // updated by the caller
+  int audio_dropped;
+  int udp_dropped;
+  int pings;                       // pings sent
+  int pongs;                       // ping replies received
+  double rtt_ms;                   // last round trip time
+  double rtt_min_ms;
+  double rtt_max_ms;
+  int client_underruns;            // reported by the client
+  int client_audio_lost;
+  int client_spectrum_lost;
+  //
+  // Results of the last interval
+  //
+  gint64 last_update;
+  long long last_tx[LINK_CLASSES];
+  long long last_rx[LINK_CLASSES];
+  gint64 last_stall;
+  double tx_rate[LINK_CLASSES];    // bytes/s
+  double rx_rate[LINK_CLASSES];
+  double stall_ms;                 // time the socket was full, msec per second
+  int interval_queue_max;
+} LINK_STATS;
+
+extern void link_stats_init(LINK_STATS *s);
+extern void link_stats_tx(LINK_STATS *s, int cls, int bytes);
+extern void link_stats_rx(LINK_STATS *s, int cls, int bytes);
+extern void link_stats_stall(LINK_STATS *s, int stalled);
+extern void link_stats_rtt(LINK_STATS *s, double rtt_ms);
+extern void link_stats_update(LINK_STATS *s);
+
+//
+// link_stats_format() gives one line of text for the server menu,
+// link_stats_json() one JSON object (without a newline).
+//
+extern void link_stats_format(const LINK_STATS *s, char *text, size_t len);
+extern void link_stats_json(const LINK_STATS *s, const char *peer, int controlling, char *text, size_t len);
+
+#endif
@@ -32,6 +32,7 @@
 #include "new_menu.h"
 #include "radio.h"
 #include "receiver.h"
+#include "text_cache.h"
 #include "version.h"
 #include "vfo.h"
 #include "vox.h"
@@ -104,6 +105,23 @@ GtkWidget* meter_init(int width, int height) {
   return meter;
 }
 
+//
+// Offscreen meter without a widget (used by the render benchmark)
+//
+void meter_init_offscreen() {
+  meter = NULL;
+
+  if (meter_surface) {
+    cairo_surface_destroy (meter_surface);
+  }
+
+  meter_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, METER_WIDTH, METER_HEIGHT);
+  cairo_t *cr = cairo_create (meter_surface);
+  cairo_set_source_rgba(cr, COLOUR_VFO_BACKGND);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+}
+
 void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double swr) {
   double rxlvl;   // only used for RX input level, clones "value"
   double pwr;     // only used for TX power, clones "value"
@@ -247,7 +265,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
           cairo_line_to(cr, x, y);
           cairo_stroke(cr);
           snprintf(sf, sizeof(sf), "%d", i);
-          cairo_text_extents(cr, sf, &extents);
+          text_cache_extents(cr, sf, &extents);
           cairo_arc(cr, cx, cx, radius + 5, radians, radians);
           cairo_get_current_point(cr, &x, &y);
           cairo_new_path(cr);
@@ -256,7 +274,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
           //
           x += extents.width * (x / (2.0 * cx) - 1.0);
           cairo_move_to(cr, x, y);
-          cairo_show_text(cr, sf);
+          text_cache_show(cr, sf);
         } else {
           cairo_arc(cr, cx, cx, radius + 2, radians, radians);
           cairo_get_current_point(cr, &x, &y);
@@ -277,13 +295,13 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
         cairo_line_to(cr, x, y);
         cairo_stroke(cr);
         snprintf(sf, sizeof(sf), "+%d", i);
-        cairo_text_extents(cr, sf, &extents);
+        text_cache_extents(cr, sf, &extents);
         cairo_arc(cr, cx, cx, radius + 5, radians, radians);
         cairo_get_current_point(cr, &x, &y);
         cairo_new_path(cr);
         x += extents.width * (x / (2.0 * cx) - 1.0);
         cairo_move_to(cr, x, y);
-        cairo_show_text(cr, sf);
+        text_cache_show(cr, sf);
         cairo_new_path(cr);
       }
 
@@ -317,7 +335,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
         cairo_move_to(cr, cx - 40, cx - radius + 34);
       }
 
-      cairo_show_text(cr, sf);
+      text_cache_show(cr, sf);
     }
     break;
 
@@ -397,13 +415,13 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
               break;
               }
 
-              cairo_text_extents(cr, sf, &extents);
+              text_cache_extents(cr, sf, &extents);
               cairo_arc(cr, cx, cx, radius + 5, radians, radians);
               cairo_get_current_point(cr, &x, &y);
               cairo_new_path(cr);
               x += extents.width * (x / (2.0 * cx) - 1.0);
               cairo_move_to(cr, x, y);
-              cairo_show_text(cr, sf);
+              text_cache_show(cr, sf);
             }
           }
 
@@ -438,7 +456,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
         }
 
         cairo_move_to(cr, cx - 20, cx - radius + 15);
-        cairo_show_text(cr, sf);
+        text_cache_show(cr, sf);
 
         if (can_transmit) {
           if (swr > transmitter->swr_alarm) {
@@ -450,14 +468,14 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
 
         snprintf(sf, sizeof(sf), "SWR %1.1f:1", swr);
         cairo_move_to(cr, cx - 40, cx - radius + 28);
-        cairo_show_text(cr, sf);
+        text_cache_show(cr, sf);
       }
 
       if (!cwmode) {
         cairo_set_source_rgba(cr, COLOUR_METER);
         snprintf(sf, sizeof(sf), "ALC %2.1f dB", max_alc);
         cairo_move_to(cr, cx - 40, cx - radius + 41);
-        cairo_show_text(cr, sf);
+        text_cache_show(cr, sf);
       }
     }
     break;
@@ -504,7 +522,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
       cairo_set_font_size(cr, DISPLAY_FONT_SIZE2);
       cairo_set_source_rgba(cr, COLOUR_METER);
       cairo_move_to(cr, offset + 105.0, 10.0);
-      cairo_show_text(cr, "Mic Lvl");
+      text_cache_show(cr, "Mic Lvl");
       cairo_move_to(cr, offset, 0.0);
       cairo_line_to(cr, offset, 5.0);
       cairo_stroke(cr);
@@ -594,7 +612,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
       cairo_set_source_rgba(cr, COLOUR_METER);
       cairo_set_font_size(cr, DISPLAY_FONT_SIZE2);
       cairo_move_to(cr, 110.0, Y1);
-      cairo_show_text(cr, "Mic Lvl");
+      text_cache_show(cr, "Mic Lvl");
     }
 
     cairo_set_source_rgba(cr, COLOUR_METER);
@@ -625,9 +643,9 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
         cairo_stroke(cr);
         cairo_set_font_size(cr, DISPLAY_FONT_SIZE2);
         cairo_move_to(cr, 20, Y4);
-        cairo_show_text(cr, "3");
+        text_cache_show(cr, "3");
         cairo_move_to(cr, 38, Y4);
-        cairo_show_text(cr, "6");
+        text_cache_show(cr, "6");
         cairo_set_source_rgba(cr, COLOUR_ALARM);
         cairo_move_to(cr, 5 + 54, Y4 - 10);
         cairo_line_to(cr, 5 + 54, Y4 - 20);
@@ -639,13 +657,13 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
         cairo_line_to(cr, 5 + 114, Y4 - 20);
         cairo_stroke(cr);
         cairo_move_to(cr, 56, Y4);
-        cairo_show_text(cr, "9");
+        text_cache_show(cr, "9");
         cairo_move_to(cr, 5 + 74 - 12, Y4);
-        cairo_show_text(cr, "+20");
+        text_cache_show(cr, "+20");
         cairo_move_to(cr, 5 + 94 - 9, Y4);
-        cairo_show_text(cr, "+40");
+        text_cache_show(cr, "+40");
         cairo_move_to(cr, 5 + 114 - 6, Y4);
-        cairo_show_text(cr, "+60");
+        text_cache_show(cr, "+60");
         //
         // The scale for l is:
         //   0.0  --> S0
@@ -696,9 +714,9 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
       cairo_set_source_rgba(cr, COLOUR_ATTN);
       cairo_set_font_size(cr, size);
       snprintf(sf, sizeof(sf), "%-3d dBm", (int)(max_rxlvl - 0.5));  // assume max_rxlvl < 0 in rounding
-      cairo_text_extents(cr, sf, &extents);
+      text_cache_extents(cr, sf, &extents);
       cairo_move_to(cr, METER_WIDTH - extents.width - 5, Y2);
-      cairo_show_text(cr, sf);
+      text_cache_show(cr, sf);
       break;
 
     case POWER:
@@ -711,7 +729,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
         cairo_set_source_rgba(cr, COLOUR_METER);  // revert to white color
         snprintf(sf, sizeof(sf), "ALC %2.1f dB", max_alc);
         cairo_move_to(cr, METER_WIDTH / 2, Y4);
-        cairo_show_text(cr, sf);
+        text_cache_show(cr, sf);
       }
 
       if (protocol == ORIGINAL_PROTOCOL || protocol == NEW_PROTOCOL) {
@@ -735,7 +753,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
 
         cairo_set_source_rgba(cr, COLOUR_ATTN);
         cairo_move_to(cr, 5, Y2);
-        cairo_show_text(cr, sf);
+        text_cache_show(cr, sf);
 
         if (can_transmit) {
           if (swr > transmitter->swr_alarm) {
@@ -747,7 +765,7 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
 
         snprintf(sf, sizeof(sf), "SWR %1.1f:1", swr);
         cairo_move_to(cr, METER_WIDTH / 2, Y2);
-        cairo_show_text(cr, sf);
+        text_cache_show(cr, sf);
       }
 
       break;
@@ -758,5 +776,8 @@ void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double
   // This is the same for analog and digital metering
   //
   cairo_destroy(cr);
-  gtk_widget_queue_draw (meter);
+
+  if (meter) {
+    gtk_widget_queue_draw (meter);
+  }
 }
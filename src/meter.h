@@ -30,6 +30,7 @@ enum _meter_type_enum {
 };
 
 extern GtkWidget* meter_init(int width, int height);
+extern void meter_init_offscreen(void);
 extern void meter_update(RECEIVER *rx, int meter_type, double value, double alc, double swr);
 
 #endif
@@ -0,0 +1,207 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+
+#include <gtk/gtk.h>
+#include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+  #include <sys/epoll.h>
+#else
+  #include <poll.h>
+#endif
+
+#include "message.h"
+#include "net_poll.h"
+
+#ifdef __linux__
+
+struct _net_poll {
+  int epfd;
+};
+
+static unsigned int epoll_events(int events) {
+  unsigned int ev = 0;
+
+  if (events & NET_POLL_IN) { ev |= EPOLLIN; }
+
+  if (events & NET_POLL_OUT) { ev |= EPOLLOUT; }
+
+  return ev;
+}
+
+NET_POLL *net_poll_new() {
+  NET_POLL *np = g_new(NET_POLL, 1);
+  np->epfd = epoll_create1(EPOLL_CLOEXEC);
+
+  if (np->epfd < 0) {
+    t_perror("epoll_create1");
+    g_free(np);
+    return NULL;
+  }
+
+  return np;
+}
+
+void net_poll_destroy(NET_POLL *np) {
+  if (np == NULL) { return; }
+
+  close(np->epfd);
+  g_free(np);
+}
+
+int net_poll_add(NET_POLL *np, int fd, int events, void *data) {
+  struct epoll_event ev;
+  ev.events = epoll_events(events);
+  ev.data.ptr = data;
+  return epoll_ctl(np->epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+int net_poll_modify(NET_POLL *np, int fd, int events, void *data) {
+  struct epoll_event ev;
+  ev.events = epoll_events(events);
+  ev.data.ptr = data;
+  return epoll_ctl(np->epfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+int net_poll_remove(NET_POLL *np, int fd) {
+  struct epoll_event ev;  // not used, but must not be NULL for old kernels
+  return epoll_ctl(np->epfd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+int net_poll_wait(NET_POLL *np, NET_POLL_EVENT *ev, int max, int timeout) {
+  struct epoll_event events[NET_POLL_MAX_FDS];
+
+  if (max > NET_POLL_MAX_FDS) { max = NET_POLL_MAX_FDS; }
+
+  int n = epoll_wait(np->epfd, events, max, timeout);
+
+  if (n < 0) { return (errno == EINTR) ? 0 : -1; }
+
+  for (int i = 0; i < n; i++) {
+    ev[i].data = events[i].data.ptr;
+    ev[i].events = 0;
+
+    if (events[i].events & EPOLLIN) { ev[i].events |= NET_POLL_IN; }
+
+    if (events[i].events & EPOLLOUT) { ev[i].events |= NET_POLL_OUT; }
+
+    if (events[i].events & (EPOLLERR | EPOLLHUP)) { ev[i].events |= NET_POLL_ERR; }
+  }
+
+  return n;
+}
+
+#else
+
+//
+// poll() version. Since the file descriptors are only changed
+// by the thread that also waits, there is no locking.
+//
+struct _net_poll {
+  int nfds;
+  struct pollfd fds[NET_POLL_MAX_FDS];
+  void *data[NET_POLL_MAX_FDS];
+};
+
+static short poll_events(int events) {
+  short ev = 0;
+
+  if (events & NET_POLL_IN) { ev |= POLLIN; }
+
+  if (events & NET_POLL_OUT) { ev |= POLLOUT; }
+
+  return ev;
+}
+
+NET_POLL *net_poll_new() {
+  return g_new0(NET_POLL, 1);
+}
+
+void net_poll_destroy(NET_POLL *np) {
+  g_free(np);
+}
+
+static int net_poll_find(const NET_POLL *np, int fd) {
+  for (int i = 0; i < np->nfds; i++) {
+    if (np->fds[i].fd == fd) { return i; }
+  }
+
+  return -1;
+}
+
+int net_poll_add(NET_POLL *np, int fd, int events, void *data) {
+  if (np->nfds >= NET_POLL_MAX_FDS || net_poll_find(np, fd) >= 0) { return -1; }
+
+  np->fds[np->nfds].fd = fd;
+  np->fds[np->nfds].events = poll_events(events);
+  np->fds[np->nfds].revents = 0;
+  np->data[np->nfds] = data;
+  np->nfds++;
+  return 0;
+}
+
+int net_poll_modify(NET_POLL *np, int fd, int events, void *data) {
+  int i = net_poll_find(np, fd);
+
+  if (i < 0) { return -1; }
+
+  np->fds[i].events = poll_events(events);
+  np->data[i] = data;
+  return 0;
+}
+
+int net_poll_remove(NET_POLL *np, int fd) {
+  int i = net_poll_find(np, fd);
+
+  if (i < 0) { return -1; }
+
+  np->nfds--;
+  np->fds[i] = np->fds[np->nfds];
+  np->data[i] = np->data[np->nfds];
+  return 0;
+}
+
+int net_poll_wait(NET_POLL *np, NET_POLL_EVENT *ev, int max, int timeout) {
+  int rc = poll(np->fds, np->nfds, timeout);
+
+  if (rc < 0) { return (errno == EINTR) ? 0 : -1; }
+
+  int n = 0;
+
+  for (int i = 0; i < np->nfds && n < max; i++) {
+    short revents = np->fds[i].revents;
+
+    if (revents == 0) { continue; }
+
+    ev[n].data = np->data[i];
+    ev[n].events = 0;
+
+    if (revents & POLLIN) { ev[n].events |= NET_POLL_IN; }
+
+    if (revents & POLLOUT) { ev[n].events |= NET_POLL_OUT; }
+
+    if (revents & (POLLERR | POLLHUP | POLLNVAL)) { ev[n].events |= NET_POLL_ERR; }
+
+    n++;
+  }
+
+  return n;
+}
+
+#endif
@@ -0,0 +1,52 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+
+#ifndef _NET_POLL_H_
+#define _NET_POLL_H_
+
+//
+// Minimal wrapper for waiting on many sockets in one thread.
+// Uses epoll on Linux, and poll() elsewhere (MacOS).
+//
+#define NET_POLL_IN     0x01
+#define NET_POLL_OUT    0x02
+#define NET_POLL_ERR    0x04         // error or hang-up, reported in any case
+
+#define NET_POLL_MAX_FDS  16
+
+typedef struct _net_poll NET_POLL;
+
+typedef struct _net_poll_event {
+  void *data;
+  int events;
+} NET_POLL_EVENT;
+
+extern NET_POLL *net_poll_new(void);
+extern void net_poll_destroy(NET_POLL *np);
+extern int net_poll_add(NET_POLL *np, int fd, int events, void *data);
+extern int net_poll_modify(NET_POLL *np, int fd, int events, void *data);
+extern int net_poll_remove(NET_POLL *np, int fd);
+
+//
+// Wait at most timeout msec (-1: forever). Returns the number of
+// events stored in ev[], 0 on time-out, or -1 on error.
+//
+extern int net_poll_wait(NET_POLL *np, NET_POLL_EVENT *ev, int max, int timeout);
+
+#endif
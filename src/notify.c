@@ -0,0 +1,96 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "message.h"
+#include "notify.h"
+
+#define MAX_NOTIFY 16
+
+typedef struct _subscriber {
+  int mask;
+  NOTIFY_FUNC func;
+  gpointer data;
+} SUBSCRIBER;
+
+static SUBSCRIBER subscriber[MAX_NOTIFY];
+static GMutex notify_mutex;
+static volatile gint notify_pending = 0;
+
+int notify_subscribe(int mask, NOTIFY_FUNC func, gpointer data) {
+  int id = 0;
+  g_mutex_lock(&notify_mutex);
+
+  for (int i = 0; i < MAX_NOTIFY; i++) {
+    if (subscriber[i].func == NULL) {
+      subscriber[i].mask = mask;
+      subscriber[i].data = data;
+      subscriber[i].func = func;
+      id = i + 1;
+      break;
+    }
+  }
+
+  g_mutex_unlock(&notify_mutex);
+
+  if (id == 0) {
+    t_print("%s: too many subscribers\n", __FUNCTION__);
+  }
+
+  return id;
+}
+
+void notify_unsubscribe(int id) {
+  if (id < 1 || id > MAX_NOTIFY) { return; }
+
+  g_mutex_lock(&notify_mutex);
+  subscriber[id - 1].func = NULL;
+  g_mutex_unlock(&notify_mutex);
+}
+
+static gboolean notify_dispatch(gpointer data) {
+  SUBSCRIBER copy[MAX_NOTIFY];
+  int changes = g_atomic_int_and(&notify_pending, 0);
+  //
+  // Call the subscribers without holding the mutex, since
+  // they may (un)subscribe.
+  //
+  g_mutex_lock(&notify_mutex);
+  memcpy(copy, subscriber, sizeof(copy));
+  g_mutex_unlock(&notify_mutex);
+
+  for (int i = 0; i < MAX_NOTIFY; i++) {
+    if (copy[i].func != NULL && (copy[i].mask & changes)) {
+      copy[i].func(changes & copy[i].mask, copy[i].data);
+    }
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+void notify_changed(int changes) {
+  //
+  // Only the first change since the last dispatch schedules
+  // a new one
+  //
+  if (g_atomic_int_or(&notify_pending, changes) == 0) {
+    g_idle_add(notify_dispatch, NULL);
+  }
+}
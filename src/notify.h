@@ -0,0 +1,58 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _NOTIFY_H_
+#define _NOTIFY_H_
+
+#include <gtk/gtk.h>
+
+//
+// Change notification for clients that report radio state
+// (TCI, CAT auto-reporting, the remote server).
+//
+// The code changing the state calls notify_changed() with the
+// kind of change. This may be done from any thread. Changes are
+// collected until the GTK event loop gets idle, and then all
+// subscribers are called (from the GTK thread) with the collected
+// changes that match their mask. So a burst of changes (e.g.
+// turning the VFO knob) is reported only once.
+// The subscribers still compare against what they have reported
+// last time and only send what actually has changed.
+//
+enum _notify_enum {
+  NOTIFY_VFO    = 1,            // VFO frequency, CTUN, band
+  NOTIFY_MODE   = 2,
+  NOTIFY_FILTER = 4,
+  NOTIFY_MOX    = 8,            // RX/TX transition (MOX, TUNE, VOX, PTT)
+  NOTIFY_SPLIT  = 16,
+  NOTIFY_DRIVE  = 32,
+  NOTIFY_ALL    = 63
+};
+
+typedef void (*NOTIFY_FUNC)(int changes, gpointer data);
+
+//
+// notify_subscribe() returns an id > 0, or 0 if there are too many
+// subscribers. A subscriber may be called once more after it
+// has unsubscribed, so the data must not be freed.
+//
+extern int  notify_subscribe(int mask, NOTIFY_FUNC func, gpointer data);
+extern void notify_unsubscribe(int id);
+extern void notify_changed(int changes);
+
+#endif
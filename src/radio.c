@@ -57,6 +57,7 @@
 #include "mode.h"
 #include "new_menu.h"
 #include "new_protocol.h"
+#include "notify.h"
 #include "old_protocol.h"
 #include "property.h"
 #include "radio_menu.h"
@@ -319,6 +320,7 @@ double drive_digi_max = 100.0; // maximum drive in DIGU/DIGL
 
 int display_warnings = TRUE;
 int display_pacurr = TRUE;
+int display_governor = TRUE;
 
 gint window_x_pos = 0;
 gint window_y_pos = 0;
@@ -1926,6 +1928,7 @@ static void rxtx(int state) {
     }
   }
 
+  notify_changed(NOTIFY_MOX);
   gpio_set_ptt(state);
 }
 
@@ -2406,6 +2409,7 @@ void radio_set_drive(double value) {
   if (!can_transmit) { return; }
 
   transmitter->drive = value;
+  notify_changed(NOTIFY_DRIVE);
 
   if (radio_is_remote) {
     send_drive(client_socket, value);
@@ -2523,6 +2527,7 @@ void radio_set_split(int val) {
   //
   if (can_transmit) {
     split = val;
+    notify_changed(NOTIFY_SPLIT);
 
     if (radio_is_remote) {
       send_split(client_socket, val);
@@ -2561,6 +2566,7 @@ static void radio_restore_state() {
   GetPropI0("radio.hpsdr_server",                            hpsdr_server);
   GetPropS0("radio.hpsdr_pwd",                               hpsdr_pwd);
   GetPropI0("radio.hpsdr_server.listen_port",                listen_port);
+  GetPropI0("radio.hpsdr_server.link_log",                   remote_link_log);
   GetPropI0("tci_enable",                                    tci_enable);
   GetPropI0("tci_port",                                      tci_port);
   GetPropI0("tci_txonly",                                    tci_txonly);
@@ -2622,6 +2628,7 @@ static void radio_restore_state() {
     GetPropI0("sat_mode",                                    sat_mode);
     GetPropI0("radio.display_warnings",                      display_warnings);
     GetPropI0("radio.display_pacurr",                        display_pacurr);
+    GetPropI0("radio.display_governor",                      display_governor);
     GetPropI0("mute_spkr_amp",                               mute_spkr_amp);
     GetPropI0("adc0_filter_bypass",                          adc0_filter_bypass);
     GetPropI0("adc1_filter_bypass",                          adc1_filter_bypass);
@@ -2760,6 +2767,7 @@ void radio_save_state() {
   SetPropI0("radio.hpsdr_server",                            hpsdr_server);
   SetPropS0("radio.hpsdr_pwd",                               hpsdr_pwd);
   SetPropI0("radio.hpsdr_server.listen_port",                listen_port);
+  SetPropI0("radio.hpsdr_server.link_log",                   remote_link_log);
   SetPropI0("tci_enable",                                    tci_enable);
   SetPropI0("tci_port",                                      tci_port);
   SetPropI0("tci_txonly",                                    tci_txonly);
@@ -2821,6 +2829,7 @@ void radio_save_state() {
     SetPropI0("sat_mode",                                    sat_mode);
     SetPropI0("radio.display_warnings",                      display_warnings);
     SetPropI0("radio.display_pacurr",                        display_pacurr);
+    SetPropI0("radio.display_governor",                      display_governor);
     SetPropI0("mute_spkr_amp",                               mute_spkr_amp);
     SetPropI0("adc0_filter_bypass",                          adc0_filter_bypass);
     SetPropI0("adc1_filter_bypass",                          adc1_filter_bypass);
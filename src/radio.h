@@ -267,6 +267,7 @@ extern double drive_digi_max;    // maximum value allowed in DIGU/DIGL
 
 extern int display_warnings;
 extern int display_pacurr;
+extern int display_governor;     // reduce frame rate of background receivers under CPU pressure
 
 extern int hl2_audio_codec;
 extern int hl2_cl1_input;
@@ -50,6 +50,8 @@
 #include "receiver.h"
 #include "rx_panadapter.h"
 #include "sliders.h"
+#include "spectrum_recorder.h"
+#include "tci.h"
 #ifdef SOAPYSDR
   #include "soapy_protocol.h"
 #endif
@@ -65,6 +67,14 @@
 #define max(x,y) (x<y?y:x)
 #endif
 
+//
+// Parameters of the display governor (see rx_display_governor)
+//
+#define GOV_LOAD_HIGH  0.70    // throttle a background receiver if load exceeds this
+#define GOV_LOAD_LOW   0.35    // un-throttle a receiver if load is below this
+#define GOV_MIN_FPS    5       // never throttle below this frame rate
+#define GOV_MAX_LEVEL  3       // fps is reduced by at most a factor of 2^GOV_MAX_LEVEL
+
 static int last_x;
 static gboolean has_moved = FALSE;
 static gboolean pressed = FALSE;
@@ -111,6 +121,16 @@ void rx_set_active(RECEIVER *rx) {
   // Make rx the new active receiver
   //
   active_receiver = rx;
+
+  //
+  // The active receiver is never throttled by the display governor
+  //
+  if (!radio_is_remote && rx->display_throttle > 0) {
+    t_print("%s: display governor: RX%d fps restored to %d\n", __FUNCTION__, rx->id + 1, rx->fps);
+    rx->display_throttle = 0;
+    rx_set_framerate(rx);
+  }
+
   g_idle_add(menu_active_receiver_changed, NULL);
   g_idle_add(ext_vfo_update, NULL);
   g_idle_add(zoompan_active_receiver_changed, NULL);
@@ -501,10 +521,93 @@ void rx_reconfigure(RECEIVER *rx, int height) {
   g_mutex_unlock(&rx->display_mutex);
 }
 
+int rx_get_display_fps(const RECEIVER *rx) {
+  //
+  // The frame rate actually used for the display. This is the frame rate
+  // chosen by the user, unless the receiver is throttled by the display governor.
+  //
+  return rx->fps >> rx->display_throttle;
+}
+
+static void rx_display_governor() {
+  //
+  // Closed-loop control of the display load, executed (at most) once per second.
+  //
+  // The load is estimated as the sum of the fraction of real time spent in the
+  // RX DSP (fexchange0 and spectrum input) and the fraction of time spent rendering
+  // panadapters and waterfalls. If it gets too high, the frame rate of a background
+  // (non-active) receiver is halved. Since the analyzer overlap is derived from the
+  // frame rate (see rx_set_analyzer), this also reduces the number of FFTs done.
+  // If the load drops, the frame rates are restored step by step.
+  // The active receiver is never throttled.
+  //
+  static gint64 last = 0;
+  gint64 now = g_get_monotonic_time();
+  double load = 0.0;
+  RECEIVER *victim = NULL;
+
+  if (now - last < 1000000) { return; }
+
+  last = now;
+
+  for (int i = 0; i < receivers; i++) {
+    const RECEIVER *rx = receiver[i];
+    load += rx->dsp_load;
+
+    if (rx->displaying) {
+      load += rx->render_time * rx_get_display_fps(rx);
+    }
+  }
+
+  for (int i = 0; i < receivers; i++) {
+    RECEIVER *rx = receiver[i];
+
+    if (!display_governor || rx == active_receiver) {
+      //
+      // restore the frame rate immediately
+      //
+      if (rx->display_throttle > 0) {
+        victim = rx;
+        break;
+      }
+    } else if (load > GOV_LOAD_HIGH) {
+      //
+      // throttle the least-throttled background receiver
+      //
+      if (rx->displaying && rx->display_throttle < GOV_MAX_LEVEL && (rx->fps >> (rx->display_throttle + 1)) >= GOV_MIN_FPS) {
+        if (victim == NULL || rx->display_throttle < victim->display_throttle) { victim = rx; }
+      }
+    } else if (load < GOV_LOAD_LOW) {
+      //
+      // un-throttle the most-throttled receiver
+      //
+      if (rx->display_throttle > 0) {
+        if (victim == NULL || rx->display_throttle > victim->display_throttle) { victim = rx; }
+      }
+    }
+  }
+
+  if (victim != NULL) {
+    int old_fps = rx_get_display_fps(victim);
+
+    if (display_governor && victim != active_receiver && load > GOV_LOAD_HIGH) {
+      victim->display_throttle++;
+    } else if (victim->display_throttle > 0) {
+      victim->display_throttle = (display_governor && victim != active_receiver) ? victim->display_throttle - 1 : 0;
+    }
+
+    t_print("%s: load=%0.2f RX%d fps %d --> %d\n", __FUNCTION__, load, victim->id + 1, old_fps,
+            rx_get_display_fps(victim));
+    rx_set_framerate(victim);
+  }
+}
+
 static int rx_update_display(gpointer data) {
   ASSERT_SERVER(0);
   RECEIVER *rx = (RECEIVER *)data;
 
+  rx_display_governor();
+
   if (rx->displaying && rx->pixels > 0) {
     int rc;
 
@@ -534,13 +637,32 @@ static int rx_update_display(gpointer data) {
     }
 
     g_mutex_lock(&rx->display_mutex);
-    rc = rx_get_pixels(rx);
+
+    //
+    // While replaying a spectrum recording, the live pixels are discarded
+    //
+    if (spectrum_replay_running(rx)) {
+      rx_get_pixels(rx);
+      rc = spectrum_replay_next_frame(rx);
+    } else {
+      rc = rx_get_pixels(rx);
+
+      if (rc) {
+        spectrum_recorder_add_frame(rx);
+      }
+    }
 
     if (rc) {
-      if (remoteclient.running) {
+      gint64 t0 = g_get_monotonic_time();
+
+      if (remote_clients > 0) {
         remote_send_rxspectrum(rx->id);
       }
 
+      if (tci_spectrum > 0) {
+        tci_rx_spectrum(rx->id);
+      }
+
       if (rx->display_panadapter) {
         rx_panadapter_update(rx);
       }
@@ -548,6 +670,8 @@ static int rx_update_display(gpointer data) {
       if (rx->display_waterfall) {
         waterfall_update(rx);
       }
+
+      rx->render_time = 0.9 * rx->render_time + 1.0E-7 * (double)(g_get_monotonic_time() - t0);
     }
 
     g_mutex_unlock(&rx->display_mutex);
@@ -565,7 +689,8 @@ void rx_set_displaying(RECEIVER *rx) {
       g_source_remove(rx->update_timer_id);
     }
 
-    rx->update_timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, 1000 / rx->fps, rx_update_display, rx, NULL);
+    rx->update_timer_id = gdk_threads_add_timeout_full(G_PRIORITY_HIGH_IDLE, 1000 / rx_get_display_fps(rx),
+                          rx_update_display, rx, NULL);
   } else {
     if (rx->update_timer_id > 0) {
       g_source_remove(rx->update_timer_id);
@@ -642,7 +767,6 @@ RECEIVER *rx_create_pure_signal_receiver(int id, int sample_rate, int width, int
     rx->fps = fps;
     rx->width = width; // used to re-calculate rx->pixels upon sample rate change
     rx->pixels = duplex ? 4 * tx_dialog_width : width;
-    rx->pixel_samples = g_new(float, rx->pixels);
     //
     // These values (including fps) should match those of the TX display
     //
@@ -886,7 +1010,6 @@ RECEIVER *rx_create_receiver(int id, int pixels, int width, int height) {
   //
   rx->iq_input_buffer = g_new(double, 2 * rx->buffer_size);
   rx->pixels = pixels * rx->zoom;
-  rx->pixel_samples = g_new(float, rx->pixels);
   t_print("%s (after restore): id=%d local_audio=%d\n", __FUNCTION__, rx->id, rx->local_audio);
   int scale = rx->sample_rate / 48000;
   rx->output_samples = rx->buffer_size / scale;
@@ -1107,6 +1230,10 @@ void rx_vfo_changed(RECEIVER *rx) {
 static void rx_process_buffer(RECEIVER *rx) {
   ASSERT_SERVER();
 
+  if (tci_streaming) {
+    tci_rx_audio(rx->id, rx->audio_output_buffer, rx->output_samples);
+  }
+
   for (int i = 0; i < rx->output_samples; i++) {
     double left_sample = rx->audio_output_buffer[i * 2];
     double right_sample = rx->audio_output_buffer[(i * 2) + 1];
@@ -1161,7 +1288,7 @@ static void rx_process_buffer(RECEIVER *rx) {
       audio_write(rx, (float)left_sample, (float)right_sample);
     }
 
-    if (remoteclient.running) {
+    if (remote_clients > 0) {
       remote_rxaudio(rx, left_audio_sample, right_audio_sample);
     }
 
@@ -1192,6 +1319,19 @@ static void rx_full_buffer(RECEIVER *rx) {
   // in this case we should not block the receiver thread
   //
   if (g_mutex_trylock(&rx->mutex)) {
+    gint64 t0 = g_get_monotonic_time();
+
+    //
+    // Remote clients that demodulate on their own get the raw IQ samples
+    //
+    if (remote_clients > 0) {
+      remote_rxiq(rx, rx->iq_input_buffer, rx->buffer_size);
+    }
+
+    if (tci_streaming) {
+      tci_rx_iq(rx->id, rx->sample_rate, rx->iq_input_buffer, rx->buffer_size);
+    }
+
     //
     // noise blanker works on original IQ samples with input sample rate
     //
@@ -1215,12 +1355,20 @@ static void rx_full_buffer(RECEIVER *rx) {
       t_print("%s: id=%d fexchange0: error=%d\n", __FUNCTION__, rx->id, error);
     }
 
+    //
+    // The analyzer hands over pixel frames through a lock-free triple buffer,
+    // so the display_mutex is not needed here (the RX thread must not wait for the GUI)
+    //
     if (rx->displaying) {
-      g_mutex_lock(&rx->display_mutex);
       Spectrum0(1, rx->id, 0, 0, rx->iq_input_buffer);
-      g_mutex_unlock(&rx->display_mutex);
     }
 
+    //
+    // DSP load: time spent here relative to the duration of the buffer
+    //
+    rx->dsp_load = 0.95 * rx->dsp_load + 0.05E-6 * (double)(g_get_monotonic_time() - t0) *
+                   (double)rx->sample_rate / (double)rx->buffer_size;
+
     rx_process_buffer(rx);
     g_mutex_unlock(&rx->mutex);
   }
@@ -1291,11 +1439,6 @@ void rx_update_zoom(RECEIVER *rx) {
   }
 
   if (!radio_is_remote) {
-    if (rx->pixel_samples != NULL) {
-      g_free(rx->pixel_samples);
-    }
-
-    rx->pixel_samples = g_new(float, rx->pixels);
     rx_set_analyzer(rx);
   }
 }
@@ -1398,8 +1541,6 @@ void rx_change_sample_rate(RECEIVER *rx, int sample_rate) {
     //
     if (rx->id == PS_RX_FEEDBACK && protocol == ORIGINAL_PROTOCOL) {
       rx->pixels = duplex ? 4 * tx_dialog_width : rx->width;
-      g_free(rx->pixel_samples);
-      rx->pixel_samples = g_new(float, rx->pixels);
       rx_set_analyzer(rx);
       t_print("%s: PS RX FEEDBACK: id=%d rate=%d buffer_size=%d output_samples=%d\n",
               __FUNCTION__, rx->id, rx->sample_rate, rx->buffer_size, rx->output_samples);
@@ -1453,8 +1594,16 @@ void rx_close(const RECEIVER *rx) {
 
 int rx_get_pixels(RECEIVER *rx) {
   ASSERT_SERVER(0);
+  //
+  // No copy is made: rx->pixel_samples points to the analyzer's
+  // pixel buffer owned by the reader. It remains valid (and unchanged)
+  // until the next call, and is shared by all consumers
+  // (panadapter, waterfall, remote client)
+  //
   int rc;
-  GetPixels(rx->id, 0, rx->pixel_samples, &rc);
+  float *frame;
+  GetPixelFrame(rx->id, 0, &frame, &rc);
+  rx->pixel_samples = frame;
   return rc;
 }
 
@@ -1518,9 +1667,10 @@ void rx_set_analyzer(const RECEIVER *rx) {
   const int afft_size = 16384;
   const int pixels = rx->pixels;
   int overlap;
+  const int fps = rx_get_display_fps(rx);
   int max_w = afft_size + (int) min(keep_time * (double) rx->sample_rate,
-                                    keep_time * (double) afft_size * (double) rx->fps);
-  overlap = (int)fmax(0.0, ceil(afft_size - (double)rx->sample_rate / (double)rx->fps));
+                                    keep_time * (double) afft_size * (double) fps);
+  overlap = (int)fmax(0.0, ceil(afft_size - (double)rx->sample_rate / (double)fps));
 
   //
   // RX FEEDBACK receiver:
@@ -1676,8 +1826,9 @@ void rx_set_average(const RECEIVER *rx) {
   //
   int wdspmode;
   double t = 0.001 * rx->display_average_time;
-  double display_avb = exp(-1.0 / ((double)rx->fps * t));
-  int display_average = max(2, (int)fmin(60, (double)rx->fps * t));
+  int fps = rx_get_display_fps(rx);
+  double display_avb = exp(-1.0 / ((double)fps * t));
+  int display_average = max(2, (int)fmin(60, (double)fps * t));
   SetDisplayAvBackmult(rx->id, 0, display_avb);
   SetDisplayNumAverage(rx->id, 0, display_average);
 
@@ -67,10 +67,13 @@ typedef struct _receiver {
   double *iq_input_buffer;
   double *audio_output_buffer;
   int audio_index;
-  float *pixel_samples;
+  float *pixel_samples;     // on the server, this points into the analyzer (see rx_get_pixels)
   int display_panadapter;
   int display_waterfall;
   guint update_timer_id;
+  int    display_throttle;  // display governor: fps is reduced by a factor of 2^display_throttle
+  double dsp_load;          // display governor: fraction of real time spent in the RX DSP
+  double render_time;       // display governor: time (in seconds) to update panadapter and waterfall
   int    smetermode;
   double meter;
 
@@ -286,6 +289,7 @@ extern void   rx_change_adc(const RECEIVER *rx);
 extern void   rx_close(const RECEIVER *rx);
 extern void   rx_create_analyzer(const RECEIVER *rx);
 extern void   rx_filter_changed(RECEIVER *rx);
+extern int    rx_get_display_fps(const RECEIVER *rx);
 extern int    rx_get_pixels(RECEIVER *rx);
 extern double rx_get_smeter(const RECEIVER *rx);
 extern void   rx_frequency_changed(RECEIVER *rx);
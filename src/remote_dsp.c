@@ -0,0 +1,342 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+
+/* Use our Windows-compatible wdsp wrapper */
+#ifdef _WIN32
+#include "../Windows/wdsp_wrapper.h"
+#else
+#include <wdsp.h>
+#endif
+
+#include "agc.h"
+#include "ext.h"
+#include "filter.h"
+#include "message.h"
+#include "mode.h"
+#include "radio.h"
+#include "receiver.h"
+#include "remote_dsp.h"
+#include "vfo.h"
+
+typedef struct _remote_dsp {
+  int open;
+  int sample_rate;
+  int out_size;                   // audio samples per buffer
+  int fill;
+  double iq[2 * REMOTE_DSP_BUFFER];
+  double audio[2 * REMOTE_DSP_BUFFER];
+  //
+  // Settings last applied to WDSP
+  //
+  int mode;
+  int filter_low;
+  int filter_high;
+  int deviation;
+  int agc;
+  double agc_gain;
+  double volume;
+  long long offset;
+  //
+  // Local analyzer
+  //
+  int analyzer;                   // created
+  int pixels;                     // 0: not set up
+  int fps;
+  float *pixel_buffer;
+  gint64 last_frame;
+} REMOTE_DSP;
+
+static REMOTE_DSP remote_dsp[2];
+
+int remote_dsp_analyzer(int id) {
+  return (id >= 0 && id < 2 && remote_dsp[id].pixels > 0);
+}
+
+static void remote_dsp_open(REMOTE_DSP *d, int id, int sample_rate) {
+  if (d->open) {
+    CloseChannel(id);
+  }
+
+  t_print("%s: RX%d local demodulation at %d Hz\n", __FUNCTION__, id + 1, sample_rate);
+  OpenChannel(id,                         // channel
+              REMOTE_DSP_BUFFER,          // in_size
+              2048,                       // dsp_size
+              sample_rate,                // input_samplerate
+              48000,                      // dsp rate
+              48000,                      // output_samplerate
+              0,                          // type (0=receive)
+              1,                          // state (run)
+              0.010, 0.025, 0.0, 0.010,   // DelayUp, SlewUp, DelayDown, SlewDown
+              1);                         // Wait for data in fexchange0
+  SetRXABandpassWindow(id, 1);
+  SetRXABandpassRun(id, 1);
+  SetRXAAMDSBMode(id, 0);
+  SetRXAPanelRun(id, 1);
+  SetRXAPanelSelect(id, 3);
+  d->open = 1;
+  d->sample_rate = sample_rate;
+  d->out_size = REMOTE_DSP_BUFFER * 48000 / sample_rate;
+  d->fill = 0;
+  d->pixels = 0;
+  //
+  // Force all settings to be applied
+  //
+  d->mode = -1;
+  d->agc = -1;
+  d->volume = 1000.0;
+  d->offset = -1;
+}
+
+//
+// Filter edges as in rx_set_filter()
+//
+static void remote_dsp_filter(const RECEIVER *rx, int *low, int *high) {
+  int id = rx->id;
+  int m = vfo[id].mode;
+  const FILTER *filter = &filters[m][vfo[id].filter];
+
+  switch (m) {
+  case modeCWL:
+    *low = -cw_keyer_sidetone_frequency + filter->low;
+    *high = -cw_keyer_sidetone_frequency + filter->high;
+    break;
+
+  case modeCWU:
+    *low = cw_keyer_sidetone_frequency + filter->low;
+    *high = cw_keyer_sidetone_frequency + filter->high;
+    break;
+
+  case modeFMN:
+    *low = -(3000 + vfo[id].deviation);
+    *high = 3000 + vfo[id].deviation;
+    break;
+
+  default:
+    *low = filter->low;
+    *high = filter->high;
+    break;
+  }
+}
+
+static void remote_dsp_settings(REMOTE_DSP *d, const RECEIVER *rx) {
+  int id = rx->id;
+  int low, high;
+
+  if (vfo[id].mode != d->mode) {
+    d->mode = vfo[id].mode;
+    SetRXAMode(id, d->mode);
+    d->filter_low = d->filter_high = 0;
+  }
+
+  remote_dsp_filter(rx, &low, &high);
+
+  if (low != d->filter_low || high != d->filter_high || vfo[id].deviation != d->deviation) {
+    d->filter_low = low;
+    d->filter_high = high;
+    d->deviation = vfo[id].deviation;
+    RXASetPassband(id, (double)low, (double)high);
+    SetRXAFMDeviation(id, (double)d->deviation);
+    d->agc = -1;              // AGC depends on the filter width
+  }
+
+  if (rx->agc != d->agc || rx->agc_gain != d->agc_gain) {
+    d->agc = rx->agc;
+    d->agc_gain = rx->agc_gain;
+    SetRXAAGCMode(id, rx->agc);
+    SetRXAAGCSlope(id, rx->agc_slope);
+    SetRXAAGCTop(id, rx->agc_gain);
+
+    switch (rx->agc) {
+    case AGC_OFF:
+      break;
+
+    case AGC_LONG:
+      SetRXAAGCAttack(id, 2);
+      SetRXAAGCHang(id, 2000);
+      SetRXAAGCDecay(id, 2000);
+      SetRXAAGCHangThreshold(id, (int)rx->agc_hang_threshold);
+      break;
+
+    case AGC_SLOW:
+      SetRXAAGCAttack(id, 2);
+      SetRXAAGCHang(id, 1000);
+      SetRXAAGCDecay(id, 500);
+      SetRXAAGCHangThreshold(id, (int)rx->agc_hang_threshold);
+      break;
+
+    case AGC_MEDIUM:
+      SetRXAAGCAttack(id, 2);
+      SetRXAAGCHang(id, 0);
+      SetRXAAGCDecay(id, 250);
+      SetRXAAGCHangThreshold(id, 100);
+      break;
+
+    case AGC_FAST:
+      SetRXAAGCAttack(id, 2);
+      SetRXAAGCHang(id, 0);
+      SetRXAAGCDecay(id, 50);
+      SetRXAAGCHangThreshold(id, 100);
+      break;
+    }
+  }
+
+  if (rx->volume != d->volume) {
+    //
+    // as in rx_set_af_gain()
+    //
+    d->volume = rx->volume;
+
+    if (d->volume <= -39.5) {
+      SetRXAPanelGain1(id, 0.0);
+    } else if (d->volume > 0.0) {
+      SetRXAPanelGain1(id, 1.0);
+    } else {
+      SetRXAPanelGain1(id, pow(10.0, 0.05 * d->volume));
+    }
+  }
+
+  if (vfo[id].offset != d->offset) {
+    d->offset = vfo[id].offset;
+    SetRXAShiftFreq(id, (double)d->offset);
+    RXANBPSetShiftFrequency(id, (double)d->offset);
+    SetRXAShiftRun(id, d->offset != 0);
+  }
+}
+
+//
+// The analyzer is only used if the IQ data has the full sample rate,
+// since otherwise the frequency axis of the panadapter would not fit.
+// Parameters as in rx_set_analyzer().
+//
+static void remote_dsp_set_analyzer(REMOTE_DSP *d, const RECEIVER *rx) {
+  int id = rx->id;
+  int pixels = rx->width * rx->zoom;
+  int fps = rx->fps > 0 ? rx->fps : 10;
+
+  if (d->sample_rate != rx->sample_rate || pixels <= 0) {
+    d->pixels = 0;
+    return;
+  }
+
+  if (pixels == d->pixels && fps == d->fps) { return; }
+
+  if (!d->analyzer) {
+    int rc;
+    XCreateAnalyzer(id, &rc, 262144, 1, 1, NULL);
+
+    if (rc != 0) {
+      t_print("%s: CreateAnalyzer failed for RX%d\n", __FUNCTION__, id + 1);
+      d->pixels = 0;
+      return;
+    }
+
+    d->analyzer = 1;
+  }
+
+  int flp[] = {0};
+  const double keep_time = 0.1;
+  const int afft_size = 16384;
+  int max_w = afft_size + (int) fmin(keep_time * (double) d->sample_rate,
+                                     keep_time * (double) afft_size * (double) fps);
+  int overlap = (int)fmax(0.0, ceil(afft_size - (double)d->sample_rate / (double)fps));
+  SetAnalyzer(id, 1, 1, 1, flp, afft_size, REMOTE_DSP_BUFFER, 5, 14.0, overlap, 0, 0.0, 0.0,
+              pixels, 1, 0, 0.0, 0.0, max_w);
+  SetDisplayDetectorMode(id, 0, DETECTOR_MODE_AVERAGE);
+  SetDisplayAverageMode(id, 0, AVERAGE_MODE_LOG_RECURSIVE);
+  SetDisplayAvBackmult(id, 0, exp(-1.0 / ((double)fps * 0.001 * rx->display_average_time)));
+  SetDisplayNumAverage(id, 0, (int)fmax(2.0, fmin(60.0, (double)fps * 0.001 * rx->display_average_time)));
+  g_free(d->pixel_buffer);
+  d->pixel_buffer = g_new(float, pixels);
+  d->pixels = pixels;
+  d->fps = fps;
+}
+
+static void remote_dsp_display(REMOTE_DSP *d, RECEIVER *rx) {
+  gint64 now = g_get_monotonic_time();
+  int flag = 0;
+
+  if (now - d->last_frame < 1000000 / d->fps) { return; }
+
+  GetPixels(rx->id, 0, d->pixel_buffer, &flag);
+
+  if (!flag) { return; }
+
+  d->last_frame = now;
+  int pan = rx->pan;
+
+  if (pan < 0 || pan + rx->width > d->pixels) { pan = 0; }
+
+  g_mutex_lock(&rx->display_mutex);
+
+  if (rx->pixel_samples == NULL) {
+    rx->pixel_samples = g_new(float, (int) rx->width);
+  }
+
+  memcpy(rx->pixel_samples, d->pixel_buffer + pan, rx->width * sizeof(float));
+  g_mutex_unlock(&rx->display_mutex);
+  g_idle_add(ext_rx_remote_update_display, rx);
+}
+
+int remote_dsp_process(RECEIVER *rx, int sample_rate, const double *iq, int n, short *pcm, int max) {
+  int id = rx->id;
+  REMOTE_DSP *d;
+  int count = 0;
+
+  if (id < 0 || id > 1 || sample_rate < 48000 || sample_rate % 48000 != 0) { return 0; }
+
+  d = &remote_dsp[id];
+
+  if (!d->open || d->sample_rate != sample_rate) {
+    remote_dsp_open(d, id, sample_rate);
+  }
+
+  for (int k = 0; k < n; k++) {
+    d->iq[2 * d->fill] = iq[2 * k];
+    d->iq[2 * d->fill + 1] = iq[2 * k + 1];
+
+    if (++d->fill < REMOTE_DSP_BUFFER) { continue; }
+
+    int error;
+    d->fill = 0;
+    remote_dsp_settings(d, rx);
+    remote_dsp_set_analyzer(d, rx);
+    fexchange0(id, d->iq, d->audio, &error);
+
+    if (error != 0) {
+      t_print("%s: RX%d fexchange0: error=%d\n", __FUNCTION__, id + 1, error);
+    }
+
+    if (d->pixels > 0 && rx->displaying) {
+      Spectrum0(1, id, 0, 0, d->iq);
+      remote_dsp_display(d, rx);
+    }
+
+    for (int i = 0; i < d->out_size && count < max; i++, count++) {
+      double left = d->audio[2 * i] * 32767.0;
+      double right = d->audio[2 * i + 1] * 32767.0;
+      pcm[2 * count] = (short)(left > 32767.0 ? 32767.0 : (left < -32767.0 ? -32767.0 : left));
+      pcm[2 * count + 1] = (short)(right > 32767.0 ? 32767.0 : (right < -32767.0 ? -32767.0 : right));
+    }
+  }
+
+  return count;
+}
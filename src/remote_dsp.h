@@ -0,0 +1,42 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _REMOTE_DSP_H_
+#define _REMOTE_DSP_H_
+
+#include "receiver.h"
+
+//
+// Client side of remote IQ streaming: the client runs its own WDSP RXA
+// channel for a receiver and feeds it with the IQ data from the server
+// (INFO_IQ). Mode, filter, AGC, volume and the CTUN/RIT offset are taken
+// from the local RECEIVER and VFO data and applied to WDSP whenever they
+// have changed, so the rx_* functions need not know about this.
+// If the IQ data comes at the full sample rate of the receiver, a local
+// analyzer feeds the panadapter as well.
+//
+#define REMOTE_DSP_BUFFER 512   // IQ samples per fexchange0()
+
+//
+// remote_dsp_process() takes n IQ samples and returns the number of
+// stereo audio samples (at 48 kHz) stored in pcm, at most max.
+//
+extern int remote_dsp_process(RECEIVER *rx, int sample_rate, const double *iq, int n, short *pcm, int max);
+extern int remote_dsp_analyzer(int id);
+
+#endif
@@ -0,0 +1,421 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+/*
+ * Headless rendering benchmark.
+ *
+ * This program links the panadapter, waterfall, meter and VFO bar renderers
+ * (together with the rest of piHPSDR, except main.c) and lets them draw into
+ * offscreen cairo image surfaces. Neither a radio nor a display is needed.
+ *
+ * The panadapter and waterfall are fed with a synthetic spectrum (noise floor
+ * plus some drifting carriers and a keyed CW signal) which is identical from
+ * run to run, or with a spectrum recording (spectrum_rx1.bin in the current
+ * directory, see spectrum_recorder.c) if invoked with -replay.
+ *
+ * For each renderer, the per-call latency (median, 90%, 99%, max) is reported,
+ * and on Linux/glibc also the number of heap allocations per call and the
+ * number of bytes allocated per call.
+ *
+ * Options:
+ *
+ * -width  <n>   width of panadapter and waterfall in pixels (default: 1024)
+ * -height <n>   height of panadapter and waterfall in pixels (default: 200)
+ * -fps    <n>   frame rate (default: 20)
+ * -frames <n>   number of frames to render (default: 1000)
+ * -layout <n>   VFO bar layout (index into vfo_layout_list, default: 0)
+ * -paced        do not render back-to-back but at the given frame rate
+ * -replay       use the spectrum recording of RX1 as input
+ */
+
+#include <gtk/gtk.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "appearance.h"
+#include "band.h"
+#include "filter.h"
+#include "main.h"
+#include "message.h"
+#include "meter.h"
+#include "mode.h"
+#include "radio.h"
+#include "receiver.h"
+#include "rx_panadapter.h"
+#include "spectrum_recorder.h"
+#include "vfo.h"
+#include "waterfall.h"
+
+//
+// Variables and functions otherwise defined in main.c
+//
+GdkScreen *screen;
+int display_width;
+int display_height;
+int screen_height;
+int screen_width;
+int full_screen;
+int this_monitor;
+GtkWidget *top_window = NULL;
+GtkWidget *topgrid;
+gulong keypress_signal_id = 0;
+
+void status_text(const char *text) {
+  t_print("%s\n", text);
+}
+
+gboolean keypress_cb(GtkWidget *widget, GdkEventKey *event, gpointer data) {
+  return FALSE;
+}
+
+int fatal_error(void *data) {
+  t_print("FATAL: %s\n", (const char *) data);
+  exit(1);
+}
+
+//
+// Counting heap allocations. With glibc, malloc/calloc/realloc are
+// replaced by versions that count the calls and the number of bytes
+// requested while counting is enabled, and then call the original ones.
+// This also catches the allocations made within the cairo/pixman/glib
+// shared libraries.
+//
+static volatile int count_allocs = 0;
+static long alloc_calls = 0;
+static long alloc_bytes = 0;
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+  if (count_allocs) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, (long) size, __ATOMIC_RELAXED);
+  }
+
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+  if (count_allocs) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, (long)(nmemb * size), __ATOMIC_RELAXED);
+  }
+
+  return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  if (count_allocs) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, (long) size, __ATOMIC_RELAXED);
+  }
+
+  return __libc_realloc(ptr, size);
+}
+#endif
+
+enum _bench_enum {
+  BENCH_PANADAPTER = 0,
+  BENCH_WATERFALL,
+  BENCH_METER,
+  BENCH_VFO,
+  BENCH_NUM
+};
+
+static const char *bench_names[BENCH_NUM] = {"panadapter", "waterfall", "meter", "vfo"};
+
+typedef struct _bench_stat {
+  long long *ns;        // latency of each call
+  int  calls;
+  long allocs;
+  long bytes;
+} BENCH_STAT;
+
+static BENCH_STAT stats[BENCH_NUM];
+
+static long long now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_ns(const void *a, const void *b) {
+  long long x = *(const long long *) a;
+  long long y = *(const long long *) b;
+  return (x > y) - (x < y);
+}
+
+static void bench_start() {
+  alloc_calls = 0;
+  alloc_bytes = 0;
+  count_allocs = 1;
+}
+
+static void bench_stop(int which, long long t0) {
+  long long t1 = now_ns();
+  count_allocs = 0;
+  BENCH_STAT *s = &stats[which];
+  s->ns[s->calls++] = t1 - t0;
+  s->allocs += alloc_calls;
+  s->bytes += alloc_bytes;
+}
+
+//
+// A simple, deterministic pseudo-random generator (xorshift32)
+//
+static unsigned int rnd_state = 0x12345678;
+
+static float rnd_uniform() {
+  rnd_state ^= rnd_state << 13;
+  rnd_state ^= rnd_state >> 17;
+  rnd_state ^= rnd_state << 5;
+  return (float) rnd_state * (1.0F / 4294967296.0F);
+}
+
+//
+// Synthetic spectrum: noise floor around -125 dBm, a few carriers
+// that slowly drift, and a CW signal that is keyed on and off.
+//
+static void synthetic_frame(float *samples, int pixels, int frame, int fps) {
+  for (int i = 0; i < pixels; i++) {
+    samples[i] = -125.0F + 6.0F * (rnd_uniform() + rnd_uniform() + rnd_uniform() - 1.5F);
+  }
+
+  for (int c = 1; c <= 5; c++) {
+    int pos = (c * pixels) / 6 + (int)(10.0 * sin(0.01 * frame * c));
+    float level = -110.0F + 12.0F * c;
+
+    for (int k = -3; k <= 3; k++) {
+      int i = pos + k;
+
+      if (i >= 0 && i < pixels) {
+        float s = level - 6.0F * k * k;
+
+        if (s > samples[i]) { samples[i] = s; }
+      }
+    }
+  }
+
+  if ((frame / (fps > 4 ? fps / 4 : 1)) & 1) {
+    int pos = pixels / 2 + pixels / 20;
+
+    if (pos < pixels) { samples[pos] = -73.0F; }
+  }
+}
+
+static void report(int which) {
+  BENCH_STAT *s = &stats[which];
+
+  if (s->calls == 0) { return; }
+
+  qsort(s->ns, s->calls, sizeof(long long), cmp_ns);
+  double p50 = 1.0E-3 * s->ns[s->calls / 2];
+  double p90 = 1.0E-3 * s->ns[(s->calls * 90) / 100];
+  double p99 = 1.0E-3 * s->ns[(s->calls * 99) / 100];
+  double max = 1.0E-3 * s->ns[s->calls - 1];
+#ifdef __GLIBC__
+  fprintf(stdout, "%-10s %7d %9.1f %9.1f %9.1f %9.1f %9.1f %11.0f\n", bench_names[which], s->calls,
+          p50, p90, p99, max, (double) s->allocs / s->calls, (double) s->bytes / s->calls);
+#else
+  fprintf(stdout, "%-10s %7d %9.1f %9.1f %9.1f %9.1f %9s %11s\n", bench_names[which], s->calls,
+          p50, p90, p99, max, "n/a", "n/a");
+#endif
+}
+
+int main(int argc, char *argv[]) {
+  int width = 1024;
+  int height = 200;
+  int fps = 20;
+  int frames = 1000;
+  int layout = 0;
+  int paced = 0;
+  int replay = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-width") && i < argc - 1)  { width = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-height") && i < argc - 1) { height = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-fps") && i < argc - 1)    { fps = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-frames") && i < argc - 1) { frames = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-layout") && i < argc - 1) { layout = atoi(argv[++i]); continue; }
+
+    if (!strcmp(argv[i], "-paced"))                  { paced = 1; continue; }
+
+    if (!strcmp(argv[i], "-replay"))                 { replay = 1; continue; }
+
+    t_print("Unknown option: %s\n", argv[i]);
+    t_print("Usage: %s [-width n] [-height n] [-fps n] [-frames n] [-layout n] [-paced] [-replay]\n", argv[0]);
+    exit(1);
+  }
+
+  if (width < 100 || width > SPECREC_MAX_WIDTH) { width = 1024; }
+
+  if (height < 50) { height = 50; }
+
+  if (fps < 1 || fps > 100) { fps = 20; }
+
+  if (frames < 1) { frames = 1000; }
+
+  for (int i = 0; i <= layout; i++) {
+    if (vfo_layout_list[i].width < 0) {
+      t_print("VFO layout %d does not exist, using layout 0\n", layout);
+      layout = 0;
+      break;
+    }
+  }
+
+  //
+  // Minimal radio state: one receiver on 20m USB, no transmitter
+  //
+  vfo_layout = layout;
+  VFO_WIDTH = vfo_layout_list[vfo_layout].width;
+  VFO_HEIGHT = vfo_layout_list[vfo_layout].height;
+  METER_HEIGHT = VFO_HEIGHT;
+  display_width = width;
+  display_height = VFO_HEIGHT + 2 * height;
+  protocol = ORIGINAL_PROTOCOL;
+
+  for (int i = 0; i < MAX_VFOS; i++) {
+    vfo[i].band = band20;
+    vfo[i].bandstack = 0;
+    vfo[i].frequency = 14150000LL;
+    vfo[i].ctun_frequency = vfo[i].frequency;
+    vfo[i].mode = modeUSB;
+    vfo[i].filter = filterF5;
+    vfo[i].step = 100;
+    vfo[i].rit_step = 10;
+  }
+
+  RECEIVER *rx = g_new0(RECEIVER, 1);
+  rx->id = 0;
+  rx->adc = 0;
+  rx->sample_rate = 192000;
+  rx->width = width;
+  rx->height = 2 * height;
+  rx->zoom = 1;
+  rx->pan = 0;
+  rx->pixels = width;
+  rx->fps = fps;
+  rx->hz_per_pixel = (double) rx->sample_rate / (double) rx->pixels;
+  rx->filter_low = 150;
+  rx->filter_high = 2850;
+  rx->panadapter_high = -40;
+  rx->panadapter_low = -140;
+  rx->panadapter_step = 20;
+  rx->panadapter_peaks_on = 1;
+  rx->panadapter_num_peaks = 4;
+  rx->panadapter_ignore_range_divider = 20;
+  rx->panadapter_ignore_noise_percentile = 80;
+  rx->waterfall_high = -100;
+  rx->waterfall_low = -150;
+  rx->waterfall_automatic = 1;
+  rx->display_filled = 1;
+  rx->display_gradient = 1;
+  rx->display_panadapter = 1;
+  rx->display_waterfall = 1;
+  rx->displaying = 1;
+  receiver[0] = rx;
+  receivers = 1;
+  active_receiver = rx;
+  rx_panadapter_init_offscreen(rx, width, height);
+  waterfall_init_offscreen(rx, width, height);
+  meter_init_offscreen();
+  vfo_init_offscreen(VFO_WIDTH, VFO_HEIGHT);
+  float *samples = g_new(float, rx->pixels);
+
+  if (replay && !spectrum_replay_start(rx)) {
+    t_print("No spectrum recording found for RX1\n");
+    exit(1);
+  }
+
+  for (int i = 0; i < BENCH_NUM; i++) {
+    stats[i].ns = g_new(long long, frames);
+  }
+
+  t_print("Rendering %d frames, width=%d height=%d fps=%d VFO layout=%d (%dx%d)%s%s\n",
+          frames, width, height, fps, vfo_layout, VFO_WIDTH, VFO_HEIGHT,
+          paced ? " paced" : "", replay ? " from recording" : "");
+  long long period = 1000000000LL / fps;
+  long long next = now_ns();
+  long long t0;
+
+  for (int frame = 0; frame < frames; frame++) {
+    if (replay) {
+      if (!spectrum_replay_next_frame(rx)) {
+        // end of the recording: start over
+        if (!spectrum_replay_start(rx) || !spectrum_replay_next_frame(rx)) { break; }
+      }
+    } else {
+      synthetic_frame(samples, rx->pixels, frame, fps);
+      rx->pixel_samples = samples;
+    }
+
+    //
+    // Let the VFO slowly move such that the waterfall has to shift
+    //
+    if (frame % fps == 0) {
+      vfo[0].frequency += 500;
+      vfo[0].ctun_frequency = vfo[0].frequency;
+    }
+
+    bench_start();
+    t0 = now_ns();
+    rx_panadapter_update(rx);
+    bench_stop(BENCH_PANADAPTER, t0);
+    bench_start();
+    t0 = now_ns();
+    waterfall_update(rx);
+    bench_stop(BENCH_WATERFALL, t0);
+    bench_start();
+    t0 = now_ns();
+    meter_update(rx, SMETER, -73.0 + 10.0 * sin(0.05 * frame), 0.0, 0.0);
+    bench_stop(BENCH_METER, t0);
+    bench_start();
+    t0 = now_ns();
+    vfo_update();
+    bench_stop(BENCH_VFO, t0);
+
+    if (paced) {
+      next += period;
+      long long wait = next - now_ns();
+
+      if (wait > 0) { usleep((useconds_t)(wait / 1000)); }
+    }
+  }
+
+  fprintf(stdout, "%-10s %7s %9s %9s %9s %9s %9s %11s\n", "renderer", "calls",
+          "p50(us)", "p90(us)", "p99(us)", "max(us)", "allocs", "bytes");
+
+  for (int i = 0; i < BENCH_NUM; i++) {
+    report(i);
+  }
+
+  if (replay) { spectrum_replay_stop(rx); }
+
+  return 0;
+}
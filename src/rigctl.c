@@ -44,7 +44,11 @@
 #include "band.h"
 #include "band_menu.h"
 #include "bandstack.h"
+#include "catdef.h"
+#include "catdef_ids.h"
 #include "channel.h"
+#include "command_queue.h"
+#include "cw_timeline.h"
 #include "ext.h"
 #include "filter.h"
 #include "filter_menu.h"
@@ -57,6 +61,7 @@
 #include "new_menu.h"
 #include "new_protocol.h"
 #include "noise_menu.h"
+#include "notify.h"
 #include "old_protocol.h"
 #include "property.h"
 #include "radio.h"
@@ -70,7 +75,6 @@
 #include "vfo.h"
 #include "zoompan.h"
 
-
 unsigned int rigctl_tcp_port = 19090;
 int rigctl_tcp_enable = 0;
 int rigctl_tcp_andromeda = 0;
@@ -79,13 +83,33 @@ int rigctl_tcp_autoreporting = 0;
 // max number of bytes we can get at once
 #define MAXDATASIZE 2000
 
+//
+// CAT commands are passed from the thread reading them to the GTK
+// thread through a per-client command queue of pre-allocated slots.
+// All commands that have arrived are processed in one go, and their
+// replies are collected and sent with a single write().
+//
+#define CAT_RING_SIZE      64     // commands waiting for the GTK thread
+#define CAT_COMMAND_SIZE   256    // max. length of a CAT command (longer ones are truncated)
+#define CAT_REPLY_SIZE     4096   // replies collected before sending
+#define CAT_STATS_INTERVAL 10     // seconds between statistics reports (if rigctl_debug)
+#define CAT_CACHE_SIZE     16     // queries whose replies are shared by all clients
+#define CAT_CACHE_WINDOW   50000  // usec a shared reply remains valid
+
 gboolean rigctl_debug = FALSE;
 
-static int parse_cmd (void *data);
+typedef struct _client CLIENT;
+static void parse_cmd (CLIENT *client, const CATDEF *def, char *command);
+static void cat_init(CLIENT *client);
+static void autoreport_ref();
+static void autoreport_unref();
+static void cat_cache_flush();
 
 int cat_control = 0;
 
 static GMutex mutex_numcat;   // only needed to make in/de-crements of "cat_control"  atomic
+static int autoreport_notify = 0;
+static int autoreport_users = 0;  // protected by mutex_numcat
 
 #define MAX_TCP_CLIENTS 3
 #define MAX_ANDROMEDA_LEDS 16
@@ -97,7 +121,14 @@ static int tcp_running = 0;
 static int server_socket = -1;
 static struct sockaddr_in server_address;
 
-typedef struct _client {
+typedef struct _cat_command {
+  CLIENT *client;
+  gint64 time;                      // time of reception (usec)
+  const CATDEF *def;                // NULL if the command is not documented
+  char command[CAT_COMMAND_SIZE];
+} CAT_COMMAND;
+
+struct _client {
   int fd;
   int fifo;                         // serial only: this is a FIFO and not a true serial line
   int busy;                         // serial only (for FIFO handling)
@@ -107,7 +138,7 @@ typedef struct _client {
   struct sockaddr_in address;       // TCP only: initialised by accept(), never used
   GThread *thread_id;               // ID of thread that serves the client
   guint andromeda_timer;            // for reporting ANDROMEDA LED states
-  guint auto_timer;                 // for auto-reporting FA/FB
+  int auto_ref;                     // holds a reference to the shared auto-reporter
   int auto_reporting;               // auto-reporting (AI, ZZAI) 0...3
   int andromeda_type;               // 1:Andromeda, 4:G2Mk1 with CM5 upgrade, 5:G2 ultra
   int last_v;                       // Last push-button state received
@@ -116,7 +147,37 @@ typedef struct _client {
   int shift;                        // shift state for original ANDROMEDA console
   int *buttonvec;                   // For G2 ANDROMEDA: button action map
   int *encodervec;                  // For G2 ANDROMEDA: encoder action map
-} CLIENT;
+  //
+  // Commands, assembled in the slots by the reading thread and handed
+  // over to the GTK thread through the queue
+  //
+  CAT_COMMAND slots[CAT_RING_SIZE];
+  COMMAND_QUEUE commands;
+  int received;                     // commands queued so far (reading thread only)
+  int cmd_len;                      // length of the command being received
+  //
+  // Replies and the batch being processed, only accessed from the GTK thread
+  //
+  int batching;                     // collect replies until the batch is done
+  int reply_len;
+  char reply[CAT_REPLY_SIZE];
+  int batch_commands;
+  int batch_cached;                 // replies taken from the shared cache
+  gint64 batch_first;               // time of reception of the first command
+  gint64 batch_sum;                 // sum of the times of reception
+  gint64 batch_now;                 // time the batch started
+  //
+  // Statistics, updated by the GTK thread and (for queries answered
+  // from the snapshot) by the reading thread
+  //
+  GMutex stats_mutex;
+  gint64 stats_start;
+  int stats_commands;
+  gint64 stats_latency;             // sum of latencies (usec)
+  gint64 stats_max_latency;
+  int stats_cached;                 // queries answered from the shared cache
+  int stats_fast;                   // queries answered from the snapshot
+};
 
 //
 // A G2V2 VFO encoder has 480 ticks per revolution and reports the number of ticks
@@ -135,11 +196,6 @@ static uint8_t andromeda_vfo_speedup[32] = {  0,   1,   2,   3,   4,   5,   6,
                                               25,  29,  33,  38,  43,  48,  54,  61,
                                               69,  77,  85,  95, 105, 116, 128,   4
                                            };
-typedef struct _command {
-  CLIENT *client;
-  char *command;
-} COMMAND;
-
 static CLIENT tcp_client[MAX_TCP_CLIENTS]; // TCP clients
 static CLIENT serial_client[MAX_SERIAL];   // serial clienta
 SERIALPORT SerialPorts[MAX_SERIAL];
@@ -175,9 +231,9 @@ void shutdown_tcp_rigctl() {
       tcp_client[id].andromeda_timer = 0;
     }
 
-    if (tcp_client[id].auto_timer != 0) {
-      g_source_remove(tcp_client[id].auto_timer);
-      tcp_client[id].auto_timer = 0;
+    if (tcp_client[id].auto_ref) {
+      tcp_client[id].auto_ref = 0;
+      autoreport_unref();
     }
 
     tcp_client[id].running = 0;
@@ -220,7 +276,6 @@ void shutdown_tcp_rigctl() {
 //
 
 #define CW_BUF_SIZE 80
-#define NSEC_PER_SEC 1000000000L
 static char cw_buf[CW_BUF_SIZE];
 static int  cw_buf_in = 0, cw_buf_out = 0;
 
@@ -228,64 +283,30 @@ static int dotsamples;
 static int dashsamples;
 
 //
-// send_dash()         send a "key-down" of a dashlen, followed by a "key-up" of a dotlen
-// send_dot()          send a "key-down" of a dotlen,  followed by a "key-up" of a dotlen
-// send_space(int len) send a "key_down" of zero,      followed by a "key-up" of len*dotlen
+// Put a character into the CW ring buffer. This is only done
+// in the GTK thread (CAT KY command, TCI cw_macros).
 //
-//
-static void send_dash() {
-  struct timespec ts;
-
-  if (cw_key_hit) { return; }
-
-  clock_gettime(CLOCK_MONOTONIC, &ts);
-  tx_queue_cw_event(1, 0);
-  tx_queue_cw_event(0, dashsamples);
-  tx_queue_cw_event(0, dotsamples);
-  ts.tv_nsec += (dashsamples + dotsamples) * 20833;
-
-  while (ts.tv_nsec > NSEC_PER_SEC) {
-    ts.tv_nsec -= NSEC_PER_SEC;
-    ts.tv_sec++;
-  }
-
-  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
-}
-
-static void send_dot() {
-  struct timespec ts;
-
-  if (cw_key_hit) { return; }
+static void cw_buf_put(char c) {
+  int new = cw_buf_in + 1;
 
-  clock_gettime(CLOCK_MONOTONIC, &ts);
-  tx_queue_cw_event(1, 0);
-  tx_queue_cw_event(0, dotsamples);
-  tx_queue_cw_event(0, dotsamples);
-  ts.tv_nsec += (2 * dotsamples) * 20833;
+  if (new >= CW_BUF_SIZE) { new = 0; }
 
-  while (ts.tv_nsec > NSEC_PER_SEC) {
-    ts.tv_nsec -= NSEC_PER_SEC;
-    ts.tv_sec++;
+  if (new != cw_buf_out) {
+    cw_buf[cw_buf_in] = c;
+    cw_buf_in = new;
   }
-
-  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
 }
 
-static void send_space(int len) {
-  struct timespec ts;
-
+//
+// CAT CW is keyed along a sample-clocked timeline, see cw_timeline.h
+// cw_element(down, up) sends a "key-down" of "down" samples followed
+// by a "key-up" of "up" samples. If down is zero, it only produces a
+// pause.
+//
+static void cw_element(int down, int up) {
   if (cw_key_hit) { return; }
 
-  clock_gettime(CLOCK_MONOTONIC, &ts);
-  tx_queue_cw_event(0, len * dotsamples);
-  ts.tv_nsec += (len * dotsamples) * 20833;
-
-  while (ts.tv_nsec > NSEC_PER_SEC) {
-    ts.tv_nsec -= NSEC_PER_SEC;
-    ts.tv_sec++;
-  }
-
-  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+  cw_timeline_element(down, up);
 }
 
 //
@@ -537,11 +558,11 @@ static void rigctl_send_cw_char(char cw_char) {
 
   while (*pattern != '\0') {
     if (*pattern == '-') {
-      send_dash();
+      cw_element(dashsamples, dotsamples);
     }
 
     if (*pattern == '.') {
-      send_dot();
+      cw_element(dotsamples, dotsamples);
     }
 
     pattern++;
@@ -555,9 +576,9 @@ static void rigctl_send_cw_char(char cw_char) {
   // We need no longer take care of a sequence of spaces since adjacent spaces
   // are now filtered out while filling the CW character (ring-) buffer.
   if (cw_char == ' ') {
-    send_space(6);  // produce inter-word space of 7 dotlens
+    cw_element(0, 6 * dotsamples);  // produce inter-word space of 7 dotlens
   } else {
-    if (!join_cw_characters) { send_space(2); }  // produce inter-character space of 3 dotlens
+    if (!join_cw_characters) { cw_element(0, 2 * dotsamples); }  // produce inter-character space of 3 dotlens
   }
 }
 
@@ -651,6 +672,8 @@ static gpointer rigctl_cw_thread(gpointer data) {
       dashsamples = (3456 * cw_keyer_weight) / cw_keyer_speed;
     }
 
+    if (!CAT_cw_is_active) { cw_timeline_start(tx_queue_cw_event); }
+
     CAT_cw_is_active = 1;
 
     if (!radio_is_remote) { schedule_transmit_specific(); }
@@ -713,6 +736,15 @@ static gpointer rigctl_cw_thread(gpointer data) {
 
       if (cw_buf_in != cw_buf_out) { continue; }
 
+      cw_timeline_drain();
+
+      if (rigctl_debug) {
+        long max_late;
+        int underruns;
+        cw_timeline_stats(&max_late, &underruns);
+        t_print("%s: max. wakeup latency %ld samples, %d underruns\n", __FUNCTION__, max_late, underruns);
+      }
+
       CAT_cw_is_active = 0;
 
       if (!radio_is_remote) { schedule_transmit_specific(); }
@@ -749,11 +781,21 @@ static gpointer rigctl_cw_thread(gpointer data) {
   return NULL;
 }
 
-static void send_resp (int fd, char * msg) {
-  //
-  // send_resp is ONLY called from within the GTK event queue
-  // ==> no multi-thread problems can occur.
-  //
+//
+// Send CW text that does not come from a CAT client (TCI cw_macros)
+// through the CAT CW machinery. This must be called in the GTK thread.
+//
+void rigctl_send_cw_text(const char *text) {
+  if (!rigctl_cw_thread_id) { rigctl_cw_thread_id = g_thread_new("RIGCTL cw", rigctl_cw_thread, NULL); }
+
+  while (*text) {
+    cw_buf_put(*text++);
+  }
+}
+
+static void cat_write (int fd, const char *msg, int length) {
+  int count = 0;
+
   if (fd == -1) {
     //
     // This means the client fd has been explicitly closed
@@ -763,14 +805,9 @@ static void send_resp (int fd, char * msg) {
     return;
   }
 
-  if (rigctl_debug) { t_print("RIGCTL: RESP=%s\n", msg); }
-
-  int length = strlen(msg);
-  int count = 0;
-
   while (length > 0) {
     //
-    // Since this is in the GTK event queue, we cannot try
+    // Since this may be in the GTK event queue, we cannot try
     // for a long time. In case of an error (rc < 0) we give
     // up immediately, for rc == 0 we try at most 10 times.
     //
@@ -789,6 +826,45 @@ static void send_resp (int fd, char * msg) {
   }
 }
 
+static void send_flush (CLIENT *client) {
+  //
+  // Write out the collected replies. This is ONLY called
+  // from within the GTK event queue.
+  //
+  int length = client->reply_len;
+  client->reply_len = 0;
+  cat_write(client->fd, client->reply, length);
+}
+
+static void send_resp (CLIENT *client, const char * msg) {
+  //
+  // send_resp is ONLY called from within the GTK event queue
+  // ==> no multi-thread problems can occur.
+  // While a batch of commands is processed, the replies are
+  // collected and sent together when the batch is done.
+  //
+  if (client->fd == -1) {
+    return;
+  }
+
+  if (rigctl_debug) { t_print("RIGCTL: RESP=%s\n", msg); }
+
+  int length = strlen(msg);
+
+  if (length > CAT_REPLY_SIZE) { return; }
+
+  if (client->reply_len + length > CAT_REPLY_SIZE) {
+    send_flush(client);
+  }
+
+  memcpy(client->reply + client->reply_len, msg, length);
+  client->reply_len += length;
+
+  if (!client->batching) {
+    send_flush(client);
+  }
+}
+
 static int wdspmode(int kenwoodmode) {
   int wdspmode;
 
@@ -880,58 +956,271 @@ static int ts2000_mode(int wdspmode) {
   return kenwoodmode;
 }
 
-static gboolean autoreport_handler(gpointer data) {
-  CLIENT *client = (CLIENT *) data;
-  //
-  // This function is repeatedly called as long as the CAT
-  // connection is active. It reports VFOA and VFOB frequency changes
-  // to the client, provided it has auto-reporting enabled and is running.
-  //
-  // Note this runs in the GTK event queue so it cannot interfere
-  // with another CAT command.
-  // Auto-reporting to a FIFO is suppressed because all data sent there will
-  // be echoed back and then be read again.
-  //
+//
+// Read-only queries (FA, FB, IF, MD, SM, ...) are answered directly
+// in the thread reading from the client, from a snapshot of the radio
+// state. This way, they are not delayed by a busy GTK thread.
+// The snapshot is written only in the GTK thread (upon state changes,
+// after each batch of CAT commands, and periodically for the S-meter)
+// and published with a sequence counter: it is odd while the snapshot
+// is being written, and zero if the snapshot is not valid.
+//
+typedef struct _cat_state {
+  long long fa, fb;                 // VFO-A/B frequency (CTUN frequency if CTUN)
+  int mode_a;                       // VFO-A mode
+  int step_a;
+  long long rit_a;
+  int rit_enabled_a;
+  int xit_enabled;                  // of the TX VFO
+  int ctcss_enabled;
+  int ctcss;
+  int split;
+  int mox;
+  int transmitting;
+  int receivers;
+  int smeter[2];                    // 0 ... 30
+} CAT_STATE;
+
+static CAT_STATE cat_state;
+static volatile gint cat_state_seq = 0;
+static guint cat_state_timer = 0;
+static int cat_state_notify = 0;
+
+static void cat_state_fill(CAT_STATE *s) {
+  s->fa = vfo[VFO_A].ctun ? vfo[VFO_A].ctun_frequency : vfo[VFO_A].frequency;
+  s->fb = vfo[VFO_B].ctun ? vfo[VFO_B].ctun_frequency : vfo[VFO_B].frequency;
+  s->mode_a = vfo[VFO_A].mode;
+  s->step_a = vfo[VFO_A].step;
+  s->rit_a = vfo[VFO_A].rit;
+  s->rit_enabled_a = vfo[VFO_A].rit_enabled;
+  s->xit_enabled = 0;
+  s->ctcss_enabled = 0;
+  s->ctcss = 0;
+
+  if (can_transmit) {
+    s->xit_enabled   = vfo[vfo_get_tx_vfo()].xit_enabled;
+    s->ctcss         = transmitter->ctcss + 1;
+    s->ctcss_enabled = transmitter->ctcss_enabled;
+  }
+
+  s->split = split;
+  s->mox = mox;
+  s->transmitting = radio_is_transmitting();
+  s->receivers = receivers;
+
+  for (int id = 0; id < 2; id++) {
+    int val = 0;
+
+    if (id < receivers) {
+      val = (int)((receiver[id]->meter + 127.0) * 0.277778);
+
+      if (val > 30) { val = 30; }
+
+      if (val < 0 ) { val = 0; }
+    }
+
+    s->smeter[id] = val;
+  }
+}
+
+static void cat_state_update() {
+  g_atomic_int_inc(&cat_state_seq);
+  cat_state_fill(&cat_state);
+  g_atomic_int_inc(&cat_state_seq);
+}
+
+static int cat_state_get(CAT_STATE *s) {
+  for (int tries = 0; tries < 10; tries++) {
+    int seq = g_atomic_int_get(&cat_state_seq);
+
+    if (seq == 0) { return 0; }
 
-  if (client->fifo || !client->running) {
+    if (seq & 1) { continue; }
+
+    memcpy(s, &cat_state, sizeof(CAT_STATE));
+
+    if (g_atomic_int_get(&cat_state_seq) == seq) { return 1; }
+  }
+
+  return 0;
+}
+
+static void cat_state_changed(int changes, gpointer data) {
+  cat_state_update();
+  cat_cache_flush();
+}
+
+static gboolean cat_state_tick(gpointer data) {
+  if (cat_control == 0) {
     //
-    // return and remove timer
+    // No more CAT clients: invalidate the snapshot and stop
     //
-    client->auto_timer = 0;
+    g_atomic_int_set(&cat_state_seq, 0);
+    notify_unsubscribe(cat_state_notify);
+    cat_state_notify = 0;
+    cat_state_timer = 0;
     return G_SOURCE_REMOVE;
   }
 
-  if (client->auto_reporting > 0) {
-    long long fa = vfo[VFO_A].ctun ? vfo[VFO_A].ctun_frequency : vfo[VFO_A].frequency;
-    long long fb = vfo[VFO_B].ctun ? vfo[VFO_B].ctun_frequency : vfo[VFO_B].frequency;
+  cat_state_update();
+  return G_SOURCE_CONTINUE;
+}
 
-    if (fa != client->last_fa) {
-      char reply[256];
-      snprintf(reply,  sizeof(reply), "FA%011lld;", fa);
-      send_resp(client->fd, reply);
-      client->last_fa = fa;
-    }
+//
+// Called through the GTK queue when a CAT client thread starts
+//
+static int cat_state_start(void *data) {
+  if (cat_state_timer == 0) {
+    cat_state_notify = notify_subscribe(NOTIFY_ALL, cat_state_changed, NULL);
+    cat_state_timer = g_timeout_add(100, cat_state_tick, NULL);
+    cat_state_update();
+  }
 
-    if (fb != client->last_fb) {
-      char reply[256];
-      snprintf(reply,  sizeof(reply), "FB%011lld;", fb);
-      send_resp(client->fd, reply);
-      client->last_fb = fb;
-    }
+  return G_SOURCE_REMOVE;
+}
+
+static void cat_format_if(char *reply, size_t len, const CAT_STATE *s) {
+  snprintf(reply,  len, "IF%011lld%04d%+06lld%d%d%d%02d%d%d%d%d%d%d%02d%d;",
+           s->fa, s->step_a, s->rit_a, s->rit_enabled_a, s->xit_enabled,
+           0, 0, s->transmitting, ts2000_mode(s->mode_a), 0, 0, s->split,
+           s->ctcss_enabled ? 2 : 0, s->ctcss, 0);
+}
+
+//
+// Try to answer a query from the snapshot. Returns the length
+// of the reply, or zero if the command must go to parse_cmd().
+//
+static int cat_fast_query(const CATDEF *def, const char *command, char *reply, size_t len) {
+  CAT_STATE s;
+
+  if (def == NULL || def->readlen != (int) strlen(command) || !cat_state_get(&s)) { return 0; }
+
+  switch (def->id) {
+  case CAT_FA:
+    snprintf(reply, len, "FA%011lld;", s.fa);
+    break;
+
+  case CAT_FB:
+    snprintf(reply, len, "FB%011lld;", s.fb);
+    break;
+
+  case CAT_ZZFA:
+    snprintf(reply, len, "ZZFA%011lld;", s.fa);
+    break;
+
+  case CAT_ZZFB:
+    snprintf(reply, len, "ZZFB%011lld;", s.fb);
+    break;
+
+  case CAT_IF:
+    cat_format_if(reply, len, &s);
+    break;
+
+  case CAT_MD:
+    snprintf(reply, len, "MD%d;", ts2000_mode(s.mode_a));
+    break;
+
+  case CAT_ZZMD:
+    snprintf(reply, len, "ZZMD%02d;", s.mode_a);
+    break;
+
+  case CAT_FT:
+    snprintf(reply, len, "FT%d;", s.split);
+    break;
+
+  case CAT_ZZTX:
+    snprintf(reply, len, "ZZTX%d;", s.mox);
+    break;
+
+  case CAT_ID:
+    snprintf(reply, len, "ID019;");
+    break;
+
+  case CAT_SM:
+    if ((command[2] != '0' && command[2] != '1') || command[2] - '0' >= s.receivers) { return 0; }
+
+    snprintf(reply, len, "SM%d%04d;", command[2] - '0', s.smeter[command[2] - '0']);
+    break;
+
+  default:
+    return 0;
   }
 
-  if (client->auto_reporting > 1) {
-    int md = vfo[VFO_A].mode;
+  return strlen(reply);
+}
+
+//
+// There is a single auto-reporter shared by all clients. Upon a VFO
+// or mode change, the reports are formatted once and sent to each
+// client that has auto-reporting enabled and has not yet seen the
+// new value.
+// Note this runs in the GTK event queue so it cannot interfere
+// with another CAT command.
+//
+static void autoreport_handler(int changes, gpointer data) {
+  long long fa = vfo[VFO_A].ctun ? vfo[VFO_A].ctun_frequency : vfo[VFO_A].frequency;
+  long long fb = vfo[VFO_B].ctun ? vfo[VFO_B].ctun_frequency : vfo[VFO_B].frequency;
+  int md = vfo[VFO_A].mode;
+  char fa_reply[32];
+  char fb_reply[32];
+  char md_reply[32];
+  snprintf(fa_reply,  sizeof(fa_reply), "FA%011lld;", fa);
+  snprintf(fb_reply,  sizeof(fb_reply), "FB%011lld;", fb);
+  snprintf(md_reply,  sizeof(md_reply), "MD%1d;", ts2000_mode(md));
+
+  for (int i = 0; i < MAX_TCP_CLIENTS + MAX_SERIAL; i++) {
+    CLIENT *client = (i < MAX_TCP_CLIENTS) ? &tcp_client[i] : &serial_client[i - MAX_TCP_CLIENTS];
+
+    //
+    // Auto-reporting to a FIFO is suppressed because all data sent there will
+    // be echoed back and then be read again.
+    //
+    if (client->fifo || !client->running) {
+      continue;
+    }
+
+    if (client->auto_reporting > 0) {
+      if (fa != client->last_fa) {
+        send_resp(client, fa_reply);
+        client->last_fa = fa;
+      }
+
+      if (fb != client->last_fb) {
+        send_resp(client, fb_reply);
+        client->last_fb = fb;
+      }
+    }
 
-    if (md != client->last_md) {
-      char reply[256];
-      snprintf(reply,  sizeof(reply), "MD%1d;", ts2000_mode(md));
-      send_resp(client->fd, reply);
+    if (client->auto_reporting > 1 && md != client->last_md) {
+      send_resp(client, md_reply);
       client->last_md = md;
     }
   }
+}
 
-  return TRUE;
+//
+// The auto-reporter is subscribed as long as there are clients.
+// These functions may be called from any thread.
+//
+static void autoreport_ref() {
+  g_mutex_lock(&mutex_numcat);
+
+  if (autoreport_users++ == 0) {
+    autoreport_notify = notify_subscribe(NOTIFY_VFO | NOTIFY_MODE, autoreport_handler, NULL);
+  }
+
+  g_mutex_unlock(&mutex_numcat);
+}
+
+static void autoreport_unref() {
+  g_mutex_lock(&mutex_numcat);
+
+  if (--autoreport_users == 0) {
+    notify_unsubscribe(autoreport_notify);
+    autoreport_notify = 0;
+  }
+
+  g_mutex_unlock(&mutex_numcat);
 }
 
 static gboolean andromeda_handler(gpointer data) {
@@ -958,7 +1247,7 @@ static gboolean andromeda_handler(gpointer data) {
   //
   if (client->andromeda_type < 1) {
     snprintf(reply,  sizeof(reply), "ZZZS;");
-    send_resp(client->fd, reply);
+    send_resp(client, reply);
     return TRUE;
   }
 
@@ -1073,7 +1362,7 @@ static gboolean andromeda_handler(gpointer data) {
     //
     if (client->last_led[led] != new) {
       snprintf(reply,  sizeof(reply), "ZZZI%02d%d;", led, new);
-      send_resp(client->fd, reply);
+      send_resp(client, reply);
       client->last_led[led] = new;
     }
   }
@@ -1202,19 +1491,22 @@ static gpointer rigctl_server(gpointer data) {
     tcp_client[spare].shift           = 0;
     tcp_client[spare].buttonvec       = NULL;
     tcp_client[spare].encodervec      = NULL;
+    cat_init(&tcp_client[spare]);
 
     for (int i = 0; i < MAX_ANDROMEDA_LEDS; i++) {
       tcp_client[spare].last_led[i] = -1;
     }
 
     //
-    // Spawn off thread that "does" the connection
+    // Make sure the auto-reporter is subscribed to state changes
     //
-    tcp_client[spare].thread_id       = g_thread_new("rigctl client", rigctl_client, (gpointer)&tcp_client[spare]);
+    tcp_client[spare].auto_ref = 1;
+    autoreport_ref();
+    notify_changed(NOTIFY_VFO | NOTIFY_MODE);
     //
-    // Launch auto-reporter task
+    // Spawn off thread that "does" the connection
     //
-    tcp_client[spare].auto_timer = g_timeout_add(750, autoreport_handler, &tcp_client[spare]);
+    tcp_client[spare].thread_id       = g_thread_new("rigctl client", rigctl_client, (gpointer)&tcp_client[spare]);
 
     //
     // If ANDROMEDA is enabled for TCP, lauch periodic ANDROMEDA task
@@ -1229,576 +1521,373 @@ static gpointer rigctl_server(gpointer data) {
   return NULL;
 }
 
-static gpointer rigctl_client (gpointer data) {
-  CLIENT *client = (CLIENT *)data;
-  t_print("%s: starting rigctl_client: socket=%d\n", __FUNCTION__, client->fd);
-  g_mutex_lock(&mutex_numcat);
-  cat_control++;
-
-  if (rigctl_debug) { t_print("RIGCTL: CTLA INC cat_control=%d\n", cat_control); }
+//
+// Report commands/sec and latency (from reception to sending the reply)
+//
+static void cat_stats(CLIENT *client, gint64 now) {
+  g_mutex_lock(&client->stats_mutex);
+  double secs = 1.0E-6 * (now - client->stats_start);
+
+  if (client->stats_commands > 0 && secs > 0.0) {
+    t_print("%s: client fd=%d: %.1f commands/sec (%d from snapshot), latency avg=%lld max=%lld usec, %d shared replies\n",
+            __FUNCTION__, client->fd, client->stats_commands / secs, client->stats_fast,
+            client->stats_latency / client->stats_commands, client->stats_max_latency, client->stats_cached);
+  }
 
-  g_mutex_unlock(&mutex_numcat);
-  g_idle_add(ext_vfo_update, NULL);
-  int i;
-  int numbytes;
-  char  cmd_input[MAXDATASIZE] ;
-  char *command = g_new(char, MAXDATASIZE);
-  int command_index = 0;
+  client->stats_start = now;
+  client->stats_commands = 0;
+  client->stats_latency = 0;
+  client->stats_max_latency = 0;
+  client->stats_cached = 0;
+  client->stats_fast = 0;
+  g_mutex_unlock(&client->stats_mutex);
+}
 
-  while (client->running && (numbytes = recv(client->fd, cmd_input, MAXDATASIZE - 2, 0)) > 0 ) {
-    for (i = 0; i < numbytes; i++) {
-      //
-      // Filter out newlines and other non-printable characters
-      // These may occur when doing CAT manually with a terminal program
-      //
-      if (cmd_input[i] < 32) {
-        continue;
-      }
+//
+// Account for n commands whose replies have just been sent. "first" is
+// the earliest time of reception and "sum" the sum of all of them, "fast"
+// and "cached" count the replies taken from the snapshot and the cache.
+//
+static void cat_stats_add(CLIENT *client, int n, gint64 first, gint64 sum, int fast, int cached) {
+  gint64 now = g_get_monotonic_time();
+  g_mutex_lock(&client->stats_mutex);
+  client->stats_commands += n;
+  client->stats_latency += n * now - sum;
+  client->stats_fast += fast;
+  client->stats_cached += cached;
 
-      command[command_index] = cmd_input[i];
-      command_index++;
+  if (now - first > client->stats_max_latency) { client->stats_max_latency = now - first; }
 
-      if (cmd_input[i] == ';') {
-        command[command_index] = '\0';
+  int report = rigctl_debug && now - client->stats_start > CAT_STATS_INTERVAL * 1000000LL;
+  g_mutex_unlock(&client->stats_mutex);
 
-        if (rigctl_debug) { t_print("RIGCTL: command=%s\n", command); }
+  if (report) { cat_stats(client, now); }
+}
 
-        COMMAND *info = g_new(COMMAND, 1);
-        info->client = client;
-        info->command = command;
-        g_idle_add(parse_cmd, info);
-        command = g_new(char, MAXDATASIZE);
-        command_index = 0;
-      }
-    }
+//
+// If several clients (say, a logger, an amplifier and a rotator
+// controller) poll the radio, they mostly send the same queries.
+// Queries that have to be processed in the GTK thread are therefore
+// evaluated only once within a short time window, and the reply is
+// shared by all clients. The shared replies are dropped upon any state
+// change reported through the notification bus, and whenever a command
+// other than a shareable query has been processed.
+//
+// A command is a query if its length matches the documented READ form.
+// Replies to some queries depend on the client and are never shared.
+//
+typedef struct _cat_cached {
+  gint64 time;                      // zero if the entry is not valid
+  char command[16];
+  char reply[64];
+  int reply_len;
+} CAT_CACHED;
+
+static CAT_CACHED cat_cache[CAT_CACHE_SIZE];
+static int cat_cache_next = 0;      // entry to be replaced next
+
+static void cat_cache_flush() {
+  for (int i = 0; i < CAT_CACHE_SIZE; i++) {
+    cat_cache[i].time = 0;
   }
+}
 
-  // Release the last "command" buffer (that has not yet been used)
-  g_free(command);
-  t_print("%s: Leaving rigctl_client thread\n", __FUNCTION__);
+static int cat_cache_shareable(const CATDEF *def, const char *command) {
+  int len = strlen(command);
 
-  //
-  // If rigctl is disabled via the GUI, the connections are closed by shutdown_rigctl_ports()
-  // but even the we should decrement cat_control
-  //
-  if (client->fd != -1) {
-    struct linger linger = { 0 };
-    linger.l_onoff = 1;
-    linger.l_linger = 0;
+  if (def == NULL || def->readlen != len || len >= (int) sizeof(cat_cache[0].command)) { return 0; }
 
-    if (setsockopt(client->fd, SOL_SOCKET, SO_LINGER, (const char *)&linger, sizeof(linger)) == -1) {
-      t_perror("setsockopt(...,SO_LINGER,...) failed for client:");
-    }
+  return def->id != CAT_AI && def->id != CAT_ZZAI && def->id != CAT_KY;
+}
 
-    if (client->andromeda_timer != 0) {
-      g_source_remove(client->andromeda_timer);
-      client->andromeda_timer = 0;
-    }
+static CAT_CACHED *cat_cache_find(const char *command, gint64 now) {
+  for (int i = 0; i < CAT_CACHE_SIZE; i++) {
+    CAT_CACHED *entry = &cat_cache[i];
 
-    if (client->auto_timer != 0) {
-      g_source_remove(client->auto_timer);
-      client->auto_timer = 0;
+    if (entry->time != 0 && now - entry->time < CAT_CACHE_WINDOW && !strcmp(entry->command, command)) {
+      return entry;
     }
-
-    client->running = 0;
-    close(client->fd);
-    client->fd = -1;
   }
 
-  // Decrement CAT_CONTROL
-  g_mutex_lock(&mutex_numcat);
-  cat_control--;
-  g_mutex_unlock(&mutex_numcat);
-  g_idle_add(ext_vfo_update, NULL);
   return NULL;
 }
 
-static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
-  gboolean implemented = TRUE;
-  char reply[256];
-  reply[0] = '\0';
-
-  switch (command[2]) {
-  case 'A': //ZZAx
-    switch (command[3]) {
-    case 'C': //ZZAC
-
-      //CATDEF    ZZAC
-      //DESCR     Set/read VFO-A step size
-      //SET       ZZACxx;
-      //READ      ZZAC;
-      //RESP      ZZACxx;
-      //NOTE      x 0...16 encodes the step size:
-      //NOTE      1 Hz (x=0), 10 Hz (x=1), 25 Hz (x=2), 50 Hz (x=3)
-      //CONT      100 Hz (x=4), 250 Hz (x=5), 500 Hz (x=6)
-      //CONT      1000 Hz (x=7), 5000 Hz (x=8), 6250 Hz (x=9)
-      //CONT      9 kHz (x=10), 10 kHz (x=11), 12.5 kHz (x=12)
-      //CONT      100 kHz (x=13), 250 kHz (x=14)
-      //CONT      500 kHz (x=15), 1 MHz (x=16).
-      //ENDDEF
-      if (command[4] == ';') {
-        // read the step size
-        snprintf(reply,  sizeof(reply), "ZZAC%02d;", vfo_id_get_stepindex(VFO_A));
-        send_resp(client->fd, reply) ;
-      } else if (command[6] == ';') {
-        // set the step size
-        int i = atoi(&command[4]) ;
-        vfo_id_set_step_from_index(VFO_A, i);
-        g_idle_add(ext_vfo_update, NULL);
-      } else {
-      }
+static void cat_cache_store(const char *command, const char *reply, int len, gint64 now) {
+  if (len <= 0 || len >= (int) sizeof(cat_cache[0].reply)) { return; }
 
-      break;
+  CAT_CACHED *entry = &cat_cache[cat_cache_next];
+  cat_cache_next = (cat_cache_next + 1) % CAT_CACHE_SIZE;
+  strcpy(entry->command, command);
+  memcpy(entry->reply, reply, len);
+  entry->reply[len] = '\0';
+  entry->reply_len = len;
+  entry->time = now;
+}
 
-    case 'D': //ZZAD
+//
+// Process a command from the queue. This runs in the GTK event queue,
+// the replies are collected until all commands that have arrived are done.
+//
+static gboolean cat_command(gpointer data) {
+  CAT_COMMAND *slot = (CAT_COMMAND *)data;
+  CLIENT *client = slot->client;
+
+  if (client->batch_commands == 0) {
+    client->batching = 1;
+    client->batch_first = slot->time;
+    client->batch_sum = 0;
+    client->batch_cached = 0;
+    client->batch_now = g_get_monotonic_time();
+  }
 
-      //CATDEF    ZZAD
-      //DESCR     Move down VFO-A frequency by a selected step
-      //SET       ZZACxx;
-      //NOTE      x encodes the step size, see ZZAC command.
-      //ENDDEF
-      if (command[6] == ';') {
-        int step_index = atoi(&command[4]);
-        long long hz = (long long) vfo_get_step_from_index(step_index);
-        vfo_id_move(VFO_A, -hz, FALSE);
-      } else {
-      }
+  client->batch_sum += slot->time;
+  client->batch_commands++;
 
-      break;
+  if (cat_cache_shareable(slot->def, slot->command)) {
+    CAT_CACHED *entry = cat_cache_find(slot->command, client->batch_now);
 
-    case 'E': //ZZAE
+    if (entry != NULL) {
+      send_resp(client, entry->reply);
+      client->batch_cached++;
+    } else {
+      int before = client->reply_len;
+      parse_cmd(client, slot->def, slot->command);
 
-      //CATDEF    ZZAE
-      //DESCR     Move down VFO-A frequency by several steps
-      //SET       ZZAExx;
-      //NOTE      VFO-A frequency moved down by x (0...99) times the current step size
-      //ENDDEF
-      if (command[6] == ';') {
-        int steps = atoi(&command[4]);
-        vfo_id_step(VFO_A, -steps);
+      if (client->reply_len > before) {
+        cat_cache_store(slot->command, client->reply + before, client->reply_len - before, client->batch_now);
       }
+    }
+  } else {
+    parse_cmd(client, slot->def, slot->command);
+    cat_cache_flush();
+  }
 
-      break;
-
-    case 'F': //ZZAF
-
-      //CATDEF    ZZAF
-      //DESCR     Move up VFO-A frequency by several steps
-      //SET       ZZAFxx;
-      //NOTE      VFO-A frequency moved up by x (0...99) times the current step size
-      //ENDDEF
-      if (command[6] == ';') {
-        int steps = atoi(&command[4]);
-        vfo_id_step(VFO_A, steps);
-      }
-
-      break;
-
-    case 'G': //ZZAG
-
-      //CATDEF    ZZAG
-      //DESCR     Set/Read RX1 volume (AF slider)
-      //SET       ZZAGxxx;
-      //READ      ZZAG;
-      //RESP      ZZAGxxx;
-      //NOTE      x = 0...100, mapped logarithmically to -40 ... 0 dB.
-      //ENDDEF
-      if (command[4] == ';') {
-        // send reply back
-        snprintf(reply,  sizeof(reply), "ZZAG%03d;", (int)(100.0 * pow(10.0, 0.05 * receiver[0]->volume)));
-        send_resp(client->fd, reply) ;
-      } else {
-        int gain = atoi(&command[4]);
-
-        if (gain < 2) {
-          receiver[0]->volume = -40.0;
-        } else {
-          receiver[0]->volume = 20.0 * log10(0.01 * (double) gain);
-        }
-
-        set_af_gain(0, receiver[0]->volume);
-      }
-
-      break;
-
-    case 'I': //ZZAI
-
-      //CATDEF    ZZAI
-      //DESCR     Set/Read auto-reporting
-      //SET       ZZAIx;
-      //READ      ZZAI;
-      //RESP      ZZAIx;
-      //NOTE      x=0: auto-reporting disabled, x>0: enabled.
-      //NOTE      Auto-reporting is affected for the client that sends this command.
-      //CONT      For x=1, only frequency changes are sent via FA/FB commands.
-      //CONT      For x>1, mode changes are also sent via MD commands.
-      //ENDDEF
-      if (command[4] == ';') {
-        // Query status
-        snprintf(reply,  sizeof(reply), "ZZAI%d;", client->auto_reporting);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-        client->auto_reporting = command[4] - '0';
-
-        if (client->auto_reporting < 0) { client->auto_reporting = 0; }
+  return G_SOURCE_REMOVE;
+}
 
-        if (client->auto_reporting > 3) { client->auto_reporting = 3; }
-      } else {
-        implemented = FALSE;
-      }
+//
+// Called when a batch of commands is done. Update the snapshot and send
+// the replies. The commands are removed from the queue only after this,
+// and the reading thread answers queries from the snapshot only if the
+// queue is empty, so replies are always sent in the order of the commands.
+//
+static gboolean cat_batch_done(gpointer data) {
+  CLIENT *client = (CLIENT *)data;
+  int n = client->batch_commands;
+  client->batching = 0;
+  client->batch_commands = 0;
 
-      break;
+  if (n > 0 && cat_state_timer != 0) { cat_state_update(); }
 
-    case 'R': //ZZAR
+  send_flush(client);
 
-      //CATDEF    ZZAR
-      //DESCR     Set/Read RX1 AGC gain
-      //SET       ZZARxxxx;
-      //READ      ZZAR;
-      //RESP      ZZARxxxx;
-      //NOTE      x -20...120, must contain + or - sign.
-      //ENDDEF
-      if (command[4] == ';') {
-        // send reply back
-        snprintf(reply,  sizeof(reply), "ZZAR%+04d;", (int)(receiver[0]->agc_gain));
-        send_resp(client->fd, reply) ;
-      } else {
-        int threshold = atoi(&command[4]);
-        set_agc_gain(VFO_A, (double)threshold);
-      }
+  if (n > 0) {
+    cat_stats_add(client, n, client->batch_first, client->batch_sum, 0, client->batch_cached);
+  }
 
-      break;
+  return G_SOURCE_REMOVE;
+}
 
-    case 'S': //ZZAS
+static void cat_init(CLIENT *client) {
+  if (client->commands.slots == NULL) {
+    command_queue_init(&client->commands, CAT_RING_SIZE, CAT_RING_SIZE, cat_command);
+    command_queue_set_flush(&client->commands, cat_batch_done, client);
 
-      //CATDEF    ZZAS
-      //DESCR     Set/Read RX2 AGC gain
-      //SET       ZZASxxxx;
-      //READ      ZZAS;
-      //RESP      ZZASxxxx;
-      //NOTE      x -20...120, must contain + or - sign.
-      //ENDDEF
-      if (receivers == 2) {
-        if (command[4] == ';') {
-          // send reply back
-          snprintf(reply,  sizeof(reply), "ZZAS%+04d;", (int)(receiver[1]->agc_gain));
-          send_resp(client->fd, reply) ;
-        } else {
-          int threshold = atoi(&command[4]);
-          set_agc_gain(VFO_B, (double)threshold);
-        }
-      } else {
-        implemented = FALSE;
-      }
+    for (int i = 0; i < CAT_RING_SIZE; i++) {
+      client->slots[i].client = client;
+    }
 
-      break;
+    g_mutex_init(&client->stats_mutex);
+  }
 
-    case 'U': //ZZAU
+  client->received = 0;
+  client->cmd_len = 0;
+  client->batching = 0;
+  client->batch_commands = 0;
+  client->reply_len = 0;
+  g_mutex_lock(&client->stats_mutex);
+  client->stats_start = g_get_monotonic_time();
+  client->stats_commands = 0;
+  client->stats_latency = 0;
+  client->stats_max_latency = 0;
+  client->stats_cached = 0;
+  client->stats_fast = 0;
+  g_mutex_unlock(&client->stats_mutex);
+}
 
-      //CATDEF    ZZAU
-      //DESCR     Move up VFO-A frequency by selected step
-      //SET       ZZAUxx;
-      //NOTE      x 0...16 selects the size of the step, see ZZAC command.
-      //ENDDEF
-      if (command[6] == ';') {
-        int step_index = atoi(&command[4]);
-        long long hz = (long long) vfo_get_step_from_index(step_index);
-        vfo_id_move(VFO_A, hz, FALSE);
-      } else {
-      }
+//
+// Called from the thread reading from the client: assemble the
+// commands directly in the slots, look them up in the CATDEF table
+// (this is the only lookup, the result is used for answering queries,
+// validation, caching and dispatching), and hand them over to the GTK
+// thread through the queue.
+// If the queue is full, wait (this throttles the client).
+//
+static void cat_input(CLIENT *client, const char *input, int numbytes) {
+  gint64 now = g_get_monotonic_time();
+  int received = 0;
+  char fast[CAT_REPLY_SIZE];
+  int fast_len = 0;
+  int fast_count = 0;
+
+  for (int i = 0; i < numbytes; i++) {
+    //
+    // Filter out newlines and other non-printable characters
+    // These may occur when doing CAT manually with a terminal program
+    //
+    if (input[i] < 32) {
+      continue;
+    }
 
-      break;
+    while (command_queue_length(&client->commands) >= CAT_RING_SIZE) {
+      if (!client->running) { return; }
 
-    default:
-      implemented = FALSE;
-      break;
+      usleep(1000);
     }
 
-    break;
+    CAT_COMMAND *slot = &client->slots[client->received % CAT_RING_SIZE];
 
-  case 'B': //ZZBx
-    switch (command[3]) {
-    case 'A': //ZZBA
+    if (input[i] != ';' && client->cmd_len >= CAT_COMMAND_SIZE - 2) {
+      continue;
+    }
 
-      //CATDEF    ZZBA
-      //DESCR     Move VFO-B one band down
-      //SET       ZZBA;
-      //NOTE      Wraps from lowest to highest band.
-      //ENDDEF
-      if (command[4] == ';') {
-        if (receivers == 2) {
-          band_minus(receiver[1]->id);
-        } else {
-          implemented = FALSE;
-        }
-      }
+    slot->command[client->cmd_len++] = input[i];
 
-      break;
+    if (input[i] == ';') {
+      slot->command[client->cmd_len] = '\0';
+      slot->def = catdef_lookup(slot->command);
+      slot->time = now;
+      client->cmd_len = 0;
 
-    case 'B': //ZZBB
+      if (rigctl_debug) { t_print("RIGCTL: command=%s\n", slot->command); }
 
-      //CATDEF    ZZBB
-      //DESCR     Move VFO-B one band up
-      //SET       ZZBB;
-      //NOTE      Wraps from highest to lowest band.
-      //ENDDEF
-      if (command[4] == ';') {
-        if (receivers == 2) {
-          band_plus(receiver[1]->id);
-        } else {
-          implemented = FALSE;
+      //
+      // Queries are answered right here if no commands are pending
+      //
+      if (command_queue_length(&client->commands) == 0) {
+        if (fast_len > CAT_REPLY_SIZE - 256) {
+          cat_write(client->fd, fast, fast_len);
+          cat_stats_add(client, fast_count, now, fast_count * now, fast_count, 0);
+          fast_len = 0;
+          fast_count = 0;
         }
-      }
-
-      break;
-
-    case 'D': //ZZBD
-
-      //CATDEF    ZZBD
-      //DESCR     Move VFO-A one band down
-      //SET       ZZBD;
-      //NOTE      Wraps from lowest to highest band.
-      //ENDDEF
-      if (command[4] == ';') {
-        band_minus(receiver[0]->id);
-      }
-
-      break;
-
-    case 'E': //ZZBE
-
-      //CATDEF    ZZBE
-      //DESCR     Move down VFO-B frequency by multiple steps
-      //SET       ZZBExx;
-      //NOTE      VFO-B frequency moves down by x (0..99) times the current step size
-      //ENDDEF
-      if (command[6] == ';') {
-        int steps = atoi(&command[4]);
-        vfo_id_step(VFO_B, -steps);
-      }
-
-      break;
-
-    case 'F': //ZZBF
-
-      //CATDEF    ZZBF
-      //DESCR     Move up VFO-B frequency by multiple steps
-      //SET       ZZBFxx;
-      //NOTE      VFO-B frequency moves up by x (0...99) times the current step size
-      //ENDDEF
-      if (command[6] == ';') {
-        int steps = atoi(&command[4]);
-        vfo_id_step(VFO_B, +steps);
-      }
 
-      break;
+        int len = cat_fast_query(slot->def, slot->command, fast + fast_len, 256);
 
-    case 'M': //ZZBM
+        if (len > 0) {
+          if (rigctl_debug) { t_print("RIGCTL: RESP=%s\n", fast + fast_len); }
 
-      //CATDEF    ZZBM
-      //DESCR     Move down VFO-B frequency by selected step.
-      //SET       ZZBMxx;
-      //NOTE      x 0...16 selects the size of the step, see ZZAC command.
-      //ENDDEF
-      if (command[6] == ';') {
-        int step_index = atoi(&command[4]);
-        long long hz = (long long) vfo_get_step_from_index(step_index);
-        vfo_id_move(VFO_B, -hz, FALSE);
-      } else {
+          fast_len += len;
+          fast_count++;
+          continue;
+        }
       }
 
-      break;
-
-    case 'P': //ZZBP
-
-      //CATDEF    ZZBP
-      //DESCR     Move up VFO-B frequency by selected step.
-      //SET       ZZBPxx;
-      //NOTE      x 0...16 selects the size of the step, see ZZAC command.
-      //ENDDEF
-      if (command[6] == ';') {
-        int step_index = atoi(&command[4]);
-        long long hz = (long long) vfo_get_step_from_index(step_index);
-        vfo_id_move(VFO_B, hz, FALSE);
+      //
+      // Replies to earlier queries must be sent before this
+      // command is handed over to the GTK thread
+      //
+      if (fast_len > 0) {
+        cat_write(client->fd, fast, fast_len);
+        cat_stats_add(client, fast_count, now, fast_count * now, fast_count, 0);
+        fast_len = 0;
+        fast_count = 0;
       }
 
-      break;
-
-    case 'S':
-    case 'T': { //ZZBS and ZZBT
-      int v = VFO_A;
-
-      if (command[3] == 'T') { v = VFO_B; }
-
-      //CATDEF    ZZBS
-      //DESCR     Set/Read VFO-A band
-      //SET       ZZBSxxx;
-      //NOTE      x 0...999 encodes the band:
-      //NOTE      136 kHz (x=136), 472 kHz (x=472), 160M (x=160)
-      //CONT      80M (x=80), 60M (x=60), 40M (x=40), 30M (x=30)
-      //CONT      20M (x=20), 17M (x=17), 15M (x=15), 12M (x=12)
-      //CONT      10M (x=10), 6M (x=6), Gen (x=888), WWV (x=999).
-      //ENDDEF
-      //CATDEF    ZZBT
-      //DESCR     Set/Read VFO-B band
-      //SET       ZZBTxxx;
-      //NOTE      x 0...999 encodes the band, see ZZBS command.
-      //ENDDEF
-      if (command[4] == ';') {
-        int b;
-
-        switch (vfo[v].band) {
-        case band136:
-          b = 136;
-          break;
-
-        case band472:
-          b = 472;
-          break;
-
-        case band160:
-          b = 160;
-          break;
-
-        case band80:
-          b = 80;
-          break;
-
-        case band60:
-          b = 60;
-          break;
-
-        case band40:
-          b = 40;
-          break;
-
-        case band30:
-          b = 30;
-          break;
-
-        case band20:
-          b = 20;
-          break;
-
-        case band17:
-          b = 17;
-          break;
-
-        case band15:
-          b = 15;
-          break;
-
-        case band12:
-          b = 12;
-          break;
-
-        case band10:
-          b = 10;
-          break;
-
-        case band6:
-          b = 6;
-          break;
-
-        case bandGen:
-          b = 888;
-          break;
-
-        case bandWWV:
-          b = 999;
-          break;
-
-        default:
-          b = 20;
-          break;
-        }
-
-        snprintf(reply,  sizeof(reply), "ZZB%c%03d;", 'S' + v, b);
-        send_resp(client->fd, reply) ;
-      } else if (command[7] == ';') {
-        int band = band20;
-        int b = atoi(&command[4]);
-
-        switch (b) {
-        case 136:
-          band = band136;
-          break;
-
-        case 472:
-          band = band472;
-          break;
-
-        case 160:
-          band = band160;
-          break;
-
-        case 80:
-          band = band80;
-          break;
+      command_queue_push(&client->commands, slot);
+      client->received++;
+      received = 1;
+    }
+  }
 
-        case 60:
-          band = band60;
-          break;
+  if (fast_len > 0) {
+    cat_write(client->fd, fast, fast_len);
+    cat_stats_add(client, fast_count, now, fast_count * now, fast_count, 0);
 
-        case 40:
-          band = band40;
-          break;
+    //
+    // On a FIFO, the serial thread must not read back the replies just
+    // written. If no command went to the GTK thread, there is nothing
+    // that sets "done" later, so the replies count as done right now.
+    //
+    if (!received) {
+      client->busy = 10;
+      client->done = 1;
+    }
+  }
 
-        case 30:
-          band = band30;
-          break;
+  if (received) {
+    client->busy = 10;
+  }
+}
 
-        case 20:
-          band = band20;
-          break;
+static gpointer rigctl_client (gpointer data) {
+  CLIENT *client = (CLIENT *)data;
+  t_print("%s: starting rigctl_client: socket=%d\n", __FUNCTION__, client->fd);
+  g_mutex_lock(&mutex_numcat);
+  cat_control++;
 
-        case 17:
-          band = band17;
-          break;
+  if (rigctl_debug) { t_print("RIGCTL: CTLA INC cat_control=%d\n", cat_control); }
 
-        case 15:
-          band = band15;
-          break;
+  g_mutex_unlock(&mutex_numcat);
+  g_idle_add(cat_state_start, NULL);
+  g_idle_add(ext_vfo_update, NULL);
+  int numbytes;
+  char  cmd_input[MAXDATASIZE] ;
 
-        case 12:
-          band = band12;
-          break;
+  while (client->running && (numbytes = recv(client->fd, cmd_input, MAXDATASIZE, 0)) > 0 ) {
+    cat_input(client, cmd_input, numbytes);
+  }
 
-        case 10:
-          band = band10;
-          break;
+  t_print("%s: Leaving rigctl_client thread\n", __FUNCTION__);
+  cat_stats(client, g_get_monotonic_time());
 
-        case 6:
-          band = band6;
-          break;
+  //
+  // If rigctl is disabled via the GUI, the connections are closed by shutdown_rigctl_ports()
+  // but even the we should decrement cat_control
+  //
+  if (client->fd != -1) {
+    struct linger linger = { 0 };
+    linger.l_onoff = 1;
+    linger.l_linger = 0;
 
-        case 888:
-          band = bandGen;
-          break;
+    if (setsockopt(client->fd, SOL_SOCKET, SO_LINGER, (const char *)&linger, sizeof(linger)) == -1) {
+      t_perror("setsockopt(...,SO_LINGER,...) failed for client:");
+    }
 
-        case 999:
-          band = bandWWV;
-          break;
-        }
+    if (client->andromeda_timer != 0) {
+      g_source_remove(client->andromeda_timer);
+      client->andromeda_timer = 0;
+    }
 
-        vfo_id_band_changed(v, band);
-      }
+    if (client->auto_ref) {
+      client->auto_ref = 0;
+      autoreport_unref();
     }
-    break;
 
-    case 'U': //ZZBU
+    client->running = 0;
+    close(client->fd);
+    client->fd = -1;
+  }
 
-      //CATDEF    ZZBU
-      //DESCR     Move VFO-A one band up
-      //SET       ZZBU;
-      //NOTE      Wraps from highest to lowest band.
-      //ENDDEF
-      if (command[4] == ';') {
-        band_plus(receiver[0]->id);
-      }
+  // Decrement CAT_CONTROL
+  g_mutex_lock(&mutex_numcat);
+  cat_control--;
+  g_mutex_unlock(&mutex_numcat);
+  g_idle_add(ext_vfo_update, NULL);
+  return NULL;
+}
 
-      break;
+//
+// ZZ commands without a CATDEF block, dispatched by their characters
+//
+static gboolean parse_undocumented_extended_cmd(const char *command, CLIENT *client) {
+  gboolean implemented = TRUE;
+  char reply[256];
+  reply[0] = '\0';
 
+  switch (command[2]) {
+  case 'B': //ZZBx
+    switch (command[3]) {
     case 'Y': //ZZBY
       // closes console (ignored)
       break;
@@ -1812,54 +1901,13 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
 
   case 'C': //ZZCx
     switch (command[3]) {
-    case 'N': //ZZCN
-
-      //CATDEF    ZZCN
-      //DESCR     Set/Read VFO-A CTUN status
-      //SET       ZZCNx;
-      //READ      ZZCN;
-      //RESP      ZZCNx;
-      //NOTE      x=0: CTUN disabled, x=1: enabled
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZCN%d;", vfo[VFO_A].ctun);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-        int state = atoi(&command[4]);
-        vfo_id_ctun_update(VFO_A, state);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    case 'O': //ZZCO
-
-      //CATDEF    ZZCO
-      //DESCR     Set/Read VFO-B CTUN status
-      //SET       ZZCOx;
-      //READ      ZZCO;
-      //RESP      ZZCOx;
-      //NOTE      x=0: CTUN disabled, x=1: enabled
-      //ENDDEF
-      if (command[4] == ';') {
-        // return the CTUN status
-        snprintf(reply,  sizeof(reply), "ZZCO%d;", vfo[VFO_B].ctun);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-        int state = atoi(&command[4]);
-        vfo_id_ctun_update(VFO_B, state);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
     case 'P': //ZZCP
 
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       // set/read compander
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZCP%d;", 0);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1879,7 +1927,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read RX Reference
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDB%d;", 0); // currently always 0
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1890,7 +1938,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/get diversity gain
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDC%04d;", (int)div_gain);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1901,7 +1949,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/get diversity phase
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDD%04d;", (int)div_phase);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1920,7 +1968,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
         }
 
         snprintf(reply,  sizeof(reply), "ZZDM%d;", v);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1931,7 +1979,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read waterfall low
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDN%+4d;", receiver[0]->waterfall_low);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1942,7 +1990,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read waterfall high
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDO%+4d;", receiver[0]->waterfall_high);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1953,7 +2001,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read panadapter high
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDP%+4d;", receiver[0]->panadapter_high);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1964,7 +2012,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read panadapter low
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDQ%+4d;", receiver[0]->panadapter_low);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1975,7 +2023,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read panadapter step
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZDR%2d;", receiver[0]->panadapter_step);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       }
 
       break;
@@ -1995,7 +2043,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read rx equaliser
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZER%d;", receiver[0]->eq_enable);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       } else if (command[5] == ';') {
         receiver[0]->eq_enable = SET(atoi(&command[4]));
       }
@@ -2009,7 +2057,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (can_transmit) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZET%d;", transmitter->eq_enable);
-          send_resp(client->fd, reply) ;
+          send_resp(client, reply) ;
         } else if (command[5] == ';') {
           transmitter->eq_enable = SET(atoi(&command[4]));
         }
@@ -2026,115 +2074,32 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
 
   case 'F': //ZZFx
     switch (command[3]) {
-    case 'A': //ZZFA
-
-      //CATDEF    ZZFA
-      //DESCR     Set/Read VFO-A frequency
-      //SET       ZZFAxxxxxxxxxxx;
-      //READ      ZZFA;
-      //RESP      ZZFAxxxxxxxxxxx;
-      //NOTE      x in Hz, left-padded with zeroes
-      //ENDDEF
+    case 'D': //ZZFD
+
+      //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
-        if (vfo[VFO_A].ctun) {
-          snprintf(reply,  sizeof(reply), "ZZFA%011lld;", vfo[VFO_A].ctun_frequency);
-        } else {
-          snprintf(reply,  sizeof(reply), "ZZFA%011lld;", vfo[VFO_A].frequency);
+        snprintf(reply,  sizeof(reply), "ZZFD%d;", vfo[VFO_A].deviation == 2500 ? 0 : 1);
+        send_resp(client, reply) ;
+      } else if (command[5] == ';') {
+        int d = atoi(&command[4]);
+        vfo[VFO_A].deviation = d ? 5000 : 2500;
+        rx_set_filter(receiver[0]);
+
+        if (can_transmit) {
+          tx_set_filter(transmitter);
         }
 
-        send_resp(client->fd, reply) ;
-      } else if (command[15] == ';') {
-        long long f = atoll(&command[4]);
-        vfo_id_set_frequency(VFO_A, f);
         g_idle_add(ext_vfo_update, NULL);
       }
 
       break;
 
-    case 'B': //ZZFB
-
-      //CATDEF    ZZFB
-      //DESCR     Set/Read VFO-B frequency
-      //SET       ZZFBxxxxxxxxxxx;
-      //READ      ZZFB;
-      //RESP      ZZFBxxxxxxxxxxx;
-      //NOTE      x in Hz, left-padded with zeroes
-      //ENDDEF
-      if (command[4] == ';') {
-        if (vfo[VFO_B].ctun) {
-          snprintf(reply,  sizeof(reply), "ZZFB%011lld;", vfo[VFO_B].ctun_frequency);
-        } else {
-          snprintf(reply,  sizeof(reply), "ZZFB%011lld;", vfo[VFO_B].frequency);
-        }
-
-        send_resp(client->fd, reply) ;
-      } else if (command[15] == ';') {
-        long long f = atoll(&command[4]);
-        vfo_id_set_frequency(VFO_B, f);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    case 'D': //ZZFD
-
-      //DO NOT DOCUMENT, THIS WILL BE REMOVED
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZFD%d;", vfo[VFO_A].deviation == 2500 ? 0 : 1);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-        int d = atoi(&command[4]);
-        vfo[VFO_A].deviation = d ? 5000 : 2500;
-        rx_set_filter(receiver[0]);
-
-        if (can_transmit) {
-          tx_set_filter(transmitter);
-        }
-
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    case 'H': //ZZFH
-
-      //CATDEF    ZZFH
-      //DESCR     Set/Read RX1 filter high water
-      //SET       ZZFHxxxxx;
-      //READ      ZZFH;
-      //RESP      ZZFHxxxxxx;
-      //NOTE      x must be in the range -9999 ... 9999 and start with a minus sign if negative.
-      //CONT      If setting, this switches to the Var1 filter first.
-      //CONT      The convention is such that LSB, the filter high cut is negative and affects the low audio frequencies.
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZFH%05d;", receiver[0]->filter_high);
-        send_resp(client->fd, reply) ;
-      } else if (command[9] == ';') {
-        int fh = atoi(&command[4]);
-        fh = fmin(9999, fh);
-        fh = fmax(-9999, fh);
-
-        // make sure filter is filterVar1
-        if (vfo[VFO_A].filter != filterVar1) {
-          vfo_id_filter_changed(VFO_A, filterVar1);
-        }
-
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        FILTER *filter = &mode_filters[filterVar1];
-        filter->high = fh;
-        vfo_id_filter_changed(VFO_A, filterVar1);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    case 'I': //ZZFI
+    case 'I': //ZZFI
 
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZFI%02d;", vfo[VFO_A].filter);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       } else if (command[6] == ';') {
         int filter = atoi(&command[4]);
         vfo_id_filter_changed(VFO_A, filter);
@@ -2147,7 +2112,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZFJ%02d;", vfo[VFO_B].filter);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       } else if (command[6] == ';') {
         int filter = atoi(&command[4]);
         vfo_id_filter_changed(VFO_B, filter);
@@ -2155,94 +2120,6 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
 
       break;
 
-    case 'L': //ZZFL
-
-      //CATDEF    ZZFL
-      //DESCR     Set/Read RX1 filter low water
-      //SET       ZZFLxxxxx;
-      //READ      ZZFL;
-      //RESP      ZZFLxxxxxx;
-      //NOTE      x must be in the range -9999 ... 9999 and start with a minus sign if negative.
-      //CONT      If setting, this switches to the Var1 filter first.
-      //CONT      The convention is such that LSB, the filter low cut is negative and affects the high audio frequencies.
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZFL%05d;", receiver[0]->filter_low);
-        send_resp(client->fd, reply) ;
-      } else if (command[9] == ';') {
-        int fl = atoi(&command[4]);
-        fl = fmin(9999, fl);
-        fl = fmax(-9999, fl);
-
-        // make sure filter is filterVar1
-        if (vfo[VFO_A].filter != filterVar1) {
-          vfo_id_filter_changed(VFO_A, filterVar1);
-        }
-
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        FILTER *filter = &mode_filters[filterVar1];
-        filter->low = fl;
-        vfo_id_filter_changed(VFO_A, filterVar1);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  case 'G': //ZZGx
-    switch (command[3]) {
-    case 'T': //ZZGT
-
-      //CATDEF    ZZGT
-      //DESCR     Set/Read RX1 AGC
-      //SET       ZZGTx;
-      //READ      ZZGT;
-      //RESP      ZZGTx;
-      //NOTE      x=0: AGC OFF, x=1: LONG, x=2: SLOW, x=3: MEDIUM, x=4: FAST
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZGT%d;", receiver[0]->agc);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-        int agc = atoi(&command[4]);
-        // update RX1 AGC
-        receiver[0]->agc = agc;
-        rx_set_agc(receiver[0]);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    case 'U': //ZZGU
-      //CATDEF    ZZGU
-      //DESCR     Set/Read RX2 AGC
-      //SET       ZZGUx;
-      //READ      ZZGU;
-      //RESP      ZZGUx;
-      //NOTE      x=0: AGC OFF, x=1: LONG, x=2: SLOW, x=3: MEDIUM, x=4: FAST
-      //ENDDEF
-      RXCHECK(1,
-      if (command[4] == ';') {
-      snprintf(reply,  sizeof(reply), "ZZGU%d;", receiver[1]->agc);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-      int agc = atoi(&command[4]);
-        // update RX2 AGC
-        RXCHECK(1,
-                receiver[1]->agc = agc;
-                rx_set_agc(receiver[1]);
-                g_idle_add(ext_vfo_update, NULL);
-               )
-      }
-             )
-      break;
-
     default:
       implemented = FALSE;
       break;
@@ -2256,203 +2133,15 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
     implemented = FALSE;
     break;
 
-  case 'L': //ZZLx
-    switch (command[3]) {
-    case 'A': //ZZLA
-
-      //CATDEF    ZZLA
-      //DESCR     Set/Read RX1 volume (AF slider)
-      //SET       ZZLAxxx;
-      //READ      ZZLA;
-      //RESP      ZZLAxxx;
-      //NOTE      x = 0...100, mapped logarithmically to -40 ... 0 dB.
-      //ENDDEF
-      if (command[4] == ';') {
-        // send reply back
-        snprintf(reply,  sizeof(reply), "ZZLA%03d;", (int)(receiver[0]->volume * 100.0));
-        send_resp(client->fd, reply) ;
-      } else {
-        int gain = atoi(&command[4]);
-
-        // gain is 0..100
-        if (gain < 2) {
-          receiver[0]->volume = -40.0;
-        } else {
-          receiver[0]->volume = 20.0 * log10(0.01 * (double) gain);
-        }
-
-        set_af_gain(0, receiver[0]->volume);
-      }
-
-      break;
-
-    case 'C': //ZZLC
-      //CATDEF    ZZLC
-      //DESCR     Set/Read RX2 volume (AF slider)
-      //SET       ZZLCxxx;
-      //READ      ZZLC;
-      //RESP      ZZLCxxx;
-      //NOTE      x = 0...100, mapped logarithmically to -40 ... 0 dB.
-      //ENDDEF
-      RXCHECK(1,
-      if (command[4] == ';') {
-      // send reply back
-      snprintf(reply,  sizeof(reply), "ZZLC%03d;", (int)(255.0 * pow(10.0, 0.05 * receiver[1]->volume)));
-        send_resp(client->fd, reply) ;
-      } else {
-        int gain = atoi(&command[4]);
-
-        // gain is 0..100
-        if (gain < 2) {
-          receiver[1]->volume = -40.0;
-        } else {
-          receiver[1]->volume = 20.0 * log10(0.01 * (double) gain);
-        }
-
-        set_af_gain(1, receiver[1]->volume);
-      }
-             )
-      break;
-
-    case 'I': //ZZLI
-
-      //CATDEF    ZZLI
-      //DESCR     Set/Read PURESIGNAL status
-      //SET       ZZLIx;
-      //READ      ZZLI;
-      //RESP      ZZLIx;
-      //NOTE      x=0: PURESIGNAL disabled, x=1: enabled.
-      //ENDDEF
-      if (can_transmit) {
-        if (command[4] == ';') {
-          // send reply back
-          snprintf(reply,  sizeof(reply), "ZZLI%d;", transmitter->puresignal);
-          send_resp(client->fd, reply) ;
-        } else {
-          int ps = atoi(&command[4]);
-          tx_ps_onoff(transmitter, ps);
-        }
-
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
   case 'M': //ZZMx
     switch (command[3]) {
-    case 'A':  //ZZMA
-
-      //CATDEF    ZZMA
-      //DESCR     Mute/Unmute RX1
-      //SET       ZZMAx;
-      //READ      ZZMA;
-      //RESP      ZZMAx;
-      //NOTE      x=0: RX1 not muted, x=1: muted.
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZMA%d;", receiver[0]->mute_radio);
-        send_resp(client->fd, reply) ;
-      } else {
-        int mute = atoi(&command[4]);
-        receiver[0]->mute_radio = mute;
-      }
-
-      break;
-
-    case 'B': //ZZMB
-      //CATDEF    ZZMB
-      //DESCR     Mute/Unmute RX2
-      //SET       ZZMBx;
-      //READ      ZZMB;
-      //RESP      ZZMBx;
-      //NOTE      x=0: RX2 not muted, x=1: muted.
-      //ENDDEF
-      RXCHECK(1,
-      if (command[4] == ';') {
-      snprintf(reply,  sizeof(reply), "ZZMA%d;", receiver[1]->mute_radio);
-        send_resp(client->fd, reply) ;
-      } else {
-        int mute = atoi(&command[4]);
-        receiver[1]->mute_radio = mute;
-      }
-             )
-      break;
-
-    case 'D': //ZZMD
-
-      //CATDEF    ZZMD
-      //DESCR     Set/Read VFO-A modes
-      //SET       ZZMDxx;
-      //READ      ZZMD;
-      //RESP      ZZMDxx;
-      //NOTE      Modes: LSB (x=0), USB (x=1), DSB (x=3), CWL (x=4)
-      //CONT      CWU (x=5), FMN (x=6), AM (x=7), DIGU (x=7)
-      //CONT      SPEC (x=8), DIGL (x=9), SAM (x=10), DRM (x=11)
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZMD%02d;", vfo[VFO_A].mode);
-        send_resp(client->fd, reply);
-      } else if (command[6] == ';') {
-        vfo_id_mode_changed(VFO_A, atoi(&command[4]));
-      }
-
-      break;
-
-    case 'E': //ZZME
-
-      //CATDEF    ZZME
-      //DESCR     Set/Read VFO-B modes
-      //SET       ZZMEx;
-      //READ      ZZME;
-      //RESP      ZZMEx;
-      //NOTE      x encodes the mode (see ZZMD command)
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZMD%02d;", vfo[VFO_B].mode);
-        send_resp(client->fd, reply);
-      } else if (command[6] == ';') {
-        vfo_id_mode_changed(VFO_A, atoi(&command[4]));
-      }
-
-      break;
-
-    case 'G': //ZZMG
-
-      //CATDEF    ZZMG
-      //DESCR     Set/Read Mic gain (Mic gain slider)
-      //SET       ZZMGxxx;
-      //READ      ZZMG;
-      //RESP      ZZMGxxx;
-      //NOTE      x 0-70 mapped to -12 ... +50 dB
-      //ENDDEF
-      if (can_transmit) {
-        if (command[4] == ';') {
-          snprintf(reply,  sizeof(reply), "ZZMG%03d;", (int)((transmitter->mic_gain + 12.0) * 1.129));
-          send_resp(client->fd, reply);
-        } else if (command[7] == ';') {
-          int val = atoi(&command[4]);
-          set_mic_gain(((double) val * 0.8857) - 12.0);
-        }
-      } else {
-        implemented = FALSE;
-      }
-
-      break;
-
     case 'L': //ZZML
 
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply),
                  "ZZML LSB00: USB01: DSB02: CWL03: CWU04: FMN05:  AM06:DIGU07:SPEC08:DIGL09: SAM10: DRM11;");
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       }
 
       break;
@@ -2463,7 +2152,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       // set/read MON status
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZMO%d;", 0);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       }
 
       break;
@@ -2473,7 +2162,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZMR%d;", active_receiver->smetermode + 1);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         int val = atoi(&command[4]) - 1;
 
@@ -2495,7 +2184,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZMT%02d;", 1); // forward power
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else {
       }
 
@@ -2515,7 +2204,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZNA%d;", (receiver[0]->nb == 1));
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         if (atoi(&command[4])) { receiver[0]->nb = 1; }
 
@@ -2529,7 +2218,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZNB%d;", (receiver[0]->nb == 2));
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         if (atoi(&command[4])) { receiver[0]->nb = 2; }
 
@@ -2544,7 +2233,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (receivers == 2) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZNC%d;", (receiver[1]->nb == 1));
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else if (command[5] == ';') {
           if (atoi(&command[4])) { receiver[1]->nb = 1; }
 
@@ -2562,7 +2251,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (receivers == 2) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZND%d;", (receiver[1]->nb == 2));
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else if (command[5] == ';') {
           if (atoi(&command[4])) { receiver[1]->nb = 2; }
 
@@ -2579,7 +2268,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZNN%d;", receiver[0]->snb);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         receiver[0]->snb = atoi(&command[4]);
         rx_set_noise(receiver[0]);
@@ -2593,7 +2282,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (receivers == 2) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZNO%d;", receiver[1]->snb);
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else if (command[5] == ';') {
           receiver[1]->snb = atoi(&command[4]);
           rx_set_noise(receiver[1]);
@@ -2610,7 +2299,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (receivers == 2) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZNR%d;", (receiver[0]->nr == 1));
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else if (command[5] == ';') {
           if (atoi(&command[4])) { receiver[0]->nr = 1; }
 
@@ -2625,7 +2314,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZNS%d;", (receiver[0]->nr == 2));
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         if (atoi(&command[4])) { receiver[0]->nr = 2; }
 
@@ -2639,7 +2328,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZNT%d;", receiver[0]->anf);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         if (atoi(&command[4])) { receiver[0]->anf = 1; }
 
@@ -2654,7 +2343,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (receivers == 2) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZNU%d;", receiver[1]->anf);
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else if (command[5] == ';') {
           if (atoi(&command[4])) { receiver[1]->anf = 1; }
 
@@ -2672,7 +2361,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (receivers == 2) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZNV%d;", (receiver[1]->nr == 1));
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else if (command[5] == ';') {
           if (atoi(&command[4])) { receiver[1]->nr = 1; }
 
@@ -2690,7 +2379,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       if (receivers == 2) {
         if (command[4] == ';') {
           snprintf(reply,  sizeof(reply), "ZZNW%d;", (receiver[1]->nr == 2));
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else if (command[5] == ';') {
           if (atoi(&command[4])) { receiver[1]->nr = 2; }
 
@@ -2734,7 +2423,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
         }
 
         snprintf(reply,  sizeof(reply), "ZZPA%d;", a);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';' && have_rx_att) {
         int a = atoi(&command[4]);
 
@@ -2772,7 +2461,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZPY%d;", receiver[0]->zoom);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[7] == ';') {
         int zoom = atoi(&command[4]);
         set_zoom(0, zoom);
@@ -2819,7 +2508,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZRF%+5lld;", vfo[VFO_A].rit);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[9] == ';') {
         vfo_id_rit_value(VFO_A, atoi(&command[4]));
         g_idle_add(ext_vfo_update, NULL);
@@ -2832,7 +2521,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[5] == ';') {
         snprintf(reply,  sizeof(reply), "ZZRM%d%20d;", active_receiver->smetermode, (int)receiver[0]->meter);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       }
 
       break;
@@ -2842,7 +2531,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZRS%d;", receivers == 2);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         int state = atoi(&command[4]);
 
@@ -2860,7 +2549,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZRT%d;", vfo[VFO_A].rit_enabled);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         vfo_id_rit_onoff(VFO_A, SET(atoi(&command[4])));
       }
@@ -2887,58 +2576,6 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
 
   case 'S': //ZZSx
     switch (command[3]) {
-    case 'A': //ZZSA
-
-      //CATDEF    ZZSA
-      //DESCR     Move down VFO-A frequency one step
-      //SET       ZZSA;
-      //NOTE      VFO-A frequency moved down by the current step size
-      //ENDDEF
-      if (command[4] == ';') {
-        vfo_id_step(VFO_A, -1);
-      }
-
-      break;
-
-    case 'B': //ZZSB
-
-      //CATDEF    ZZSB
-      //DESCR     Move up VFO-A frequency one step
-      //SET       ZZSB;
-      //NOTE      VFO-A frequency moved up by the current step size
-      //ENDDEF
-      if (command[4] == ';') {
-        vfo_id_step(VFO_A, 1);
-      }
-
-      break;
-
-    case 'G': //ZZSG
-
-      //CATDEF    ZZSG
-      //DESCR     Move down VFO-B frequency one step
-      //SET       ZZSG;
-      //NOTE      VFO-B frequency moved down by the current step size
-      //ENDDEF
-      if (command[4] == ';') {
-        vfo_id_step(VFO_B, -1);
-      }
-
-      break;
-
-    case 'H': //ZZSH
-
-      //CATDEF    ZZSH
-      //DESCR     Move up VFO-B frequency one step
-      //SET       ZZSG;
-      //NOTE      VFO-B frequency moved up by the current step size
-      //ENDDEF
-      if (command[4] == ';') {
-        vfo_id_step(VFO_B, 1);
-      }
-
-      break;
-
     case 'M': //ZZSM
 
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
@@ -2950,7 +2587,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
           m = fmax(-140.0, m);
           m = fmin(-10.0, m);
           snprintf(reply,  sizeof(reply), "ZZSM%d%03d;", v, (int)((m + 140.0) * 2));
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         } else {
           implemented = FALSE;
         }
@@ -2963,7 +2600,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZSP%d;", split);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       } else if (command[5] == ';') {
         int val = atoi(&command[4]);
         radio_set_split(val);
@@ -2976,7 +2613,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZSW%d;", split);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       } else if (command[5] == ';') {
         int val = atoi(&command[4]);
         radio_set_split(val);
@@ -2998,60 +2635,13 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZTU%d;", tune);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       } else if (command[5] == ';') {
         radio_set_tune(atoi(&command[4]));
       }
 
       break;
 
-    case 'X': //ZZTX
-
-      //CATDEF    ZZTX
-      //DESCR     Get/Set MOX status
-      //SET       ZZTXx;
-      //READ      ZZTX;
-      //RESP      ZZTXx;
-      //NOTE      x=1: MOX on, x=0: off.
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZTX%d;", mox);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-        radio_set_mox(atoi(&command[4]));
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  case 'U': //ZZUx
-    switch (command[3]) {
-    case 'U': //ZZUT
-
-      //CATDEF    ZZUT
-      //DESCR     Get/Set TwoTone status
-      //SET       ZZUTx;
-      //READ      ZZUT;
-      //RESP      ZZTXx;
-      //NOTE      x=1: TwoTone on, x=0: TwoTone off.
-      //ENDDEF
-      if (can_transmit) {
-        if (command[4] == ';') {
-          snprintf(reply,  sizeof(reply), "ZZUT%d;", transmitter->twotone);
-          send_resp(client->fd, reply) ;
-        } else if (command[5] == ';') {
-          radio_set_twotone(transmitter, atoi(&command[4]));
-        }
-      }
-
-      break;
-
     default:
       implemented = FALSE;
       break;
@@ -3067,24 +2657,6 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       g_idle_add(ext_vfo_update, NULL);
       break;
 
-    case 'S': { //ZZVS
-      //CATDEF    ZZVS
-      //DESCR     Swap VFO A and B
-      //SET       ZZVS;
-      //NOTE      The contents (frequencies, CTUN mode, filters, etc.) of VFO A and B are exchanged.
-      //ENDDEF
-      int i = atoi(&command[4]);
-
-      if (i == 0) {
-        vfo_a_to_b();
-      } else if (i == 1) {
-        vfo_b_to_a();
-      } else {
-        vfo_a_swap_b();
-      }
-    }
-    break;
-
     default:
       implemented = FALSE;
       break;
@@ -3108,7 +2680,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZXT%+05lld;", vfo[vfo_get_tx_vfo()].xit);
-        send_resp(client->fd, reply) ;
+        send_resp(client, reply) ;
       } else if (command[9] == ';') {
         vfo_xit_value(atoi(&command[4]));
       }
@@ -3151,7 +2723,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
         if (receiver[0]->anf) { status |=  0x1000; }
 
         snprintf(reply,  sizeof(reply), "ZZXN%04d;", status);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       }
 
       break;
@@ -3193,7 +2765,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
           if (receiver[1]->anf) { status |=  0x1000; }
 
           snprintf(reply,  sizeof(reply), "ZZXO%04d;", status);
-          send_resp(client->fd, reply);
+          send_resp(client, reply);
         }
       } else {
         implemented = FALSE;
@@ -3206,7 +2778,7 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
       //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[4] == ';') {
         snprintf(reply,  sizeof(reply), "ZZXS%d;", vfo[vfo_get_tx_vfo()].xit_enabled);
-        send_resp(client->fd, reply);
+        send_resp(client, reply);
       } else if (command[5] == ';') {
         vfo[vfo_get_tx_vfo()].xit_enabled = atoi(&command[4]);
         schedule_high_priority();
@@ -3215,447 +2787,44 @@ static gboolean parse_extended_cmd (const char *command, CLIENT *client) {
 
       break;
 
-    case 'V': //ZZXV
-
-      //CATDEF    ZZXV
-      //DESCR     Get extended status information
-      //READ      ZZVS;
-      //RESP      ZZVSxxxx;
-      //NOTE      Status is reported bit-wise in the status word x=0-1023.
-      //NOTE      Bit 0: RIT; Bit 1: Lock, Bit2: Lock, Bit3: Split,
-      //NOTE      Bit 4: VFO-A CTUN, Bit 5: VFO-B CTUN, Bit 6: MOX,
-      //NOTE      Bit 7: TUNE, Bit 8: XIT, Bit 9: always cleared.
-      //ENDDEF
-      if (command[4] == ';') {
-        int status = 0;
-
-        if (vfo[VFO_A].rit_enabled) {
-          // cppcheck-suppress badBitmaskCheck
-          status = status | 0x01;
-        }
-
-        if (locked) {
-          status = status | 0x02;
-          status = status | 0x04;
-        }
-
-        if (split) {
-          status = status | 0x08;
-        }
-
-        if (vfo[VFO_A].ctun) {
-          status = status | 0x10;
-        }
+    default:
+      implemented = FALSE;
+      break;
+    }
 
-        if (vfo[VFO_B].ctun) {
-          status = status | 0x20;
-        }
+    break;
 
-        if (mox) {
-          status = status | 0x40;
-        }
+  default:
+    implemented = FALSE;
+    break;
+  }
 
-        if (tune) {
-          status = status | 0x80;
-        }
+  return implemented;
+}
 
-        if (vfo[vfo_get_tx_vfo()].xit_enabled) {
-          status = status | 0x100;
-        }
+//
+// Commands without a CATDEF block, dispatched by their characters
+//
+static gboolean parse_undocumented_cmd(const char *command, CLIENT *client) {
+  gboolean implemented = TRUE;
+  char reply[256];
+  reply[0] = '\0';
 
-        snprintf(reply,  sizeof(reply), "ZZXV%03d;", status);
-        send_resp(client->fd, reply);
-      }
+  switch (command[0]) {
+  case 'A':
+    switch (command[1]) {
+    case 'C': //AC
+      // set/read internal atu status
+      implemented = FALSE;
+      break;
 
+    case 'L': // AL
+      // set/read Auto Notch level
+      implemented = FALSE;
       break;
 
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  case 'Y': //ZZYx
-    switch (command[3]) {
-    case 'R': //ZZYR
-
-      //CATDEF    ZZYR
-      //DESCR     Get/Set active receiver
-      //SET       ZZYRx;
-      //READ      ZZYR;
-      //RESP      ZZYRx;
-      //NOTE      The active receiver is either RX1 (x=0) or RX2 (x=1).
-      //ENDDEF
-      if (command[4] == ';') {
-        snprintf(reply,  sizeof(reply), "ZZYR%01d;", active_receiver->id);
-        send_resp(client->fd, reply);
-      } else if (command[5] == ';') {
-        int v = atoi(&command[4]);
-
-        if (v >= 0 && v < receivers) {
-          schedule_action(v == 0 ? RX1 : RX2, ACTION_PRESSED, 0);
-        } else {
-          implemented = FALSE;
-        }
-
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  case 'Z': //ZZZx
-    switch (command[3]) {
-    case 'D': //ZZZD
-
-      //CATDEF    ZZZD
-      //DESCR     Move down frequency of active receiver
-      //SET       ZZZDxx;
-      //NOTE      ANDROMEDA extension. x = number of VFO steps.
-      //NOTE      For x>10, the number of VFO steps is multiplied with
-      //CONT      a speed-up factor that increases up to 4 at x=30
-      //CONT      (corresponds to 3 turns of the VFO dial per second).
-      //CONT      This implements an over-proportional tuning speed if
-      //CONT      turning the VFO knob faster and faster.
-      //ENDDEF
-      if (command[6] == ';') {
-        int steps = 10 * (command[4] - '0') + (command[5] - '0');
-
-        if (steps <= 30) {
-          steps = andromeda_vfo_speedup[steps];
-        } else {
-          steps *= andromeda_vfo_speedup[31];
-        }
-
-        schedule_action(VFO, ACTION_RELATIVE, -steps);
-      } else {
-        // unexpected command format
-        implemented = FALSE;
-      }
-
-      break;
-
-    case 'E': //ZZZE ANDROMEDA command
-
-      //CATDEF    ZZZE
-      //DESCR     Handle ANDROMEDA encoders
-      //SET       ZZZExxy;
-      //NOTE      ANDROMEDA extension.
-      //NOTE      x encodes the encoder and the direction.
-      //NOTE      x= 1-20 maps to encoder 1-20, clockwise
-      //NOTE      x=51-70 maps to encoder 1-20, counter clockwise
-      //NOTE      y=0-9 is the number of ticks
-      //NOTE
-      //ENDDEF
-      if (command[7] == ';') {
-        int v, p;
-        p = 10 * (command[4] - '0') + (command[5] - '0');
-        v = command[6] - '0';
-
-        if (p > 50) {
-          p -= 50;
-          v = -v;
-        }
-
-        if (v == 0) {
-          // This should not happen, but if, just do nothing
-          break;
-        }
-
-        //
-        // At this place, p is the encoder number (1...20) and
-        // v the number of ticks (-9 ... 9)
-        //
-
-        if (client->andromeda_type == 1) {
-          andromeda_execute_encoder(p, v);
-        } else {
-          if (g2panel_menu_is_open) {
-            g2panel_change_command(client->andromeda_type, CONTROLLER_ENCODER,
-                                   client->buttonvec, client->encodervec, p);
-          } else {
-            g2panel_execute_encoder(client->andromeda_type, client->encodervec, p, v);
-          }
-        }
-      } else {
-        // unexpected command format
-        implemented = FALSE;
-      }
-
-      break;
-
-    case 'I': //ZZZI ANDROMEDA info
-      //CATDEF    ZZZI
-      //DESCR     ANDROMEDA reports
-      //RESP      ZZZIxxy;
-      //NOTE      Automatic generated response for ANDROMEDA controller.
-      //NOTE      The LED with number x shall be switched on (y=1)
-      //NOTE      or off (y=0).
-      //ENDDEF
-      implemented = FALSE;  // this command should never ARRIVE from the console
-      break;
-
-    case 'P': //ZZZP ANDROMEDA command
-
-      //CATDEF    ZZZP
-      //DESCR     Handle ANDROMEDA push-buttons
-      //SET       ZZZPxxy;
-      //NOTE      ANDROMEDA extension.
-      //NOTE      x encodes the button and y means released (y=0),
-      //NOTE      pressed(y=1) or pressed for a longer time (y=2).
-      //ENDDEF
-      if (command[7] == ';') {
-        int p = 10 * (command[4] - '0') + (command[5] - '0');
-        int v = (command[6] - '0');
-
-        //
-        // The Andromeda console will send a v=0 --> v=1 --> v=0 sequence for a short press,
-        // so we have characteristic transitions tr01 (0-->1, upon pressing), tr12 (1-->2, after waiting),
-        // tr10 (1-->0, upon release) and tr20 (2-->0, upon release). For any button, either the sequence
-        // {tr01,tr01} is generated (short press) or the sequence {tr01,tr12,tr20} (long press).
-        //
-        // We have to distinguish "normal" buttons from "long" buttons. "normal" buttons make no difference
-        // between a short and a long press but "long" buttons may generate different actions for short
-        // and long presses.
-        //
-        // "Normal" buttons should generate a "ACTION_PRESSED" upon tr01 and (if required) a "ACTION_RELEASED" upon (tr10 || tr20).
-        // "Long" buttons generate a "ACTION_PRESSED" for the short-press event upon tr10,
-        // and a "ACTION_PRESSED" for the long-press event upon tr12.
-        //
-        // ATTENTION: no RELEASE event is ever triggered for a "long" button. Such events are currently required
-        //            only for PTT, RIT_PLUS, RIT_MINS, XIT_PLUS, XIT_MINUS, and CW keyer actions, which may be associated
-        //            to the "function keys" F1-F8 on the original ANDROMEDA console.
-        //            In all other cases, there is no need to bother the system with RELEASE events.
-        //
-        // NOTE: Rick's code for the original ANDROMEDA console went to andromeda.c
-        //
-        //
-
-        if (client->andromeda_type == 1) {
-          client->shift = andromeda_execute_button(v, p);
-        } else {
-          //
-          // "generic" ANDROMDA push-button section
-          //
-          int tr01, tr10, tr12, tr20;
-          tr01 = 0;  // indicates a v=0 --> v=1 transision
-          tr12 = 0;  // indicates a v=1 --> v=2 transision
-          tr10 = 0;  // indicates a v=1 --> v=0 transision
-          tr20 = 0;  // indicates a v=2 --> v=0 transision
-
-          if (client->last_v == 0 && v == 1) { tr01 = 1; }
-
-          if (client->last_v == 1 && v == 2) { tr12 = 1; }
-
-          if (client->last_v == 1 && v == 0) { tr10 = 1; }
-
-          if (client->last_v == 2 && v == 0) { tr20 = 1; }
-
-          client->last_v = v;
-
-          if (g2panel_menu_is_open) {
-            //
-            // It is enough to "fire" this upon initial press
-            //
-            if (tr01) {
-              g2panel_change_command(client->andromeda_type, CONTROLLER_SWITCH,
-                                     client->buttonvec, client->encodervec, p);
-            }
-          } else {
-            g2panel_execute_button(client->andromeda_type, client->buttonvec, p, tr01, tr10, tr12, tr20);
-          }
-        }
-
-        //
-        // Schedule LED update, in case the state has changed
-        //
-        g_idle_add(andromeda_oneshot_handler, (gpointer) client);
-      } else {
-        // all ANDROMEDA types, unexpected command format
-        implemented = FALSE;
-      }
-
-      break;
-
-    case 'S': //ZZZS ANDROMEDA command
-
-      //CATDEF    ZZZS
-      //DESCR     Log ANDROMEDA version
-      //SET       ZZZSxxyyzzz;
-      //NOTE      ANDROMEDA extension.
-      //NOTE      The ANDROMEDA type (x), hardware (y) and
-      //CONT      software (z) version is printed in the log file.
-      //CONT      The type (x) sent by a client does affect the
-      //CONT      processing of ZZZE and ZZZP commands from that client.
-      //CONT      Only the cases x=1 (original ANDROMEDA console)
-      //CONT      and x=5 (G2 Ultra console) are implemented.
-      //ENDDEF
-      if (command[11] == ';') {
-        //
-        // Besides logging, store the ANDROMEDA type in the client data structure
-        //
-        client->andromeda_type = 10 * (command[4] - '0') + (command[5] - '0');
-        t_print("RIGCTL:INFO: Andromeda Client: Type:%c%c h/w:%c%c s/w:%c%c%c\n",
-                command[4], command[5],
-                command[6], command[7], command[8], command[9], command[10]);
-
-        if (client->andromeda_type == 4 || client->andromeda_type == 5) {
-          //
-          // Initialise commands.
-          //
-          if (client->buttonvec) { g_free(client->buttonvec); }
-
-          if (client->encodervec) { g_free(client->encodervec); }
-
-          client->buttonvec  = g2panel_default_buttons(client->andromeda_type);
-          client->encodervec = g2panel_default_encoders(client->andromeda_type);
-          g2panelRestoreState(client->andromeda_type, client->buttonvec, client->encodervec);
-
-          //
-          // This takes care the G2panel menu is shown in the main menu
-          //
-          if (controller == NO_CONTROLLER) { controller = G2_V2; }
-        }
-      }
-
-      break;
-
-    case 'U': //ZZZU ANDROMEDA command operating on VFO of active receiver
-
-      //CATDEF    ZZZU
-      //DESCR     Move up frequency of active receiver
-      //SET       ZZZUxx;
-      //NOTE      ANDROMEDA extension. x = number of steps.
-      //NOTE      For x>10, the number of VFO steps is multiplied with
-      //CONT      a speed-up factor that increases up to 4 at x=30
-      //CONT      (corresponds to 3 turns of the VFO dial per second).
-      //CONT      This implements an over-proportional tuning speed if
-      //CONT      turning the VFO knob faster and faster.
-      //ENDDEF
-      if (command[6] == ';') {
-        int steps = 10 * (command[4] - '0') + (command[5] - '0');
-
-        if (steps <= 30) {
-          steps = andromeda_vfo_speedup[steps];
-        } else {
-          steps *= andromeda_vfo_speedup[31];
-        }
-
-        schedule_action(VFO, ACTION_RELATIVE, steps);
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  default:
-    implemented = FALSE;
-    break;
-  }
-
-  return implemented;
-}
-
-// called with g_idle_add so that the processing is running on the main thread
-static int parse_cmd(void *data) {
-  COMMAND *info = (COMMAND *)data;
-  CLIENT *client = info->client;
-  char *command = info->command;
-  char reply[256];
-  reply[0] = '\0';
-  gboolean implemented = TRUE;
-
-  switch (command[0]) {
-  case '#':
-
-    //CATDEF    \#S
-    //DESCR     Shutdown Console
-    //SET       \#S;
-    //ENDDEF
-    if (command[1] == 'S' && command[2] == ';') {
-      schedule_action(SHUTDOWN, ACTION_PRESSED, 0);
-    } else {
-      implemented = FALSE;
-    }
-
-    break;
-
-  case 'A':
-    switch (command[1]) {
-    case 'C': //AC
-      // set/read internal atu status
-      implemented = FALSE;
-      break;
-
-    case 'G': //AG
-
-      //CATDEF    AG
-      //DESCR     Sets/Reads audio volume (AF slider)
-      //SET       AGxyyy;
-      //READ      AGx;
-      //RESP      AGxyyy;
-      //NOTE      x=0 sets RX1 audio volume, x=1 sets RX2 audio volume.
-      //NOTE      y is 0...255 and mapped logarithmically to the volume -40...0 dB
-      //ENDDEF
-      if (command[3] == ';') {
-        int id = SET(command[2] == '1');
-        RXCHECK(id,
-                snprintf(reply,  sizeof(reply), "AG%1d%03d;", id, (int)(255.0 * pow(10.0, 0.05 * receiver[id]->volume)));
-                send_resp(client->fd, reply);
-               )
-      } else if (command[6] == ';') {
-        int id = SET(command[2] == '1');
-        int gain = atoi(&command[3]);
-        double vol = (gain < 3) ? -40.0 : 20.0 * log10((double) gain / 255.0);
-        RXCHECK(id, receiver[id]->volume = vol; set_af_gain(0, receiver[id]->volume));
-      }
-
-      break;
-
-    case 'I': //AI
-
-      //CATDEF    AI
-      //DESCR     Sets/Reads auto reporting status
-      //SET       AIx;
-      //READ      AI;
-      //RESP      AIx;
-      //NOTE      x=0: auto-reporting disabled, x>0: enabled.
-      //NOTE      Auto-reporting is affected for the client that sends this command.
-      //CONT      For x=1, only frequency changes are sent via FA/FB commands.
-      //CONT      For x>1, mode changes are also sent via MD commands.
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "AI%d;", client->auto_reporting);
-        send_resp(client->fd, reply) ;
-      } else if (command[3] == ';') {
-        client->auto_reporting = command[2] - '0';
-
-        if (client->auto_reporting < 0) { client->auto_reporting = 0; }
-
-        if (client->auto_reporting > 3) { client->auto_reporting = 3; }
-      }
-
-      break;
-
-    case 'L': // AL
-      // set/read Auto Notch level
-      implemented = FALSE;
-      break;
-
-    case 'M': // AM
-      // set/read Auto Mode
+    case 'M': // AM
+      // set/read Auto Mode
       implemented = FALSE;
       break;
 
@@ -3683,29 +2852,11 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'D': //BD
-      //CATDEF    BD
-      //DESCR     VFO-A Band down
-      //SET       BD;
-      //NOTE      Wraps from the lowest to the highest band.
-      //ENDDEF
-      band_minus(receiver[0]->id);
-      break;
-
     case 'P': //BP
       // set/read Manual Beat Canceller frequency
       implemented = FALSE;
       break;
 
-    case 'U': //BU
-      //CATDEF    BU
-      //DESCR     VFO-A Band up
-      //SET       BU;
-      //NOTE      Wraps from the highest to the lowest band.
-      //ENDDEF
-      band_plus(receiver[0]->id);
-      break;
-
     case 'Y': //BY
       // read busy signal
       implemented = FALSE;
@@ -3740,61 +2891,6 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'N': //CN
-
-      //CATDEF    CN
-      //DESCR     Sets/Reads the CTCSS frequency
-      //SET       CNxx;
-      //READ      CN;
-      //RESP      CNxx;
-      //NOTE      x =  1...38. CTCSS frequencies in Hz are:
-      //CONT      67.0 (x=1),  71.9 (x=2),  74.4 (x=3),  77.0 (x=4),
-      //CONT      79.7 (x=5),  82.5 (x=6),  85.4 (x=7),  88.5 (x=8),
-      //CONT      91.5 (x=9),  94.8 (x=10), 97.4 (x=11), 100.0 (x=12)
-      //CONT      103.5 (x=13), 107.2 (x=14), 110.9 (x=15), 114.8 (x=16)
-      //CONT      118.8 (x=17), 123.0 (x=18), 127.3 (x=19), 131.8 (x=20)
-      //CONT      136.5 (x=21), 141.3 (x=22), 146.2 (x=23), 151.4 (x=24)
-      //CONT      156.7 (x=25), 162.2 (x=26), 167.9 (x=27), 173.8 (x=28)
-      //CONT      179.9 (x=29), 186.2 (x=30), 192.8 (x=31), 203.5 (x=32)
-      //CONT      210.7 (x=33), 218.1 (x=34), 225.7 (x=35), 233.6 (x=36)
-      //CONT      241.8 (x=37), 250.3 (x=38).
-      //ENDDEF
-      // sets/reads CTCSS function (frequency)
-      if (can_transmit) {
-        if (command[2] == ';') {
-          snprintf(reply,  sizeof(reply), "CN%02d;", transmitter->ctcss + 1);
-          send_resp(client->fd, reply) ;
-        } else if (command[4] == ';') {
-          transmitter->ctcss = atoi(&command[2]) - 1;
-          tx_set_ctcss(transmitter);
-          g_idle_add(ext_vfo_update, NULL);
-        }
-      }
-
-      break;
-
-    case 'T': //CT
-
-      //CATDEF    CT
-      //DESCR     Enable/Disable CTCSS
-      //SET       CTx;
-      //READ      CT;
-      //RESP      CTx;
-      //NOTE      x = 0: CTCSS off, x=1: on
-      //ENDDEF
-      if (can_transmit) {
-        if (command[2] == ';') {
-          snprintf(reply,  sizeof(reply), "CT%d;", transmitter->ctcss_enabled);
-          send_resp(client->fd, reply) ;
-        } else if (command[3] == ';') {
-          transmitter->ctcss_enabled = SET(command[2] == '1');
-          tx_set_ctcss(transmitter);
-          g_idle_add(ext_vfo_update, NULL);
-        }
-      }
-
-      break;
-
     default:
       implemented = FALSE;
       break;
@@ -3809,15 +2905,6 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'N': //DN
-      //CATDEF    DN
-      //DESCR     VFO-A down  one step
-      //SET       DN;
-      //NOTE      Parameters may be given, but are ignored.
-      //ENDDEF
-      vfo_id_step(VFO_A, -1);
-      break;
-
     case 'Q': //DQ
       // set/read DCS function status
       implemented = FALSE;
@@ -3846,56 +2933,6 @@ static int parse_cmd(void *data) {
 
   case 'F':
     switch (command[1]) {
-    case 'A': //FA
-
-      //CATDEF    FA
-      //DESCR     Set/Read VFO-A frequency
-      //SET       FAxxxxxxxxxxx;
-      //READ      FA;
-      //RESP      FAxxxxxxxxxxx;
-      //NOTE      x in Hz, left-padded with zeroes
-      //ENDDEF
-      if (command[2] == ';') {
-        if (vfo[VFO_A].ctun) {
-          snprintf(reply,  sizeof(reply), "FA%011lld;", vfo[VFO_A].ctun_frequency);
-        } else {
-          snprintf(reply,  sizeof(reply), "FA%011lld;", vfo[VFO_A].frequency);
-        }
-
-        send_resp(client->fd, reply) ;
-      } else if (command[13] == ';') {
-        long long f = atoll(&command[2]);
-        vfo_id_set_frequency(VFO_A, f);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    case 'B': //FB
-
-      //CATDEF    FB
-      //DESCR     Set/Read VFO-B frequency
-      //SET       FBxxxxxxxxxxx;
-      //READ      FB;
-      //RESP      FBxxxxxxxxxxx;
-      //NOTE      x in Hz, left-padded with zeroes
-      //ENDDEF
-      if (command[2] == ';') {
-        if (vfo[VFO_B].ctun) {
-          snprintf(reply,  sizeof(reply), "FB%011lld;", vfo[VFO_B].ctun_frequency);
-        } else {
-          snprintf(reply,  sizeof(reply), "FB%011lld;", vfo[VFO_B].frequency);
-        }
-
-        send_resp(client->fd, reply) ;
-      } else if (command[13] == ';') {
-        long long f = atoll(&command[2]);
-        vfo_id_set_frequency(VFO_B, f);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
     case 'C': //FC
       // set/read the sub receiver VFO frequency menu
       implemented = FALSE;
@@ -3906,269 +2943,45 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'R': //FR
-
-      //CATDEF    FR
-      //DESCR     Set/Read active receiver
-      //SET       FRx;
-      //READ      FR;
-      //RESP      FRx;
-      //NOTE      x = 0 (RX1) or 1 (RX2)
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "FR%d;", active_receiver->id);
-        send_resp(client->fd, reply) ;
-      } else if (command[3] == ';') {
-        int id = SET(command[2] == '1');
-        RXCHECK(id, schedule_action(id == 0 ? RX1 : RX2, ACTION_PRESSED, 0));
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
     case 'S': //FS
       // set/read the fine tune function status
       implemented = FALSE;
       break;
 
-    case 'T': //FT
+    default:
+      implemented = FALSE;
+      break;
+    }
 
-      //CATDEF    FT
-      //DESCR     Set/Read Split status
-      //SET       FTx;
-      //READ      FT;
-      //RESP      FTx;
-      //NOTE      x=0: TX VFO is the VFO controlling the active receiver, x=1: the other VFO.
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "FT%d;", split);
-        send_resp(client->fd, reply) ;
-      } else if (command[3] == ';') {
-        int id = SET(command[2] == '1');
-        radio_set_split(id);
-      }
+    break;
 
+  case 'H':
+    switch (command[1]) {
+    default:
+      implemented = FALSE;
       break;
+    }
+
+    break;
 
-    case 'W': //FW
+  case 'I':
+    switch (command[1]) {
+    case 'S': //IS
 
-      //CATDEF    FW
-      //DESCR     Set/Read VFO-A filter width (CW, AM, FM)
-      //SET       FWxxxx;
-      //READ      FW;
-      //RESP      FWxxxx;
-      //NOTE      When setting, this switches to the Var1 filter and sets its  width to x.
-      //CONT      Only valid for CW, FM, AM. Use SH/SL for LSB, USB, DIGL, DIGU.
-      //NOTE      For AM, 8kHz filter width (x=0) or  16 kHz (x$\ne$0)
-      //NOTE      For FM, 2.5kHz deviation (x=0) or 5 kHz (x$\ne$0)
-      //ENDDEF
+      //DO NOT DOCUMENT, THIS WILL BE REMOVED
       if (command[2] == ';') {
-        int val = 0;
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        const FILTER *filter = &mode_filters[vfo[VFO_A].filter];
-
-        switch (vfo[VFO_A].mode) {
-        case modeCWL:
-        case modeCWU:
-          val = filter->low * 2;
-          break;
+        snprintf(reply,  sizeof(reply), "%s", "IS 0000;");
+        send_resp(client, reply);
+      } else {
+        implemented = FALSE;
+      }
 
-        case modeAM:
-        case modeSAM:
-          val = filter->low >= -4000;
-          break;
+      break;
 
-        case modeFMN:
-          val = vfo[VFO_A].deviation == 5000;
-          break;
-
-        default:
-          implemented = FALSE;
-          break;
-        }
-
-        if (implemented) {
-          snprintf(reply,  sizeof(reply), "FW%04d;", val);
-          send_resp(client->fd, reply) ;
-        }
-      } else if (command[6] == ';') {
-        // make sure filter is filterVar1
-        if (vfo[VFO_A].filter != filterVar1) {
-          vfo_id_filter_changed(VFO_A, filterVar1);
-        }
-
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        FILTER *filter = &mode_filters[filterVar1];
-        int fw = atoi(&command[2]);
-        filter->low = fw;
-
-        switch (vfo[VFO_A].mode) {
-        case modeCWL:
-        case modeCWU:
-          filter->low = fw / 2;
-          filter->high = fw / 2;
-          break;
-
-        case modeFMN:
-          if (fw == 0) {
-            filter->low = -5500;
-            filter->high = 5500;
-            vfo[VFO_A].deviation = 2500;
-          } else {
-            filter->low = -8000;
-            filter->high = 8000;
-            vfo[VFO_A].deviation = 5000;
-          }
-
-          rx_set_filter(receiver[0]);
-
-          if (can_transmit) {
-            tx_set_filter(transmitter);
-          }
-
-          g_idle_add(ext_vfo_update, NULL);
-          break;
-
-        case modeAM:
-        case modeSAM:
-          if (fw == 0) {
-            filter->low = -4000;
-            filter->high = 4000;
-          } else {
-            filter->low = -8000;
-            filter->high = 8000;
-          }
-
-          break;
-
-        default:
-          implemented = FALSE;
-          break;
-        }
-
-        if (implemented) {
-          vfo_id_filter_changed(VFO_A, filterVar1);
-          g_idle_add(ext_vfo_update, NULL);
-        }
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  case 'G':
-    switch (command[1]) {
-    case 'T': //GT
-
-      //CATDEF    GT
-      //DESCR     Set/Read RX1 AGC
-      //SET       GTxxx;
-      //READ      GT;
-      //RESP      GTxxx;
-      //NOTE      x=0: AGC OFF, x=5: LONG, x=10: SLOW,
-      //CONT      x=15: MEDIUM, x=20: FAST.
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "GT%03d;", receiver[0]->agc * 5);
-        send_resp(client->fd, reply) ;
-      } else if (command[5] == ';') {
-        receiver[0]->agc = atoi(&command[2]) / 5;
-        rx_set_agc(receiver[0]);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  case 'H':
-    switch (command[1]) {
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
-  case 'I':
-    switch (command[1]) {
-    case 'D': //ID
-      //CATDEF    ID
-      //DESCR     Get radio model ID
-      //READ      ID;
-      //RESP      IDxxx;
-      //NOTE      piHPSDR responds ID019; (so does the Kenwood TS-2000)
-      //ENDDEF
-      snprintf(reply,  sizeof(reply), "%s", "ID019;");
-      send_resp(client->fd, reply);
-      break;
-
-    case 'F': { //IF
-      //CATDEF    IF
-      //DESCR     Get VFO-A Frequency/Mode etc.
-      //READ      IF;
-      //RESP      IFxxxxxxxxxxxyyyyzzzzzzsbc|ddefghikllm;
-      //NOTE      x : VFO-A Frequency (11 digit)
-      //NOTE      y : VFO-A step size
-      //NOTE      z : VFO-A rit step size
-      //NOTE      s : VFO-A rit enabled (0/1)
-      //NOTE      b : VFO-A xit enabled (0/1)
-      //NOTE      c : always 0
-      //NOTE      d : always 0
-      //NOTE      e : RX (e=0) or TX (e=1)
-      //NOTE      f : mode (TS-2000 encoding, see MD command)
-      //NOTE      g : always 0
-      //NOTE      h : always 0
-      //NOTE      i : Split enabled (i=1) or disabled (i=0)
-      //NOTE      k : CTCSS enabled (i=2) or disabled (i=0)
-      //NOTE      l : CTCSS frequency (1 - 38), see CN command
-      //NOTE      m : always 0
-      //ENDDEF
-      int mode = ts2000_mode(vfo[VFO_A].mode);
-      int tx_xit_en = 0;
-      int tx_ctcss_en = 0;
-      int tx_ctcss = 0;
-
-      if (can_transmit) {
-        tx_xit_en   = vfo[vfo_get_tx_vfo()].xit_enabled;
-        tx_ctcss    = transmitter->ctcss + 1;
-        tx_ctcss_en = transmitter->ctcss_enabled;
-      }
-
-      snprintf(reply,  sizeof(reply), "IF%011lld%04d%+06lld%d%d%d%02d%d%d%d%d%d%d%02d%d;",
-               vfo[VFO_A].ctun ? vfo[VFO_A].ctun_frequency : vfo[VFO_A].frequency,
-               vfo[VFO_A].step, vfo[VFO_A].rit, vfo[VFO_A].rit_enabled, tx_xit_en,
-               0, 0, radio_is_transmitting(), mode, 0, 0, split, tx_ctcss_en ? 2 : 0, tx_ctcss, 0);
-      send_resp(client->fd, reply);
-    }
-    break;
-
-    case 'S': //IS
-
-      //DO NOT DOCUMENT, THIS WILL BE REMOVED
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "%s", "IS 0000;");
-        send_resp(client->fd, reply);
-      } else {
-        implemented = FALSE;
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
+    default:
+      implemented = FALSE;
+      break;
+    }
 
     break;
 
@@ -4181,121 +2994,8 @@ static int parse_cmd(void *data) {
 
     break;
 
-  case 'K':
-    switch (command[1]) {
-    case 'S': //KS
-
-      //CATDEF    KS
-      //DESCR     Set CW speed
-      //SET       KSxxx;
-      //READ      KS;
-      //RESP      KSxxx;
-      //NOTE      x (1 - 60) is in wpm
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "KS%03d;", cw_keyer_speed);
-        send_resp(client->fd, reply);
-      } else if (command[5] == ';') {
-        int speed = atoi(&command[2]);
-
-        if (speed >= 1 && speed <= 60) {
-          cw_keyer_speed = speed;
-          keyer_update();
-          g_idle_add(ext_vfo_update, NULL);
-        }
-      }
-
-      break;
-
-    case 'Y': //KY
-
-      //CATDEF    KY
-      //DESCR     Send Morse/query Morse buffer
-      //SET       KYxyyy...yyy;
-      //READ      KY;
-      //RESP      KYx;
-      //NOTE      When setting (sending), x must be a space.
-      //CONT      When reading, x=1 indicates buffer space is available, x=0  buffer full
-      //NOTE      y: string of up to 24 characters NOT containing ';'.
-      //CONT      Trailing blanks are ignored in y, but if it is completely blank it causes an inter-word space.
-      //ENDDEF
-      if (command[2] == ';') {
-        //
-        // reply "buffer full" condition if the buffer contains
-        // more than (CW_BUF_SIZE-24) characters.
-        //
-        int avail = cw_buf_in - cw_buf_out;
-
-        if (avail < 0) { avail += CW_BUF_SIZE; }
-
-        if (avail < CW_BUF_SIZE - 24) {
-          snprintf(reply,  sizeof(reply), "KY0;");
-        } else {
-          snprintf(reply,  sizeof(reply), "KY1;");
-        }
-
-        send_resp(client->fd, reply);
-      } else {
-        //
-        // Recent versions of Hamlib send CW messages one character at a time.
-        // So all trailing blanks have to be removed, and an entirely blank
-        // message is interpreted as a inter-word distance.
-        // Note we allow variable lengths of incoming messages here, although
-        // the standard says they are exactly 24 characters long.
-        //
-        int j = 3;
-
-        for (unsigned int i = 3; i < strlen(command); i++) {
-          if (command[i] == ';') { break; }
-
-          if (command[i] != ' ') { j = i; }
-        }
-
-        // j points to the last non-blank character, or to the first blank
-        // in an empty string
-        for (int i = 3; i <= j; i++) {
-          int new = cw_buf_in + 1;
-
-          if (new >= CW_BUF_SIZE) { new = 0; }
-
-          if (new != cw_buf_out) {
-            cw_buf[cw_buf_in] = command[i];
-            cw_buf_in = new;
-          }
-        }
-      }
-
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
-    }
-
-    break;
-
   case 'L':
     switch (command[1]) {
-    case 'K': //LK
-
-      //CATDEF    LK
-      //DESCR     Set/Read Lock status
-      //SET       LKxx;
-      //READ      LK;
-      //RESP      LKxx;
-      //NOTE      When setting, any nonzero x sets lock status.
-      //CONT      When reading, x = 00 (not locked) or x = 11 (locked)
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "LK%d%d;", locked, locked);
-        send_resp(client->fd, reply);
-      } else if (command[4] == ';') {
-        locked = atoi(&command[2]);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
     case 'M': //LM
       // set/read keyer recording status
       implemented = FALSE;
@@ -4320,62 +3020,11 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'D': //MD
-
-      //CATDEF    MD
-      //DESCR     Set/Read VFO-A modes
-      //SET       MDx;
-      //READ      MD;
-      //RESP      MDx;
-      //NOTE      Kenwood-type  mode  list:
-      //CONT      LSB (x=1), USB (x=2), CWU (x=3), FMN (x=4),
-      //CONT      AM (x=5), DIGL (x=6), CWL (x=7), DIGU (x=9)
-      //ENDDEF
-      if (command[2] == ';') {
-        int mode = ts2000_mode(vfo[VFO_A].mode);
-        snprintf(reply,  sizeof(reply), "MD%d;", mode);
-        send_resp(client->fd, reply);
-      } else if (command[3] == ';') {
-        int mode = wdspmode(atoi(&command[2]));
-        vfo_id_mode_changed(VFO_A, mode);
-      }
-
-      break;
-
     case 'F': //MF
       // set/read Menu
       implemented = FALSE;
       break;
 
-    case 'G': //MG
-
-      //CATDEF    MG
-      //DESCR     Set/Read Mic gain (Mic gain slider)
-      //SET       MGxxx;
-      //READ      MG;
-      //RESP      MGxxx;
-      //NOTE      x 0-100 mapped to -12 ... +50 dB
-      //ENDDEF
-      if (can_transmit) {
-        if (command[2] == ';') {
-          snprintf(reply,  sizeof(reply), "MG%03d;", (int)(((transmitter->mic_gain + 12.0) / 62.0) * 100.0));
-          send_resp(client->fd, reply);
-        } else if (command[5] == ';') {
-          double gain = (double)atoi(&command[2]);
-          gain = ((gain / 100.0) * 62.0) - 12.0;
-
-          if (gain < -12.0) { gain = -12.0; }
-
-          if (gain > 50.0) { gain = 50.0; }
-
-          set_mic_gain(gain);
-        }
-      } else {
-        implemented = FALSE;
-      }
-
-      break;
-
     case 'L': //ML
       // set/read Monitor Function Level
       implemented = FALSE;
@@ -4410,68 +3059,11 @@ static int parse_cmd(void *data) {
 
   case 'N':
     switch (command[1]) {
-    case 'B': //NB
-
-      //CATDEF    NB
-      //DESCR     Set/Read RX1 noise blanker
-      //SET       NBx;
-      //READ      NB;
-      //RESP      NBx;
-      //NOTE      x=0: NB off, x=1: NB1 on, x=2: NB2 on
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "NB%d;", receiver[0]->nb);
-        send_resp(client->fd, reply);
-      } else if (command[3] == ';') {
-        receiver[0]->nb = atoi(&command[2]);
-        rx_set_noise(receiver[0]);
-      }
-
-      break;
-
     case 'L': //NL
       // set/read noise blanker level
       implemented = FALSE;
       break;
 
-    case 'R': //NR
-
-      //CATDEF    NR
-      //DESCR     Set/Read RX1 noise reduction
-      //SET       NRx;
-      //READ      NR;
-      //RESP      NRx;
-      //NOTE      x=0: NR off, x=1: NR1 on, x=2: NR2 on
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "NR%d;", receiver[0]->nr);
-        send_resp(client->fd, reply);
-      } else if (command[3] == ';')  {
-        receiver[0]->nr = atoi(&command[2]);
-        rx_set_noise(receiver[0]);
-      }
-
-      break;
-
-    case 'T': //NT
-
-      //CATDEF    NT
-      //DESCR     Set/Read RX1 auto notch filter
-      //SET       NTx;
-      //READ      NT;
-      //RESP      NTx;
-      //NOTE      x=0: Automatic Notch Filter off, x=1: on
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "NT%d;", receiver[0]->anf);
-        send_resp(client->fd, reply);
-      } else if (command[3] == ';') {
-        receiver[0]->anf = atoi(&command[2]);
-        rx_set_noise(receiver[0]);
-      }
-
-      break;
-
     default:
       implemented = FALSE;
       break;
@@ -4505,51 +3097,11 @@ static int parse_cmd(void *data) {
 
   case 'P':
     switch (command[1]) {
-    case 'A': //PA
-
-      //CATDEF    PA
-      //DESCR     Set/Read RX1 preamp status
-      //SET       PAx;
-      //READ      PA;
-      //RESP      PAx;
-      //NOTE      Applies to RX1
-      //NOTE      x=0: RX1 preamp off, x=1: on
-      //NOTE      newer HPSDR radios do not have a switchable preamp
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "PA%d0;", receiver[0]->preamp);
-        send_resp(client->fd, reply);
-      } else if (command[4] == ';') {
-        receiver[0]->preamp = command[2] == '1';
-      }
-
-      break;
-
     case 'B': //PB
       // set/read FRU-3A playback status
       implemented = FALSE;
       break;
 
-    case 'C': //PC
-
-      //CATDEF    PC
-      //DESCR     Set/Read TX power (Drive slider)
-      //SET       PCxxx;
-      //READ      PC;
-      //RESP      PCxxx;
-      //NOTE      x = 0...100
-      //ENDDEF
-      if (can_transmit) {
-        if (command[2] == ';') {
-          snprintf(reply,  sizeof(reply), "PC%03d;", (int)transmitter->drive);
-          send_resp(client->fd, reply);
-        } else if (command[5] == ';') {
-          set_drive((double)atoi(&command[2]));
-        }
-      }
-
-      break;
-
     case 'I': //PI
       // store in program memory channel
       implemented = FALSE;
@@ -4560,32 +3112,6 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'L': //PL
-
-      //CATDEF    PL
-      //DESCR     Set/Read TX compressor level
-      //SET       PLxxxyyy;
-      //READ      PL;
-      //RESP      PLxxxyyy;
-      //NOTE      x = 0...100, maps to compression 0...20 dB.
-      //NOTE      y ignored when setting, y=0 when reading
-      //ENDDEF
-      if (can_transmit) {
-        if (command[2] == ';') {
-          snprintf(reply,  sizeof(reply), "PL%03d000;", (int)(5.0 * transmitter->compressor_level));
-          send_resp(client->fd, reply);
-        } else if (command[8] == ';') {
-          command[5] = '\0';
-          double level = (double)atoi(&command[2]);
-          level = 0.2 * level;
-          transmitter->compressor_level = level;
-          tx_set_compressor(transmitter);
-          g_idle_add(ext_vfo_update, NULL);
-        }
-      }
-
-      break;
-
     case 'M': //PM
       // recall program memory
       implemented = FALSE;
@@ -4596,33 +3122,6 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'S': //PS
-
-      //CATDEF    PS
-      //DESCR     Set/Read power status
-      //SET       PSx;
-      //READ      PS;
-      //RESP      PSx;
-      //NOTE      x = 1: Power on, x=0: off
-      //NOTE      When setting, x=1 is ignored and x=0 leads to shutdown
-      //NOTE      Reading always reports x=1
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "PS1;");
-        send_resp(client->fd, reply);
-      } else if (command[3] == ';') {
-        int pwrc = atoi(&command[2]);
-
-        if ( pwrc == 0 ) {
-          schedule_action(SHUTDOWN, ACTION_PRESSED, 0);
-        } else {
-          // power-on command. Should there be a reply?
-          // snprintf(reply,  sizeof(reply), "PS1;");
-        }
-      }
-
-      break;
-
     default:
       implemented = FALSE;
       break;
@@ -4656,90 +3155,6 @@ static int parse_cmd(void *data) {
 
   case 'R':
     switch (command[1]) {
-    case 'A': //RA
-
-      //CATDEF    RA
-      //DESCR     Set/Read RX1 attenuator or RX1 gain
-      //SET       RAxx;
-      //READ      RA;
-      //RESP      RAxxyy;
-      //NOTE      x = 0 ... 99 is mapped to the attenuation range available.
-      //NOTE      HPSDR radios: attenuator range 0...31 dB,
-      //CONT      HermesLite-II etc.: gain range -12...48 dB.
-      //CONT      y is always zero.
-      //ENDDEF
-      // set/read Attenuator function
-      if (command[2] == ';') {
-        int att = 0;
-
-        if (have_rx_gain) {
-          // map gain value -12...48 to 0...99
-          att = (int)(adc[receiver[0]->adc].attenuation + 12);
-          att = (int)(((double)att / 60.0) * 99.0);
-        }
-
-        if (have_rx_att) {
-          // map att value -31 ... 0 to 0...99
-          att = (int)(adc[receiver[0]->adc].attenuation);
-          att = (int)(((double)att / 31.0) * 99.0);
-        }
-
-        snprintf(reply,  sizeof(reply), "RA%02d00;", att);
-        send_resp(client->fd, reply);
-      } else if (command[4] == ';') {
-        int att = atoi(&command[2]);
-
-        if (have_rx_gain) {
-          // map 0...99 scale to -12...48
-          att = (int)((((double)att / 99.0) * 60.0) - 12.0);
-          set_rf_gain(VFO_A, (double)att);
-        }
-
-        if (have_rx_att) {
-          // mapp 0...99 scale to 0...31
-          att = (int)(((double)att / 99.0) * 31.0);
-          set_attenuation_value((double)att);
-        }
-      }
-
-      break;
-
-    case 'C': //RC
-
-      //CATDEF    RC
-      //DESCR     Clear VFO-A RIT value
-      //SET       RC;
-      //ENDDEF
-      if (command[2] == ';') {
-        vfo[VFO_A].rit = 0;
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
-    case 'D': //RD
-
-      //CATDEF    RD
-      //DESCR     Set or Decrement VFO-A RIT value
-      //SET       RDxxxxx;
-      //NOTE      When x is not given (RD;)  decrement by 10 Hz (CW modes) or 50 Hz (other modes).
-      //CONT      When x is given, set VFO-A rit value to the negative of x.
-      //ENDDEF
-      if (command[2] == ';') {
-        if (vfo[VFO_A].mode == modeCWL || vfo[VFO_A].mode == modeCWU) {
-          vfo[VFO_A].rit -= 10;
-        } else {
-          vfo[VFO_A].rit -= 50;
-        }
-
-        g_idle_add(ext_vfo_update, NULL);
-      } else if (command[7] == ';') {
-        vfo[VFO_A].rit = -atoi(&command[2]);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
-      break;
-
     case 'G': //RG
       // set/read RF gain status
       implemented = FALSE;
@@ -4755,737 +3170,2825 @@ static int parse_cmd(void *data) {
       implemented = FALSE;
       break;
 
-    case 'T': //RT
-
-      //CATDEF    RT
-      //DESCR     Read/Set VFO-A RIT status
-      //SET       RTx;
-      //READ      RT;
-      //RESP      RTx;
-      //NOTE      x=0: VFO-A RIT off, x=1: on
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "RT%d;", vfo[VFO_A].rit_enabled);
-        send_resp(client->fd, reply);
-      } else if (command[3] == ';') {
-        vfo[VFO_A].rit_enabled = atoi(&command[2]);
-        g_idle_add(ext_vfo_update, NULL);
-      }
-
+    default:
+      implemented = FALSE;
       break;
+    }
+
+    break;
+
+  case 'S':
+    switch (command[1]) {
+    case 'B': //SB
+      // set/read SUB,TF-W status
+      implemented = FALSE;
+      break;
+
+    case 'C': //SC
+      // set/read SCAN function status
+      implemented = FALSE;
+      break;
+
+    case 'I': //SI
+      // enter satellite memory name
+      implemented = FALSE;
+      break;
+
+    case 'R': //SR
+      // reset transceiver
+      implemented = FALSE;
+      break;
+
+    case 'S': //SS
+      // set/read program scan pause frequency
+      implemented = FALSE;
+      break;
+
+    case 'T': //ST
+      // set/read MULTI/CH channel frequency steps
+      implemented = FALSE;
+      break;
+
+    case 'U': //SU
+      // set/read program scan pause frequency
+      implemented = FALSE;
+      break;
+
+    case 'V': //SV
+      // execute memory transfer function
+      implemented = FALSE;
+      break;
+
+    default:
+      implemented = FALSE;
+      break;
+    }
+
+    break;
+
+  case 'T':
+    switch (command[1]) {
+    case 'C': //TC
+      // set/read internal TNC mode
+      implemented = FALSE;
+      break;
+
+    case 'D': //TD
+      // send DTMF memory channel data
+      implemented = FALSE;
+      break;
+
+    case 'I': //TI
+      // read TNC LED status
+      implemented = FALSE;
+      break;
+
+    case 'N': //TN
+      // set/read sub-tone frequency
+      implemented = FALSE;
+      break;
+
+    case 'O': //TO
+      // set/read TONE function
+      implemented = FALSE;
+      break;
+
+    case 'S': //TS
+      // set/read TF-SET function
+      implemented = FALSE;
+      break;
+
+    default:
+      implemented = FALSE;
+      break;
+    }
+
+    break;
+
+  case 'U':
+    switch (command[1]) {
+    case 'L': //UL
+      // detects the PLL unlock status
+      implemented = FALSE;
+      break;
+
+    default:
+      implemented = FALSE;
+      break;
+    }
+
+    break;
+
+  case 'V':
+    switch (command[1]) {
+    case 'D': //VD
+      // set/read VOX delay time
+      implemented = FALSE;
+      break;
+
+    case 'R': //VR
+      // emulate VOICE1 or VOICE2 key
+      implemented = FALSE;
+      break;
+
+    default:
+      implemented = FALSE;
+      break;
+    }
+
+    break;
+
+  case 'W':
+    switch (command[1]) {
+    default:
+      implemented = FALSE;
+      break;
+    }
+
+    break;
+
+
+  case 'Y':
+    switch (command[1]) {
+    default:
+      implemented = FALSE;
+      break;
+    }
+
+    break;
+
+  case 'Z':
+    switch (command[1]) {
+    case 'Z':
+      implemented = parse_undocumented_extended_cmd(command, client);
+      break;
+
+    default:
+      implemented = FALSE;
+      break;
+    }
+
+    break;
+
+  default:
+    implemented = FALSE;
+    break;
+  }
+
+  return implemented;
+}
+
+// called with g_idle_add so that the processing is running on the main thread
+static void parse_cmd(CLIENT *client, const CATDEF *def, char *command) {
+  char reply[256];
+  reply[0] = '\0';
+  gboolean implemented = TRUE;
+
+  //
+  // Commands documented in a CATDEF block whose length does not match
+  // any of the documented SET/READ forms are rejected right here, so
+  // the individual cases need not care about malformed input.
+  // Undocumented commands are passed on unchecked.
+  //
+  if (catdef_valid(def, strlen(command)) == 0) {
+    if (rigctl_debug) { t_print("RIGCTL: MALFORMED COMMAND: %s\n", command); }
+
+    send_resp(client, "?;");
+    client->done = 1;
+    return;
+  }
+
+  //
+  // Documented commands are dispatched on the id of their CATDEF block,
+  // the table entry has been looked up when the command arrived.
+  //
+  switch (def != NULL ? def->id : CAT_UNDOCUMENTED) {
+  case CAT_ZZAC:
+
+    //CATDEF    ZZAC
+    //DESCR     Set/read VFO-A step size
+    //SET       ZZACxx;
+    //READ      ZZAC;
+    //RESP      ZZACxx;
+    //NOTE      x 0...16 encodes the step size:
+    //NOTE      1 Hz (x=0), 10 Hz (x=1), 25 Hz (x=2), 50 Hz (x=3)
+    //CONT      100 Hz (x=4), 250 Hz (x=5), 500 Hz (x=6)
+    //CONT      1000 Hz (x=7), 5000 Hz (x=8), 6250 Hz (x=9)
+    //CONT      9 kHz (x=10), 10 kHz (x=11), 12.5 kHz (x=12)
+    //CONT      100 kHz (x=13), 250 kHz (x=14)
+    //CONT      500 kHz (x=15), 1 MHz (x=16).
+    //ENDDEF
+    if (command[4] == ';') {
+      // read the step size
+      snprintf(reply,  sizeof(reply), "ZZAC%02d;", vfo_id_get_stepindex(VFO_A));
+      send_resp(client, reply) ;
+    } else if (command[6] == ';') {
+      // set the step size
+      int i = atoi(&command[4]) ;
+      vfo_id_set_step_from_index(VFO_A, i);
+      g_idle_add(ext_vfo_update, NULL);
+    } else {
+    }
+
+    break;
+
+  case CAT_ZZAD:
+
+    //CATDEF    ZZAD
+    //DESCR     Move down VFO-A frequency by a selected step
+    //SET       ZZADxx;
+    //NOTE      x encodes the step size, see ZZAC command.
+    //ENDDEF
+    if (command[6] == ';') {
+      int step_index = atoi(&command[4]);
+      long long hz = (long long) vfo_get_step_from_index(step_index);
+      vfo_id_move(VFO_A, -hz, FALSE);
+    } else {
+    }
+
+    break;
+
+  case CAT_ZZAE:
+
+    //CATDEF    ZZAE
+    //DESCR     Move down VFO-A frequency by several steps
+    //SET       ZZAExx;
+    //NOTE      VFO-A frequency moved down by x (0...99) times the current step size
+    //ENDDEF
+    if (command[6] == ';') {
+      int steps = atoi(&command[4]);
+      vfo_id_step(VFO_A, -steps);
+    }
+
+    break;
+
+  case CAT_ZZAF:
+
+    //CATDEF    ZZAF
+    //DESCR     Move up VFO-A frequency by several steps
+    //SET       ZZAFxx;
+    //NOTE      VFO-A frequency moved up by x (0...99) times the current step size
+    //ENDDEF
+    if (command[6] == ';') {
+      int steps = atoi(&command[4]);
+      vfo_id_step(VFO_A, steps);
+    }
+
+    break;
+
+  case CAT_ZZAG:
+
+    //CATDEF    ZZAG
+    //DESCR     Set/Read RX1 volume (AF slider)
+    //SET       ZZAGxxx;
+    //READ      ZZAG;
+    //RESP      ZZAGxxx;
+    //NOTE      x = 0...100, mapped logarithmically to -40 ... 0 dB.
+    //ENDDEF
+    if (command[4] == ';') {
+      // send reply back
+      snprintf(reply,  sizeof(reply), "ZZAG%03d;", (int)(100.0 * pow(10.0, 0.05 * receiver[0]->volume)));
+      send_resp(client, reply) ;
+    } else {
+      int gain = atoi(&command[4]);
+
+      if (gain < 2) {
+        receiver[0]->volume = -40.0;
+      } else {
+        receiver[0]->volume = 20.0 * log10(0.01 * (double) gain);
+      }
+
+      set_af_gain(0, receiver[0]->volume);
+    }
+
+    break;
+
+  case CAT_ZZAI:
+
+    //CATDEF    ZZAI
+    //DESCR     Set/Read auto-reporting
+    //SET       ZZAIx;
+    //READ      ZZAI;
+    //RESP      ZZAIx;
+    //NOTE      x=0: auto-reporting disabled, x>0: enabled.
+    //NOTE      Auto-reporting is affected for the client that sends this command.
+    //CONT      For x=1, only frequency changes are sent via FA/FB commands.
+    //CONT      For x>1, mode changes are also sent via MD commands.
+    //ENDDEF
+    if (command[4] == ';') {
+      // Query status
+      snprintf(reply,  sizeof(reply), "ZZAI%d;", client->auto_reporting);
+      send_resp(client, reply) ;
+    } else if (command[5] == ';') {
+      client->auto_reporting = command[4] - '0';
+
+      if (client->auto_reporting < 0) { client->auto_reporting = 0; }
+
+      if (client->auto_reporting > 3) { client->auto_reporting = 3; }
+
+      notify_changed(NOTIFY_VFO | NOTIFY_MODE);
+    } else {
+      implemented = FALSE;
+    }
+
+    break;
+
+  case CAT_ZZAR:
+
+    //CATDEF    ZZAR
+    //DESCR     Set/Read RX1 AGC gain
+    //SET       ZZARxxxx;
+    //READ      ZZAR;
+    //RESP      ZZARxxxx;
+    //NOTE      x -20...120, must contain + or - sign.
+    //ENDDEF
+    if (command[4] == ';') {
+      // send reply back
+      snprintf(reply,  sizeof(reply), "ZZAR%+04d;", (int)(receiver[0]->agc_gain));
+      send_resp(client, reply) ;
+    } else {
+      int threshold = atoi(&command[4]);
+      set_agc_gain(VFO_A, (double)threshold);
+    }
+
+    break;
+
+  case CAT_ZZAS:
+
+    //CATDEF    ZZAS
+    //DESCR     Set/Read RX2 AGC gain
+    //SET       ZZASxxxx;
+    //READ      ZZAS;
+    //RESP      ZZASxxxx;
+    //NOTE      x -20...120, must contain + or - sign.
+    //ENDDEF
+    if (receivers == 2) {
+      if (command[4] == ';') {
+        // send reply back
+        snprintf(reply,  sizeof(reply), "ZZAS%+04d;", (int)(receiver[1]->agc_gain));
+        send_resp(client, reply) ;
+      } else {
+        int threshold = atoi(&command[4]);
+        set_agc_gain(VFO_B, (double)threshold);
+      }
+    } else {
+      implemented = FALSE;
+    }
+
+    break;
+
+  case CAT_ZZAU:
+
+    //CATDEF    ZZAU
+    //DESCR     Move up VFO-A frequency by selected step
+    //SET       ZZAUxx;
+    //NOTE      x 0...16 selects the size of the step, see ZZAC command.
+    //ENDDEF
+    if (command[6] == ';') {
+      int step_index = atoi(&command[4]);
+      long long hz = (long long) vfo_get_step_from_index(step_index);
+      vfo_id_move(VFO_A, hz, FALSE);
+    } else {
+    }
+
+    break;
+
+  case CAT_ZZBA:
+
+    //CATDEF    ZZBA
+    //DESCR     Move VFO-B one band down
+    //SET       ZZBA;
+    //NOTE      Wraps from lowest to highest band.
+    //ENDDEF
+    if (command[4] == ';') {
+      if (receivers == 2) {
+        band_minus(receiver[1]->id);
+      } else {
+        implemented = FALSE;
+      }
+    }
+
+    break;
+
+  case CAT_ZZBB:
+
+    //CATDEF    ZZBB
+    //DESCR     Move VFO-B one band up
+    //SET       ZZBB;
+    //NOTE      Wraps from highest to lowest band.
+    //ENDDEF
+    if (command[4] == ';') {
+      if (receivers == 2) {
+        band_plus(receiver[1]->id);
+      } else {
+        implemented = FALSE;
+      }
+    }
+
+    break;
+
+  case CAT_ZZBD:
+
+    //CATDEF    ZZBD
+    //DESCR     Move VFO-A one band down
+    //SET       ZZBD;
+    //NOTE      Wraps from lowest to highest band.
+    //ENDDEF
+    if (command[4] == ';') {
+      band_minus(receiver[0]->id);
+    }
+
+    break;
+
+  case CAT_ZZBE:
+
+    //CATDEF    ZZBE
+    //DESCR     Move down VFO-B frequency by multiple steps
+    //SET       ZZBExx;
+    //NOTE      VFO-B frequency moves down by x (0..99) times the current step size
+    //ENDDEF
+    if (command[6] == ';') {
+      int steps = atoi(&command[4]);
+      vfo_id_step(VFO_B, -steps);
+    }
+
+    break;
+
+  case CAT_ZZBF:
+
+    //CATDEF    ZZBF
+    //DESCR     Move up VFO-B frequency by multiple steps
+    //SET       ZZBFxx;
+    //NOTE      VFO-B frequency moves up by x (0...99) times the current step size
+    //ENDDEF
+    if (command[6] == ';') {
+      int steps = atoi(&command[4]);
+      vfo_id_step(VFO_B, +steps);
+    }
+
+    break;
+
+  case CAT_ZZBM:
+
+    //CATDEF    ZZBM
+    //DESCR     Move down VFO-B frequency by selected step.
+    //SET       ZZBMxx;
+    //NOTE      x 0...16 selects the size of the step, see ZZAC command.
+    //ENDDEF
+    if (command[6] == ';') {
+      int step_index = atoi(&command[4]);
+      long long hz = (long long) vfo_get_step_from_index(step_index);
+      vfo_id_move(VFO_B, -hz, FALSE);
+    } else {
+    }
+
+    break;
+
+  case CAT_ZZBP:
+
+    //CATDEF    ZZBP
+    //DESCR     Move up VFO-B frequency by selected step.
+    //SET       ZZBPxx;
+    //NOTE      x 0...16 selects the size of the step, see ZZAC command.
+    //ENDDEF
+    if (command[6] == ';') {
+      int step_index = atoi(&command[4]);
+      long long hz = (long long) vfo_get_step_from_index(step_index);
+      vfo_id_move(VFO_B, hz, FALSE);
+    }
+
+    break;
+
+  case CAT_ZZBS:
+  case CAT_ZZBT: {
+    int v = VFO_A;
+
+    if (command[3] == 'T') { v = VFO_B; }
+
+    //CATDEF    ZZBS
+    //DESCR     Set/Read VFO-A band
+    //SET       ZZBSxxx;
+    //READ      ZZBS;
+    //RESP      ZZBSxxx;
+    //NOTE      x 0...999 encodes the band:
+    //NOTE      136 kHz (x=136), 472 kHz (x=472), 160M (x=160)
+    //CONT      80M (x=80), 60M (x=60), 40M (x=40), 30M (x=30)
+    //CONT      20M (x=20), 17M (x=17), 15M (x=15), 12M (x=12)
+    //CONT      10M (x=10), 6M (x=6), Gen (x=888), WWV (x=999).
+    //ENDDEF
+    //CATDEF    ZZBT
+    //DESCR     Set/Read VFO-B band
+    //SET       ZZBTxxx;
+    //READ      ZZBT;
+    //RESP      ZZBTxxx;
+    //NOTE      x 0...999 encodes the band, see ZZBS command.
+    //ENDDEF
+    if (command[4] == ';') {
+      int b;
+
+      switch (vfo[v].band) {
+      case band136:
+        b = 136;
+        break;
+
+      case band472:
+        b = 472;
+        break;
+
+      case band160:
+        b = 160;
+        break;
+
+      case band80:
+        b = 80;
+        break;
+
+      case band60:
+        b = 60;
+        break;
+
+      case band40:
+        b = 40;
+        break;
+
+      case band30:
+        b = 30;
+        break;
+
+      case band20:
+        b = 20;
+        break;
+
+      case band17:
+        b = 17;
+        break;
+
+      case band15:
+        b = 15;
+        break;
+
+      case band12:
+        b = 12;
+        break;
+
+      case band10:
+        b = 10;
+        break;
+
+      case band6:
+        b = 6;
+        break;
+
+      case bandGen:
+        b = 888;
+        break;
+
+      case bandWWV:
+        b = 999;
+        break;
+
+      default:
+        b = 20;
+        break;
+      }
+
+      snprintf(reply,  sizeof(reply), "ZZB%c%03d;", 'S' + v, b);
+      send_resp(client, reply) ;
+    } else if (command[7] == ';') {
+      int band = band20;
+      int b = atoi(&command[4]);
+
+      switch (b) {
+      case 136:
+        band = band136;
+        break;
+
+      case 472:
+        band = band472;
+        break;
+
+      case 160:
+        band = band160;
+        break;
+
+      case 80:
+        band = band80;
+        break;
+
+      case 60:
+        band = band60;
+        break;
+
+      case 40:
+        band = band40;
+        break;
+
+      case 30:
+        band = band30;
+        break;
+
+      case 20:
+        band = band20;
+        break;
+
+      case 17:
+        band = band17;
+        break;
+
+      case 15:
+        band = band15;
+        break;
+
+      case 12:
+        band = band12;
+        break;
+
+      case 10:
+        band = band10;
+        break;
+
+      case 6:
+        band = band6;
+        break;
+
+      case 888:
+        band = bandGen;
+        break;
+
+      case 999:
+        band = bandWWV;
+        break;
+      }
+
+      vfo_id_band_changed(v, band);
+    }
+  }
+  break;
+
+  case CAT_ZZBU:
+
+    //CATDEF    ZZBU
+    //DESCR     Move VFO-A one band up
+    //SET       ZZBU;
+    //NOTE      Wraps from highest to lowest band.
+    //ENDDEF
+    if (command[4] == ';') {
+      band_plus(receiver[0]->id);
+    }
+
+    break;
+
+  case CAT_ZZCN:
+
+    //CATDEF    ZZCN
+    //DESCR     Set/Read VFO-A CTUN status
+    //SET       ZZCNx;
+    //READ      ZZCN;
+    //RESP      ZZCNx;
+    //NOTE      x=0: CTUN disabled, x=1: enabled
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZCN%d;", vfo[VFO_A].ctun);
+      send_resp(client, reply) ;
+    } else if (command[5] == ';') {
+      int state = atoi(&command[4]);
+      vfo_id_ctun_update(VFO_A, state);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZCO:
+
+    //CATDEF    ZZCO
+    //DESCR     Set/Read VFO-B CTUN status
+    //SET       ZZCOx;
+    //READ      ZZCO;
+    //RESP      ZZCOx;
+    //NOTE      x=0: CTUN disabled, x=1: enabled
+    //ENDDEF
+    if (command[4] == ';') {
+      // return the CTUN status
+      snprintf(reply,  sizeof(reply), "ZZCO%d;", vfo[VFO_B].ctun);
+      send_resp(client, reply) ;
+    } else if (command[5] == ';') {
+      int state = atoi(&command[4]);
+      vfo_id_ctun_update(VFO_B, state);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZFA:
+
+    //CATDEF    ZZFA
+    //DESCR     Set/Read VFO-A frequency
+    //SET       ZZFAxxxxxxxxxxx;
+    //READ      ZZFA;
+    //RESP      ZZFAxxxxxxxxxxx;
+    //NOTE      x in Hz, left-padded with zeroes
+    //ENDDEF
+    if (command[4] == ';') {
+      if (vfo[VFO_A].ctun) {
+        snprintf(reply,  sizeof(reply), "ZZFA%011lld;", vfo[VFO_A].ctun_frequency);
+      } else {
+        snprintf(reply,  sizeof(reply), "ZZFA%011lld;", vfo[VFO_A].frequency);
+      }
+
+      send_resp(client, reply) ;
+    } else if (command[15] == ';') {
+      long long f = atoll(&command[4]);
+      vfo_id_set_frequency(VFO_A, f);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZFB:
+
+    //CATDEF    ZZFB
+    //DESCR     Set/Read VFO-B frequency
+    //SET       ZZFBxxxxxxxxxxx;
+    //READ      ZZFB;
+    //RESP      ZZFBxxxxxxxxxxx;
+    //NOTE      x in Hz, left-padded with zeroes
+    //ENDDEF
+    if (command[4] == ';') {
+      if (vfo[VFO_B].ctun) {
+        snprintf(reply,  sizeof(reply), "ZZFB%011lld;", vfo[VFO_B].ctun_frequency);
+      } else {
+        snprintf(reply,  sizeof(reply), "ZZFB%011lld;", vfo[VFO_B].frequency);
+      }
+
+      send_resp(client, reply) ;
+    } else if (command[15] == ';') {
+      long long f = atoll(&command[4]);
+      vfo_id_set_frequency(VFO_B, f);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZFH:
+
+    //CATDEF    ZZFH
+    //DESCR     Set/Read RX1 filter high water
+    //SET       ZZFHxxxxx;
+    //READ      ZZFH;
+    //RESP      ZZFHxxxxxx;
+    //NOTE      x must be in the range -9999 ... 9999 and start with a minus sign if negative.
+    //CONT      If setting, this switches to the Var1 filter first.
+    //CONT      The convention is such that LSB, the filter high cut is negative and affects the low audio frequencies.
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZFH%05d;", receiver[0]->filter_high);
+      send_resp(client, reply) ;
+    } else if (command[9] == ';') {
+      int fh = atoi(&command[4]);
+      fh = fmin(9999, fh);
+      fh = fmax(-9999, fh);
+
+      // make sure filter is filterVar1
+      if (vfo[VFO_A].filter != filterVar1) {
+        vfo_id_filter_changed(VFO_A, filterVar1);
+      }
+
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      FILTER *filter = &mode_filters[filterVar1];
+      filter->high = fh;
+      vfo_id_filter_changed(VFO_A, filterVar1);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZFL:
+
+    //CATDEF    ZZFL
+    //DESCR     Set/Read RX1 filter low water
+    //SET       ZZFLxxxxx;
+    //READ      ZZFL;
+    //RESP      ZZFLxxxxxx;
+    //NOTE      x must be in the range -9999 ... 9999 and start with a minus sign if negative.
+    //CONT      If setting, this switches to the Var1 filter first.
+    //CONT      The convention is such that LSB, the filter low cut is negative and affects the high audio frequencies.
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZFL%05d;", receiver[0]->filter_low);
+      send_resp(client, reply) ;
+    } else if (command[9] == ';') {
+      int fl = atoi(&command[4]);
+      fl = fmin(9999, fl);
+      fl = fmax(-9999, fl);
+
+      // make sure filter is filterVar1
+      if (vfo[VFO_A].filter != filterVar1) {
+        vfo_id_filter_changed(VFO_A, filterVar1);
+      }
+
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      FILTER *filter = &mode_filters[filterVar1];
+      filter->low = fl;
+      vfo_id_filter_changed(VFO_A, filterVar1);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZGT:
+
+    //CATDEF    ZZGT
+    //DESCR     Set/Read RX1 AGC
+    //SET       ZZGTx;
+    //READ      ZZGT;
+    //RESP      ZZGTx;
+    //NOTE      x=0: AGC OFF, x=1: LONG, x=2: SLOW, x=3: MEDIUM, x=4: FAST
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZGT%d;", receiver[0]->agc);
+      send_resp(client, reply) ;
+    } else if (command[5] == ';') {
+      int agc = atoi(&command[4]);
+      // update RX1 AGC
+      receiver[0]->agc = agc;
+      rx_set_agc(receiver[0]);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZGU:
+    //CATDEF    ZZGU
+    //DESCR     Set/Read RX2 AGC
+    //SET       ZZGUx;
+    //READ      ZZGU;
+    //RESP      ZZGUx;
+    //NOTE      x=0: AGC OFF, x=1: LONG, x=2: SLOW, x=3: MEDIUM, x=4: FAST
+    //ENDDEF
+    RXCHECK(1,
+    if (command[4] == ';') {
+    snprintf(reply,  sizeof(reply), "ZZGU%d;", receiver[1]->agc);
+      send_resp(client, reply) ;
+    } else if (command[5] == ';') {
+    int agc = atoi(&command[4]);
+      // update RX2 AGC
+      RXCHECK(1,
+              receiver[1]->agc = agc;
+              rx_set_agc(receiver[1]);
+              g_idle_add(ext_vfo_update, NULL);
+             )
+    }
+           )
+    break;
+
+  case CAT_ZZLA:
+
+    //CATDEF    ZZLA
+    //DESCR     Set/Read RX1 volume (AF slider)
+    //SET       ZZLAxxx;
+    //READ      ZZLA;
+    //RESP      ZZLAxxx;
+    //NOTE      x = 0...100, mapped logarithmically to -40 ... 0 dB.
+    //ENDDEF
+    if (command[4] == ';') {
+      // send reply back
+      snprintf(reply,  sizeof(reply), "ZZLA%03d;", (int)(receiver[0]->volume * 100.0));
+      send_resp(client, reply) ;
+    } else {
+      int gain = atoi(&command[4]);
+
+      // gain is 0..100
+      if (gain < 2) {
+        receiver[0]->volume = -40.0;
+      } else {
+        receiver[0]->volume = 20.0 * log10(0.01 * (double) gain);
+      }
+
+      set_af_gain(0, receiver[0]->volume);
+    }
+
+    break;
+
+  case CAT_ZZLC:
+    //CATDEF    ZZLC
+    //DESCR     Set/Read RX2 volume (AF slider)
+    //SET       ZZLCxxx;
+    //READ      ZZLC;
+    //RESP      ZZLCxxx;
+    //NOTE      x = 0...100, mapped logarithmically to -40 ... 0 dB.
+    //ENDDEF
+    RXCHECK(1,
+    if (command[4] == ';') {
+    // send reply back
+    snprintf(reply,  sizeof(reply), "ZZLC%03d;", (int)(255.0 * pow(10.0, 0.05 * receiver[1]->volume)));
+      send_resp(client, reply) ;
+    } else {
+      int gain = atoi(&command[4]);
+
+      // gain is 0..100
+      if (gain < 2) {
+        receiver[1]->volume = -40.0;
+      } else {
+        receiver[1]->volume = 20.0 * log10(0.01 * (double) gain);
+      }
+
+      set_af_gain(1, receiver[1]->volume);
+    }
+           )
+    break;
+
+  case CAT_ZZLI:
+
+    //CATDEF    ZZLI
+    //DESCR     Set/Read PURESIGNAL status
+    //SET       ZZLIx;
+    //READ      ZZLI;
+    //RESP      ZZLIx;
+    //NOTE      x=0: PURESIGNAL disabled, x=1: enabled.
+    //ENDDEF
+    if (can_transmit) {
+      if (command[4] == ';') {
+        // send reply back
+        snprintf(reply,  sizeof(reply), "ZZLI%d;", transmitter->puresignal);
+        send_resp(client, reply) ;
+      } else {
+        int ps = atoi(&command[4]);
+        tx_ps_onoff(transmitter, ps);
+      }
+
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZMA:
+
+    //CATDEF    ZZMA
+    //DESCR     Mute/Unmute RX1
+    //SET       ZZMAx;
+    //READ      ZZMA;
+    //RESP      ZZMAx;
+    //NOTE      x=0: RX1 not muted, x=1: muted.
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZMA%d;", receiver[0]->mute_radio);
+      send_resp(client, reply) ;
+    } else {
+      int mute = atoi(&command[4]);
+      receiver[0]->mute_radio = mute;
+    }
+
+    break;
+
+  case CAT_ZZMB:
+    //CATDEF    ZZMB
+    //DESCR     Mute/Unmute RX2
+    //SET       ZZMBx;
+    //READ      ZZMB;
+    //RESP      ZZMBx;
+    //NOTE      x=0: RX2 not muted, x=1: muted.
+    //ENDDEF
+    RXCHECK(1,
+    if (command[4] == ';') {
+    snprintf(reply,  sizeof(reply), "ZZMA%d;", receiver[1]->mute_radio);
+      send_resp(client, reply) ;
+    } else {
+      int mute = atoi(&command[4]);
+      receiver[1]->mute_radio = mute;
+    }
+           )
+    break;
+
+  case CAT_ZZMD:
+
+    //CATDEF    ZZMD
+    //DESCR     Set/Read VFO-A modes
+    //SET       ZZMDxx;
+    //READ      ZZMD;
+    //RESP      ZZMDxx;
+    //NOTE      Modes: LSB (x=0), USB (x=1), DSB (x=3), CWL (x=4)
+    //CONT      CWU (x=5), FMN (x=6), AM (x=7), DIGU (x=7)
+    //CONT      SPEC (x=8), DIGL (x=9), SAM (x=10), DRM (x=11)
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZMD%02d;", vfo[VFO_A].mode);
+      send_resp(client, reply);
+    } else if (command[6] == ';') {
+      vfo_id_mode_changed(VFO_A, atoi(&command[4]));
+    }
+
+    break;
+
+  case CAT_ZZME:
+
+    //CATDEF    ZZME
+    //DESCR     Set/Read VFO-B modes
+    //SET       ZZMExx;
+    //READ      ZZME;
+    //RESP      ZZMEx;
+    //NOTE      x encodes the mode (see ZZMD command)
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZMD%02d;", vfo[VFO_B].mode);
+      send_resp(client, reply);
+    } else if (command[6] == ';') {
+      vfo_id_mode_changed(VFO_A, atoi(&command[4]));
+    }
+
+    break;
+
+  case CAT_ZZMG:
+
+    //CATDEF    ZZMG
+    //DESCR     Set/Read Mic gain (Mic gain slider)
+    //SET       ZZMGxxx;
+    //READ      ZZMG;
+    //RESP      ZZMGxxx;
+    //NOTE      x 0-70 mapped to -12 ... +50 dB
+    //ENDDEF
+    if (can_transmit) {
+      if (command[4] == ';') {
+        snprintf(reply,  sizeof(reply), "ZZMG%03d;", (int)((transmitter->mic_gain + 12.0) * 1.129));
+        send_resp(client, reply);
+      } else if (command[7] == ';') {
+        int val = atoi(&command[4]);
+        set_mic_gain(((double) val * 0.8857) - 12.0);
+      }
+    } else {
+      implemented = FALSE;
+    }
+
+    break;
+
+  case CAT_ZZSA:
+
+    //CATDEF    ZZSA
+    //DESCR     Move down VFO-A frequency one step
+    //SET       ZZSA;
+    //NOTE      VFO-A frequency moved down by the current step size
+    //ENDDEF
+    if (command[4] == ';') {
+      vfo_id_step(VFO_A, -1);
+    }
+
+    break;
+
+  case CAT_ZZSB:
+
+    //CATDEF    ZZSB
+    //DESCR     Move up VFO-A frequency one step
+    //SET       ZZSB;
+    //NOTE      VFO-A frequency moved up by the current step size
+    //ENDDEF
+    if (command[4] == ';') {
+      vfo_id_step(VFO_A, 1);
+    }
+
+    break;
+
+  case CAT_ZZSG:
+
+    //CATDEF    ZZSG
+    //DESCR     Move down VFO-B frequency one step
+    //SET       ZZSG;
+    //NOTE      VFO-B frequency moved down by the current step size
+    //ENDDEF
+    if (command[4] == ';') {
+      vfo_id_step(VFO_B, -1);
+    }
+
+    break;
+
+  case CAT_ZZSH:
+
+    //CATDEF    ZZSH
+    //DESCR     Move up VFO-B frequency one step
+    //SET       ZZSH;
+    //NOTE      VFO-B frequency moved up by the current step size
+    //ENDDEF
+    if (command[4] == ';') {
+      vfo_id_step(VFO_B, 1);
+    }
+
+    break;
+
+  case CAT_ZZTX:
+
+    //CATDEF    ZZTX
+    //DESCR     Get/Set MOX status
+    //SET       ZZTXx;
+    //READ      ZZTX;
+    //RESP      ZZTXx;
+    //NOTE      x=1: MOX on, x=0: off.
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZTX%d;", mox);
+      send_resp(client, reply) ;
+    } else if (command[5] == ';') {
+      radio_set_mox(atoi(&command[4]));
+    }
+
+    break;
+
+  case CAT_ZZUT:
+
+    //CATDEF    ZZUT
+    //DESCR     Get/Set TwoTone status
+    //SET       ZZUTx;
+    //READ      ZZUT;
+    //RESP      ZZUTx;
+    //NOTE      x=1: TwoTone on, x=0: TwoTone off.
+    //ENDDEF
+    if (can_transmit) {
+      if (command[4] == ';') {
+        snprintf(reply,  sizeof(reply), "ZZUT%d;", transmitter->twotone);
+        send_resp(client, reply) ;
+      } else if (command[5] == ';') {
+        radio_set_twotone(transmitter, atoi(&command[4]));
+      }
+    }
+
+    break;
+
+  case CAT_ZZVS: {
+    //CATDEF    ZZVS
+    //DESCR     Swap VFO A and B
+    //SET       ZZVSx;
+    //NOTE      x=0: copy VFO A to B, x=1: copy VFO B to A, x=2: exchange VFO A and B.
+    //NOTE      The contents (frequencies, CTUN mode, filters, etc.) of the VFOs are copied.
+    //ENDDEF
+    int i = atoi(&command[4]);
+
+    if (i == 0) {
+      vfo_a_to_b();
+    } else if (i == 1) {
+      vfo_b_to_a();
+    } else {
+      vfo_a_swap_b();
+    }
+  }
+  break;
+
+  case CAT_ZZXV:
+
+    //CATDEF    ZZXV
+    //DESCR     Get extended status information
+    //READ      ZZXV;
+    //RESP      ZZXVxxxx;
+    //NOTE      Status is reported bit-wise in the status word x=0-1023.
+    //NOTE      Bit 0: RIT; Bit 1: Lock, Bit2: Lock, Bit3: Split,
+    //NOTE      Bit 4: VFO-A CTUN, Bit 5: VFO-B CTUN, Bit 6: MOX,
+    //NOTE      Bit 7: TUNE, Bit 8: XIT, Bit 9: always cleared.
+    //ENDDEF
+    if (command[4] == ';') {
+      int status = 0;
+
+      if (vfo[VFO_A].rit_enabled) {
+        // cppcheck-suppress badBitmaskCheck
+        status = status | 0x01;
+      }
+
+      if (locked) {
+        status = status | 0x02;
+        status = status | 0x04;
+      }
+
+      if (split) {
+        status = status | 0x08;
+      }
+
+      if (vfo[VFO_A].ctun) {
+        status = status | 0x10;
+      }
+
+      if (vfo[VFO_B].ctun) {
+        status = status | 0x20;
+      }
+
+      if (mox) {
+        status = status | 0x40;
+      }
+
+      if (tune) {
+        status = status | 0x80;
+      }
+
+      if (vfo[vfo_get_tx_vfo()].xit_enabled) {
+        status = status | 0x100;
+      }
+
+      snprintf(reply,  sizeof(reply), "ZZXV%03d;", status);
+      send_resp(client, reply);
+    }
+
+    break;
+
+  case CAT_ZZYR:
+
+    //CATDEF    ZZYR
+    //DESCR     Get/Set active receiver
+    //SET       ZZYRx;
+    //READ      ZZYR;
+    //RESP      ZZYRx;
+    //NOTE      The active receiver is either RX1 (x=0) or RX2 (x=1).
+    //ENDDEF
+    if (command[4] == ';') {
+      snprintf(reply,  sizeof(reply), "ZZYR%01d;", active_receiver->id);
+      send_resp(client, reply);
+    } else if (command[5] == ';') {
+      int v = atoi(&command[4]);
+
+      if (v >= 0 && v < receivers) {
+        schedule_action(v == 0 ? RX1 : RX2, ACTION_PRESSED, 0);
+      } else {
+        implemented = FALSE;
+      }
+
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_ZZZD:
+
+    //CATDEF    ZZZD
+    //DESCR     Move down frequency of active receiver
+    //SET       ZZZDxx;
+    //NOTE      ANDROMEDA extension. x = number of VFO steps.
+    //NOTE      For x>10, the number of VFO steps is multiplied with
+    //CONT      a speed-up factor that increases up to 4 at x=30
+    //CONT      (corresponds to 3 turns of the VFO dial per second).
+    //CONT      This implements an over-proportional tuning speed if
+    //CONT      turning the VFO knob faster and faster.
+    //ENDDEF
+    if (command[6] == ';') {
+      int steps = 10 * (command[4] - '0') + (command[5] - '0');
+
+      if (steps <= 30) {
+        steps = andromeda_vfo_speedup[steps];
+      } else {
+        steps *= andromeda_vfo_speedup[31];
+      }
+
+      schedule_action(VFO, ACTION_RELATIVE, -steps);
+    } else {
+      // unexpected command format
+      implemented = FALSE;
+    }
+
+    break;
+
+  case CAT_ZZZE: // ANDROMEDA command
+
+    //CATDEF    ZZZE
+    //DESCR     Handle ANDROMEDA encoders
+    //SET       ZZZExxy;
+    //NOTE      ANDROMEDA extension.
+    //NOTE      x encodes the encoder and the direction.
+    //NOTE      x= 1-20 maps to encoder 1-20, clockwise
+    //NOTE      x=51-70 maps to encoder 1-20, counter clockwise
+    //NOTE      y=0-9 is the number of ticks
+    //NOTE
+    //ENDDEF
+    if (command[7] == ';') {
+      int v, p;
+      p = 10 * (command[4] - '0') + (command[5] - '0');
+      v = command[6] - '0';
+
+      if (p > 50) {
+        p -= 50;
+        v = -v;
+      }
+
+      if (v == 0) {
+        // This should not happen, but if, just do nothing
+        break;
+      }
+
+      //
+      // At this place, p is the encoder number (1...20) and
+      // v the number of ticks (-9 ... 9)
+      //
+
+      if (client->andromeda_type == 1) {
+        andromeda_execute_encoder(p, v);
+      } else {
+        if (g2panel_menu_is_open) {
+          g2panel_change_command(client->andromeda_type, CONTROLLER_ENCODER,
+                                 client->buttonvec, client->encodervec, p);
+        } else {
+          g2panel_execute_encoder(client->andromeda_type, client->encodervec, p, v);
+        }
+      }
+    } else {
+      // unexpected command format
+      implemented = FALSE;
+    }
+
+    break;
+
+  case CAT_ZZZI: // ANDROMEDA info
+    //CATDEF    ZZZI
+    //DESCR     ANDROMEDA reports
+    //RESP      ZZZIxxy;
+    //NOTE      Automatic generated response for ANDROMEDA controller.
+    //NOTE      The LED with number x shall be switched on (y=1)
+    //NOTE      or off (y=0).
+    //ENDDEF
+    implemented = FALSE;  // this command should never ARRIVE from the console
+    break;
+
+  case CAT_ZZZP: // ANDROMEDA command
+
+    //CATDEF    ZZZP
+    //DESCR     Handle ANDROMEDA push-buttons
+    //SET       ZZZPxxy;
+    //NOTE      ANDROMEDA extension.
+    //NOTE      x encodes the button and y means released (y=0),
+    //NOTE      pressed(y=1) or pressed for a longer time (y=2).
+    //ENDDEF
+    if (command[7] == ';') {
+      int p = 10 * (command[4] - '0') + (command[5] - '0');
+      int v = (command[6] - '0');
+
+      //
+      // The Andromeda console will send a v=0 --> v=1 --> v=0 sequence for a short press,
+      // so we have characteristic transitions tr01 (0-->1, upon pressing), tr12 (1-->2, after waiting),
+      // tr10 (1-->0, upon release) and tr20 (2-->0, upon release). For any button, either the sequence
+      // {tr01,tr01} is generated (short press) or the sequence {tr01,tr12,tr20} (long press).
+      //
+      // We have to distinguish "normal" buttons from "long" buttons. "normal" buttons make no difference
+      // between a short and a long press but "long" buttons may generate different actions for short
+      // and long presses.
+      //
+      // "Normal" buttons should generate a "ACTION_PRESSED" upon tr01 and (if required) a "ACTION_RELEASED" upon (tr10 || tr20).
+      // "Long" buttons generate a "ACTION_PRESSED" for the short-press event upon tr10,
+      // and a "ACTION_PRESSED" for the long-press event upon tr12.
+      //
+      // ATTENTION: no RELEASE event is ever triggered for a "long" button. Such events are currently required
+      //            only for PTT, RIT_PLUS, RIT_MINS, XIT_PLUS, XIT_MINUS, and CW keyer actions, which may be associated
+      //            to the "function keys" F1-F8 on the original ANDROMEDA console.
+      //            In all other cases, there is no need to bother the system with RELEASE events.
+      //
+      // NOTE: Rick's code for the original ANDROMEDA console went to andromeda.c
+      //
+      //
+
+      if (client->andromeda_type == 1) {
+        client->shift = andromeda_execute_button(v, p);
+      } else {
+        //
+        // "generic" ANDROMDA push-button section
+        //
+        int tr01, tr10, tr12, tr20;
+        tr01 = 0;  // indicates a v=0 --> v=1 transision
+        tr12 = 0;  // indicates a v=1 --> v=2 transision
+        tr10 = 0;  // indicates a v=1 --> v=0 transision
+        tr20 = 0;  // indicates a v=2 --> v=0 transision
+
+        if (client->last_v == 0 && v == 1) { tr01 = 1; }
+
+        if (client->last_v == 1 && v == 2) { tr12 = 1; }
+
+        if (client->last_v == 1 && v == 0) { tr10 = 1; }
+
+        if (client->last_v == 2 && v == 0) { tr20 = 1; }
+
+        client->last_v = v;
+
+        if (g2panel_menu_is_open) {
+          //
+          // It is enough to "fire" this upon initial press
+          //
+          if (tr01) {
+            g2panel_change_command(client->andromeda_type, CONTROLLER_SWITCH,
+                                   client->buttonvec, client->encodervec, p);
+          }
+        } else {
+          g2panel_execute_button(client->andromeda_type, client->buttonvec, p, tr01, tr10, tr12, tr20);
+        }
+      }
+
+      //
+      // Schedule LED update, in case the state has changed
+      //
+      g_idle_add(andromeda_oneshot_handler, (gpointer) client);
+    } else {
+      // all ANDROMEDA types, unexpected command format
+      implemented = FALSE;
+    }
+
+    break;
+
+  case CAT_ZZZS: // ANDROMEDA command
+
+    //CATDEF    ZZZS
+    //DESCR     Log ANDROMEDA version
+    //SET       ZZZSxxyyzzz;
+    //NOTE      ANDROMEDA extension.
+    //NOTE      The ANDROMEDA type (x), hardware (y) and
+    //CONT      software (z) version is printed in the log file.
+    //CONT      The type (x) sent by a client does affect the
+    //CONT      processing of ZZZE and ZZZP commands from that client.
+    //CONT      Only the cases x=1 (original ANDROMEDA console)
+    //CONT      and x=5 (G2 Ultra console) are implemented.
+    //ENDDEF
+    if (command[11] == ';') {
+      //
+      // Besides logging, store the ANDROMEDA type in the client data structure
+      //
+      client->andromeda_type = 10 * (command[4] - '0') + (command[5] - '0');
+      t_print("RIGCTL:INFO: Andromeda Client: Type:%c%c h/w:%c%c s/w:%c%c%c\n",
+              command[4], command[5],
+              command[6], command[7], command[8], command[9], command[10]);
+
+      if (client->andromeda_type == 4 || client->andromeda_type == 5) {
+        //
+        // Initialise commands.
+        //
+        if (client->buttonvec) { g_free(client->buttonvec); }
+
+        if (client->encodervec) { g_free(client->encodervec); }
+
+        client->buttonvec  = g2panel_default_buttons(client->andromeda_type);
+        client->encodervec = g2panel_default_encoders(client->andromeda_type);
+        g2panelRestoreState(client->andromeda_type, client->buttonvec, client->encodervec);
+
+        //
+        // This takes care the G2panel menu is shown in the main menu
+        //
+        if (controller == NO_CONTROLLER) { controller = G2_V2; }
+      }
+    }
+
+    break;
+
+  case CAT_ZZZU: // ANDROMEDA command operating on VFO of active receiver
+
+    //CATDEF    ZZZU
+    //DESCR     Move up frequency of active receiver
+    //SET       ZZZUxx;
+    //NOTE      ANDROMEDA extension. x = number of steps.
+    //NOTE      For x>10, the number of VFO steps is multiplied with
+    //CONT      a speed-up factor that increases up to 4 at x=30
+    //CONT      (corresponds to 3 turns of the VFO dial per second).
+    //CONT      This implements an over-proportional tuning speed if
+    //CONT      turning the VFO knob faster and faster.
+    //ENDDEF
+    if (command[6] == ';') {
+      int steps = 10 * (command[4] - '0') + (command[5] - '0');
+
+      if (steps <= 30) {
+        steps = andromeda_vfo_speedup[steps];
+      } else {
+        steps *= andromeda_vfo_speedup[31];
+      }
+
+      schedule_action(VFO, ACTION_RELATIVE, steps);
+    }
+
+    break;
+
+  case CAT_SHARP_S:
+
+    //CATDEF    \#S
+    //DESCR     Shutdown Console
+    //SET       \#S;
+    //ENDDEF
+    schedule_action(SHUTDOWN, ACTION_PRESSED, 0);
+    break;
+
+  case CAT_AG:
+
+    //CATDEF    AG
+    //DESCR     Sets/Reads audio volume (AF slider)
+    //SET       AGxyyy;
+    //READ      AGx;
+    //RESP      AGxyyy;
+    //NOTE      x=0 sets RX1 audio volume, x=1 sets RX2 audio volume.
+    //NOTE      y is 0...255 and mapped logarithmically to the volume -40...0 dB
+    //ENDDEF
+    if (command[3] == ';') {
+      int id = SET(command[2] == '1');
+      RXCHECK(id,
+              snprintf(reply,  sizeof(reply), "AG%1d%03d;", id, (int)(255.0 * pow(10.0, 0.05 * receiver[id]->volume)));
+              send_resp(client, reply);
+             )
+    } else if (command[6] == ';') {
+      int id = SET(command[2] == '1');
+      int gain = atoi(&command[3]);
+      double vol = (gain < 3) ? -40.0 : 20.0 * log10((double) gain / 255.0);
+      RXCHECK(id, receiver[id]->volume = vol; set_af_gain(0, receiver[id]->volume));
+    }
+
+    break;
+
+  case CAT_AI:
+
+    //CATDEF    AI
+    //DESCR     Sets/Reads auto reporting status
+    //SET       AIx;
+    //READ      AI;
+    //RESP      AIx;
+    //NOTE      x=0: auto-reporting disabled, x>0: enabled.
+    //NOTE      Auto-reporting is affected for the client that sends this command.
+    //CONT      For x=1, only frequency changes are sent via FA/FB commands.
+    //CONT      For x>1, mode changes are also sent via MD commands.
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "AI%d;", client->auto_reporting);
+      send_resp(client, reply) ;
+    } else if (command[3] == ';') {
+      client->auto_reporting = command[2] - '0';
+
+      if (client->auto_reporting < 0) { client->auto_reporting = 0; }
+
+      if (client->auto_reporting > 3) { client->auto_reporting = 3; }
+
+      notify_changed(NOTIFY_VFO | NOTIFY_MODE);
+    }
+
+    break;
+
+  case CAT_BD:
+    //CATDEF    BD
+    //DESCR     VFO-A Band down
+    //SET       BD;
+    //NOTE      Wraps from the lowest to the highest band.
+    //ENDDEF
+    band_minus(receiver[0]->id);
+    break;
+
+  case CAT_BU:
+    //CATDEF    BU
+    //DESCR     VFO-A Band up
+    //SET       BU;
+    //NOTE      Wraps from the highest to the lowest band.
+    //ENDDEF
+    band_plus(receiver[0]->id);
+    break;
+
+  case CAT_CN:
+
+    //CATDEF    CN
+    //DESCR     Sets/Reads the CTCSS frequency
+    //SET       CNxx;
+    //READ      CN;
+    //RESP      CNxx;
+    //NOTE      x =  1...38. CTCSS frequencies in Hz are:
+    //CONT      67.0 (x=1),  71.9 (x=2),  74.4 (x=3),  77.0 (x=4),
+    //CONT      79.7 (x=5),  82.5 (x=6),  85.4 (x=7),  88.5 (x=8),
+    //CONT      91.5 (x=9),  94.8 (x=10), 97.4 (x=11), 100.0 (x=12)
+    //CONT      103.5 (x=13), 107.2 (x=14), 110.9 (x=15), 114.8 (x=16)
+    //CONT      118.8 (x=17), 123.0 (x=18), 127.3 (x=19), 131.8 (x=20)
+    //CONT      136.5 (x=21), 141.3 (x=22), 146.2 (x=23), 151.4 (x=24)
+    //CONT      156.7 (x=25), 162.2 (x=26), 167.9 (x=27), 173.8 (x=28)
+    //CONT      179.9 (x=29), 186.2 (x=30), 192.8 (x=31), 203.5 (x=32)
+    //CONT      210.7 (x=33), 218.1 (x=34), 225.7 (x=35), 233.6 (x=36)
+    //CONT      241.8 (x=37), 250.3 (x=38).
+    //ENDDEF
+    // sets/reads CTCSS function (frequency)
+    if (can_transmit) {
+      if (command[2] == ';') {
+        snprintf(reply,  sizeof(reply), "CN%02d;", transmitter->ctcss + 1);
+        send_resp(client, reply) ;
+      } else if (command[4] == ';') {
+        transmitter->ctcss = atoi(&command[2]) - 1;
+        tx_set_ctcss(transmitter);
+        g_idle_add(ext_vfo_update, NULL);
+      }
+    }
+
+    break;
+
+  case CAT_CT:
+
+    //CATDEF    CT
+    //DESCR     Enable/Disable CTCSS
+    //SET       CTx;
+    //READ      CT;
+    //RESP      CTx;
+    //NOTE      x = 0: CTCSS off, x=1: on
+    //ENDDEF
+    if (can_transmit) {
+      if (command[2] == ';') {
+        snprintf(reply,  sizeof(reply), "CT%d;", transmitter->ctcss_enabled);
+        send_resp(client, reply) ;
+      } else if (command[3] == ';') {
+        transmitter->ctcss_enabled = SET(command[2] == '1');
+        tx_set_ctcss(transmitter);
+        g_idle_add(ext_vfo_update, NULL);
+      }
+    }
+
+    break;
+
+  case CAT_DN:
+    //CATDEF    DN
+    //DESCR     VFO-A down  one step
+    //SET       DN;
+    //NOTE      Parameters may be given, but are ignored.
+    //ENDDEF
+    vfo_id_step(VFO_A, -1);
+    break;
+
+  case CAT_FA:
+
+    //CATDEF    FA
+    //DESCR     Set/Read VFO-A frequency
+    //SET       FAxxxxxxxxxxx;
+    //READ      FA;
+    //RESP      FAxxxxxxxxxxx;
+    //NOTE      x in Hz, left-padded with zeroes
+    //ENDDEF
+    if (command[2] == ';') {
+      if (vfo[VFO_A].ctun) {
+        snprintf(reply,  sizeof(reply), "FA%011lld;", vfo[VFO_A].ctun_frequency);
+      } else {
+        snprintf(reply,  sizeof(reply), "FA%011lld;", vfo[VFO_A].frequency);
+      }
+
+      send_resp(client, reply) ;
+    } else if (command[13] == ';') {
+      long long f = atoll(&command[2]);
+      vfo_id_set_frequency(VFO_A, f);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_FB:
+
+    //CATDEF    FB
+    //DESCR     Set/Read VFO-B frequency
+    //SET       FBxxxxxxxxxxx;
+    //READ      FB;
+    //RESP      FBxxxxxxxxxxx;
+    //NOTE      x in Hz, left-padded with zeroes
+    //ENDDEF
+    if (command[2] == ';') {
+      if (vfo[VFO_B].ctun) {
+        snprintf(reply,  sizeof(reply), "FB%011lld;", vfo[VFO_B].ctun_frequency);
+      } else {
+        snprintf(reply,  sizeof(reply), "FB%011lld;", vfo[VFO_B].frequency);
+      }
+
+      send_resp(client, reply) ;
+    } else if (command[13] == ';') {
+      long long f = atoll(&command[2]);
+      vfo_id_set_frequency(VFO_B, f);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_FR:
+
+    //CATDEF    FR
+    //DESCR     Set/Read active receiver
+    //SET       FRx;
+    //READ      FR;
+    //RESP      FRx;
+    //NOTE      x = 0 (RX1) or 1 (RX2)
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "FR%d;", active_receiver->id);
+      send_resp(client, reply) ;
+    } else if (command[3] == ';') {
+      int id = SET(command[2] == '1');
+      RXCHECK(id, schedule_action(id == 0 ? RX1 : RX2, ACTION_PRESSED, 0));
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_FT:
+
+    //CATDEF    FT
+    //DESCR     Set/Read Split status
+    //SET       FTx;
+    //READ      FT;
+    //RESP      FTx;
+    //NOTE      x=0: TX VFO is the VFO controlling the active receiver, x=1: the other VFO.
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "FT%d;", split);
+      send_resp(client, reply) ;
+    } else if (command[3] == ';') {
+      int id = SET(command[2] == '1');
+      radio_set_split(id);
+    }
+
+    break;
+
+  case CAT_FW:
+
+    //CATDEF    FW
+    //DESCR     Set/Read VFO-A filter width (CW, AM, FM)
+    //SET       FWxxxx;
+    //READ      FW;
+    //RESP      FWxxxx;
+    //NOTE      When setting, this switches to the Var1 filter and sets its  width to x.
+    //CONT      Only valid for CW, FM, AM. Use SH/SL for LSB, USB, DIGL, DIGU.
+    //NOTE      For AM, 8kHz filter width (x=0) or  16 kHz (x$\ne$0)
+    //NOTE      For FM, 2.5kHz deviation (x=0) or 5 kHz (x$\ne$0)
+    //ENDDEF
+    if (command[2] == ';') {
+      int val = 0;
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      const FILTER *filter = &mode_filters[vfo[VFO_A].filter];
+
+      switch (vfo[VFO_A].mode) {
+      case modeCWL:
+      case modeCWU:
+        val = filter->low * 2;
+        break;
+
+      case modeAM:
+      case modeSAM:
+        val = filter->low >= -4000;
+        break;
+
+      case modeFMN:
+        val = vfo[VFO_A].deviation == 5000;
+        break;
+
+      default:
+        implemented = FALSE;
+        break;
+      }
+
+      if (implemented) {
+        snprintf(reply,  sizeof(reply), "FW%04d;", val);
+        send_resp(client, reply) ;
+      }
+    } else if (command[6] == ';') {
+      // make sure filter is filterVar1
+      if (vfo[VFO_A].filter != filterVar1) {
+        vfo_id_filter_changed(VFO_A, filterVar1);
+      }
 
-    case 'U': //RU
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      FILTER *filter = &mode_filters[filterVar1];
+      int fw = atoi(&command[2]);
+      filter->low = fw;
 
-      //CATDEF    RU
-      //DESCR     Set or Increment VFO-A RIT value
-      //SET       RUxxxxx;
-      //NOTE      When x is not given (RU;)  increment by 10 Hz (CW modes) or 50 Hz (other modes).
-      //CONT      When x is given, set VFO-A rit value to x
-      //ENDDEF
-      if (command[2] == ';') {
-        if (vfo[VFO_A].mode == modeCWL || vfo[VFO_A].mode == modeCWU) {
-          vfo[VFO_A].rit += 10;
+      switch (vfo[VFO_A].mode) {
+      case modeCWL:
+      case modeCWU:
+        filter->low = fw / 2;
+        filter->high = fw / 2;
+        break;
+
+      case modeFMN:
+        if (fw == 0) {
+          filter->low = -5500;
+          filter->high = 5500;
+          vfo[VFO_A].deviation = 2500;
         } else {
-          vfo[VFO_A].rit += 50;
+          filter->low = -8000;
+          filter->high = 8000;
+          vfo[VFO_A].deviation = 5000;
+        }
+
+        rx_set_filter(receiver[0]);
+
+        if (can_transmit) {
+          tx_set_filter(transmitter);
         }
 
         g_idle_add(ext_vfo_update, NULL);
-      } else if (command[7] == ';') {
-        vfo[VFO_A].rit = atoi(&command[2]);
+        break;
+
+      case modeAM:
+      case modeSAM:
+        if (fw == 0) {
+          filter->low = -4000;
+          filter->high = 4000;
+        } else {
+          filter->low = -8000;
+          filter->high = 8000;
+        }
+
+        break;
+
+      default:
+        implemented = FALSE;
+        break;
+      }
+
+      if (implemented) {
+        vfo_id_filter_changed(VFO_A, filterVar1);
         g_idle_add(ext_vfo_update, NULL);
       }
+    }
 
-      break;
+    break;
 
-    case 'X': //RX
+  case CAT_GT:
 
-      //CATDEF    RX
-      //DESCR     Enter RX mode
-      //SET       RX;
-      //ENDDEF
-      if (command[2] == ';') {
-        radio_set_mox(0);
-      }
+    //CATDEF    GT
+    //DESCR     Set/Read RX1 AGC
+    //SET       GTxxx;
+    //READ      GT;
+    //RESP      GTxxx;
+    //NOTE      x=0: AGC OFF, x=5: LONG, x=10: SLOW,
+    //CONT      x=15: MEDIUM, x=20: FAST.
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "GT%03d;", receiver[0]->agc * 5);
+      send_resp(client, reply) ;
+    } else if (command[5] == ';') {
+      receiver[0]->agc = atoi(&command[2]) / 5;
+      rx_set_agc(receiver[0]);
+      g_idle_add(ext_vfo_update, NULL);
+    }
 
-      break;
+    break;
 
-    default:
-      implemented = FALSE;
-      break;
+  case CAT_ID:
+    //CATDEF    ID
+    //DESCR     Get radio model ID
+    //READ      ID;
+    //RESP      IDxxx;
+    //NOTE      piHPSDR responds ID019; (so does the Kenwood TS-2000)
+    //ENDDEF
+    snprintf(reply,  sizeof(reply), "%s", "ID019;");
+    send_resp(client, reply);
+    break;
+
+  case CAT_IF: {
+    //CATDEF    IF
+    //DESCR     Get VFO-A Frequency/Mode etc.
+    //READ      IF;
+    //RESP      IFxxxxxxxxxxxyyyyzzzzzzsbc|ddefghikllm;
+    //NOTE      x : VFO-A Frequency (11 digit)
+    //NOTE      y : VFO-A step size
+    //NOTE      z : VFO-A rit step size
+    //NOTE      s : VFO-A rit enabled (0/1)
+    //NOTE      b : VFO-A xit enabled (0/1)
+    //NOTE      c : always 0
+    //NOTE      d : always 0
+    //NOTE      e : RX (e=0) or TX (e=1)
+    //NOTE      f : mode (TS-2000 encoding, see MD command)
+    //NOTE      g : always 0
+    //NOTE      h : always 0
+    //NOTE      i : Split enabled (i=1) or disabled (i=0)
+    //NOTE      k : CTCSS enabled (i=2) or disabled (i=0)
+    //NOTE      l : CTCSS frequency (1 - 38), see CN command
+    //NOTE      m : always 0
+    //ENDDEF
+    CAT_STATE state;
+    cat_state_fill(&state);
+    cat_format_if(reply, sizeof(reply), &state);
+    send_resp(client, reply);
+  }
+  break;
+
+  case CAT_KS:
+
+    //CATDEF    KS
+    //DESCR     Set CW speed
+    //SET       KSxxx;
+    //READ      KS;
+    //RESP      KSxxx;
+    //NOTE      x (1 - 60) is in wpm
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "KS%03d;", cw_keyer_speed);
+      send_resp(client, reply);
+    } else if (command[5] == ';') {
+      int speed = atoi(&command[2]);
+
+      if (speed >= 1 && speed <= 60) {
+        cw_keyer_speed = speed;
+        keyer_update();
+        g_idle_add(ext_vfo_update, NULL);
+      }
     }
 
     break;
 
-  case 'S':
-    switch (command[1]) {
-    case 'A': //SA
-
-      //CATDEF    SA
-      //DESCR     Set/Read SAT mode
-      //SET       SAxyzsbcdeeeeeeee;
-      //READ      SA;
-      //RESP      SAxyzsbcdeeeeeeee;
-      //NOTE      x=0: neither SAT nor RSAT, x=1: SAT or RSAT
-      //NOTE      y,z,s always zero
-      //NOTE      c = 1 indicates SAT mode (TRACE)
-      //NOTE      d = 1 indicates RSAT mode (TRACE REV)
-      //NOTE      e = eight-character label, here "SAT     "
-      //NOTE      when setting, c=1 and/or d=1 is illegal, and s is ignored.
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "SA%d%d%d%d%d%d%dSAT     ;", (sat_mode == SAT_MODE) || (sat_mode == RSAT_MODE), 0, 0, 0,
-                 sat_mode == SAT_MODE, sat_mode == RSAT_MODE, 0);
-        send_resp(client->fd, reply);
-      } else if (command[9] == ';') {
-        if (command[2] == '0') {
-          radio_set_satmode(SAT_NONE);
-        } else if (command[2] == '1') {
-          if (command[6] == '0' && command[7] == '0') {
-            radio_set_satmode(SAT_NONE);
-          } else if (command[6] == '1' && command[7] == '0') {
-            radio_set_satmode(SAT_MODE);
-          } else if (command[6] == '0' && command[7] == '1') {
-            radio_set_satmode(RSAT_MODE);
-          } else {
-            implemented = FALSE;
-          }
-        }
+  case CAT_KY:
+
+    //CATDEF    KY
+    //DESCR     Send Morse/query Morse buffer
+    //SET       KYxyyy...yyy;
+    //READ      KY;
+    //RESP      KYx;
+    //NOTE      When setting (sending), x must be a space.
+    //CONT      When reading, x=1 indicates buffer space is available, x=0  buffer full
+    //NOTE      y: string of up to 24 characters NOT containing ';'.
+    //CONT      Trailing blanks are ignored in y, but if it is completely blank it causes an inter-word space.
+    //ENDDEF
+    if (command[2] == ';') {
+      //
+      // reply "buffer full" condition if the buffer contains
+      // more than (CW_BUF_SIZE-24) characters.
+      //
+      int avail = cw_buf_in - cw_buf_out;
+
+      if (avail < 0) { avail += CW_BUF_SIZE; }
+
+      if (avail < CW_BUF_SIZE - 24) {
+        snprintf(reply,  sizeof(reply), "KY0;");
       } else {
-        implemented = FALSE;
+        snprintf(reply,  sizeof(reply), "KY1;");
       }
 
-      break;
+      send_resp(client, reply);
+    } else {
+      //
+      // Recent versions of Hamlib send CW messages one character at a time.
+      // So all trailing blanks have to be removed, and an entirely blank
+      // message is interpreted as a inter-word distance.
+      // Note we allow variable lengths of incoming messages here, although
+      // the standard says they are exactly 24 characters long.
+      //
+      int j = 3;
 
-    case 'B': //SB
-      // set/read SUB,TF-W status
-      implemented = FALSE;
-      break;
+      for (unsigned int i = 3; i < strlen(command); i++) {
+        if (command[i] == ';') { break; }
 
-    case 'C': //SC
-      // set/read SCAN function status
+        if (command[i] != ' ') { j = i; }
+      }
+
+      // j points to the last non-blank character, or to the first blank
+      // in an empty string
+      for (int i = 3; i <= j; i++) {
+        cw_buf_put(command[i]);
+      }
+    }
+
+    break;
+
+  case CAT_LK:
+
+    //CATDEF    LK
+    //DESCR     Set/Read Lock status
+    //SET       LKxx;
+    //READ      LK;
+    //RESP      LKxx;
+    //NOTE      When setting, any nonzero x sets lock status.
+    //CONT      When reading, x = 00 (not locked) or x = 11 (locked)
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "LK%d%d;", locked, locked);
+      send_resp(client, reply);
+    } else if (command[4] == ';') {
+      locked = atoi(&command[2]);
+      g_idle_add(ext_vfo_update, NULL);
+    }
+
+    break;
+
+  case CAT_MD:
+
+    //CATDEF    MD
+    //DESCR     Set/Read VFO-A modes
+    //SET       MDx;
+    //READ      MD;
+    //RESP      MDx;
+    //NOTE      Kenwood-type  mode  list:
+    //CONT      LSB (x=1), USB (x=2), CWU (x=3), FMN (x=4),
+    //CONT      AM (x=5), DIGL (x=6), CWL (x=7), DIGU (x=9)
+    //ENDDEF
+    if (command[2] == ';') {
+      int mode = ts2000_mode(vfo[VFO_A].mode);
+      snprintf(reply,  sizeof(reply), "MD%d;", mode);
+      send_resp(client, reply);
+    } else if (command[3] == ';') {
+      int mode = wdspmode(atoi(&command[2]));
+      vfo_id_mode_changed(VFO_A, mode);
+    }
+
+    break;
+
+  case CAT_MG:
+
+    //CATDEF    MG
+    //DESCR     Set/Read Mic gain (Mic gain slider)
+    //SET       MGxxx;
+    //READ      MG;
+    //RESP      MGxxx;
+    //NOTE      x 0-100 mapped to -12 ... +50 dB
+    //ENDDEF
+    if (can_transmit) {
+      if (command[2] == ';') {
+        snprintf(reply,  sizeof(reply), "MG%03d;", (int)(((transmitter->mic_gain + 12.0) / 62.0) * 100.0));
+        send_resp(client, reply);
+      } else if (command[5] == ';') {
+        double gain = (double)atoi(&command[2]);
+        gain = ((gain / 100.0) * 62.0) - 12.0;
+
+        if (gain < -12.0) { gain = -12.0; }
+
+        if (gain > 50.0) { gain = 50.0; }
+
+        set_mic_gain(gain);
+      }
+    } else {
       implemented = FALSE;
-      break;
+    }
+
+    break;
+
+  case CAT_NB:
+
+    //CATDEF    NB
+    //DESCR     Set/Read RX1 noise blanker
+    //SET       NBx;
+    //READ      NB;
+    //RESP      NBx;
+    //NOTE      x=0: NB off, x=1: NB1 on, x=2: NB2 on
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "NB%d;", receiver[0]->nb);
+      send_resp(client, reply);
+    } else if (command[3] == ';') {
+      receiver[0]->nb = atoi(&command[2]);
+      rx_set_noise(receiver[0]);
+    }
+
+    break;
+
+  case CAT_NR:
+
+    //CATDEF    NR
+    //DESCR     Set/Read RX1 noise reduction
+    //SET       NRx;
+    //READ      NR;
+    //RESP      NRx;
+    //NOTE      x=0: NR off, x=1: NR1 on, x=2: NR2 on
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "NR%d;", receiver[0]->nr);
+      send_resp(client, reply);
+    } else if (command[3] == ';')  {
+      receiver[0]->nr = atoi(&command[2]);
+      rx_set_noise(receiver[0]);
+    }
+
+    break;
+
+  case CAT_NT:
+
+    //CATDEF    NT
+    //DESCR     Set/Read RX1 auto notch filter
+    //SET       NTx;
+    //READ      NT;
+    //RESP      NTx;
+    //NOTE      x=0: Automatic Notch Filter off, x=1: on
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "NT%d;", receiver[0]->anf);
+      send_resp(client, reply);
+    } else if (command[3] == ';') {
+      receiver[0]->anf = atoi(&command[2]);
+      rx_set_noise(receiver[0]);
+    }
+
+    break;
+
+  case CAT_PA:
+
+    //CATDEF    PA
+    //DESCR     Set/Read RX1 preamp status
+    //SET       PAxy;
+    //READ      PA;
+    //RESP      PAxy;
+    //NOTE      Applies to RX1
+    //NOTE      x=0: RX1 preamp off, x=1: on. y is always zero.
+    //NOTE      newer HPSDR radios do not have a switchable preamp
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "PA%d0;", receiver[0]->preamp);
+      send_resp(client, reply);
+    } else if (command[4] == ';') {
+      receiver[0]->preamp = command[2] == '1';
+    }
+
+    break;
 
-    case 'D': //SD
+  case CAT_PC:
 
-      //CATDEF    SD
-      //DESCR     Set/Read CW break-in hang time
-      //SET       SDxxxx;
-      //READ      SD;
-      //RESP      SDxxxx;
-      //NOTE      x = 0...1000 (in milli seconds).
-      //CONT      When setting, x = 0  disables break-in
-      //ENDDEF
+    //CATDEF    PC
+    //DESCR     Set/Read TX power (Drive slider)
+    //SET       PCxxx;
+    //READ      PC;
+    //RESP      PCxxx;
+    //NOTE      x = 0...100
+    //ENDDEF
+    if (can_transmit) {
       if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "SD%04d;", (int)fmin(cw_keyer_hang_time, 1000));
-        send_resp(client->fd, reply);
-      } else if (command[6] == ';') {
-        int b = fmin(atoi(&command[2]), 1000);
-        cw_breakin = (b == 0);
-        cw_keyer_hang_time = b;
-      } else {
-        implemented = FALSE;
+        snprintf(reply,  sizeof(reply), "PC%03d;", (int)transmitter->drive);
+        send_resp(client, reply);
+      } else if (command[5] == ';') {
+        set_drive((double)atoi(&command[2]));
       }
+    }
 
-      break;
+    break;
 
-    case 'H': //SH
+  case CAT_PL:
 
-      //CATDEF    SH
-      //DESCR     Set/Read VFO-A filter high-water (LSB, USB, DIGL, DIGU only)
-      //SET       SHxx;
-      //READ      SH;
-      //RESP      SHxx;
-      //NOTE      When setting, the Var1 filter is activated
-      //NOTE      x = 0...11 encodes filter high water mark in Hz:
-      //NOTE      1400 (x=0), 1600 (x=1), 1800 (x=2), 2000 (x=3)
-      //CONT      2200 (x=4), 2400 (x=5), 2600 (x=6), 2800 (x=7)
-      //CONT      3000 (x=8), 3400 (x=9), 4000 (x=10), 5000 (x=11).
-      //ENDDEF
+    //CATDEF    PL
+    //DESCR     Set/Read TX compressor level
+    //SET       PLxxxyyy;
+    //READ      PL;
+    //RESP      PLxxxyyy;
+    //NOTE      x = 0...100, maps to compression 0...20 dB.
+    //NOTE      y ignored when setting, y=0 when reading
+    //ENDDEF
+    if (can_transmit) {
       if (command[2] == ';') {
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        const FILTER *filter = &mode_filters[vfo[VFO_A].filter];
-        int fh, high = 0;
-
-        switch (vfo[VFO_A].mode) {
-        case modeLSB:
-        case modeDIGL:
-          high = abs(filter->low);
-          break;
+        snprintf(reply,  sizeof(reply), "PL%03d000;", (int)(5.0 * transmitter->compressor_level));
+        send_resp(client, reply);
+      } else if (command[8] == ';') {
+        command[5] = '\0';
+        double level = (double)atoi(&command[2]);
+        level = 0.2 * level;
+        transmitter->compressor_level = level;
+        tx_set_compressor(transmitter);
+        g_idle_add(ext_vfo_update, NULL);
+      }
+    }
 
-        case modeUSB:
-        case modeDIGU:
-          high = filter->high;
-          break;
+    break;
 
-        default:
-          implemented = FALSE;
-          break;
-        }
+  case CAT_PS:
 
-        if (high <= 1400) {
-          fh = 0;
-        } else if (high <= 1600) {
-          fh = 1;
-        } else if (high <= 1800) {
-          fh = 2;
-        } else if (high <= 2000) {
-          fh = 3;
-        } else if (high <= 2200) {
-          fh = 4;
-        } else if (high <= 2400) {
-          fh = 5;
-        } else if (high <= 2600) {
-          fh = 6;
-        } else if (high <= 2800) {
-          fh = 7;
-        } else if (high <= 3000) {
-          fh = 8;
-        } else if (high <= 3400) {
-          fh = 9;
-        } else if (high <= 4000) {
-          fh = 10;
-        } else {
-          fh = 11;
-        }
+    //CATDEF    PS
+    //DESCR     Set/Read power status
+    //SET       PSx;
+    //READ      PS;
+    //RESP      PSx;
+    //NOTE      x = 1: Power on, x=0: off
+    //NOTE      When setting, x=1 is ignored and x=0 leads to shutdown
+    //NOTE      Reading always reports x=1
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "PS1;");
+      send_resp(client, reply);
+    } else if (command[3] == ';') {
+      int pwrc = atoi(&command[2]);
+
+      if ( pwrc == 0 ) {
+        schedule_action(SHUTDOWN, ACTION_PRESSED, 0);
+      } else {
+        // power-on command. Should there be a reply?
+        // snprintf(reply,  sizeof(reply), "PS1;");
+      }
+    }
 
-        if (implemented) {
-          snprintf(reply,  sizeof(reply), "SH%02d;", fh);
-          send_resp(client->fd, reply) ;
-        }
-      } else if (command[4] == ';') {
-        // make sure filter is filterVar1
-        if (vfo[VFO_A].filter != filterVar1) {
-          vfo_id_filter_changed(VFO_A, filterVar1);
-        }
+    break;
 
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        FILTER *filter = &mode_filters[filterVar1];
-        int i = atoi(&command[2]);
-        int fh;
+  case CAT_RA:
+
+    //CATDEF    RA
+    //DESCR     Set/Read RX1 attenuator or RX1 gain
+    //SET       RAxx;
+    //READ      RA;
+    //RESP      RAxxyy;
+    //NOTE      x = 0 ... 99 is mapped to the attenuation range available.
+    //NOTE      HPSDR radios: attenuator range 0...31 dB,
+    //CONT      HermesLite-II etc.: gain range -12...48 dB.
+    //CONT      y is always zero.
+    //ENDDEF
+    // set/read Attenuator function
+    if (command[2] == ';') {
+      int att = 0;
 
-        switch (i) {
-        case 0:
-          fh = 1400;
-          break;
+      if (have_rx_gain) {
+        // map gain value -12...48 to 0...99
+        att = (int)(adc[receiver[0]->adc].attenuation + 12);
+        att = (int)(((double)att / 60.0) * 99.0);
+      }
 
-        case 1:
-          fh = 1600;
-          break;
+      if (have_rx_att) {
+        // map att value -31 ... 0 to 0...99
+        att = (int)(adc[receiver[0]->adc].attenuation);
+        att = (int)(((double)att / 31.0) * 99.0);
+      }
 
-        case 2:
-          fh = 1800;
-          break;
+      snprintf(reply,  sizeof(reply), "RA%02d00;", att);
+      send_resp(client, reply);
+    } else if (command[4] == ';') {
+      int att = atoi(&command[2]);
 
-        case 3:
-          fh = 2000;
-          break;
+      if (have_rx_gain) {
+        // map 0...99 scale to -12...48
+        att = (int)((((double)att / 99.0) * 60.0) - 12.0);
+        set_rf_gain(VFO_A, (double)att);
+      }
 
-        case 4:
-          fh = 2200;
-          break;
+      if (have_rx_att) {
+        // mapp 0...99 scale to 0...31
+        att = (int)(((double)att / 99.0) * 31.0);
+        set_attenuation_value((double)att);
+      }
+    }
 
-        case 5:
-          fh = 2400;
-          break;
+    break;
 
-        case 6:
-          fh = 2600;
-          break;
+  case CAT_RC:
 
-        case 7:
-          fh = 2800;
-          break;
+    //CATDEF    RC
+    //DESCR     Clear VFO-A RIT value
+    //SET       RC;
+    //ENDDEF
+    if (command[2] == ';') {
+      vfo[VFO_A].rit = 0;
+      g_idle_add(ext_vfo_update, NULL);
+    }
 
-        case 8:
-          fh = 3000;
-          break;
+    break;
 
-        case 9:
-          fh = 3400;
-          break;
+  case CAT_RD:
 
-        case 10:
-          fh = 4000;
-          break;
+    //CATDEF    RD
+    //DESCR     Set or Decrement VFO-A RIT value
+    //SET       RDxxxxx;
+    //SET       RD;
+    //NOTE      When x is not given (RD;)  decrement by 10 Hz (CW modes) or 50 Hz (other modes).
+    //CONT      When x is given, set VFO-A rit value to the negative of x.
+    //ENDDEF
+    if (command[2] == ';') {
+      if (vfo[VFO_A].mode == modeCWL || vfo[VFO_A].mode == modeCWU) {
+        vfo[VFO_A].rit -= 10;
+      } else {
+        vfo[VFO_A].rit -= 50;
+      }
 
-        case 11:
-          fh = 5000;
-          break;
+      g_idle_add(ext_vfo_update, NULL);
+    } else if (command[7] == ';') {
+      vfo[VFO_A].rit = -atoi(&command[2]);
+      g_idle_add(ext_vfo_update, NULL);
+    }
 
-        default:
-          fh = 100;
-          break;
-        }
+    break;
 
-        switch (vfo[VFO_A].mode) {
-        case modeUSB:
-        case modeDIGU:
-          filter->high = fh;
-          break;
+  case CAT_RT:
 
-        case modeLSB:
-        case modeDIGL:
-          filter->low = -fh;
-          break;
+    //CATDEF    RT
+    //DESCR     Read/Set VFO-A RIT status
+    //SET       RTx;
+    //READ      RT;
+    //RESP      RTx;
+    //NOTE      x=0: VFO-A RIT off, x=1: on
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "RT%d;", vfo[VFO_A].rit_enabled);
+      send_resp(client, reply);
+    } else if (command[3] == ';') {
+      vfo[VFO_A].rit_enabled = atoi(&command[2]);
+      g_idle_add(ext_vfo_update, NULL);
+    }
 
-        default:
-          implemented = FALSE;
-        }
+    break;
 
-        vfo_id_filter_changed(VFO_A, filterVar1);
-        g_idle_add(ext_vfo_update, NULL);
+  case CAT_RU:
+
+    //CATDEF    RU
+    //DESCR     Set or Increment VFO-A RIT value
+    //SET       RUxxxxx;
+    //SET       RU;
+    //NOTE      When x is not given (RU;)  increment by 10 Hz (CW modes) or 50 Hz (other modes).
+    //CONT      When x is given, set VFO-A rit value to x
+    //ENDDEF
+    if (command[2] == ';') {
+      if (vfo[VFO_A].mode == modeCWL || vfo[VFO_A].mode == modeCWU) {
+        vfo[VFO_A].rit += 10;
+      } else {
+        vfo[VFO_A].rit += 50;
       }
 
-      break;
+      g_idle_add(ext_vfo_update, NULL);
+    } else if (command[7] == ';') {
+      vfo[VFO_A].rit = atoi(&command[2]);
+      g_idle_add(ext_vfo_update, NULL);
+    }
 
-    case 'I': //SI
-      // enter satellite memory name
-      implemented = FALSE;
-      break;
+    break;
 
-    case 'L': //SL
+  case CAT_RX:
 
-      //CATDEF    SL
-      //DESCR     Set/Read VFO-A filter low-water (LSB, USB, DIGL, DIGU only)
-      //SET       SLxx;
-      //READ      SL;
-      //RESP      SLxx;
-      //NOTE      When setting, the Var1 filter is activated
-      //NOTE      x = 0...11 encodes filter low water mark in Hz:
-      //NOTE      10 (x=0), 50 (x=1), 100 (x=2), 200 (x=3)
-      //CONT      300 (x=4), 400 (x=5), 500 (x=6), 600 (x=7)
-      //CONT      700 (x=8), 800 (x=9), 900 (x=10), 1000 (x=11).
-      //ENDDEF
-      if (command[2] == ';') {
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        const FILTER *filter = &mode_filters[vfo[VFO_A].filter];
-        int fl = 2;
-        int low = filter->low;
+    //CATDEF    RX
+    //DESCR     Enter RX mode
+    //SET       RX;
+    //ENDDEF
+    if (command[2] == ';') {
+      radio_set_mox(0);
+    }
 
-        if (vfo[VFO_A].mode == modeLSB || vfo[VFO_A].mode == modeDIGL) {
-          low = abs(filter->high);
-        }
+    break;
 
-        if (low <= 10) {
-          fl = 0;
-        } else if (low <= 50) {
-          fl = 1;
-        } else if (low <= 100) {
-          fl = 2;
-        } else if (low <= 200) {
-          fl = 3;
-        } else if (low <= 300) {
-          fl = 4;
-        } else if (low <= 400) {
-          fl = 5;
-        } else if (low <= 500) {
-          fl = 6;
-        } else if (low <= 600) {
-          fl = 7;
-        } else if (low <= 700) {
-          fl = 8;
-        } else if (low <= 800) {
-          fl = 9;
-        } else if (low <= 900) {
-          fl = 10;
+  case CAT_SA:
+
+    //CATDEF    SA
+    //DESCR     Set/Read SAT mode
+    //SET       SAxyzsbcd;
+    //READ      SA;
+    //RESP      SAxyzsbcdeeeeeeee;
+    //NOTE      x=0: neither SAT nor RSAT, x=1: SAT or RSAT
+    //NOTE      y,z,s always zero
+    //NOTE      c = 1 indicates SAT mode (TRACE)
+    //NOTE      d = 1 indicates RSAT mode (TRACE REV)
+    //NOTE      e = eight-character label, here "SAT     " (not given when setting)
+    //NOTE      when setting, c=1 and/or d=1 is illegal, and s is ignored.
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "SA%d%d%d%d%d%d%dSAT     ;", (sat_mode == SAT_MODE) || (sat_mode == RSAT_MODE), 0, 0, 0,
+               sat_mode == SAT_MODE, sat_mode == RSAT_MODE, 0);
+      send_resp(client, reply);
+    } else if (command[9] == ';') {
+      if (command[2] == '0') {
+        radio_set_satmode(SAT_NONE);
+      } else if (command[2] == '1') {
+        if (command[6] == '0' && command[7] == '0') {
+          radio_set_satmode(SAT_NONE);
+        } else if (command[6] == '1' && command[7] == '0') {
+          radio_set_satmode(SAT_MODE);
+        } else if (command[6] == '0' && command[7] == '1') {
+          radio_set_satmode(RSAT_MODE);
         } else {
-          fl = 11;
+          implemented = FALSE;
         }
+      }
+    } else {
+      implemented = FALSE;
+    }
 
-        snprintf(reply,  sizeof(reply), "SL%02d;", fl);
-        send_resp(client->fd, reply) ;
-      } else if (command[4] == ';') {
-        // make sure filter is filterVar1
-        if (vfo[VFO_A].filter != filterVar1) {
-          vfo_id_filter_changed(VFO_A, filterVar1);
-        }
+    break;
 
-        FILTER *mode_filters = filters[vfo[VFO_A].mode];
-        FILTER *filter = &mode_filters[filterVar1];
-        int i = atoi(&command[2]);
-        int fl = 100;
+  case CAT_SD:
 
-        switch (i) {
-        case 0:
-          fl = 10;
-          break;
+    //CATDEF    SD
+    //DESCR     Set/Read CW break-in hang time
+    //SET       SDxxxx;
+    //READ      SD;
+    //RESP      SDxxxx;
+    //NOTE      x = 0...1000 (in milli seconds).
+    //CONT      When setting, x = 0  disables break-in
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "SD%04d;", (int)fmin(cw_keyer_hang_time, 1000));
+      send_resp(client, reply);
+    } else if (command[6] == ';') {
+      int b = fmin(atoi(&command[2]), 1000);
+      cw_breakin = (b == 0);
+      cw_keyer_hang_time = b;
+    } else {
+      implemented = FALSE;
+    }
 
-        case 1:
-          fl = 50;
-          break;
+    break;
+
+  case CAT_SH:
+
+    //CATDEF    SH
+    //DESCR     Set/Read VFO-A filter high-water (LSB, USB, DIGL, DIGU only)
+    //SET       SHxx;
+    //READ      SH;
+    //RESP      SHxx;
+    //NOTE      When setting, the Var1 filter is activated
+    //NOTE      x = 0...11 encodes filter high water mark in Hz:
+    //NOTE      1400 (x=0), 1600 (x=1), 1800 (x=2), 2000 (x=3)
+    //CONT      2200 (x=4), 2400 (x=5), 2600 (x=6), 2800 (x=7)
+    //CONT      3000 (x=8), 3400 (x=9), 4000 (x=10), 5000 (x=11).
+    //ENDDEF
+    if (command[2] == ';') {
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      const FILTER *filter = &mode_filters[vfo[VFO_A].filter];
+      int fh, high = 0;
+
+      switch (vfo[VFO_A].mode) {
+      case modeLSB:
+      case modeDIGL:
+        high = abs(filter->low);
+        break;
+
+      case modeUSB:
+      case modeDIGU:
+        high = filter->high;
+        break;
+
+      default:
+        implemented = FALSE;
+        break;
+      }
+
+      if (high <= 1400) {
+        fh = 0;
+      } else if (high <= 1600) {
+        fh = 1;
+      } else if (high <= 1800) {
+        fh = 2;
+      } else if (high <= 2000) {
+        fh = 3;
+      } else if (high <= 2200) {
+        fh = 4;
+      } else if (high <= 2400) {
+        fh = 5;
+      } else if (high <= 2600) {
+        fh = 6;
+      } else if (high <= 2800) {
+        fh = 7;
+      } else if (high <= 3000) {
+        fh = 8;
+      } else if (high <= 3400) {
+        fh = 9;
+      } else if (high <= 4000) {
+        fh = 10;
+      } else {
+        fh = 11;
+      }
+
+      if (implemented) {
+        snprintf(reply,  sizeof(reply), "SH%02d;", fh);
+        send_resp(client, reply) ;
+      }
+    } else if (command[4] == ';') {
+      // make sure filter is filterVar1
+      if (vfo[VFO_A].filter != filterVar1) {
+        vfo_id_filter_changed(VFO_A, filterVar1);
+      }
 
-        case 2:
-          fl = 100;
-          break;
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      FILTER *filter = &mode_filters[filterVar1];
+      int i = atoi(&command[2]);
+      int fh;
 
-        case 3:
-          fl = 200;
-          break;
+      switch (i) {
+      case 0:
+        fh = 1400;
+        break;
 
-        case 4:
-          fl = 300;
-          break;
+      case 1:
+        fh = 1600;
+        break;
 
-        case 5:
-          fl = 400;
-          break;
+      case 2:
+        fh = 1800;
+        break;
 
-        case 6:
-          fl = 500;
-          break;
+      case 3:
+        fh = 2000;
+        break;
 
-        case 7:
-          fl = 600;
-          break;
+      case 4:
+        fh = 2200;
+        break;
 
-        case 8:
-          fl = 700;
-          break;
+      case 5:
+        fh = 2400;
+        break;
 
-        case 9:
-          fl = 800;
-          break;
+      case 6:
+        fh = 2600;
+        break;
 
-        case 10:
-          fl = 900;
-          break;
+      case 7:
+        fh = 2800;
+        break;
 
-        case 11:
-          fl = 1000;
-          break;
+      case 8:
+        fh = 3000;
+        break;
 
-        default:
-          fl = 100;
-          break;
-        }
+      case 9:
+        fh = 3400;
+        break;
 
-        switch (vfo[VFO_A].mode) {
-        case modeLSB:
-        case modeDIGL:
-          filter->high = -fl;
-          break;
+      case 10:
+        fh = 4000;
+        break;
 
-        case modeUSB:
-        case modeDIGU:
-          filter->low = fl;
-          break;
-        }
+      case 11:
+        fh = 5000;
+        break;
 
-        vfo_id_filter_changed(VFO_A, filterVar1);
-        g_idle_add(ext_vfo_update, NULL);
+      default:
+        fh = 100;
+        break;
       }
 
-      break;
-
-    case 'M': //SM
+      switch (vfo[VFO_A].mode) {
+      case modeUSB:
+      case modeDIGU:
+        filter->high = fh;
+        break;
 
-      //CATDEF    SM
-      //DESCR     Read S-meter
-      //READ      SMx;
-      //RESP      SMxyyyy;
-      //NOTE      x=0: read RX1, x=1: read RX2
-      //NOTE      y : 0 ... 30 mapped to -127...-19 dBm
-      //ENDDEF
-      if (command[3] == ';') {
-        int id = atoi(&command[2]);
-        RXCHECK (id,
-                 int val = (int)((receiver[id]->meter + 127.0) * 0.277778);
+      case modeLSB:
+      case modeDIGL:
+        filter->low = -fh;
+        break;
 
-        if (val > 30) { val = 30; }
-      if (val < 0 ) { val = 0; }
-      snprintf(reply,  sizeof(reply), "SM%d%04d;", id, val);
-      send_resp(client->fd, reply);
-              )
+      default:
+        implemented = FALSE;
       }
 
-      break;
+      vfo_id_filter_changed(VFO_A, filterVar1);
+      g_idle_add(ext_vfo_update, NULL);
+    }
 
-    case 'Q': //SQ
+    break;
 
-      //CATDEF    SQ
-      //DESCR     Set/Read squelch level (Squelch slider)
-      //SET       SQxyyy;
-      //READ      SQx;
-      //RESP      SQxyyy
-      //NOTE      x=0: read/set RX1 squelch, x=1: RX2.
-      //NOTE      y : 0-255 mapped to 0-100
-      //ENDDEF
-      if (command[3] == ';') {
-        int id = atoi(&command[2]);
-        RXCHECK(id,
-                snprintf(reply,  sizeof(reply), "SQ%d%03d;", id, (int)((double)receiver[id]->squelch / 100.0 * 255.0 + 0.5));
-                send_resp(client->fd, reply);
-               )
-      } else if (command[6] == ';') {
-        int id = atoi(&command[2]);
-        int p2 = atoi(&command[3]);
-        RXCHECK(id,
-                receiver[id]->squelch = (int)((double)p2 / 255.0 * 100.0 + 0.5);
-                set_squelch(receiver[id]);
-               )
+  case CAT_SL:
+
+    //CATDEF    SL
+    //DESCR     Set/Read VFO-A filter low-water (LSB, USB, DIGL, DIGU only)
+    //SET       SLxx;
+    //READ      SL;
+    //RESP      SLxx;
+    //NOTE      When setting, the Var1 filter is activated
+    //NOTE      x = 0...11 encodes filter low water mark in Hz:
+    //NOTE      10 (x=0), 50 (x=1), 100 (x=2), 200 (x=3)
+    //CONT      300 (x=4), 400 (x=5), 500 (x=6), 600 (x=7)
+    //CONT      700 (x=8), 800 (x=9), 900 (x=10), 1000 (x=11).
+    //ENDDEF
+    if (command[2] == ';') {
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      const FILTER *filter = &mode_filters[vfo[VFO_A].filter];
+      int fl = 2;
+      int low = filter->low;
+
+      if (vfo[VFO_A].mode == modeLSB || vfo[VFO_A].mode == modeDIGL) {
+        low = abs(filter->high);
+      }
+
+      if (low <= 10) {
+        fl = 0;
+      } else if (low <= 50) {
+        fl = 1;
+      } else if (low <= 100) {
+        fl = 2;
+      } else if (low <= 200) {
+        fl = 3;
+      } else if (low <= 300) {
+        fl = 4;
+      } else if (low <= 400) {
+        fl = 5;
+      } else if (low <= 500) {
+        fl = 6;
+      } else if (low <= 600) {
+        fl = 7;
+      } else if (low <= 700) {
+        fl = 8;
+      } else if (low <= 800) {
+        fl = 9;
+      } else if (low <= 900) {
+        fl = 10;
+      } else {
+        fl = 11;
       }
 
-      break;
-
-    case 'R': //SR
-      // reset transceiver
-      implemented = FALSE;
-      break;
+      snprintf(reply,  sizeof(reply), "SL%02d;", fl);
+      send_resp(client, reply) ;
+    } else if (command[4] == ';') {
+      // make sure filter is filterVar1
+      if (vfo[VFO_A].filter != filterVar1) {
+        vfo_id_filter_changed(VFO_A, filterVar1);
+      }
 
-    case 'S': //SS
-      // set/read program scan pause frequency
-      implemented = FALSE;
-      break;
+      FILTER *mode_filters = filters[vfo[VFO_A].mode];
+      FILTER *filter = &mode_filters[filterVar1];
+      int i = atoi(&command[2]);
+      int fl = 100;
 
-    case 'T': //ST
-      // set/read MULTI/CH channel frequency steps
-      implemented = FALSE;
-      break;
+      switch (i) {
+      case 0:
+        fl = 10;
+        break;
 
-    case 'U': //SU
-      // set/read program scan pause frequency
-      implemented = FALSE;
-      break;
+      case 1:
+        fl = 50;
+        break;
 
-    case 'V': //SV
-      // execute memory transfer function
-      implemented = FALSE;
-      break;
+      case 2:
+        fl = 100;
+        break;
 
-    default:
-      implemented = FALSE;
-      break;
-    }
+      case 3:
+        fl = 200;
+        break;
 
-    break;
+      case 4:
+        fl = 300;
+        break;
 
-  case 'T':
-    switch (command[1]) {
-    case 'C': //TC
-      // set/read internal TNC mode
-      implemented = FALSE;
-      break;
+      case 5:
+        fl = 400;
+        break;
 
-    case 'D': //TD
-      // send DTMF memory channel data
-      implemented = FALSE;
-      break;
+      case 6:
+        fl = 500;
+        break;
 
-    case 'I': //TI
-      // read TNC LED status
-      implemented = FALSE;
-      break;
+      case 7:
+        fl = 600;
+        break;
 
-    case 'N': //TN
-      // set/read sub-tone frequency
-      implemented = FALSE;
-      break;
+      case 8:
+        fl = 700;
+        break;
 
-    case 'O': //TO
-      // set/read TONE function
-      implemented = FALSE;
-      break;
+      case 9:
+        fl = 800;
+        break;
 
-    case 'S': //TS
-      // set/read TF-SET function
-      implemented = FALSE;
-      break;
+      case 10:
+        fl = 900;
+        break;
 
-    case 'X': //TX
+      case 11:
+        fl = 1000;
+        break;
 
-      //CATDEF    TX
-      //DESCR     Enter TX mode
-      //SET       TX;
-      //ENDDEF
-      // set transceiver to TX mode
-      if (command[2] == ';') {
-        radio_set_mox(1);
+      default:
+        fl = 100;
+        break;
       }
 
-      break;
-
-    case 'Y': //TY
+      switch (vfo[VFO_A].mode) {
+      case modeLSB:
+      case modeDIGL:
+        filter->high = -fl;
+        break;
 
-      //CATDEF    TY
-      //DESCR     Read firmware version
-      //READ      TY;
-      //RESP      TYxxx;
-      //NOTE      x is always zero
-      //ENDDEF
-      if (command[2] == ';') {
-        send_resp(client->fd, "TY000;");
+      case modeUSB:
+      case modeDIGU:
+        filter->low = fl;
+        break;
       }
 
-      break;
-
-    default:
-      implemented = FALSE;
-      break;
+      vfo_id_filter_changed(VFO_A, filterVar1);
+      g_idle_add(ext_vfo_update, NULL);
     }
 
     break;
 
-  case 'U':
-    switch (command[1]) {
-    case 'L': //UL
-      // detects the PLL unlock status
-      implemented = FALSE;
-      break;
-
-    case 'P': //UP
-
-      //CATDEF    UP
-      //DESCR     Move VFO-A one step up
-      //SET       UP;
-      //NOTE      use current VFO-A step size
-      //ENDDEF
-      if (command[2] == ';') {
-        vfo_id_step(VFO_A, 1);
-      }
-
-      break;
+  case CAT_SM:
 
-    default:
-      implemented = FALSE;
-      break;
+    //CATDEF    SM
+    //DESCR     Read S-meter
+    //READ      SMx;
+    //RESP      SMxyyyy;
+    //NOTE      x=0: read RX1, x=1: read RX2
+    //NOTE      y : 0 ... 30 mapped to -127...-19 dBm
+    //ENDDEF
+    if (command[3] == ';') {
+      int id = atoi(&command[2]);
+      RXCHECK (id,
+               int val = (int)((receiver[id]->meter + 127.0) * 0.277778);
+
+      if (val > 30) { val = 30; }
+    if (val < 0 ) { val = 0; }
+    snprintf(reply,  sizeof(reply), "SM%d%04d;", id, val);
+    send_resp(client, reply);
+            )
     }
 
     break;
 
-  case 'V':
-    switch (command[1]) {
-    case 'D': //VD
-      // set/read VOX delay time
-      implemented = FALSE;
-      break;
+  case CAT_SQ:
 
-    case 'G': //VG
-
-      //CATDEF    VG
-      //DESCR     Set/Read VOX threshold
-      //SET       VGxxx;
-      //READ      VG;
-      //RESP      VGxxx;
-      //NOTE      x is in the range 0-9, mapped to an amplitude
-      //CONT      threshold 0.0-1.0
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "VG%03d;", (int)((vox_threshold * 100.0) * 0.9));
-        send_resp(client->fd, reply);
-      } else if (command[5] == ';') {
-        vox_threshold = atof(&command[2]) / 9.0;
-        g_idle_add(ext_vfo_update, NULL);
-      }
+    //CATDEF    SQ
+    //DESCR     Set/Read squelch level (Squelch slider)
+    //SET       SQxyyy;
+    //READ      SQx;
+    //RESP      SQxyyy;
+    //NOTE      x=0: read/set RX1 squelch, x=1: RX2.
+    //NOTE      y : 0-255 mapped to 0-100
+    //ENDDEF
+    if (command[3] == ';') {
+      int id = atoi(&command[2]);
+      RXCHECK(id,
+              snprintf(reply,  sizeof(reply), "SQ%d%03d;", id, (int)((double)receiver[id]->squelch / 100.0 * 255.0 + 0.5));
+              send_resp(client, reply);
+             )
+    } else if (command[6] == ';') {
+      int id = atoi(&command[2]);
+      int p2 = atoi(&command[3]);
+      RXCHECK(id,
+              receiver[id]->squelch = (int)((double)p2 / 255.0 * 100.0 + 0.5);
+              set_squelch(receiver[id]);
+             )
+    }
 
-      break;
+    break;
 
-    case 'R': //VR
-      // emulate VOICE1 or VOICE2 key
-      implemented = FALSE;
-      break;
+  case CAT_TX:
 
-    case 'X': //VX
+    //CATDEF    TX
+    //DESCR     Enter TX mode
+    //SET       TX;
+    //ENDDEF
+    // set transceiver to TX mode
+    if (command[2] == ';') {
+      radio_set_mox(1);
+    }
 
-      //CATDEF    VX
-      //DESCR     Set/Read VOX status
-      //SET       VXx;
-      //READ      VX;
-      //RESP      VXx;
-      //NOTE      x=0: VOX disabled, x=1: enabled
-      //ENDDEF
-      if (command[2] == ';') {
-        snprintf(reply,  sizeof(reply), "VX%d;", vox_enabled);
-        send_resp(client->fd, reply);
-      } else if (command[3] == ';') {
-        vox_enabled = atoi(&command[2]);
-        g_idle_add(ext_vfo_update, NULL);
-      }
+    break;
 
-      break;
+  case CAT_TY:
 
-    default:
-      implemented = FALSE;
-      break;
+    //CATDEF    TY
+    //DESCR     Read firmware version
+    //READ      TY;
+    //RESP      TYxxx;
+    //NOTE      x is always zero
+    //ENDDEF
+    if (command[2] == ';') {
+      send_resp(client, "TY000;");
     }
 
     break;
 
-  case 'W':
-    switch (command[1]) {
-    default:
-      implemented = FALSE;
-      break;
+  case CAT_UP:
+
+    //CATDEF    UP
+    //DESCR     Move VFO-A one step up
+    //SET       UP;
+    //NOTE      use current VFO-A step size
+    //ENDDEF
+    if (command[2] == ';') {
+      vfo_id_step(VFO_A, 1);
     }
 
     break;
 
-  case 'X':
-    switch (command[1]) {
-    case 'T': //XT
-
-      //CATDEF    XT
-      //DESCR     Set/Read XIT status
-      //SET       XTx;
-      //READ      XT;
-      //RESP      XTx;
-      //NOTE      x=0: XIT disabled, x=1: enabled
-      //ENDDEF
-      if (can_transmit) {
-        if (command[2] == ';') {
-          snprintf(reply,  sizeof(reply), "XT%d;", vfo[vfo_get_tx_vfo()].xit_enabled);
-          send_resp(client->fd, reply);
-        } else if (command[3] == ';') {
-          vfo_xit_onoff(SET(atoi(&command[2])));
-        }
-      }
-
-      break;
+  case CAT_VG:
 
-    default:
-      implemented = FALSE;
-      break;
+    //CATDEF    VG
+    //DESCR     Set/Read VOX threshold
+    //SET       VGxxx;
+    //READ      VG;
+    //RESP      VGxxx;
+    //NOTE      x is in the range 0-9, mapped to an amplitude
+    //CONT      threshold 0.0-1.0
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "VG%03d;", (int)((vox_threshold * 100.0) * 0.9));
+      send_resp(client, reply);
+    } else if (command[5] == ';') {
+      vox_threshold = atof(&command[2]) / 9.0;
+      g_idle_add(ext_vfo_update, NULL);
     }
 
     break;
 
-  case 'Y':
-    switch (command[1]) {
-    default:
-      implemented = FALSE;
-      break;
+  case CAT_VX:
+
+    //CATDEF    VX
+    //DESCR     Set/Read VOX status
+    //SET       VXx;
+    //READ      VX;
+    //RESP      VXx;
+    //NOTE      x=0: VOX disabled, x=1: enabled
+    //ENDDEF
+    if (command[2] == ';') {
+      snprintf(reply,  sizeof(reply), "VX%d;", vox_enabled);
+      send_resp(client, reply);
+    } else if (command[3] == ';') {
+      vox_enabled = atoi(&command[2]);
+      g_idle_add(ext_vfo_update, NULL);
     }
 
     break;
 
-  case 'Z':
-    switch (command[1]) {
-    case 'Z':
-      implemented = parse_extended_cmd (command, client);
-      break;
+  case CAT_XT:
 
-    default:
-      implemented = FALSE;
-      break;
+    //CATDEF    XT
+    //DESCR     Set/Read XIT status
+    //SET       XTx;
+    //READ      XT;
+    //RESP      XTx;
+    //NOTE      x=0: XIT disabled, x=1: enabled
+    //ENDDEF
+    if (can_transmit) {
+      if (command[2] == ';') {
+        snprintf(reply,  sizeof(reply), "XT%d;", vfo[vfo_get_tx_vfo()].xit_enabled);
+        send_resp(client, reply);
+      } else if (command[3] == ';') {
+        vfo_xit_onoff(SET(atoi(&command[2])));
+      }
     }
 
     break;
 
   default:
-    implemented = FALSE;
+    implemented = parse_undocumented_cmd(command, client);
     break;
   }
 
   if (!implemented) {
-    if (rigctl_debug) { t_print("RIGCTL: UNIMPLEMENTED COMMAND: %s\n", info->command); }
+    if (rigctl_debug) { t_print("RIGCTL: UNIMPLEMENTED COMMAND: %s\n", command); }
 
-    send_resp(client->fd, "?;");
+    send_resp(client, "?;");
   }
 
   client->done = 1; // possibly inform server that command is finished
-  g_free(info->command);
-  g_free(info);
-  return 0;
 }
 
 // Serial Port Launch
@@ -5557,15 +6060,13 @@ static gpointer serial_server(gpointer data) {
   // when we get data we'll send it to parse_cmd
   CLIENT *client = (CLIENT *)data;
   char cmd_input[MAXDATASIZE];
-  char *command = g_new(char, MAXDATASIZE);
-  int command_index = 0;
-  int i;
   fd_set fds;
   struct timeval tv;
   t_print("%s: Entering Thread\n", __FUNCTION__);
   g_mutex_lock(&mutex_numcat);
   cat_control++;
   g_mutex_unlock(&mutex_numcat);
+  g_idle_add(cat_state_start, NULL);
   g_idle_add(ext_vfo_update, NULL);
   client->running = TRUE;
 
@@ -5620,37 +6121,11 @@ static gpointer serial_server(gpointer data) {
     if (!client->running) { break; }
 
     if (numbytes > 0) {
-      for (i = 0; i < numbytes; i++) {
-        //
-        // Filter out newlines and other non-printable characters
-        // These may occur when doing CAT manually with a terminal program
-        //
-        if (cmd_input[i] < 32) {
-          continue;
-        }
-
-        command[command_index] = cmd_input[i];
-        command_index++;
-
-        if (cmd_input[i] == ';') {
-          command[command_index] = '\0';
-
-          if (rigctl_debug) { t_print("RIGCTL: serial command=%s\n", command); }
-
-          COMMAND *info = g_new(COMMAND, 1);
-          info->client = client;
-          info->command = command;
-          client->busy = 10;
-          g_idle_add(parse_cmd, info);
-          command = g_new(char, MAXDATASIZE);
-          command_index = 0;
-        }
-      }
+      cat_input(client, cmd_input, numbytes);
     }
   }
 
-  // Release the last "command" buffer (that has not yet been used)
-  g_free(command);
+  cat_stats(client, g_get_monotonic_time());
   g_mutex_lock(&mutex_numcat);
   cat_control--;
   g_mutex_unlock(&mutex_numcat);
@@ -5718,19 +6193,22 @@ int launch_serial_rigctl (int id) {
   serial_client[id].shift              = 0;
   serial_client[id].buttonvec          = NULL;
   serial_client[id].encodervec         = NULL;
+  cat_init(&serial_client[id]);
 
   for (int i = 0; i < MAX_ANDROMEDA_LEDS; i++) {
     serial_client[id].last_led[i] = -1;
   }
 
   //
-  // Spawn off server thread
+  // Make sure the auto-reporter is subscribed to state changes
   //
-  serial_client[id].thread_id = g_thread_new( "Serial server", serial_server, (gpointer)&serial_client[id]);
+  serial_client[id].auto_ref = 1;
+  autoreport_ref();
+  notify_changed(NOTIFY_VFO | NOTIFY_MODE);
   //
-  // Launch auto-reporter task
+  // Spawn off server thread
   //
-  serial_client[id].auto_timer = g_timeout_add(750, autoreport_handler, &serial_client[id]);
+  serial_client[id].thread_id = g_thread_new( "Serial server", serial_server, (gpointer)&serial_client[id]);
 
   //
   // If this is a serial line to an ANDROMEDA controller, initialise it and start a periodic GTK task
@@ -5757,9 +6235,9 @@ void disable_serial_rigctl (int id) {
     serial_client[id].andromeda_timer = 0;
   }
 
-  if (serial_client[id].auto_timer != 0) {
-    g_source_remove(serial_client[id].auto_timer);
-    serial_client[id].auto_timer = 0;
+  if (serial_client[id].auto_ref) {
+    serial_client[id].auto_ref = 0;
+    autoreport_unref();
   }
 
   serial_client[id].running = FALSE;
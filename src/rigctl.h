@@ -49,6 +49,7 @@ extern int rigctl_tcp_running();
 extern void  shutdown_tcp_rigctl(void);
 extern void rigctlSaveState(void);
 extern void rigctlRestoreState(void);
+extern void rigctl_send_cw_text(const char *text);
 
 extern int cat_control;
 extern unsigned int rigctl_tcp_port;
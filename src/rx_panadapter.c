@@ -41,6 +41,7 @@
 #endif
 #include "receiver.h"
 #include "rx_panadapter.h"
+#include "spectrum_recorder.h"
 #include "transmitter.h"
 #include "vfo.h"
 
@@ -109,8 +110,16 @@ void rx_panadapter_update(RECEIVER *rx) {
   long long divisor;
   double soffset;
   gboolean active = (active_receiver == rx);
-  int mywidth = gtk_widget_get_allocated_width (rx->panadapter);
-  int myheight = gtk_widget_get_allocated_height (rx->panadapter);
+  int mywidth, myheight;
+
+  if (rx->panadapter) {
+    mywidth = gtk_widget_get_allocated_width (rx->panadapter);
+    myheight = gtk_widget_get_allocated_height (rx->panadapter);
+  } else {
+    mywidth = cairo_image_surface_get_width (rx->panadapter_surface);
+    myheight = cairo_image_surface_get_height (rx->panadapter_surface);
+  }
+
   samples = rx->pixel_samples;
   cairo_t *cr;
   cr = cairo_create (rx->panadapter_surface);
@@ -316,12 +325,12 @@ void rx_panadapter_update(RECEIVER *rx) {
     }
   }
 
-  if (remoteclient.running) {
+  if (remote_clients > 0) {
     char text[64];
     cairo_select_font_face(cr, DISPLAY_FONT_FACE, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
     cairo_set_source_rgba(cr, COLOUR_SHADE);
     cairo_set_font_size(cr, DISPLAY_FONT_SIZE4);
-    inet_ntop(AF_INET, &(((struct sockaddr_in *)&remoteclient.address)->sin_addr), text, 64);
+    remote_client_address(text, sizeof(text));
     cairo_text_extents(cr, text, &extents);
     cairo_move_to(cr, ((double)mywidth / 2.0) - (extents.width / 2.0), (double)myheight / 2.0);
     cairo_show_text(cr, text);
@@ -644,7 +653,37 @@ void rx_panadapter_update(RECEIVER *rx) {
   }
 
   if (rx->id == 0) {
-    display_panadapter_messages(cr, mywidth, rx->fps);
+    display_panadapter_messages(cr, mywidth, rx_get_display_fps(rx));
+  }
+
+  //
+  // Spectrum recording / replay status
+  //
+  char rectext[128];
+
+  if (spectrum_recorder_status(rx, rectext, sizeof(rectext))) {
+    if (spectrum_replay_running(rx)) {
+      cairo_set_source_rgba(cr, COLOUR_ALARM);
+    } else {
+      cairo_set_source_rgba(cr, COLOUR_ATTN);
+    }
+
+    cairo_set_font_size(cr, DISPLAY_FONT_SIZE2);
+    cairo_move_to(cr, (double) mywidth - 300.0, myheight - 10.0);
+    cairo_show_text(cr, rectext);
+  }
+
+  //
+  // Indicate that the display governor has reduced the frame rate
+  //
+  if (rx->display_throttle > 0 && display_warnings) {
+    char text[64];
+    snprintf(text, sizeof(text), "Display %d fps (load %d%%)", rx_get_display_fps(rx),
+             (int)(100.0 * (rx->dsp_load + rx->render_time * rx_get_display_fps(rx))));
+    cairo_set_source_rgba(cr, COLOUR_ATTN);
+    cairo_set_font_size(cr, DISPLAY_FONT_SIZE2);
+    cairo_move_to(cr, 100.0, myheight - 10.0);
+    cairo_show_text(cr, text);
   }
 
   //
@@ -667,7 +706,10 @@ void rx_panadapter_update(RECEIVER *rx) {
   }
 
   cairo_destroy (cr);
-  gtk_widget_queue_draw (rx->panadapter);
+
+  if (rx->panadapter) {
+    gtk_widget_queue_draw (rx->panadapter);
+  }
 }
 
 void rx_panadapter_init(RECEIVER *rx, int width, int height) {
@@ -698,10 +740,19 @@ void rx_panadapter_init(RECEIVER *rx, int width, int height) {
                          | GDK_POINTER_MOTION_HINT_MASK);
 }
 
+//
+// Offscreen panadapter without a widget (used by the render benchmark).
+// The panadapter is drawn into an image surface of the given size.
+//
+void rx_panadapter_init_offscreen(RECEIVER *rx, int width, int height) {
+  rx->panadapter = NULL;
+  rx->panadapter_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+}
+
 void display_panadapter_messages(cairo_t *cr, int width, unsigned int fps) {
   char text[64];
 
-  if (display_warnings || remoteclient.running) {
+  if (display_warnings || remote_clients > 0) {
     //
     // Sequence errors
     // ADC overloads
@@ -712,8 +763,8 @@ void display_panadapter_messages(cairo_t *cr, int width, unsigned int fps) {
     //
     // If we are the server and there is a client, we must
     // do the display otherwise the indicators will not be
-    // cleared after two seconds (remoteclient.running
-    // will be FALSE if we are the client)
+    // cleared after two seconds (remote_clients
+    // will be zero if we are the client)
     //
     cairo_set_source_rgba(cr, COLOUR_ALARM);
     cairo_set_font_size(cr, DISPLAY_FONT_SIZE2);
@@ -21,4 +21,5 @@
 
 void rx_panadapter_update(RECEIVER* rx);
 void rx_panadapter_init(RECEIVER *rx, int width, int height);
+void rx_panadapter_init_offscreen(RECEIVER *rx, int width, int height);
 void display_panadapter_messages(cairo_t *cr, int width, unsigned int fps);
@@ -172,6 +172,10 @@ static void display_pacurr_cb(GtkWidget *widget, gpointer data) {
   display_pacurr = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
 }
 
+static void display_governor_cb(GtkWidget *widget, gpointer data) {
+  display_governor = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+}
+
 void screen_menu(GtkWidget *parent) {
   GtkWidget *label;
   GtkWidget *button;
@@ -302,6 +306,12 @@ void screen_menu(GtkWidget *parent) {
     gtk_widget_show(b_display_pacurr);
     gtk_grid_attach(GTK_GRID(grid), b_display_pacurr, 1, row, 1, 1);
     g_signal_connect(b_display_pacurr, "toggled", G_CALLBACK(display_pacurr_cb), NULL);
+    GtkWidget *b_display_governor = gtk_check_button_new_with_label("Display Governor");
+    gtk_widget_set_name (b_display_governor, "boldlabel");
+    gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (b_display_governor), display_governor);
+    gtk_widget_show(b_display_governor);
+    gtk_grid_attach(GTK_GRID(grid), b_display_governor, 2, row, 1, 1);
+    g_signal_connect(b_display_governor, "toggled", G_CALLBACK(display_governor_cb), NULL);
   }
 
   gtk_container_add(GTK_CONTAINER(content), grid);
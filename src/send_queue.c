@@ -0,0 +1,224 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "message.h"
+#include "send_queue.h"
+
+//
+// Queue limits (bytes). 64 kB are about 300 msec of uncompressed
+// audio, so if the queue is longer than that, the client is lagging
+// behind and spectrum data is useless anyway. The hard limit must
+// be larger than what is sent upon connection.
+//
+#define SEND_SPECTRUM_LIMIT   65536
+#define SEND_AUDIO_LIMIT      262144
+#define SEND_CONTROL_LIMIT    4194304
+
+SEND_PACKET *send_packet_new(int kind, const void *data, int len) {
+  SEND_PACKET *p = g_malloc(sizeof(SEND_PACKET) + len);
+  p->refcount = 1;
+  p->kind = kind;
+  p->key = 1;
+  p->channel = -1;
+  p->len = len;
+
+  if (data != NULL) { memcpy(p->data, data, len); }
+
+  return p;
+}
+
+SEND_PACKET *send_packet_ref(SEND_PACKET *p) {
+  g_atomic_int_inc(&p->refcount);
+  return p;
+}
+
+void send_packet_unref(SEND_PACKET *p) {
+  if (p != NULL && g_atomic_int_dec_and_test(&p->refcount)) {
+    g_free(p);
+  }
+}
+
+void send_queue_init(SEND_QUEUE *q, void (*wakeup)(void *arg), void *wakeup_arg) {
+  g_mutex_init(&q->mutex);
+  g_queue_init(&q->packets);
+  q->bytes = 0;
+  q->closed = 0;
+  q->inflight = 0;
+  q->offset = 0;
+  q->idle = 1;
+  q->wakeup = wakeup;
+  q->wakeup_arg = wakeup_arg;
+  q->sent_bytes = 0;
+  q->spectrum_dropped = 0;
+  q->audio_dropped = 0;
+}
+
+void send_queue_close(SEND_QUEUE *q) {
+  g_mutex_lock(&q->mutex);
+  q->closed = 1;
+  g_mutex_unlock(&q->mutex);
+}
+
+void send_queue_clear(SEND_QUEUE *q) {
+  SEND_PACKET *p;
+  g_mutex_lock(&q->mutex);
+
+  while ((p = g_queue_pop_head(&q->packets)) != NULL) {
+    send_packet_unref(p);
+  }
+
+  q->bytes = 0;
+  q->inflight = 0;
+  q->offset = 0;
+  g_mutex_unlock(&q->mutex);
+}
+
+void send_queue_destroy(SEND_QUEUE *q) {
+  send_queue_clear(q);
+  g_mutex_clear(&q->mutex);
+}
+
+//
+// Remove all spectrum frames from the queue, except those in flight.
+// Called with the mutex locked.
+//
+static void send_queue_drop_spectrum(SEND_QUEUE *q) {
+  GList *l = g_queue_peek_nth_link(&q->packets, q->inflight);
+  int dropped = 0;
+
+  while (l != NULL) {
+    GList *next = l->next;
+    SEND_PACKET *p = l->data;
+
+    if (p->kind == SEND_SPECTRUM) {
+      q->bytes -= p->len;
+      g_queue_delete_link(&q->packets, l);
+      send_packet_unref(p);
+      dropped = 1;
+    }
+
+    l = next;
+  }
+
+  if (dropped) { q->spectrum_dropped++; }
+}
+
+int send_queue_push(SEND_QUEUE *q, SEND_PACKET *p) {
+  int rc = 0;
+  int wakeup = 0;
+  g_mutex_lock(&q->mutex);
+
+  if (q->closed) {
+    rc = -1;
+  } else {
+    switch (p->kind) {
+    case SEND_SPECTRUM:
+      if (q->bytes > SEND_SPECTRUM_LIMIT) {
+        q->spectrum_dropped++;
+        rc = 1;
+      }
+
+      break;
+
+    case SEND_AUDIO:
+      if (q->bytes > SEND_AUDIO_LIMIT) {
+        send_queue_drop_spectrum(q);
+      }
+
+      if (q->bytes > SEND_AUDIO_LIMIT) {
+        q->audio_dropped++;
+        rc = 1;
+      }
+
+      break;
+
+    default:
+      if (q->bytes > SEND_CONTROL_LIMIT) {
+        t_print("%s: send queue overflow, closing\n", __FUNCTION__);
+        q->closed = 1;
+        rc = -1;
+      }
+
+      break;
+    }
+  }
+
+  if (rc == 0) {
+    g_queue_push_tail(&q->packets, send_packet_ref(p));
+    q->bytes += p->len;
+    wakeup = q->idle;
+    q->idle = 0;
+  }
+
+  g_mutex_unlock(&q->mutex);
+
+  if (wakeup && q->wakeup != NULL) { q->wakeup(q->wakeup_arg); }
+
+  return rc;
+}
+
+int send_queue_iov(SEND_QUEUE *q, struct iovec *iov, int max) {
+  int n = 0;
+  g_mutex_lock(&q->mutex);
+
+  for (GList *l = q->packets.head; l != NULL && n < max; l = l->next, n++) {
+    SEND_PACKET *p = l->data;
+    int offset = (n == 0) ? q->offset : 0;
+    iov[n].iov_base = p->data + offset;
+    iov[n].iov_len = p->len - offset;
+  }
+
+  if (n > q->inflight) { q->inflight = n; }
+
+  if (n == 0) { q->idle = 1; }
+
+  g_mutex_unlock(&q->mutex);
+  return n;
+}
+
+void send_queue_consume(SEND_QUEUE *q, int bytes) {
+  g_mutex_lock(&q->mutex);
+  q->sent_bytes += bytes;
+
+  while (bytes > 0) {
+    SEND_PACKET *p = g_queue_peek_head(&q->packets);
+
+    if (p == NULL) { break; }
+
+    int rest = p->len - q->offset;
+
+    if (bytes < rest) {
+      q->offset += bytes;
+      break;
+    }
+
+    bytes -= rest;
+    g_queue_pop_head(&q->packets);
+    q->bytes -= p->len;
+    q->offset = 0;
+
+    if (q->inflight > 0) { q->inflight--; }
+
+    send_packet_unref(p);
+  }
+
+  g_mutex_unlock(&q->mutex);
+}
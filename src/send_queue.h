@@ -0,0 +1,100 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _SEND_QUEUE_H_
+#define _SEND_QUEUE_H_
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+//
+// Outgoing packets of the server. A packet is encoded once and may then
+// be queued for several clients, so it is reference counted.
+//
+enum _send_kind_enum {
+  SEND_CONTROL = 0,            // never dropped
+  SEND_AUDIO,                  // dropped if the queue is very long
+  SEND_SPECTRUM                // dropped first
+};
+
+typedef struct _send_packet {
+  gint refcount;
+  int kind;
+  int key;                     // spectrum: decodable without the previous frame
+  int channel;                 // UDP channel, -1: TCP only
+  int len;
+  uint8_t data[];
+} SEND_PACKET;
+
+extern SEND_PACKET *send_packet_new(int kind, const void *data, int len);
+extern SEND_PACKET *send_packet_ref(SEND_PACKET *p);
+extern void send_packet_unref(SEND_PACKET *p);
+
+//
+// Per-client send queue. If the client (or the network) cannot keep up,
+// spectrum frames are dropped before audio, and audio before control data.
+// If even control data piles up, the queue is closed and the client has to
+// be disconnected.
+//
+// The queue is emptied by an I/O thread with non-blocking sockets: it
+// collects the packets at the head of the queue with send_queue_iov(),
+// writes them with writev(), and removes what has been written with
+// send_queue_consume(). Packets handed out that way are "in flight" and
+// never dropped. If the I/O thread has found the queue empty, the next
+// push calls the wakeup function.
+//
+typedef struct _send_queue {
+  GMutex mutex;
+  GQueue packets;
+  int bytes;                   // bytes in the queue
+  int closed;
+  int inflight;                // packets at the head handed out by send_queue_iov()
+  int offset;                  // bytes of the first packet already sent
+  int idle;                    // I/O thread waits for the wakeup
+  void (*wakeup)(void *arg);
+  void *wakeup_arg;
+  //
+  // statistics
+  //
+  long long sent_bytes;
+  int spectrum_dropped;        // incremented each time spectrum frames are dropped
+  int audio_dropped;
+} SEND_QUEUE;
+
+extern void send_queue_init(SEND_QUEUE *q, void (*wakeup)(void *arg), void *wakeup_arg);
+extern void send_queue_close(SEND_QUEUE *q);
+extern void send_queue_clear(SEND_QUEUE *q);
+extern void send_queue_destroy(SEND_QUEUE *q);
+
+//
+// send_queue_push() takes its own reference and never blocks (except for the
+// queue mutex). It returns 0 if the packet has been queued, 1 if it has been
+// dropped, and -1 if the queue is closed or overflowing with control data.
+//
+extern int send_queue_push(SEND_QUEUE *q, SEND_PACKET *p);
+
+//
+// send_queue_iov() fills at most max iovecs with pending data and returns
+// their number. If it returns 0, the queue is marked idle.
+// send_queue_consume() removes "bytes" written bytes from the head.
+//
+extern int send_queue_iov(SEND_QUEUE *q, struct iovec *iov, int max);
+extern void send_queue_consume(SEND_QUEUE *q, int bytes);
+
+#endif
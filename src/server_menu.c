@@ -32,8 +32,15 @@
 #include "server_menu.h"
 
 static GtkWidget *dialog = NULL;
+static GtkWidget *stats_label = NULL;
+static guint stats_timer = 0;
 
 static void cleanup() {
+  if (stats_timer != 0) {
+    g_source_remove(stats_timer);
+    stats_timer = 0;
+  }
+
   if (dialog != NULL) {
     GtkWidget *tmp = dialog;
     dialog = NULL;
@@ -67,6 +74,29 @@ static void pwd_cb(GtkWidget *widget, GdkEventButton *event, gpointer data) {
   snprintf(hpsdr_pwd, sizeof(hpsdr_pwd), "%s", gtk_entry_get_text(GTK_ENTRY(widget)));
 }
 
+static void link_log_cb(GtkWidget *widget, gpointer data) {
+  remote_link_log = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+}
+
+static int stats_update(gpointer data) {
+  char text[1024];
+
+  if (remote_clients > 0) {
+    remote_audio_stats(text, sizeof(text));
+    size_t n = strlen(text);
+
+    if (n + 1 < sizeof(text)) {
+      text[n++] = '\n';
+      remote_link_stats(text + n, sizeof(text) - n);
+    }
+  } else {
+    snprintf(text, sizeof(text), "No client connected");
+  }
+
+  gtk_label_set_text(GTK_LABEL(stats_label), text);
+  return TRUE;
+}
+
 void server_menu(GtkWidget *parent) {
   GtkWidget *lbl;
   GtkWidget *btn;
@@ -113,6 +143,18 @@ void server_menu(GtkWidget *parent) {
   gtk_grid_attach(GTK_GRID(grid), btn, 1, 3, 2, 1);
   g_signal_connect(btn, "changed", G_CALLBACK(pwd_cb), NULL);
   //
+  btn = gtk_check_button_new_with_label("Log link statistics");
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (btn), remote_link_log);
+  gtk_widget_set_halign(btn, GTK_ALIGN_END);
+  gtk_grid_attach(GTK_GRID(grid), btn, 0, 4, 1, 1);
+  g_signal_connect(btn, "toggled", G_CALLBACK(link_log_cb), NULL);
+  //
+  stats_label = gtk_label_new(NULL);
+  gtk_widget_set_halign(stats_label, GTK_ALIGN_START);
+  gtk_grid_attach(GTK_GRID(grid), stats_label, 0, 5, 3, 1);
+  stats_update(NULL);
+  stats_timer = g_timeout_add(1000, stats_update, NULL);
+  //
   gtk_container_add(GTK_CONTAINER(content), grid);
   sub_menu = dialog;
   gtk_widget_show_all(dialog);
@@ -0,0 +1,257 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "spectrum_codec.h"
+
+//
+// Even over TCP, send a key frame now and then such that a
+// decoder never depends on a long history.
+//
+#define SPECTRUM_KEY_INTERVAL 100
+
+typedef struct _bitstream {
+  uint8_t *buf;
+  int len;                            // in bytes
+  int pos;                            // in bits
+} BITSTREAM;
+
+static inline int put_bits(BITSTREAM *bs, unsigned int val, int n) {
+  if (bs->pos + n > 8 * bs->len) { return -1; }
+
+  for (int i = n - 1; i >= 0; i--) {
+    int byte = bs->pos >> 3;
+
+    if ((bs->pos & 7) == 0) { bs->buf[byte] = 0; }
+
+    if (val & (1U << i)) { bs->buf[byte] |= 0x80 >> (bs->pos & 7); }
+
+    bs->pos++;
+  }
+
+  return 0;
+}
+
+static inline int get_bit(BITSTREAM *bs) {
+  if (bs->pos >= 8 * bs->len) { return -1; }
+
+  int bit = (bs->buf[bs->pos >> 3] >> (7 - (bs->pos & 7))) & 1;
+  bs->pos++;
+  return bit;
+}
+
+//
+// Exp-Golomb code (order 0) for v >= 0:
+// 0 --> 1, 1 --> 010, 2 --> 011, 3 --> 00100, ...
+//
+static int put_golomb(BITSTREAM *bs, unsigned int v) {
+  unsigned int x = v + 1;
+  int n = 0;
+
+  while ((x >> n) > 1) { n++; }
+
+  if (put_bits(bs, 0, n) < 0) { return -1; }
+
+  return put_bits(bs, x, n + 1);
+}
+
+static int get_golomb(BITSTREAM *bs) {
+  int n = 0;
+  int bit;
+
+  while ((bit = get_bit(bs)) == 0) {
+    if (++n > 16) { return -1; }
+  }
+
+  if (bit < 0) { return -1; }
+
+  unsigned int x = 1;
+
+  for (int i = 0; i < n; i++) {
+    if ((bit = get_bit(bs)) < 0) { return -1; }
+
+    x = (x << 1) | bit;
+  }
+
+  return x - 1;
+}
+
+//
+// Non-zero differences: 1, -1, 2, -2, ... --> 0, 1, 2, 3, ...
+//
+static inline unsigned int zigzag(int d) {
+  return d > 0 ? 2 * d - 2 : -2 * d - 1;
+}
+
+static inline int unzigzag(unsigned int z) {
+  return (z & 1) ? -(int)((z + 1) >> 1) : (int)(z >> 1) + 1;
+}
+
+SPECTRUM_CODEC *spectrum_codec_new(int width, int deadband) {
+  SPECTRUM_CODEC *c = g_new0(SPECTRUM_CODEC, 1);
+
+  if (width > SPECTRUM_CODEC_MAX_WIDTH) { width = SPECTRUM_CODEC_MAX_WIDTH; }
+
+  if (deadband < 0) { deadband = 0; }
+
+  c->width = width;
+  c->deadband = deadband;
+  c->frames = SPECTRUM_KEY_INTERVAL;  // start with a key frame
+  return c;
+}
+
+void spectrum_codec_free(SPECTRUM_CODEC *c) {
+  g_free(c);
+}
+
+//
+// Make the next frame a key frame
+//
+void spectrum_codec_force_key(SPECTRUM_CODEC *c) {
+  c->frames = SPECTRUM_KEY_INTERVAL;
+}
+
+int spectrum_quantize(const float *in, int n, int width, int low, int high, uint8_t *out) {
+  int range = high - low;
+
+  if (range > 255) { range = 255; }
+
+  if (range < 1) { range = 1; }
+
+  if (width > n || width <= 0) { width = n; }
+
+  if (width > SPECTRUM_CODEC_MAX_WIDTH) { width = SPECTRUM_CODEC_MAX_WIDTH; }
+
+  for (int i = 0; i < width; i++) {
+    int first = (int)((long)i * n / width);
+    int last  = (int)((long)(i + 1) * n / width);
+    float peak = in[first];
+
+    for (int j = first + 1; j < last; j++) {
+      if (in[j] > peak) { peak = in[j]; }
+    }
+
+    int v = (int) peak - low;
+
+    if (v < 0) { v = 0; }
+
+    if (v > range) { v = range; }
+
+    out[i] = (uint8_t) v;
+  }
+
+  return width;
+}
+
+int spectrum_encode(SPECTRUM_CODEC *c, const uint8_t *in, uint8_t *out, int *flags) {
+  BITSTREAM bs = { out, c->width, 0 };
+  uint8_t ref[SPECTRUM_CODEC_MAX_WIDTH];
+  int key = (c->frames >= SPECTRUM_KEY_INTERVAL);
+  int run = 0;
+  int ok = 1;
+
+  for (int i = 0; i < c->width && ok; i++) {
+    int pred = key ? (i > 0 ? ref[i - 1] : 0) : c->ref[i];
+    int d = in[i] - pred;
+
+    if (!key && d <= c->deadband && d >= -c->deadband) { d = 0; }
+
+    ref[i] = pred + d;
+
+    if (d == 0) {
+      run++;
+      continue;
+    }
+
+    ok = (put_golomb(&bs, run) == 0 && put_golomb(&bs, zigzag(d)) == 0);
+    run = 0;
+  }
+
+  if (ok && run > 0) { ok = (put_golomb(&bs, run) == 0); }
+
+  if (!ok) {
+    //
+    // Coding does not pay off, send the frame as it is
+    //
+    memcpy(out, in, c->width);
+    memcpy(c->ref, in, c->width);
+    c->frames = 1;
+    *flags = SPECTRUM_FLAG_KEY | SPECTRUM_FLAG_RAW;
+    return c->width;
+  }
+
+  memcpy(c->ref, ref, c->width);
+  c->frames = key ? 1 : c->frames + 1;
+  *flags = key ? SPECTRUM_FLAG_KEY : 0;
+  return (bs.pos + 7) >> 3;
+}
+
+int spectrum_decode(SPECTRUM_CODEC *c, const uint8_t *in, int len, int width, int flags) {
+  if (width <= 0 || width > SPECTRUM_CODEC_MAX_WIDTH) { return -1; }
+
+  if (width != c->width) {
+    c->width = width;
+    c->valid = 0;
+  }
+
+  if (flags & SPECTRUM_FLAG_RAW) {
+    if (len < width) { return -1; }
+
+    memcpy(c->ref, in, width);
+    c->valid = 1;
+    return 0;
+  }
+
+  int key = (flags & SPECTRUM_FLAG_KEY);
+
+  if (!key && !c->valid) { return -1; }
+
+  BITSTREAM bs = { (uint8_t *)in, len, 0 };
+  int i = 0;
+
+  while (i < width) {
+    int run = get_golomb(&bs);
+
+    if (run < 0 || run > width - i) {
+      c->valid = 0;
+      return -1;
+    }
+
+    for (int j = 0; j < run; j++, i++) {
+      if (key) { c->ref[i] = i > 0 ? c->ref[i - 1] : 0; }
+    }
+
+    if (i >= width) { break; }
+
+    int z = get_golomb(&bs);
+
+    if (z < 0) {
+      c->valid = 0;
+      return -1;
+    }
+
+    int pred = key ? (i > 0 ? c->ref[i - 1] : 0) : c->ref[i];
+    c->ref[i] = (uint8_t)(pred + unzigzag(z));
+    i++;
+  }
+
+  c->valid = 1;
+  return 0;
+}
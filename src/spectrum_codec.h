@@ -0,0 +1,71 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _SPECTRUM_CODEC_H_
+#define _SPECTRUM_CODEC_H_
+
+#include <stdint.h>
+
+//
+// Compression of panadapter frames for the client/server protocol.
+// A frame is a row of 8-bit values (1 dB per step, 0 corresponds to the
+// lower end of the dB range requested by the client).
+//
+// Frames are coded as differences to the previous frame (key frames:
+// to the left neighbour). Runs of zero differences and the non-zero
+// differences are written as Exp-Golomb codes, so an unchanged pixel
+// costs at most one bit. Differences up to "deadband" dB are suppressed
+// by the encoder, which tracks what the decoder has, so the error never
+// exceeds the deadband. If coding does not pay off, the frame is sent raw.
+//
+#define SPECTRUM_CODEC_MAX_WIDTH  4096
+
+#define SPECTRUM_FLAG_KEY   0x01      // frame does not depend on the previous one
+#define SPECTRUM_FLAG_RAW   0x02      // frame is not coded (one byte per pixel)
+
+typedef struct _spectrum_codec {
+  int width;                          // pixels per frame
+  int deadband;                       // encoder only, in dB
+  int frames;                         // frames since the last key frame
+  int valid;                          // decoder only: ref[] is valid
+  uint8_t ref[SPECTRUM_CODEC_MAX_WIDTH];  // the frame as seen by the decoder
+} SPECTRUM_CODEC;
+
+extern SPECTRUM_CODEC *spectrum_codec_new(int width, int deadband);
+extern void spectrum_codec_free(SPECTRUM_CODEC *c);
+extern void spectrum_codec_force_key(SPECTRUM_CODEC *c);
+
+//
+// Reduce a row of dBm values to "width" pixels (taking the peak of the
+// pixels that are merged) and quantize it to the range low...high.
+// If width >= n, no reduction takes place. Returns the number of pixels.
+//
+extern int spectrum_quantize(const float *in, int n, int width, int low, int high, uint8_t *out);
+
+//
+// spectrum_encode() codes one frame of c->width pixels into "out", which must
+// have room for c->width bytes. It returns the number of bytes and stores
+// the SPECTRUM_FLAG_xxx bits in *flags.
+// spectrum_decode() reconstructs a frame of "width" pixels into c->ref and
+// returns 0, or -1 if the data is corrupt or a delta frame arrives without
+// a valid reference.
+//
+extern int spectrum_encode(SPECTRUM_CODEC *c, const uint8_t *in, uint8_t *out, int *flags);
+extern int spectrum_decode(SPECTRUM_CODEC *c, const uint8_t *in, int len, int width, int flags);
+
+#endif
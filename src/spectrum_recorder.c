@@ -0,0 +1,500 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// Spectrum recorder
+//
+// While recording, each pixel frame obtained from the analyzer (the visible part of
+// rx->pixel_samples) is stored, together with VFO/zoom/pan data, in a memory-mapped
+// file. The file contains a ring of frames, so it always holds the last few minutes.
+// This allows to review band activity after the fact. Since replaying feeds the
+// recorded frames into the panadapter and waterfall, a recording also serves as a
+// deterministic input for rendering benchmarks.
+//
+// The file is sized such that it holds the requested number of minutes if the
+// delta encoding achieves (at least) a 2:1 compression, which is easily the case
+// for quiet bands. Otherwise the oldest frames are overwritten earlier.
+//
+// All functions here are called from the GTK main thread, more specifically from
+// rx_update_display() with the display mutex of the receiver held, or from the menu.
+//
+
+#include <gtk/gtk.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "message.h"
+#include "radio.h"
+#include "receiver.h"
+#include "spectrum_recorder.h"
+#include "vfo.h"
+
+typedef struct _specrec {
+  int             fd;
+  size_t          map_size;
+  unsigned char  *map;
+  SPECREC_HEADER *header;
+  SPECREC_INDEX  *index;
+  unsigned char  *data;
+  int             replaying;     // 0: recording, 1: replaying
+  int             width;         // width of the previous frame
+  uint64_t        next;          // replay: next frame to show
+  int64_t         time;          // replay: time stamp of the last frame shown
+  long long       frequency;     // replay: VFO frequency of the last frame shown
+  float          *samples;       // replay: pixel buffer handed to the panadapter/waterfall
+  int             num_samples;
+  uint8_t         cur[SPECREC_MAX_WIDTH];
+  uint8_t         prev[SPECREC_MAX_WIDTH];
+  uint8_t         payload[SPECREC_MAX_WIDTH];
+} SPECREC;
+
+static SPECREC specrec[SPECREC_RECEIVERS];
+
+static SPECREC *specrec_get(const RECEIVER *rx) {
+  if (rx->id < 0 || rx->id >= SPECREC_RECEIVERS) {
+    return NULL;
+  }
+
+  return &specrec[rx->id];
+}
+
+static void specrec_filename(const RECEIVER *rx, char *name, size_t len) {
+  snprintf(name, len, "spectrum_rx%d.bin", rx->id + 1);
+}
+
+static void specrec_unmap(SPECREC *r) {
+  if (r->map != NULL) {
+    if (!r->replaying) {
+      msync(r->map, r->map_size, MS_ASYNC);
+    }
+
+    munmap(r->map, r->map_size);
+  }
+
+  if (r->fd >= 0) {
+    close(r->fd);
+  }
+
+  r->map = NULL;
+  r->header = NULL;
+  r->index = NULL;
+  r->data = NULL;
+  r->fd = -1;
+}
+
+static int specrec_map(SPECREC *r, int fd, size_t size, int prot) {
+  r->map = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+
+  if (r->map == MAP_FAILED) {
+    t_print("%s: mmap failed\n", __FUNCTION__);
+    r->map = NULL;
+    close(fd);
+    return 0;
+  }
+
+  r->fd = fd;
+  r->map_size = size;
+  r->header = (SPECREC_HEADER *) r->map;
+  r->index = (SPECREC_INDEX *)(r->map + sizeof(SPECREC_HEADER));
+  r->data = r->map + sizeof(SPECREC_HEADER) + r->header->index_entries * sizeof(SPECREC_INDEX);
+  return 1;
+}
+
+int spectrum_encode_frame(const uint8_t *cur, const uint8_t *prev, int width, uint8_t *out) {
+  //
+  // Returns the number of bytes produced, or -1 if the encoded frame would be
+  // larger than a keyframe (in this case a keyframe should be used).
+  //
+  int n = 0;
+  int i = 0;
+
+  while (i < width) {
+    if (cur[i] == prev[i]) {
+      int run = 0;
+
+      while (i < width && run < 255 && cur[i] == prev[i]) {
+        run++;
+        i++;
+      }
+
+      if (n + 2 > width) { return -1; }
+
+      out[n++] = 0;
+      out[n++] = run;
+    } else {
+      if (n + 1 > width) { return -1; }
+
+      out[n++] = (uint8_t)(cur[i] - prev[i]);
+      i++;
+    }
+  }
+
+  return n;
+}
+
+int spectrum_decode_frame(const uint8_t *in, int len, int keyframe, uint8_t *cur, int width) {
+  //
+  // On input, cur contains the previous frame (not used for keyframes).
+  // Returns 0 on success and -1 if the data is corrupt.
+  //
+  int i = 0;
+  int n = 0;
+
+  if (keyframe) {
+    if (len != width) { return -1; }
+
+    memcpy(cur, in, width);
+    return 0;
+  }
+
+  while (n < len) {
+    uint8_t b = in[n++];
+
+    if (b == 0) {
+      if (n >= len) { return -1; }
+
+      i += in[n++];
+
+      if (i > width) { return -1; }
+    } else {
+      if (i >= width) { return -1; }
+
+      cur[i++] += b;
+    }
+  }
+
+  return (i == width) ? 0 : -1;
+}
+
+void spectrum_recorder_start(const RECEIVER *rx, int minutes) {
+  SPECREC *r = specrec_get(rx);
+  char name[64];
+
+  if (r == NULL || radio_is_remote) { return; }
+
+  if (r->map != NULL) {
+    // already recording or replaying
+    return;
+  }
+
+  int fps = rx->fps > 0 ? rx->fps : 10;
+  int width = rx->width < SPECREC_MAX_WIDTH ? rx->width : SPECREC_MAX_WIDTH;
+  uint32_t entries = (uint32_t) minutes * 60 * fps;
+  uint32_t data_size = entries * (uint32_t)(sizeof(SPECREC_FRAME) + width / 2);
+  size_t size = sizeof(SPECREC_HEADER) + entries * sizeof(SPECREC_INDEX) + data_size;
+  specrec_filename(rx, name, sizeof(name));
+  int fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0) {
+    t_print("%s: cannot open %s\n", __FUNCTION__, name);
+    return;
+  }
+
+  if (ftruncate(fd, size) < 0) {
+    t_print("%s: cannot resize %s to %lu bytes\n", __FUNCTION__, name, (unsigned long) size);
+    close(fd);
+    return;
+  }
+
+  SPECREC_HEADER h;
+  h.magic = SPECREC_MAGIC;
+  h.version = SPECREC_VERSION;
+  h.index_entries = entries;
+  h.data_size = data_size;
+  h.fps = fps;
+  h.keyframe_interval = fps;
+  h.frames = 0;
+  h.data_pos = 0;
+
+  if (pwrite(fd, &h, sizeof(h), 0) != sizeof(h)) {
+    t_print("%s: cannot write %s\n", __FUNCTION__, name);
+    close(fd);
+    return;
+  }
+
+  r->replaying = 0;
+
+  if (!specrec_map(r, fd, size, PROT_READ | PROT_WRITE)) {
+    return;
+  }
+
+  r->width = 0;
+  t_print("%s: RX%d recording to %s (%d minutes, %lu bytes)\n", __FUNCTION__, rx->id + 1, name, minutes,
+          (unsigned long) size);
+}
+
+void spectrum_recorder_stop(const RECEIVER *rx) {
+  SPECREC *r = specrec_get(rx);
+
+  if (r == NULL || r->map == NULL || r->replaying) { return; }
+
+  t_print("%s: RX%d frames=%llu\n", __FUNCTION__, rx->id + 1, (unsigned long long) r->header->frames);
+  specrec_unmap(r);
+}
+
+int spectrum_recorder_running(const RECEIVER *rx) {
+  const SPECREC *r = specrec_get(rx);
+  return r != NULL && r->map != NULL && !r->replaying;
+}
+
+void spectrum_recorder_add_frame(const RECEIVER *rx) {
+  SPECREC *r = specrec_get(rx);
+
+  if (r == NULL || r->map == NULL || r->replaying || rx->pixel_samples == NULL) { return; }
+
+  SPECREC_HEADER *h = r->header;
+  int width = rx->width < SPECREC_MAX_WIDTH ? rx->width : SPECREC_MAX_WIDTH;
+  const float *samples = rx->pixel_samples + rx->pan;
+  int len = -1;
+  int keyframe;
+
+  for (int i = 0; i < width; i++) {
+    int s = ((int) samples[i]) + 200;  // -200dBm ... 55dBm maps to 0 ... 255
+
+    if (s < 0) { s = 0; }
+
+    if (s > 255) { s = 255; }
+
+    r->cur[i] = (uint8_t) s;
+  }
+
+  keyframe = (width != r->width) || (h->frames % h->keyframe_interval == 0);
+
+  if (!keyframe) {
+    len = spectrum_encode_frame(r->cur, r->prev, width, r->payload);
+  }
+
+  if (len < 0) {
+    keyframe = 1;
+    len = width;
+    memcpy(r->payload, r->cur, width);
+  }
+
+  //
+  // Frames are 8-byte aligned in the data ring. If the frame does not fit
+  // at the end of the ring, continue at the beginning.
+  //
+  uint32_t total = (sizeof(SPECREC_FRAME) + len + 7) & ~7U;
+
+  if (h->data_pos + total > h->data_size) {
+    h->data_pos = 0;
+  }
+
+  SPECREC_FRAME *f = (SPECREC_FRAME *)(r->data + h->data_pos);
+  const struct _vfo *v = &vfo[rx->id];
+  f->frame = h->frames;
+  f->time = g_get_real_time();
+  f->frequency = v->frequency;
+  f->ctun_frequency = v->ctun_frequency;
+  f->offset = v->offset;
+  f->sample_rate = rx->sample_rate;
+  f->width = width;
+  f->payload = len;
+  f->pan = rx->pan;
+  f->zoom = rx->zoom;
+  f->ctun = v->ctun;
+  f->keyframe = keyframe;
+  f->mode = v->mode;
+  memcpy((unsigned char *)(f + 1), r->payload, len);
+  SPECREC_INDEX *ix = &r->index[h->frames % h->index_entries];
+  ix->frame = h->frames;
+  ix->offset = h->data_pos;
+  ix->length = total;
+  h->data_pos += total;
+  h->frames++;
+  memcpy(r->prev, r->cur, width);
+  r->width = width;
+}
+
+static const SPECREC_FRAME *specrec_frame(const SPECREC *r, uint64_t frame) {
+  //
+  // Return frame if it is still present in the data ring, else NULL
+  //
+  const SPECREC_HEADER *h = r->header;
+  const SPECREC_INDEX *ix = &r->index[frame % h->index_entries];
+
+  if (frame >= h->frames || ix->frame != frame || ix->offset + ix->length > h->data_size) {
+    return NULL;
+  }
+
+  const SPECREC_FRAME *f = (const SPECREC_FRAME *)(r->data + ix->offset);
+
+  if (f->frame != frame || sizeof(SPECREC_FRAME) + f->payload > ix->length || f->width > SPECREC_MAX_WIDTH) {
+    return NULL;
+  }
+
+  return f;
+}
+
+int spectrum_replay_start(RECEIVER *rx) {
+  SPECREC *r = specrec_get(rx);
+  char name[64];
+  struct stat st;
+
+  if (r == NULL || radio_is_remote) { return 0; }
+
+  if (r->map != NULL) {
+    if (r->replaying) { return 1; }
+
+    spectrum_recorder_stop(rx);
+  }
+
+  specrec_filename(rx, name, sizeof(name));
+  int fd = open(name, O_RDONLY);
+
+  if (fd < 0) {
+    t_print("%s: cannot open %s\n", __FUNCTION__, name);
+    return 0;
+  }
+
+  if (fstat(fd, &st) < 0 || st.st_size < (off_t) sizeof(SPECREC_HEADER)) {
+    t_print("%s: %s is not a spectrum recording\n", __FUNCTION__, name);
+    close(fd);
+    return 0;
+  }
+
+  if (!specrec_map(r, fd, st.st_size, PROT_READ)) {
+    return 0;
+  }
+
+  r->replaying = 1;
+
+  const SPECREC_HEADER *h = r->header;
+
+  if (h->magic != SPECREC_MAGIC || h->version != SPECREC_VERSION || h->index_entries == 0 ||
+      sizeof(SPECREC_HEADER) + h->index_entries * sizeof(SPECREC_INDEX) + h->data_size > (size_t) st.st_size) {
+    t_print("%s: %s is not a valid spectrum recording\n", __FUNCTION__, name);
+    specrec_unmap(r);
+    return 0;
+  }
+
+  //
+  // Start with the oldest keyframe still present in the data ring
+  //
+  r->next = h->frames > h->index_entries ? h->frames - h->index_entries : 0;
+
+  for (;;) {
+    const SPECREC_FRAME *f;
+
+    if (r->next >= h->frames) {
+      t_print("%s: %s contains no frames\n", __FUNCTION__, name);
+      specrec_unmap(r);
+      return 0;
+    }
+
+    f = specrec_frame(r, r->next);
+
+    if (f != NULL && f->keyframe) { break; }
+
+    r->next++;
+  }
+
+  t_print("%s: RX%d replaying %llu frames from %s\n", __FUNCTION__, rx->id + 1,
+          (unsigned long long)(h->frames - r->next), name);
+  return 1;
+}
+
+void spectrum_replay_stop(RECEIVER *rx) {
+  SPECREC *r = specrec_get(rx);
+
+  if (r == NULL || r->map == NULL || !r->replaying) { return; }
+
+  specrec_unmap(r);
+  r->replaying = 0;
+  //
+  // rx->pixel_samples points to the replay buffer. It is only used
+  // after a successful rx_get_pixels(), which lets it point to the
+  // analyzer again. The replay buffer is kept for the next replay.
+  //
+  rx->pixel_samples = NULL;
+}
+
+int spectrum_replay_running(const RECEIVER *rx) {
+  const SPECREC *r = specrec_get(rx);
+  return r != NULL && r->map != NULL && r->replaying;
+}
+
+int spectrum_replay_next_frame(RECEIVER *rx) {
+  //
+  // Decode the next frame and let rx->pixel_samples point to it.
+  // Returns 1 if there is a new frame to display, and 0 if replay has ended.
+  // The recorded row is placed at the current pan position, and the
+  // panadapter/waterfall is drawn with the current VFO settings, while
+  // the recorded time and frequency are shown as a status text.
+  //
+  SPECREC *r = specrec_get(rx);
+
+  if (r == NULL || r->map == NULL || !r->replaying) { return 0; }
+
+  const SPECREC_FRAME *f = specrec_frame(r, r->next);
+
+  if (f == NULL || spectrum_decode_frame((const uint8_t *)(f + 1), f->payload, f->keyframe, r->cur, f->width) < 0) {
+    t_print("%s: RX%d replay finished\n", __FUNCTION__, rx->id + 1);
+    spectrum_replay_stop(rx);
+    return 0;
+  }
+
+  r->next++;
+  r->time = f->time;
+  r->frequency = f->ctun ? f->ctun_frequency : f->frequency;
+
+  if (r->samples == NULL || r->num_samples < rx->pixels) {
+    g_free(r->samples);
+    r->samples = g_new(float, rx->pixels);
+    r->num_samples = rx->pixels;
+  }
+
+  int width = f->width < rx->width ? f->width : rx->width;
+
+  for (int i = 0; i < rx->pixels; i++) {
+    r->samples[i] = -200.0F;
+  }
+
+  for (int i = 0; i < width; i++) {
+    r->samples[rx->pan + i] = (float)((int) r->cur[i] - 200);
+  }
+
+  rx->pixel_samples = r->samples;
+  return 1;
+}
+
+int spectrum_recorder_status(const RECEIVER *rx, char *text, size_t len) {
+  const SPECREC *r = specrec_get(rx);
+
+  if (r == NULL || r->map == NULL) { return 0; }
+
+  if (r->replaying) {
+    GDateTime *dt = g_date_time_new_from_unix_local(r->time / 1000000);
+    gchar *str = g_date_time_format(dt, "%Y-%m-%d %H:%M:%S");
+    snprintf(text, len, "Replay %s  %0.3f kHz", str, (double) r->frequency * 0.001);
+    g_free(str);
+    g_date_time_unref(dt);
+  } else {
+    const SPECREC_HEADER *h = r->header;
+    uint64_t frames = h->frames < h->index_entries ? h->frames : h->index_entries;
+    int secs = (int)(frames / h->fps);
+    snprintf(text, len, "Spectrum REC %d:%02d", secs / 60, secs % 60);
+  }
+
+  return 1;
+}
@@ -0,0 +1,93 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _SPECTRUM_RECORDER_H_
+#define _SPECTRUM_RECORDER_H_
+
+#include <stdint.h>
+
+#include "receiver.h"
+
+#define SPECREC_MAGIC       0x43455053    // "SPEC"
+#define SPECREC_VERSION     1
+#define SPECREC_MAX_WIDTH   4096          // max. number of pixels recorded per frame
+#define SPECREC_MINUTES     10            // default length of the recording ring
+#define SPECREC_RECEIVERS   2             // spectrum recording is possible for RX1 and RX2
+
+//
+// File layout: a SPECREC_HEADER, followed by the frame index (index_entries
+// SPECREC_INDEX records), followed by the data ring (data_size bytes).
+// Each frame in the data ring is a SPECREC_FRAME followed by the encoded payload.
+// All data is stored in host byte order.
+//
+typedef struct _specrec_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t index_entries;      // number of entries in the frame index
+  uint32_t data_size;          // size of the data ring (bytes)
+  uint32_t fps;                // frame rate when the recording was started
+  uint32_t keyframe_interval;  // every n-th frame is encoded without reference to the previous one
+  uint64_t frames;             // total number of frames written so far
+  uint64_t data_pos;           // write position in the data ring
+} SPECREC_HEADER;
+
+typedef struct _specrec_index {
+  uint64_t frame;              // frame number
+  uint32_t offset;             // position of the frame in the data ring
+  uint32_t length;             // length of frame header plus payload
+} SPECREC_INDEX;
+
+typedef struct _specrec_frame {
+  uint64_t frame;              // frame number (used to validate index entries)
+  int64_t  time;               // wall-clock time in micro-seconds since the epoch
+  int64_t  frequency;          // VFO frequency
+  int64_t  ctun_frequency;     // VFO CTUN frequency
+  int64_t  offset;             // VFO offset
+  int32_t  sample_rate;
+  uint16_t width;              // number of pixels in this frame
+  uint16_t payload;            // number of bytes following
+  uint16_t pan;
+  uint8_t  zoom;
+  uint8_t  ctun;
+  uint8_t  keyframe;           // 1: payload contains quantized pixels, 0: run-length encoded deltas
+  uint8_t  mode;
+  uint8_t  pad[2];
+} SPECREC_FRAME;
+
+//
+// Pixels are quantized to 1 dB in the same way as for the remote spectrum
+// (-200 dBm ... +55 dBm map to 0 ... 255). A keyframe contains these bytes,
+// other frames contain the byte-wise difference to the previous frame where
+// a zero byte is followed by the number of consecutive zero differences.
+//
+extern int spectrum_encode_frame(const uint8_t *cur, const uint8_t *prev, int width, uint8_t *out);
+extern int spectrum_decode_frame(const uint8_t *in, int len, int keyframe, uint8_t *cur, int width);
+
+extern void spectrum_recorder_start(const RECEIVER *rx, int minutes);
+extern void spectrum_recorder_stop(const RECEIVER *rx);
+extern int  spectrum_recorder_running(const RECEIVER *rx);
+extern void spectrum_recorder_add_frame(const RECEIVER *rx);
+
+extern int  spectrum_replay_start(RECEIVER *rx);
+extern void spectrum_replay_stop(RECEIVER *rx);
+extern int  spectrum_replay_running(const RECEIVER *rx);
+extern int  spectrum_replay_next_frame(RECEIVER *rx);
+
+extern int  spectrum_recorder_status(const RECEIVER *rx, char *text, size_t len);
+
+#endif
@@ -0,0 +1,181 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "message.h"
+#include "state_cache.h"
+
+#define STATE_CACHE_MAGIC 0x53544154       // "STAT"
+
+//
+// 64-bit FNV-1a. This only has to detect changes, not tampering.
+//
+uint64_t state_hash(const uint8_t *data, size_t len) {
+  uint64_t h = 0xCBF29CE484222325ULL;
+
+  for (size_t i = 0; i < len; i++) {
+    h ^= data[i];
+    h *= 0x100000001B3ULL;
+  }
+
+  return h;
+}
+
+void state_snapshot_set(STATE_SNAPSHOT *s, int section, const uint8_t *data, size_t len) {
+  if (s->data[section] == NULL) {
+    s->data[section] = g_byte_array_sized_new(len);
+  } else {
+    g_byte_array_set_size(s->data[section], 0);
+  }
+
+  g_byte_array_append(s->data[section], data, len);
+  s->hash[section] = state_hash(data, len);
+}
+
+void state_snapshot_clear(STATE_SNAPSHOT *s) {
+  for (int i = 0; i < STATE_SECTIONS; i++) {
+    if (s->data[i] != NULL) {
+      g_byte_array_free(s->data[i], TRUE);
+      s->data[i] = NULL;
+    }
+
+    s->hash[i] = 0;
+  }
+}
+
+static GByteArray *state_convert(GConverter *conv, const uint8_t *in, size_t len, size_t hint) {
+  GByteArray *out = g_byte_array_sized_new(hint);
+  uint8_t buf[4096];
+  GConverterResult rc;
+
+  do {
+    gsize bytes_read = 0;
+    gsize bytes_written = 0;
+    GError *error = NULL;
+    rc = g_converter_convert(conv, in, len, buf, sizeof(buf), G_CONVERTER_INPUT_AT_END,
+                             &bytes_read, &bytes_written, &error);
+
+    if (rc == G_CONVERTER_ERROR) {
+      t_print("%s: %s\n", __FUNCTION__, error->message);
+      g_error_free(error);
+      g_byte_array_free(out, TRUE);
+      return NULL;
+    }
+
+    in += bytes_read;
+    len -= bytes_read;
+    g_byte_array_append(out, buf, bytes_written);
+  } while (rc != G_CONVERTER_FINISHED);
+
+  return out;
+}
+
+GByteArray *state_compress(const uint8_t *data, size_t len) {
+  GZlibCompressor *conv = g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9);
+  GByteArray *out = state_convert(G_CONVERTER(conv), data, len, len / 4);
+  g_object_unref(conv);
+  return out;
+}
+
+GByteArray *state_uncompress(const uint8_t *data, size_t len, size_t raw_len) {
+  GZlibDecompressor *conv = g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+  GByteArray *out = state_convert(G_CONVERTER(conv), data, len, raw_len);
+  g_object_unref(conv);
+
+  if (out != NULL && out->len != raw_len) {
+    t_print("%s: got %u bytes, expected %zu\n", __FUNCTION__, out->len, raw_len);
+    g_byte_array_free(out, TRUE);
+    out = NULL;
+  }
+
+  return out;
+}
+
+//
+// File layout: magic, version, then for each section its length
+// (0xFFFFFFFF: not available) and contents. Native byte order, since
+// the file never leaves the machine.
+//
+int state_cache_load(STATE_SNAPSHOT *s, const char *filename, uint32_t version) {
+  uint32_t head[2];
+  FILE *f = fopen(filename, "rb");
+  state_snapshot_clear(s);
+
+  if (f == NULL) { return -1; }
+
+  if (fread(head, sizeof(head), 1, f) != 1 || head[0] != STATE_CACHE_MAGIC || head[1] != version) {
+    t_print("%s: ignoring %s\n", __FUNCTION__, filename);
+    fclose(f);
+    return -1;
+  }
+
+  for (int i = 0; i < STATE_SECTIONS; i++) {
+    uint32_t len;
+
+    if (fread(&len, sizeof(len), 1, f) != 1) { break; }
+
+    if (len == 0xFFFFFFFF) { continue; }
+
+    if (len > 1048576) { break; }
+
+    uint8_t *data = g_malloc(len > 0 ? len : 1);
+
+    if (len > 0 && fread(data, len, 1, f) != 1) {
+      g_free(data);
+      break;
+    }
+
+    state_snapshot_set(s, i, data, len);
+    g_free(data);
+  }
+
+  fclose(f);
+  return 0;
+}
+
+int state_cache_save(const STATE_SNAPSHOT *s, const char *filename, uint32_t version) {
+  uint32_t head[2] = { STATE_CACHE_MAGIC, version };
+  FILE *f = fopen(filename, "wb");
+
+  if (f == NULL) {
+    t_perror("state_cache_save");
+    return -1;
+  }
+
+  int ok = (fwrite(head, sizeof(head), 1, f) == 1);
+
+  for (int i = 0; i < STATE_SECTIONS && ok; i++) {
+    uint32_t len = s->data[i] != NULL ? s->data[i]->len : 0xFFFFFFFF;
+    ok = (fwrite(&len, sizeof(len), 1, f) == 1);
+
+    if (ok && s->data[i] != NULL && len > 0) { ok = (fwrite(s->data[i]->data, len, 1, f) == 1); }
+  }
+
+  if (fclose(f) != 0) { ok = 0; }
+
+  if (!ok) {
+    t_perror("state_cache_save");
+    remove(filename);
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _STATE_CACHE_H_
+#define _STATE_CACHE_H_
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+//
+// Radio state for the initial client/server sync. The packets the server
+// sends upon connection are grouped into sections, and each section is
+// identified by a hash of its contents. A client keeps the sections of
+// its last session (in memory and in a cache file per server), and upon
+// reconnecting the server only sends the sections that have changed.
+//
+enum _state_section_enum {
+  STATE_RADIO = 0,               // radio, ADC, DAC, Var1/Var2 filter edges
+  STATE_RX,                      // receivers
+  STATE_VFO,                     // VFO A and B
+  STATE_BAND,                    // bands and band stacks
+  STATE_MEMORY,                  // memory slots
+  STATE_TX,                      // transmitter
+  STATE_SECTIONS
+};
+
+typedef struct _state_snapshot {
+  GByteArray *data[STATE_SECTIONS];   // NULL: section not available
+  uint64_t hash[STATE_SECTIONS];
+} STATE_SNAPSHOT;
+
+extern uint64_t state_hash(const uint8_t *data, size_t len);
+extern void state_snapshot_set(STATE_SNAPSHOT *s, int section, const uint8_t *data, size_t len);
+extern void state_snapshot_clear(STATE_SNAPSHOT *s);
+
+//
+// zlib compression of the initial sync. state_uncompress() returns NULL
+// if the data is corrupt or does not have the expected length.
+//
+extern GByteArray *state_compress(const uint8_t *data, size_t len);
+extern GByteArray *state_uncompress(const uint8_t *data, size_t len, size_t raw_len);
+
+//
+// The cache file carries the client/server version number, a file
+// written by another version is ignored. Hashes are recomputed on loading.
+//
+extern int state_cache_load(STATE_SNAPSHOT *s, const char *filename, uint32_t version);
+extern int state_cache_save(const STATE_SNAPSHOT *s, const char *filename, uint32_t version);
+
+#endif
@@ -28,22 +28,37 @@
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 #include <ctype.h>
+#include <stdlib.h>
 
 #include <openssl/sha.h>
 #include <openssl/evp.h>
 
+#include "band.h"
+#include "command_queue.h"
+#include "iq_codec.h"
+#include "jitter_buffer.h"
 #include "message.h"
+#include "notify.h"
 #include "radio.h"
 #include "rigctl.h"
+#include "spectrum_codec.h"
+#include "tci.h"
+#include "tci_stream.h"
 #include "vfo.h"
 
 #define MAX_TCI_CLIENTS 3
 #define MAXDATASIZE     1024
 #define MAXMSGSIZE      128
+#define TCI_CHUNK       1024   // max. samples per stream frame
+#define TCI_SPECTRUM_DB -160   // level (dBm) of spectrum pixel value 0
+#define TCI_INPUT_SIZE  65536  // input buffer, large enough for TX audio frames
+#define TCI_CHRONO      1024   // TX audio samples (48 kHz) requested per TX_CHRONO frame
 
 int tci_enable = 0;
 int tci_port   = 40001;
 int tci_txonly = 0;
+int tci_streaming = 0;   // number of IQ/audio streams started by the clients
+int tci_spectrum = 0;    // number of spectrum streams started by the clients
 
 //
 // OpCodes for WebSocket frames
@@ -63,11 +78,25 @@ static int tci_running = 0;
 static int server_socket = -1;
 static struct sockaddr_in server_address;
 
+//
+// IQ and RX audio stream of one receiver for one client. The queue is
+// filled by the RX thread of the receiver, which also owns the decimators.
+//
+typedef struct _rx_stream {
+  COMMAND_QUEUE queue;
+  IQ_DECIMATOR *iq_decimator;
+  IQ_DECIMATOR *audio_decimator;
+  int iq_factor;                // decimation requested when iq_decimator was created
+  int audio_factor;             // decimation requested when audio_decimator was created
+} RX_STREAM;
+
 typedef struct _client {
   int seq;                      // Seq. number of the client
   int fd;                       // socket
+  volatile gint in_use;         // slot taken, cleared when all threads of the client are gone
   int running;                  // set this to zero to close client connection
   guint tci_timer;              // GTK id  of the periodic task
+  int notify_id;                // subscription for state changes
   socklen_t address_length;     // unused
   struct sockaddr_in address;   // unused
   GThread *thread_id;           // thread id of receiving thread
@@ -80,6 +109,22 @@ typedef struct _client {
   int last_mox;                 // last mox   state reported
   int count;                    // ping counter
   int rxsensor;                 // enable transmit of S meter data
+  int iq_rate;                  // iq_samplerate requested by the client
+  int audio_rate;               // audio_samplerate requested by the client
+  volatile gint iq_on[2];       // iq_start/iq_stop per receiver
+  volatile gint audio_on[2];    // audio_start/audio_stop per receiver
+  volatile gint spectrum_on[2]; // spectrum_start/spectrum_stop per receiver
+  int spectrum_width;           // pixels per spectrum frame requested by the client
+  int spectrum_fps;             // spectrum frames per second requested by the client
+  gint64 spectrum_last[2];      // time of the last spectrum frame (GTK thread only)
+  RX_STREAM stream[2];          // IQ and audio frames per receiver
+  COMMAND_QUEUE text;           // text frames, produced by the GTK thread
+  COMMAND_QUEUE chrono;         // TX_CHRONO frames, produced by the TX thread
+  COMMAND_QUEUE spectrum;       // spectrum frames, produced by the GTK thread
+  GThread *writer_id;           // thread id of sending thread
+  GMutex wakeup_mutex;
+  GCond wakeup_cond;
+  volatile gint sleeping;       // sending thread waits for frames
 } CLIENT;
 
 typedef struct _response {
@@ -90,8 +135,16 @@ typedef struct _response {
 
 static CLIENT tci_client[MAX_TCI_CLIENTS];
 
+//
+// TX audio from the clients. It is never destroyed since
+// the TX thread may access it at any time.
+//
+static JITTER_BUFFER *tci_tx_buffer = NULL;
+static volatile gint tci_tx_owner = -1;  // client (seq) whose TX audio is used, -1: none
+
 static gpointer tci_server(gpointer data);
 static gpointer tci_listener(gpointer data);
+static gpointer tci_writer(gpointer data);
 
 //
 // Launch TCI system. Called upon program start if TCI is
@@ -101,6 +154,22 @@ static gpointer tci_listener(gpointer data);
 void launch_tci () {
   t_print( "---- LAUNCHING TCI SERVER ----\n");
   tci_running = 1;
+
+  if (tci_tx_buffer == NULL) {
+    tci_tx_buffer = jitter_buffer_new(TCI_CHRONO, 64);
+
+    for (int id = 0; id < MAX_TCI_CLIENTS; id++) {
+      CLIENT *client = &tci_client[id];
+      command_queue_init(&client->text, TCI_QUEUE_SIZE, 0, NULL);
+      command_queue_init(&client->chrono, TCI_QUEUE_SIZE, 0, NULL);
+      command_queue_init(&client->spectrum, TCI_QUEUE_SIZE, 0, NULL);
+
+      for (int v = 0; v < 2; v++) {
+        command_queue_init(&client->stream[v].queue, TCI_QUEUE_SIZE, 0, NULL);
+      }
+    }
+  }
+
   //
   // Start TCI server
   //
@@ -122,6 +191,7 @@ static void force_close(CLIENT *client) {
     // No error checking since the socket may have been close in a race condition
     // in the listener
     SETSOCKOPT(client->fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    shutdown(client->fd, SHUT_RDWR);
     close(client->fd);
     client->fd = -1;
   }
@@ -130,6 +200,11 @@ static void force_close(CLIENT *client) {
     g_source_remove(client->tci_timer);
     client->tci_timer = 0;
   }
+
+  if (client->notify_id != 0) {
+    notify_unsubscribe(client->notify_id);
+    client->notify_id = 0;
+  }
 }
 
 //
@@ -177,16 +252,35 @@ void shutdown_tci() {
 }
 
 //
-// send_frame is intended to  be called  through the GTK idle queue
+// Discard the frames in a queue. Only to be called if
+// the producer is known to be idle.
+//
+static void tci_queue_clear(COMMAND_QUEUE *q) {
+  TCI_FRAME *frame;
+
+  while ((frame = command_queue_pop(q)) != NULL) {
+    g_free(frame);
+  }
+}
+
+//
+// Wake up the sending thread if it is waiting for frames
+//
+static void tci_wakeup(CLIENT *client) {
+  if (g_atomic_int_get(&client->sleeping)) {
+    g_mutex_lock(&client->wakeup_mutex);
+    g_cond_signal(&client->wakeup_cond);
+    g_mutex_unlock(&client->wakeup_mutex);
+  }
+}
+
+//
+// send_frame is intended to  be called  through the GTK idle queue.
+// It encodes the frame and hands it over to the sending thread.
 //
 static int tci_send_frame(void *data) {
   RESPONSE *response = (RESPONSE *) data;
   CLIENT *client = response->client;
-  int type = response->type;
-  const char *msg = response->msg;
-  unsigned char frame[1024];
-  unsigned char *p;
-  int start;
 
   //
   // This means client has already been closed
@@ -196,56 +290,100 @@ static int tci_send_frame(void *data) {
     return G_SOURCE_REMOVE;
   }
 
-  size_t length = strlen(msg);
-  frame[0] = 128 | type;
+  TCI_FRAME *frame = tci_frame_new(response->type, NULL, 0, response->msg, strlen(response->msg));
 
-  if (length <= 125) {
-    frame[1] = length;
-    start = 2;
+  if (command_queue_push(&client->text, frame)) {
+    tci_wakeup(client);
   } else {
-    frame[1] = 126;
-    frame[2] = (length >> 8) & 255;
-    frame[3] = length & 255;
-    start = 4;
+    //
+    // The client does not read its data
+    //
+    g_free(frame);
+    client->running = 0;
   }
 
-  for (size_t i = 0; i < length; i++) {
-    frame[start + i] = msg[i];
-  }
+  g_free(data);
+  return G_SOURCE_REMOVE;
+}
 
-  length = length + start;
+//
+// Write a frame, possibly in several chunks.
+//
+static int tci_write(CLIENT *client, const TCI_FRAME *frame) {
+  const uint8_t *p = frame->data;
+  size_t length = frame->len;
   int count = 0;
-  p = frame;
 
-  //
-  // Write data, possibly in several chunks. If it fails,
-  // mark the client as "not running"
-  //
   while (length > 0) {
     int rc = write(client->fd, p, length);
 
-    if (rc < 0) {
-      g_free(data);
-      client->running = 0;
-      return G_SOURCE_REMOVE;
+    if (rc < 0) { return -1; }
+
+    if (rc == 0 && ++count > 10) { return -1; }
+
+    length -= rc;
+    p += rc;
+  }
+
+  return 0;
+}
+
+//
+// The sending thread of a client. Text frames go first, IQ and audio
+// frames of the two receivers and spectrum frames are sent alternately.
+// If writing fails, mark the client as "not running".
+//
+static gpointer tci_writer(gpointer data) {
+  CLIENT *client = (CLIENT *)data;
+  TCI_FRAME *frame;
+
+  while (client->running) {
+    int idle = 1;
+
+    while (client->running && (frame = command_queue_pop(&client->text)) != NULL) {
+      if (tci_write(client, frame) < 0) { client->running = 0; }
+
+      g_free(frame);
+      idle = 0;
     }
 
-    if (rc == 0) {
-      count++;
+    if (client->running && (frame = command_queue_pop(&client->chrono)) != NULL) {
+      if (tci_write(client, frame) < 0) { client->running = 0; }
 
-      if (count > 10) {
-        g_free(data);
-        client->running = 0;
-        return G_SOURCE_REMOVE;
+      g_free(frame);
+      idle = 0;
+    }
+
+    for (int v = 0; v < 2 && client->running; v++) {
+      if ((frame = command_queue_pop(&client->stream[v].queue)) != NULL) {
+        if (tci_write(client, frame) < 0) { client->running = 0; }
+
+        g_free(frame);
+        idle = 0;
       }
     }
 
-    length -= rc;
-    p += rc;
+    if (client->running && (frame = command_queue_pop(&client->spectrum)) != NULL) {
+      if (tci_write(client, frame) < 0) { client->running = 0; }
+
+      g_free(frame);
+      idle = 0;
+    }
+
+    if (idle) {
+      //
+      // The time-out takes care of a wakeup that comes
+      // just before we fall asleep
+      //
+      g_mutex_lock(&client->wakeup_mutex);
+      g_atomic_int_set(&client->sleeping, 1);
+      g_cond_wait_until(&client->wakeup_cond, &client->wakeup_mutex, g_get_monotonic_time() + 10000);
+      g_atomic_int_set(&client->sleeping, 0);
+      g_mutex_unlock(&client->wakeup_mutex);
+    }
   }
 
-  g_free(data);
-  return G_SOURCE_REMOVE;
+  return NULL;
 }
 
 static void tci_send_text(CLIENT *client, char *msg) {
@@ -415,6 +553,21 @@ static void tci_send_cwspeed(CLIENT *client) {
   tci_send_text(client, msg);
 }
 
+//
+// CW text is sent through the CAT CW machinery (see rigctl.c),
+// this must be done in the GTK thread.
+//
+static int tci_cw_macros(gpointer data) {
+  char *text = (char *) data;
+  char *cp;
+
+  if ((cp = strchr(text, ';')) != NULL) { *cp = 0; }
+
+  rigctl_send_cw_text(text);
+  g_free(text);
+  return G_SOURCE_REMOVE;
+}
+
 static void tci_send_smeter(CLIENT *client, int v) {
   //
   // UNDOCUMENTED in the TCI protocol, but MLDX sends this
@@ -490,9 +643,389 @@ static void tci_send_pong(CLIENT *client) {
   g_idle_add(tci_send_frame, resp);
 }
 
+//
+// IQ and RX audio streams. The sample rate requested by the client is
+// reached by decimating by a power of two, the rate actually used is
+// reported in the stream header.
+//
+// The streams are recounted whenever one is switched on or off. This is
+// done by the listener threads of all clients, the mutex makes sure the
+// count stored last has seen all changes made before.
+//
+static GMutex tci_stream_mutex;
+
+static void tci_update_streaming() {
+  int n = 0;
+  int s = 0;
+  g_mutex_lock(&tci_stream_mutex);
+
+  for (int id = 0; id < MAX_TCI_CLIENTS; id++) {
+    for (int v = 0; v < 2; v++) {
+      if (g_atomic_int_get(&tci_client[id].iq_on[v])) { n++; }
+
+      if (g_atomic_int_get(&tci_client[id].audio_on[v])) { n++; }
+
+      if (g_atomic_int_get(&tci_client[id].spectrum_on[v])) { s++; }
+    }
+  }
+
+  tci_streaming = n;
+  tci_spectrum = s;
+  g_mutex_unlock(&tci_stream_mutex);
+}
+
+static void tci_set_stream(CLIENT *client, volatile gint *on, const char *cmd, const char *arg, int enable) {
+  char msg[MAXMSGSIZE];
+  int v = (*arg == '1') ? 1 : 0;
+  g_atomic_int_set(&on[v], enable);
+  tci_update_streaming();
+  snprintf(msg, sizeof(msg), "%s:%d;", cmd, v);
+  tci_send_text(client, msg);
+}
+
+//
+// The IQ rate is obtained from the sample rate of the receiver by
+// decimating with a power of two. A requested rate is only accepted
+// if it can be reached exactly for all receivers.
+//
+static int tci_iq_rate_ok(int rate) {
+  if (rate <= 0) { return 0; }
+
+  for (int v = 0; v < receivers && v < 2; v++) {
+    int sample_rate = receiver[v]->sample_rate;
+
+    if (rate > sample_rate || sample_rate % rate != 0) { return 0; }
+
+    int ratio = sample_rate / rate;
+
+    if (ratio & (ratio - 1)) { return 0; }
+  }
+
+  return 1;
+}
+
+//
+// The IQ rate actually used (as in tci_rx_iq) if the receiver runs at "sample_rate"
+//
+static int tci_iq_rate_used(int sample_rate, int iq_rate) {
+  int factor = sample_rate / iq_rate;
+
+  while (factor > 1) {
+    sample_rate >>= 1;
+    factor >>= 1;
+  }
+
+  return sample_rate;
+}
+
+static void tci_send_iq_rate(CLIENT *client) {
+  char msg[MAXMSGSIZE];
+  int rate = client->iq_rate;
+
+  if (receivers > 0) { rate = tci_iq_rate_used(receiver[0]->sample_rate, rate); }
+
+  snprintf(msg, sizeof(msg), "iq_samplerate:%d;", rate);
+  tci_send_text(client, msg);
+}
+
+static void tci_send_audio_rate(CLIENT *client) {
+  char msg[MAXMSGSIZE];
+  snprintf(msg, sizeof(msg), "audio_samplerate:%d;", client->audio_rate);
+  tci_send_text(client, msg);
+}
+
+static void tci_stream_push(CLIENT *client, int v, int type, int rate, IQ_DECIMATOR *d, const double *in, int n) {
+  double out[2 * TCI_CHUNK];
+  float samples[2 * TCI_CHUNK];
+
+  for (int k = 0; k < n; k += TCI_CHUNK) {
+    int m = iq_decimate(d, in + 2 * k, MIN(TCI_CHUNK, n - k), out);
+
+    if (m == 0) { continue; }
+
+    for (int i = 0; i < 2 * m; i++) {
+      samples[i] = (float) out[i];
+    }
+
+    TCI_FRAME *frame = tci_stream_frame(v, rate, type, samples, 2 * m);
+
+    if (command_queue_push(&client->stream[v].queue, frame)) {
+      tci_wakeup(client);
+    } else {
+      g_free(frame);
+    }
+  }
+}
+
+//
+// Called from the RX thread with the IQ samples of a receiver
+//
+void tci_rx_iq(int v, int sample_rate, const double *iq, int n) {
+  if (v < 0 || v > 1) { return; }
+
+  for (int id = 0; id < MAX_TCI_CLIENTS; id++) {
+    CLIENT *client = &tci_client[id];
+    RX_STREAM *stream = &client->stream[v];
+
+    if (!client->running || !g_atomic_int_get(&client->iq_on[v])) { continue; }
+
+    int factor = sample_rate / client->iq_rate;
+
+    if (stream->iq_decimator == NULL || stream->iq_factor != factor) {
+      if (stream->iq_decimator != NULL) { iq_decimator_free(stream->iq_decimator); }
+
+      stream->iq_decimator = iq_decimator_new(factor);
+      stream->iq_factor = factor;
+    }
+
+    tci_stream_push(client, v, TCI_IQ_STREAM, sample_rate / iq_decimator_factor(stream->iq_decimator),
+                    stream->iq_decimator, iq, n);
+  }
+}
+
+//
+// Called from the RX thread with the (48 kHz stereo) audio of a receiver
+//
+void tci_rx_audio(int v, const double *audio, int n) {
+  if (v < 0 || v > 1) { return; }
+
+  for (int id = 0; id < MAX_TCI_CLIENTS; id++) {
+    CLIENT *client = &tci_client[id];
+    RX_STREAM *stream = &client->stream[v];
+
+    if (!client->running || !g_atomic_int_get(&client->audio_on[v])) { continue; }
+
+    int factor = 48000 / client->audio_rate;
+
+    if (stream->audio_decimator == NULL || stream->audio_factor != factor) {
+      if (stream->audio_decimator != NULL) { iq_decimator_free(stream->audio_decimator); }
+
+      stream->audio_decimator = iq_decimator_new(factor);
+      stream->audio_factor = factor;
+    }
+
+    tci_stream_push(client, v, TCI_RX_AUDIO_STREAM, 48000 / iq_decimator_factor(stream->audio_decimator),
+                    stream->audio_decimator, audio, n);
+  }
+}
+
+//
+// Spectrum stream (piHPSDR extension): the panadapter data of a receiver
+// reduced to the width requested by the client (merged pixels take the
+// peak value), at (at most) the frame rate requested by the client.
+//
+static void tci_spectrum_start(CLIENT *client, const char *arg, int width, int fps) {
+  char msg[MAXMSGSIZE];
+  int v = (*arg == '1') ? 1 : 0;
+
+  if (width <= 0) { width = 1024; }
+
+  if (width < 16) { width = 16; }
+
+  if (width > SPECTRUM_CODEC_MAX_WIDTH) { width = SPECTRUM_CODEC_MAX_WIDTH; }
+
+  if (fps <= 0) { fps = 10; }
+
+  if (fps > 50) { fps = 50; }
+
+  client->spectrum_width = width;
+  client->spectrum_fps = fps;
+  g_atomic_int_set(&client->spectrum_on[v], 1);
+  tci_update_streaming();
+  snprintf(msg, sizeof(msg), "spectrum_start:%d,%d,%d;", v, width, fps);
+  tci_send_text(client, msg);
+}
+
+//
+// Called from the GTK thread (with the display mutex locked) whenever
+// the analyzer of a receiver has delivered a new frame. This is the frame
+// the panadapter shows, so no additional FFT is done. The reduction and
+// quantization is done once for each width requested, and clients
+// asking for the same width get copies of the same frame.
+//
+void tci_rx_spectrum(int v) {
+  TCI_FRAME *frames[MAX_TCI_CLIENTS];
+  int widths[MAX_TCI_CLIENTS];
+  int nframes = 0;
+  gint64 now = g_get_monotonic_time();
+
+  if (v < 0 || v > 1 || v >= receivers) { return; }
+
+  const RECEIVER *rx = receiver[v];
+
+  if (rx->pixel_samples == NULL || rx->width <= 0) { return; }
+
+  //
+  // Frequency of the first pixel, and calibration, as in rx_panadapter
+  //
+  int f = (diversity_enabled && v == 1) ? 0 : v;  // in diversity mode, RX2 tracks RX1
+  long long frequency = vfo[f].frequency;
+  int mode = vfo[f].mode;
+
+  if (mode == modeCWU) {
+    frequency -= cw_keyer_sidetone_frequency;
+  } else if (mode == modeCWL) {
+    frequency += cw_keyer_sidetone_frequency;
+  }
+
+  long long low_freq = frequency - rx->sample_rate / 2 + (long long)((double)rx->pan * rx->hz_per_pixel);
+  int span = (int)((double)rx->width * rx->hz_per_pixel);
+  const BAND *band = band_get_band(vfo[v].band);
+  double soffset = (double)(rx_gain_calibration - band->gain) + (double)adc[rx->adc].attenuation - adc[rx->adc].gain;
+
+  if (filter_board == ALEX && rx->adc == 0) {
+    soffset += (double)(10 * rx->alex_attenuation - 20 * rx->preamp);
+  }
+
+  if (filter_board == CHARLY25 && rx->adc == 0) {
+    soffset += (double)(12 * rx->alex_attenuation - 18 * rx->preamp - 18 * rx->dither);
+  }
+
+  int low = TCI_SPECTRUM_DB - (int) soffset;
+
+  for (int id = 0; id < MAX_TCI_CLIENTS; id++) {
+    CLIENT *client = &tci_client[id];
+    TCI_FRAME *frame = NULL;
+
+    if (!client->running || !g_atomic_int_get(&client->spectrum_on[v])) { continue; }
+
+    // Called per panadapter update, take one if 3/4 of the client's frame interval has passed
+    if (now - client->spectrum_last[v] < 750000 / client->spectrum_fps) { continue; }
+
+    client->spectrum_last[v] = now;
+    int width = MIN(client->spectrum_width, rx->width);
+
+    for (int i = 0; i < nframes; i++) {
+      if (widths[i] == width) { frame = frames[i]; }
+    }
+
+    if (frame == NULL) {
+      uint8_t pixels[SPECTRUM_CODEC_MAX_WIDTH];
+      int n = spectrum_quantize(rx->pixel_samples + rx->pan, rx->width, width, low, low + 255, pixels);
+      frame = tci_spectrum_frame(v, low_freq, span, TCI_SPECTRUM_DB, pixels, n);
+      frames[nframes] = frame;
+      widths[nframes] = width;
+      nframes++;
+    }
+
+    TCI_FRAME *copy = g_malloc(sizeof(TCI_FRAME) + frame->len);
+    memcpy(copy, frame, sizeof(TCI_FRAME) + frame->len);
+
+    if (command_queue_push(&client->spectrum, copy)) {
+      tci_wakeup(client);
+    } else {
+      g_free(copy);
+    }
+  }
+
+  for (int i = 0; i < nframes; i++) {
+    g_free(frames[i]);
+  }
+}
+
+//
+// TX audio (digital modes). While transmitting, the client providing
+// TX audio gets a TX_CHRONO frame for each TCI_CHRONO samples consumed
+// by the TX thread, and answers with that many samples of TX audio.
+// So the client is clocked by the radio, the remaining clock difference
+// is handled by the jitter buffer (rmatch).
+//
+// TX audio is only taken from one client. This is the client that
+// has sent "trx:x,true" last or, if there is none, the first that sends
+// TX audio. Until then, all clients that have started the audio stream
+// get TX_CHRONO frames. At the end of a transmission, any client may
+// take over for the next one.
+//
+// Called from the TX thread for each microphone sample.
+//
+void tci_tx_audio(double *sample) {
+  static int count = 0;
+  static int was_transmitting = 0;
+  static int underflows = 0;
+  double left, right;
+  int transmitting = radio_is_transmitting();
+
+  if (++count >= TCI_CHRONO) {
+    count = 0;
+
+    int owner = g_atomic_int_get(&tci_tx_owner);
+
+    for (int id = 0; id < MAX_TCI_CLIENTS && transmitting; id++) {
+      CLIENT *client = &tci_client[id];
+
+      if (!client->running || !g_atomic_int_get(&client->audio_on[0])) { continue; }
+
+      if (owner >= 0 && owner != client->seq) { continue; }
+
+      TCI_FRAME *frame = tci_stream_frame(0, client->audio_rate, TCI_TX_CHRONO, NULL,
+                                          2 * TCI_CHRONO * client->audio_rate / 48000);
+
+      if (command_queue_push(&client->chrono, frame)) {
+        tci_wakeup(client);
+      } else {
+        g_free(frame);
+      }
+    }
+  }
+
+  if (was_transmitting && !transmitting) {
+    g_atomic_int_set(&tci_tx_owner, -1);
+
+    if (tci_tx_buffer->underflows != underflows) {
+      t_print("%s: %d TX audio underflows\n", __FUNCTION__, tci_tx_buffer->underflows - underflows);
+      underflows = tci_tx_buffer->underflows;
+    }
+  }
+
+  was_transmitting = transmitting;
+
+  if (jitter_buffer_get(tci_tx_buffer, &left, &right)) {
+    *sample = left;
+  }
+}
+
+//
+// A binary frame from a client. The samples of a TX audio stream are
+// converted right from the input buffer into the rmatch input of the
+// jitter buffer, if the client provides the TX audio.
+//
+static void tci_tx_stream(CLIENT *client, unsigned char *payload, int length) {
+  uint32_t head[TCI_STREAM_HEADER / 4];
+
+  if (length < TCI_STREAM_HEADER) { return; }
+
+  memcpy(head, payload, TCI_STREAM_HEADER);
+  int rate = GUINT32_FROM_LE(head[1]);
+  int format = GUINT32_FROM_LE(head[2]);
+  int count = GUINT32_FROM_LE(head[5]);
+  int type = GUINT32_FROM_LE(head[6]);
+  int channels = GUINT32_FROM_LE(head[7]);
+
+  if (type != TCI_TX_AUDIO_STREAM) { return; }
+
+  if (!g_atomic_int_compare_and_exchange(&tci_tx_owner, -1, client->seq) &&
+      g_atomic_int_get(&tci_tx_owner) != client->seq) { return; }
+
+  if (format != TCI_FLOAT32 || channels < 1 || channels > 2 || rate < 8000 || rate > 48000) {
+    t_print("%s: unsupported TX audio format=%d channels=%d rate=%d\n", __FUNCTION__, format, channels, rate);
+    return;
+  }
+
+  length -= TCI_STREAM_HEADER;
+  payload += TCI_STREAM_HEADER;
+
+  if (count > length / 4) { count = length / 4; }
+
+  if (count >= channels) {
+    jitter_buffer_put_float(tci_tx_buffer, payload, count / channels, channels, rate);
+  }
+}
+
 static gboolean tci_reporter(gpointer data) {
   //
-  // This function is called repeatedly as long as the client  runs
+  // This function is called repeatedly as long as the client  runs.
+  // It sends PINGs and S-meter readings, state changes are reported
+  // by tci_notify().
   //
   CLIENT *client = (CLIENT *) data;
 
@@ -505,6 +1038,27 @@ static gboolean tci_reporter(gpointer data) {
     tci_send_ping(client);
   }
 
+  //
+  // If S-meter reading is requested, send info each time
+  //
+  if (!tci_txonly && client->rxsensor && (client->count & 1)) {
+    tci_send_rx(client, 0);
+    tci_send_rx(client, 1);
+  }
+
+  return TRUE;
+}
+
+//
+// Called (in the GTK thread) upon state changes
+//
+static void tci_notify(int changes, gpointer data) {
+  CLIENT *client = (CLIENT *) data;
+
+  if (!client->running) {
+    return;
+  }
+
   //
   // Determine TX frequency  and  report  if changed
   //
@@ -515,14 +1069,6 @@ static gboolean tci_reporter(gpointer data) {
   }
 
   if (!tci_txonly) {
-    //
-    // If S-meter reading is requested, send info each time
-    //
-    if (client->rxsensor && (client->count & 1)) {
-      tci_send_rx(client, 0);
-      tci_send_rx(client, 1);
-    }
-
     //
     // Determine VFO-A/B frequency/mode, report if changed
     //
@@ -559,8 +1105,6 @@ static gboolean tci_reporter(gpointer data) {
       tci_send_mox(client);
     }
   }
-
-  return TRUE;
 }
 
 //
@@ -606,6 +1150,9 @@ static gpointer tci_server(gpointer data) {
 
   for (int id = 0; id < MAX_TCI_CLIENTS; id++) {
     tci_client[id].fd = -1;
+    tci_client[id].in_use = 0;
+    g_mutex_init(&tci_client[id].wakeup_mutex);
+    g_cond_init(&tci_client[id].wakeup_cond);
   }
 
   // listen with a max queue of 3
@@ -630,7 +1177,7 @@ static gpointer tci_server(gpointer data) {
     spare = -1;
 
     for (int id = 0; id < MAX_TCI_CLIENTS; id++) {
-      if (tci_client[id].fd == -1) {
+      if (!g_atomic_int_get(&tci_client[id].in_use)) {
         spare = id;
         break;
       }
@@ -733,6 +1280,7 @@ static gpointer tci_server(gpointer data) {
     // spawn off thread that "listens" to the connection,
     // start periodic job that reports frequency/mode changes
     //
+    g_atomic_int_set(&tci_client[spare].in_use, 1);
     tci_client[spare].fd              = fd;
     tci_client[spare].running         = 1;
     tci_client[spare].seq             = spare;
@@ -743,6 +1291,27 @@ static gpointer tci_server(gpointer data) {
     tci_client[spare].last_mb         = -1;
     tci_client[spare].count           =  0;
     tci_client[spare].rxsensor        =  0;
+    tci_client[spare].notify_id       =  0;
+    tci_client[spare].iq_rate         = 48000;
+    tci_client[spare].audio_rate      = 48000;
+    tci_client[spare].sleeping        =  0;
+
+    //
+    // Frames left over from the previous connection in this slot
+    //
+    tci_queue_clear(&tci_client[spare].text);
+    tci_queue_clear(&tci_client[spare].chrono);
+    tci_queue_clear(&tci_client[spare].spectrum);
+
+    for (int v = 0; v < 2; v++) {
+      tci_client[spare].iq_on[v]      =  0;
+      tci_client[spare].audio_on[v]   =  0;
+      tci_client[spare].spectrum_on[v] =  0;
+      tci_client[spare].spectrum_last[v] = 0;
+      tci_queue_clear(&tci_client[spare].stream[v].queue);
+    }
+
+    tci_client[spare].writer_id       = g_thread_new("TCI writer", tci_writer, (gpointer)&tci_client[spare]);
     tci_client[spare].thread_id       = g_thread_new("TCI listener", tci_listener, (gpointer)&tci_client[spare]);
     tci_client[spare].tci_timer       = g_timeout_add(500, tci_reporter, &tci_client[spare]);
   }
@@ -751,29 +1320,43 @@ static gpointer tci_server(gpointer data) {
   return NULL;
 }
 
-static int digest_frame(const unsigned char *buff, char *msg,  int offset, int *type) {
+static int digest_frame(unsigned char *buff, int offset, int *type, unsigned char **payload, int *length) {
   //
   // If the buffer contains enough data for a complete frame,
-  // produce the payload in "msg" and return the number of
+  // de-mask the payload in place, return its start in "payload"
+  // and its length in "length", and return the number of
   // frame bytes consumed.
   // If there is not enough data, leave input data untouched
-  // and return zero.
+  // and return zero. If the frame cannot fit into the input
+  // buffer, return -1.
   // For a valid frame, return frame type in "type".
   //
   int head = 2;   // number  of bytes preceeding the payload
-  int mask = (buff[1] & 0x80);
-  int len = (buff[1] & 0x7F);
+  long long len;
   int mstrt = 0;
 
-  if (len == 127) {
-    // Do not even try
-    t_print("%s: excessive length\n", __FUNCTION__);
+  if (offset < 2) {
     return 0;
   }
 
+  int mask = (buff[1] & 0x80);
+  len = (buff[1] & 0x7F);
+
   if (len == 126) {
-    len = buff[2] + (buff[3] << 8);
+    if (offset < 4) { return 0; }
+
+    len = (buff[2] << 8) + buff[3];
     head = 4;
+  } else if (len == 127) {
+    if (offset < 10) { return 0; }
+
+    len = 0;
+
+    for (int i = 2; i < 10; i++) {
+      len = (len << 8) + buff[i];
+    }
+
+    head = 10;
   }
 
   if (mask) {
@@ -781,24 +1364,28 @@ static int digest_frame(const unsigned char *buff, char *msg,  int offset, int *
     head += 4;
   }
 
+  if (len < 0 || head + len > TCI_INPUT_SIZE) {
+    t_print("%s: excessive length\n", __FUNCTION__);
+    return -1;
+  }
+
   if (head + len > offset) {
     return 0;
   }
 
   //
-  // There is enough data. Copy/DeMask  it.
+  // There is enough data. DeMask it.
   //
   *type = buff[0] & 0x0F;
 
-  for (int i = 0; i < len;  i++) {
-    if (mask) {
-      msg[i] = buff[head + i] ^ buff[mstrt + (i & 3)];
-    } else {
-      msg[i] = buff[head + i];
+  if (mask) {
+    for (int i = 0; i < len;  i++) {
+      buff[head + i] ^= buff[mstrt + (i & 3)];
     }
   }
 
-  msg[len] = 0;   // form null-terminated  string
+  *payload = buff + head;
+  *length = len;
   //
   // Return the number of bytes *digested*, not the number of  bytes produced.
   //
@@ -807,14 +1394,14 @@ static int digest_frame(const unsigned char *buff, char *msg,  int offset, int *
 
 //
 // TCI "Listener". It starts with sending  initialisation data, and then
-// listens for incoming commands (and ignores all of them!).
-// It only responds to incoming PING and CLOSE packets.
+// listens for incoming commands. Binary frames carry TX audio
+// and are fed to the jitter buffer.
 //
 static gpointer tci_listener(gpointer data) {
   CLIENT *client = (CLIENT *)data;
   t_print("%s: starting client: socket=%d\n", __FUNCTION__, client->fd);
   int offset = 0;
-  unsigned char buff [MAXDATASIZE];
+  unsigned char *buff = g_malloc(TCI_INPUT_SIZE);
   char msg [MAXDATASIZE];
   const int ARGLEN = 16;
   int argc;
@@ -831,7 +1418,7 @@ static gpointer tci_listener(gpointer data) {
   // With transverters etc. the upper frequency can be
   // very large. For the time being we go up to the 70cm band
   // No need to send vfo and modulation  commands, since this is
-  // automatically  done in the tci_reporter task.
+  // automatically  done by tci_notify().
   //
   tci_send_text(client, "vfo_limits:0,450000000;");
   tci_send_text(client, "if_limits:-96000,96000;");
@@ -859,23 +1446,37 @@ static gpointer tci_listener(gpointer data) {
   tci_send_text(client, "tune:0,false;");
   tci_send_text(client, "tune:1,false;");
   tci_send_text(client, "mute:false;");
+  tci_send_iq_rate(client);
+  tci_send_audio_rate(client);
+  tci_send_text(client, "audio_stream_sample_type:float32;");
+  tci_send_text(client, "audio_stream_channels:2;");
   tci_send_text(client, "start;");
   tci_send_text(client, "ready;");
+  //
+  // From now on, report state changes. Since the subscriber is
+  // called from the GTK queue, this comes after the initial data.
+  // Trigger a report in case something has changed meanwhile.
+  //
+  client->notify_id = notify_subscribe(NOTIFY_VFO | NOTIFY_MODE | NOTIFY_SPLIT | NOTIFY_MOX,
+                                       tci_notify, client);
+  notify_changed(NOTIFY_ALL);
 
   while (client->running) {
     int numbytes;
     int type;
+    int length;
+    unsigned char *payload;
 
     //
     // This can happen when a very long command has arrived...
     // ...just give up
     //
-    if (offset >= MAXDATASIZE) {
+    if (offset >= TCI_INPUT_SIZE) {
       client->running = 0;
       break;
     }
 
-    numbytes = recv(client->fd, buff + offset, MAXDATASIZE - offset, 0);
+    numbytes = recv(client->fd, buff + offset, TCI_INPUT_SIZE - offset, 0);
 
     if (numbytes <= 0) {
       usleep(100000);
@@ -887,9 +1488,17 @@ static gpointer tci_listener(gpointer data) {
     //
     // The chunk just read may contain more than one frame
     //
-    while ((numbytes =  digest_frame(buff, msg, offset, &type)) > 0) {
+    while ((numbytes =  digest_frame(buff, offset, &type, &payload, &length)) > 0) {
       switch (type) {
       case opTEXT:
+        //
+        // Commands are short, just truncate excessive ones
+        //
+        if (length >= MAXDATASIZE) { length = MAXDATASIZE - 1; }
+
+        memcpy(msg, payload, length);
+        msg[length] = 0;
+
         for (size_t i = 0; i < strlen(msg); i++) {
           msg[i] = tolower(msg[i]);
         }
@@ -906,10 +1515,20 @@ static gpointer tci_listener(gpointer data) {
         // --------------------------------------------------------------------------
         // trx_count               tci_send_trx_count()
         // trx                     tci_send_mox()          do not change mox
+        // trx:x,true;             tci_send_mox()          do not change mox, take over TX audio
         // rx_sensors_enable:x,y;  enable:=arg1            sending interval always 1 second, ignore y
         // modulation:x;           tci_send_mode(arg1)     do not change mode, ignore y
         // vfo:x,y;                tci_send_vfo(x,y)       do not change frequency
         // rx_smeter,x,y;          tci_send_smeter(x)      undocumented, ignore y
+        // iq_samplerate:x;        tci_send_iq_rate()      48000, 96000, 192000, 384000, not above RX rate
+        // audio_samplerate:x;     tci_send_audio_rate()   12000, 24000, 48000
+        // iq_start:x;             iq_start:x;             start IQ stream of RX x
+        // iq_stop:x;              iq_stop:x;
+        // audio_start:x;          audio_start:x;          start audio stream of RX x
+        // audio_stop:x;           audio_stop:x;
+        // cw_macros:x,text;       (none)                  send text in CW, ignore x
+        // spectrum_start:x,w,f;   spectrum_start:x,w,f;   (extension) spectrum of RX x, w pixels, f fps
+        // spectrum_stop:x;        spectrum_stop:x;
         //
         // While it was originally decided NOT to respond to any incoming TCI command, there
         // are logbook program which seem to require that. Note that additional arguments are
@@ -944,6 +1563,8 @@ static gpointer tci_listener(gpointer data) {
         if (!strcmp(arg[0], "trx_count")) {
           tci_send_trx_count(client);
         } else if (!strcmp(arg[0], "trx")) {
+          if (argc > 2 && !strcmp(arg[2], "true")) { g_atomic_int_set(&tci_tx_owner, client->seq); }
+
           tci_send_mox(client);
         } else if (!strcmp(arg[0], "rx_sensors_enable") && argc > 1) {
           // MLDX originally sent '1/0' instead of 'true/false'
@@ -956,10 +1577,55 @@ static gpointer tci_listener(gpointer data) {
           tci_send_smeter(client, (*arg[1] == '1') ? 1 : 0);
         } else if (!strcmp(arg[0], "cw_macros_speed")) {
           tci_send_cwspeed(client);
+        } else if (!strcmp(arg[0], "cw_macros") && argc > 2) {
+          //
+          // Commas in the text have been taken as argument separators
+          //
+          for (int i = 3; i < argc; i++) {
+            arg[i][-1] = ',';
+          }
+
+          g_idle_add(tci_cw_macros, g_strdup(arg[2]));
+        } else if (!strcmp(arg[0], "iq_samplerate")) {
+          int rate = argc > 1 ? atoi(arg[1]) : 0;
+
+          if ((rate == 48000 || rate == 96000 || rate == 192000 || rate == 384000) && tci_iq_rate_ok(rate)) {
+            client->iq_rate = rate;
+          }
+
+          tci_send_iq_rate(client);
+        } else if (!strcmp(arg[0], "audio_samplerate")) {
+          int rate = argc > 1 ? atoi(arg[1]) : 0;
+
+          if (rate == 12000 || rate == 24000 || rate == 48000) { client->audio_rate = rate; }
+
+          tci_send_audio_rate(client);
+        } else if (!strcmp(arg[0], "iq_start") && argc > 1) {
+          tci_set_stream(client, client->iq_on, "iq_start", arg[1], 1);
+        } else if (!strcmp(arg[0], "iq_stop") && argc > 1) {
+          tci_set_stream(client, client->iq_on, "iq_stop", arg[1], 0);
+        } else if (!strcmp(arg[0], "audio_start") && argc > 1) {
+          tci_set_stream(client, client->audio_on, "audio_start", arg[1], 1);
+        } else if (!strcmp(arg[0], "audio_stop") && argc > 1) {
+          tci_set_stream(client, client->audio_on, "audio_stop", arg[1], 0);
+
+          if (*arg[1] != '1') { g_atomic_int_compare_and_exchange(&tci_tx_owner, client->seq, -1); }
+        } else if (!strcmp(arg[0], "spectrum_start") && argc > 1) {
+          tci_spectrum_start(client, arg[1], argc > 2 ? atoi(arg[2]) : 0, argc > 3 ? atoi(arg[3]) : 0);
+        } else if (!strcmp(arg[0], "spectrum_stop") && argc > 1) {
+          tci_set_stream(client, client->spectrum_on, "spectrum_stop", arg[1], 0);
+        } else if (!strcmp(arg[0], "audio_stream_sample_type")) {
+          tci_send_text(client, "audio_stream_sample_type:float32;");
+        } else if (!strcmp(arg[0], "audio_stream_channels")) {
+          tci_send_text(client, "audio_stream_channels:2;");
         }
 
         break;
 
+      case opBIN:
+        tci_tx_stream(client, payload, length);
+        break;
+
       case opPING:
         if (rigctl_debug) { t_print("TCI%d PING rcvd\n", client->seq); }
 
@@ -980,16 +1646,47 @@ static gpointer tci_listener(gpointer data) {
       offset  -= numbytes;
 
       if (offset > 0) {
-        for (int i = 0; i < offset; i++) {
-          buff[i] = buff[i + numbytes];
-        }
+        memmove(buff, buff + numbytes, offset);
       }
     }
+
+    if (numbytes < 0) {
+      client->running = 0;
+    }
+  }
+
+  g_free(buff);
+
+  for (int v = 0; v < 2; v++) {
+    g_atomic_int_set(&client->iq_on[v], 0);
+    g_atomic_int_set(&client->audio_on[v], 0);
+    g_atomic_int_set(&client->spectrum_on[v], 0);
   }
 
+  g_atomic_int_compare_and_exchange(&tci_tx_owner, client->seq, -1);
+  tci_update_streaming();
   tci_send_text(client, "stop;");
   tci_send_close(client);
+
+  //
+  // Stop the sending thread (shutdown() wakes it up if it hangs
+  // in write()) and join with it before the socket is closed. The
+  // slot is released only then, so that a new connection cannot
+  // get it while the old sending thread still uses its queues.
+  //
+  client->running = 0;
+
+  if (client->fd != -1) { shutdown(client->fd, SHUT_RDWR); }
+
+  tci_wakeup(client);
+
+  if (client->writer_id) {
+    g_thread_join(client->writer_id);
+    client->writer_id = NULL;
+  }
+
   force_close(client);
+  g_atomic_int_set(&client->in_use, 0);
   t_print("%s: leaving thread\n", __FUNCTION__);
   return NULL;
 }
@@ -19,6 +19,13 @@
 extern int tci_enable;
 extern int tci_port;   // usually 40001
 extern int tci_txonly; // only report TX frequency
+extern int tci_streaming; // IQ or audio streams active
+extern int tci_spectrum;  // spectrum streams active
+
+void tci_rx_iq(int v, int sample_rate, const double *iq, int n);
+void tci_rx_audio(int v, const double *audio, int n);
+void tci_tx_audio(double *sample);
+void tci_rx_spectrum(int v);
 
 void launch_tci(void);
 void shutdown_tci(void);
@@ -0,0 +1,132 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "tci_stream.h"
+
+TCI_FRAME *tci_frame_new(int opcode, const void *head, size_t headlen, const void *data, size_t datalen) {
+  size_t len = headlen + datalen;
+  int fragments = len > 0 ? (len + TCI_FRAGMENT_SIZE - 1) / TCI_FRAGMENT_SIZE : 1;
+  TCI_FRAME *frame = g_malloc(sizeof(TCI_FRAME) + len + 10 * fragments);
+  uint8_t *p = frame->data;
+  size_t pos = 0;
+
+  for (int f = 0; f < fragments; f++) {
+    size_t n = MIN(len - pos, TCI_FRAGMENT_SIZE);
+    //
+    // FIN bit in the last fragment, opcode in the first one
+    //
+    *p++ = (f == fragments - 1 ? 128 : 0) | (f == 0 ? opcode : 0);
+
+    if (n <= 125) {
+      *p++ = n;
+    } else if (n <= 65535) {
+      *p++ = 126;
+      *p++ = (n >> 8) & 255;
+      *p++ = n & 255;
+    } else {
+      *p++ = 127;
+
+      for (int i = 7; i >= 0; i--) {
+        *p++ = ((uint64_t)n >> (8 * i)) & 255;
+      }
+    }
+
+    //
+    // Copy the part of head and data belonging to this fragment
+    //
+    for (size_t end = pos + n; pos < end;) {
+      if (pos < headlen) {
+        size_t k = MIN(end, headlen) - pos;
+        memcpy(p, (const uint8_t *)head + pos, k);
+        p += k;
+        pos += k;
+      } else {
+        size_t k = end - pos;
+        memcpy(p, (const uint8_t *)data + pos - headlen, k);
+        p += k;
+        pos += k;
+      }
+    }
+  }
+
+  frame->len = p - frame->data;
+  return frame;
+}
+
+//
+// The stream header has 16 32-bit little-endian words: receiver,
+// sample rate, format, codec, crc, length (number of values),
+// type, channels, and 8 reserved words. TX_CHRONO frames have
+// no samples (samples == NULL), "count" is the number of values
+// requested from the client.
+//
+TCI_FRAME *tci_stream_frame(int receiver, int sample_rate, int type, const float *samples, int count) {
+  uint32_t head[TCI_STREAM_HEADER / 4];
+  memset(head, 0, sizeof(head));
+  head[0] = GUINT32_TO_LE(receiver);
+  head[1] = GUINT32_TO_LE(sample_rate);
+  head[2] = GUINT32_TO_LE(TCI_FLOAT32);
+  head[5] = GUINT32_TO_LE(count);
+  head[6] = GUINT32_TO_LE(type);
+  head[7] = GUINT32_TO_LE(2);
+
+  if (samples == NULL) {
+    return tci_frame_new(2, head, sizeof(head), NULL, 0);
+  }
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+  return tci_frame_new(2, head, sizeof(head), samples, count * sizeof(float));
+#else
+  uint32_t *le = g_new(uint32_t, count);
+
+  for (int i = 0; i < count; i++) {
+    uint32_t v;
+    memcpy(&v, &samples[i], sizeof(v));
+    le[i] = GUINT32_TO_LE(v);
+  }
+
+  TCI_FRAME *frame = tci_frame_new(2, head, sizeof(head), le, count * sizeof(float));
+  g_free(le);
+  return frame;
+#endif
+}
+
+//
+// Spectrum frames use the stream header with the span (in Hz) in place
+// of the sample rate, one channel, and three of the reserved words:
+// the frequency of the first pixel (low and high 32 bits), and the
+// level (in dBm) of pixel value zero as a signed number.
+//
+TCI_FRAME *tci_spectrum_frame(int receiver, long long low_freq, int span, int db_low,
+                              const uint8_t *pixels, int width) {
+  uint32_t head[TCI_STREAM_HEADER / 4];
+  memset(head, 0, sizeof(head));
+  head[0] = GUINT32_TO_LE(receiver);
+  head[1] = GUINT32_TO_LE(span);
+  head[2] = GUINT32_TO_LE(TCI_UINT8);
+  head[5] = GUINT32_TO_LE(width);
+  head[6] = GUINT32_TO_LE(TCI_SPECTRUM_STREAM);
+  head[7] = GUINT32_TO_LE(1);
+  head[8] = GUINT32_TO_LE((uint32_t)(low_freq & 0xFFFFFFFF));
+  head[9] = GUINT32_TO_LE((uint32_t)(low_freq >> 32));
+  head[10] = GUINT32_TO_LE((uint32_t) db_low);
+  return tci_frame_new(2, head, sizeof(head), pixels, width);
+}
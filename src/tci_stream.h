@@ -0,0 +1,82 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _TCI_STREAM_H_
+#define _TCI_STREAM_H_
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+//
+// WebSocket frames for the TCI server, and the binary TCI streams.
+//
+// Frames are encoded by the thread producing the data (text frames in
+// the GTK thread, IQ and audio streams in the RX thread of the receiver)
+// and handed over to the writer thread of the client through lock-free
+// single-producer/single-consumer queues (COMMAND_QUEUE without a
+// handler, see command_queue.h). If a client cannot keep up,
+// its queues fill up and further stream frames are dropped, such that
+// the RX thread never waits for the network.
+//
+#define TCI_FRAGMENT_SIZE   32768   // larger payloads are sent in several frames
+#define TCI_QUEUE_SIZE      64      // a power of two
+#define TCI_STREAM_HEADER   64      // bytes preceeding the samples of a stream
+
+//
+// Stream types and sample formats (TCI protocol 1.8)
+//
+enum _tci_stream_type_enum {
+  TCI_IQ_STREAM = 0,
+  TCI_RX_AUDIO_STREAM,
+  TCI_TX_AUDIO_STREAM,
+  TCI_TX_CHRONO,
+  TCI_LINEOUT_STREAM,
+  TCI_SPECTRUM_STREAM = 100     // piHPSDR extension, not part of the TCI protocol
+};
+
+enum _tci_sample_type_enum {
+  TCI_INT16 = 0,
+  TCI_INT24,
+  TCI_INT32,
+  TCI_FLOAT32,
+  TCI_UINT8 = 100               // piHPSDR extension (spectrum stream)
+};
+
+typedef struct _tci_frame {
+  size_t len;
+  uint8_t data[];
+} TCI_FRAME;
+
+//
+// tci_frame_new() encodes "head" followed by "data" as the payload of a
+// server-to-client (unmasked) WebSocket message, fragmented if needed.
+// tci_stream_frame() does so for a binary stream with "count" float
+// values (two channels, interleaved).
+//
+extern TCI_FRAME *tci_frame_new(int opcode, const void *head, size_t headlen, const void *data, size_t datalen);
+extern TCI_FRAME *tci_stream_frame(int receiver, int sample_rate, int type, const float *samples, int count);
+
+//
+// tci_spectrum_frame() encodes a panadapter frame of "width" pixels
+// (one byte each, 1 dB per step, 0 corresponds to "db_low" dBm) that
+// covers "span" Hz starting at "low_freq".
+//
+extern TCI_FRAME *tci_spectrum_frame(int receiver, long long low_freq, int span, int db_low,
+                                     const uint8_t *pixels, int width);
+
+#endif
@@ -0,0 +1,198 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+//
+// Cache for rendered text strings.
+//
+// The VFO bar and the meter re-draw all their text fields upon each update,
+// although most of the fields do not change from one update to the next.
+// Converting a string to glyphs and rasterizing them is much more expensive
+// than painting a small pre-rendered alpha mask, so each string is rendered
+// once into an A8 image surface (together with its text extents), and later
+// painted with cairo_mask_surface() using the current source colour. Since
+// the colour is not part of the mask, the same entry serves e.g. both the
+// "active" and "inactive" colour of a VFO dial.
+//
+// The entries live in a small hash table with an LRU replacement within
+// each probe window. All drawing is done from the GTK main thread, so no
+// locking is required.
+//
+// Strings are drawn at the current point rounded to full pixels. If there is
+// no current point, the string is too long, or the user-space transformation
+// is not the identity, the call is passed on to cairo.
+//
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "text_cache.h"
+
+#define TEXT_CACHE_SIZE  512          // number of entries (power of two)
+#define TEXT_CACHE_PROBE 8            // length of the probe window
+#define TEXT_CACHE_LEN   32           // max. length of cached strings including the trailing zero
+
+typedef struct _text_cache_entry {
+  char text[TEXT_CACHE_LEN];
+  cairo_font_face_t *face;            // a reference is held while the entry is in use
+  double size;                        // font size (xx element of the font matrix)
+  double scale;                       // device scale of the target surface
+  cairo_surface_t *mask;              // NULL if only the extents have been computed
+  cairo_text_extents_t extents;
+  int mask_x;                         // mask origin relative to the text origin
+  int mask_y;
+  unsigned int used;                  // "time" of last use (for LRU replacement)
+} TEXT_CACHE_ENTRY;
+
+static TEXT_CACHE_ENTRY cache[TEXT_CACHE_SIZE];
+static unsigned int cache_clock = 0;
+
+static unsigned int text_cache_hash(const char *text, const cairo_font_face_t *face, double size) {
+  // FNV-1a
+  uint32_t h = 2166136261U;
+
+  while (*text) {
+    h ^= (unsigned char) *text++;
+    h *= 16777619U;
+  }
+
+  h ^= (uint32_t)(size * 16.0);
+  h *= 16777619U;
+  h ^= (uint32_t)((uintptr_t) face >> 4);
+  h *= 16777619U;
+  return h;
+}
+
+static int text_cache_usable(cairo_t *cr, const char *text) {
+  cairo_matrix_t m;
+
+  if (strlen(text) >= TEXT_CACHE_LEN || !cairo_has_current_point(cr)) { return 0; }
+
+  cairo_get_matrix(cr, &m);
+  return m.xx == 1.0 && m.yy == 1.0 && m.xy == 0.0 && m.yx == 0.0;
+}
+
+//
+// Find the cache entry for the text with the current font of cr.
+// If there is none, the least recently used entry in the probe window
+// is re-initialized and returned (without mask).
+//
+static TEXT_CACHE_ENTRY *text_cache_lookup(cairo_t *cr, const char *text) {
+  cairo_font_face_t *face = cairo_get_font_face(cr);
+  cairo_matrix_t fm;
+  double sx, sy;
+  cairo_get_font_matrix(cr, &fm);
+  cairo_surface_get_device_scale(cairo_get_target(cr), &sx, &sy);
+  unsigned int h = text_cache_hash(text, face, fm.xx);
+  TEXT_CACHE_ENTRY *victim = NULL;
+  cache_clock++;
+
+  for (int i = 0; i < TEXT_CACHE_PROBE; i++) {
+    TEXT_CACHE_ENTRY *e = &cache[(h + i) & (TEXT_CACHE_SIZE - 1)];
+
+    if (e->face == face && e->size == fm.xx && e->scale == sx && !strcmp(e->text, text)) {
+      e->used = cache_clock;
+      return e;
+    }
+
+    if (victim == NULL || e->used < victim->used) { victim = e; }
+  }
+
+  if (victim->mask) {
+    cairo_surface_destroy(victim->mask);
+    victim->mask = NULL;
+  }
+
+  if (victim->face) {
+    cairo_font_face_destroy(victim->face);
+  }
+
+  victim->face = cairo_font_face_reference(face);
+  victim->size = fm.xx;
+  victim->scale = sx;
+  victim->used = cache_clock;
+  strcpy(victim->text, text);
+  cairo_text_extents(cr, text, &victim->extents);
+  return victim;
+}
+
+static void text_cache_render(cairo_t *cr, TEXT_CACHE_ENTRY *e) {
+  cairo_matrix_t fm;
+  cairo_font_options_t *options = cairo_font_options_create();
+  //
+  // one pixel of extra space on each side for anti-aliasing
+  //
+  e->mask_x = (int) floor(e->extents.x_bearing) - 1;
+  e->mask_y = (int) floor(e->extents.y_bearing) - 1;
+  int w = (int) ceil(e->extents.width) + 3;
+  int h = (int) ceil(e->extents.height) + 3;
+  e->mask = cairo_image_surface_create(CAIRO_FORMAT_A8, (int) ceil(w * e->scale), (int) ceil(h * e->scale));
+  cairo_surface_set_device_scale(e->mask, e->scale, e->scale);
+  cairo_t *mcr = cairo_create(e->mask);
+  cairo_get_font_matrix(cr, &fm);
+  cairo_get_font_options(cr, options);
+  cairo_set_font_face(mcr, e->face);
+  cairo_set_font_matrix(mcr, &fm);
+  cairo_set_font_options(mcr, options);
+  cairo_move_to(mcr, -e->mask_x, -e->mask_y);
+  cairo_show_text(mcr, e->text);
+  cairo_destroy(mcr);
+  cairo_font_options_destroy(options);
+}
+
+void text_cache_show(cairo_t *cr, const char *text) {
+  double x, y;
+
+  if (!text_cache_usable(cr, text)) {
+    cairo_show_text(cr, text);
+    return;
+  }
+
+  TEXT_CACHE_ENTRY *e = text_cache_lookup(cr, text);
+
+  if (e->mask == NULL) {
+    text_cache_render(cr, e);
+  }
+
+  cairo_get_current_point(cr, &x, &y);
+  cairo_mask_surface(cr, e->mask, round(x) + e->mask_x, round(y) + e->mask_y);
+  //
+  // Like cairo_show_text(), advance the current point
+  //
+  cairo_move_to(cr, x + e->extents.x_advance, y + e->extents.y_advance);
+}
+
+void text_cache_show_digits(cairo_t *cr, const char *text) {
+  char c[2];
+  c[1] = 0;
+
+  while (*text) {
+    c[0] = *text++;
+    text_cache_show(cr, c);
+  }
+}
+
+void text_cache_extents(cairo_t *cr, const char *text, cairo_text_extents_t *extents) {
+  if (strlen(text) >= TEXT_CACHE_LEN) {
+    cairo_text_extents(cr, text, extents);
+    return;
+  }
+
+  const TEXT_CACHE_ENTRY *e = text_cache_lookup(cr, text);
+  *extents = e->extents;
+}
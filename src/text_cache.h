@@ -0,0 +1,36 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef _TEXT_CACHE_H_
+#define _TEXT_CACHE_H_
+
+#include <gtk/gtk.h>
+
+//
+// Drop-in replacements for cairo_show_text() and cairo_text_extents()
+// used by the VFO bar and the meter. Rasterized strings are kept as
+// alpha masks (keyed by text, font face and font size) so that unchanged
+// fields are just painted with the current source colour.
+// text_cache_show_digits() caches single characters, such that for a
+// frequency only the digits are rasterized that have not been seen before.
+//
+extern void text_cache_show(cairo_t *cr, const char *text);
+extern void text_cache_show_digits(cairo_t *cr, const char *text);
+extern void text_cache_extents(cairo_t *cr, const char *text, cairo_text_extents_t *extents);
+
+#endif
@@ -48,6 +48,7 @@
 #ifdef SOAPYSDR
   #include "soapy_protocol.h"
 #endif
+#include "tci.h"
 #include "toolbar.h"
 #include "transmitter.h"
 #include "tx_panadapter.h"
@@ -306,8 +307,6 @@ void tx_reconfigure(TRANSMITTER *tx, int pixels, int width, int height) {
         RECEIVER *rx = receiver[PS_RX_FEEDBACK];
         g_mutex_lock(&rx->mutex);
         rx->pixels = pixels;
-        g_free(rx->pixel_samples);
-        rx->pixel_samples = g_new(float, rx->pixels);
         rx_set_analyzer(rx);
         g_mutex_unlock(&rx->mutex);
       }
@@ -781,7 +780,7 @@ static gboolean tx_update_display(gpointer data) {
     }
 
     if (rc) {
-      if (remoteclient.running) {
+      if (remote_clients > 0) {
         remote_send_txspectrum();
       }
 
@@ -1589,10 +1588,18 @@ void tx_add_mic_sample(TRANSMITTER *tx, short next_mic_sample) {
   //
   // If we have a client, it overwrites 'local' microphone data.
   //
-  if (remoteclient.running) {
+  if (remote_clients > 0) {
     mic_sample_double = remote_get_mic_sample() * 0.00003051;  // divide by 32768;
   }
 
+  //
+  // TX audio from TCI clients (digital modes) overwrites microphone data,
+  // as long as it is available.
+  //
+  if (tci_streaming) {
+    tci_tx_audio(&mic_sample_double);
+  }
+
   // If there is captured data to re-play, replace incoming
   // mic samples by captured data.
   //
@@ -1857,9 +1864,7 @@ void tx_add_ps_iq_samples(const TRANSMITTER *tx, double i_sample_tx, double q_sa
       }
 
       if (tx->displaying && tx->feedback) {
-        g_mutex_lock(&rx_feedback->display_mutex);
         Spectrum0(1, rx_feedback->id, 0, 0, rx_feedback->iq_input_buffer);
-        g_mutex_unlock(&rx_feedback->display_mutex);
       }
     }
 
@@ -0,0 +1,284 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+
+#include <gtk/gtk.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "udp_channel.h"
+
+static const uint8_t udp_sync[2] = { 0xFA, 0xFB };
+
+//
+// If a gap is larger than this, it is not a loss but a re-start
+// of the stream, so do not try to conceal it.
+//
+#define UDP_MAX_GAP 64
+
+void udp_header_init(UDP_HEADER *hdr, int type, int channel, uint32_t token) {
+  memset(hdr, 0, sizeof(UDP_HEADER));
+  memcpy(hdr->sync, udp_sync, sizeof(udp_sync));
+  hdr->type = type;
+  hdr->channel = channel;
+  hdr->token = htonl(token);
+}
+
+int udp_header_check(const UDP_HEADER *hdr, int len) {
+  if (len < (int)sizeof(UDP_HEADER) || memcmp(hdr->sync, udp_sync, sizeof(udp_sync)) != 0) { return -1; }
+
+  if (hdr->type > UDP_PARITY || hdr->channel >= UDP_CHANNELS || hdr->fec > UDP_MAX_FEC) { return -1; }
+
+  if (len - (int)sizeof(UDP_HEADER) > UDP_MAX_PAYLOAD) { return -1; }
+
+  return 0;
+}
+
+void udp_sender_init(UDP_SENDER *s, int fec) {
+  int n = 1;
+
+  //
+  // The group size must be a power of two, such that the groups
+  // stay aligned when the sequence number wraps around.
+  //
+  while (2 * n <= fec && 2 * n <= UDP_MAX_FEC) { n <<= 1; }
+
+  s->seq = 0;
+  s->fec = (n > 1) ? n : 0;
+  s->count = 0;
+  s->maxlen = 0;
+  s->lenxor = 0;
+}
+
+int udp_sender_packet(UDP_SENDER *s, const uint8_t *payload, int len, UDP_HEADER *hdr, UDP_HEADER *parity_hdr) {
+  uint32_t seq = s->seq++;
+  hdr->type = UDP_DATA;
+  hdr->seq = htonl(seq);
+  hdr->fec = s->fec;
+  hdr->lenxor = 0;
+
+  if (s->fec == 0) { return 0; }
+
+  if (s->count == 0) {
+    s->maxlen = 0;
+    s->lenxor = 0;
+  }
+
+  //
+  // The parity buffer is cleared "on demand"
+  //
+  if (len > s->maxlen) {
+    memset(s->parity + s->maxlen, 0, len - s->maxlen);
+    s->maxlen = len;
+  }
+
+  for (int i = 0; i < len; i++) {
+    s->parity[i] ^= payload[i];
+  }
+
+  s->lenxor ^= len;
+
+  if (++s->count < s->fec) { return 0; }
+
+  s->count = 0;
+  *parity_hdr = *hdr;
+  parity_hdr->type = UDP_PARITY;
+  parity_hdr->seq = htonl(seq - (s->fec - 1));
+  parity_hdr->lenxor = htons(s->lenxor);
+  return s->maxlen;
+}
+
+UDP_RECEIVER *udp_receiver_new(int channel, void (*deliver)(int, const uint8_t *, int), void (*lost)(int)) {
+  UDP_RECEIVER *r = g_new0(UDP_RECEIVER, 1);
+  r->channel = channel;
+  r->deliver = deliver;
+  r->lost = lost;
+  return r;
+}
+
+void udp_receiver_free(UDP_RECEIVER *r) {
+  if (r == NULL) { return; }
+
+  g_free(r->data);
+  g_free(r->parity);
+  g_free(r);
+}
+
+static void udp_receiver_lost(UDP_RECEIVER *r, uint32_t count) {
+  r->missing += count;
+
+  if (count > UDP_MAX_GAP) { return; }
+
+  for (uint32_t i = 0; i < count; i++) {
+    r->lost(r->channel);
+  }
+}
+
+//
+// FEC: deliver what is in order, and reconstruct a single missing
+// datagram of the group once the parity is there.
+//
+static void udp_receiver_flush(UDP_RECEIVER *r) {
+  if (r->parity_len > 0) {
+    int missing = -1;
+    int count = 0;
+
+    for (int i = 0; i < r->fec; i++) {
+      if (!r->have[i]) {
+        missing = i;
+        count++;
+      }
+    }
+
+    if (count == 1 && (int32_t)(r->group + missing - r->next) >= 0) {
+      uint8_t *out = r->data + missing * UDP_MAX_PAYLOAD;
+      int len = r->parity_lenxor;
+      memcpy(out, r->parity, r->parity_len);
+
+      for (int i = 0; i < r->fec; i++) {
+        if (i == missing) { continue; }
+
+        const uint8_t *in = r->data + i * UDP_MAX_PAYLOAD;
+
+        for (int j = 0; j < r->len[i]; j++) {
+          out[j] ^= in[j];
+        }
+
+        len ^= r->len[i];
+      }
+
+      if (len > 0 && len <= r->parity_len) {
+        r->have[missing] = 1;
+        r->len[missing] = len;
+        r->recovered++;
+      }
+    }
+  }
+
+  while ((int32_t)(r->next - r->group) < r->fec) {
+    int i = r->next - r->group;
+
+    if (!r->have[i]) { break; }
+
+    r->deliver(r->channel, r->data + i * UDP_MAX_PAYLOAD, r->len[i]);
+    r->next++;
+  }
+}
+
+//
+// Give up on the current group: what is still missing is lost.
+//
+static void udp_receiver_finish(UDP_RECEIVER *r) {
+  udp_receiver_flush(r);
+
+  while ((int32_t)(r->next - r->group) < r->fec) {
+    int i = r->next - r->group;
+
+    if (r->have[i]) {
+      r->deliver(r->channel, r->data + i * UDP_MAX_PAYLOAD, r->len[i]);
+    } else {
+      udp_receiver_lost(r, 1);
+    }
+
+    r->next++;
+  }
+}
+
+static void udp_receiver_start_group(UDP_RECEIVER *r, uint32_t group) {
+  r->group = group;
+  r->parity_len = 0;
+
+  for (int i = 0; i < r->fec; i++) {
+    r->have[i] = 0;
+  }
+}
+
+void udp_receiver_input(UDP_RECEIVER *r, const UDP_HEADER *hdr, const uint8_t *payload, int len) {
+  uint32_t seq = ntohl(hdr->seq);
+  int fec = hdr->fec;
+
+  if (fec != r->fec) {
+    //
+    // (Re-)start. FEC buffers are allocated when first needed.
+    //
+    if (fec > 0 && r->data == NULL) {
+      r->data = g_new(uint8_t, UDP_MAX_FEC * UDP_MAX_PAYLOAD);
+      r->parity = g_new(uint8_t, UDP_MAX_PAYLOAD);
+    }
+
+    r->fec = fec;
+    r->started = 0;
+  }
+
+  if (hdr->type == UDP_DATA) { r->received++; }
+
+  if (fec == 0) {
+    if (hdr->type != UDP_DATA) { return; }
+
+    if (r->started && (int32_t)(seq - r->next) < 0) {
+      r->late++;
+      return;
+    }
+
+    if (r->started) { udp_receiver_lost(r, seq - r->next); }
+
+    r->started = 1;
+    r->next = seq + 1;
+    r->deliver(r->channel, payload, len);
+    return;
+  }
+
+  uint32_t group = seq & ~(uint32_t)(fec - 1);
+
+  if (!r->started) {
+    if (hdr->type != UDP_DATA) { return; }
+
+    r->started = 1;
+    r->next = seq;
+    udp_receiver_start_group(r, group);
+  }
+
+  if ((int32_t)(group - r->group) < 0 || (hdr->type == UDP_DATA && (int32_t)(seq - r->next) < 0)) {
+    r->late++;
+    return;
+  }
+
+  if (group != r->group) {
+    udp_receiver_finish(r);
+
+    if ((int32_t)(group - r->next) > 0) {
+      udp_receiver_lost(r, group - r->next);
+      r->next = group;
+    }
+
+    udp_receiver_start_group(r, group);
+  }
+
+  if (hdr->type == UDP_PARITY) {
+    memcpy(r->parity, payload, len);
+    r->parity_len = len;
+    r->parity_lenxor = ntohs(hdr->lenxor);
+  } else {
+    int i = seq - group;
+    memcpy(r->data + i * UDP_MAX_PAYLOAD, payload, len);
+    r->have[i] = 1;
+    r->len[i] = len;
+  }
+
+  udp_receiver_flush(r);
+}
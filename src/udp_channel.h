@@ -0,0 +1,116 @@
+/* Copyright (C)
+* 2025 - piHPSDR contributors
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*/
+
+
+#ifndef _UDP_CHANNEL_H_
+#define _UDP_CHANNEL_H_
+
+#include <stdint.h>
+
+//
+// Framing of the optional UDP side channel of the client/server protocol.
+// Audio and spectrum packets (exactly as they are sent over TCP) are put
+// into datagrams with a sequence number per channel, such that the
+// receiver can detect lost and late packets. Optionally, a parity
+// datagram (the XOR of the payloads) is sent after each group of
+// "fec" data datagrams, from which one lost datagram per group can be
+// reconstructed.
+//
+#define UDP_MAX_PAYLOAD   8192        // larger packets go over TCP
+#define UDP_MAX_FEC       8           // max. FEC group size
+
+enum _udp_channel_enum {
+  UDP_CHANNEL_AUDIO = 0,              // RX audio of RX1 and RX2
+  UDP_CHANNEL_SPECTRUM = 2,           // panadapters of RX1 ... RX8 and TX
+  UDP_CHANNEL_IQ = 11,                // IQ data of RX1 and RX2
+  UDP_CHANNELS = 13
+};
+
+enum _udp_type_enum {
+  UDP_HELLO = 0,                      // client --> server, opens the channel
+  UDP_DATA,
+  UDP_PARITY
+};
+
+typedef struct __attribute__((__packed__)) _udp_header {
+  uint8_t sync[2];
+  uint8_t type;
+  uint8_t channel;
+  uint32_t token;                     // identifies the client connection
+  uint32_t seq;                       // parity: first sequence number of the group
+  uint8_t fec;                        // FEC group size used by the sender
+  uint8_t reserved;
+  uint16_t lenxor;                    // parity: XOR of the payload lengths
+} UDP_HEADER;
+
+extern void udp_header_init(UDP_HEADER *hdr, int type, int channel, uint32_t token);
+extern int udp_header_check(const UDP_HEADER *hdr, int len);
+
+//
+// Sender: udp_sender_packet() fills in the header of the next data datagram.
+// If this completes a FEC group, it returns the length of the parity
+// payload (in s->parity, valid until the next call) and fills in its
+// header, otherwise it returns 0.
+//
+typedef struct _udp_sender {
+  uint32_t seq;
+  int fec;
+  int count;
+  int maxlen;
+  uint16_t lenxor;
+  uint8_t parity[UDP_MAX_PAYLOAD];
+} UDP_SENDER;
+
+extern void udp_sender_init(UDP_SENDER *s, int fec);
+extern int udp_sender_packet(UDP_SENDER *s, const uint8_t *payload, int len, UDP_HEADER *hdr,
+                             UDP_HEADER *parity_hdr);
+
+//
+// Receiver: delivers the payloads of a channel in order. Late datagrams are
+// discarded, and lost() is called for every datagram that could not be
+// reconstructed, at the position where it should have been delivered.
+//
+typedef struct _udp_receiver {
+  int channel;
+  int fec;
+  int started;
+  uint32_t next;                      // next sequence number to deliver
+  uint32_t group;                     // first sequence number of the current FEC group
+  int have[UDP_MAX_FEC];
+  int len[UDP_MAX_FEC];
+  uint8_t *data;                      // UDP_MAX_FEC * UDP_MAX_PAYLOAD bytes
+  int parity_len;                     // 0: no parity for the current group
+  uint16_t parity_lenxor;
+  uint8_t *parity;
+  void (*deliver)(int channel, const uint8_t *payload, int len);
+  void (*lost)(int channel);
+  //
+  // statistics
+  //
+  long received;
+  long missing;
+  long recovered;
+  long late;
+} UDP_RECEIVER;
+
+extern UDP_RECEIVER *udp_receiver_new(int channel, void (*deliver)(int, const uint8_t *, int),
+                                      void (*lost)(int));
+extern void udp_receiver_free(UDP_RECEIVER *r);
+extern void udp_receiver_input(UDP_RECEIVER *r, const UDP_HEADER *hdr, const uint8_t *payload, int len);
+
+#endif
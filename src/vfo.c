@@ -54,9 +54,11 @@
 #include "filter.h"
 #include "actions.h"
 #include "noise_menu.h"
+#include "notify.h"
 #include "equalizer_menu.h"
 #include "message.h"
 #include "sliders.h"
+#include "text_cache.h"
 
 static int my_width;
 static int my_height;
@@ -828,6 +830,7 @@ void vfo_id_mode_changed(int id, int m) {
   }
 
   vfo[id].mode = m;
+  notify_changed(NOTIFY_MODE);
 
   if (id < receivers) {
     vfo_apply_mode_settings(receiver[id]);
@@ -894,6 +897,7 @@ void vfo_filter_changed(int f) {
 
 void vfo_id_filter_changed(int id, int f) {
   vfo[id].filter = f;
+  notify_changed(NOTIFY_FILTER);
 
   if (radio_is_remote) {
     send_filter_sel(client_socket, id, f);
@@ -1595,7 +1599,7 @@ void vfo_update() {
     cairo_set_font_size(cr, vfl->size1);
     cairo_set_source_rgba(cr, COLOUR_ATTN);
     cairo_move_to(cr, vfl->mode_x, vfl->mode_y);
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   // In what follows, we want to display the VFO frequency
@@ -1666,14 +1670,14 @@ void vfo_update() {
     f_k = (af - 1000000LL * f_m) / 1000;
     f_h = (af - 1000000LL * f_m - 1000 * f_k);
     cairo_set_font_size(cr, vfl->size2);
-    cairo_show_text(cr, "A:");
+    text_cache_show(cr, "A:");
     cairo_set_font_size(cr, vfl->size3);
 
     if (txvfo == 0 && oob) {
-      cairo_show_text(cr, "Out of band");
+      text_cache_show(cr, "Out of band");
     } else if (vfo[0].entered_frequency[0]) {
       snprintf(temp_text, sizeof(temp_text), "%s", vfo[0].entered_frequency);
-      cairo_show_text(cr, temp_text);
+      text_cache_show(cr, temp_text);
     } else {
       //
       // poor man's right alignment:
@@ -1684,21 +1688,21 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_VFO_BACKGND);
 
       if (f_m < 10) {
-        cairo_show_text(cr, "0000");
+        text_cache_show_digits(cr, "0000");
       } else if (f_m < 100) {
-        cairo_show_text(cr, "000");
+        text_cache_show_digits(cr, "000");
       } else if (f_m < 1000) {
-        cairo_show_text(cr, "00");
+        text_cache_show_digits(cr, "00");
       } else if (f_m < 10000) {
-        cairo_show_text(cr, "0");
+        text_cache_show_digits(cr, "0");
       }
 
       cairo_restore(cr);
       snprintf(temp_text, sizeof(temp_text), "%0d.%03d", f_m, f_k);
-      cairo_show_text(cr, temp_text);
+      text_cache_show_digits(cr, temp_text);
       cairo_set_font_size(cr, vfl->size2);
       snprintf(temp_text, sizeof(temp_text), "%03d", f_h);
-      cairo_show_text(cr, temp_text);
+      text_cache_show_digits(cr, temp_text);
     }
   }
 
@@ -1724,14 +1728,14 @@ void vfo_update() {
     f_k = (bf - 1000000LL * f_m) / 1000;
     f_h = (bf - 1000000LL * f_m - 1000 * f_k);
     cairo_set_font_size(cr, vfl->size2);
-    cairo_show_text(cr, "B:");
+    text_cache_show(cr, "B:");
     cairo_set_font_size(cr, vfl->size3);
 
     if (txvfo == 0 && oob) {
-      cairo_show_text(cr, "Out of band");
+      text_cache_show(cr, "Out of band");
     } else if (vfo[1].entered_frequency[0]) {
       snprintf(temp_text, sizeof(temp_text), "%s", vfo[1].entered_frequency);
-      cairo_show_text(cr, temp_text);
+      text_cache_show(cr, temp_text);
     } else {
       //
       // poor man's right alignment:
@@ -1742,21 +1746,21 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_VFO_BACKGND);
 
       if (f_m < 10) {
-        cairo_show_text(cr, "0000");
+        text_cache_show_digits(cr, "0000");
       } else if (f_m < 100) {
-        cairo_show_text(cr, "000");
+        text_cache_show_digits(cr, "000");
       } else if (f_m < 1000) {
-        cairo_show_text(cr, "00");
+        text_cache_show_digits(cr, "00");
       } else if (f_m < 10000) {
-        cairo_show_text(cr, "0");
+        text_cache_show_digits(cr, "0");
       }
 
       cairo_restore(cr);
       snprintf(temp_text, sizeof(temp_text), "%0d.%03d", f_m, f_k);
-      cairo_show_text(cr, temp_text);
+      text_cache_show_digits(cr, temp_text);
       cairo_set_font_size(cr, vfl->size2);
       snprintf(temp_text, sizeof(temp_text), "%03d", f_h);
-      cairo_show_text(cr, temp_text);
+      text_cache_show_digits(cr, temp_text);
     }
   }
 
@@ -1780,7 +1784,7 @@ void vfo_update() {
     }
 
     snprintf(temp_text, sizeof(temp_text), "Zoom %d", active_receiver->zoom);
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   // -----------------------------------------------------------
@@ -1797,7 +1801,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "PS");
+    text_cache_show(cr, "PS");
   }
 
   // -----------------------------------------------------------
@@ -1814,7 +1818,7 @@ void vfo_update() {
 
     snprintf(temp_text, sizeof(temp_text), "RIT %lldHz", vfo[id].rit);
     cairo_move_to(cr, vfl->rit_x, vfl->rit_y);
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   // -----------------------------------------------------------
@@ -1831,7 +1835,7 @@ void vfo_update() {
 
     snprintf(temp_text, sizeof(temp_text), "XIT %lldHz", vfo[txvfo].xit);
     cairo_move_to(cr, vfl->xit_x, vfl->xit_y);
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   // -----------------------------------------------------------
@@ -1845,17 +1849,17 @@ void vfo_update() {
     switch (active_receiver->nb) {
     case 1:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "NB");
+      text_cache_show(cr, "NB");
       break;
 
     case 2:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "NB2");
+      text_cache_show(cr, "NB2");
       break;
 
     default:
       cairo_set_source_rgba(cr, COLOUR_SHADE);
-      cairo_show_text(cr, "NB");
+      text_cache_show(cr, "NB");
       break;
     }
   }
@@ -1871,29 +1875,29 @@ void vfo_update() {
     switch (active_receiver->nr) {
     case 1:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "NR");
+      text_cache_show(cr, "NR");
       break;
 
     case 2:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "NR2");
+      text_cache_show(cr, "NR2");
       break;
 #ifdef EXTNR
 
     case 3:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "NR3");
+      text_cache_show(cr, "NR3");
       break;
 
     case 4:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "NR4");
+      text_cache_show(cr, "NR4");
       break;
 #endif
 
     default:
       cairo_set_source_rgba(cr, COLOUR_SHADE);
-      cairo_show_text(cr, "NR");
+      text_cache_show(cr, "NR");
       break;
     }
   }
@@ -1912,7 +1916,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "ANF");
+    text_cache_show(cr, "ANF");
   }
 
   // -----------------------------------------------------------
@@ -1929,7 +1933,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "SNB");
+    text_cache_show(cr, "SNB");
   }
 
   // -----------------------------------------------------------
@@ -1946,7 +1950,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "DExp");
+    text_cache_show(cr, "DExp");
   }
 
   // -----------------------------------------------------------
@@ -1960,27 +1964,27 @@ void vfo_update() {
     switch (active_receiver->agc) {
     case AGC_OFF:
       cairo_set_source_rgba(cr, COLOUR_SHADE);
-      cairo_show_text(cr, "AGC off");
+      text_cache_show(cr, "AGC off");
       break;
 
     case AGC_LONG:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "AGC long");
+      text_cache_show(cr, "AGC long");
       break;
 
     case AGC_SLOW:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "AGC slow");
+      text_cache_show(cr, "AGC slow");
       break;
 
     case AGC_MEDIUM:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "AGC med");
+      text_cache_show(cr, "AGC med");
       break;
 
     case AGC_FAST:
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "AGC fast");
+      text_cache_show(cr, "AGC fast");
       break;
     }
   }
@@ -2013,7 +2017,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   // -----------------------------------------------------------
@@ -2026,13 +2030,13 @@ void vfo_update() {
 
     if (radio_is_transmitting() && transmitter->eq_enable) {
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "TxEQ");
+      text_cache_show(cr, "TxEQ");
     } else if (!radio_is_transmitting() && active_receiver->eq_enable) {
       cairo_set_source_rgba(cr, COLOUR_ATTN);
-      cairo_show_text(cr, "RxEQ");
+      text_cache_show(cr, "RxEQ");
     } else {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
-      cairo_show_text(cr, "EQ");
+      text_cache_show(cr, "EQ");
     }
   }
 
@@ -2050,7 +2054,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "DIV");
+    text_cache_show(cr, "DIV");
   }
 
   // -----------------------------------------------------------
@@ -2070,7 +2074,7 @@ void vfo_update() {
     snprintf(temp_text, sizeof(temp_text), "Step %s", step_labels[s]);
     cairo_move_to(cr, vfl->step_x, vfl->step_y);
     cairo_set_source_rgba(cr, COLOUR_ATTN);
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   // -----------------------------------------------------------
@@ -2087,7 +2091,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "CTUN");
+    text_cache_show(cr, "CTUN");
   }
 
   // -----------------------------------------------------------
@@ -2104,7 +2108,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "CAT");
+    text_cache_show(cr, "CAT");
   }
 
   // -----------------------------------------------------------
@@ -2121,7 +2125,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "VOX");
+    text_cache_show(cr, "VOX");
   }
 
   // -----------------------------------------------------------
@@ -2138,7 +2142,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "Locked");
+    text_cache_show(cr, "Locked");
   }
 
   // -----------------------------------------------------------
@@ -2155,7 +2159,7 @@ void vfo_update() {
       cairo_set_source_rgba(cr, COLOUR_SHADE);
     }
 
-    cairo_show_text(cr, "Split");
+    text_cache_show(cr, "Split");
   }
 
   // -----------------------------------------------------------
@@ -2173,9 +2177,9 @@ void vfo_update() {
     }
 
     if (sat_mode == SAT_NONE || sat_mode == SAT_MODE) {
-      cairo_show_text(cr, "Sat");
+      text_cache_show(cr, "Sat");
     } else {
-      cairo_show_text(cr, "RSat");
+      text_cache_show(cr, "RSat");
     }
   }
 
@@ -2193,7 +2197,7 @@ void vfo_update() {
 
     snprintf(temp_text, sizeof(temp_text), "Dup");
     cairo_move_to(cr, vfl->dup_x, vfl->dup_y);
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   // -----------------------------------------------------------
@@ -2212,11 +2216,14 @@ void vfo_update() {
 
     GetMultifunctionString(temp_text, sizeof(temp_text));
     cairo_move_to(cr, vfl->multifn_x, vfl->multifn_y);
-    cairo_show_text(cr, temp_text);
+    text_cache_show(cr, temp_text);
   }
 
   cairo_destroy (cr);
-  gtk_widget_queue_draw (vfo_panel);
+
+  if (vfo_panel) {
+    gtk_widget_queue_draw (vfo_panel);
+  }
 }
 
 // cppcheck-suppress constParameterCallback
@@ -2260,6 +2267,25 @@ GtkWidget* vfo_init(int width, int height) {
   return vfo_panel;
 }
 
+//
+// Offscreen VFO bar without a widget (used by the render benchmark)
+//
+void vfo_init_offscreen(int width, int height) {
+  my_width = width;
+  my_height = height;
+  vfo_panel = NULL;
+
+  if (vfo_surface) {
+    cairo_surface_destroy (vfo_surface);
+  }
+
+  vfo_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+  cairo_t *cr = cairo_create (vfo_surface);
+  cairo_set_source_rgba(cr, COLOUR_VFO_BACKGND);
+  cairo_paint (cr);
+  cairo_destroy(cr);
+}
+
 //
 // Some utility functions to get characteristics of the current
 // transmitter. These functions can be used even if there is no
@@ -2445,6 +2471,7 @@ void vfo_id_set_frequency(int v, long long f) {
     }
   }
 
+  notify_changed(NOTIFY_VFO);
   g_idle_add(ext_vfo_update, NULL);
 }
 
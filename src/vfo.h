@@ -163,6 +163,7 @@ extern char *step_labels[];
 // Global functions declared in vfo.h start with "vfo_"
 //
 extern GtkWidget* vfo_init(int width, int height);
+extern void vfo_init_offscreen(int width, int height);
 extern int        vfo_id_get_stepindex(int id);
 extern void       vfo_id_set_step_from_index(int id, int index);
 extern int        vfo_get_step_from_index(int index);
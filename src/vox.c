@@ -56,7 +56,7 @@ void vox_update(double lvl) {
   //
   // As long as a client controls us, VOX is done there
   //
-  if (remoteclient.running) { return; }
+  if (remote_clients > 0) { return; }
 
   if (vox_enabled && !mox && !tune && !TxInhibit) {
     if (peak > vox_threshold) {
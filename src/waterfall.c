@@ -286,7 +286,9 @@ void waterfall_update(RECEIVER *rx) {
       }
     }
 
-    gtk_widget_queue_draw (rx->waterfall);
+    if (rx->waterfall) {
+      gtk_widget_queue_draw (rx->waterfall);
+    }
   }
 }
 
@@ -323,3 +325,17 @@ void waterfall_init(RECEIVER *rx, int width, int height) {
                          | GDK_POINTER_MOTION_MASK
                          | GDK_POINTER_MOTION_HINT_MASK);
 }
+
+//
+// Offscreen waterfall without a widget (used by the render benchmark)
+//
+void waterfall_init_offscreen(RECEIVER *rx, int width, int height) {
+  my_width = width;
+  my_heigt = height;
+  rx->waterfall = NULL;
+  rx->waterfall_frequency = 0;
+  rx->waterfall_sample_rate = 0;
+  rx->pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, width, height);
+  unsigned char *pixels = gdk_pixbuf_get_pixels (rx->pixbuf);
+  memset(pixels, 0, gdk_pixbuf_get_rowstride(rx->pixbuf) * height);
+}
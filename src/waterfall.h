@@ -21,4 +21,5 @@
 
 extern void waterfall_update(RECEIVER *rx);
 extern void waterfall_init(RECEIVER *rx, int width, int height);
+extern void waterfall_init_offscreen(RECEIVER *rx, int width, int height);
 
@@ -552,6 +552,32 @@ void avenger (  int av_mode,                // averaging mode
             pixels[i] += (dOUTREAL)norm_oneHz;
 }
 
+/********************************************************************************************************
+*                                                                                                       *
+*   Pixel frame exchange:  the three pixel buffers of each output are used as a lock-free triple       *
+*   buffer.  The writer (stitch) owns w_pix_buff, the reader owns r_pix_buff, and m_pix_buff holds     *
+*   the "middle" buffer that is passed between them with an atomic exchange.                          *
+*                                                                                                       *
+********************************************************************************************************/
+
+static LONG SwapPixelBuffer (volatile LONG *middle, LONG value)
+{
+    // atomic exchange with full memory barrier (the frame must be visible before it is published)
+    LONG old;
+    do
+    {
+        old = *middle;
+    } while (InterlockedCompareExchange (middle, value, old) != old);
+    return old;
+}
+
+static void InitPixelBuffers (DP a, int pixout)
+{
+    // keep the buffer the reader currently holds, the other two are re-assigned
+    a->w_pix_buff[pixout] = (a->r_pix_buff[pixout] + 1) % dNUM_PIXEL_BUFFS;
+    a->m_pix_buff[pixout] = (a->r_pix_buff[pixout] + 2) % dNUM_PIXEL_BUFFS;
+}
+
 void stitch(int disp)
 {
     DP a = pdisp[disp];
@@ -589,13 +615,9 @@ void stitch(int disp)
         avenger (a->av_mode[i], a->num_pixels, &a->avail_frames[i], a->num_average[i], &a->av_in_idx[i], &a->av_out_idx[i],
             a->av_backmult[i], a->scale, a->t_pixels[i], a->av_sum[i], a->av_buff[i], a->cd, a->normalize[i], a->norm_oneHz,
             a->pixels[i][a->w_pix_buff[i]]);
+        // publish the frame just written, take over the previously published one for writing
+        a->w_pix_buff[i] = (int)(SwapPixelBuffer(&a->m_pix_buff[i], a->w_pix_buff[i] | dPIX_BUFF_FRESH) & dPIX_BUFF_INDEX);
         LeaveCriticalSection(&a->ResampleSection);
-
-        EnterCriticalSection(&a->PB_ControlsSection[i]);
-            a->last_pix_buff[i] = a->w_pix_buff[i];
-            while ((a->w_pix_buff[i] = (a->w_pix_buff[i] + 1) % dNUM_PIXEL_BUFFS) == a->r_pix_buff[i]);
-        LeaveCriticalSection(&a->PB_ControlsSection[i]);
-        InterlockedBitTestAndSet(&(a->pb_ready[i][a->last_pix_buff[i]]), 0);
     }
 }
 
@@ -962,13 +984,7 @@ void ResetPixelBuffers(int disp)
         a->avail_frames[i] = 0;
         a->av_in_idx[i] = 0;
         a->av_out_idx[i] = 0;
-        EnterCriticalSection(&a->PB_ControlsSection[i]);
-        a->w_pix_buff[i] = 0;
-        a->r_pix_buff[i] = 0;
-        a->last_pix_buff[i] = 0;
-        for (j = 0; j < dNUM_PIXEL_BUFFS; j++)
-            a->pb_ready[i][j] = 0;
-        LeaveCriticalSection(&a->PB_ControlsSection[i]);
+        InitPixelBuffers (a, i);
     }
     memset((void*)a->pre_av_out, 0, sizeof(double) * a->max_size * a->max_stitch);
     LeaveCriticalSection(&a->ResampleSection);
@@ -1113,13 +1129,7 @@ void SetAnalyzer (  int disp,           // display identifier
         a->spec_flag[i] = 0;
     a->stitch_flag = 0;
     for (i = 0; i < dMAX_PIXOUTS; i++)
-    {
-        a->w_pix_buff[i] = 0;
-        a->r_pix_buff[i] = 0;
-        a->last_pix_buff[i] = 0;
-        for (j = 0; j < dNUM_PIXEL_BUFFS; j++)
-            a->pb_ready[i][j] = 0;
-    }
+        InitPixelBuffers (a, i);
     a->ss = 0;
     a->LO = 0;
     for (i = 0; i < dMAX_STITCH; i++)
@@ -1165,8 +1175,6 @@ void XCreateAnalyzer(   int disp,
     InitializeCriticalSectionAndSpinCount(&a->ResampleSection, 0);
     InitializeCriticalSectionAndSpinCount(&a->SetAnalyzerSection, 0);
     InitializeCriticalSectionAndSpinCount(&a->StitchSection, 0);
-    for (i = 0; i < dMAX_PIXOUTS; i++)
-        InitializeCriticalSectionAndSpinCount(&a->PB_ControlsSection[i], 0);
     for (i = 0; i < dMAX_STITCH; i++)
     {
         InitializeCriticalSectionAndSpinCount(&(a->EliminateSection[i]), 0);
@@ -1203,6 +1211,12 @@ void XCreateAnalyzer(   int disp,
             a->pixels[i][j] = (dOUTREAL*) malloc0 (sizeof(dOUTREAL) * dMAX_PIXELS);
     }
 
+    for (i = 0; i < dMAX_PIXOUTS; i++)
+    {
+        a->r_pix_buff[i] = 0;
+        InitPixelBuffers (a, i);
+    }
+
     a->cd = (double*) malloc0 (sizeof(double) * dMAX_PIXELS);
     for (j = 0; j < dMAX_PIXELS; j++)
         a->cd[j] = 1.0;
@@ -1296,8 +1310,6 @@ void DestroyAnalyzer(int disp)
         for (j = 0; j < dMAX_NUM_FFT; j++)
             DeleteCriticalSection(&(a->BufferControlSection[i][j]));
     }
-    for (i = 0; i < dMAX_PIXOUTS; i++)
-        DeleteCriticalSection(&a->PB_ControlsSection[i]);
     DeleteCriticalSection(&a->StitchSection);
     DeleteCriticalSection(&a->SetAnalyzerSection);
     DeleteCriticalSection(&a->ResampleSection);
@@ -1319,18 +1331,30 @@ void GetPixels  (   int disp,
                 )
 {
     DP a = pdisp[disp];
-    EnterCriticalSection(&a->PB_ControlsSection[pixout]);
-        a->r_pix_buff[pixout] = a->last_pix_buff[pixout];
-    LeaveCriticalSection(&a->PB_ControlsSection[pixout]);
+    dOUTREAL *frame;
+    GetPixelFrame (disp, pixout, &frame, flag);
+    if (*flag)
+        memcpy (pix, frame, a->num_pixels * sizeof(dOUTREAL));
+}
 
-    if (_InterlockedAnd(&(a->pb_ready[pixout][a->r_pix_buff[pixout]]), 1))
+PORT
+void GetPixelFrame (int disp,
+                    int pixout,
+                    dOUTREAL **pix,     //always set to the most recent frame owned by the reader, valid until the next call
+                    int *flag           //1 if this frame has not been returned before, else 0
+                   )
+{
+    // Zero-copy, lock-free variant of GetPixels():  there must be only ONE reader per pixout,
+    // all consumers of a frame (panadapter, waterfall, remote, ...) share the returned pointer.
+    DP a = pdisp[disp];
+    if (a->m_pix_buff[pixout] & dPIX_BUFF_FRESH)
     {
-        memcpy (pix, a->pixels[pixout][a->r_pix_buff[pixout]], a->num_pixels * sizeof(dOUTREAL));
+        a->r_pix_buff[pixout] = (int)(SwapPixelBuffer(&a->m_pix_buff[pixout], a->r_pix_buff[pixout]) & dPIX_BUFF_INDEX);
         *flag = 1;
-        InterlockedBitTestAndReset(&(a->pb_ready[pixout][a->r_pix_buff[pixout]]), 0);
     }
     else
         *flag = 0;
+    *pix = a->pixels[pixout][a->r_pix_buff[pixout]];
 }
 
 PORT
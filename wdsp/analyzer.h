@@ -73,8 +73,8 @@ typedef struct _dp
     double *t_pixels[dMAX_PIXOUTS];                         // pointer to temporary pixel buffer                                    //pointer to temporary pixel buffer for non-averaged data
     int w_pix_buff[dMAX_PIXOUTS];                           // number of pixel buffer owned by writing process
     int r_pix_buff[dMAX_PIXOUTS];                           // number of pixel buffer owned by reading process
-    int last_pix_buff[dMAX_PIXOUTS];                        // number of the last pixel buffer written
-    volatile LONG pb_ready[dMAX_PIXOUTS][dNUM_PIXEL_BUFFS]; // if value is 0, this data has already been read; 1 = fresh data to read
+    volatile LONG m_pix_buff[dMAX_PIXOUTS];                 // number of the published ("middle") pixel buffer, ORed with
+                                                            //      dPIX_BUFF_FRESH if it has not yet been taken by the reader
     int num_average[dMAX_PIXOUTS];                          // number of spans to average to create the pixels
     int avail_frames[dMAX_PIXOUTS];                         // number of pixel frames currently available to average
     int av_in_idx[dMAX_PIXOUTS];                            // input index in averaging pixel buffer ring
@@ -121,7 +121,6 @@ typedef struct _dp
     HANDLE hSnapEvent[dMAX_STITCH][dMAX_NUM_FFT];           // mutex handles; mutexes will be used to signal a snap is complete
     double *snap_buff[dMAX_STITCH][dMAX_NUM_FFT];           // pointers to buffers for the snap
 
-    CRITICAL_SECTION PB_ControlsSection[dMAX_PIXOUTS];
     CRITICAL_SECTION SetAnalyzerSection;
     CRITICAL_SECTION BufferControlSection[dMAX_STITCH][dMAX_NUM_FFT];
     CRITICAL_SECTION StitchSection;
@@ -137,6 +136,9 @@ typedef struct _dp
     int normalize[dMAX_PIXOUTS];
 }  dp, *DP;
 
+#define dPIX_BUFF_INDEX                 0x03                // mask to obtain the buffer number from m_pix_buff
+#define dPIX_BUFF_FRESH                 0x04                // flag in m_pix_buff: buffer contains a frame not yet read
+
 extern DP pdisp[];
 
 extern __declspec( dllexport )
@@ -178,6 +180,9 @@ void Spectrum2(int run, int disp, int ss, int LO, dINREAL* pbuff);
 extern __declspec( dllexport )
 void Spectrum0(int run, int disp, int ss, int LO, double* pbuff);
 
+extern __declspec( dllexport )
+void GetPixelFrame (int disp, int pixout, dOUTREAL **pix, int *flag);
+
 extern __declspec( dllexport )
 void SnapSpectrum(  int disp,
                     int ss,
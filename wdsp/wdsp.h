@@ -168,6 +168,11 @@ extern void GetPixels  (   int disp,
                     dOUTREAL *pix,
                     int *flag
                 );
+extern void GetPixelFrame (int disp,
+                    int pixout,
+                    dOUTREAL **pix,
+                    int *flag
+                );
 extern void SnapSpectrum(  int disp,
                     int ss,
                     int LO,